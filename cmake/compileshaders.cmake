@@ -12,6 +12,7 @@ endfunction()
 
 CompileShader(graph/constructionpass_vs VERTEX main)
 CompileShader(graph/constructionpass_vs_skinned VERTEX main)
+CompileShader(graph/constructionpass_vs_skinned_compact VERTEX main)
 CompileShader(graph/constructionpass_fs FRAGMENT main)
 
 CompileShader(graph/deferredlightingpass_vs VERTEX main)
@@ -24,9 +25,11 @@ CompileShader(graph/compositepass_vs VERTEX main)
 CompileShader(graph/compositepass_fs FRAGMENT main)
 
 CompileShader(graph/shadowmappingpass_vs VERTEX main)
+CompileShader(graph/shadowmappingpass_vs_compact VERTEX main)
 CompileShader(graph/shadowmappingpass_fs FRAGMENT main)
 CompileShader(graph/shadowmappingpass_gs GEOMETRY main)
 CompileShader(graph/shadowmappingpass_dir_vs VERTEX main)
+CompileShader(graph/shadowmappingpass_dir_vs_compact VERTEX main)
 CompileShader(graph/shadowmappingpass_dir_fs FRAGMENT main)
 CompileShader(graph/shadowmappingpass_dir_gs GEOMETRY main)
 
@@ -36,6 +39,9 @@ CompileShader(graph/skyboxpass_fs FRAGMENT main)
 CompileShader(graph/wireframepass_vs VERTEX main)
 CompileShader(graph/wireframepass_fs FRAGMENT main)
 
+CompileShader(graph/particlepass_vs VERTEX main)
+CompileShader(graph/particlepass_fs FRAGMENT main)
+
 CompileShader(ren2d/vs_multi VERTEX main)
 CompileShader(ren2d/fs_multi FRAGMENT main)
 
@@ -5,6 +5,7 @@ option(DRIVER_OPENGL "Build the OpenGL gpu driver" ON)
 option(DRIVER_VULKAN "Build the Vulkan gpu driver" ON)
 option(DRIVER_BOX2D "Build the box2d physics driver" ON)
 option(DRIVER_BULLET3 "Build the bullet3 physics driver"  ON)
+option(DRIVER_BULLET3_MULTITHREADED "Build bullet3 with BT_THREADSAFE to support the multithreaded dynamics world"  OFF) # Depends on DRIVER_BULLET3
 option(DRIVER_OPENAL "Build the OpenAL audio driver"  ON)
 option(DRIVER_FREETYPE "Build the FreeType font rendering driver"  ON)
 option(DRIVER_ASSIMP "Build the AssImp resource parser driver (For 3D asset file formats)"  ON)
@@ -111,6 +112,11 @@ if (DRIVER_BULLET3)
             BulletDynamics BulletCollision LinearMath)
 endif ()
 
+if (DRIVER_BULLET3_MULTITHREADED)
+    # The engine has to see the same BT_THREADSAFE definition as the bullet libraries because it changes the class layouts.
+    add_compile_definitions(BT_THREADSAFE=1)
+endif ()
+
 if (DRIVER_OPENAL)
     CompileDriver(DRIVER_OPENAL
             openal-soft
@@ -5,6 +5,11 @@ set(CMAKE_CXX_STANDARD_REQUIRED ON)
 
 find_package(Threads REQUIRED)
 
+option(XENGINE_SIMD "Use the SSE / AVX / NEON math kernels if supported by the target, otherwise the scalar fallbacks are used" ON)
+if (NOT XENGINE_SIMD)
+    add_compile_definitions(XENGINE_SIMD_DISABLE)
+endif ()
+
 set(RELEASE_COMPILER_FLAGS)
 set(DEBUG_COMPILER_FLAGS)
 
@@ -37,6 +37,70 @@ add_executable(test-physics2d ${BASE_SOURCE_DIR}/tests/physics2d/src/main.cpp)
 target_include_directories(test-physics2d PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/physics2d/src/ ${SHADER_COMPILED_DIR} ${TESTS_COMMON_DIR})
 target_link_libraries(test-physics2d Threads::Threads xengine)
 
+add_executable(test-mathbenchmark ${BASE_SOURCE_DIR}/tests/mathbenchmark/src/main.cpp)
+target_include_directories(test-mathbenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/mathbenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-mathbenchmark Threads::Threads xengine)
+
+add_executable(test-particlebenchmark ${BASE_SOURCE_DIR}/tests/particlebenchmark/src/main.cpp)
+target_include_directories(test-particlebenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/particlebenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-particlebenchmark Threads::Threads xengine)
+
+add_executable(test-pakbenchmark ${BASE_SOURCE_DIR}/tests/pakbenchmark/src/main.cpp)
+target_include_directories(test-pakbenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/pakbenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-pakbenchmark Threads::Threads xengine)
+
+add_executable(test-scenebenchmark ${BASE_SOURCE_DIR}/tests/scenebenchmark/src/main.cpp)
+target_include_directories(test-scenebenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/scenebenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-scenebenchmark Threads::Threads xengine)
+
+add_executable(test-lightclusterbenchmark ${BASE_SOURCE_DIR}/tests/lightclusterbenchmark/src/main.cpp)
+target_include_directories(test-lightclusterbenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/lightclusterbenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-lightclusterbenchmark Threads::Threads xengine)
+
+add_executable(test-resourcehandlebenchmark ${BASE_SOURCE_DIR}/tests/resourcehandlebenchmark/src/main.cpp)
+target_include_directories(test-resourcehandlebenchmark PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/resourcehandlebenchmark/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-resourcehandlebenchmark Threads::Threads xengine)
+
+add_executable(test-meshsimplifier ${BASE_SOURCE_DIR}/tests/meshsimplifier/src/main.cpp)
+target_include_directories(test-meshsimplifier PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/meshsimplifier/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-meshsimplifier Threads::Threads xengine)
+
+add_executable(test-meshoptimizer ${BASE_SOURCE_DIR}/tests/meshoptimizer/src/main.cpp)
+target_include_directories(test-meshoptimizer PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/meshoptimizer/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-meshoptimizer Threads::Threads xengine)
+
+add_executable(test-vertexquantizer ${BASE_SOURCE_DIR}/tests/vertexquantizer/src/main.cpp)
+target_include_directories(test-vertexquantizer PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/vertexquantizer/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-vertexquantizer Threads::Threads xengine)
+
+add_executable(test-texturecooker ${BASE_SOURCE_DIR}/tests/texturecooker/src/main.cpp)
+target_include_directories(test-texturecooker PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/texturecooker/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-texturecooker Threads::Threads xengine)
+
+add_executable(test-packedtextureatlas ${BASE_SOURCE_DIR}/tests/packedtextureatlas/src/main.cpp)
+target_include_directories(test-packedtextureatlas PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/packedtextureatlas/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-packedtextureatlas Threads::Threads xengine)
+
+add_executable(test-bonepalette ${BASE_SOURCE_DIR}/tests/bonepalette/src/main.cpp)
+target_include_directories(test-bonepalette PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/bonepalette/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-bonepalette Threads::Threads xengine)
+
+add_executable(test-resourcecache ${BASE_SOURCE_DIR}/tests/resourcecache/src/main.cpp)
+target_include_directories(test-resourcecache PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/resourcecache/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-resourcecache Threads::Threads xengine)
+
+add_executable(test-resourcestreamer ${BASE_SOURCE_DIR}/tests/resourcestreamer/src/main.cpp)
+target_include_directories(test-resourcestreamer PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/resourcestreamer/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-resourcestreamer Threads::Threads xengine)
+
+add_executable(test-shadowmapcache ${BASE_SOURCE_DIR}/tests/shadowmapcache/src/main.cpp)
+target_include_directories(test-shadowmapcache PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/shadowmapcache/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-shadowmapcache Threads::Threads xengine)
+
+add_executable(test-meshlodselector ${BASE_SOURCE_DIR}/tests/meshlodselector/src/main.cpp)
+target_include_directories(test-meshlodselector PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/tests/meshlodselector/src/ ${TESTS_COMMON_DIR})
+target_link_libraries(test-meshlodselector Threads::Threads xengine)
+
 if (MSVC)
     target_compile_options(test-framegraph PUBLIC /bigobj)
     target_compile_options(test-skeletalanimation PUBLIC /bigobj)
@@ -46,6 +110,22 @@ if (MSVC)
     target_compile_options(test-mandelbrot PUBLIC /bigobj)
     target_compile_options(test-shadows PUBLIC /bigobj)
     target_compile_options(test-physics3d PUBLIC /bigobj)
+    target_compile_options(test-mathbenchmark PUBLIC /bigobj)
+    target_compile_options(test-particlebenchmark PUBLIC /bigobj)
+    target_compile_options(test-pakbenchmark PUBLIC /bigobj)
+    target_compile_options(test-scenebenchmark PUBLIC /bigobj)
+    target_compile_options(test-lightclusterbenchmark PUBLIC /bigobj)
+    target_compile_options(test-resourcehandlebenchmark PUBLIC /bigobj)
+    target_compile_options(test-meshsimplifier PUBLIC /bigobj)
+    target_compile_options(test-meshoptimizer PUBLIC /bigobj)
+    target_compile_options(test-vertexquantizer PUBLIC /bigobj)
+    target_compile_options(test-texturecooker PUBLIC /bigobj)
+    target_compile_options(test-packedtextureatlas PUBLIC /bigobj)
+    target_compile_options(test-bonepalette PUBLIC /bigobj)
+    target_compile_options(test-resourcecache PUBLIC /bigobj)
+    target_compile_options(test-resourcestreamer PUBLIC /bigobj)
+    target_compile_options(test-shadowmapcache PUBLIC /bigobj)
+    target_compile_options(test-meshlodselector PUBLIC /bigobj)
 endif ()
 
 file(GLOB RESULT ${TESTS_ASSET_DIR}/*)
@@ -0,0 +1,5 @@
+# The texture cooker used for converting images into cooked textures (.xtex) with generated mip maps and block compression.
+
+add_executable(texturecooker ${BASE_SOURCE_DIR}/texturecooker/src/main.cpp)
+target_include_directories(texturecooker PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/texturecooker/src/)
+target_link_libraries(texturecooker Threads::Threads xengine)
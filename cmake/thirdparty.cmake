@@ -32,6 +32,7 @@ endif ()
 
 if (DRIVER_BULLET3)
     set(BUILD_UNIT_TESTS OFF CACHE BOOL "" FORCE)
+    set(BULLET2_MULTITHREADING ${DRIVER_BULLET3_MULTITHREADED} CACHE BOOL "" FORCE)
     add_thirdparty_subdir(${THIRD_PARTY_BASE}/bullet3/)
     add_thirdparty_include(${THIRD_PARTY_BASE}/bullet3/src/)
 endif ()
@@ -31,6 +31,8 @@
 
 #include "xng/math/matrixmath.hpp"
 
+#include "xng/log/log.hpp"
+
 namespace xng {
     static Mat4f convertMat4(const aiMatrix4x4 &mat) {
         Mat4f ret;
@@ -321,10 +323,12 @@ namespace xng {
         return ret;
     }
 
-    static ResourceBundle readAsset(const std::vector<char> &assetBuffer,
+    static ResourceBundle readAsset(const ReadBuffer &assetBuffer,
                                     const std::string &hint,
                                     const Uri &path,
-                                    Archive *archive) {
+                                    Archive *archive,
+                                    const MeshSimplifier::LodSettings &lodSettings,
+                                    bool optimizeMeshes) {
         // TODO: Implement assimp IOSystem pointing to archive
         // TODO: Automatically apply scene settings such as coordinate system and unit scale when importing, https://github.com/assimp/assimp/issues/849#issuecomment-875475292
 
@@ -392,6 +396,19 @@ namespace xng {
                 mesh.rig = getRig(*meshPtr, subMeshPtrs, scene);
             }
 
+            if (lodSettings.maxLods > 0) {
+                MeshSimplifier::generateLods(mesh, lodSettings);
+            }
+
+            if (optimizeMeshes) {
+                auto report = mesh.optimize();
+                Log::instance().log(DEBUG, "Optimized mesh " + pair.first
+                                           + " ACMR: " + std::to_string(report.before.getACMR())
+                                           + " -> " + std::to_string(report.after.getACMR())
+                                           + " ATVR: " + std::to_string(report.before.getATVR())
+                                           + " -> " + std::to_string(report.after.getATVR()));
+            }
+
             ret.add(pair.first, std::make_unique<SkinnedMesh>(mesh));
 
             mesh.vertexLayout = Mesh::getDefaultVertexLayout();
@@ -420,17 +437,14 @@ namespace xng {
                                         const std::string &hint,
                                         const std::string &path,
                                         Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
 
-        return readAsset(buffer, hint, Uri(path), archive);
+    ResourceBundle AssImpImporter::readBuffer(const ReadBuffer &buffer,
+                                              const std::string &hint,
+                                              const std::string &path,
+                                              Archive *archive) {
+        return readAsset(buffer, hint, Uri(path), archive, lodSettings, optimizeMeshes);
     }
 
     const std::set<std::string> &AssImpImporter::getSupportedFormats() const {
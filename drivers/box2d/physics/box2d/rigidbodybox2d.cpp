@@ -225,6 +225,10 @@ namespace xng {
             body->SetGravityScale(scale);
         }
 
+        bool RigidBodyBox2D::isAwake() {
+            return body->IsAwake();
+        }
+
         void RigidBodyBox2D::setMass(float mass, const Vec3f &center, const Vec3f &localInertia) {
             if (std::isnan(mass)
                 || std::isnan(center.x)
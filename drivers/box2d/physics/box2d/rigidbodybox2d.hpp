@@ -79,6 +79,8 @@ namespace xng {
             float getMass() override;
 
             void setGravityScale(float scale) override;
+
+            bool isAwake() override;
         };
     }
 }
@@ -20,6 +20,7 @@
 #include "worldbox2d.hpp"
 #include "rigidbodybox2d.hpp"
 #include "commonbox2d.hpp"
+#include "xng/math/rotation.hpp"
 
 namespace xng {
     namespace box2d {
@@ -133,5 +134,46 @@ namespace xng {
         WorldBox2D::createBody(const ColliderDesc &colliderDesc, RigidBody::RigidBodyType type) {
             return std::make_unique<RigidBodyBox2D>(*this, colliderDesc);
         }
+
+        void WorldBox2D::getStates(const std::vector<RigidBody *> &bodies, std::vector<RigidBody::State> &states) {
+            states.resize(bodies.size());
+            for (auto i = 0; i < bodies.size(); i++) {
+                const auto *body = dynamic_cast<RigidBodyBox2D &>(*bodies[i]).body;
+                const auto &transform = body->GetTransform();
+                auto angle = transform.q.GetAngle();
+                auto &state = states[i];
+                state.position = convert(transform.p);
+                state.rotation = {0, 0, radiansToDegrees(angle)};
+                state.velocity = convert(body->GetLinearVelocity());
+                state.angularVelocity = {0, 0, body->GetAngularVelocity()};
+                state.awake = body->IsAwake();
+                if (std::isnan(state.position.x)
+                    || std::isnan(state.position.y)
+                    || std::isnan(angle)) {
+                    throw std::runtime_error("Box2D returned NaN value.");
+                }
+            }
+        }
+
+        void WorldBox2D::setStates(const std::vector<RigidBody *> &bodies, const std::vector<RigidBody::State> &states) {
+            if (bodies.size() != states.size())
+                throw std::runtime_error("Number of bodies and states does not match");
+            for (auto i = 0; i < bodies.size(); i++) {
+                auto *body = dynamic_cast<RigidBodyBox2D &>(*bodies[i]).body;
+                auto &state = states[i];
+                if (std::isnan(state.position.x)
+                    || std::isnan(state.position.y)
+                    || std::isnan(state.rotation.z)
+                    || std::isnan(state.velocity.x)
+                    || std::isnan(state.velocity.y)
+                    || std::isnan(state.angularVelocity.z)) {
+                    throw std::runtime_error("Attempted to set NaN value.");
+                }
+                body->SetTransform(convert(state.position), degreesToRadians(state.rotation.z));
+                body->SetLinearVelocity(convert(state.velocity));
+                body->SetAngularVelocity(state.angularVelocity.z);
+                body->SetAwake(true);
+            }
+        }
     }
 }
\ No newline at end of file
@@ -67,6 +67,10 @@ namespace xng {
 
             RayHit rayTestClosest(const Vec3f &from, const Vec3f &to) override;
 
+            void getStates(const std::vector<RigidBody *> &bodies, std::vector<RigidBody::State> &states) override;
+
+            void setStates(const std::vector<RigidBody *> &bodies,
+                           const std::vector<RigidBody::State> &states) override;
 
             void BeginContact(b2Contact *contact) override;
 
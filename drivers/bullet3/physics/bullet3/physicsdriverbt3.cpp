@@ -24,6 +24,6 @@
 
 namespace xng {
     std::unique_ptr<World> bullet3::Bt3PhysicsDriver::createWorld() {
-        return std::make_unique<WorldBt3>();
+        return std::make_unique<WorldBt3>(multiThreaded);
     }
 }
@@ -268,6 +268,10 @@ namespace xng {
             if (scale != 1)
                 body->setGravity({0, 0, 0});
         }
+
+        bool isAwake() override {
+            return body->isActive();
+        }
     };
 }
 
@@ -0,0 +1,117 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_TASKSCHEDULERBT3_HPP
+#define XENGINE_TASKSCHEDULERBT3_HPP
+
+#include <algorithm>
+
+#include "xng/async/threadpool.hpp"
+
+#include "LinearMath/btThreads.h"
+
+namespace xng {
+    /**
+     * A bullet task scheduler which runs the parallel loops of the multithreaded dynamics world on the engine ThreadPool.
+     *
+     * The range of a loop is split into one chunk per thread, the first chunk is processed by the calling thread.
+     */
+    class TaskSchedulerBt3 : public btITaskScheduler {
+    public:
+        TaskSchedulerBt3() : btITaskScheduler("xEngine ThreadPool") {
+            numThreads = TaskSchedulerBt3::getMaxNumThreads();
+        }
+
+        ~TaskSchedulerBt3() override = default;
+
+        int getMaxNumThreads() const override {
+            return std::clamp(static_cast<int>(std::thread::hardware_concurrency()), 1, BT_MAX_THREAD_COUNT);
+        }
+
+        int getNumThreads() const override {
+            return numThreads;
+        }
+
+        void setNumThreads(int value) override {
+            numThreads = std::clamp(value, 1, getMaxNumThreads());
+        }
+
+        void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody &body) override {
+            run(iBegin, iEnd, grainSize, [&body](int begin, int end) {
+                body.forLoop(begin, end);
+                return btScalar(0);
+            });
+        }
+
+        btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody &body) override {
+            return run(iBegin, iEnd, grainSize, [&body](int begin, int end) {
+                return body.sumLoop(begin, end);
+            });
+        }
+
+    private:
+        int numThreads = 1;
+
+        template<typename F>
+        btScalar run(int iBegin, int iEnd, int grainSize, F fn) {
+            auto size = iEnd - iBegin;
+            if (size <= 0)
+                return 0;
+
+            auto chunks = std::clamp(size / std::max(1, grainSize), 1, numThreads);
+            if (chunks == 1)
+                return fn(iBegin, iEnd);
+
+            auto chunkSize = (size + chunks - 1) / chunks;
+
+            std::vector<btScalar> sums(chunks, 0);
+            std::vector<std::shared_ptr<Task>> tasks;
+            for (int chunk = 1; chunk < chunks; chunk++) {
+                auto begin = std::min(iEnd, iBegin + chunk * chunkSize);
+                auto end = std::min(iEnd, begin + chunkSize);
+                tasks.emplace_back(ThreadPool::getPool().addTask([&fn, &sums, chunk, begin, end]() {
+                    sums.at(chunk) = fn(begin, end);
+                }));
+            }
+
+            std::exception_ptr exception;
+            try {
+                sums.at(0) = fn(iBegin, std::min(iEnd, iBegin + chunkSize));
+            } catch (...) {
+                exception = std::current_exception();
+            }
+
+            for (auto &task: tasks) {
+                auto &ex = task->join();
+                if (ex && !exception)
+                    exception = ex;
+            }
+
+            if (exception)
+                std::rethrow_exception(exception);
+
+            btScalar ret = 0;
+            for (auto &sum: sums)
+                ret += sum;
+            return ret;
+        }
+    };
+}
+
+#endif //XENGINE_TASKSCHEDULERBT3_HPP
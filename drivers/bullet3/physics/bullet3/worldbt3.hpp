@@ -20,7 +20,7 @@
 #ifndef XENGINE_WORLDBT3_HPP
 #define XENGINE_WORLDBT3_HPP
 
-#include <unordered_set>
+#include <map>
 
 #include "xng/physics/world.hpp"
 
@@ -31,12 +31,53 @@
 #include "btBulletDynamicsCommon.h"
 #include "btBulletCollisionCommon.h"
 #include "BulletCollision/NarrowPhaseCollision/btRaycastCallback.h"
+
+#ifdef BT_THREADSAFE
+#include "BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h"
+#include "BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h"
+#include "BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h"
+#include "physics/bullet3/taskschedulerbt3.hpp"
+#endif
 #include "xng/util/time.hpp"
 
 namespace xng {
     class WorldBt3 : public World {
     public:
-        WorldBt3() {
+        /**
+         * @param multiThreaded If true the btDiscreteDynamicsWorldMt is used with a task scheduler backed by the engine ThreadPool,
+         * requires bullet to be built with BT_THREADSAFE (DRIVER_BULLET3_MULTITHREADED).
+         */
+        explicit WorldBt3(bool multiThreaded = false) {
+            if (multiThreaded) {
+#ifdef BT_THREADSAFE
+                static TaskSchedulerBt3 scheduler;
+                if (btGetTaskScheduler() != &scheduler) {
+                    btSetTaskScheduler(&scheduler);
+                }
+
+                btDefaultCollisionConstructionInfo info;
+                info.m_defaultMaxPersistentManifoldPoolSize = 80000;
+                info.m_defaultMaxCollisionAlgorithmPoolSize = 80000;
+                auto *collisionConfiguration = new btDefaultCollisionConfiguration(info);
+
+                auto *dispatcher = new btCollisionDispatcherMt(collisionConfiguration);
+
+                btBroadphaseInterface *overlappingPairCache = new btDbvtBroadphase();
+
+                auto *solverPool = new btConstraintSolverPoolMt(scheduler.getNumThreads());
+                auto *solver = new btSequentialImpulseConstraintSolverMt();
+
+                dynamicsWorld = new btDiscreteDynamicsWorldMt(dispatcher,
+                                                              overlappingPairCache,
+                                                              solverPool,
+                                                              solver,
+                                                              collisionConfiguration);
+                return;
+#else
+                throw std::runtime_error("Bullet3 was built without BT_THREADSAFE, enable DRIVER_BULLET3_MULTITHREADED");
+#endif
+            }
+
             ///collision configuration contains default setup for memory, collision setup. Advanced users can create their own configuration.
             auto *collisionConfiguration = new btDefaultCollisionConfiguration();
 
@@ -82,110 +123,12 @@ namespace xng {
 
         void step(DeltaTime deltaTime) override {
             dynamicsWorld->stepSimulation(deltaTime, -1);
-
-            std::unordered_set<Contact> contacts;
-
-            int numManifolds = dynamicsWorld->getDispatcher()->getNumManifolds();
-            for (int i = 0; i < numManifolds; i++) {
-                btPersistentManifold *contactManifold = dynamicsWorld->getDispatcher()->getManifoldByIndexInternal(i);
-                const auto *obA = static_cast<const btCollisionObject *>(contactManifold->getBody0());
-                const auto *obB = static_cast<const btCollisionObject *>(contactManifold->getBody1());
-
-                auto &colA = colliders.at(obA);
-                auto &colB = colliders.at(obB);
-
-                int numContacts = contactManifold->getNumContacts();
-                for (int j = 0; j < numContacts; j++) {
-                    btManifoldPoint &pt = contactManifold->getContactPoint(j);
-                    if (pt.getDistance() < 0.f) {
-                        const btVector3 &ptA = pt.getPositionWorldOnA();
-                        const btVector3 &ptB = pt.getPositionWorldOnB();
-                        const btVector3 &normalOnB = pt.m_normalWorldOnB;
-
-                        Contact c{colliders.at(obA),
-                                  colliders.at(obB),
-                                  convert(ptA),
-                                  convert(ptB),
-                                  convert(normalOnB)};
-                        contacts.insert(c);
-                        if (!existingContacts.contains(c)) {
-                            for (auto &l: listeners) {
-                                l->beginContact(c);
-                            }
-                        }
-                        existingContacts.insert(c);
-                    }
-                }
-            }
-
-            std::unordered_set<Contact> delContacts;
-
-            for (auto &c: existingContacts) {
-                if (contacts.find(c) == contacts.end()) {
-                    for (auto &l: listeners) {
-                        l->endContact(c);
-                    }
-                    delContacts.insert(c);
-                }
-            }
-
-            for (auto &d: delContacts) {
-                existingContacts.erase(d);
-            }
+            updateContacts();
         }
 
         void step(DeltaTime deltaTime, int maxSteps) override {
             dynamicsWorld->stepSimulation(deltaTime, maxSteps);
-
-            std::unordered_set<Contact> contacts;
-
-            int numManifolds = dynamicsWorld->getDispatcher()->getNumManifolds();
-            for (int i = 0; i < numManifolds; i++) {
-                btPersistentManifold *contactManifold = dynamicsWorld->getDispatcher()->getManifoldByIndexInternal(i);
-                const auto *obA = static_cast<const btCollisionObject *>(contactManifold->getBody0());
-                const auto *obB = static_cast<const btCollisionObject *>(contactManifold->getBody1());
-
-                auto &colA = colliders.at(obA);
-                auto &colB = colliders.at(obB);
-
-                int numContacts = contactManifold->getNumContacts();
-                for (int j = 0; j < numContacts; j++) {
-                    btManifoldPoint &pt = contactManifold->getContactPoint(j);
-                    if (pt.getDistance() < 0.f) {
-                        const btVector3 &ptA = pt.getPositionWorldOnA();
-                        const btVector3 &ptB = pt.getPositionWorldOnB();
-                        const btVector3 &normalOnB = pt.m_normalWorldOnB;
-
-                        Contact c{colliders.at(obA),
-                                  colliders.at(obB),
-                                  convert(ptA),
-                                  convert(ptB),
-                                  convert(normalOnB)};
-                        contacts.insert(c);
-                        if (!existingContacts.contains(c)) {
-                            for (auto &l: listeners) {
-                                l->beginContact(c);
-                            }
-                        }
-                        existingContacts.insert(c);
-                    }
-                }
-            }
-
-            std::unordered_set<Contact> delContacts;
-
-            for (auto &c: existingContacts) {
-                if (contacts.find(c) == contacts.end()) {
-                    for (auto &l: listeners) {
-                        l->endContact(c);
-                    }
-                    delContacts.insert(c);
-                }
-            }
-
-            for (auto &d: delContacts) {
-                existingContacts.erase(d);
-            }
+            updateContacts();
         }
 
         std::vector<RayHit> rayTestAll(const Vec3f &from, const Vec3f &to) override {
@@ -220,12 +163,109 @@ namespace xng {
                           &colliders.at(results.m_collisionObject)};
         }
 
+        void getStates(const std::vector<RigidBody *> &bodies, std::vector<RigidBody::State> &states) override {
+            states.resize(bodies.size());
+            for (auto i = 0; i < bodies.size(); i++) {
+                const auto *body = dynamic_cast<RigidBodyBt3 &>(*bodies[i]).body;
+                const auto &transform = body->getWorldTransform();
+                auto &state = states[i];
+                state.position = convert(transform.getOrigin());
+                state.rotation = convert(transform.getRotation()).getEulerAngles();
+                state.velocity = convert(body->getLinearVelocity());
+                state.angularVelocity = convert(body->getAngularVelocity());
+                state.awake = body->isActive();
+            }
+        }
+
+        void setStates(const std::vector<RigidBody *> &bodies, const std::vector<RigidBody::State> &states) override {
+            if (bodies.size() != states.size())
+                throw std::runtime_error("Number of bodies and states does not match");
+            for (auto i = 0; i < bodies.size(); i++) {
+                auto *body = dynamic_cast<RigidBodyBt3 &>(*bodies[i]).body;
+                auto &state = states[i];
+                btTransform transform;
+                transform.setOrigin(convert(state.position));
+                transform.setRotation(convert(Quaternion(state.rotation)));
+                body->setWorldTransform(transform);
+                body->setLinearVelocity(convert(state.velocity));
+                body->setAngularVelocity(convert(state.angularVelocity));
+                body->activate();
+            }
+        }
+
     private:
+        typedef std::pair<const btCollisionObject *, const btCollisionObject *> ContactKey;
+
         btDiscreteDynamicsWorld *dynamicsWorld;
 
         std::set<ContactListener *> listeners;
 
-        std::unordered_set<Contact> existingContacts;
+        // The touching collision object pairs, a pair begins touching when its persistent manifold
+        // has a penetrating point and stops touching when it has none.
+        std::map<ContactKey, Contact> existingContacts;
+        std::map<ContactKey, Contact> currentContacts;
+
+        /**
+         * Diff the touching pairs against the previous step and invoke the contact listeners.
+         *
+         * Contacts are keyed by the collision object pair of the persistent manifold
+         * so that jittering contact points do not generate begin / end events.
+         */
+        void updateContacts() {
+            currentContacts.clear();
+
+            auto *dispatcher = dynamicsWorld->getDispatcher();
+            int numManifolds = dispatcher->getNumManifolds();
+            for (int i = 0; i < numManifolds; i++) {
+                btPersistentManifold *contactManifold = dispatcher->getManifoldByIndexInternal(i);
+                const auto *obA = static_cast<const btCollisionObject *>(contactManifold->getBody0());
+                const auto *obB = static_cast<const btCollisionObject *>(contactManifold->getBody1());
+
+                // Use the deepest point of the manifold as the representative point of the contact
+                int deepest = -1;
+                int numContacts = contactManifold->getNumContacts();
+                for (int j = 0; j < numContacts; j++) {
+                    auto distance = contactManifold->getContactPoint(j).getDistance();
+                    if (distance < 0.f
+                        && (deepest < 0 || distance < contactManifold->getContactPoint(deepest).getDistance())) {
+                        deepest = j;
+                    }
+                }
+
+                if (deepest < 0)
+                    continue;
+
+                const btManifoldPoint &pt = contactManifold->getContactPoint(deepest);
+
+                ContactKey key = obA < obB ? ContactKey(obA, obB) : ContactKey(obB, obA);
+                if (currentContacts.find(key) != currentContacts.end())
+                    continue;
+
+                Contact c{colliders.at(obA),
+                          colliders.at(obB),
+                          convert(pt.getPositionWorldOnA()),
+                          convert(pt.getPositionWorldOnB()),
+                          convert(pt.m_normalWorldOnB)};
+
+                currentContacts.insert({key, c});
+
+                if (existingContacts.find(key) == existingContacts.end()) {
+                    for (auto &l: listeners) {
+                        l->beginContact(c);
+                    }
+                }
+            }
+
+            for (auto &pair: existingContacts) {
+                if (currentContacts.find(pair.first) == currentContacts.end()) {
+                    for (auto &l: listeners) {
+                        l->endContact(pair.second);
+                    }
+                }
+            }
+
+            std::swap(existingContacts, currentContacts);
+        }
 
         std::map<const btCollisionObject *, ColliderBt3> colliders;
 
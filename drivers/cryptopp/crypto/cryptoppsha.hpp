@@ -49,6 +49,29 @@ namespace xng {
         std::string sha256(const std::vector<char> &data) override {
             return sha256(data.data(), data.size());
         }
+
+        std::unique_ptr<Hasher> createSha256() override {
+            class CryptoPPHasher : public Hasher {
+            public:
+                void update(const char *data, size_t length) override {
+                    hash.Update((const CryptoPP::byte *) data, length);
+                }
+
+                std::string final() override {
+                    std::string tmp;
+                    std::string ret;
+                    CryptoPP::HexEncoder encoder(new CryptoPP::StringSink(ret));
+                    tmp.resize(hash.DigestSize());
+                    hash.Final((CryptoPP::byte *) &tmp[0]);
+                    CryptoPP::StringSource(tmp, true, new CryptoPP::Redirector(encoder));
+                    return ret;
+                }
+
+            private:
+                CryptoPP::SHA256 hash;
+            };
+            return std::make_unique<CryptoPPHasher>();
+        }
     };
 }
 
@@ -922,21 +922,62 @@ namespace xng::opengl {
                     oglDebugStartGroup("Copy Texture Array");
 
                     if (count > 0) {
+                        for (auto level = 0; level < src.desc.textureDesc.mipMapLevels; level++) {
+                            glCopyImageSubData(src.handle,
+                                               GL_TEXTURE_2D_ARRAY,
+                                               level,
+                                               0,
+                                               0,
+                                               0,
+                                               target.handle,
+                                               GL_TEXTURE_2D_ARRAY,
+                                               level,
+                                               0,
+                                               0,
+                                               0,
+                                               std::max(1, src.desc.textureDesc.size.x >> level),
+                                               std::max(1, src.desc.textureDesc.size.y >> level),
+                                               static_cast<GLsizei>(count));
+                        }
+                    }
+
+                    oglDebugEndGroup();
+
+                    oglCheckError();
+
+                    break;
+                }
+                case Command::COPY_TEXTURE_ARRAY_REGION: {
+                    auto data = std::get<TextureArrayBufferRegionCopy>(c.data);
+
+                    auto &target = dynamic_cast<OGLTextureArrayBuffer &>(*data.target);
+                    auto &src = dynamic_cast<OGLTextureArrayBuffer &>(*data.source);
+                    if (src.desc.textureDesc.format != target.desc.textureDesc.format
+                        || data.mipMapLevels > src.desc.textureDesc.mipMapLevels
+                        || data.mipMapLevels > target.desc.textureDesc.mipMapLevels
+                        || data.sourceIndex >= src.desc.textureCount
+                        || data.targetIndex >= target.desc.textureCount) {
+                        throw std::runtime_error("Cannot copy texture array buffer region");
+                    }
+
+                    oglDebugStartGroup("Copy Texture Array Region");
+
+                    for (auto level = 0; level < data.mipMapLevels; level++) {
                         glCopyImageSubData(src.handle,
                                            GL_TEXTURE_2D_ARRAY,
-                                           0,
-                                           0,
-                                           0,
-                                           0,
+                                           level,
+                                           data.sourceOffset.x >> level,
+                                           data.sourceOffset.y >> level,
+                                           static_cast<GLint>(data.sourceIndex),
                                            target.handle,
                                            GL_TEXTURE_2D_ARRAY,
-                                           0,
-                                           0,
-                                           0,
-                                           0,
-                                           src.desc.textureDesc.size.x,
-                                           src.desc.textureDesc.size.y,
-                                           static_cast<GLsizei>(count));
+                                           level,
+                                           data.targetOffset.x >> level,
+                                           data.targetOffset.y >> level,
+                                           static_cast<GLint>(data.targetIndex),
+                                           std::max(1, data.size.x >> level),
+                                           std::max(1, data.size.y >> level),
+                                           1);
                     }
 
                     oglDebugEndGroup();
@@ -180,6 +180,12 @@ namespace xng::opengl {
             throw std::runtime_error("Not Implemented");
         }
 
+        std::unique_ptr<RenderPipeline> createRenderPipeline(const RenderPipelineDesc &desc,
+                                                             const std::vector<uint8_t> &cacheData,
+                                                             ShaderDecompiler &decompiler) override {
+            return std::make_unique<OGLRenderPipeline>(desc, cacheData, decompiler);
+        }
+
         std::unique_ptr<ComputePipeline> createComputePipeline(const ComputePipelineDesc &desc,
                                                                ShaderDecompiler &decompiler) override {
             return std::make_unique<OGLComputePipeline>( desc, decompiler);
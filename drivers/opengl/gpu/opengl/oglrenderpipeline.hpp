@@ -23,6 +23,7 @@
 #include "xng/gpu/renderpipeline.hpp"
 
 #include <utility>
+#include <cstring>
 
 #include "oglinclude.hpp"
 
@@ -128,12 +129,43 @@ namespace xng::opengl {
             }
             glAttachShader(programHandle, fsH);
 
+            glProgramParameteri(programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
             glLinkProgram(programHandle);
 
             glDeleteShader(vsH);
             glDeleteShader(fsH);
         }
 
+        /**
+         * @param data The format of the binary followed by the data returned from glGetProgramBinary
+         * @return False if the driver rejected the binary
+         */
+        bool loadBinary(const std::vector<uint8_t> &data) {
+            if (data.size() <= sizeof(GLenum))
+                return false;
+
+            GLenum format;
+            std::memcpy(&format, data.data(), sizeof(GLenum));
+
+            programHandle = glCreateProgram();
+            glProgramBinary(programHandle,
+                            format,
+                            data.data() + sizeof(GLenum),
+                            static_cast<GLsizei>(data.size() - sizeof(GLenum)));
+
+            GLint success;
+            glGetProgramiv(programHandle, GL_LINK_STATUS, &success);
+            if (!success) {
+                glDeleteProgram(programHandle);
+                programHandle = 0;
+                // Rejected binaries raise GL_INVALID_ENUM, which must not be reported after the fallback build
+                while (glGetError() != GL_NO_ERROR) {}
+                return false;
+            }
+            return true;
+        }
+
         void buildSPIRV() {
             programHandle = glCreateProgram();
 
@@ -233,6 +265,23 @@ namespace xng::opengl {
             oglCheckError();
         }
 
+        OGLRenderPipeline(RenderPipelineDesc descArg,
+                          const std::vector<uint8_t> &cacheData,
+                          ShaderDecompiler &decompiler)
+                : desc(std::move(descArg)) {
+            oglDebugStartGroup("Render Pipeline Constructor");
+
+            // Binaries are rejected when the driver changed, in which case the program is built from the description.
+            if (!desc.shaders.empty() && !loadBinary(cacheData)) {
+                buildGLSL(decompiler);
+                checkLinkSuccess();
+            }
+
+            oglDebugEndGroup();
+
+            oglCheckError();
+        }
+
         ~OGLRenderPipeline() override {
             glDeleteProgram(programHandle);
 
@@ -262,7 +311,21 @@ namespace xng::opengl {
         }
 
         std::vector<uint8_t> cache() override {
-            throw std::runtime_error("Not Implemented");
+            GLint length = 0;
+            glGetProgramiv(programHandle, GL_PROGRAM_BINARY_LENGTH, &length);
+            if (length <= 0)
+                return {};
+
+            std::vector<uint8_t> ret(sizeof(GLenum) + length);
+            GLenum format;
+            GLsizei written = 0;
+            glGetProgramBinary(programHandle, length, &written, &format, ret.data() + sizeof(GLenum));
+            std::memcpy(ret.data(), &format, sizeof(GLenum));
+            ret.resize(sizeof(GLenum) + written);
+
+            oglCheckError();
+
+            return ret;
         }
     };
 }
@@ -112,12 +112,11 @@ namespace xng::opengl {
                 }
                 case RenderTargetAttachment::ATTACHMENT_TEXTUREARRAY: {
                     auto &tex = dynamic_cast<OGLTextureArrayBuffer &>(*att.textureArrayBuffer);
-                    glFramebufferTexture3D(GL_FRAMEBUFFER,
-                                           attachment,
-                                           convert(tex.getDescription().textureDesc.textureType),
-                                           tex.handle,
-                                           static_cast<GLint>(att.mipMapLevel),
-                                           static_cast<GLint>(att.index));
+                    glFramebufferTextureLayer(GL_FRAMEBUFFER,
+                                              attachment,
+                                              tex.handle,
+                                              static_cast<GLint>(att.mipMapLevel),
+                                              static_cast<GLint>(att.index));
                     break;
                 }
                 case RenderTargetAttachment::ATTACHMENT_TEXTUREARRAY_CUBEMAP: {
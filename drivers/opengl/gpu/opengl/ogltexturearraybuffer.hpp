@@ -173,8 +173,8 @@ namespace xng::opengl {
                             0,
                             0,
                             static_cast<GLint>(index),
-                            desc.textureDesc.size.x,
-                            desc.textureDesc.size.y,
+                            std::max(1, desc.textureDesc.size.x >> mipMapLevel),
+                            std::max(1, desc.textureDesc.size.y >> mipMapLevel),
                             1,
                             convert(format),
                             GL_UNSIGNED_BYTE,
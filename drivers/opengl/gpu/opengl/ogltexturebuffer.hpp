@@ -204,15 +204,7 @@ namespace xng::opengl {
 
             glBindTexture(GL_TEXTURE_2D, handle);
 
-            glTexSubImage2D(GL_TEXTURE_2D,
-                            mipMapLevel,
-                            0,
-                            0,
-                            desc.size.x,
-                            desc.size.y,
-                            convert(format),
-                            GL_UNSIGNED_BYTE,
-                            buffer);
+            uploadLevel(GL_TEXTURE_2D, format, buffer, bufferSize, mipMapLevel);
 
             glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -240,15 +232,7 @@ namespace xng::opengl {
 
             glBindTexture(GL_TEXTURE_CUBE_MAP, handle);
 
-            glTexSubImage2D(convert(face),
-                            mipMapLevel,
-                            0,
-                            0,
-                            desc.size.x,
-                            desc.size.y,
-                            convert(format),
-                            GL_UNSIGNED_BYTE,
-                            buffer);
+            uploadLevel(convert(face), format, buffer, bufferSize, mipMapLevel);
 
             glBindTexture(GL_TEXTURE_CUBE_MAP, 0);
 
@@ -302,6 +286,10 @@ namespace xng::opengl {
         }
 
         void generateMipMaps() override {
+            if (isBlockCompressed(desc.format)) {
+                throw std::runtime_error("Mip maps of block compressed textures must be uploaded");
+            }
+
             oglDebugStartGroup("Texture Buffer Generate Mip Maps");
 
             glBindTexture(textureType, handle);
@@ -314,6 +302,63 @@ namespace xng::opengl {
 
             oglCheckError();
         }
+
+    private:
+        void uploadLevel(GLenum target,
+                         ColorFormat format,
+                         const uint8_t *buffer,
+                         size_t bufferSize,
+                         int mipMapLevel) {
+            auto width = std::max(1, desc.size.x >> mipMapLevel);
+            auto height = std::max(1, desc.size.y >> mipMapLevel);
+            if (isBlockCompressed(format)) {
+                if (format != desc.format) {
+                    throw std::runtime_error("Block compressed upload format does not match the texture format");
+                }
+                if (bufferSize != getBlockCompressedSize(format, width, height)) {
+                    throw std::runtime_error("Invalid block compressed buffer size");
+                }
+                glCompressedTexSubImage2D(target,
+                                          mipMapLevel,
+                                          0,
+                                          0,
+                                          width,
+                                          height,
+                                          convert(format),
+                                          static_cast<GLsizei>(bufferSize),
+                                          buffer);
+            } else {
+                size_t channels;
+                switch (format) {
+                    case R:
+                        channels = 1;
+                        break;
+                    case RG:
+                        channels = 2;
+                        break;
+                    case RGB:
+                        channels = 3;
+                        break;
+                    case RGBA:
+                        channels = 4;
+                        break;
+                    default:
+                        throw std::runtime_error("Unsupported upload format");
+                }
+                if (bufferSize < static_cast<size_t>(width) * static_cast<size_t>(height) * channels) {
+                    throw std::runtime_error("Invalid buffer size");
+                }
+                glTexSubImage2D(target,
+                                mipMapLevel,
+                                0,
+                                0,
+                                width,
+                                height,
+                                convert(format),
+                                GL_UNSIGNED_BYTE,
+                                buffer);
+            }
+        }
     };
 }
 
@@ -78,6 +78,12 @@ namespace xng::opengl {
                     return GL_FLOAT;
                 case VertexAttribute::DOUBLE:
                     return GL_DOUBLE;
+                case VertexAttribute::UNSIGNED_SHORT:
+                    return GL_UNSIGNED_SHORT;
+                case VertexAttribute::SIGNED_SHORT:
+                    return GL_SHORT;
+                case VertexAttribute::HALF_FLOAT:
+                    return GL_HALF_FLOAT;
                 default:
                     throw std::runtime_error("Invalid component");
             }
@@ -203,11 +209,11 @@ namespace xng::opengl {
             for (int i = 0; i < desc.vertexLayout.attributes.size(); i++) {
                 auto &binding = desc.vertexLayout.attributes.at(i);
                 glEnableVertexAttribArray(i);
-                if (binding.component > VertexAttribute::SIGNED_INT) {
+                if (binding.normalized || !VertexAttribute::isInteger(binding.component)) {
                     glVertexAttribPointer(i,
                                           VertexAttribute::getCount(binding.type),
                                           getType(binding.component),
-                                          GL_FALSE,
+                                          binding.normalized ? GL_TRUE : GL_FALSE,
                                           vertexStride,
                                           (void *) (currentOffset));
                 } else {
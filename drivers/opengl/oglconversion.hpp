@@ -25,6 +25,14 @@
 #include "xng/render/geometry/primitive.hpp"
 #include "xng/gpu/drawcall.hpp"
 
+// S3TC is exposed through EXT_texture_compression_s3tc which is not part of the generated glad headers.
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT1_EXT 0x83F1
+#endif
+#ifndef GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+#define GL_COMPRESSED_RGBA_S3TC_DXT5_EXT 0x83F3
+#endif
+
 namespace xng::opengl {
     static GLenum getColorAttachment(int index) {
         return GL_COLOR_ATTACHMENT0 + index;
@@ -319,6 +327,14 @@ namespace xng::opengl {
                 return GL_RGB32UI;
             case RGBA32UI:
                 return GL_RGBA32UI;
+            case BC1_RGBA:
+                return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case BC3_RGBA:
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case BC5_RG:
+                return GL_COMPRESSED_RG_RGTC2;
+            case BC7_RGBA:
+                return GL_COMPRESSED_RGBA_BPTC_UNORM;
             default:
                 throw std::runtime_error("Unrecognized color format");
         }
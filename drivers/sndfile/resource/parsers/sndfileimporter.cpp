@@ -17,6 +17,7 @@
  *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
  */
 
+#include <algorithm>
 #include <limits>
 #include <vector>
 #include <cstring>
@@ -32,7 +33,7 @@
 
 namespace xng {
     struct LibSndBuffer {
-        std::vector<char> data;
+        const ReadBuffer &data;
         size_t pos;
     };
 
@@ -61,10 +62,10 @@ namespace xng {
 
     sf_count_t sf_vio_read(void *ptr, sf_count_t count, void *user_data) {
         auto *buffer = reinterpret_cast<LibSndBuffer *>(user_data);
-        sf_count_t ret;
-        for (ret = 0; ret < count && buffer->pos + ret < buffer->data.size(); ret++) {
-            static_cast<char *>(ptr)[ret] = buffer->data.at(buffer->pos + ret);
-        }
+        if (buffer->pos >= buffer->data.size())
+            return 0;
+        auto ret = std::min(count, static_cast<sf_count_t>(buffer->data.size() - buffer->pos));
+        std::memcpy(ptr, buffer->data.data() + buffer->pos, static_cast<size_t>(ret));
         buffer->pos += ret;
         return ret;
     }
@@ -78,7 +79,7 @@ namespace xng {
         return buffer->pos;
     }
 
-    static AudioData readAudio(const std::vector<char> &buf) {
+    static AudioData readAudio(const ReadBuffer &buf) {
         SF_VIRTUAL_IO virtio;
         virtio.get_filelen = &sf_vio_get_filelen;
         virtio.seek = &sf_vio_seek;
@@ -149,16 +150,13 @@ namespace xng {
                                          const std::string &hint,
                                          const std::string &path,
                                          Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
 
+    ResourceBundle SndFileImporter::readBuffer(const ReadBuffer &buffer,
+                                               const std::string &hint,
+                                               const std::string &path,
+                                               Archive *archive) {
         ResourceBundle ret;
         ret.add("", std::make_unique<AudioData>(readAudio(buffer)));
         return ret;
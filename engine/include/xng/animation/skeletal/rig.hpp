@@ -55,7 +55,13 @@ namespace xng {
 
         Bone &getBone(const std::string &name) { return bones.at(boneNameMapping.at(name)); }
 
-        bool hasBone(const std::string &name) { return boneNameMapping.find(name) != boneNameMapping.end(); }
+        bool hasBone(const std::string &name) const { return boneNameMapping.find(name) != boneNameMapping.end(); }
+
+        /**
+         * @param name
+         * @return The index of the bone in getBones()
+         */
+        size_t getBoneIndex(const std::string &name) const { return boneNameMapping.at(name); }
 
         Bone &getParentBone(const std::string &name) {
             return bones.at(boneNameMapping.at(boneParentMapping.at(name)));
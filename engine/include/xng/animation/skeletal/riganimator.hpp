@@ -21,6 +21,7 @@
 #define XENGINE_RIGANIMATOR_HPP
 
 #include <memory>
+#include <limits>
 
 #include "rig.hpp"
 #include "riganimation.hpp"
@@ -55,8 +56,9 @@ namespace xng {
          * Advance the animation channels by deltaTime and update the animated rig.
          *
          * @param deltaTime
+         * @param maxBoneDepth Bones deeper than maxBoneDepth in the hierarchy are not animated and keep their bind pose relative to their parent.
          */
-        void update(DeltaTime deltaTime);
+        void update(DeltaTime deltaTime, size_t maxBoneDepth = std::numeric_limits<size_t>::max());
 
         /**
          *
@@ -80,12 +82,17 @@ namespace xng {
          */
         void setAnimationSpeed(float speed, size_t channel = 0);
 
-        const std::map<std::string, Mat4f> &getBoneTransforms() { return boneTransforms; }
+        /**
+         * @return The skinning transforms of the bones in the order of Rig::getBones(), empty before the first update
+         */
+        const std::vector<Mat4f> &getBoneTransforms() { return boneTransforms; }
 
     private:
         Rig rig;
 
-        std::map<std::string, Mat4f> boneTransforms;
+        std::map<std::string, size_t> boneDepths; // The depth of each bone in the hierarchy, root bones have a depth of 0
+
+        std::vector<Mat4f> boneTransforms;
 
         std::map<size_t, RigChannel> channels;
     };
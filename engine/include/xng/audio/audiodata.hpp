@@ -39,6 +39,10 @@ namespace xng {
             return typeid(AudioData);
         }
 
+        size_t getMemoryUsage() const override {
+            return buffer.size();
+        }
+
         std::vector<uint8_t> buffer;
         AudioFormat format;
         unsigned int frequency;
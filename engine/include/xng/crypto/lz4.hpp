@@ -0,0 +1,55 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_LZ4_HPP
+#define XENGINE_LZ4_HPP
+
+#include <vector>
+#include <cstddef>
+
+namespace xng {
+    /**
+     * Built in fast compression using the LZ4 block format.
+     *
+     * Compresses worse than GZip but decompresses several times faster, intended for hot data.
+     */
+    class XENGINE_EXPORT LZ4 {
+    public:
+        /**
+         * @param data
+         * @param length
+         * @return The compressed block
+         */
+        static std::vector<char> compress(const char *data, size_t length);
+
+        /**
+         * Decompress a block into output.
+         *
+         * Throws if the block is corrupt or does not decompress to exactly outputLength bytes.
+         *
+         * @param data The compressed block
+         * @param length The size of the compressed block
+         * @param output The output buffer
+         * @param outputLength The decompressed size of the block
+         */
+        static void decompress(const char *data, size_t length, char *output, size_t outputLength);
+    };
+}
+
+#endif //XENGINE_LZ4_HPP
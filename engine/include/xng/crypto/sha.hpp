@@ -22,6 +22,7 @@
 
 #include <string>
 #include <vector>
+#include <memory>
 
 namespace xng {
     /**
@@ -29,6 +30,21 @@ namespace xng {
      */
     class SHA {
     public:
+        /**
+         * Incremental hashing of data which is not available at once.
+         */
+        class Hasher {
+        public:
+            virtual ~Hasher() = default;
+
+            virtual void update(const char *data, size_t length) = 0;
+
+            /**
+             * @return The hash of all data passed to update, in the same format as sha256()
+             */
+            virtual std::string final() = 0;
+        };
+
         virtual ~SHA() = default;
 
         virtual std::string sha256(const char *data, size_t length) = 0;
@@ -36,6 +52,33 @@ namespace xng {
         virtual std::string sha256(const std::string &data) = 0;
 
         virtual std::string sha256(const std::vector<char> &data) = 0;
+
+        /**
+         * Create an incremental SHA256 hasher.
+         *
+         * The default implementation collects the data and hashes it with sha256() in final().
+         *
+         * @return
+         */
+        virtual std::unique_ptr<Hasher> createSha256() {
+            class BufferedHasher : public Hasher {
+            public:
+                explicit BufferedHasher(SHA &sha) : sha(sha) {}
+
+                void update(const char *data, size_t length) override {
+                    buffer.insert(buffer.end(), data, data + length);
+                }
+
+                std::string final() override {
+                    return sha.sha256(buffer);
+                }
+
+            private:
+                SHA &sha;
+                std::vector<char> buffer;
+            };
+            return std::make_unique<BufferedHasher>(*this);
+        }
     };
 }
 
@@ -22,15 +22,35 @@
 
 #include "xng/resource/resourceimporter.hpp"
 
+#include "xng/render/geometry/meshsimplifier.hpp"
+
 namespace xng {
     class XENGINE_EXPORT AssImpImporter : public ResourceImporter {
     public:
+        AssImpImporter() = default;
+
+        /**
+         * @param lodSettings The settings for generating the levels of detail of imported meshes, maxLods = 0 disables the generation.
+         * @param optimizeMeshes If true the imported meshes are optimized for the vertex cache, overdraw and vertex fetch
+         */
+        explicit AssImpImporter(const MeshSimplifier::LodSettings &lodSettings, bool optimizeMeshes = true)
+                : lodSettings(lodSettings), optimizeMeshes(optimizeMeshes) {}
+
         ResourceBundle read(std::istream &stream,
                             const std::string &hint,
                             const std::string &path,
                             Archive *archive) override;
 
+        ResourceBundle readBuffer(const ReadBuffer &buffer,
+                                  const std::string &hint,
+                                  const std::string &path,
+                                  Archive *archive) override;
+
         const std::set<std::string> &getSupportedFormats() const override;
+
+    private:
+        MeshSimplifier::LodSettings lodSettings;
+        bool optimizeMeshes = true;
     };
 }
 
@@ -26,7 +26,18 @@ namespace xng {
     namespace bullet3 {
         class XENGINE_EXPORT Bt3PhysicsDriver : public PhysicsDriver {
         public:
+            Bt3PhysicsDriver() = default;
+
+            /**
+             * @param multiThreaded If true the created worlds step the simulation in parallel on the engine ThreadPool.
+             * Requires the driver to be built with DRIVER_BULLET3_MULTITHREADED.
+             */
+            explicit Bt3PhysicsDriver(bool multiThreaded) : multiThreaded(multiThreaded) {}
+
             std::unique_ptr<World> createWorld() override;
+
+        private:
+            bool multiThreaded = false;
         };
     }
 }
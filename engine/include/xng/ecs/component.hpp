@@ -21,6 +21,7 @@
 #define XENGINE_COMPONENT_HPP
 
 #include "xng/io/messageable.hpp"
+#include "xng/io/protocol/binaryprotocol.hpp"
 
 namespace xng {
     /**
@@ -45,6 +46,26 @@ namespace xng {
             return message;
         }
 
+        /**
+         * Write the component to the binary scene format.
+         *
+         * The default implementation writes the message representation of the component,
+         * components which are stored in large numbers should override serialize and deserialize
+         * to write their fields directly.
+         */
+        virtual void serialize(BinaryWriter &writer) const {
+            Message message(Message::DICTIONARY);
+            *this >> message;
+            BinaryProtocol::writeMessage(writer, message);
+        }
+
+        /**
+         * Read the component from the data written by serialize.
+         */
+        virtual void deserialize(BinaryReader &reader) {
+            *this << BinaryProtocol::readMessage(reader);
+        }
+
         bool operator==(const Component &other) const = default;
 
         bool enabled = true;
@@ -26,6 +26,7 @@
 #include <memory>
 
 #include "xng/io/message.hpp"
+#include "xng/io/binarystream.hpp"
 
 #include "component.hpp"
 
@@ -64,6 +65,18 @@ bool r_##type = xng::ComponentRegistry::instance().registerComponent(typeid(type
                                                                                  scene.updateComponent(ent,\
                                                                                                        dynamic_cast<const type &>(\
                                                                                                                value));\
+                                                                             },\
+                                                                             [](const xng::EntityScene &scene,\
+                                                                                xng::EntityHandle ent,\
+                                                                                xng::BinaryWriter &writer) {\
+                                                                                 scene.getComponent<type>(ent).serialize(writer);\
+                                                                             },\
+                                                                             [](xng::EntityScene &scene,\
+                                                                                xng::EntityHandle ent,\
+                                                                                xng::BinaryReader &reader) {\
+                                                                                 type comp;\
+                                                                                 comp.deserialize(reader);\
+                                                                                 scene.createComponent(ent, comp);\
                                                                              });
 
 #define UNREGISTER_COMPONENT(type) xng::ComponentRegistry::instance().unregisterComponent(typeid(type));
@@ -80,6 +93,8 @@ namespace xng {
         typedef std::function<void(EntityScene &, EntityHandle, const Message &)> Deserializer;
         typedef std::function<void(EntityScene &scene, EntityHandle ent)> Constructor;
         typedef std::function<void(EntityScene &scene, EntityHandle ent, const Component &value)> Updater;
+        typedef std::function<void(const EntityScene &, EntityHandle, BinaryWriter &)> BinarySerializer;
+        typedef std::function<void(EntityScene &, EntityHandle, BinaryReader &)> BinaryDeserializer;
 
         /**
          * @return The component registry instance with the engine components already registered.
@@ -93,6 +108,18 @@ namespace xng {
                                const Constructor &constructor,
                                const Updater &updater) noexcept;
 
+        /**
+         * Register a component type with direct binary serialization.
+         */
+        bool registerComponent(std::type_index type,
+                               const std::string &typeName,
+                               const Serializer &serializer,
+                               const Deserializer &deserializer,
+                               const Constructor &constructor,
+                               const Updater &updater,
+                               const BinarySerializer &binarySerializer,
+                               const BinaryDeserializer &binaryDeserializer) noexcept;
+
         void unregisterComponent(std::type_index type) noexcept;
 
         const std::type_index &getTypeFromName(const std::string &typeName);
@@ -109,6 +136,10 @@ namespace xng {
 
         const Updater &getUpdater(const std::type_index &index);
 
+        const BinarySerializer &getBinarySerializer(const std::type_index &index);
+
+        const BinaryDeserializer &getBinaryDeserializer(const std::type_index &index);
+
         const std::map<std::type_index, std::string> &getComponents();
 
     private:
@@ -121,6 +152,8 @@ namespace xng {
         std::map<std::type_index, Deserializer> deserializers;
         std::map<std::type_index, Constructor> constructors;
         std::map<std::type_index, Updater> updaters;
+        std::map<std::type_index, BinarySerializer> binarySerializers;
+        std::map<std::type_index, BinaryDeserializer> binaryDeserializers;
     };
 }
 
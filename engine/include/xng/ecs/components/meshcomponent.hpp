@@ -55,6 +55,21 @@ namespace xng {
             return message;
         }
 
+        void serialize(BinaryWriter &writer) const override {
+            writer.writeBool(enabled);
+            writer.writeBool(castShadows);
+            writer.writeBool(receiveShadows);
+            writer.writeKey(mesh.getUri().empty() ? std::string() : mesh.getUri().toString());
+        }
+
+        void deserialize(BinaryReader &reader) override {
+            enabled = reader.readBool();
+            castShadows = reader.readBool();
+            receiveShadows = reader.readBool();
+            auto &uri = reader.readKey();
+            mesh = uri.empty() ? ResourceHandle<Mesh>() : ResourceHandle<Mesh>(Uri(uri));
+        }
+
         std::type_index getType() const override {
             return typeid(MeshComponent);
         }
@@ -20,18 +20,33 @@
 #ifndef XENGINE_PARTICLECOMPONENT_HPP
 #define XENGINE_PARTICLECOMPONENT_HPP
 
+#include <memory>
+
 #include "xng/io/messageable.hpp"
 #include "xng/ecs/component.hpp"
+#include "xng/render/particles/particleemitter.hpp"
+#include "xng/render/particles/particlepool.hpp"
 
 namespace xng {
-    // TODO: Design particle rendering interface
+    /**
+     * A particle emitter which is simulated by the ParticleSystem.
+     *
+     * The emitter origin is the position of the TransformComponent of the entity.
+     */
     struct XENGINE_EXPORT ParticleComponent : public Component {
+        ParticleEmitter emitter;
+
+        // The particles in draw order written by the ParticleSystem, not serialized.
+        std::shared_ptr<const std::vector<ParticleInstance>> instances;
+
         Messageable &operator<<(const Message &message) override {
+            message.value("emitter", emitter);
             return Component::operator<<(message);
         }
 
         Message &operator>>(Message &message) const override {
             message = Message(Message::DICTIONARY);
+            emitter >> message["emitter"];
             return Component::operator>>(message);
         }
 
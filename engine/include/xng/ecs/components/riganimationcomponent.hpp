@@ -53,7 +53,7 @@ namespace xng {
 
         std::map<size_t, Channel> channels;
 
-        std::map<std::string, Mat4f> boneTransforms;
+        std::vector<Mat4f> boneTransforms; // The skinning transforms in the order of the bones in the rig
 
         bool operator==(const RigAnimationComponent &other) const {
             return enabled == other.enabled
@@ -47,6 +47,28 @@ namespace xng {
             return Component::operator>>(message);
         }
 
+        void serialize(BinaryWriter &writer) const override {
+            writer.writeBool(enabled);
+            auto &position = transform.getPosition();
+            auto &rotation = transform.getRotation();
+            auto &scale = transform.getScale();
+            const float values[] = {position.x, position.y, position.z,
+                                    rotation.w, rotation.x, rotation.y, rotation.z,
+                                    scale.x, scale.y, scale.z};
+            writer.write(values, sizeof(values));
+            writer.writeKey(parent);
+        }
+
+        void deserialize(BinaryReader &reader) override {
+            enabled = reader.readBool();
+            float values[10];
+            reader.read(values, sizeof(values));
+            transform.setPosition(Vec3f(values[0], values[1], values[2]));
+            transform.setRotation(Quaternion(values[3], values[4], values[5], values[6]));
+            transform.setScale(Vec3f(values[7], values[8], values[9]));
+            parent = reader.readKey();
+        }
+
         std::type_index getType() const override {
             return typeid(TransformComponent);
         }
@@ -31,10 +31,14 @@
 #include "xng/ecs/componentregistry.hpp"
 
 #include "xng/io/messageable.hpp"
+#include "xng/io/binarystream.hpp"
 
 namespace xng {
     class Entity;
 
+    static const std::string BINARY_SCENE_VERSION = "01";
+    static const std::string BINARY_SCENE_MAGIC = "\xa9scn\xff" + BINARY_SCENE_VERSION + "\xa9";
+
     class XENGINE_EXPORT EntityScene : public Resource, public Messageable {
     public:
         class XENGINE_EXPORT Listener {
@@ -328,10 +332,12 @@ namespace xng {
 
         Messageable &operator<<(const Message &message) override {
             message.value("name", name);
-            if (message.getMessage("entities").getType() == Message::LIST) {
-                for (auto &msg: message.getMessage("entities").asList()) {
+            const Message none;
+            auto &entityList = message.getMessage("entities", none);
+            if (entityList.getType() == Message::LIST) {
+                entityList.forEachElement([this](const Message &msg) {
                     deserializeEntity(msg);
-                }
+                });
             }
             return *this;
         }
@@ -361,6 +367,23 @@ namespace xng {
 
         void deserializeEntity(const Message &message);
 
+        /**
+         * Write the scene in the binary scene format.
+         *
+         * Registered components are written through the binary serializers of the component registry
+         * without creating message trees.
+         *
+         * @param writer
+         */
+        void serialize(BinaryWriter &writer) const;
+
+        /**
+         * Read a scene written by serialize and add its entities to this scene.
+         *
+         * @param reader
+         */
+        void deserialize(BinaryReader &reader);
+
     private:
         std::set<int> idStore;
         int idCounter = 0;
@@ -0,0 +1,64 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef XENGINE_PARTICLESYSTEM_HPP
+#define XENGINE_PARTICLESYSTEM_HPP
+
+#include "xng/ecs/system.hpp"
+
+#include "xng/ecs/components/particlecomponent.hpp"
+#include "xng/render/particles/particlepool.hpp"
+
+namespace xng {
+    /**
+     * The particle system simulates the emitters of all entities with a ParticleComponent and a TransformComponent.
+     *
+     * Each emitter owns a ParticlePool, the resulting particle instances are sorted back to front relative
+     * to the active camera and written to ParticleComponent.instances from where they are picked up by the MeshRenderSystem.
+     */
+    class XENGINE_EXPORT ParticleSystem : public System, public EntityScene::Listener {
+    public:
+        ParticleSystem() = default;
+
+        ~ParticleSystem() override = default;
+
+        void start(EntityScene &scene, EventBus &eventBus) override;
+
+        void stop(EntityScene &scene, EventBus &eventBus) override;
+
+        void update(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus) override;
+
+        std::string getName() override { return "ParticleSystem"; }
+
+        void onComponentDestroy(const EntityHandle &entity, const Component &component) override;
+
+        void onEntityDestroy(const EntityHandle &entity) override;
+
+    private:
+        struct EmitterState {
+            ParticlePool pool;
+            float spawnAccumulator = 0;
+            uint64_t seed = 0;
+        };
+
+        std::map<EntityHandle, EmitterState> emitters;
+    };
+}
+
+#endif //XENGINE_PARTICLESYSTEM_HPP
@@ -26,7 +26,15 @@
 #include "xng/physics/world.hpp"
 #include "xng/util/time.hpp"
 
+#include "xng/ecs/components/rigidbodycomponent.hpp"
+
 namespace xng {
+    /**
+     * The physics system synchronizes the RigidBodyComponent and TransformComponent of entities with the physics world.
+     *
+     * Only bodies whose transform, velocity or mass properties were changed since the last synchronization are written to the world,
+     * and only bodies which are awake or were modified are written back to the components.
+     */
     class XENGINE_EXPORT PhysicsSystem : public System, public EntityScene::Listener, public World::ContactListener {
     public:
         PhysicsSystem(World &world, float scale, float timeStep);
@@ -62,6 +70,23 @@ namespace xng {
         void endContact(const World::Contact &contact) override;
 
     private:
+        /**
+         * The values of a body which were last synchronized between the components and the world.
+         */
+        struct BodyState {
+            Vec3f position; // The position in the TransformComponent (unscaled)
+            Quaternion rotation;
+            Vec3f velocity;
+            Vec3f angularVelocity;
+            float mass = 0;
+            Vec3f massCenter;
+            Vec3f rotationalInertia;
+            RigidBody::RigidBodyType type = RigidBody::STATIC;
+            bool forceWriteBack = false; // If true the components are updated even if the body is sleeping
+        };
+
+        void applyForces(RigidBody &rb, const RigidBodyComponent &comp) const;
+
         World &world;
         EventBus *bus = nullptr;
 
@@ -70,6 +95,16 @@ namespace xng {
         std::map<EntityHandle, std::vector<std::unique_ptr<Collider>>> colliders;
         std::map<Collider *, size_t> colliderIndices;
 
+        std::map<EntityHandle, BodyState> bodyStates;
+
+        // Reused between updates to avoid reallocation
+        std::vector<RigidBody *> writeBodies;
+        std::vector<RigidBody::State> writeStates;
+        std::vector<EntityHandle> forceEntities;
+        std::vector<EntityHandle> readEntities;
+        std::vector<RigidBody *> readBodies;
+        std::vector<RigidBody::State> readStates;
+
         float scale = 20; // The number of units which correspond to a metre in the physics world.
         float timeStep = 0; // The duration of one physics world step
         float deltaAccumulator = 0;
@@ -26,9 +26,48 @@
 #include "xng/animation/skeletal/riganimator.hpp"
 #include "xng/util/time.hpp"
 
+#include <chrono>
+
 namespace xng {
+    /**
+     * The rig animation system evaluates the rig animators of all entities with a RigAnimationComponent and a SkinnedMeshComponent.
+     *
+     * Rigs are assigned a level of detail based on the distance of the entity to the active camera.
+     * Distant rigs are evaluated at a reduced frequency and with a limited bone depth,
+     * the evaluation of rigs which share an update interval is spread across frames.
+     *
+     * If a budget is set the total evaluation time per frame is capped and rigs that did not fit into the budget
+     * are evaluated with priority in the following frames.
+     */
     class XENGINE_EXPORT RigAnimationSystem : public System, public EntityScene::Listener {
     public:
+        struct LodLevel {
+            float distance = 0; // The minimum distance between the rig and the camera at which this level is used
+            int updateInterval = 1; // The rig is evaluated every updateInterval frames
+            size_t maxBoneDepth = std::numeric_limits<size_t>::max(); // Bones deeper than this are not animated
+        };
+
+        struct LodSettings {
+            // Sorted by ascending distance, the first level must have a distance of 0.
+            std::vector<LodLevel> levels = {
+                    {0, 1},
+                    {25, 2},
+                    {50, 4, 6},
+                    {100, 8, 3},
+            };
+
+            // The maximum time per frame spent evaluating rigs, zero means unlimited.
+            std::chrono::microseconds budget{0};
+
+            // If true the bone transforms of rigs are interpolated between evaluations,
+            // interpolated poses trail the evaluated pose by one update interval.
+            bool interpolate = false;
+        };
+
+        RigAnimationSystem() = default;
+
+        explicit RigAnimationSystem(LodSettings settings);
+
         ~RigAnimationSystem() override = default;
 
         void start(EntityScene &scene, EventBus &eventBus) override;
@@ -49,8 +88,26 @@ namespace xng {
 
         void onEntityDestroy(const EntityHandle &entity) override;
 
+        const LodSettings &getLodSettings() const { return settings; }
+
+        void setLodSettings(const LodSettings &value) { settings = value; }
+
     private:
-        std::map<EntityHandle, RigAnimator> rigAnimators;
+        struct RigState {
+            RigAnimator animator;
+            Duration pendingTime; // The accumulated delta time which has not been applied to the animator yet
+            int framesSinceUpdate = 0;
+            bool deferred = false; // True if the rig was due but skipped because the budget was exhausted
+            std::vector<Mat4f> previousTransforms;
+        };
+
+        size_t getLodLevel(float distance) const;
+
+        LodSettings settings;
+
+        std::map<EntityHandle, RigState> rigs;
+
+        unsigned long frame = 0;
     };
 }
 
@@ -41,6 +41,10 @@ namespace xng {
         std::type_index getTypeIndex() const override {
             return typeid(Font);
         }
+
+        size_t getMemoryUsage() const override {
+            return data.size();
+        }
     };
 }
 #endif //XENGINE_FONTDATA_HPP
@@ -60,6 +60,7 @@ namespace xng {
             BIND_SHADER_RESOURCES,
             BIND_VERTEX_ARRAY_OBJECT,
             COPY_TEXTURE_ARRAY,
+            COPY_TEXTURE_ARRAY_REGION,
             COPY_TEXTURE,
             COPY_INDEX_BUFFER,
             COPY_VERTEX_BUFFER,
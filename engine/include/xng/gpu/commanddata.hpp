@@ -157,6 +157,35 @@ namespace xng {
                                                                                          target(target) {}
     };
 
+    struct TextureArrayBufferRegionCopy {
+        TextureArrayBuffer *source;
+        TextureArrayBuffer *target;
+        size_t sourceIndex;
+        size_t targetIndex;
+        Vec2i sourceOffset;
+        Vec2i targetOffset;
+        Vec2i size;
+        int mipMapLevels;
+
+        TextureArrayBufferRegionCopy() = default;
+
+        TextureArrayBufferRegionCopy(TextureArrayBuffer *source,
+                                     TextureArrayBuffer *target,
+                                     size_t sourceIndex,
+                                     size_t targetIndex,
+                                     Vec2i sourceOffset,
+                                     Vec2i targetOffset,
+                                     Vec2i size,
+                                     int mipMapLevels) : source(source),
+                                                         target(target),
+                                                         sourceIndex(sourceIndex),
+                                                         targetIndex(targetIndex),
+                                                         sourceOffset(sourceOffset),
+                                                         targetOffset(targetOffset),
+                                                         size(size),
+                                                         mipMapLevels(mipMapLevels) {}
+    };
+
     struct TextureBufferCopy {
         TextureBuffer *source;
         TextureBuffer *target;
@@ -253,6 +282,7 @@ namespace xng {
             RenderPipelineBind,
             ShaderResourceBind,
             TextureArrayBufferCopy,
+            TextureArrayBufferRegionCopy,
             TextureBufferCopy,
             VertexArrayObjectBind,
             VertexBufferCopy,
@@ -94,6 +94,23 @@ namespace xng {
 
         virtual std::unique_ptr<RenderPipeline> createRenderPipeline(const uint8_t *cacheData, size_t size) = 0;
 
+        /**
+         * Create a pipeline from the data previously returned by RenderPipeline::cache() for the same description.
+         *
+         * Implementations must fall back to building the pipeline from the description if the data is rejected,
+         * for example because the driver was updated.
+         *
+         * @param desc The description of the pipeline
+         * @param cacheData The data returned by RenderPipeline::cache()
+         * @param decompiler The decompiler used if the pipeline has to be built from the description
+         * @return
+         */
+        virtual std::unique_ptr<RenderPipeline> createRenderPipeline(const RenderPipelineDesc &desc,
+                                                                     const std::vector<uint8_t> &cacheData,
+                                                                     ShaderDecompiler &decompiler) {
+            return createRenderPipeline(desc, decompiler);
+        }
+
         virtual std::unique_ptr<ComputePipeline> createComputePipeline(const ComputePipelineDesc &desc,
                                                                        ShaderDecompiler &decompiler) = 0;
 
@@ -46,6 +46,10 @@ namespace xng {
             return {Command::BIND_SHADER_RESOURCES, ShaderResourceBind(std::move(resources))};
         }
 
+        /**
+         * @return The driver specific data from which the pipeline can be recreated with RenderDevice::createRenderPipeline,
+         * or an empty vector if the driver does not support caching pipelines.
+         */
         virtual std::vector<uint8_t> cache() = 0;
 
         virtual const RenderPipelineDesc &getDescription() = 0;
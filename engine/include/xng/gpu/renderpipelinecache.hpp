@@ -0,0 +1,117 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_RENDERPIPELINECACHE_HPP
+#define XENGINE_RENDERPIPELINECACHE_HPP
+
+#include <filesystem>
+#include <list>
+#include <unordered_map>
+
+#include "xng/gpu/renderdevice.hpp"
+
+#include "xng/shader/shaderdecompilercache.hpp"
+
+namespace xng {
+    /**
+     * Keeps render pipelines alive across frames so that passes which are toggled or skipped for some frames
+     * do not decompile and link their shaders again.
+     *
+     * Pipelines are keyed by a stable hash of their description, descriptions with colliding hashes are chained.
+     * Pipelines which were not used in the current frame are destroyed in least recently used order
+     * when the number of cached pipelines exceeds the capacity.
+     *
+     * If a directory is set the decompiled shader sources and the data returned by RenderPipeline::cache()
+     * are additionally stored on disk and reused by later runs of the application.
+     */
+    class XENGINE_EXPORT RenderPipelineCache {
+    public:
+        /**
+         * @param device
+         * @param decompiler
+         * @param capacity The number of pipelines kept alive, pipelines used in the current frame are never destroyed.
+         * @param directory The directory for the on disk cache, if empty the cache is kept in memory only.
+         */
+        RenderPipelineCache(RenderDevice &device,
+                            ShaderDecompiler &decompiler,
+                            size_t capacity = 256,
+                            const std::filesystem::path &directory = {});
+
+        RenderPipelineCache(const RenderPipelineCache &other) = delete;
+
+        RenderPipelineCache &operator=(const RenderPipelineCache &other) = delete;
+
+        /**
+         * Get or create the pipeline for the description and mark it as used in the current frame.
+         *
+         * @param desc
+         * @return
+         */
+        RenderPipeline &get(const RenderPipelineDesc &desc);
+
+        /**
+         * Destroy the least recently used pipelines over capacity and begin a new frame.
+         */
+        void collect();
+
+        void clear();
+
+        size_t size() const { return entries.size(); }
+
+        size_t getCapacity() const { return capacity; }
+
+        void setCapacity(size_t value) { capacity = value; }
+
+        void setDirectory(const std::filesystem::path &directory);
+
+        /**
+         * @return The caching decompiler used for creating the pipelines.
+         */
+        ShaderDecompiler &getDecompiler() { return decompilerCache; }
+
+        /**
+         * @param desc
+         * @return A hash of all properties of the description which does not change between runs.
+         */
+        static uint64_t getStableHash(const RenderPipelineDesc &desc);
+
+    private:
+        struct Entry {
+            uint64_t key = 0;
+            RenderPipelineDesc desc;
+            std::unique_ptr<RenderPipeline> pipeline;
+            size_t frame = 0;
+        };
+
+        std::unique_ptr<RenderPipeline> create(const RenderPipelineDesc &desc, uint64_t key, bool persistent);
+
+        RenderDevice &device;
+        ShaderDecompilerCache decompilerCache;
+
+        size_t capacity;
+        std::filesystem::path directory;
+        uint64_t deviceHash;
+
+        size_t frame = 0;
+        std::list<Entry> lru; // Most recently used first
+        std::unordered_multimap<uint64_t, std::list<Entry>::iterator> entries;
+    };
+}
+
+#endif //XENGINE_RENDERPIPELINECACHE_HPP
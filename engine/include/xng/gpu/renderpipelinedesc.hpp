@@ -80,8 +80,12 @@ namespace xng {
         bool operator==(const RenderPipelineDesc &other) const {
             return bindings == other.bindings
                    && shaders == other.shaders
+                   && primitive == other.primitive
+                   && vertexLayout == other.vertexLayout
+                   && instanceArrayLayout == other.instanceArrayLayout
                    && multiSample == other.multiSample
                    && multiSampleEnableFrequency == other.multiSampleEnableFrequency
+                   && multiSampleFrequency == other.multiSampleFrequency
                    && enableDepthTest == other.enableDepthTest
                    && depthTestWrite == other.depthTestWrite
                    && depthTestMode == other.depthTestMode
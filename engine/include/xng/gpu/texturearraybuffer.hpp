@@ -46,6 +46,41 @@ namespace xng {
             return {Command::COPY_TEXTURE_ARRAY, TextureArrayBufferCopy(&source, this)};
         }
 
+        /**
+         * Copy a rectangle of one texture in the source array into a texture of this array.
+         *
+         * The offsets and size are specified in texels of mip map level 0 and are shifted right for each
+         * subsequent level, they should therefore be multiples of 1 << (mipMapLevels - 1).
+         *
+         * The source may be this array as long as the source and target rectangles do not overlap.
+         *
+         * @param source
+         * @param sourceIndex
+         * @param targetIndex
+         * @param sourceOffset
+         * @param targetOffset
+         * @param size
+         * @param mipMapLevels The number of mip map levels starting at level 0 to copy
+         * @return
+         */
+        Command copy(TextureArrayBuffer &source,
+                     size_t sourceIndex,
+                     size_t targetIndex,
+                     Vec2i sourceOffset,
+                     Vec2i targetOffset,
+                     Vec2i size,
+                     int mipMapLevels) {
+            return {Command::COPY_TEXTURE_ARRAY_REGION,
+                    TextureArrayBufferRegionCopy(&source,
+                                                 this,
+                                                 sourceIndex,
+                                                 targetIndex,
+                                                 sourceOffset,
+                                                 targetOffset,
+                                                 size,
+                                                 mipMapLevels)};
+        }
+
         /**
          * Upload the image buffer.
          *
@@ -20,6 +20,9 @@
 #ifndef XENGINE_TEXTUREPROPERTIES_HPP
 #define XENGINE_TEXTUREPROPERTIES_HPP
 
+#include <algorithm>
+#include <stdexcept>
+
 #include "xng/io/message.hpp"
 
 namespace xng {
@@ -110,8 +113,59 @@ namespace xng {
         RG32UI,
         RGB32UI,
         RGBA32UI,
+
+        //Block compressed formats, data is stored in 4x4 pixel blocks
+        BC1_RGBA, // 8 bytes per block, rgb565 endpoints with 1 bit alpha
+        BC3_RGBA, // 16 bytes per block, BC1 color with interpolated 8 bit alpha
+        BC5_RG, // 16 bytes per block, two independently interpolated 8 bit channels
+        BC7_RGBA, // 16 bytes per block, high quality rgba
     };
 
+    /**
+     * @param format
+     * @return True if the format stores 4x4 pixel blocks which are uploaded without conversion
+     */
+    inline bool isBlockCompressed(ColorFormat format) {
+        switch (format) {
+            case BC1_RGBA:
+            case BC3_RGBA:
+            case BC5_RG:
+            case BC7_RGBA:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /**
+     * @param format
+     * @return The number of bytes of a single 4x4 block of the block compressed format
+     */
+    inline size_t getBlockCompressedBlockSize(ColorFormat format) {
+        switch (format) {
+            case BC1_RGBA:
+                return 8;
+            case BC3_RGBA:
+            case BC5_RG:
+            case BC7_RGBA:
+                return 16;
+            default:
+                throw std::runtime_error("Color format is not block compressed");
+        }
+    }
+
+    /**
+     * @param format
+     * @param width
+     * @param height
+     * @return The number of bytes of a width * height image in the block compressed format
+     */
+    inline size_t getBlockCompressedSize(ColorFormat format, int width, int height) {
+        return static_cast<size_t>((std::max(width, 1) + 3) / 4)
+               * static_cast<size_t>((std::max(height, 1) + 3) / 4)
+               * getBlockCompressedBlockSize(format);
+    }
+
     enum TextureWrapping : int {
         REPEAT = 0,
         MIRRORED_REPEAT,
@@ -42,7 +42,10 @@ namespace xng {
             UNSIGNED_INT, // 4 Byte unsigned
             SIGNED_INT, // 4 Byte signed
             FLOAT, // 4 Byte float
-            DOUBLE // 8 Byte double
+            DOUBLE, // 8 Byte double
+            UNSIGNED_SHORT, // 2 Byte unsigned
+            SIGNED_SHORT, // 2 Byte signed
+            HALF_FLOAT // 2 Byte float
         };
 
         static int getBytes(Component type) {
@@ -50,6 +53,10 @@ namespace xng {
                 case UNSIGNED_BYTE:
                 case SIGNED_BYTE:
                     return 1;
+                case UNSIGNED_SHORT:
+                case SIGNED_SHORT:
+                case HALF_FLOAT:
+                    return 2;
                 case UNSIGNED_INT:
                 case SIGNED_INT:
                 case FLOAT:
@@ -61,6 +68,24 @@ namespace xng {
             }
         }
 
+        /**
+         * @param type
+         * @return True if the component is an integer type which is passed to the shader as an integer unless normalized
+         */
+        static bool isInteger(Component type) {
+            switch (type) {
+                case UNSIGNED_BYTE:
+                case SIGNED_BYTE:
+                case UNSIGNED_INT:
+                case SIGNED_INT:
+                case UNSIGNED_SHORT:
+                case SIGNED_SHORT:
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
         static int getCount(Type count) {
             switch (count) {
                 case SINGLE:
@@ -87,17 +112,23 @@ namespace xng {
 
         VertexAttribute() = default;
 
-        VertexAttribute(Type type, Component component, size_t offset = 0) : type(type),
-                                                                         component(component),
-                                                                         offset(offset) {}
+        VertexAttribute(Type type, Component component, size_t offset = 0, bool normalized = false)
+                : type(type),
+                  component(component),
+                  offset(offset),
+                  normalized(normalized) {}
 
         bool operator==(const VertexAttribute &other) const {
-            return type == other.type && component == other.component && offset == other.offset;
+            return type == other.type
+                   && component == other.component
+                   && offset == other.offset
+                   && normalized == other.normalized;
         }
 
         Type type;
         Component component;
         size_t offset; // The offset that is applied to the attribute pointer.
+        bool normalized = false; // If true integer components are mapped to floats in the range [0, 1] for unsigned and [-1, 1] for signed components.
     };
 }
 #endif //XENGINE_VERTEXATTRIBUTE_HPP
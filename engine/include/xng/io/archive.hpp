@@ -23,6 +23,8 @@
 #include <iostream>
 #include <memory>
 
+#include "xng/io/readbuffer.hpp"
+
 namespace xng {
     /**
      * Archive interface, implementations may be directories or custom archive format.
@@ -35,6 +37,19 @@ namespace xng {
 
         virtual std::unique_ptr<std::istream> open(const std::string &name) = 0;
 
+        /**
+         * Open a contiguous read only view of the data at name.
+         *
+         * Implementations should override this to return a view without intermediate copies (eg. memory mapped files).
+         * The default implementation reads the stream returned by open() into memory.
+         *
+         * @param name
+         * @return
+         */
+        virtual ReadBuffer openBuffer(const std::string &name) {
+            return ReadBuffer::fromStream(*open(name));
+        }
+
         virtual std::unique_ptr<std::iostream> openRW(const std::string &name) = 0;
     };
 }
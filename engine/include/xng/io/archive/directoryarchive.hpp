@@ -20,6 +20,8 @@
 #ifndef XENGINE_DIRECTORYARCHIVE_HPP
 #define XENGINE_DIRECTORYARCHIVE_HPP
 
+#include <filesystem>
+
 #include "xng/io/archive.hpp"
 
 namespace xng {
@@ -39,6 +41,12 @@ namespace xng {
 
         std::unique_ptr<std::istream> open(const std::string &path) override;
 
+        /**
+         * @param path
+         * @return A view of the memory mapped file
+         */
+        ReadBuffer openBuffer(const std::string &path) override;
+
         std::unique_ptr<std::iostream> openRW(const std::string &path) override;
 
     private:
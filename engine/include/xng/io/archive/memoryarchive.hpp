@@ -22,7 +22,6 @@
 
 #include <map>
 #include <vector>
-#include <sstream>
 
 #include "xng/io/archive.hpp"
 
@@ -38,10 +37,11 @@ namespace xng {
         }
 
         std::unique_ptr<std::istream> open(const std::string &path) override {
-            auto buf = data.at(path);
-            auto ret = new std::stringstream(std::string(buf.begin(), buf.end()));
-            std::noskipws(*ret);
-            return std::unique_ptr<std::istream>(dynamic_cast<std::istream *>(ret));
+            return std::make_unique<ReadBufferStream>(openBuffer(path));
+        }
+
+        ReadBuffer openBuffer(const std::string &path) override {
+            return ReadBuffer(data.at(path));
         }
 
         std::unique_ptr<std::iostream> openRW(const std::string &path) override {
@@ -51,7 +51,7 @@ namespace xng {
         void addData(const std::string &path, const std::vector<uint8_t> &bytes) {
             if (data.find(path) != data.end())
                 throw std::runtime_error("Data already exists at " + path);
-            data[path] = bytes;
+            data[path] = std::make_shared<const std::vector<uint8_t>>(bytes);
         }
 
         void removeData(const std::string &path) {
@@ -59,7 +59,7 @@ namespace xng {
         }
 
     private:
-        std::map<std::string, std::vector<uint8_t>> data;
+        std::map<std::string, std::shared_ptr<const std::vector<uint8_t>>> data;
     };
 }
 #endif //XENGINE_MEMORYARCHIVE_HPP
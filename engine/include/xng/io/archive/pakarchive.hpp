@@ -20,12 +20,13 @@
 #ifndef XENGINE_PAKARCHIVE_HPP
 #define XENGINE_PAKARCHIVE_HPP
 
-#include <mutex>
-
 #include "xng/io/archive.hpp"
 #include "xng/io/pak.hpp"
 
 namespace xng {
+    /**
+     * An archive reading from a pak, entries may be opened concurrently from multiple threads.
+     */
     class XENGINE_EXPORT PakArchive : public Archive {
     public:
         PakArchive() = default;
@@ -38,10 +39,11 @@ namespace xng {
 
         std::unique_ptr<std::istream> open(const std::string &path) override;
 
+        ReadBuffer openBuffer(const std::string &path) override;
+
         std::unique_ptr<std::iostream> openRW(const std::string &name) override;
 
     private:
-        std::mutex mutex;
         Pak pak;
         bool verifyHashes;
     };
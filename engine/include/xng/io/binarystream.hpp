@@ -0,0 +1,201 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_BINARYSTREAM_HPP
+#define XENGINE_BINARYSTREAM_HPP
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <cstring>
+#include <cstdint>
+#include <stdexcept>
+
+namespace xng {
+    /**
+     * Writes little endian binary values into a memory buffer.
+     *
+     * Unsigned integers are written as LEB128 varints, signed integers are zigzag encoded.
+     * Strings which are written with writeKey are interned, repeated keys are written as a table index.
+     */
+    class XENGINE_EXPORT BinaryWriter {
+    public:
+        void write(const void *ptr, size_t size) {
+            auto *p = static_cast<const char *>(ptr);
+            data.insert(data.end(), p, p + size);
+        }
+
+        void writeUInt8(uint8_t value) {
+            data.emplace_back(static_cast<char>(value));
+        }
+
+        void writeUInt(unsigned long long value) {
+            while (value >= 0x80) {
+                data.emplace_back(static_cast<char>((value & 0x7F) | 0x80));
+                value >>= 7;
+            }
+            data.emplace_back(static_cast<char>(value));
+        }
+
+        void writeInt(long long value) {
+            writeUInt((static_cast<unsigned long long>(value) << 1) ^ static_cast<unsigned long long>(value >> 63));
+        }
+
+        void writeBool(bool value) {
+            writeUInt8(value ? 1 : 0);
+        }
+
+        void writeFloat(float value) {
+            write(&value, sizeof(float));
+        }
+
+        void writeDouble(double value) {
+            write(&value, sizeof(double));
+        }
+
+        void writeString(std::string_view value) {
+            writeUInt(value.size());
+            write(value.data(), value.size());
+        }
+
+        /**
+         * Write a string which is likely to be repeated, such as a dictionary key or type name.
+         *
+         * The first occurrence is written as 0 followed by the string, following occurrences as the table index + 1.
+         */
+        void writeKey(const std::string &key) {
+            auto it = keys.find(key);
+            if (it == keys.end()) {
+                writeUInt(0);
+                writeString(key);
+                keys.emplace(key, keys.size());
+            } else {
+                writeUInt(it->second + 1);
+            }
+        }
+
+        const std::vector<char> &getData() const { return data; }
+
+        size_t size() const { return data.size(); }
+
+    private:
+        std::vector<char> data;
+        std::unordered_map<std::string, size_t> keys;
+    };
+
+    /**
+     * Reads the values written by a BinaryWriter from a memory buffer.
+     *
+     * Reading past the end of the buffer throws a std::runtime_error.
+     */
+    class XENGINE_EXPORT BinaryReader {
+    public:
+        BinaryReader(const char *data, size_t size)
+                : data(data), end(data + size) {}
+
+        void read(void *ptr, size_t size) {
+            if (static_cast<size_t>(end - data) < size)
+                throw std::runtime_error("Binary read out of range");
+            std::memcpy(ptr, data, size);
+            data += size;
+        }
+
+        uint8_t readUInt8() {
+            if (data == end)
+                throw std::runtime_error("Binary read out of range");
+            return static_cast<uint8_t>(*data++);
+        }
+
+        unsigned long long readUInt() {
+            unsigned long long ret = 0;
+            for (int shift = 0; shift < 64; shift += 7) {
+                auto byte = readUInt8();
+                ret |= static_cast<unsigned long long>(byte & 0x7F) << shift;
+                if ((byte & 0x80) == 0)
+                    return ret;
+            }
+            throw std::runtime_error("Invalid binary varint");
+        }
+
+        long long readInt() {
+            auto value = readUInt();
+            return static_cast<long long>(value >> 1) ^ -static_cast<long long>(value & 1);
+        }
+
+        bool readBool() {
+            return readUInt8() != 0;
+        }
+
+        float readFloat() {
+            float ret;
+            read(&ret, sizeof(float));
+            return ret;
+        }
+
+        double readDouble() {
+            double ret;
+            read(&ret, sizeof(double));
+            return ret;
+        }
+
+        std::string_view readStringView() {
+            auto size = readUInt();
+            if (static_cast<size_t>(end - data) < size)
+                throw std::runtime_error("Binary read out of range");
+            std::string_view ret(data, size);
+            data += size;
+            return ret;
+        }
+
+        std::string readString() {
+            return std::string(readStringView());
+        }
+
+        const std::string &readKey() {
+            auto index = readUInt();
+            if (index == 0) {
+                keys.emplace_back(readStringView());
+                return keys.back();
+            } else if (index > keys.size()) {
+                throw std::runtime_error("Invalid binary key index");
+            }
+            return keys.at(index - 1);
+        }
+
+        /**
+         * Skip the given number of bytes
+         */
+        void skip(size_t size) {
+            if (static_cast<size_t>(end - data) < size)
+                throw std::runtime_error("Binary read out of range");
+            data += size;
+        }
+
+        size_t remaining() const { return end - data; }
+
+    private:
+        const char *data;
+        const char *end;
+        std::deque<std::string> keys;
+    };
+}
+
+#endif //XENGINE_BINARYSTREAM_HPP
@@ -25,6 +25,9 @@
 #include <stdexcept>
 #include <set>
 #include <string>
+#include <string_view>
+#include <variant>
+#include <algorithm>
 
 namespace xng {
     class XENGINE_EXPORT Message;
@@ -65,210 +68,206 @@ namespace xng {
             }
         }
 
-        explicit Message(DataType type = NUL) : type(type) {}
+        explicit Message(DataType type = NUL) {
+            switch (type) {
+                case NUL:
+                    break;
+                case SIGNED_INTEGER:
+                    data.emplace<SIGNED_INTEGER>();
+                    break;
+                case UNSIGNED_INTEGER:
+                    data.emplace<UNSIGNED_INTEGER>();
+                    break;
+                case FLOAT:
+                    data.emplace<FLOAT>();
+                    break;
+                case STRING:
+                    data.emplace<STRING>();
+                    break;
+                case DICTIONARY:
+                    data.emplace<DICTIONARY>();
+                    break;
+                case LIST:
+                    data.emplace<LIST>();
+                    break;
+                default:
+                    throw std::runtime_error("Invalid data type");
+            }
+        }
+
+        Message(int value) : data(std::in_place_index<SIGNED_INTEGER>, value) {}
 
-        Message(int value) : type(SIGNED_INTEGER) { ival = value; }
+        Message(long value) : data(std::in_place_index<SIGNED_INTEGER>, value) {}
 
-        Message(long value) : type(SIGNED_INTEGER) { ival = value; }
+        Message(long long value) : data(std::in_place_index<SIGNED_INTEGER>, value) {}
 
-        Message(long long value) : type(SIGNED_INTEGER) { ival = value; }
+        Message(unsigned int value) : data(std::in_place_index<UNSIGNED_INTEGER>, value) {}
 
-        Message(unsigned int value) : type(UNSIGNED_INTEGER) { uival = value; }
+        Message(unsigned long value) : data(std::in_place_index<UNSIGNED_INTEGER>, value) {}
 
-        Message(unsigned long value) : type(UNSIGNED_INTEGER) { uival = value; }
+        Message(unsigned long long value) : data(std::in_place_index<UNSIGNED_INTEGER>, value) {}
 
-        Message(unsigned long long value) : type(UNSIGNED_INTEGER) { uival = value; }
+        Message(float value) : data(std::in_place_index<FLOAT>, value) {}
 
-        Message(float value) : type(FLOAT) { fval = value; }
+        Message(double value) : data(std::in_place_index<FLOAT>, value) {}
 
-        Message(double value) : type(FLOAT) { fval = value; }
+        Message(const std::string &value) : data(std::in_place_index<STRING>, value) {}
 
-        Message(const std::string &value) : type(STRING) { sval = value; }
+        Message(const std::map<std::string, Message> &value)
+                : data(std::in_place_index<DICTIONARY>, value.begin(), value.end()) {}
 
-        Message(const std::map<std::string, Message> &value) : type(DICTIONARY) { mval = value; }
+        Message(const std::vector<Message> &value) : data(std::in_place_index<LIST>, value) {}
 
-        Message(const std::vector<Message> &value) : type(LIST) { vval = value; }
+        Message(std::vector<Message> &&value) : data(std::in_place_index<LIST>, std::move(value)) {}
 
         Message &operator[](const char *name) {
-            if (type != DICTIONARY)
-                throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return mval[name];
+            return getOrInsert(name);
         }
 
         const Message &operator[](const char *name) const {
-            if (type != DICTIONARY)
-                throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return mval.at(name);
+            return getExisting(name, "array operator");
         }
 
         Message &operator[](const std::string &name) {
-            if (type != DICTIONARY)
-                throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return mval[name];
+            return getOrInsert(name);
         }
 
         const Message &operator[](const std::string &name) const {
-            if (type != DICTIONARY)
-                throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return mval.at(name);
+            return getExisting(name, "array operator");
         }
 
         Message &operator[](int index) {
-            if (type != LIST)
-                throw std::runtime_error("Type error");
-            if (vval.size() >= index)
+            if (getType() != LIST)
                 throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return vval.at(index);
+                        "Attempted to call array operator on message of type " + getDataTypeName(getType()));
+            return std::get<LIST>(data).at(index);
         }
 
         const Message &operator[](int index) const {
-            if (type != LIST)
+            if (getType() != LIST)
                 throw std::runtime_error(
-                        "Attempted to call array operator on message of type " + getDataTypeName(type));
-            return vval.at(index);
+                        "Attempted to call array operator on message of type " + getDataTypeName(getType()));
+            return std::get<LIST>(data).at(index);
         }
 
         bool has(const char *name) const {
-            if (type != DICTIONARY)
-                throw std::runtime_error("Attempted to call has on message of type " + getDataTypeName(type));
-            return mval.find(name) != mval.end();
+            if (getType() != DICTIONARY)
+                throw std::runtime_error("Attempted to call has on message of type " + getDataTypeName(getType()));
+            return find(name) != nullptr;
         }
 
         Message &at(const char *name) {
-            if (type != DICTIONARY)
-                throw std::runtime_error("Attempted to call at on message of type " + getDataTypeName(type));
-            return mval.at(name);
+            return const_cast<Message &>(getExisting(name, "at"));
         }
 
         const Message &at(const char *name) const {
-            if (type != DICTIONARY)
-                throw std::runtime_error("Attempted to call at on message of type " + getDataTypeName(type));
-            return mval.at(name);
+            return getExisting(name, "at");
         }
 
         explicit operator int() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<int>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<int>(ival);
-            } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to int");
-            }
+            return static_cast<int>(getInteger("int"));
         }
 
         explicit operator long() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<long>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<long>(ival);
-            } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to long");
-            }
+            return static_cast<long>(getInteger("long"));
         }
 
         explicit operator long long() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<long long>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<long long>(ival);
-            } else {
-                throw std::runtime_error(
-                        "Attempted to cast message of type " + getDataTypeName(type) + " to long long");
-            }
+            return getInteger("long long");
         }
 
         explicit  operator unsigned int() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<unsigned int>(uival);
-            } else {
-                throw std::runtime_error(
-                        "Attempted to cast message of type " + getDataTypeName(type) + " to unsigned int");
-            }
+            return static_cast<unsigned int>(getUnsignedInteger("unsigned int"));
         }
 
         explicit  operator unsigned long() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<unsigned long>(uival);
-            } else {
-                throw std::runtime_error(
-                        "Attempted to cast message of type " + getDataTypeName(type) + " to unsigned long");
-            }
+            return static_cast<unsigned long>(getUnsignedInteger("unsigned long"));
         }
 
         explicit operator unsigned long long() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<unsigned long long>(uival);
-            } else {
-                throw std::runtime_error(
-                        "Attempted to cast message of type " + getDataTypeName(type) + " to unsigned long long");
-            }
+            return getUnsignedInteger("unsigned long long");
         }
 
         explicit operator bool() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<bool>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<bool>(ival);
-            } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to bool");
-            }
+            return static_cast<bool>(getInteger("bool"));
         }
 
         explicit operator float() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<float>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<float>(ival);
-            } else if (type == FLOAT) {
-                return static_cast<float>(fval);
-            } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to float");
-            }
+            return static_cast<float>(getNumber("float"));
         }
 
         explicit operator double() const {
-            if (type == UNSIGNED_INTEGER) {
-                return static_cast<double>(uival);
-            } else if (type == SIGNED_INTEGER) {
-                return static_cast<double>(ival);
-            } else if (type == FLOAT) {
-                return static_cast<double>(fval);
-            } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to double");
-            }
+            return getNumber("double");
         }
 
         explicit operator std::string() const {
-            if (type == STRING) {
-                return sval;
+            if (getType() == STRING) {
+                return std::get<STRING>(data);
             } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to string");
+                throw std::runtime_error(
+                        "Attempted to cast message of type " + getDataTypeName(getType()) + " to string");
             }
         }
 
         explicit operator std::map<std::string, Message>() const {
-            if (type == DICTIONARY) {
-                return mval;
+            if (getType() == DICTIONARY) {
+                auto &dictionary = std::get<DICTIONARY>(data);
+                return {dictionary.begin(), dictionary.end()};
             } else {
                 throw std::runtime_error(
-                        "Attempted to cast message of type " + getDataTypeName(type) + " to dictionary");
+                        "Attempted to cast message of type " + getDataTypeName(getType()) + " to dictionary");
             }
         }
 
         explicit  operator std::vector<Message>() const {
-            if (type == LIST) {
-                return vval;
+            if (getType() == LIST) {
+                return std::get<LIST>(data);
             } else {
-                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(type) + " to list");
+                throw std::runtime_error(
+                        "Attempted to cast message of type " + getDataTypeName(getType()) + " to list");
+            }
+        }
+
+        DataType getType() const { return static_cast<DataType>(data.index()); }
+
+        /**
+         * @return The number of elements in a DICTIONARY or LIST message
+         */
+        size_t size() const {
+            if (getType() == DICTIONARY) {
+                return std::get<DICTIONARY>(data).size();
+            } else if (getType() == LIST) {
+                return std::get<LIST>(data).size();
+            } else {
+                throw std::runtime_error("Attempted to call size on message of type " + getDataTypeName(getType()));
+            }
+        }
+
+        /**
+         * Invoke f(key, value) for each element of a DICTIONARY message in key order without copying the elements.
+         */
+        template<typename F>
+        void forEachEntry(F &&f) const {
+            if (getType() != DICTIONARY)
+                throw std::runtime_error(
+                        "Attempted to call forEachEntry on message of type " + getDataTypeName(getType()));
+            for (auto &pair: std::get<DICTIONARY>(data)) {
+                f(pair.first, pair.second);
             }
         }
 
-        DataType getType() const { return type; }
+        /**
+         * Invoke f(value) for each element of a LIST message without copying the elements.
+         */
+        template<typename F>
+        void forEachElement(F &&f) const {
+            if (getType() != LIST)
+                throw std::runtime_error(
+                        "Attempted to call forEachElement on message of type " + getDataTypeName(getType()));
+            for (auto &element: std::get<LIST>(data)) {
+                f(element);
+            }
+        }
 
         template<typename T>
         T as() const {
@@ -337,9 +336,9 @@ namespace xng {
 
         template<typename T>
         bool value(const std::string &name, T &v, const T &defaultValue = T()) const {
-            auto it = mval.find(name);
-            if (it != mval.end()) {
-                v << it->second;
+            auto *message = find(name);
+            if (message != nullptr) {
+                v << *message;
                 return true;
             } else {
                 v = defaultValue;
@@ -349,27 +348,120 @@ namespace xng {
 
         const Message &getMessageOf(const std::set<std::string> &names, const Message &defaultValue = Message()) const {
             for (auto &name: names) {
-                auto it = mval.find(name);
-                if (it != mval.end()) {
-                    return it->second;
+                auto *message = find(name);
+                if (message != nullptr) {
+                    return *message;
                 }
             }
             return defaultValue;
         }
 
         const Message &getMessage(const std::string &name, const Message &defaultValue = Message()) const {
-            return getMessageOf({name}, defaultValue);
+            auto *message = find(name);
+            return message != nullptr ? *message : defaultValue;
         }
 
     private:
-        DataType type;
-
-        long long ival = 0;
-        unsigned long long uival = 0;
-        double fval = 0;
-        std::string sval = {};
-        std::map<std::string, Message> mval = {};
-        std::vector<Message> vval = {};
+        /**
+         * Dictionaries are stored as vectors sorted by key.
+         */
+        typedef std::vector<std::pair<std::string, Message>> Dictionary;
+
+        /**
+         * The alternatives are ordered by DataType.
+         *
+         * Numbers are stored inline and short strings use the small string storage of std::string.
+         */
+        std::variant<std::monostate,
+                long long,
+                unsigned long long,
+                double,
+                std::string,
+                Dictionary,
+                std::vector<Message>> data;
+
+        /**
+         * @return The element with the given key or nullptr if this is not a dictionary or the key does not exist.
+         */
+        const Message *find(std::string_view name) const {
+            if (getType() != DICTIONARY)
+                return nullptr;
+            auto &dictionary = std::get<DICTIONARY>(data);
+            auto it = std::lower_bound(dictionary.begin(),
+                                       dictionary.end(),
+                                       name,
+                                       [](const std::pair<std::string, Message> &pair, std::string_view key) {
+                                           return pair.first < key;
+                                       });
+            if (it != dictionary.end() && it->first == name) {
+                return &it->second;
+            }
+            return nullptr;
+        }
+
+        const Message &getExisting(std::string_view name, const char *operation) const {
+            if (getType() != DICTIONARY)
+                throw std::runtime_error("Attempted to call " + std::string(operation) + " on message of type "
+                                         + getDataTypeName(getType()));
+            auto *ret = find(name);
+            if (ret == nullptr)
+                throw std::out_of_range("Message key not found: " + std::string(name));
+            return *ret;
+        }
+
+        Message &getOrInsert(std::string_view name) {
+            if (getType() != DICTIONARY)
+                throw std::runtime_error(
+                        "Attempted to call array operator on message of type " + getDataTypeName(getType()));
+            auto &dictionary = std::get<DICTIONARY>(data);
+            // Keys are usually inserted in order
+            if (dictionary.empty() || dictionary.back().first < name) {
+                return dictionary.emplace_back(name, Message()).second;
+            }
+            auto it = std::lower_bound(dictionary.begin(),
+                                       dictionary.end(),
+                                       name,
+                                       [](const std::pair<std::string, Message> &pair, std::string_view key) {
+                                           return pair.first < key;
+                                       });
+            if (it == dictionary.end() || it->first != name) {
+                it = dictionary.emplace(it, name, Message());
+            }
+            return it->second;
+        }
+
+        long long getInteger(const char *typeName) const {
+            if (getType() == UNSIGNED_INTEGER) {
+                return static_cast<long long>(std::get<UNSIGNED_INTEGER>(data));
+            } else if (getType() == SIGNED_INTEGER) {
+                return std::get<SIGNED_INTEGER>(data);
+            } else {
+                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(getType())
+                                         + " to " + typeName);
+            }
+        }
+
+        unsigned long long getUnsignedInteger(const char *typeName) const {
+            if (getType() == UNSIGNED_INTEGER) {
+                return std::get<UNSIGNED_INTEGER>(data);
+            } else {
+                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(getType())
+                                         + " to " + typeName);
+            }
+        }
+
+        double getNumber(const char *typeName) const {
+            if (getType() == UNSIGNED_INTEGER) {
+                return static_cast<double>(std::get<UNSIGNED_INTEGER>(data));
+            } else if (getType() == SIGNED_INTEGER) {
+                return static_cast<double>(std::get<SIGNED_INTEGER>(data));
+            } else if (getType() == FLOAT) {
+                return std::get<FLOAT>(data);
+            } else {
+                throw std::runtime_error("Attempted to cast message of type " + getDataTypeName(getType())
+                                         + " to " + typeName);
+            }
+        }
     };
 
     // Default Operators
@@ -399,11 +491,12 @@ namespace xng {
     std::vector<T> &operator<<(std::vector<T> &vec, const Message &message) {
         vec.clear();
         if (message.getType() == Message::LIST) {
-            for (auto &msg: message.asList()) {
+            vec.reserve(message.size());
+            message.forEachElement([&vec](const Message &msg) {
                 T val;
                 val << msg;
                 vec.emplace_back(val);
-            }
+            });
         }
         return vec;
     }
@@ -411,12 +504,13 @@ namespace xng {
     template<typename T>
     Message &operator>>(const std::vector<T> &vec, Message &message) {
         std::vector<Message> msgs;
+        msgs.reserve(vec.size());
         for (auto &v: vec) {
             Message msg;
             v >> msg;
-            msgs.emplace_back(msg);
+            msgs.emplace_back(std::move(msg));
         }
-        message = Message(msgs);
+        message = Message(std::move(msgs));
         return message;
     }
 
@@ -425,11 +519,11 @@ namespace xng {
     std::map<std::string, T> &operator<<(std::map<std::string, T> &map, const Message &message) {
         map.clear();
         if (message.getType() == Message::DICTIONARY) {
-            for (auto &pair: message.asDictionary()) {
+            message.forEachEntry([&map](const std::string &key, const Message &value) {
                 T val;
-                val << pair.second;
-                map[pair.first] = val;
-            }
+                val << value;
+                map[key] = val;
+            });
         }
         return map;
     }
@@ -451,11 +545,11 @@ namespace xng {
     std::map<size_t, T> &operator<<(std::map<size_t, T> &map, const Message &message) {
         map.clear();
         if (message.getType() == Message::DICTIONARY) {
-            for (auto &pair: message.asDictionary()) {
+            message.forEachEntry([&map](const std::string &key, const Message &value) {
                 T val;
-                val << pair.second;
-                map[std::stoul(pair.first)] = val;
-            }
+                val << value;
+                map[std::stoul(key)] = val;
+            });
         }
         return map;
     }
@@ -477,11 +571,11 @@ namespace xng {
     std::set<T> &operator<<(std::set<T> &set, const Message &message) {
         set.clear();
         if (message.getType() == Message::LIST) {
-            for (auto &msg: message.asList()) {
+            message.forEachElement([&set](const Message &msg) {
                 T value;
                 value << msg;
                 set.insert(value);
-            }
+            });
         }
         return set;
     }
@@ -489,12 +583,13 @@ namespace xng {
     template<typename T>
     Message &operator>>(const std::set<T> &set, Message &message) {
         std::vector<Message> msgs;
+        msgs.reserve(set.size());
         for (auto &value: set) {
             Message msg;
             value >> msg;
-            msgs.emplace_back(msg);
+            msgs.emplace_back(std::move(msg));
         }
-        message = Message(msgs);
+        message = Message(std::move(msgs));
         return message;
     }
 }
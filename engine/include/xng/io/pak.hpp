@@ -6,28 +6,73 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include <mutex>
 
 #include "xng/crypto/aes.hpp"
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
 
+#include "xng/io/randomaccessreader.hpp"
+
 namespace xng {
     static const std::string PAK_FORMAT_VERSION = "01";
     static const std::string PAK_HEADER_MAGIC = "\xa9pak\xff" + PAK_FORMAT_VERSION + "\xa9";
 
+    static const std::string PAK_BINARY_FORMAT_VERSION = "02";
+    static const std::string PAK_BINARY_HEADER_MAGIC = "\xa9pak\xff" + PAK_BINARY_FORMAT_VERSION + "\xa9";
+
+    class PakBinaryHeader;
+
     /**
      * The pak file format
+     *
+     * Unencrypted paks store a binary header (PAK_BINARY_HEADER_MAGIC) which is used in place without parsing,
+     * encrypted paks and paks written by previous versions store a bson header (PAK_HEADER_MAGIC).
      */
     class XENGINE_EXPORT Pak {
     public:
+        /**
+         * The compression of a pak entry
+         */
+        enum Codec {
+            CODEC_STORE = 0, // Uncompressed, use for data which is already compressed such as png or ogg files
+            CODEC_GZIP = 1,
+            CODEC_LZ4 = 2, // Faster decompression than gzip at a lower compression ratio
+        };
+
         struct HeaderEntry {
             size_t offset;
             size_t size;
             std::string hash;
+            Codec codec = CODEC_STORE;
+            bool framed = false; // If false the entry is compressed as a single stream (Paks written before block framing)
         };
 
+        static const size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
         Pak() = default;
 
+        /**
+         * @param chunks The chunk readers in the order returned by PakBuilder::build
+         */
+        Pak(std::vector<std::shared_ptr<RandomAccessReader>> chunks, GZip &gzip, SHA &sha);
+
+        /**
+         * @param chunks The chunk readers in the order returned by PakBuilder::build
+         * @param key The key used to decrypt encrypted entries
+         */
+        Pak(std::vector<std::shared_ptr<RandomAccessReader>> chunks,
+            GZip &gzip,
+            SHA &sha,
+            AES &aes,
+            AES::Key key);
+
+        /**
+         * Reads from the streams are serialized per stream,
+         * prefer the RandomAccessReader constructors (eg. RandomAccessReader::open) for concurrent access.
+         *
+         * @param streams The chunk streams in the order returned by PakBuilder::build
+         */
         Pak(std::vector<std::reference_wrapper<std::istream>> streams, GZip &gzip, SHA &sha);
 
         /**
@@ -63,29 +108,69 @@ namespace xng {
          * and optionally verify its hash.
          *
          * The data of the entry is loaded into memory from the chunk streams when this method is called.
+         * This method is thread safe, decompression and hash verification run on the calling thread.
          *
          * @param path The path of the entry
          * @param verifyHash If true the hash of the returned data is checked against a hash stored in the pak header and an exception is thrown on mismatch.
          * @return The entry data
          */
-        std::vector<char> get(const std::string &path, bool verifyHash = false);
+        std::vector<char> get(const std::string &path, bool verifyHash = false) const;
 
-        bool exists(const std::string &path) {
-            return entries.find(path) != entries.end();
-        }
+        /**
+         * Same as get() but returns a view into the chunk data without copying
+         * if the entry is stored uncompressed and unencrypted inside a memory resident chunk.
+         *
+         * @param path The path of the entry
+         * @param verifyHash If true the hash of the returned data is checked against a hash stored in the pak header and an exception is thrown on mismatch.
+         * @return The entry data
+         */
+        ReadBuffer getBuffer(const std::string &path, bool verifyHash = false) const;
+
+        /**
+         * Open a stream to the entry data which decompresses the blocks of the entry incrementally while reading.
+         *
+         * The hash of the entry is not verified, the pak must outlive the returned stream.
+         *
+         * @param path The path of the entry
+         * @return The stream to the entry data
+         */
+        std::unique_ptr<std::istream> stream(const std::string &path) const;
 
-        const std::map<std::string, HeaderEntry> &getEntries() const { return entries; }
+        bool exists(const std::string &path) const;
+
+        /**
+         * For paks with a binary header the map is created on the first call.
+         *
+         * @return The header entries with global offsets
+         */
+        const std::map<std::string, HeaderEntry> &getEntries() const;
 
     private:
         void loadHeader();
 
-        size_t getRelativeOffset(size_t globalOffset);
+        /**
+         * Read size bytes starting at the global offset, spanning chunk boundaries if necessary.
+         */
+        ReadBuffer readData(size_t offset, size_t size) const;
+
+        bool findEntry(const std::string &path, HeaderEntry &entry) const;
+
+        HeaderEntry getEntry(const std::string &path) const;
+
+        ReadBuffer decrypt(const ReadBuffer &data) const;
+
+        std::vector<char> decode(const HeaderEntry &entry, const ReadBuffer &data) const;
+
+        void verify(const HeaderEntry &entry, const char *data, size_t size) const;
 
-        std::istream &getStreamForOffset(size_t globalOffset);
+        std::vector<std::shared_ptr<RandomAccessReader>> chunks;
+        std::shared_ptr<const PakBinaryHeader> binaryHeader;
+        size_t dataBegin{};
 
-        std::vector<std::reference_wrapper<std::istream>> streams;
-        std::map<std::string, HeaderEntry> entries; // The header entries with global offsets
-        long chunkSize{};
+        mutable std::map<std::string, HeaderEntry> entries; // The header entries with global offsets
+        mutable bool entriesLoaded = false;
+        std::shared_ptr<std::mutex> entriesMutex = std::make_shared<std::mutex>();
+        size_t chunkSize{};
         bool encrypted{};
         bool compressed{};
 
@@ -20,15 +20,62 @@
 #ifndef XENGINE_PAKBUILDER_HPP
 #define XENGINE_PAKBUILDER_HPP
 
+#include <filesystem>
+#include <functional>
+
 #include "pak.hpp"
 
 namespace xng {
     class XENGINE_EXPORT PakBuilder {
     public:
-        PakBuilder() = default;
+        /**
+         * @param blockSize The uncompressed size of the independently compressed blocks of compressed entries
+         */
+        explicit PakBuilder(size_t blockSize = Pak::DEFAULT_BLOCK_SIZE);
 
+        /**
+         * Add an entry which is compressed with gzip if compressData is passed to build().
+         *
+         * @param name
+         * @param buffer
+         */
         void addEntry(const std::string &name, const std::vector<char> &buffer);
 
+        /**
+         * Add an entry with a specific codec.
+         *
+         * Entries which do not compress with the codec are stored uncompressed.
+         *
+         * @param name
+         * @param buffer
+         * @param codec
+         */
+        void addEntry(const std::string &name, const std::vector<char> &buffer, Pak::Codec codec);
+
+        /**
+         * Add an entry which is read from the file at path when building.
+         *
+         * The entry is compressed with gzip if compressData is passed to build().
+         *
+         * @param name
+         * @param path
+         */
+        void addFile(const std::string &name, const std::filesystem::path &path);
+
+        /**
+         * Add an entry which is read from the file at path when building, with a specific codec.
+         *
+         * @param name
+         * @param path
+         * @param codec
+         */
+        void addFile(const std::string &name, const std::filesystem::path &path, Pak::Codec codec);
+
+        /**
+         * Build the pak in memory.
+         *
+         * @return The chunks of the pak
+         */
         std::vector<std::vector<char>> build(size_t chunkSize,
                                              bool compressData,
                                              bool encryptData,
@@ -38,8 +85,42 @@ namespace xng {
                                              const AES::Key &key,
                                              const AES::InitializationVector &iv);
 
+        /**
+         * Build the pak by streaming the entries into the chunk streams.
+         *
+         * Entries are read in blocks and the blocks are compressed in parallel on the thread pool while
+         * the calling thread writes the results in order, so memory usage is bounded by the number of blocks in flight.
+         * Encrypted entries are encrypted as a whole and are therefore held in memory while they are processed.
+         *
+         * The header is written last, so the chunk streams must be seekable
+         * and remain valid until this method returns. (eg. std::ofstream)
+         *
+         * Compressed entries are stored uncompressed if none of their blocks compress,
+         * blocks of large entries are only inspected up to the number of blocks in flight.
+         *
+         * @param createChunk Invoked with the index of each chunk when data is first written to it, returns the stream to write the chunk to.
+         * @param chunkSize The maximum size of each chunk or 0 to write a single chunk
+         */
+        void build(const std::function<std::ostream &(size_t index)> &createChunk,
+                   size_t chunkSize,
+                   bool compressData,
+                   bool encryptData,
+                   SHA &sha,
+                   GZip &zip,
+                   AES &aes,
+                   const AES::Key &key,
+                   const AES::InitializationVector &iv);
+
     private:
-        std::map<std::string, std::vector<char>> entries;
+        struct Entry {
+            std::vector<char> data;
+            std::filesystem::path file; // If not empty the entry data is read from this file
+            bool defaultCodec = true;
+            Pak::Codec codec = Pak::CODEC_STORE;
+        };
+
+        size_t blockSize;
+        std::map<std::string, Entry> entries;
     };
 }
 
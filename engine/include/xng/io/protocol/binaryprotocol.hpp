@@ -0,0 +1,54 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_BINARYPROTOCOL_HPP
+#define XENGINE_BINARYPROTOCOL_HPP
+
+#include "xng/io/protocol.hpp"
+#include "xng/io/binarystream.hpp"
+
+namespace xng {
+    static const std::string BINARY_PROTOCOL_VERSION = "01";
+    static const std::string BINARY_PROTOCOL_MAGIC = "\xa9msg\xff" + BINARY_PROTOCOL_VERSION + "\xa9";
+
+    /**
+     * A compact binary message format.
+     *
+     * Each value is written as a type byte followed by the value,
+     * integers are varints, floats are doubles and dictionary keys are interned.
+     */
+    class XENGINE_EXPORT BinaryProtocol : public Protocol {
+    public:
+        /**
+         * Write the message without the magic prefix.
+         */
+        static void writeMessage(BinaryWriter &writer, const Message &message);
+
+        /**
+         * Read a message written by writeMessage.
+         */
+        static Message readMessage(BinaryReader &reader);
+
+        void serialize(std::ostream &stream, const Message &message) override;
+
+        Message deserialize(std::istream &stream) override;
+    };
+}
+
+#endif //XENGINE_BINARYPROTOCOL_HPP
@@ -0,0 +1,98 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_RANDOMACCESSREADER_HPP
+#define XENGINE_RANDOMACCESSREADER_HPP
+
+#include <filesystem>
+#include <istream>
+#include <memory>
+
+#include "xng/io/readbuffer.hpp"
+
+namespace xng {
+    /**
+     * A read only data source supporting positional reads.
+     *
+     * Unlike std::istream a reader has no shared seek position,
+     * so read() and view() may be called concurrently from any number of threads.
+     */
+    class XENGINE_EXPORT RandomAccessReader {
+    public:
+        /**
+         * Open a reader for the file at path, the file is memory mapped.
+         *
+         * @param path
+         * @return
+         */
+        static std::shared_ptr<RandomAccessReader> open(const std::filesystem::path &path);
+
+        /**
+         * Create a reader for a stream.
+         *
+         * Reads are serialized by a mutex because the stream has a single seek position,
+         * the stream must outlive the returned reader.
+         *
+         * @param stream
+         * @return
+         */
+        static std::shared_ptr<RandomAccessReader> fromStream(std::istream &stream);
+
+        /**
+         * @param buffer
+         * @return A reader for the data in buffer
+         */
+        static std::shared_ptr<RandomAccessReader> fromBuffer(ReadBuffer buffer);
+
+        virtual ~RandomAccessReader() = default;
+
+        /**
+         * @return The total number of bytes
+         */
+        virtual size_t size() const = 0;
+
+        /**
+         * Copy count bytes starting at offset into buffer.
+         *
+         * @param offset
+         * @param buffer
+         * @param count
+         * @return The number of bytes read, smaller than count if the end of the data was reached
+         */
+        virtual size_t read(size_t offset, uint8_t *buffer, size_t count) = 0;
+
+        /**
+         * Return a view of count bytes starting at offset.
+         *
+         * Memory resident readers return a view without copying,
+         * the default implementation copies the data using read().
+         *
+         * @param offset
+         * @param count
+         * @return
+         */
+        virtual ReadBuffer view(size_t offset, size_t count) {
+            std::vector<uint8_t> data(count);
+            data.resize(read(offset, data.data(), count));
+            return ReadBuffer(std::move(data));
+        }
+    };
+}
+
+#endif //XENGINE_RANDOMACCESSREADER_HPP
@@ -0,0 +1,171 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_READBUFFER_HPP
+#define XENGINE_READBUFFER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <streambuf>
+#include <istream>
+#include <stdexcept>
+
+namespace xng {
+    /**
+     * A contiguous read only view of bytes.
+     *
+     * The buffer keeps the backing storage (Heap memory, a memory mapped file, a pak entry...) alive
+     * for as long as any copy of the buffer exists, copying a ReadBuffer does not copy the data.
+     */
+    class XENGINE_EXPORT ReadBuffer {
+    public:
+        ReadBuffer() = default;
+
+        /**
+         * @param data The pointer to the first byte
+         * @param size The number of bytes
+         * @param owner The object which owns the memory pointed to by data
+         */
+        ReadBuffer(const uint8_t *data, size_t size, std::shared_ptr<const void> owner)
+                : ptr(data), length(size), owner(std::move(owner)) {}
+
+        explicit ReadBuffer(std::shared_ptr<const std::vector<uint8_t>> bytes)
+                : ptr(bytes->data()), length(bytes->size()), owner(std::move(bytes)) {}
+
+        explicit ReadBuffer(std::vector<uint8_t> bytes)
+                : ReadBuffer(std::make_shared<const std::vector<uint8_t>>(std::move(bytes))) {}
+
+        explicit ReadBuffer(const std::vector<char> &bytes)
+                : ReadBuffer(std::vector<uint8_t>(bytes.begin(), bytes.end())) {}
+
+        /**
+         * Read the remaining contents of the stream into a new buffer.
+         *
+         * If the stream is seekable the size is determined upfront and the data is read in a single call.
+         *
+         * @param stream
+         * @return
+         */
+        static ReadBuffer fromStream(std::istream &stream) {
+            std::vector<uint8_t> bytes;
+
+            auto begin = stream.tellg();
+            if (begin != std::streampos(-1) && stream.seekg(0, std::ios::end)) {
+                auto end = stream.tellg();
+                stream.seekg(begin);
+                if (end != std::streampos(-1) && end >= begin) {
+                    bytes.resize(static_cast<size_t>(end - begin));
+                    stream.read(reinterpret_cast<char *>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+                    bytes.resize(static_cast<size_t>(stream.gcount()));
+                    return ReadBuffer(std::move(bytes));
+                }
+            }
+
+            stream.clear();
+
+            char chunk[4096];
+            while (stream) {
+                stream.read(chunk, sizeof(chunk));
+                bytes.insert(bytes.end(), chunk, chunk + stream.gcount());
+            }
+
+            return ReadBuffer(std::move(bytes));
+        }
+
+        const uint8_t *data() const { return ptr; }
+
+        const char *chars() const { return reinterpret_cast<const char *>(ptr); }
+
+        size_t size() const { return length; }
+
+        bool empty() const { return length == 0; }
+
+        const uint8_t *begin() const { return ptr; }
+
+        const uint8_t *end() const { return ptr + length; }
+
+        /**
+         * @param offset
+         * @param size
+         * @return A view into this buffer which shares the backing storage
+         */
+        ReadBuffer slice(size_t offset, size_t size) const {
+            if (offset > length || size > length - offset)
+                throw std::runtime_error("ReadBuffer slice out of range");
+            return {ptr + offset, size, owner};
+        }
+
+    private:
+        const uint8_t *ptr = nullptr;
+        size_t length = 0;
+        std::shared_ptr<const void> owner;
+    };
+
+    /**
+     * A seekable input stream reading directly from a ReadBuffer without copying the data.
+     */
+    class XENGINE_EXPORT ReadBufferStream : public std::istream {
+    public:
+        explicit ReadBufferStream(ReadBuffer buffer)
+                : std::istream(nullptr), streamBuf(std::move(buffer)) {
+            rdbuf(&streamBuf);
+            std::noskipws(*this);
+        }
+
+    private:
+        class StreamBuf : public std::streambuf {
+        public:
+            explicit StreamBuf(ReadBuffer buffer) : buffer(std::move(buffer)) {
+                auto *begin = const_cast<char *>(this->buffer.chars());
+                setg(begin, begin, begin + this->buffer.size());
+            }
+
+        protected:
+            pos_type seekoff(off_type off,
+                             std::ios_base::seekdir way,
+                             std::ios_base::openmode which) override {
+                off_type base;
+                if (way == std::ios_base::beg)
+                    base = 0;
+                else if (way == std::ios_base::cur)
+                    base = gptr() - eback();
+                else
+                    base = static_cast<off_type>(buffer.size());
+                return seekpos(pos_type(base + off), which);
+            }
+
+            pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+                if (!(which & std::ios_base::in)
+                    || pos < 0
+                    || static_cast<size_t>(pos) > buffer.size())
+                    return pos_type(off_type(-1));
+                setg(eback(), eback() + static_cast<off_type>(pos), egptr());
+                return pos;
+            }
+
+        private:
+            ReadBuffer buffer;
+        };
+
+        StreamBuf streamBuf;
+    };
+}
+
+#endif //XENGINE_READBUFFER_HPP
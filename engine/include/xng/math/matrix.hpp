@@ -81,49 +81,43 @@ namespace xng {
             return W * row + col; // Row Major
         }
 
+        // Element wise operators iterate the data array directly so that the compiler can vectorize the loops.
+
         Matrix<T, W, H> &operator+=(const Matrix<T, W, H> &other) {
-            for (int col = 0; col < W; col++) {
-                for (int row = 0; row < H; row++) {
-                    data[getIndex(col, row)] += other.get(col, row);
-                }
+            for (int i = 0; i < W * H; i++) {
+                data[i] += other.data[i];
             }
             return *this;
         }
 
         Matrix<T, W, H> &operator-=(const Matrix<T, W, H> &other) {
-            for (int col = 0; col < W; col++) {
-                for (int row = 0; row < H; row++) {
-                    data[getIndex(col, row)] -= other.get(col, row);
-                }
+            for (int i = 0; i < W * H; i++) {
+                data[i] -= other.data[i];
             }
             return *this;
         }
 
         friend Matrix<T, W, H> operator+(const Matrix<T, W, H> &lhs, const Matrix<T, W, H> &rhs) {
             Matrix<T, W, H> ret;
-            for (int x = 0; x < ret.width(); x++) {
-                for (int y = 0; y < ret.height(); y++) {
-                    ret.set(x, y, lhs.get(x, y) + rhs.get(x, y));
-                }
+            for (int i = 0; i < W * H; i++) {
+                ret.data[i] = lhs.data[i] + rhs.data[i];
             }
             return ret;
         }
 
         friend Matrix<T, W, H> operator-(const Matrix<T, W, H> &lhs, const Matrix<T, W, H> &rhs) {
             Matrix<T, W, H> ret;
-            for (int x = 0; x < ret.width(); x++) {
-                for (int y = 0; y < ret.height(); y++) {
-                    ret.set(x, y, lhs.get(x, y) - rhs.get(x, y));
-                }
+            for (int i = 0; i < W * H; i++) {
+                ret.data[i] = lhs.data[i] - rhs.data[i];
             }
             return ret;
         }
 
         Matrix<T, W, H> &operator<<(const Message &message) {
             if (message.getType() == Message::LIST) {
-                auto v = message.asList();
-                for (int i = 0; i < Matrix<T, W, H>::size() && i < v.size(); i++) {
-                    data[i] = v.at(i).as<T>();
+                auto count = message.size();
+                for (int i = 0; i < Matrix<T, W, H>::size() && i < count; i++) {
+                    data[i] = message[i].as<T>();
                 }
             } else {
                 std::fill_n(data, size(), 0);
@@ -132,10 +126,12 @@ namespace xng {
         }
 
         Message &operator>>(Message &message) const {
-            message = Message(Message::LIST);
+            std::vector<Message> elements;
+            elements.reserve(Matrix<T, W, H>::size());
             for (int i = 0; i < Matrix<T, W, H>::size(); i++) {
-                message[i] = data[i];
+                elements.emplace_back(data[i]);
             }
+            message = Message(std::move(elements));
             return message;
         }
 
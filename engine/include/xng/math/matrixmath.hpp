@@ -32,6 +32,46 @@ namespace xng::MatrixMath {
 
     XENGINE_EXPORT Mat4f transpose(const Mat4f &mat);
 
+    /**
+     * Multiply lhs with each matrix in rhs.
+     *
+     * @param lhs
+     * @param rhs Array of count matrices
+     * @param out Array of count matrices which receives lhs * rhs[i], may be the same array as rhs
+     * @param count
+     */
+    XENGINE_EXPORT void multiply(const Mat4f &lhs, const Mat4f *rhs, Mat4f *out, size_t count);
+
+    /**
+     * Multiply each matrix in lhs with rhs.
+     *
+     * @param lhs Array of count matrices
+     * @param rhs
+     * @param out Array of count matrices which receives lhs[i] * rhs, may be the same array as lhs
+     * @param count
+     */
+    XENGINE_EXPORT void multiply(const Mat4f *lhs, const Mat4f &rhs, Mat4f *out, size_t count);
+
+    /**
+     * Multiply mat with each column vector in vectors.
+     *
+     * @param mat
+     * @param vectors Array of count vectors
+     * @param out Array of count vectors which receives mat * vectors[i], may be the same array as vectors
+     * @param count
+     */
+    XENGINE_EXPORT void transform(const Mat4f &mat, const Vec4f *vectors, Vec4f *out, size_t count);
+
+    /**
+     * Transform each point in points by mat, the points are treated as column vectors with a w component of 1.
+     *
+     * @param mat
+     * @param points Array of count points
+     * @param out Array of count points which receives the transformed points, may be the same array as points
+     * @param count
+     */
+    XENGINE_EXPORT void transformPoints(const Mat4f &mat, const Vec3f *points, Vec3f *out, size_t count);
+
     /**
      * Returns a matrix which can be used for multiplying with a column vector.
      *
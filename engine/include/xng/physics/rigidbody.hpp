@@ -37,6 +37,17 @@ namespace xng {
             DYNAMIC
         };
 
+        /**
+         * The simulated state of a rigidbody, used for reading and writing bodies in bulk through the World.
+         */
+        struct State {
+            Vec3f position;
+            Vec3f rotation; // Euler angles in degrees
+            Vec3f velocity;
+            Vec3f angularVelocity;
+            bool awake = true; // False if the body is sleeping and has not moved during the last step
+        };
+
         virtual ~RigidBody() = default;
 
         virtual void setRigidBodyType(RigidBodyType type) = 0;
@@ -77,6 +88,11 @@ namespace xng {
 
         virtual void setGravityScale(float scale) = 0;
 
+        /**
+         * @return True if the body is simulated, false if the physics backend put the body to sleep.
+         */
+        virtual bool isAwake() = 0;
+
         /**
          * Create a collider attached to this rigidbody.
          * May not be supported by certain driver implementations (bullet3),
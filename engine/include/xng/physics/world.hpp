@@ -91,6 +91,23 @@ namespace xng {
         virtual std::vector<RayHit> rayTestAll(const Vec3f &from, const Vec3f &to) = 0;
 
         virtual RayHit rayTestClosest(const Vec3f &from, const Vec3f &to) = 0;
+
+        /**
+         * Read the state of multiple bodies at once.
+         *
+         * @param bodies The bodies to read, must have been created by this world.
+         * @param states Resized to the number of bodies and filled with the state of each body.
+         */
+        virtual void getStates(const std::vector<RigidBody *> &bodies, std::vector<RigidBody::State> &states) = 0;
+
+        /**
+         * Write the position, rotation and velocities of multiple bodies at once and wake them up.
+         * The awake flag of the states is ignored.
+         *
+         * @param bodies The bodies to write, must have been created by this world.
+         * @param states The state of each body, must have the same size as bodies.
+         */
+        virtual void setStates(const std::vector<RigidBody *> &bodies, const std::vector<RigidBody::State> &states) = 0;
     };
 }
 
@@ -0,0 +1,162 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_PACKEDTEXTUREATLAS_HPP
+#define XENGINE_PACKEDTEXTUREATLAS_HPP
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+
+#include "xng/render/atlas/skylinepacker.hpp"
+#include "xng/render/scene/image.hpp"
+
+namespace xng {
+    /**
+     * A texture atlas which packs textures of arbitrary size into the layers of a texture array
+     * with fixed size layers, instead of rounding every texture up to a power of two slot like TextureAtlas.
+     *
+     * Every texture is surrounded by a border of padding texels which repeat the texture edge
+     * and the allocations are aligned to 1 << (mipMapLevels - 1) texels so that every mip map level of a texture
+     * starts on a texel boundary and the filtered mip levels of neighbouring textures do not bleed into each other.
+     *
+     * Removing a texture does not make its space available to the packer until the layer is empty,
+     * defragment can be called to repack the layer with the most unusable space.
+     *
+     * This class only manages the allocations, FrameGraphPackedTextureAtlas applies them to a texture array buffer.
+     */
+    class XENGINE_EXPORT PackedTextureAtlas {
+    public:
+        struct Region {
+            size_t layer{};
+            Vec2i offset; // The offset of the texture in the layer in texels
+            Vec2i size; // The original texture size
+            Vec2i allocationOffset; // The offset of the allocated area including the padding
+            Vec2i allocationSize; // The size of the allocated area including the padding and alignment
+
+            bool operator==(const Region &other) const = default;
+        };
+
+        struct Move {
+            size_t handle{};
+            Region source;
+            Region target;
+        };
+
+        /**
+         * Create a copy of the texture with the size of the region allocation which has the texture placed at
+         * the padding offset and the edge texels of the texture repeated into the padding.
+         *
+         * @param texture
+         * @param region
+         * @return
+         */
+        static ImageRGBA getPaddedImage(const ImageRGBA &texture, const Region &region);
+
+        PackedTextureAtlas() = default;
+
+        /**
+         * @param layerSize The size of the layers, has to be a multiple of 1 << (mipMapLevels - 1)
+         * @param padding The number of texels around each texture, should be at least 1 << (mipMapLevels - 1) to
+         * keep a border of one texel at the smallest mip map level
+         * @param mipMapLevels The number of mip map levels that will be sampled from the atlas
+         */
+        explicit PackedTextureAtlas(Vec2i layerSize, int padding = 2, int mipMapLevels = 1);
+
+        /**
+         * Allocate a region for a texture of the given size.
+         *
+         * Creates a new layer if the texture does not fit into any of the existing layers.
+         *
+         * @param size
+         * @return The handle of the texture
+         */
+        size_t add(const Vec2i &size);
+
+        void remove(size_t handle);
+
+        const Region &getRegion(size_t handle) const {
+            return regions.at(handle);
+        }
+
+        /**
+         * Repack the texture regions of the layer with the lowest occupancy into an empty layer.
+         *
+         * One layer is compacted per invocation so that the cost of the returned copies can be spread over frames.
+         * The compacted layer is empty afterwards and will be reused by subsequent allocations.
+         *
+         * @param maxOccupancy Layers with a ratio of live texels to consumed texels above this value are not compacted
+         * @return The regions which have been moved, the texture data has to be copied from source to target
+         */
+        std::vector<Move> defragment(float maxOccupancy = 0.75f);
+
+        /**
+         * @param layer
+         * @return The ratio of live texture texels to the texels which can no longer be allocated in the layer
+         */
+        float getOccupancy(size_t layer) const;
+
+        size_t getLayerCount() const { return layers.size(); }
+
+        const Vec2i &getLayerSize() const { return layerSize; }
+
+        int getPadding() const { return padding; }
+
+        int getMipMapLevels() const { return mipMapLevels; }
+
+        /**
+         * @return The uv offset of the region in the layer
+         */
+        Vec2f getUvOffset(size_t handle) const {
+            auto &region = regions.at(handle);
+            return region.offset.convert<float>() / layerSize.convert<float>();
+        }
+
+        /**
+         * @return The uv scale to apply to the texture uv coordinates before adding the uv offset
+         */
+        Vec2f getUvScale(size_t handle) const {
+            auto &region = regions.at(handle);
+            return region.size.convert<float>() / layerSize.convert<float>();
+        }
+
+    private:
+        struct Layer {
+            SkylinePacker packer;
+            std::set<size_t> handles;
+            size_t liveArea = 0;
+        };
+
+        Vec2i getAllocationSize(const Vec2i &size) const;
+
+        bool allocate(Layer &layer, size_t layerIndex, const Vec2i &size, Region &region) const;
+
+        Vec2i layerSize;
+        int padding = 2;
+        int mipMapLevels = 1;
+        int alignment = 1;
+
+        std::vector<Layer> layers;
+        std::unordered_map<size_t, Region> regions;
+        size_t handleCounter = 0;
+    };
+}
+
+#endif //XENGINE_PACKEDTEXTUREATLAS_HPP
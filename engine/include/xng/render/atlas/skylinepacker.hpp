@@ -0,0 +1,85 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_SKYLINEPACKER_HPP
+#define XENGINE_SKYLINEPACKER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "xng/math/vector2.hpp"
+
+namespace xng {
+    /**
+     * Packs rectangles into a fixed size area by tracking the upper contour ("skyline") of the placed rectangles.
+     *
+     * Rectangles are placed at the position which results in the lowest top edge (bottom-left rule),
+     * which keeps the packing dense for mixed aspect ratios without the bookkeeping of a free rectangle list.
+     *
+     * Space below the skyline which is not covered by a rectangle is not reused,
+     * rectangles cannot be removed individually, the packer has to be reset and the remaining rectangles repacked.
+     */
+    class XENGINE_EXPORT SkylinePacker {
+    public:
+        SkylinePacker() = default;
+
+        explicit SkylinePacker(Vec2i size);
+
+        /**
+         * @param size The size of the rectangle
+         * @param offset Receives the offset of the rectangle if it was placed
+         * @return False if there is not enough space for the rectangle
+         */
+        bool pack(const Vec2i &size, Vec2i &offset);
+
+        void reset();
+
+        const Vec2i &getSize() const { return size; }
+
+        /**
+         * @return The sum of the areas of the packed rectangles
+         */
+        size_t getUsedArea() const { return usedArea; }
+
+        /**
+         * @return The area below the skyline which includes the unusable gaps between the packed rectangles
+         */
+        size_t getCoveredArea() const;
+
+    private:
+        struct Node {
+            int x;
+            int y;
+            int width;
+        };
+
+        /**
+         * @return The y coordinate at which a rectangle of the given width fits at the x of the node
+         * or -1 if it does not fit.
+         */
+        int fit(size_t index, const Vec2i &rect) const;
+
+        Vec2i size;
+        std::vector<Node> skyline;
+        size_t usedArea = 0;
+    };
+}
+
+#endif //XENGINE_SKYLINEPACKER_HPP
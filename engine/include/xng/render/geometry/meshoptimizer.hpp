@@ -0,0 +1,129 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MESHOPTIMIZER_HPP
+#define XENGINE_MESHOPTIMIZER_HPP
+
+#include <vector>
+#include <cstddef>
+
+#include "xng/math/vector3.hpp"
+
+namespace xng {
+    /**
+     * Reorders the triangles and vertices of indexed triangle lists for the post transform vertex cache,
+     * for overdraw and for vertex fetch locality.
+     *
+     * The optimizations only change the order of the triangles and vertices, the rendered geometry is unchanged.
+     */
+    class XENGINE_EXPORT MeshOptimizer {
+    public:
+        /**
+         * The vertex cache efficiency of a triangle list simulated with a FIFO cache.
+         */
+        struct Statistics {
+            size_t triangles = 0;
+            size_t vertices = 0; // The number of unique vertices referenced by the triangles
+            size_t transformedVertices = 0; // The number of vertex shader invocations
+
+            /**
+             * @return Average cache miss ratio, the transformed vertices per triangle, 0.5 is optimal for large regular meshes
+             */
+            float getACMR() const {
+                return triangles == 0 ? 0 : static_cast<float>(transformedVertices) / static_cast<float>(triangles);
+            }
+
+            /**
+             * @return Average transformed vertex ratio, the transformed vertices per vertex, 1 is optimal
+             */
+            float getATVR() const {
+                return vertices == 0 ? 0 : static_cast<float>(transformedVertices) / static_cast<float>(vertices);
+            }
+
+            Statistics &operator+=(const Statistics &other) {
+                triangles += other.triangles;
+                vertices += other.vertices;
+                transformedVertices += other.transformedVertices;
+                return *this;
+            }
+        };
+
+        /**
+         * The statistics of a mesh before and after optimization.
+         */
+        struct Report {
+            Statistics before;
+            Statistics after;
+
+            Report &operator+=(const Report &other) {
+                before += other.before;
+                after += other.after;
+                return *this;
+            }
+        };
+
+        /**
+         * @param indices The triangle list
+         * @param vertexCount
+         * @param cacheSize The number of entries of the simulated FIFO cache
+         * @return
+         */
+        static Statistics analyzeVertexCache(const std::vector<unsigned int> &indices,
+                                             size_t vertexCount,
+                                             size_t cacheSize = 16);
+
+        /**
+         * Reorder the triangles for the post transform vertex cache with the linear speed algorithm by Tom Forsyth.
+         *
+         * @param indices
+         * @param vertexCount
+         * @return The reordered indices
+         */
+        static std::vector<unsigned int> optimizeVertexCache(const std::vector<unsigned int> &indices,
+                                                             size_t vertexCount);
+
+        /**
+         * Reorder clusters of cache optimized triangles so that triangles facing outwards from the mesh center are drawn first.
+         *
+         * The indices should be optimized for the vertex cache beforehand, clusters are split where the cache
+         * is flushed and where the cache miss ratio of the cluster stays below threshold times the ratio of the enclosing cluster.
+         *
+         * @param indices
+         * @param positions
+         * @param threshold The factor by which the cache miss ratio may increase in favor of smaller clusters
+         * @return The reordered indices
+         */
+        static std::vector<unsigned int> optimizeOverdraw(const std::vector<unsigned int> &indices,
+                                                          const std::vector<Vec3f> &positions,
+                                                          float threshold = 1.05f);
+
+        /**
+         * Create the remapping which orders vertices by their first use in the indices.
+         * Vertices which are not referenced are moved behind the referenced vertices.
+         *
+         * @param indices
+         * @param vertexCount
+         * @return The new index of each vertex
+         */
+        static std::vector<unsigned int> getVertexFetchRemap(const std::vector<unsigned int> &indices,
+                                                             size_t vertexCount);
+    };
+}
+
+#endif //XENGINE_MESHOPTIMIZER_HPP
@@ -0,0 +1,103 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MESHSIMPLIFIER_HPP
+#define XENGINE_MESHSIMPLIFIER_HPP
+
+#include <vector>
+
+#include "xng/math/vector3.hpp"
+
+#include "xng/render/scene/mesh.hpp"
+
+namespace xng {
+    /**
+     * Simplifies indexed triangle meshes by quadric edge collapse.
+     *
+     * Vertices are only collapsed onto other vertices of the mesh so that the simplified indices
+     * can be drawn with the vertex buffer of the source mesh.
+     * Vertices on attribute seams (Vertices which share their position with another vertex) are never moved,
+     * vertices on the border of the mesh are only collapsed along the border.
+     */
+    class XENGINE_EXPORT MeshSimplifier {
+    public:
+        struct Result {
+            std::vector<unsigned int> indices;
+            float error = 0; // The maximum collapse error in units of the positions
+        };
+
+        struct LodSettings {
+            size_t maxLods = 4; // The maximum number of levels of detail generated per mesh, 0 disables generation
+            float reduction = 0.5f; // The target index count of each level relative to the previous level
+            float maxError = 0.05f; // The maximum error of a level relative to the extent of the mesh
+            size_t minTriangles = 64; // Meshes with fewer triangles are not simplified
+        };
+
+        /**
+         * @param positions The vertex positions
+         * @param indices The triangle list indices into positions
+         * @param targetIndexCount The number of indices at which the simplification stops
+         * @param maxError The maximum error relative to the extent of the mesh at which the simplification stops
+         * @return
+         */
+        static Result simplify(const std::vector<Vec3f> &positions,
+                               const std::vector<unsigned int> &indices,
+                               size_t targetIndexCount,
+                               float maxError);
+
+        /**
+         * Generate the levels of detail of the mesh and its sub meshes, replaces existing levels.
+         *
+         * Each level is simplified from the full resolution indices so that the errors are not accumulated.
+         * Levels which do not reduce the index count of the previous level significantly are discarded.
+         *
+         * @param mesh
+         * @param settings
+         */
+        static void generateLods(Mesh &mesh, const LodSettings &settings);
+
+        static void generateLods(Mesh &mesh) {
+            generateLods(mesh, LodSettings());
+        }
+
+        /**
+         * The position is read from the first attribute of the vertex layout which must be a float vector3
+         * or the quantized position of a compact vertex layout.
+         *
+         * @param mesh
+         * @return
+         */
+        static std::vector<Vec3f> getPositions(const Mesh &mesh);
+
+        /**
+         * The maximum distance of the source vertices to the surface of the simplified triangles.
+         *
+         * Brute force, intended for tests and tools.
+         *
+         * @param positions
+         * @param simplifiedIndices
+         * @return
+         */
+        static float getDistanceError(const std::vector<Vec3f> &positions,
+                                      const std::vector<unsigned int> &indices,
+                                      const std::vector<unsigned int> &simplifiedIndices);
+    };
+}
+
+#endif //XENGINE_MESHSIMPLIFIER_HPP
@@ -0,0 +1,94 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_VERTEXQUANTIZER_HPP
+#define XENGINE_VERTEXQUANTIZER_HPP
+
+#include <cstdint>
+
+#include "xng/math/vector2.hpp"
+#include "xng/math/vector3.hpp"
+
+#include "xng/render/scene/mesh.hpp"
+
+namespace xng {
+    /**
+     * Converts meshes between the default float vertex layouts and the compact quantized vertex layouts,
+     * see Mesh::getCompactVertexLayout and SkinnedMesh::getCompactVertexLayout.
+     */
+    class XENGINE_EXPORT VertexQuantizer {
+    public:
+        /**
+         * Convert the vertices of the mesh and its sub meshes from the default layout to the compact layout.
+         *
+         * The positions are quantized to the bounding box of each mesh which is stored in Mesh::positionOffset and Mesh::positionScale.
+         * Meshes which already use the compact layout are not modified.
+         *
+         * @param mesh A mesh with the Mesh or SkinnedMesh default or compact vertex layout
+         */
+        static void quantize(Mesh &mesh);
+
+        /**
+         * Convert the vertices of the mesh and its sub meshes from the compact layout to the default layout.
+         *
+         * The bitangent is reconstructed from the normal, tangent and bitangent sign.
+         * Meshes which already use the default layout are not modified.
+         *
+         * @param mesh A mesh with the Mesh or SkinnedMesh default or compact vertex layout
+         */
+        static void dequantize(Mesh &mesh);
+
+        /**
+         * @param mesh
+         * @return True if the vertex layout of the mesh is Mesh::getCompactVertexLayout or SkinnedMesh::getCompactVertexLayout
+         */
+        static bool isCompact(const Mesh &mesh);
+
+        /**
+         * Decode the object space position of a vertex of the mesh in either the default or the compact layout.
+         *
+         * @param mesh
+         * @param vertex
+         * @return
+         */
+        static Vec3f getPosition(const Mesh &mesh, const Vertex &vertex);
+
+        /**
+         * @param normal A unit vector
+         * @return The octahedral encoding of the vector in the range [-1, 1]
+         */
+        static Vec2f encodeOctahedral(const Vec3f &normal);
+
+        static Vec3f decodeOctahedral(const Vec2f &value);
+
+        /**
+         * @param value
+         * @return The IEEE 754 half precision representation of the value rounded to nearest even
+         */
+        static uint16_t encodeHalf(float value);
+
+        static float decodeHalf(uint16_t value);
+
+        static int16_t encodeSnorm16(float value);
+
+        static float decodeSnorm16(int16_t value);
+    };
+}
+
+#endif //XENGINE_VERTEXQUANTIZER_HPP
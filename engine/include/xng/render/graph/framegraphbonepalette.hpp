@@ -0,0 +1,87 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_FRAMEGRAPHBONEPALETTE_HPP
+#define XENGINE_FRAMEGRAPHBONEPALETTE_HPP
+
+#include <map>
+#include <vector>
+#include <cstdint>
+#include <limits>
+
+#include "xng/render/graph/framegraphbuilder.hpp"
+
+#include "xng/render/scene/scene.hpp"
+
+namespace xng {
+    /**
+     * Uploads Scene.bonePalette once per frame and translates the bone indices of skinned meshes into palette indices.
+     *
+     * The vertices of a mesh reference their bones by the index in Mesh.bones, each pass uploads a small
+     * buffer of palette indices per draw (the boneIndices buffer in skinning.glsl) instead of a copy of the transforms.
+     * The mapping from the bones of a mesh to the bones of its rig is computed once per mesh and cached
+     * until the generation of the mesh bundle changes.
+     */
+    class XENGINE_EXPORT FrameGraphBonePalette {
+    public:
+        /**
+         * Get the shader storage buffer of the current frame containing the palette encoded
+         * in the format of SETTING_BONE_PALETTE_FORMAT.
+         *
+         * The buffer is created and uploaded by the first pass which calls this method in a frame and
+         * shared with subsequent passes through SLOT_BONE_PALETTE.
+         *
+         * @param builder
+         * @return The shader storage buffer containing the BonePaletteData declared in skinning.glsl
+         */
+        static FrameGraphResource getPaletteBuffer(FrameGraphBuilder &builder);
+
+        /**
+         * Append the palette index of each bone of the mesh to indices.
+         *
+         * Bones which are not animated by the BoneTransformsProperty of the node reference the identity entry.
+         *
+         * @param scene
+         * @param node The node containing the SkinnedMeshProperty and the optional BoneTransformsProperty
+         * @param subMesh 0 for the mesh or the index of the sub mesh + 1
+         * @param indices
+         * @return The offset of the first appended index in indices or -1 if the mesh has no bones
+         */
+        int addBoneIndices(const Scene &scene, const Node &node, size_t subMesh, std::vector<uint32_t> &indices);
+
+        /**
+         * Release the cached bone mappings of the meshes which were not used since the last call.
+         */
+        void releaseUnused();
+
+    private:
+        static const uint32_t NO_BONE = std::numeric_limits<uint32_t>::max();
+
+        struct Entry {
+            uint64_t generation = 0; // The bundle generation of the mesh which was mapped
+            std::vector<std::vector<uint32_t>> rigIndices; // The rig bone index of each bone of the mesh and sub meshes
+            bool used = false;
+        };
+
+        std::map<Uri, Entry> entries;
+    };
+}
+
+#endif //XENGINE_FRAMEGRAPHBONEPALETTE_HPP
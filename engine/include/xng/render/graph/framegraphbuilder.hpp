@@ -87,6 +87,30 @@ namespace xng {
                   size_t writeOffset,
                   size_t count);
 
+        /**
+         * Copy a rectangle between textures of texture array buffers.
+         *
+         * The offsets and size are specified in texels of mip map level 0 and are shifted right for each
+         * subsequent level.
+         *
+         * @param source A TextureArrayBuffer
+         * @param dest A TextureArrayBuffer with the same color format, may be the source if the rectangles do not overlap
+         * @param sourceIndex
+         * @param targetIndex
+         * @param sourceOffset
+         * @param targetOffset
+         * @param size
+         * @param mipMapLevels The number of mip map levels starting at level 0 to copy
+         */
+        void copyTextureRegion(FrameGraphResource source,
+                               FrameGraphResource dest,
+                               size_t sourceIndex,
+                               size_t targetIndex,
+                               Vec2i sourceOffset,
+                               Vec2i targetOffset,
+                               Vec2i size,
+                               int mipMapLevels);
+
         void generateMipMaps(FrameGraphResource buffer);
 
         /**
@@ -42,6 +42,7 @@ namespace xng {
             CREATE_SHADER_STORAGE_BUFFER,
             UPLOAD,
             COPY,
+            COPY_TEXTURE_REGION,
             GENERATE_MIPMAPS,
             BLIT_COLOR,
             BLIT_DEPTH,
@@ -82,6 +83,15 @@ namespace xng {
             size_t count;
         };
 
+        struct CopyTextureRegionData {
+            size_t sourceIndex;
+            size_t targetIndex;
+            Vec2i sourceOffset;
+            Vec2i targetOffset;
+            Vec2i size;
+            int mipMapLevels;
+        };
+
         struct DrawCallData {
             std::vector<DrawCall> drawCalls;
             std::vector<size_t> baseVertices;
@@ -125,6 +135,7 @@ namespace xng {
 
         std::variant<UploadData,
                 CopyData,
+                CopyTextureRegionData,
                 DrawCallData,
                 ClearData,
                 ViewportData,
@@ -0,0 +1,175 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_FRAMEGRAPHPACKEDTEXTUREATLAS_HPP
+#define XENGINE_FRAMEGRAPHPACKEDTEXTUREATLAS_HPP
+
+#include "xng/render/atlas/packedtextureatlas.hpp"
+#include "xng/render/texture/texturecooker.hpp"
+
+#include "xng/render/graph/framegraphbuilder.hpp"
+
+namespace xng {
+    /**
+     * Maintains a PackedTextureAtlas in a single persistent texture array buffer.
+     *
+     * New textures are uploaded into a transient texture with the size of their allocation
+     * which is then copied into the atlas layer together with its cpu generated mip map levels.
+     * Regions moved by defragment are copied inside the array buffer on the gpu.
+     */
+    class FrameGraphPackedTextureAtlas {
+    public:
+        FrameGraphPackedTextureAtlas() = default;
+
+        /**
+         * @param layerDesc The description of the array buffer layers, the size and mip map levels are
+         * passed to the PackedTextureAtlas
+         * @param padding
+         */
+        explicit FrameGraphPackedTextureAtlas(const TextureBufferDesc &layerDesc, int padding = 2)
+                : layerDesc(layerDesc),
+                  atlas(layerDesc.size, padding, layerDesc.mipMapLevels) {
+            mipMapSettings.wrapping = CLAMP_TO_EDGE;
+        }
+
+        size_t add(const ImageRGBA &texture) {
+            auto ret = atlas.add(texture.getResolution());
+            pendingTextures[ret] = texture;
+            return ret;
+        }
+
+        void remove(size_t handle) {
+            atlas.remove(handle);
+            pendingTextures.erase(handle);
+        }
+
+        /**
+         * Compact the layer with the lowest occupancy, the copies are recorded in the next getAtlasBuffer call.
+         *
+         * @param maxOccupancy
+         * @return The handles of the textures whose region has changed
+         */
+        std::vector<size_t> defragment(float maxOccupancy = 0.75f) {
+            std::vector<size_t> ret;
+            for (auto &move: atlas.defragment(maxOccupancy)) {
+                ret.emplace_back(move.handle);
+                // Pending textures are uploaded to their current region anyway.
+                if (pendingTextures.find(move.handle) == pendingTextures.end()) {
+                    pendingMoves.emplace_back(move);
+                }
+            }
+            return ret;
+        }
+
+        void setup(FrameGraphBuilder &builder) {
+            previousHandle = currentHandle;
+
+            auto layerCount = std::max(atlas.getLayerCount(), static_cast<size_t>(1));
+            if (!currentHandle.assigned || bufferLayers < layerCount) {
+                bufferLayers = layerCount;
+                TextureArrayBufferDesc desc;
+                desc.textureCount = layerCount;
+                desc.textureDesc = layerDesc;
+                currentHandle = builder.createTextureArrayBuffer(desc);
+            }
+
+            builder.persist(currentHandle);
+        }
+
+        FrameGraphResource getAtlasBuffer(FrameGraphBuilder &builder) {
+            if (currentHandle != previousHandle && previousHandle.assigned) {
+                builder.copy(previousHandle, currentHandle, 0, 0, 0);
+            }
+
+            // Layers added after setup are allocated in the next frame, the pending operations are deferred until then.
+            if (atlas.getLayerCount() > bufferLayers) {
+                return currentHandle;
+            }
+
+            for (auto &move: pendingMoves) {
+                builder.copyTextureRegion(currentHandle,
+                                          currentHandle,
+                                          move.source.layer,
+                                          move.target.layer,
+                                          move.source.allocationOffset,
+                                          move.target.allocationOffset,
+                                          move.source.allocationSize,
+                                          layerDesc.mipMapLevels);
+            }
+            pendingMoves.clear();
+
+            for (auto &pair: pendingTextures) {
+                auto &region = atlas.getRegion(pair.first);
+
+                TextureArrayBufferDesc desc;
+                desc.textureCount = 1;
+                desc.textureDesc = layerDesc;
+                desc.textureDesc.size = region.allocationSize;
+                auto staging = builder.createTextureArrayBuffer(desc);
+
+                auto levels = std::make_shared<std::vector<ImageRGBA>>();
+                levels->emplace_back(PackedTextureAtlas::getPaddedImage(pair.second, region));
+                if (layerDesc.mipMapLevels > 1) {
+                    *levels = TextureCooker::generateMipChain(levels->at(0), mipMapSettings);
+                }
+
+                for (auto level = 0; level < layerDesc.mipMapLevels; level++) {
+                    builder.upload(staging,
+                                   0,
+                                   0,
+                                   RGBA,
+                                   {},
+                                   [levels, level]() {
+                                       return FrameGraphUploadBuffer::createArray(levels->at(level).getBuffer());
+                                   },
+                                   level);
+                }
+
+                builder.copyTextureRegion(staging,
+                                          currentHandle,
+                                          0,
+                                          region.layer,
+                                          {},
+                                          region.allocationOffset,
+                                          region.allocationSize,
+                                          layerDesc.mipMapLevels);
+            }
+            pendingTextures.clear();
+
+            return currentHandle;
+        }
+
+        FrameGraphResource currentHandle;
+        FrameGraphResource previousHandle;
+
+        TextureBufferDesc layerDesc;
+
+        PackedTextureAtlas atlas;
+
+        // The filter settings used to generate the mip map levels of uploaded textures
+        TextureCooker::Settings mipMapSettings;
+
+        size_t bufferLayers = 0;
+
+        std::unordered_map<size_t, ImageRGBA> pendingTextures;
+        std::vector<PackedTextureAtlas::Move> pendingMoves;
+    };
+}
+#endif //XENGINE_FRAMEGRAPHPACKEDTEXTUREATLAS_HPP
@@ -37,6 +37,18 @@ FRAMEGRAPH_SETTING(SETTING_RENDER_SCALE, static_cast<float>(1.0))
 // int, the number of sub samples per pixel (MSAA) to use when forward rendering, if not defined the back buffer sample count is used.
 FRAMEGRAPH_SETTING(SETTING_RENDER_SAMPLES, 1)
 
+// float, Range(0, inf) The maximum projected error in pixels of the selected mesh level of detail, 0 always draws the full resolution meshes.
+FRAMEGRAPH_SETTING(SETTING_LOD_THRESHOLD, static_cast<float>(1.0))
+
+// float, Range(0, 1) The fraction by which the projected error of a coarser level must be below the threshold before it is selected.
+FRAMEGRAPH_SETTING(SETTING_LOD_HYSTERESIS, static_cast<float>(0.25))
+
+// bool, Upload the geometry of the construction and shadow mapping passes in the quantized SkinnedMesh::getCompactVertexLayout()
+FRAMEGRAPH_SETTING(SETTING_COMPACT_VERTEX_LAYOUT, false)
+
+// int, The BonePalette::Format of the uploaded bone transforms, 0 = 3x4 matrices, 1 = dual quaternions (Preserves volume but ignores bone scale)
+FRAMEGRAPH_SETTING(SETTING_BONE_PALETTE_FORMAT, 0)
+
 // Vec2i, The resolution of the point shadow maps
 FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_POINT_RESOLUTION, Vec2i(2048, 2048))
 
@@ -46,4 +58,25 @@ FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_DIRECTIONAL_RESOLUTION, Vec2i(2048, 20
 // Vec2i, The resolution of the spot shadow maps
 FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_SPOT_RESOLUTION, Vec2i(2048, 2048))
 
+// int, The maximum number of shadow maps rendered per frame, shadow maps of lights whose casters did not change are cached. Values < 1 disable the budget.
+FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_UPDATE_BUDGET, 0)
+
+// int, Range(0, inf) The number of levels of detail by which shadow casters are coarser than the level selected for the camera.
+FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_LOD_BIAS, 1)
+
+// int, Range(1, 4) The number of cascades of directional light shadow maps, 1 uses the fixed shadow projection of the light.
+FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_DIRECTIONAL_CASCADES, 1)
+
+// float, The view distance covered by the directional light shadow cascades.
+FRAMEGRAPH_SETTING(SETTING_SHADOW_MAPPING_DIRECTIONAL_CASCADE_DISTANCE, static_cast<float>(100))
+
+// Vec2i, The number of screen space tiles of the light cluster grid
+FRAMEGRAPH_SETTING(SETTING_LIGHT_CLUSTER_TILES, Vec2i(16, 9))
+
+// int, The number of depth slices of the light cluster grid
+FRAMEGRAPH_SETTING(SETTING_LIGHT_CLUSTER_SLICES, 24)
+
+// float, Range(0, inf) The radiance below which point and spot lights are culled, smaller values result in larger light radii.
+FRAMEGRAPH_SETTING(SETTING_LIGHT_CLUSTER_THRESHOLD, static_cast<float>(1.0 / 256.0))
+
 #endif //XENGINE_FRAMEGRAPHSETTINGS_HPP
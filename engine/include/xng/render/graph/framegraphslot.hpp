@@ -51,6 +51,14 @@ namespace xng {
         SLOT_SHADOW_MAP_DIRECTIONAL, // A Texture Array with 2D textures containing directional light depth maps of light sources.
         SLOT_SHADOW_MAP_SPOT, // A Texture Array with 2D textures containing spot light depth maps of light sources.
 
+        // Shadow Map Data, A Shader Storage Buffer with one element for each shadow casting light in scene order, the layouts are declared in shadow.glsl
+        SLOT_SHADOW_MAP_POINT_DATA, // std140 ShadowPointData[] : The layer of the light in SLOT_SHADOW_MAP_POINT
+        SLOT_SHADOW_MAP_DIRECTIONAL_DATA, // std140 ShadowDirectionalData[] : The layers, view depth splits and light space transforms of the cascades in SLOT_SHADOW_MAP_DIRECTIONAL
+        SLOT_SHADOW_MAP_SPOT_DATA, // std140 ShadowSpotData[] : The layer and light space transform of the light in SLOT_SHADOW_MAP_SPOT
+
+        // Skinning
+        SLOT_BONE_PALETTE, // std430 BonePaletteData : The encoded Scene.bonePalette of the frame, created by the first pass which uses FrameGraphBonePalette::getPaletteBuffer
+
         // Users can creat custom slots for sharing data between custom passes by using a value >= SLOT_USER for the slot.
         SLOT_USER = 255,
     };
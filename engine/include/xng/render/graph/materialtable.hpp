@@ -0,0 +1,158 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MATERIALTABLE_HPP
+#define XENGINE_MATERIALTABLE_HPP
+
+#include <map>
+#include <set>
+#include <vector>
+#include <cstdint>
+
+#include "xng/render/graph/framegraphbuilder.hpp"
+#include "xng/render/graph/framegraphtextureatlas.hpp"
+
+#include "xng/render/scene/material.hpp"
+
+namespace xng {
+    /**
+     * Assigns stable integer ids to the materials used by a pass and maintains a persistent shader storage buffer
+     * containing the resolved parameters and texture atlas coordinates of each material (ShaderMaterial in material.glsl).
+     *
+     * Draw records only carry the material id, the material handles are resolved once when a material is first used
+     * and the buffer entries are only uploaded when a material is added or the resource of the material
+     * or of one of its textures was reloaded, which is detected by the bundle generation of the handles.
+     *
+     * Ids stay valid as long as the material is used every frame, ids of materials which were not used
+     * in a frame are released in setup() and reused by later materials.
+     */
+    class XENGINE_EXPORT MaterialTable {
+    public:
+        /**
+         * The id of the default constructed material used for meshes without an assigned material.
+         */
+        static const uint32_t DEFAULT_MATERIAL = 0;
+
+#pragma pack(push, 1)
+        struct ShaderAtlasTexture {
+            int level_index_filtering_assigned[4]{0, 0, 0, 0};
+            float atlasScale_texSize[4]{0, 0, 0, 0};
+        };
+
+        struct ShaderMaterial {
+            float metallic_roughness_ambientOcclusion[4]{0, 0, 0, 0};
+            float albedoColor[4]{0, 0, 0, 0};
+            float normalIntensity[4]{0, 0, 0, 0};
+
+            ShaderAtlasTexture normal;
+
+            ShaderAtlasTexture metallic;
+            ShaderAtlasTexture roughness;
+            ShaderAtlasTexture ambientOcclusion;
+            ShaderAtlasTexture albedo;
+        };
+#pragma pack(pop)
+
+        /**
+         * @param atlas The atlas into which the textures of the materials are added, must outlive the table.
+         */
+        explicit MaterialTable(FrameGraphTextureAtlas &atlas);
+
+        MaterialTable(const MaterialTable &other) = delete;
+
+        MaterialTable &operator=(const MaterialTable &other) = delete;
+
+        /**
+         * Get the id of the material and mark it as used in the current frame.
+         *
+         * Must be called before FrameGraphTextureAtlas::setup for the textures of new materials to be uploaded in the same frame.
+         *
+         * @param material The material or an unassigned handle for the default material
+         * @return The index of the material in the buffer returned by setup()
+         */
+        uint32_t getMaterial(const ResourceHandle<Material> &material);
+
+        /**
+         * @param id
+         * @return The material data of the id, valid until the id is released.
+         */
+        const Material &get(uint32_t id) const {
+            return *entries.at(id).material;
+        }
+
+        /**
+         * Release the materials which were not used since the last call,
+         * upload the changed entries and return the persistent material buffer.
+         *
+         * @param builder
+         * @return The shader storage buffer containing ShaderMaterial[]
+         */
+        FrameGraphResource setup(FrameGraphBuilder &builder);
+
+        size_t getMaterialCount() const {
+            return materials.size() + 1;
+        }
+
+    private:
+        struct EntryTexture {
+            Uri uri;
+            uint64_t generation = 0; // The bundle generation of the texture when the entry was resolved
+        };
+
+        struct Entry {
+            ResourceHandle<Material> handle;
+            const Material *material = nullptr;
+            uint64_t generation = 0; // The bundle generation of the material when the entry was resolved
+            std::vector<EntryTexture> textures; // The atlas textures referenced by the entry
+            bool used = false;
+        };
+
+        struct TextureEntry {
+            TextureAtlasHandle handle;
+            size_t refCount = 0;
+            uint64_t generation = 0; // The bundle generation of the texture in the atlas
+        };
+
+        void resolve(Entry &entry);
+
+        bool hasReloadedTextures(const Entry &entry) const;
+
+        void releaseTextures(Entry &entry);
+
+        ShaderAtlasTexture getTexture(const ResourceHandle<Texture> &texture, Entry &entry);
+
+        FrameGraphTextureAtlas &atlas;
+
+        std::vector<Entry> entries; // Indexed by material id
+        std::vector<uint32_t> freeIds;
+        std::map<Uri, uint32_t> materials;
+
+        std::map<Uri, TextureEntry> textures;
+
+        std::vector<ShaderMaterial> shaderData; // Indexed by material id
+        std::set<uint32_t> dirtyIds;
+
+        FrameGraphResource buffer;
+        size_t bufferCapacity = 0;
+
+        Material defaultMaterial;
+    };
+}
+
+#endif //XENGINE_MATERIALTABLE_HPP
@@ -33,10 +33,45 @@ namespace xng {
                 Primitive primitive = TRIANGLES;
                 DrawCall drawCall{};
                 size_t baseVertex = 0;
+                std::vector<DrawCall> lods; // The draw calls of Mesh::lods which use the vertices of drawCall
+
+                // The Mesh::positionOffset and Mesh::positionScale of the uploaded vertices
+                Vec3f positionOffset;
+                Vec3f positionScale = Vec3f(1);
+
+                /**
+                 * @param lod The level of detail, levels beyond the levels of the mesh use the coarsest level
+                 * @return
+                 */
+                const DrawCall &getDrawCall(size_t lod) const {
+                    if (lod == 0 || lods.empty()) {
+                        return drawCall;
+                    }
+                    return lods.at(std::min(lod, lods.size()) - 1);
+                }
             };
             std::vector<Data> data;
+
+            /**
+             * The error of each level of detail in object space, the maximum over the mesh and its sub meshes.
+             * The first level is the full resolution mesh with an error of 0.
+             */
+            std::vector<float> lodErrors;
+
+            Vec4f bounds; // The object space bounding sphere with the center in xyz and the radius in w
         };
 
+        /**
+         * @param vertexLayout The layout of the vertex buffer, either SkinnedMesh::getDefaultVertexLayout or SkinnedMesh::getCompactVertexLayout
+         */
+        explicit MeshAllocator(VertexLayout vertexLayout = SkinnedMesh::getDefaultVertexLayout());
+
+        /**
+         * Meshes in the default or compact skinned layout which do not match the vertex layout of the allocator
+         * are converted before upload.
+         *
+         * @param mesh
+         */
         void prepareMeshAllocation(const ResourceHandle<SkinnedMesh> &mesh);
 
         MeshAllocation getAllocatedMesh(const ResourceHandle<SkinnedMesh> &mesh);
@@ -57,6 +92,10 @@ namespace xng {
             return meshAllocations;
         }
 
+        const VertexLayout &getVertexLayout() const {
+            return vertexLayout;
+        }
+
     private:
         MeshAllocation allocateMesh(const Mesh &mesh);
 
@@ -80,9 +119,12 @@ namespace xng {
 
         void mergeFreeIndexBufferRanges();
 
+        VertexLayout vertexLayout;
+
         std::map<Uri, MeshAllocation> meshAllocations;
         std::map<Uri, MeshAllocation> pendingMeshAllocations;
         std::map<Uri, ResourceHandle<SkinnedMesh>> pendingMeshHandles;
+        std::map<Uri, SkinnedMesh> pendingConvertedMeshes; // Pending meshes which were converted to vertexLayout
 
         size_t requestedVertexBufferSize{};
         size_t requestedIndexBufferSize{};
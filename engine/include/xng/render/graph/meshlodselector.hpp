@@ -0,0 +1,100 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MESHLODSELECTOR_HPP
+#define XENGINE_MESHLODSELECTOR_HPP
+
+#include <unordered_map>
+#include <cstdint>
+
+#include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/scene/camera.hpp"
+#include "xng/render/scene/property.hpp"
+
+namespace xng {
+    /**
+     * Selects the level of detail of objects from the projected size of the level errors.
+     *
+     * The coarsest level whose projected error is below the threshold is selected,
+     * switching to a coarser level additionally requires the projected error to be below threshold * (1 - hysteresis)
+     * so that objects near the threshold distance do not alternate between levels.
+     */
+    class XENGINE_EXPORT MeshLodSelector {
+    public:
+        /**
+         * Must be called once per frame before select, objects which were not selected in the previous frame are forgotten.
+         *
+         * @param camera
+         * @param cameraTransform
+         * @param resolution The render resolution in pixels
+         * @param threshold The maximum projected error in pixels
+         * @param hysteresis Range(0, 1)
+         */
+        void beginFrame(const Camera &camera,
+                        const Transform &cameraTransform,
+                        const Vec2i &resolution,
+                        float threshold,
+                        float hysteresis);
+
+        /**
+         * @param object The identifier of the object which must be stable across frames, see getObjectId
+         * @param mesh
+         * @param transform The transform of the object
+         * @param bias The number of levels added to the selected level, for example for shadow maps
+         * @return The level of detail to pass to MeshAllocation::Data::getDrawCall
+         */
+        size_t select(uint64_t object,
+                      const MeshAllocator::MeshAllocation &mesh,
+                      const Transform &transform,
+                      size_t bias = 0);
+
+        /**
+         * @param distance The distance to the camera
+         * @return The number of pixels covered by one world space unit at the given distance
+         */
+        float getPixelsPerUnit(float distance) const;
+
+        /**
+         * The scene nodes are recreated every frame so their addresses cannot be used to identify objects.
+         *
+         * @param property The mesh property of the node
+         * @param nodeIndex The index of the node in the drawn nodes, only used if the property has no object id
+         * @return The object id of the property if it has one, otherwise an identifier derived from the node index which does not collide with object ids
+         */
+        static uint64_t getObjectId(const SkinnedMeshProperty &property, size_t nodeIndex);
+
+    private:
+        struct State {
+            size_t lod = 0;
+            uint64_t frame = 0;
+        };
+
+        std::unordered_map<uint64_t, State> states;
+        uint64_t frame = 0;
+
+        CameraType cameraType = PERSPECTIVE;
+        Vec3f cameraPosition;
+        float projectionScale = 1;
+        float nearClip = 0.1f;
+        float threshold = 1;
+        float hysteresis = 0;
+    };
+}
+
+#endif //XENGINE_MESHLODSELECTOR_HPP
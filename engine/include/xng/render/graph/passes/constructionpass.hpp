@@ -28,6 +28,9 @@
 #include "xng/render/graph/framegraphtextureatlas.hpp"
 #include "xng/render/scene/scene.hpp"
 #include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/graph/meshlodselector.hpp"
+#include "xng/render/graph/materialtable.hpp"
+#include "xng/render/graph/framegraphbonepalette.hpp"
 
 namespace xng {
     /**
@@ -42,11 +45,6 @@ namespace xng {
         std::type_index getTypeIndex() const override;
 
     private:
-        TextureAtlasHandle getTexture(const ResourceHandle<Texture> &texture,
-                                      std::map<TextureAtlasResolution, FrameGraphResource> &atlasBuffers);
-
-        void deallocateTexture(const ResourceHandle<Texture> &texture);
-
         FrameGraphResource renderPipeline;
         FrameGraphResource renderPipelineSkinned;
 
@@ -54,13 +52,15 @@ namespace xng {
         FrameGraphResource indexBuffer;
 
         FrameGraphTextureAtlas atlas;
+        MaterialTable materials{atlas};
 
         size_t currentVertexBufferSize{};
         size_t currentIndexBufferSize{};
 
         MeshAllocator meshAllocator;
+        MeshLodSelector lodSelector;
 
-        std::map<Uri, TextureAtlasHandle> textures;
+        FrameGraphBonePalette bonePalette;
     };
 }
 
@@ -23,6 +23,7 @@
 #include "xng/render/scene/scene.hpp"
 #include "xng/render/graph/framegraphpass.hpp"
 #include "xng/render/graph/framegraphresource.hpp"
+#include "xng/render/lighting/lightclustergrid.hpp"
 
 namespace xng {
     /**
@@ -48,6 +49,8 @@ namespace xng {
         FrameGraphResource cubeVertexBuffer;
 
         FrameGraphResource pipeline;
+
+        LightClusterGrid lightClusters;
     };
 }
 
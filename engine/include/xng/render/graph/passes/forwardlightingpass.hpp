@@ -23,8 +23,11 @@
 #include "xng/render/graph/framegraphpass.hpp"
 #include "xng/render/graph/framegraphtextureatlas.hpp"
 #include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/graph/meshlodselector.hpp"
+#include "xng/render/graph/materialtable.hpp"
 
 #include "xng/render/atlas/textureatlas.hpp"
+#include "xng/render/lighting/lightclustergrid.hpp"
 
 namespace xng {
     /**
@@ -43,23 +46,20 @@ namespace xng {
         std::type_index getTypeIndex() const override;
 
     private:
-        TextureAtlasHandle getTexture(const ResourceHandle <Texture> &texture,
-                                      std::map<TextureAtlasResolution, FrameGraphResource> &atlasBuffers);
-
-        void deallocateTexture(const ResourceHandle<Texture> &texture);
-
         FrameGraphResource pipeline;
         FrameGraphResource vertexBuffer;
         FrameGraphResource indexBuffer;
 
         FrameGraphTextureAtlas atlas;
+        MaterialTable materials{atlas};
 
         size_t currentVertexBufferSize{};
         size_t currentIndexBufferSize{};
 
         MeshAllocator meshAllocator;
+        MeshLodSelector lodSelector;
 
-        std::map<Uri, TextureAtlasHandle> textures;
+        LightClusterGrid lightClusters;
     };
 }
 #endif //XENGINE_FORWARDLIGHTINGPASS_HPP
@@ -0,0 +1,53 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef XENGINE_PARTICLEPASS_HPP
+#define XENGINE_PARTICLEPASS_HPP
+
+#include "xng/render/graph/framegraphpass.hpp"
+#include "xng/render/graph/framegraphresource.hpp"
+#include "xng/render/scene/mesh.hpp"
+
+namespace xng {
+    /**
+     * The ParticlePass draws the particles of all nodes with a ParticleProperty as camera facing billboards
+     * to the SCREEN_COLOR texture.
+     *
+     * The particles of all emitters are uploaded into a single shader storage buffer and drawn with one instanced draw call.
+     * Emitters are drawn back to front, the particles of an emitter are drawn in the order they are stored in the property.
+     *
+     * Depth testing is performed with the existing contents of SCREEN_DEPTH, particles do not write depth.
+     */
+    class XENGINE_EXPORT ParticlePass : public FrameGraphPass {
+    public:
+        ~ParticlePass() override = default;
+
+        void setup(FrameGraphBuilder &builder) override;
+
+        std::type_index getTypeIndex() const override;
+
+    private:
+        Mesh mesh = Mesh::normalizedQuad();
+
+        FrameGraphResource pipeline;
+        FrameGraphResource vertexBuffer;
+    };
+}
+
+#endif //XENGINE_PARTICLEPASS_HPP
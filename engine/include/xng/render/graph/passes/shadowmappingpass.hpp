@@ -23,12 +23,24 @@
 #include "xng/render/graph/framegraphpass.hpp"
 #include "xng/render/scene/pointlight.hpp"
 #include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/graph/meshlodselector.hpp"
 #include "xng/render/scene/scene.hpp"
+#include "xng/render/graph/shadowmapcache.hpp"
+#include "xng/render/graph/framegraphbonepalette.hpp"
 
 namespace xng {
     /**
      * The shadow mapping pass creates the shadow mapping textures.
      *
+     * The shadow maps are persistent texture arrays in which each shadow casting light keeps its layer across frames.
+     * A layer is only re-rendered when the projection of its light changes or when a shadow caster within range of the light changes,
+     * SETTING_SHADOW_MAPPING_UPDATE_BUDGET limits the number of layers rendered per frame.
+     *
+     * Directional lights are optionally split into cascades fitted to the camera frustum (SETTING_SHADOW_MAPPING_DIRECTIONAL_CASCADES).
+     *
+     * The layers and transforms of the lights are written to the SLOT_SHADOW_MAP_*_DATA buffers
+     * in the order of the shadow casting lights returned by Node::findAll.
+     *
      * Writes SLOT_SHADOW_MAP_*
      */
     class XENGINE_EXPORT ShadowMappingPass : public FrameGraphPass {
@@ -39,11 +51,22 @@ namespace xng {
 
         std::type_index getTypeIndex() const override;
 
+        typedef ShadowMapCache::Caster ShadowCaster;
+
     private:
+        ShadowCaster getShadowCaster(const ResourceHandle<SkinnedMesh> &mesh,
+                                     const Mat4f &model,
+                                     const BonePalette &bonePalette,
+                                     size_t paletteOffset,
+                                     size_t lod);
+
         size_t currentVertexBufferSize{};
         size_t currentIndexBufferSize{};
 
         MeshAllocator meshAllocator;
+        MeshLodSelector lodSelector;
+
+        FrameGraphBonePalette bonePalette;
 
         FrameGraphResource pointPipeline;
         FrameGraphResource dirPipeline;
@@ -53,6 +76,24 @@ namespace xng {
 
         FrameGraphResource staleVertexBuffer;
         FrameGraphResource staleIndexBuffer;
+
+        ShadowMapCache pointShadowCache;
+        ShadowMapCache dirShadowCache;
+        ShadowMapCache spotShadowCache;
+
+        FrameGraphResource pointLightShadowMap;
+        FrameGraphResource dirLightShadowMap;
+        FrameGraphResource spotLightShadowMap;
+
+        size_t pointShadowCapacity{};
+        size_t dirShadowCapacity{};
+        size_t spotShadowCapacity{};
+
+        Vec2i currentPointResolution;
+        Vec2i currentDirResolution;
+        Vec2i currentSpotResolution;
+
+        std::map<Uri, Vec4f> meshBounds; // The local bounding sphere of each mesh, xyz = center, w = radius
     };
 }
 #endif //XENGINE_SHADOWMAPPINGPASS_HPP
@@ -28,6 +28,7 @@
 #include "xng/render/graph/framegraphtextureatlas.hpp"
 #include "xng/render/scene/scene.hpp"
 #include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/graph/framegraphbonepalette.hpp"
 
 namespace xng {
     /**
@@ -53,6 +54,8 @@ namespace xng {
         size_t currentIndexBufferSize{};
 
         MeshAllocator meshAllocator;
+
+        FrameGraphBonePalette bonePalette;
     };
 }
 
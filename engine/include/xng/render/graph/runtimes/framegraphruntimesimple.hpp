@@ -27,6 +27,7 @@
 #include "xng/shader/shaderdecompiler.hpp"
 
 #include "xng/gpu/renderdevice.hpp"
+#include "xng/gpu/renderpipelinecache.hpp"
 
 namespace xng {
     /**
@@ -45,6 +46,11 @@ namespace xng {
 
         const RenderDeviceInfo &getRenderDeviceInfo() override;
 
+        /**
+         * The pipeline cache can be used to configure the capacity and the on disk cache directory.
+         */
+        RenderPipelineCache &getPipelineCache() { return pipelineCache; }
+
     private:
         RenderObject &getObject(FrameGraphResource resource);
 
@@ -58,6 +64,8 @@ namespace xng {
 
         void cmdCopy(const FrameGraphCommand &cmd);
 
+        void cmdCopyTextureRegion(const FrameGraphCommand &cmd);
+
         void cmdGenerateMipMap(const FrameGraphCommand &cmd);
 
         void cmdBlit(const FrameGraphCommand &cmd);
@@ -133,7 +141,7 @@ namespace xng {
         ShaderCompiler &shaderCompiler;
         ShaderDecompiler &shaderDecompiler;
 
-        std::unordered_map<RenderPipelineDesc, std::unique_ptr<RenderPipeline>> pipelines;
+        RenderPipelineCache pipelineCache;
         std::unordered_map<RenderPassDesc, std::unique_ptr<RenderPass>> passes;
         std::unordered_map<VertexBufferDesc, std::vector<std::unique_ptr<VertexBuffer>>> vertexBuffers;
         std::unordered_map<IndexBufferDesc, std::vector<std::unique_ptr<IndexBuffer>>> indexBuffers;
@@ -145,7 +153,6 @@ namespace xng {
         std::unordered_map<RenderTargetDesc, std::vector<std::unique_ptr<RenderTarget>>> targets;
         std::vector<std::unique_ptr<CommandBuffer>> commandBuffers;
 
-        std::unordered_map<RenderPipelineDesc, int> usedPipelines;
         std::unordered_map<RenderPassDesc, int> usedPasses;
         std::unordered_map<VertexBufferDesc, int> usedVertexBuffers;
         std::unordered_map<IndexBufferDesc, int> usedIndexBuffers;
@@ -0,0 +1,110 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef XENGINE_SHADOWMAPCACHE_HPP
+#define XENGINE_SHADOWMAPCACHE_HPP
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+#include "xng/math/vector3.hpp"
+
+namespace xng {
+    /**
+     * Assigns persistent texture array layers to shadow maps and decides which shadow maps have to be rendered.
+     *
+     * A shadow map is identified by the hash of its light state (position, direction, projection)
+     * so that a light keeps its layer and cached contents as long as it does not change.
+     * The caster hash covers the shadow casters within the range of the light,
+     * the cached shadow map is rendered again when the caster hash changes.
+     */
+    class XENGINE_EXPORT ShadowMapCache {
+    public:
+        struct Request {
+            uint64_t lightHash = 0;
+            uint64_t casterHash = 0;
+        };
+
+        struct Caster {
+            Vec3f center; // The center of the bounding sphere of the caster
+            float radius;
+            uint64_t hash; // The hash of the state which affects the shadow of the caster
+        };
+
+        struct Allocation {
+            size_t layer = 0;
+            bool render = false; // The shadow map must be rendered into the layer
+            bool clear = false; // The layer contains no valid shadow map and was not scheduled for rendering because of the budget
+        };
+
+        /**
+         * @param minCapacity The minimum number of layers, the capacity grows to the next power of two of the number of requests.
+         */
+        explicit ShadowMapCache(size_t minCapacity = 4);
+
+        /**
+         * Assign layers to the shadow maps of the current frame.
+         *
+         * Shadow maps which were never rendered into their layer are rendered first,
+         * then the outdated shadow maps which were rendered the longest time ago.
+         *
+         * When the capacity grows all cached shadow maps are invalidated because the texture array has to be recreated.
+         *
+         * @param requests The shadow maps of the current frame
+         * @param budget The maximum number of shadow maps to render
+         * @return The allocations in the order of the requests
+         */
+        std::vector<Allocation> update(const std::vector<Request> &requests,
+                                       size_t budget = std::numeric_limits<size_t>::max());
+
+        /**
+         * Hash the casters which can cast a shadow into the range of a light.
+         *
+         * @param casters
+         * @param center The center of the range of the light
+         * @param radius The radius of the range of the light
+         * @return The hash of the casters whose bounding sphere intersects the range, independent of the order of the casters
+         */
+        static uint64_t getCasterHash(const std::vector<Caster> &casters, const Vec3f &center, float radius);
+
+        /**
+         * Mark all layers as invalid, for example when the texture array was recreated.
+         */
+        void invalidate();
+
+        size_t getCapacity() const { return slots.size(); }
+
+    private:
+        struct Slot {
+            bool used = false;
+            bool valid = false;
+            uint64_t lightHash = 0;
+            uint64_t casterHash = 0;
+            uint64_t renderFrame = 0;
+        };
+
+        size_t minCapacity;
+        uint64_t frame = 0;
+        std::vector<Slot> slots;
+    };
+}
+
+#endif //XENGINE_SHADOWMAPCACHE_HPP
@@ -0,0 +1,163 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_LIGHTCLUSTERGRID_HPP
+#define XENGINE_LIGHTCLUSTERGRID_HPP
+
+#include <vector>
+#include <array>
+#include <cstdint>
+
+#include "xng/render/scene/camera.hpp"
+#include "xng/render/scene/pointlight.hpp"
+#include "xng/render/scene/spotlight.hpp"
+
+namespace xng {
+    /**
+     * The grid parameters passed to the lighting shaders, layout matches the std140 block
+     * { mat4 view; vec4 viewportSize_depthScale_depthBias; ivec4 gridSize; }
+     */
+    struct LightClusterInfo {
+        Mat4f view;
+        std::array<float, 4> viewportSize_depthScale_depthBias{0, 0, 0, 0};
+        std::array<int, 4> gridSize{0, 0, 0, 0};
+    };
+
+    /**
+     * The light list of a cluster, layout matches a std430 array of uvec2 { offset, count }
+     */
+    struct LightCluster {
+        uint32_t offset = 0; // The index of the first light index of the cluster in the light index list
+        uint32_t count = 0;
+    };
+
+    static_assert(sizeof(LightCluster) == 8);
+
+    /**
+     * Bins lights into a froxel grid in view space so that the lighting shaders only evaluate the lights
+     * which can affect the cluster of the shaded fragment.
+     *
+     * The view frustum is split into tilesX * tilesY screen space tiles and into depth slices which are distributed
+     * logarithmically between the near and far clip plane of the camera.
+     * Each light is bounded by a sphere whose radius is the distance at which the light intensity falls below a threshold.
+     *
+     * The slices are binned in parallel on the ThreadPool if the number of lights exceeds the parallel threshold.
+     */
+    class XENGINE_EXPORT LightClusterGrid {
+    public:
+        /**
+         * The type of light referenced by a light index, stored in the two most significant bits of the index.
+         */
+        enum LightType : uint32_t {
+            LIGHT_POINT = 0,
+            LIGHT_POINT_SHADOW = 1,
+            LIGHT_SPOT = 2,
+            LIGHT_SPOT_SHADOW = 3
+        };
+
+        static const uint32_t LIGHT_TYPE_SHIFT = 30;
+        static const uint32_t LIGHT_INDEX_MASK = (1u << LIGHT_TYPE_SHIFT) - 1;
+
+        struct LightBounds {
+            Vec3f position; // World space
+            float radius = 0;
+            uint32_t index = 0; // The encoded light index
+        };
+
+        static uint32_t encodeLightIndex(LightType type, uint32_t index) {
+            return (static_cast<uint32_t>(type) << LIGHT_TYPE_SHIFT) | (index & LIGHT_INDEX_MASK);
+        }
+
+        /**
+         * @param light
+         * @param threshold The radiance below which the light is ignored
+         * @return The distance at which the radiance of the light falls below threshold
+         */
+        static float getRadius(const PointLight &light, float threshold);
+
+        static float getRadius(const SpotLight &light, float threshold);
+
+        explicit LightClusterGrid(int tilesX = 16, int tilesY = 9, int slices = 24, size_t parallelThreshold = 64);
+
+        /**
+         * Rebuild the light lists of all clusters.
+         *
+         * @param camera The camera used for rendering, the cluster bounds are only recomputed when the projection changed.
+         * @param viewMatrix The view matrix of the camera
+         * @param viewportSize The size of the viewport in pixels
+         * @param lights The lights to bin
+         */
+        void build(const Camera &camera,
+                   const Mat4f &viewMatrix,
+                   const Vec2i &viewportSize,
+                   const std::vector<LightBounds> &lights);
+
+        const LightClusterInfo &getInfo() const { return info; }
+
+        const std::vector<LightCluster> &getClusters() const { return clusters; }
+
+        const std::vector<uint32_t> &getLightIndices() const { return lightIndices; }
+
+        /**
+         * Compute the cluster of a fragment in the same way as the lighting shaders.
+         *
+         * @param worldPosition The world space position of the fragment
+         * @param fragCoord The window space position of the fragment in pixels
+         * @return The index into getClusters()
+         */
+        size_t getClusterIndex(const Vec3f &worldPosition, const Vec2f &fragCoord) const;
+
+        int getTilesX() const { return tilesX; }
+
+        int getTilesY() const { return tilesY; }
+
+        int getSlices() const { return slices; }
+
+    private:
+        struct Range {
+            float min;
+            float max;
+        };
+
+        void updateBounds(const Camera &camera);
+
+        void binSlice(int slice, const std::vector<Vec4f> &viewLights, const std::vector<LightBounds> &lights);
+
+        int tilesX;
+        int tilesY;
+        int slices;
+        size_t parallelThreshold;
+
+        // The projection parameters for which the bounds were computed
+        std::array<float, 9> boundsKey{};
+        bool boundsValid = false;
+
+        std::vector<Range> sliceDepths; // The view space depth range of each slice, depth is the negated view space z
+        std::vector<Range> columnRanges; // The view space x range of each column per slice
+        std::vector<Range> rowRanges; // The view space y range of each row per slice
+
+        std::vector<std::vector<uint32_t>> bins;
+
+        LightClusterInfo info;
+        std::vector<LightCluster> clusters;
+        std::vector<uint32_t> lightIndices;
+    };
+}
+
+#endif //XENGINE_LIGHTCLUSTERGRID_HPP
@@ -0,0 +1,112 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef XENGINE_PARTICLEEMITTER_HPP
+#define XENGINE_PARTICLEEMITTER_HPP
+
+#include "xng/io/messageable.hpp"
+#include "xng/math/vector3.hpp"
+#include "xng/render/scene/color.hpp"
+
+namespace xng {
+    /**
+     * Describes how particles are spawned and how they evolve over their lifetime.
+     *
+     * Particles are simulated in world space, the spawn position is the emitter origin plus a random offset inside spawnExtent.
+     */
+    struct XENGINE_EXPORT ParticleEmitter : public Messageable {
+        float spawnRate = 100; // Particles spawned per second
+        size_t maxParticles = 10000; // The maximum number of alive particles
+
+        float lifetimeMin = 1; // Seconds
+        float lifetimeMax = 2; // Seconds
+
+        Vec3f spawnExtent = {}; // Half extents of the box around the origin in which particles are spawned
+
+        Vec3f velocity = {0, 1, 0}; // The initial velocity
+        Vec3f velocityVariance = {}; // Random per axis offset in the range [-velocityVariance, velocityVariance] applied to the initial velocity
+
+        Vec3f acceleration = {}; // Constant acceleration eg. gravity
+        float drag = 0; // Velocity damping per second
+
+        float startSize = 1;
+        float endSize = 1;
+
+        ColorRGBA startColor = ColorRGBA::white();
+        ColorRGBA endColor = ColorRGBA::white(1, 0);
+
+        bool sortParticles = true; // If true particles are sorted back to front relative to the camera for alpha blending
+
+        bool operator==(const ParticleEmitter &other) const {
+            return spawnRate == other.spawnRate
+                   && maxParticles == other.maxParticles
+                   && lifetimeMin == other.lifetimeMin
+                   && lifetimeMax == other.lifetimeMax
+                   && spawnExtent == other.spawnExtent
+                   && velocity == other.velocity
+                   && velocityVariance == other.velocityVariance
+                   && acceleration == other.acceleration
+                   && drag == other.drag
+                   && startSize == other.startSize
+                   && endSize == other.endSize
+                   && startColor == other.startColor
+                   && endColor == other.endColor
+                   && sortParticles == other.sortParticles;
+        }
+
+        Messageable &operator<<(const Message &message) override {
+            message.value("spawnRate", spawnRate, 100.0f);
+            message.value("maxParticles", maxParticles, static_cast<size_t>(10000));
+            message.value("lifetimeMin", lifetimeMin, 1.0f);
+            message.value("lifetimeMax", lifetimeMax, 2.0f);
+            message.value("spawnExtent", spawnExtent);
+            message.value("velocity", velocity, Vec3f(0, 1, 0));
+            message.value("velocityVariance", velocityVariance);
+            message.value("acceleration", acceleration);
+            message.value("drag", drag);
+            message.value("startSize", startSize, 1.0f);
+            message.value("endSize", endSize, 1.0f);
+            message.value("startColor", startColor, ColorRGBA::white());
+            message.value("endColor", endColor, ColorRGBA::white(1, 0));
+            message.value("sortParticles", sortParticles, true);
+            return *this;
+        }
+
+        Message &operator>>(Message &message) const override {
+            message = Message(Message::DICTIONARY);
+            spawnRate >> message["spawnRate"];
+            maxParticles >> message["maxParticles"];
+            lifetimeMin >> message["lifetimeMin"];
+            lifetimeMax >> message["lifetimeMax"];
+            spawnExtent >> message["spawnExtent"];
+            velocity >> message["velocity"];
+            velocityVariance >> message["velocityVariance"];
+            acceleration >> message["acceleration"];
+            drag >> message["drag"];
+            startSize >> message["startSize"];
+            endSize >> message["endSize"];
+            startColor >> message["startColor"];
+            endColor >> message["endColor"];
+            sortParticles >> message["sortParticles"];
+            return message;
+        }
+    };
+}
+
+#endif //XENGINE_PARTICLEEMITTER_HPP
@@ -0,0 +1,157 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef XENGINE_PARTICLEPOOL_HPP
+#define XENGINE_PARTICLEPOOL_HPP
+
+#include <vector>
+#include <cstdint>
+
+#include "xng/render/particles/particleemitter.hpp"
+
+namespace xng {
+    /**
+     * The per particle data passed to the renderer, layout matches a std140 array of { vec4 positionSize; vec4 color; }
+     */
+    struct ParticleInstance {
+        float position[3]{0, 0, 0};
+        float size{0};
+        float color[4]{0, 0, 0, 0};
+    };
+
+    static_assert(sizeof(ParticleInstance) == 32);
+
+    /**
+     * A pool of particles stored as structure of arrays.
+     *
+     * Each attribute is stored in a separate contiguous float array so that the simulation loops
+     * can be vectorized by the compiler. The spawn, integrate, kill and sort steps split the particle range into chunks
+     * which are processed in parallel on the ThreadPool if the number of particles exceeds the parallel threshold.
+     *
+     * The pool is not thread safe.
+     */
+    class XENGINE_EXPORT ParticlePool {
+    public:
+        ParticlePool() = default;
+
+        /**
+         * @param capacity The maximum number of alive particles
+         * @param parallelThreshold The minimum number of particles required for a step to be run in parallel.
+         */
+        explicit ParticlePool(size_t capacity, size_t parallelThreshold = 16384);
+
+        /**
+         * Spawn up to count particles, limited by the remaining capacity.
+         *
+         * @param count The number of particles to spawn
+         * @param origin The world space origin of the emitter
+         * @param emitter The emitter parameters
+         * @param seed The random seed used to generate the initial particle values
+         * @return The number of spawned particles
+         */
+        size_t spawn(size_t count, const Vec3f &origin, const ParticleEmitter &emitter, uint64_t seed);
+
+        /**
+         * Advance the age of all particles and integrate velocity and position using semi implicit euler.
+         *
+         * @param deltaTime Seconds
+         */
+        void integrate(float deltaTime, const ParticleEmitter &emitter);
+
+        /**
+         * Remove all particles whose age exceeds their lifetime, the relative order of the surviving particles is preserved.
+         */
+        void kill();
+
+        /**
+         * Sort the particle draw order back to front by the squared distance to the view position.
+         *
+         * Each chunk is radix sorted in parallel and the sorted chunks are merged pairwise.
+         */
+        void sort(const Vec3f &viewPosition);
+
+        /**
+         * Write the render instances in draw order into instances.
+         * The size and color are interpolated between the emitter start and end values based on the normalized age.
+         */
+        void writeInstances(const ParticleEmitter &emitter, std::vector<ParticleInstance> &instances) const;
+
+        /**
+         * Convenience method which runs integrate, kill, spawn and sort (if emitter.sortParticles is set) in that order.
+         *
+         * @param spawnAccumulator Fractional particles carried over between calls to keep the spawn rate independent of the frame rate.
+         */
+        void update(float deltaTime,
+                    const Vec3f &origin,
+                    const Vec3f &viewPosition,
+                    const ParticleEmitter &emitter,
+                    float &spawnAccumulator,
+                    uint64_t seed);
+
+        void clear();
+
+        size_t size() const { return count; }
+
+        size_t getCapacity() const { return capacity; }
+
+        void setCapacity(size_t value);
+
+        size_t getParallelThreshold() const { return parallelThreshold; }
+
+        void setParallelThreshold(size_t value) { parallelThreshold = value; }
+
+        const std::vector<float> &getPositionX() const { return arrays.posX; }
+
+        const std::vector<float> &getPositionY() const { return arrays.posY; }
+
+        const std::vector<float> &getPositionZ() const { return arrays.posZ; }
+
+        const std::vector<float> &getAge() const { return arrays.age; }
+
+        const std::vector<float> &getLifetime() const { return arrays.lifetime; }
+
+        /**
+         * @return The particle indices in draw order, only valid after a call to sort.
+         */
+        const std::vector<uint32_t> &getOrder() const { return order; }
+
+    private:
+        struct Arrays {
+            std::vector<float> posX, posY, posZ;
+            std::vector<float> velX, velY, velZ;
+            std::vector<float> age, lifetime;
+
+            void resize(size_t size);
+        };
+
+        size_t count = 0;
+        size_t capacity = 0;
+        size_t parallelThreshold = 16384;
+
+        Arrays arrays;
+        Arrays backArrays; // Compaction target, swapped with arrays after kill
+
+        std::vector<uint64_t> sortKeys; // Inverted depth in the upper 32 bits, particle index in the lower 32 bits
+        std::vector<uint64_t> sortBuffer;
+        std::vector<uint32_t> order;
+        bool orderValid = false;
+    };
+}
+
+#endif //XENGINE_PARTICLEPOOL_HPP
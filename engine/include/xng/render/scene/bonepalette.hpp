@@ -0,0 +1,93 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_BONEPALETTE_HPP
+#define XENGINE_BONEPALETTE_HPP
+
+#include <vector>
+
+#include "xng/math/matrix.hpp"
+
+namespace xng {
+    /**
+     * The skinning transforms of all animated meshes in a scene stored in one contiguous array.
+     *
+     * Each skinned node adds the transforms of its rig in the order of Rig::getBones() once per frame
+     * and references them by the returned offset, the passes translate the mesh local bone indices
+     * of the vertices into palette indices instead of uploading their own copy of the transforms.
+     *
+     * The first entry is always the identity transform and is used for bones which are not animated.
+     */
+    class XENGINE_EXPORT BonePalette {
+    public:
+        enum Format : int {
+            MATRIX_3X4 = 0, // The upper three rows of the matrix, supports scaled bones
+            DUAL_QUATERNION, // A unit dual quaternion, avoids the volume loss of linear blending but drops any scale
+        };
+
+        /**
+         * @param format
+         * @return The number of vec4 values used per bone
+         */
+        static size_t getStride(Format format);
+
+        /**
+         * @param transform
+         * @param format
+         * @param out Receives getStride(format) * 4 floats
+         */
+        static void encode(const Mat4f &transform, Format format, float *out);
+
+        /**
+         * @param data getStride(format) * 4 floats created by encode
+         * @param format
+         * @return
+         */
+        static Mat4f decode(const float *data, Format format);
+
+        BonePalette();
+
+        /**
+         * @param transforms The skinning transforms in the order of the bones in the rig
+         * @return The offset of the first transform in the palette, 0 if transforms is empty
+         */
+        size_t add(const std::vector<Mat4f> &transforms);
+
+        /**
+         * Remove all transforms except the identity entry.
+         */
+        void clear();
+
+        /**
+         * @param format
+         * @return The encoded transforms, getStride(format) * 4 floats per entry
+         */
+        std::vector<float> encode(Format format) const;
+
+        const std::vector<Mat4f> &getTransforms() const { return transforms; }
+
+        size_t size() const { return transforms.size(); }
+
+    private:
+        std::vector<Mat4f> transforms;
+    };
+}
+
+#endif //XENGINE_BONEPALETTE_HPP
@@ -54,6 +54,10 @@ namespace xng {
             return typeid(Image<T>);
         }
 
+        size_t getMemoryUsage() const override {
+            return buffer.size() * sizeof(T);
+        }
+
         Image() : resolution(), buffer() {}
 
         Image(int width, int height, const std::vector<T> &buffer) : resolution(width, height), buffer(buffer) {}
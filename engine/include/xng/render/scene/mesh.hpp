@@ -30,6 +30,7 @@
 
 #include "xng/render/geometry/vertex.hpp"
 #include "xng/render/geometry/primitive.hpp"
+#include "xng/render/geometry/meshoptimizer.hpp"
 
 #include "xng/resource/resource.hpp"
 
@@ -42,6 +43,14 @@
 
 namespace xng {
     struct XENGINE_EXPORT Mesh : public Resource {
+        /**
+         * A simplified version of the mesh which indexes into the vertices of the mesh.
+         */
+        struct Lod {
+            std::vector<unsigned int> indices;
+            float error = 0; // The maximum distance to the full resolution mesh in units of the vertex positions
+        };
+
         /**
          * Create a standard vertex buffer description which is the format of meshes returned by the resource abstraction.
          *
@@ -69,6 +78,29 @@ namespace xng {
             return VertexLayout(layout);
         }
 
+        /**
+         * Create a quantized vertex buffer description which stores the same data as the default layout in 20 bytes per vertex.
+         *
+         * The position is quantized relative to positionOffset and positionScale,
+         * the normal and tangent are octahedral encoded and the bitangent is stored as the sign of cross(normal, tangent).
+         *
+         * eg. GLSL:
+         *  layout (location = 0) in vec4 positionBitangentSign; // snorm16
+         *  layout (location = 1) in vec4 normalTangent; // snorm16, octahedral normal in xy and tangent in zw
+         *  layout (location = 2) in vec2 uv; // half float
+         *
+         * @return
+         */
+        static VertexLayout getCompactVertexLayout() {
+            const std::vector<VertexAttribute> layout = {
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::SIGNED_SHORT, 0, true),
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::SIGNED_SHORT, 0, true),
+                    VertexAttribute(VertexAttribute::VECTOR2, VertexAttribute::HALF_FLOAT),
+            };
+
+            return VertexLayout(layout);
+        }
+
         /**
          * eg. GLSL:
          *  layout (location = 0) in vec3 position;
@@ -124,6 +156,19 @@ namespace xng {
 
         std::vector<Mesh> subMeshes;
 
+        /**
+         * The levels of detail of this mesh ordered from finest to coarsest, not including the full resolution indices.
+         * Sub meshes store their own levels.
+         */
+        std::vector<Lod> lods;
+
+        /**
+         * The transformation from the quantized positions of a compact vertex layout to object space,
+         * position = positionOffset + quantizedPosition * positionScale
+         */
+        Vec3f positionOffset;
+        Vec3f positionScale = Vec3f(1);
+
         Mesh() = default;
 
         Mesh(Primitive primitive, std::vector<Vertex> vertices)
@@ -168,6 +213,31 @@ namespace xng {
 
         std::type_index getTypeIndex() const override;
 
+        size_t getMemoryUsage() const override {
+            size_t ret = indices.size() * sizeof(unsigned int);
+            for (auto &lod: lods) {
+                ret += lod.indices.size() * sizeof(unsigned int);
+            }
+            for (auto &vertex: vertices) {
+                ret += vertex.buffer.size();
+            }
+            for (auto &mesh: subMeshes) {
+                ret += mesh.getMemoryUsage();
+            }
+            return ret;
+        }
+
+        /**
+         * Reorder the triangles of the mesh and its levels of detail for the vertex cache and overdraw
+         * and reorder the vertices in the order they are fetched by the full resolution indices.
+         *
+         * Only indexed triangle meshes are optimized, sub meshes are optimized recursively.
+         * The overdraw optimization is skipped if the first vertex attribute is not a float vector3 or compact position.
+         *
+         * @return The vertex cache statistics of the full resolution indices of this mesh and its sub meshes
+         */
+        MeshOptimizer::Report optimize();
+
         size_t polyCount() const {
             if (indices.empty())
                 return vertices.size() / primitive;
@@ -21,10 +21,12 @@
 #define XENGINE_PROPERTY_HPP
 
 #include <typeindex>
+#include <memory>
 
 #include "xng/render/scene/pointlight.hpp"
 #include "xng/render/scene/directionallight.hpp"
 #include "xng/render/scene/spotlight.hpp"
+#include "xng/render/particles/particlepool.hpp"
 
 namespace xng {
     struct XENGINE_EXPORT Property {
@@ -72,6 +74,12 @@ namespace xng {
         }
 
         ResourceHandle<SkinnedMesh> mesh;
+
+        /**
+         * Identifies the object across frames, for example the entity id, so that per object state
+         * such as the selected level of detail is kept when the scene is rebuilt. Negative if the object has no id.
+         */
+        int objectId = -1;
     };
 
     struct MaterialProperty : public Property {
@@ -87,7 +95,7 @@ namespace xng {
             return typeid(BoneTransformsProperty);
         }
 
-        std::map<std::string, Mat4f> boneTransforms; // Optional dynamic bone transform values which override the values in SkinnedMesh.rig
+        size_t paletteOffset = 0; // The offset of the rig ordered bone transforms in Scene.bonePalette, 0 references the identity entry
     };
 
     struct PointLightProperty : public Property {
@@ -137,6 +145,14 @@ namespace xng {
 
         ColorRGBA wireColor;
     };
+
+    struct ParticleProperty : public Property {
+        std::type_index getType() override {
+            return typeid(ParticleProperty);
+        }
+
+        std::shared_ptr<const std::vector<ParticleInstance>> instances; // World space particles sorted in draw order
+    };
 }
 
 #endif //XENGINE_PROPERTY_HPP
@@ -32,6 +32,7 @@
 #include "xng/render/scene/mesh.hpp"
 #include "xng/render/scene/skinnedmesh.hpp"
 #include "xng/render/scene/node.hpp"
+#include "xng/render/scene/bonepalette.hpp"
 
 #include "xng/util/genericmap.hpp"
 
@@ -43,6 +44,8 @@ namespace xng {
      */
     struct XENGINE_EXPORT Scene {
         Node rootNode;
+
+        BonePalette bonePalette; // The bone transforms referenced by BoneTransformsProperty.paletteOffset
     };
 }
 
@@ -58,6 +58,30 @@ namespace xng {
             return VertexLayout(layout);
         }
 
+        /**
+         * The skinned equivalent of Mesh::getCompactVertexLayout with 32 bytes per vertex.
+         *
+         * eg. GLSL:
+         *  layout (location = 0) in vec4 positionBitangentSign; // snorm16
+         *  layout (location = 1) in vec4 normalTangent; // snorm16, octahedral normal in xy and tangent in zw
+         *  layout (location = 2) in vec2 uv; // half float
+         *  layout (location = 3) in ivec4 boneIds; // int16
+         *  layout (location = 4) in vec4 boneWeights; // unorm8
+         *
+         * @return
+         */
+        static VertexLayout getCompactVertexLayout() {
+            const std::vector<VertexAttribute> layout = {
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::SIGNED_SHORT, 0, true),
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::SIGNED_SHORT, 0, true),
+                    VertexAttribute(VertexAttribute::VECTOR2, VertexAttribute::HALF_FLOAT),
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::SIGNED_SHORT),
+                    VertexAttribute(VertexAttribute::VECTOR4, VertexAttribute::UNSIGNED_BYTE, 0, true),
+            };
+
+            return VertexLayout(layout);
+        }
+
         /**
          * eg. GLSL:
          *  layout (location = 0) in vec3 position;
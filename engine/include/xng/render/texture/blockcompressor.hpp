@@ -0,0 +1,104 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_BLOCKCOMPRESSOR_HPP
+#define XENGINE_BLOCKCOMPRESSOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include "xng/gpu/textureproperties.hpp"
+#include "xng/render/scene/image.hpp"
+
+namespace xng {
+    /**
+     * CPU encoders and decoders for the block compressed color formats.
+     *
+     * Images are split into 4x4 pixel blocks in row major order,
+     * pixels of partial blocks at the right and bottom border are clamped to the image.
+     *
+     * BC1, BC3 and BC5 endpoints are fitted along the principal axis of the block and refined by a least squares pass,
+     * BC7 blocks are encoded in mode 6 (Single subset rgba with 4 bit indices) which covers opaque and translucent content.
+     */
+    class XENGINE_EXPORT BlockCompressor {
+    public:
+        /**
+         * @param image
+         * @param format A block compressed format
+         * @return The encoded blocks of the image
+         */
+        static std::vector<uint8_t> compress(const ImageRGBA &image, ColorFormat format);
+
+        /**
+         * @param data The encoded blocks
+         * @param size The size of data in bytes
+         * @param resolution The resolution of the encoded image
+         * @param format A block compressed format
+         * @return The decoded image, BC5 data is decoded into the red and green channels
+         */
+        static ImageRGBA decompress(const uint8_t *data, size_t size, const Vec2i &resolution, ColorFormat format);
+
+        /**
+         * @param pixels The 16 pixels of the block in row major order
+         * @param output 8 bytes
+         * @param alpha If true pixels with alpha below 128 are encoded as transparent black using the 3 color mode
+         */
+        static void encodeBC1(const ColorRGBA *pixels, uint8_t *output, bool alpha = false);
+
+        /**
+         * @param pixels The 16 pixels of the block in row major order
+         * @param output 16 bytes
+         */
+        static void encodeBC3(const ColorRGBA *pixels, uint8_t *output);
+
+        /**
+         * @param values The 16 values of the block in row major order
+         * @param output 8 bytes
+         */
+        static void encodeBC4(const uint8_t *values, uint8_t *output);
+
+        /**
+         * @param pixels The 16 pixels of the block in row major order, the red and green channels are encoded
+         * @param output 16 bytes
+         */
+        static void encodeBC5(const ColorRGBA *pixels, uint8_t *output);
+
+        /**
+         * @param pixels The 16 pixels of the block in row major order
+         * @param output 16 bytes
+         */
+        static void encodeBC7(const ColorRGBA *pixels, uint8_t *output);
+
+        static void decodeBC1(const uint8_t *block, ColorRGBA *pixels);
+
+        static void decodeBC3(const uint8_t *block, ColorRGBA *pixels);
+
+        static void decodeBC4(const uint8_t *block, uint8_t *values);
+
+        static void decodeBC5(const uint8_t *block, ColorRGBA *pixels);
+
+        /**
+         * Only mode 6 blocks as written by encodeBC7 are supported, other modes throw a std::runtime_error.
+         */
+        static void decodeBC7(const uint8_t *block, ColorRGBA *pixels);
+    };
+}
+
+#endif //XENGINE_BLOCKCOMPRESSOR_HPP
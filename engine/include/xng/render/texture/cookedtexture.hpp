@@ -0,0 +1,110 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_COOKEDTEXTURE_HPP
+#define XENGINE_COOKEDTEXTURE_HPP
+
+#include <vector>
+
+#include "xng/gpu/texturebuffer.hpp"
+#include "xng/gpu/texturebufferdesc.hpp"
+
+#include "xng/io/binarystream.hpp"
+#include "xng/io/readbuffer.hpp"
+
+#include "xng/render/graph/framegraphbuilder.hpp"
+
+#include "xng/resource/resource.hpp"
+
+namespace xng {
+    static const std::string COOKED_TEXTURE_VERSION = "01";
+    static const std::string COOKED_TEXTURE_MAGIC = "\xa9tex\xff" + COOKED_TEXTURE_VERSION + "\xa9";
+
+    /**
+     * A texture whose mip chain has been generated and encoded offline by the TextureCooker.
+     *
+     * The mip levels contain the data in the format of the description (Usually a block compressed format)
+     * and are uploaded to the texture buffer as is.
+     * When deserialized the mip levels are views into the source buffer so importing does not copy or decode the data.
+     */
+    struct XENGINE_EXPORT CookedTexture : public Resource {
+        ~CookedTexture() override = default;
+
+        std::unique_ptr<Resource> clone() override {
+            return std::make_unique<CookedTexture>(*this);
+        }
+
+        std::type_index getTypeIndex() const override {
+            return typeid(CookedTexture);
+        }
+
+        size_t getMemoryUsage() const override {
+            size_t ret = 0;
+            for (auto &level: mipMapLevels) {
+                ret += level.size();
+            }
+            return ret;
+        }
+
+        /**
+         * @param level
+         * @return The resolution of the given mip map level
+         */
+        Vec2i getMipMapResolution(int level) const {
+            return {std::max(1, description.size.x >> level), std::max(1, description.size.y >> level)};
+        }
+
+        /**
+         * Upload all mip levels.
+         *
+         * The texture buffer must have been created with a description matching the size, format and mip map level count of this texture.
+         *
+         * @param buffer
+         */
+        void upload(TextureBuffer &buffer) const;
+
+        /**
+         * Upload all mip levels through the frame graph.
+         *
+         * @param builder
+         * @param buffer A texture buffer resource created with a description matching the size, format and mip map level count of this texture.
+         */
+        void upload(FrameGraphBuilder &builder, FrameGraphResource buffer) const;
+
+        /**
+         * Write the texture in the cooked texture container format, starting with COOKED_TEXTURE_MAGIC.
+         *
+         * @param writer
+         */
+        void serialize(BinaryWriter &writer) const;
+
+        /**
+         * Read the texture from a buffer containing the cooked texture container format.
+         *
+         * @param buffer
+         */
+        void deserialize(const ReadBuffer &buffer);
+
+        TextureBufferDesc description;
+        std::vector<ReadBuffer> mipMapLevels;
+    };
+}
+
+#endif //XENGINE_COOKEDTEXTURE_HPP
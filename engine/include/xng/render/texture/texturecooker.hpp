@@ -0,0 +1,77 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#ifndef XENGINE_TEXTURECOOKER_HPP
+#define XENGINE_TEXTURECOOKER_HPP
+
+#include <vector>
+
+#include "xng/render/scene/image.hpp"
+#include "xng/render/texture/cookedtexture.hpp"
+
+namespace xng {
+    /**
+     * Prepares textures offline so that loading them at runtime only requires uploading the stored data.
+     *
+     * The mip chain is generated on the cpu with a separable filter instead of relying on TextureBuffer::generateMipMaps
+     * which cannot be used with block compressed formats and whose filter quality depends on the driver.
+     */
+    class XENGINE_EXPORT TextureCooker {
+    public:
+        enum MipMapFilter : int {
+            FILTER_BOX = 0, // Area weighted average of the source pixels
+            FILTER_KAISER, // Kaiser windowed sinc which keeps more detail in the smaller levels
+        };
+
+        struct Settings {
+            ColorFormat format = BC7_RGBA; // RGBA or a block compressed format
+            bool generateMipMaps = true;
+            MipMapFilter filter = FILTER_KAISER;
+            bool sRGB = true; // If true the color channels are converted to linear space for filtering
+            bool normalMap = false; // If true the rgb channels contain a unit vector which is renormalized after filtering
+            TextureWrapping wrapping = REPEAT; // The wrapping applied to the filter taps at the image borders
+            TextureFiltering filterMin = LINEAR;
+            TextureFiltering filterMag = LINEAR;
+            MipMapFiltering mipMapFilter = LINEAR_MIPMAP_LINEAR;
+        };
+
+        /**
+         * Generate the full mip chain of the image down to 1x1.
+         *
+         * Translucent pixels are filtered with premultiplied alpha to avoid bleeding the color of invisible pixels.
+         *
+         * @param image
+         * @param settings
+         * @return The mip map levels starting with a copy of the image at index 0
+         */
+        static std::vector<ImageRGBA> generateMipChain(const ImageRGBA &image, const Settings &settings);
+
+        /**
+         * Generate the mip chain if enabled and encode each level into the format of the settings.
+         *
+         * @param image
+         * @param settings
+         * @return
+         */
+        static CookedTexture cook(const ImageRGBA &image, const Settings &settings);
+    };
+}
+
+#endif //XENGINE_TEXTURECOOKER_HPP
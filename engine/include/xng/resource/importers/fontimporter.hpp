@@ -35,6 +35,11 @@ namespace xng {
                             const std::string &path,
                             Archive *archive) override;
 
+        ResourceBundle readBuffer(const ReadBuffer &buffer,
+                                  const std::string &hint,
+                                  const std::string &path,
+                                  Archive *archive) override;
+
         const std::set<std::string> &getSupportedFormats() const override;
     };
 }
@@ -46,10 +46,20 @@ namespace xng {
     public:
         static Message createBundle(const ResourceBundle &bundle);
 
-         ResourceBundle read(std::istream &stream,
-                             const std::string &hint,
-                             const std::string &path,
-                             Archive *archive) override;
+        /**
+         * Create the resources of a bundle or scene message
+         */
+        static ResourceBundle readBundle(const Message &message);
+
+        ResourceBundle read(std::istream &stream,
+                            const std::string &hint,
+                            const std::string &path,
+                            Archive *archive) override;
+
+        ResourceBundle readBuffer(const ReadBuffer &buffer,
+                                  const std::string &hint,
+                                  const std::string &path,
+                                  Archive *archive) override;
 
         const std::set<std::string> &getSupportedFormats() const override;
     };
@@ -40,6 +40,13 @@ namespace xng {
         virtual bool isLoaded() const { return true; }
 
         virtual bool isLoading() const { return false; }
+
+        /**
+         * Used by the resource registry to account the memory of loaded bundles.
+         *
+         * @return The approximate number of bytes allocated by this resource, 0 if unknown.
+         */
+        virtual size_t getMemoryUsage() const { return 0; }
     };
 }
 
@@ -116,6 +116,17 @@ namespace xng {
             assets.erase(name);
         }
 
+        /**
+         * @return The sum of the memory usage of the resources in the bundle
+         */
+        size_t getMemoryUsage() const {
+            size_t ret = 0;
+            for (auto &pair: assets) {
+                ret += pair.second->getMemoryUsage();
+            }
+            return ret;
+        }
+
         bool has(const std::string &name){
             return assets.find(name) != assets.end();
         }
@@ -22,6 +22,7 @@
 
 #include <memory>
 #include <utility>
+#include <atomic>
 
 #include "uri.hpp"
 #include "resourceregistry.hpp"
@@ -31,30 +32,39 @@
 #include "xng/io/messageable.hpp"
 
 namespace xng {
+    /**
+     * A reference counted handle to a resource.
+     *
+     * Handles store the interned id of their uri so that copying a handle only increments an atomic counter,
+     * the resolved resource pointer is cached in the handle and revalidated against the generation of the bundle
+     * so that get() only locks the registry after the bundle was loaded or reloaded.
+     */
     template<typename T>
     class ResourceHandle : public Messageable {
     public:
         ResourceHandle() = default;
 
-        explicit ResourceHandle(Uri u,
+        explicit ResourceHandle(const Uri &u,
                                 ResourceRegistry *r = nullptr)
-                : uri(std::move(u)), registry(r) {
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
+                : registry(r) {
+            if (!u.empty()) {
+                id = &getRegistry().intern(u);
+                getRegistry().incRef(*id);
             }
         }
 
         ~ResourceHandle() {
-            if (!uri.empty()) {
-                getRegistry().decRef(uri);
+            if (id != nullptr) {
+                getRegistry().decRef(*id);
             }
         };
 
-        ResourceHandle(const ResourceHandle<T> &other) {
-            uri = other.uri;
-            registry = other.registry;
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
+        ResourceHandle(const ResourceHandle<T> &other)
+                : id(other.id),
+                  registry(other.registry) {
+            copyCache(other);
+            if (id != nullptr) {
+                getRegistry().incRef(*id);
             }
         }
 
@@ -62,21 +72,48 @@ namespace xng {
             if (this == &other)
                 return *this;
 
-            uri = other.uri;
-            registry = other.registry;
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
+            if (other.id != nullptr) {
+                other.getRegistry().incRef(*other.id);
+            }
+            if (id != nullptr) {
+                getRegistry().decRef(*id);
             }
 
+            id = other.id;
+            registry = other.registry;
+            copyCache(other);
+
             return *this;
         }
 
-        ResourceHandle(ResourceHandle<T> &&other)  noexcept = default;
+        ResourceHandle(ResourceHandle<T> &&other) noexcept
+                : id(other.id),
+                  registry(other.registry) {
+            copyCache(other);
+            other.id = nullptr;
+            other.storeCache(nullptr, 0);
+        }
+
+        ResourceHandle<T> &operator=(ResourceHandle<T> &&other) noexcept {
+            if (this == &other)
+                return *this;
+
+            if (id != nullptr) {
+                getRegistry().decRef(*id);
+            }
+
+            id = other.id;
+            registry = other.registry;
+            copyCache(other);
+
+            other.id = nullptr;
+            other.storeCache(nullptr, 0);
 
-        ResourceHandle<T> &operator=(ResourceHandle<T> &&other)  noexcept = default;
+            return *this;
+        }
 
         bool operator==(const ResourceHandle<T> &other) const {
-            return uri == other.uri
+            return id == other.id
                    && registry == other.registry;
         }
 
@@ -85,29 +122,45 @@ namespace xng {
         }
 
         bool assigned() const {
-            return !uri.empty();
+            return id != nullptr;
         }
 
         const Uri &getUri() const {
-            return uri;
+            static const Uri empty;
+            return id == nullptr ? empty : id->uri;
         }
 
         bool isLoaded() const {
-            return getRegistry().isLoaded(uri);
+            return getRegistry().isLoaded(getUri());
         }
 
         bool isLoading() const {
-            return getRegistry().isLoading(uri);
+            return getRegistry().isLoading(getUri());
+        }
+
+        /**
+         * @return The generation of the bundle of the resource, which changes when the bundle is loaded, reloaded or unloaded.
+         */
+        uint64_t getGeneration() const {
+            return id == nullptr ? 0 : id->bundle->generation.load(std::memory_order_acquire);
         }
 
         const T &get() const {
-            try {
-                return dynamic_cast<const T &>(getRegistry().get(uri, typeid(T)));
-            } catch (const std::bad_cast &e) {
-                throw std::runtime_error("Invalid Resource Cast, Uri: " + uri.toString() + " Type: " +
-                                         getRegistry().get(uri, typeid(T)).getTypeIndex().name() + " Requested: " +
-                                         typeid(T).name());
+            if (id == nullptr) {
+                throw std::runtime_error("Resource handle is not assigned");
             }
+
+            // The generation is read before resolving so that a concurrent reload invalidates the cached pointer
+            auto currentGeneration = id->bundle->generation.load(std::memory_order_acquire);
+            const T *ptr;
+            uint64_t cachedGeneration;
+            if (loadCache(ptr, cachedGeneration) && ptr != nullptr && cachedGeneration == currentGeneration) {
+                return *ptr;
+            }
+
+            auto &ret = resolve();
+            storeCache(&ret, currentGeneration);
+            return ret;
         }
 
         ResourceRegistry &getRegistry() const {
@@ -119,23 +172,79 @@ namespace xng {
         }
 
         Messageable &operator<<(const Message &message) override {
+            Uri uri;
             uri << message.getMessage("uri");
-            if (!uri.empty()) {
-                getRegistry().incRef(uri);
-            }
+            *this = ResourceHandle<T>(uri, registry);
             return *this;
         }
 
         Message &operator>>(Message &message) const override {
             auto map = std::map<std::string, Message>();
-            uri >> map["uri"];
+            getUri() >> map["uri"];
             message = map;
             return message;
         }
 
     private:
-        Uri uri;
+        const T &resolve() const {
+            auto &uri = id->uri;
+            try {
+                return dynamic_cast<const T &>(getRegistry().get(uri, typeid(T)));
+            } catch (const std::bad_cast &e) {
+                throw std::runtime_error("Invalid Resource Cast, Uri: " + uri.toString() + " Type: " +
+                                         getRegistry().get(uri, typeid(T)).getTypeIndex().name() + " Requested: " +
+                                         typeid(T).name());
+            }
+        }
+
+        /**
+         * Read the cached pointer and generation as one unit.
+         *
+         * @return False if another thread is writing the cache or wrote it while reading
+         */
+        bool loadCache(const T *&ptr, uint64_t &gen) const {
+            auto seq = sequence.load(std::memory_order_acquire);
+            if (seq & 1) {
+                return false;
+            }
+            ptr = resource.load(std::memory_order_relaxed);
+            gen = generation.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            return sequence.load(std::memory_order_relaxed) == seq;
+        }
+
+        /**
+         * Publish the pointer and generation as one unit, the cache is left unchanged if another thread is writing it.
+         */
+        void storeCache(const T *ptr, uint64_t gen) const {
+            auto seq = sequence.load(std::memory_order_relaxed);
+            if ((seq & 1) || !sequence.compare_exchange_strong(seq, seq + 1, std::memory_order_acquire)) {
+                return;
+            }
+            std::atomic_thread_fence(std::memory_order_release);
+            resource.store(ptr, std::memory_order_relaxed);
+            generation.store(gen, std::memory_order_relaxed);
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        void copyCache(const ResourceHandle<T> &other) {
+            const T *ptr;
+            uint64_t gen;
+            if (other.loadCache(ptr, gen)) {
+                storeCache(ptr, gen);
+            } else {
+                storeCache(nullptr, 0);
+            }
+        }
+
+        const ResourceId *id = nullptr;
         ResourceRegistry *registry = nullptr;
+
+        // The cache is guarded by a sequence lock so that a pointer is never paired with the generation of another thread,
+        // the sequence is odd while a thread writes the cache.
+        mutable std::atomic<uint32_t> sequence = 0;
+        mutable std::atomic<const T *> resource = nullptr;
+        mutable std::atomic<uint64_t> generation = 0;
     };
 }
 
@@ -0,0 +1,53 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_RESOURCEID_HPP
+#define XENGINE_RESOURCEID_HPP
+
+#include <atomic>
+
+#include "xng/resource/uri.hpp"
+
+namespace xng {
+    /**
+     * The reference count and generation of a bundle file, shared by the resource ids of the file.
+     */
+    struct ResourceBundleCounter {
+        std::atomic<size_t> references = 0;
+
+        /**
+         * Incremented each time the bundle is inserted into or removed from the registry,
+         * pointers to resources of the bundle are valid as long as the generation does not change.
+         */
+        std::atomic<uint64_t> generation = 0;
+    };
+
+    /**
+     * An interned resource uri, created by ResourceRegistry::intern.
+     *
+     * Ids live as long as the registry which created them,
+     * two ids of the same registry are equal if and only if their uris are equal.
+     */
+    struct ResourceId {
+        Uri uri;
+        ResourceBundleCounter *bundle = nullptr;
+    };
+}
+
+#endif //XENGINE_RESOURCEID_HPP
@@ -27,6 +27,7 @@
 #include "xng/resource/uri.hpp"
 
 #include "xng/io/archive.hpp"
+#include "xng/io/readbuffer.hpp"
 
 namespace xng {
     /**
@@ -49,6 +50,25 @@ namespace xng {
          */
         virtual ResourceBundle read(std::istream &stream, const std::string &hint, const std::string &path, Archive *archive) = 0;
 
+        /**
+         * Import the bundle from a contiguous read only buffer.
+         *
+         * Importers which operate on memory should override this to avoid copying the data,
+         * the default implementation wraps the buffer in a non copying stream and calls read().
+         *
+         * @param buffer The buffer containing the data to be imported.
+         * @param hint The file extension
+         * @param archive The archive instance to use when resolving paths in the buffer data.
+         * @return
+         */
+        virtual ResourceBundle readBuffer(const ReadBuffer &buffer,
+                                          const std::string &hint,
+                                          const std::string &path,
+                                          Archive *archive) {
+            ReadBufferStream stream(buffer);
+            return read(stream, hint, path, archive);
+        }
+
         /**
          * @return The set of supported file extensions with each containing the preceding dot
          */
@@ -29,27 +29,72 @@
 #include <filesystem>
 #include <shared_mutex>
 #include <unordered_map>
+#include <list>
+#include <chrono>
+#include <limits>
 
 #include "xng/io/archive.hpp"
 
 #include "uri.hpp"
+#include "resourceid.hpp"
 #include "resource.hpp"
 #include "resourcebundle.hpp"
 #include "resourceimporter.hpp"
+#include "resourcestreamer.hpp"
 
 #include "xng/async/threadpool.hpp"
 
-#include "xng/util/refcounter.hpp"
-
 namespace xng {
+    /**
+     * The caching behaviour for the bundles of a scheme.
+     *
+     * Bundles without references are kept resident until their grace period expires
+     * or until the memory budget of the scheme is exceeded, in which case the least recently used
+     * unreferenced bundles are unloaded first.
+     */
+    struct ResourceCachePolicy {
+        /**
+         * The maximum number of bytes of resident bundles.
+         * Referenced bundles are never unloaded, so the budget can be exceeded by referenced bundles.
+         */
+        size_t memoryBudget = std::numeric_limits<size_t>::max();
+
+        /**
+         * The time for which unreferenced bundles are kept resident.
+         */
+        std::chrono::milliseconds gracePeriod{0};
+    };
+
+    struct ResourceCacheStatistics {
+        size_t residentBytes = 0; // The bytes of all resident bundles
+        size_t unreferencedBytes = 0; // The bytes of resident bundles without references
+        size_t hits = 0; // The number of first references to bundles which were resident or loading
+        size_t misses = 0; // The number of first references to bundles which had to be loaded
+        size_t evictions = 0; // The number of bundles unloaded by the cache policy
+    };
+
     /**
      * A resource registry is responsible for loading and managing resource data.
      * The registry invokes the set importer for importing data.
      * The registry uses reference counting for resource lifetime management.
      * ResourceHandle can be used to do the reference counting with a RAII interface.
+     *
+     * Uris are interned into ResourceId instances which hold the atomic reference count of their bundle,
+     * adding and removing references only locks the registry when the first reference is added or the last is removed.
+     *
+     * Bundles without references are unloaded according to the ResourceCachePolicy of their scheme.
+     * The size of a bundle is the memory usage reported by its resources, or the size of the file if no resource reports its usage.
+     *
+     * Bundles are loaded through a ResourceStreamer, loads which have not started yet can be re-prioritized
+     * and are cancelled when the last reference is removed before the load started.
      */
     class XENGINE_EXPORT ResourceRegistry {
     public:
+        /**
+         * Invoked after the bundle of the uri was loaded, or with the exception if the load failed or was cancelled.
+         */
+        typedef std::function<void(const Uri &uri, const std::exception_ptr &exception)> LoadCallback;
+
         /**
          * The default registry used by resource handle if no registry is specified.
          *
@@ -99,38 +144,102 @@ namespace xng {
          * @return
          */
         const Resource &get(const Uri &uri, std::type_index typeIndex){
-            mutex.lock();
+            std::unique_lock<std::mutex> lock(mutex);
             auto it = loadTasks.find(uri.getFile());
             if (it != loadTasks.end()) {
                 auto task = it->second;
-                mutex.unlock();
+                streamer.setPriority(uri.getFile(), ResourceStreamer::CRITICAL, 0);
+                lock.unlock();
                 auto ex = task->join();
                 if (ex) {
                     std::rethrow_exception(ex);
                 }
-                mutex.lock();
+                lock.lock();
             }
-            auto &ret = bundles.at(uri.getFile()).get(uri.getAsset(), typeIndex);
-            mutex.unlock();
-            return ret;
+            return bundles.at(uri.getFile()).get(uri.getAsset(), typeIndex);
+        }
+
+        /**
+         * Get the interned id of the uri, the returned reference is valid for the lifetime of the registry.
+         *
+         * @param uri
+         * @return
+         */
+        const ResourceId &intern(const Uri &uri);
+
+        /**
+         * @param uri
+         * @param priority The priority of the load if the uri is not loaded or loading
+         * @param distance The distance to the viewer used for ordering loads of the same priority
+         */
+        void incRef(const Uri &uri,
+                    ResourceStreamer::Priority priority = ResourceStreamer::VISIBLE,
+                    float distance = 0) {
+            incRef(intern(uri), priority, distance);
         }
 
-        void incRef(const Uri &uri);
+        void decRef(const Uri &uri) {
+            decRef(intern(uri));
+        }
 
-        void decRef(const Uri &uri);
+        /**
+         * Only the first reference to a bundle locks the registry.
+         *
+         * @param id
+         * @param priority The priority of the load if the uri is not loaded or loading
+         * @param distance The distance to the viewer used for ordering loads of the same priority
+         */
+        void incRef(const ResourceId &id,
+                    ResourceStreamer::Priority priority = ResourceStreamer::VISIBLE,
+                    float distance = 0) {
+            if (id.bundle->references.fetch_add(1, std::memory_order_acq_rel) == 0) {
+                load(id.uri, priority, distance);
+            }
+        }
+
+        /**
+         * Only the removal of the last reference to a bundle locks the registry.
+         *
+         * @param id
+         */
+        void decRef(const ResourceId &id) {
+            auto references = id.bundle->references.fetch_sub(1, std::memory_order_acq_rel);
+            if (references == 0) {
+                id.bundle->references.fetch_add(1, std::memory_order_acq_rel);
+                throw std::runtime_error("Reference count underflow for " + id.uri.toString());
+            } else if (references == 1) {
+                unload(id.uri);
+            }
+        }
 
         void reload(const Uri &uri);
 
         void reloadAll() {
-            for (auto &uri: getUris()) {
+            std::set<Uri> reloadUris;
+            {
+                std::lock_guard<std::mutex> g(mutex);
+                reloadUris = uris;
+            }
+            for (auto &uri: reloadUris) {
                 reload(uri);
             }
         }
 
+        /**
+         * Wait for the load of the uri to complete, the load is moved to the CRITICAL priority.
+         *
+         * @param uri
+         */
         void await(const Uri &uri);
 
         void awaitAll() {
-            for (auto &uri: getLoadingUris()) {
+            // Copied because the loads complete concurrently
+            std::set<Uri> awaitUris;
+            {
+                std::lock_guard<std::mutex> g(mutex);
+                awaitUris = loadingUris;
+            }
+            for (auto &uri: awaitUris) {
                 await(uri);
             }
         }
@@ -144,11 +253,93 @@ namespace xng {
         }
 
         bool isLoading(const Uri &uri) const {
-            return loadTasks.find(uri.getFile()) == loadTasks.end();
+            return loadTasks.find(uri.getFile()) != loadTasks.end();
         }
 
+        /**
+         * Change the priority of a load which has not started yet, for example when the distance to the camera changed.
+         *
+         * @return False if the uri is not queued for loading
+         */
+        bool setLoadPriority(const Uri &uri, ResourceStreamer::Priority priority, float distance = 0);
+
+        /**
+         * Add a callback which is invoked when the load of the uri completes.
+         * If the uri is already loaded the callback is invoked immediately.
+         *
+         * The callback is invoked on a worker thread and must not block on other loads.
+         *
+         * @param uri
+         * @param callback
+         */
+        void addLoadCallback(const Uri &uri, LoadCallback callback);
+
+        /**
+         * @param maxIo The maximum number of files which are read concurrently
+         * @param maxDecode The maximum number of bundles which are imported concurrently
+         */
+        void setStreamingConcurrency(size_t maxIo, size_t maxDecode);
+
+        /**
+         * @param scheme The scheme of the uris to which the policy applies, uris without a scheme use the default scheme.
+         * @param policy
+         */
+        void setCachePolicy(const std::string &scheme, const ResourceCachePolicy &policy);
+
+        /**
+         * @param policy The policy for schemes without a policy set by setCachePolicy
+         */
+        void setDefaultCachePolicy(const ResourceCachePolicy &policy);
+
+        ResourceCacheStatistics getCacheStatistics();
+
+        /**
+         * Unload the unreferenced bundles whose grace period has expired.
+         *
+         * The registry collects when references are added or removed,
+         * applications using grace periods should additionally call collect periodically, for example once per frame.
+         */
+        void collect();
+
     private:
-        void load(const Uri &uri);
+        struct CacheEntry {
+            std::string scheme;
+            size_t size = 0;
+            bool referenced = true;
+            std::chrono::steady_clock::time_point releaseTime;
+            std::list<std::string>::iterator lruIterator;
+        };
+
+        /**
+         * The cache functions must be called with the mutex locked.
+         * The unloaded bundles are moved into the passed vector and must be destroyed after unlocking the mutex,
+         * because resources can release references to other bundles when destroyed.
+         */
+        void insertBundle(const std::string &file,
+                          const std::string &scheme,
+                          ResourceBundle bundle,
+                          size_t size,
+                          bool referenced,
+                          std::vector<ResourceBundle> &unloaded);
+
+        void removeBundle(const std::string &file, std::vector<ResourceBundle> &unloaded);
+
+        void releaseBundle(const std::string &file);
+
+        void collectBundles(std::vector<ResourceBundle> &unloaded);
+
+        const ResourceCachePolicy &getCachePolicy(const std::string &scheme) const;
+
+        std::string getCacheScheme(const Uri &uri) const;
+
+        ResourceBundleCounter &getBundleCounter(const std::string &file);
+
+        /**
+         * Load and unload are called without the mutex locked after the reference count of the bundle changed,
+         * and check the reference count again after locking so that concurrent transitions are resolved
+         * in favor of the current count.
+         */
+        void load(const Uri &uri, ResourceStreamer::Priority priority, float distance);
 
         void unload(const Uri &uri);
 
@@ -158,7 +349,9 @@ namespace xng {
 
         std::shared_mutex archiveMutex;
 
-        RefCounter<std::string, unsigned long> bundleRefCounter;
+        std::shared_mutex internMutex;
+        std::unordered_map<Uri, std::unique_ptr<ResourceId>> ids;
+        std::unordered_map<std::string, std::unique_ptr<ResourceBundleCounter>> bundleCounters;
 
         std::unordered_map<std::string, std::shared_ptr<Task>> loadTasks;
 
@@ -174,6 +367,17 @@ namespace xng {
         std::set<Uri> loadingUris;
 
         std::set<std::string> killBundles;
+
+        std::unordered_map<std::string, std::vector<LoadCallback>> loadCallbacks;
+
+        std::map<std::string, CacheEntry> cacheEntries;
+        std::list<std::string> unreferencedBundles; // Least recently released first
+        std::map<std::string, size_t> schemeBytes;
+        std::map<std::string, ResourceCachePolicy> cachePolicies;
+        ResourceCachePolicy defaultCachePolicy;
+        ResourceCacheStatistics cacheStatistics;
+
+        ResourceStreamer streamer; // Declared last so that running loads complete before the other members are destroyed
     };
 }
 #endif //XENGINE_RESOURCEREGISTRY_HPP
@@ -0,0 +1,184 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_RESOURCESTREAMER_HPP
+#define XENGINE_RESOURCESTREAMER_HPP
+
+#include <string>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <set>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include <thread>
+
+#include "xng/io/readbuffer.hpp"
+#include "xng/async/threadpool.hpp"
+
+namespace xng {
+    /**
+     * Schedules resource loads in two stages, reading the file data (I/O) and decoding it.
+     *
+     * Requests are ordered by priority class, then by distance and then by insertion order.
+     * The number of concurrently running reads and decodes is limited separately,
+     * so that streaming never occupies more than maxIo + maxDecode threads of the thread pool.
+     */
+    class XENGINE_EXPORT ResourceStreamer {
+    public:
+        enum Priority {
+            CRITICAL = 0, // Required for the current frame
+            VISIBLE = 1, // Visible but a placeholder can be drawn
+            PREFETCH = 2 // Speculative loads
+        };
+
+        enum Status {
+            COMPLETED,
+            FAILED,
+            CANCELLED
+        };
+
+        typedef std::function<ReadBuffer()> Reader;
+        typedef std::function<void(const ReadBuffer &buffer)> Decoder;
+
+        /**
+         * Invoked on the worker thread after the decoder returned or the reader or decoder threw,
+         * or by cancel() when a queued request was cancelled.
+         */
+        typedef std::function<void(Status status, const std::exception_ptr &exception)> Callback;
+
+        /**
+         * @param maxIo The maximum number of concurrently running readers
+         * @param maxDecode The maximum number of concurrently running decoders
+         * @param pool The pool on which the readers and decoders are run
+         */
+        explicit ResourceStreamer(size_t maxIo = 2,
+                                  size_t maxDecode = std::max(std::thread::hardware_concurrency(), 2u) - 1,
+                                  ThreadPool &pool = ThreadPool::getPool());
+
+        /**
+         * Queued requests are dropped without invoking their callback, running requests are awaited.
+         */
+        ~ResourceStreamer();
+
+        ResourceStreamer(const ResourceStreamer &other) = delete;
+
+        ResourceStreamer &operator=(const ResourceStreamer &other) = delete;
+
+        /**
+         * Queue a request.
+         *
+         * @param key The unique key of the request, there can only be one request per key.
+         * @param priority
+         * @param distance The distance to the viewer used for ordering requests of the same priority class
+         * @param reader
+         * @param decoder
+         * @param callback
+         */
+        void enqueue(const std::string &key,
+                     Priority priority,
+                     float distance,
+                     Reader reader,
+                     Decoder decoder,
+                     Callback callback);
+
+        /**
+         * Change the priority of a request which has not started reading or decoding yet.
+         *
+         * @return False if no request with the key is queued
+         */
+        bool setPriority(const std::string &key, Priority priority, float distance);
+
+        /**
+         * Cancel a queued request.
+         *
+         * The callback of the request is invoked with the CANCELLED status before cancel returns.
+         * Requests which are currently reading or decoding cannot be cancelled.
+         *
+         * @return True if the request was cancelled
+         */
+        bool cancel(const std::string &key);
+
+        void setConcurrency(size_t maxIo, size_t maxDecode);
+
+        bool contains(const std::string &key);
+
+        /**
+         * Wait until all queued and running requests have completed.
+         */
+        void waitIdle();
+
+    private:
+        enum Stage {
+            QUEUED_READ,
+            READING,
+            QUEUED_DECODE,
+            DECODING
+        };
+
+        struct Request {
+            std::string key;
+            Priority priority;
+            float distance;
+            size_t sequence;
+            Stage stage = QUEUED_READ;
+            Reader reader;
+            Decoder decoder;
+            Callback callback;
+            ReadBuffer buffer;
+        };
+
+        typedef std::tuple<Priority, float, size_t, std::string> QueueKey;
+
+        static QueueKey getQueueKey(const Request &request) {
+            return {request.priority, request.distance, request.sequence, request.key};
+        }
+
+        /**
+         * Start queued requests up to the concurrency limits, must be called with the mutex locked.
+         */
+        void dispatch();
+
+        void read(const std::shared_ptr<Request> &request);
+
+        void decode(const std::shared_ptr<Request> &request);
+
+        void finish(const std::shared_ptr<Request> &request, Status status, const std::exception_ptr &exception);
+
+        ThreadPool &pool;
+
+        std::mutex mutex;
+        std::condition_variable idleCondition;
+
+        size_t maxIo;
+        size_t maxDecode;
+        size_t runningIo = 0;
+        size_t runningDecode = 0;
+        size_t activeTasks = 0; // The pool tasks which have not returned yet
+        size_t sequence = 0;
+
+        std::unordered_map<std::string, std::shared_ptr<Request>> requests;
+        std::set<QueueKey> readQueue;
+        std::set<QueueKey> decodeQueue;
+    };
+}
+
+#endif //XENGINE_RESOURCESTREAMER_HPP
@@ -0,0 +1,62 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_SHADERDECOMPILERCACHE_HPP
+#define XENGINE_SHADERDECOMPILERCACHE_HPP
+
+#include <filesystem>
+#include <mutex>
+#include <unordered_map>
+
+#include "xng/shader/shaderdecompiler.hpp"
+
+namespace xng {
+    /**
+     * A ShaderDecompiler which caches the output of another decompiler in memory and optionally on disk.
+     *
+     * Decompiling with spirv-cross is expensive and pipelines which differ only in their render state share their shaders,
+     * so each shader is only decompiled once.
+     */
+    class XENGINE_EXPORT ShaderDecompilerCache : public ShaderDecompiler {
+    public:
+        /**
+         * @param decompiler The decompiler invoked on cache misses
+         * @param directory The directory in which the decompiled sources are stored, if empty sources are only cached in memory.
+         */
+        explicit ShaderDecompilerCache(ShaderDecompiler &decompiler, std::filesystem::path directory = {});
+
+        std::string decompile(const std::vector<uint32_t> &source,
+                              const std::string &entryPoint,
+                              ShaderStage stage,
+                              ShaderLanguage targetLanguage) const override;
+
+        void setDirectory(const std::filesystem::path &directory);
+
+        void clear();
+
+    private:
+        ShaderDecompiler &decompiler;
+
+        mutable std::mutex mutex;
+        std::filesystem::path directory;
+        mutable std::unordered_map<uint64_t, std::string> sources;
+    };
+}
+
+#endif //XENGINE_SHADERDECOMPILERCACHE_HPP
@@ -0,0 +1,76 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_STABLEHASH_HPP
+#define XENGINE_STABLEHASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <type_traits>
+
+namespace xng {
+    /**
+     * A 64 bit FNV-1a hash whose value only depends on the hashed bytes.
+     *
+     * Unlike std::hash the values are identical across runs, compilers and platforms of the same endianness,
+     * so they can be used as keys of persistent caches.
+     */
+    class StableHash {
+    public:
+        void add(const void *data, size_t size) {
+            auto *bytes = static_cast<const uint8_t *>(data);
+            for (size_t i = 0; i < size; i++) {
+                value ^= bytes[i];
+                value *= 1099511628211ull;
+            }
+        }
+
+        template<typename T>
+        std::enable_if_t<std::is_arithmetic_v<T> || std::is_enum_v<T>> add(T v) {
+            if constexpr (std::is_enum_v<T>) {
+                add(static_cast<int64_t>(v));
+            } else if constexpr (std::is_same_v<T, bool>) {
+                add(static_cast<uint8_t>(v));
+            } else {
+                add(&v, sizeof(T));
+            }
+        }
+
+        void add(const std::string &v) {
+            add(static_cast<uint64_t>(v.size()));
+            add(v.data(), v.size());
+        }
+
+        template<typename T>
+        void add(const std::vector<T> &v) {
+            static_assert(std::is_arithmetic_v<T>);
+            add(static_cast<uint64_t>(v.size()));
+            add(v.data(), v.size() * sizeof(T));
+        }
+
+        uint64_t get() const { return value; }
+
+    private:
+        uint64_t value = 14695981039346656037ull;
+    };
+}
+
+#endif //XENGINE_STABLEHASH_HPP
@@ -46,6 +46,7 @@
 #include "xng/ecs/systems/riganimationsystem.hpp"
 #include "xng/ecs/systems/physicssystem.hpp"
 #include "xng/ecs/systems/guieventsystem.hpp"
+#include "xng/ecs/systems/particlesystem.hpp"
 #include "xng/ecs/components/skyboxcomponent.hpp"
 #include "xng/ecs/components/cameracomponent.hpp"
 #include "xng/ecs/components/rigidbodycomponent.hpp"
@@ -158,6 +159,7 @@
 #include "xng/gpu/shaderresource.hpp"
 #include "xng/gpu/texturebufferdesc.hpp"
 #include "xng/gpu/renderpipeline.hpp"
+#include "xng/gpu/renderpipelinecache.hpp"
 #include "xng/gpu/rendertargetattachment.hpp"
 #include "xng/gpu/renderdevice.hpp"
 #include "xng/font/font.hpp"
@@ -172,33 +174,43 @@
 #include "xng/util/framelimiter.hpp"
 #include "xng/util/crc.hpp"
 #include "xng/util/counter.hpp"
+#include "xng/util/stablehash.hpp"
 #include "xng/io/messageable.hpp"
 #include "xng/io/pak.hpp"
 #include "xng/io/substreambuf.hpp"
 #include "xng/io/message.hpp"
 #include "xng/io/readfile.hpp"
 #include "xng/io/archive.hpp"
+#include "xng/io/readbuffer.hpp"
+#include "xng/io/randomaccessreader.hpp"
 #include "xng/io/pakbuilder.hpp"
 #include "xng/io/library.hpp"
 #include "xng/io/protocol.hpp"
 #include "xng/io/byte.hpp"
 #include "xng/io/writefile.hpp"
 #include "xng/io/protocol/jsonprotocol.hpp"
+#include "xng/io/protocol/binaryprotocol.hpp"
+#include "xng/io/binarystream.hpp"
 #include "xng/io/archive/pakarchive.hpp"
 #include "xng/io/archive/directoryarchive.hpp"
 #include "xng/io/archive/memoryarchive.hpp"
 #include "xng/resource/resourceimporter.hpp"
 #include "xng/resource/resourcebundle.hpp"
 #include "xng/resource/resourceregistry.hpp"
+#include "xng/resource/resourcestreamer.hpp"
 #include "xng/resource/resourceexporter.hpp"
 #include "xng/resource/resourcehandle.hpp"
+#include "xng/resource/resourceid.hpp"
 #include "xng/resource/uri.hpp"
 #include "xng/resource/resource.hpp"
 #include "xng/resource/importers/fontimporter.hpp"
 #include "xng/resource/importers/stbiimporter.hpp"
 #include "xng/resource/importers/jsonimporter.hpp"
+#include "xng/resource/importers/binaryimporter.hpp"
+#include "xng/resource/importers/cookedtextureimporter.hpp"
 #include "xng/crypto/aes.hpp"
 #include "xng/crypto/gzip.hpp"
+#include "xng/crypto/lz4.hpp"
 #include "xng/crypto/sha.hpp"
 #include "xng/crypto/random.hpp"
 #include "xng/crypto/cryptodriver.hpp"
@@ -239,17 +251,31 @@
 #include "xng/render/scene/texture.hpp"
 #include "xng/render/scene/material.hpp"
 #include "xng/render/scene/scene.hpp"
+#include "xng/render/scene/bonepalette.hpp"
+#include "xng/render/particles/particleemitter.hpp"
+#include "xng/render/particles/particlepool.hpp"
+#include "xng/render/lighting/lightclustergrid.hpp"
 #include "xng/render/geometry/vertexstream.hpp"
 #include "xng/render/geometry/vertexbuilder.hpp"
+#include "xng/render/geometry/meshsimplifier.hpp"
+#include "xng/render/geometry/meshoptimizer.hpp"
+#include "xng/render/geometry/vertexquantizer.hpp"
 #include "xng/render/geometry/primitive.hpp"
 #include "xng/render/geometry/vertex.hpp"
 #include "xng/render/atlas/textureatlashandle.hpp"
 #include "xng/render/atlas/textureatlas.hpp"
 #include "xng/render/atlas/textureatlasresolution.hpp"
+#include "xng/render/atlas/skylinepacker.hpp"
+#include "xng/render/atlas/packedtextureatlas.hpp"
+#include "xng/render/texture/blockcompressor.hpp"
+#include "xng/render/texture/cookedtexture.hpp"
+#include "xng/render/texture/texturecooker.hpp"
 #include "xng/render/2d/texture2d.hpp"
 #include "xng/render/2d/renderer2d.hpp"
 #include "xng/render/graph/framegraphbuilder.hpp"
 #include "xng/render/graph/framegraphtextureatlas.hpp"
+#include "xng/render/graph/framegraphpackedtextureatlas.hpp"
+#include "xng/render/graph/framegraphbonepalette.hpp"
 #include "xng/render/graph/framegraphrenderer.hpp"
 #include "xng/render/graph/framegraphruntime.hpp"
 #include "xng/render/graph/framegraphcontext.hpp"
@@ -261,6 +287,9 @@
 #include "xng/render/graph/framegraphpass.hpp"
 #include "xng/render/graph/framegraph.hpp"
 #include "xng/render/graph/meshallocator.hpp"
+#include "xng/render/graph/meshlodselector.hpp"
+#include "xng/render/graph/shadowmapcache.hpp"
+#include "xng/render/graph/materialtable.hpp"
 #include "xng/render/graph/framegraphpipeline.hpp"
 #include "xng/render/graph/runtimes/framegraphruntimesimple.hpp"
 #include "xng/render/graph/passes/skyboxpass.hpp"
@@ -272,6 +301,7 @@
 #include "xng/render/graph/passes/forwardlightingpass.hpp"
 #include "xng/render/graph/passes/constructionpass.hpp"
 #include "xng/render/graph/passes/presentationpass.hpp"
+#include "xng/render/graph/passes/particlepass.hpp"
 #include "xng/event/eventbus.hpp"
 #include "xng/event/event.hpp"
 #include "xng/event/eventlistener.hpp"
@@ -284,6 +314,7 @@
 #include "xng/shader/shaderenvironment.hpp"
 #include "xng/shader/shadercompiler.hpp"
 #include "xng/shader/shaderdecompiler.hpp"
+#include "xng/shader/shaderdecompilercache.hpp"
 #include "xng/shader/spirvshader.hpp"
 #include "xng/shader/shaderdirectoryinclude.hpp"
 #include "xng/shader/shaderlanguage.hpp"
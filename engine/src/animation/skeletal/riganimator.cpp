@@ -205,14 +205,24 @@ namespace xng {
         }
     }
 
+    static void getDepthRecursive(Bone &bone, Rig &rig, size_t depth, std::map<std::string, size_t> &boneDepths) {
+        boneDepths[bone.name] = depth;
+        for (auto &childBone: rig.getChildBones(bone.name)) {
+            getDepthRecursive(childBone.get(), rig, depth + 1, boneDepths);
+        }
+    }
+
     RigAnimator::RigAnimator(Rig rig)
             : rig(std::move(rig)) {
+        for (auto &bone: this->rig.getRootBones()) {
+            getDepthRecursive(bone, this->rig, 0, boneDepths);
+        }
     }
 
     static void getTransformRecursive(Bone &bone,
                                       Rig &rig,
                                       Mat4f parentTransform,
-                                      std::map<std::string, Mat4f> &boneTransforms,
+                                      std::vector<Mat4f> &boneTransforms,
                                       const std::map<std::string, Mat4f> &keyframes) {
         auto it = keyframes.find(bone.name);
 
@@ -225,7 +235,7 @@ namespace xng {
 
         Mat4f globalTransform = parentTransform * localTransform;
 
-        boneTransforms[bone.name] = globalTransform * bone.offset;
+        boneTransforms.at(rig.getBoneIndex(bone.name)) = globalTransform * bone.offset;
 
         for (auto &childBone: rig.getChildBones(bone.name)) {
             getTransformRecursive(childBone.get(), rig, globalTransform, boneTransforms, keyframes);
@@ -239,8 +249,8 @@ namespace xng {
         float weight{};
     };
 
-    void RigAnimator::update(DeltaTime deltaTime) {
-        boneTransforms.clear();
+    void RigAnimator::update(DeltaTime deltaTime, size_t maxBoneDepth) {
+        boneTransforms.assign(rig.getBones().size(), MatrixMath::identity());
 
         std::vector<RigKeyframe> channelFrames;
         for (auto &pair: channels) {
@@ -258,6 +268,10 @@ namespace xng {
         for (auto &channelFrame: channelFrames) {
             totalWeight += channelFrame.weight;
             for (auto &boneAnimation: channelFrame.animation.channels) {
+                auto depthIt = boneDepths.find(boneAnimation.name);
+                if (depthIt != boneDepths.end() && depthIt->second > maxBoneDepth)
+                    continue;
+
                 auto pos = interpolatePosition(channelFrame.time,
                                                boneAnimation,
                                                channelFrame.animation.ticksPerSecond);
@@ -0,0 +1,67 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_PARALLELCHUNKS_HPP
+#define XENGINE_PARALLELCHUNKS_HPP
+
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "xng/async/threadpool.hpp"
+
+namespace xng {
+    /**
+     * Invoke fn(chunkIndex) for each chunk in [0, chunks).
+     * The first chunk is processed by the calling thread, the remaining chunks are processed on the ThreadPool.
+     */
+    template<typename F>
+    static void parallelChunks(size_t chunks, F fn) {
+        if (chunks <= 1) {
+            if (chunks == 1)
+                fn(0);
+            return;
+        }
+
+        std::vector<std::shared_ptr<Task>> tasks;
+        for (size_t chunk = 1; chunk < chunks; chunk++) {
+            tasks.emplace_back(ThreadPool::getPool().addTask([&fn, chunk]() { fn(chunk); }));
+        }
+
+        std::exception_ptr exception;
+        try {
+            fn(0);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        for (auto &task: tasks) {
+            auto &ex = task->join();
+            if (ex && !exception) {
+                exception = ex;
+            }
+        }
+
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+#endif //XENGINE_PARALLELCHUNKS_HPP
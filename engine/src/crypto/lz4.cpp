@@ -0,0 +1,193 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/crypto/lz4.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace xng {
+    static const size_t MIN_MATCH = 4;
+    static const size_t LAST_LITERALS = 5; // The last 5 bytes are always literals
+    static const size_t MATCH_FIND_LIMIT = 12; // The last match must start at least 12 bytes before the end
+    static const size_t MAX_OFFSET = 65535;
+    static const int HASH_LOG = 14;
+
+    static uint32_t read32(const char *data) {
+        uint32_t ret;
+        std::memcpy(&ret, data, sizeof(ret));
+        return ret;
+    }
+
+    static uint32_t hashSequence(uint32_t sequence) {
+        return (sequence * 2654435761u) >> (32 - HASH_LOG);
+    }
+
+    static void writeLength(std::vector<char> &out, size_t length) {
+        while (length >= 255) {
+            out.emplace_back(static_cast<char>(255));
+            length -= 255;
+        }
+        out.emplace_back(static_cast<char>(length));
+    }
+
+    static void writeSequence(std::vector<char> &out,
+                              const char *literals,
+                              size_t literalLength,
+                              size_t offset,
+                              size_t matchLength) {
+        auto token = static_cast<uint8_t>(std::min<size_t>(literalLength, 15) << 4);
+        if (matchLength > 0) {
+            token |= static_cast<uint8_t>(std::min<size_t>(matchLength - MIN_MATCH, 15));
+        }
+        out.emplace_back(static_cast<char>(token));
+
+        if (literalLength >= 15)
+            writeLength(out, literalLength - 15);
+        out.insert(out.end(), literals, literals + literalLength);
+
+        if (matchLength > 0) {
+            out.emplace_back(static_cast<char>(offset & 0xFF));
+            out.emplace_back(static_cast<char>((offset >> 8) & 0xFF));
+            if (matchLength - MIN_MATCH >= 15)
+                writeLength(out, matchLength - MIN_MATCH - 15);
+        }
+    }
+
+    std::vector<char> LZ4::compress(const char *data, size_t length) {
+        std::vector<char> ret;
+        ret.reserve(length + length / 255 + 16);
+
+        size_t anchor = 0;
+
+        if (length > MATCH_FIND_LIMIT) {
+            std::vector<uint32_t> table(1u << HASH_LOG, 0);
+
+            const size_t matchLimit = length - LAST_LITERALS;
+            const size_t findLimit = length - MATCH_FIND_LIMIT;
+
+            size_t i = 0;
+            while (i < findLimit) {
+                auto sequence = read32(data + i);
+                auto &entry = table[hashSequence(sequence)];
+                size_t ref = entry;
+                entry = static_cast<uint32_t>(i);
+
+                if (ref >= i || i - ref > MAX_OFFSET || read32(data + ref) != sequence) {
+                    // Skip faster through data that does not compress
+                    i += 1 + ((i - anchor) >> 6);
+                    continue;
+                }
+
+                // Extend the match backwards into the pending literals
+                while (i > anchor && ref > 0 && data[i - 1] == data[ref - 1]) {
+                    i--;
+                    ref--;
+                }
+
+                auto matchLength = MIN_MATCH;
+                while (i + matchLength < matchLimit && data[i + matchLength] == data[ref + matchLength]) {
+                    matchLength++;
+                }
+
+                writeSequence(ret, data + anchor, i - anchor, i - ref, matchLength);
+
+                i += matchLength;
+                anchor = i;
+
+                if (i - 2 < findLimit) {
+                    table[hashSequence(read32(data + i - 2))] = static_cast<uint32_t>(i - 2);
+                }
+            }
+        }
+
+        writeSequence(ret, data + anchor, length - anchor, 0, 0);
+
+        return ret;
+    }
+
+    static size_t readLength(const uint8_t *data, size_t length, size_t &position) {
+        size_t ret = 0;
+        uint8_t value;
+        do {
+            if (position >= length)
+                throw std::runtime_error("Corrupt LZ4 block");
+            value = data[position++];
+            ret += value;
+        } while (value == 255);
+        return ret;
+    }
+
+    void LZ4::decompress(const char *data, size_t length, char *output, size_t outputLength) {
+        auto *input = reinterpret_cast<const uint8_t *>(data);
+        size_t ip = 0;
+        size_t op = 0;
+
+        while (ip < length) {
+            auto token = input[ip++];
+
+            size_t literalLength = token >> 4;
+            if (literalLength == 15)
+                literalLength += readLength(input, length, ip);
+
+            if (literalLength > length - ip || literalLength > outputLength - op)
+                throw std::runtime_error("Corrupt LZ4 block");
+
+            // The output may be null for empty blocks which is undefined for memcpy even with a length of 0
+            if (literalLength > 0)
+                std::memcpy(output + op, data + ip, literalLength);
+            ip += literalLength;
+            op += literalLength;
+
+            if (ip == length)
+                break; // The last sequence contains only literals
+
+            if (length - ip < 2)
+                throw std::runtime_error("Corrupt LZ4 block");
+
+            size_t offset = input[ip] | (static_cast<size_t>(input[ip + 1]) << 8);
+            ip += 2;
+
+            if (offset == 0 || offset > op)
+                throw std::runtime_error("Corrupt LZ4 block");
+
+            size_t matchLength = token & 15;
+            if (matchLength == 15)
+                matchLength += readLength(input, length, ip);
+            matchLength += MIN_MATCH;
+
+            if (matchLength > outputLength - op)
+                throw std::runtime_error("Corrupt LZ4 block");
+
+            // The offset check above ensures that op > 0 and matchLength is at least MIN_MATCH so the output is not null
+            auto *dst = output + op;
+            const auto *src = dst - offset;
+            // Overlapping matches repeat the last offset bytes, copy in non overlapping steps of offset bytes
+            for (size_t i = 0; i < matchLength; i += offset) {
+                std::memcpy(dst + i, src + i, std::min(offset, matchLength - i));
+            }
+            op += matchLength;
+        }
+
+        if (op != outputLength)
+            throw std::runtime_error("Corrupt LZ4 block");
+    }
+}
@@ -19,6 +19,7 @@
 
 #include "xng/ecs/componentregistry.hpp"
 #include "xng/ecs/components.hpp"
+#include "xng/io/protocol/binaryprotocol.hpp"
 
 namespace xng {
     std::unique_ptr<ComponentRegistry> ComponentRegistry::inst = nullptr;
@@ -51,6 +52,31 @@ namespace xng {
                                               const Deserializer &deserializer,
                                               const Constructor &constructor,
                                               const Updater &updater) noexcept {
+        // Components registered without binary serializers are written as binary messages
+        return registerComponent(type,
+                                 typeName,
+                                 serializer,
+                                 deserializer,
+                                 constructor,
+                                 updater,
+                                 [serializer](const EntityScene &scene, EntityHandle ent, BinaryWriter &writer) {
+                                     Message message;
+                                     serializer(scene, ent, message);
+                                     BinaryProtocol::writeMessage(writer, message);
+                                 },
+                                 [deserializer](EntityScene &scene, EntityHandle ent, BinaryReader &reader) {
+                                     deserializer(scene, ent, BinaryProtocol::readMessage(reader));
+                                 });
+    }
+
+    bool ComponentRegistry::registerComponent(std::type_index type,
+                                              const std::string &typeName,
+                                              const Serializer &serializer,
+                                              const Deserializer &deserializer,
+                                              const Constructor &constructor,
+                                              const Updater &updater,
+                                              const BinarySerializer &binarySerializer,
+                                              const BinaryDeserializer &binaryDeserializer) noexcept {
         if (nameMapping.find(type) != nameMapping.end()) {
             return false;
         }
@@ -61,6 +87,8 @@ namespace xng {
         deserializers[type] = deserializer;
         constructors[type] = constructor;
         updaters[type] = updater;
+        binarySerializers[type] = binarySerializer;
+        binaryDeserializers[type] = binaryDeserializer;
         return true;
     }
 
@@ -72,6 +100,8 @@ namespace xng {
         deserializers.erase(type);
         constructors.erase(type);
         updaters.erase(type);
+        binarySerializers.erase(type);
+        binaryDeserializers.erase(type);
     }
 
     const std::type_index &ComponentRegistry::getTypeFromName(const std::string &typeName) {
@@ -102,6 +132,14 @@ namespace xng {
         return updaters.at(index);
     }
 
+    const ComponentRegistry::BinarySerializer &ComponentRegistry::getBinarySerializer(const std::type_index &index) {
+        return binarySerializers.at(index);
+    }
+
+    const ComponentRegistry::BinaryDeserializer &ComponentRegistry::getBinaryDeserializer(const std::type_index &index) {
+        return binaryDeserializers.at(index);
+    }
+
     const std::map<std::type_index, std::string> &ComponentRegistry::getComponents() {
         return nameMapping;
     }
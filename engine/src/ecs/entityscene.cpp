@@ -20,33 +20,40 @@
 #include "xng/ecs/entityscene.hpp"
 #include "xng/ecs/components.hpp"
 #include "xng/ecs/entity.hpp"
+#include "xng/io/protocol/binaryprotocol.hpp"
 
 namespace xng {
+    /**
+     * Registered components are written by their binary serializer,
+     * generic components are written as binary messages.
+     */
+    enum BinaryComponentKind : uint8_t {
+        BINARY_COMPONENT_REGISTERED = 0,
+        BINARY_COMPONENT_MESSAGE = 1
+    };
+
     void EntityScene::serializeEntity(const EntityHandle &entity, Message &message) const {
         message = Message(Message::DICTIONARY);
         auto it = entityNamesReverse.find(entity);
         if (it != entityNamesReverse.end()) {
             message["name"] = it->second;
         }
-        auto cmap = std::map<std::string, Message>();
+        auto &components = message["components"];
+        components = Message(Message::DICTIONARY);
         for (auto &pair: componentPools) {
             if (pair.first == typeid(GenericComponent)) {
                 if (pair.second->check(entity)) {
                     auto &comp = pair.second->get<GenericComponent>(entity);
                     for (auto &p: comp.components) {
-                        cmap[p.first] = p.second;
+                        components[p.first] = p.second;
                     }
                 }
 
             } else if (pair.second->check(entity)) {
-                auto serializer = ComponentRegistry::instance().getSerializer(pair.first);
-                Message msg;
-                serializer(*this, entity, msg);
-                cmap[ComponentRegistry::instance().getNameFromType(pair.first)] = msg;
+                auto &serializer = ComponentRegistry::instance().getSerializer(pair.first);
+                serializer(*this, entity, components[ComponentRegistry::instance().getNameFromType(pair.first)]);
             }
         }
-
-        message["components"] = cmap;
     }
 
     void EntityScene::deserializeEntity(const Message &message) {
@@ -56,19 +63,112 @@ namespace xng {
         } else {
             entity = create();
         }
-        for (auto &c: message.getMessage("components", std::map<std::string, Message>()).asDictionary()) {
-            if (ComponentRegistry::instance().checkTypeName(c.first)) {
-                auto type = ComponentRegistry::instance().getTypeFromName(c.first);
-                auto deserializer = ComponentRegistry::instance().getDeserializer(type);
-                deserializer(*this, entity, c.second);
+        const Message none;
+        auto &components = message.getMessage("components", none);
+        if (components.getType() != Message::DICTIONARY) {
+            return;
+        }
+        components.forEachEntry([this, &entity](const std::string &typeName, const Message &value) {
+            if (ComponentRegistry::instance().checkTypeName(typeName)) {
+                auto type = ComponentRegistry::instance().getTypeFromName(typeName);
+                auto &deserializer = ComponentRegistry::instance().getDeserializer(type);
+                deserializer(*this, entity, value);
             } else {
                 if (!checkComponent<GenericComponent>(entity)) {
                     createComponent(entity, GenericComponent());
                 }
                 auto comp = getComponent<GenericComponent>(entity);
-                comp.components[c.first] = c.second;
+                comp.components[typeName] = value;
                 updateComponent(entity, comp);
             }
+        });
+    }
+
+    void EntityScene::serialize(BinaryWriter &writer) const {
+        writer.write(BINARY_SCENE_MAGIC.data(), BINARY_SCENE_MAGIC.size());
+        writer.writeString(name);
+        writer.writeUInt(entities.size());
+        for (auto &entity: entities) {
+            auto it = entityNamesReverse.find(entity);
+            writer.writeBool(it != entityNamesReverse.end());
+            if (it != entityNamesReverse.end()) {
+                writer.writeString(it->second);
+            }
+
+            size_t count = 0;
+            for (auto &pair: componentPools) {
+                if (pair.second->check(entity)) {
+                    if (pair.first == typeid(GenericComponent)) {
+                        count += pair.second->get<GenericComponent>(entity).components.size();
+                    } else {
+                        count++;
+                    }
+                }
+            }
+            writer.writeUInt(count);
+
+            for (auto &pair: componentPools) {
+                if (!pair.second->check(entity)) {
+                    continue;
+                }
+                if (pair.first == typeid(GenericComponent)) {
+                    for (auto &p: pair.second->get<GenericComponent>(entity).components) {
+                        writer.writeKey(p.first);
+                        writer.writeUInt8(BINARY_COMPONENT_MESSAGE);
+                        BinaryProtocol::writeMessage(writer, p.second);
+                    }
+                } else {
+                    writer.writeKey(ComponentRegistry::instance().getNameFromType(pair.first));
+                    writer.writeUInt8(BINARY_COMPONENT_REGISTERED);
+                    ComponentRegistry::instance().getBinarySerializer(pair.first)(*this, entity, writer);
+                }
+            }
+        }
+    }
+
+    void EntityScene::deserialize(BinaryReader &reader) {
+        std::string magic(BINARY_SCENE_MAGIC.size(), 0);
+        reader.read(magic.data(), magic.size());
+        if (magic != BINARY_SCENE_MAGIC)
+            throw std::runtime_error("Invalid binary scene magic");
+
+        name = reader.readString();
+        auto entityCount = reader.readUInt();
+        for (size_t i = 0; i < entityCount; i++) {
+            EntityHandle entity;
+            if (reader.readBool()) {
+                entity = create(reader.readString());
+            } else {
+                entity = create();
+            }
+
+            auto count = reader.readUInt();
+            for (size_t c = 0; c < count; c++) {
+                auto &typeName = reader.readKey();
+                auto kind = reader.readUInt8();
+                if (kind == BINARY_COMPONENT_REGISTERED) {
+                    // The data of registered components can only be read by the component type
+                    if (!ComponentRegistry::instance().checkTypeName(typeName))
+                        throw std::runtime_error("Binary scene contains unregistered component type " + typeName);
+                    auto type = ComponentRegistry::instance().getTypeFromName(typeName);
+                    ComponentRegistry::instance().getBinaryDeserializer(type)(*this, entity, reader);
+                } else if (kind == BINARY_COMPONENT_MESSAGE) {
+                    auto message = BinaryProtocol::readMessage(reader);
+                    if (ComponentRegistry::instance().checkTypeName(typeName)) {
+                        auto type = ComponentRegistry::instance().getTypeFromName(typeName);
+                        ComponentRegistry::instance().getDeserializer(type)(*this, entity, message);
+                    } else {
+                        if (!checkComponent<GenericComponent>(entity)) {
+                            createComponent(entity, GenericComponent());
+                        }
+                        auto comp = getComponent<GenericComponent>(entity);
+                        comp.components[typeName] = message;
+                        updateComponent(entity, comp);
+                    }
+                } else {
+                    throw std::runtime_error("Invalid binary scene component kind");
+                }
+            }
         }
     }
 
@@ -60,6 +60,7 @@ namespace xng {
 
             SkinnedMeshProperty meshProperty;
             meshProperty.mesh = pair.second.mesh;
+            meshProperty.objectId = pair.first.id;
             node.addProperty(meshProperty);
 
             ShadowProperty shadowProperty;
@@ -75,15 +76,30 @@ namespace xng {
             }
 
             if (entScene.checkComponent<RigAnimationComponent>(pair.first)) {
-                BoneTransformsProperty boneTransformsProperty;
-                boneTransformsProperty.boneTransforms = entScene.getComponent<RigAnimationComponent>(
-                        pair.first).boneTransforms;
-                node.addProperty(boneTransformsProperty);
+                auto &boneTransforms = entScene.getComponent<RigAnimationComponent>(pair.first).boneTransforms;
+                if (!boneTransforms.empty()) {
+                    BoneTransformsProperty boneTransformsProperty;
+                    boneTransformsProperty.paletteOffset = scene.bonePalette.add(boneTransforms);
+                    node.addProperty(boneTransformsProperty);
+                }
             }
 
             scene.rootNode.childNodes.emplace_back(node);
         }
 
+        // Get particles
+        for (auto &pair: entScene.getPool<ParticleComponent>()) {
+            if (!pair.second.enabled || !pair.second.instances || pair.second.instances->empty())
+                continue;
+
+            ParticleProperty particleProperty;
+            particleProperty.instances = pair.second.instances;
+
+            Node node;
+            node.addProperty(particleProperty);
+            scene.rootNode.childNodes.emplace_back(node);
+        }
+
         // Get skybox
         for (auto &pair: entScene.getPool<SkyboxComponent>()) {
             auto &comp = pair.second;
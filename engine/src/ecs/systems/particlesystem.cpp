@@ -0,0 +1,97 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "xng/ecs/systems/particlesystem.hpp"
+#include "xng/ecs/components/cameracomponent.hpp"
+#include "xng/ecs/components/transformcomponent.hpp"
+
+namespace xng {
+    void ParticleSystem::start(EntityScene &scene, EventBus &eventBus) {
+        scene.addListener(*this);
+    }
+
+    void ParticleSystem::stop(EntityScene &scene, EventBus &eventBus) {
+        scene.removeListener(*this);
+        emitters.clear();
+    }
+
+    void ParticleSystem::update(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus) {
+        Vec3f cameraPosition;
+        for (auto &pair: scene.getPool<CameraComponent>()) {
+            if (!scene.checkComponent<TransformComponent>(pair.first))
+                continue;
+            auto &tcomp = scene.getComponent<TransformComponent>(pair.first);
+            if (!tcomp.enabled)
+                continue;
+            cameraPosition = TransformComponent::walkHierarchy(tcomp, scene).getPosition();
+            break;
+        }
+
+        auto delta = static_cast<float>(static_cast<double>(deltaTime));
+
+        std::map<EntityHandle, ParticleComponent> cUpdates;
+        for (auto &c: scene.getPool<ParticleComponent>()) {
+            if (!c.second.enabled)
+                continue;
+
+            if (!scene.checkComponent<TransformComponent>(c.first))
+                continue;
+
+            auto &tcomp = scene.getComponent<TransformComponent>(c.first);
+            if (!tcomp.enabled)
+                continue;
+
+            auto origin = TransformComponent::walkHierarchy(tcomp, scene).getPosition();
+
+            auto it = emitters.find(c.first);
+            if (it == emitters.end()) {
+                it = emitters.emplace(c.first, EmitterState()).first;
+                it->second.seed = static_cast<uint64_t>(c.first.id);
+            }
+
+            auto &state = it->second;
+            state.pool.update(delta,
+                              origin,
+                              cameraPosition,
+                              c.second.emitter,
+                              state.spawnAccumulator,
+                              state.seed++);
+
+            auto instances = std::make_shared<std::vector<ParticleInstance>>();
+            state.pool.writeInstances(c.second.emitter, *instances);
+
+            cUpdates[c.first] = c.second;
+            cUpdates.at(c.first).instances = instances;
+        }
+
+        for (auto &pair: cUpdates) {
+            scene.updateComponent(pair.first, pair.second);
+        }
+    }
+
+    void ParticleSystem::onComponentDestroy(const EntityHandle &entity, const Component &component) {
+        if (component.getType() == typeid(ParticleComponent)) {
+            emitters.erase(entity);
+        }
+    }
+
+    void ParticleSystem::onEntityDestroy(const EntityHandle &entity) {
+        emitters.erase(entity);
+    }
+}
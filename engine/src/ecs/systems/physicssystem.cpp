@@ -60,6 +60,17 @@ namespace xng {
         return shape;
     }
 
+    static bool equals(const Quaternion &a, const Quaternion &b) {
+        return a.w == b.w && a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+
+    static bool hasForces(const RigidBodyComponent &comp) {
+        return comp.force != Vec3f()
+               || comp.torque != Vec3f()
+               || comp.impulse != Vec3f()
+               || comp.angularImpulse != Vec3f();
+    }
+
     PhysicsSystem::PhysicsSystem(World &world, float scale, float timeStep)
             : world(world), scale(scale), timeStep(timeStep) {}
 
@@ -132,28 +143,66 @@ namespace xng {
             }
 
             auto &rb = *rigidbodies.at(pair.first).get();
-            auto tcomp = scene.getComponent<TransformComponent>(pair.first);
-
-            if (pair.second.rotationalInertia.x < 0
-                || pair.second.rotationalInertia.y < 0
-                || pair.second.rotationalInertia.z < 0)
-                rb.setMass(pair.second.type == RigidBody::STATIC ? 0 : pair.second.mass,
-                           pair.second.massCenter);
-            else
-                rb.setMass(pair.second.type == RigidBody::STATIC ? 0 : pair.second.mass,
-                           pair.second.massCenter,
-                           pair.second.rotationalInertia);
-
-            rb.setVelocity(pair.second.velocity);
-            rb.setAngularVelocity(pair.second.angularVelocity);
-
-            rb.setPosition(tcomp.transform.getPosition() / scale);
-            rb.setRotation(tcomp.transform.getRotation().getEulerAngles());
-
-            rb.applyForce(pair.second.force, pair.second.forcePoint / scale);
-            rb.applyTorque(pair.second.torque);
-            rb.applyLinearImpulse(pair.second.impulse, pair.second.impulsePoint);
-            rb.applyAngularImpulse(pair.second.angularImpulse);
+            auto &tcomp = scene.getComponent<TransformComponent>(pair.first);
+            auto &comp = pair.second;
+
+            auto it = bodyStates.find(pair.first);
+            auto created = it == bodyStates.end();
+            if (created) {
+                it = bodyStates.emplace(pair.first, BodyState()).first;
+            }
+            auto &state = it->second;
+
+            // Only push the values which were changed since the last synchronization to the world.
+            if (created
+                || state.mass != comp.mass
+                || state.massCenter != comp.massCenter
+                || state.rotationalInertia != comp.rotationalInertia
+                || state.type != comp.type) {
+                if (comp.rotationalInertia.x < 0
+                    || comp.rotationalInertia.y < 0
+                    || comp.rotationalInertia.z < 0)
+                    rb.setMass(comp.type == RigidBody::STATIC ? 0 : comp.mass,
+                               comp.massCenter);
+                else
+                    rb.setMass(comp.type == RigidBody::STATIC ? 0 : comp.mass,
+                               comp.massCenter,
+                               comp.rotationalInertia);
+                state.mass = comp.mass;
+                state.massCenter = comp.massCenter;
+                state.rotationalInertia = comp.rotationalInertia;
+                state.type = comp.type;
+                state.forceWriteBack = true;
+            }
+
+            if (created
+                || state.position != tcomp.transform.getPosition()
+                || !equals(state.rotation, tcomp.transform.getRotation())
+                || state.velocity != comp.velocity
+                || state.angularVelocity != comp.angularVelocity) {
+                RigidBody::State bodyState;
+                bodyState.position = tcomp.transform.getPosition() / scale;
+                bodyState.rotation = tcomp.transform.getRotation().getEulerAngles();
+                bodyState.velocity = comp.velocity;
+                bodyState.angularVelocity = comp.angularVelocity;
+                writeBodies.emplace_back(&rb);
+                writeStates.emplace_back(bodyState);
+                state.forceWriteBack = true;
+            }
+
+            if (hasForces(comp)) {
+                forceEntities.emplace_back(pair.first);
+                state.forceWriteBack = true;
+            }
+        }
+
+        if (!writeBodies.empty()) {
+            world.setStates(writeBodies, writeStates);
+        }
+
+        for (auto &entity: forceEntities) {
+            auto &comp = scene.getComponent<RigidBodyComponent>(entity);
+            applyForces(*rigidbodies.at(entity), comp);
         }
 
         if (timeStep == 0) {
@@ -164,36 +213,73 @@ namespace xng {
             deltaAccumulator -= timeStep * static_cast<float>(steps);
 
             for (int i = 0; i < steps && i < maxSteps; i++) {
-                for (auto &pair: scene.getPool<RigidBodyComponent>()) {
-                    auto &rb = *rigidbodies.at(pair.first).get();
-                    rb.applyForce(pair.second.force, pair.second.forcePoint / scale);
-                    rb.applyTorque(pair.second.torque);
-                    rb.applyLinearImpulse(pair.second.impulse, pair.second.impulsePoint);
-                    rb.applyAngularImpulse(pair.second.angularImpulse);
+                for (auto &entity: forceEntities) {
+                    auto &comp = scene.getComponent<RigidBodyComponent>(entity);
+                    applyForces(*rigidbodies.at(entity), comp);
                 }
 
                 world.step(DeltaTime(timeStep));
             }
         }
+
+        // Read the state of all bodies in bulk and write back only the bodies which are awake or were modified.
         for (auto &pair: scene.getPool<RigidBodyComponent>()) {
-            auto &rb = *rigidbodies.at(pair.first).get();
-            auto tcomp = scene.getComponent<TransformComponent>(pair.first);
+            readEntities.emplace_back(pair.first);
+            readBodies.emplace_back(rigidbodies.at(pair.first).get());
+        }
+
+        world.getStates(readBodies, readStates);
+
+        for (auto i = 0; i < readEntities.size(); i++) {
+            auto &entity = readEntities.at(i);
+            auto &bodyState = readStates.at(i);
+            auto &state = bodyStates.at(entity);
 
-            tcomp.transform.setPosition(rb.getPosition() * scale);
-            tcomp.transform.setRotation(Quaternion(rb.getRotation()));
+            if (!bodyState.awake && !state.forceWriteBack)
+                continue;
 
-            RigidBodyComponent comp = pair.second;
+            auto &rb = *readBodies.at(i);
+
+            auto tcomp = scene.getComponent<TransformComponent>(entity);
+            tcomp.transform.setPosition(bodyState.position * scale);
+            tcomp.transform.setRotation(Quaternion(bodyState.rotation));
+
+            RigidBodyComponent comp = scene.getComponent<RigidBodyComponent>(entity);
             comp.force = Vec3f();
             comp.torque = Vec3f();
             comp.impulse = Vec3f();
             comp.angularImpulse = Vec3f();
-            comp.velocity = rb.getVelocity();
-            comp.angularVelocity = rb.getAngularVelocity();
+            comp.velocity = bodyState.velocity;
+            comp.angularVelocity = bodyState.angularVelocity;
             comp.mass = rb.getMass();
 
-            scene.updateComponent(pair.first, comp);
-            scene.updateComponent(pair.first, tcomp);
+            state.position = tcomp.transform.getPosition();
+            state.rotation = tcomp.transform.getRotation();
+            state.velocity = comp.velocity;
+            state.angularVelocity = comp.angularVelocity;
+            state.mass = comp.mass;
+            state.forceWriteBack = false;
+
+            scene.updateComponent(entity, comp);
+            scene.updateComponent(entity, tcomp);
         }
+
+        writeBodies.clear();
+        writeStates.clear();
+        forceEntities.clear();
+        readEntities.clear();
+        readBodies.clear();
+    }
+
+    void PhysicsSystem::applyForces(RigidBody &rb, const RigidBodyComponent &comp) const {
+        if (comp.force != Vec3f())
+            rb.applyForce(comp.force, comp.forcePoint / scale);
+        if (comp.torque != Vec3f())
+            rb.applyTorque(comp.torque);
+        if (comp.impulse != Vec3f())
+            rb.applyLinearImpulse(comp.impulse, comp.impulsePoint);
+        if (comp.angularImpulse != Vec3f())
+            rb.applyAngularImpulse(comp.angularImpulse);
     }
 
     void PhysicsSystem::onComponentCreate(const EntityHandle &entity, const Component &component) {
@@ -211,6 +297,7 @@ namespace xng {
                 rigidbodiesReverse.erase(rigidbodies.at(entity).get());
                 rigidbodies.erase(entity);
             }
+            bodyStates.erase(entity);
         }
     }
 
@@ -222,9 +309,13 @@ namespace xng {
             auto &nComp = dynamic_cast<const RigidBodyComponent &>(newComponent);
 
             if (rigidbodies.find(entity) != rigidbodies.end()) {
-                rigidbodies.at(entity)->setRigidBodyType(nComp.type);
-                rigidbodies.at(entity)->setAngularFactor(nComp.angularFactor);
-                rigidbodies.at(entity)->setGravityScale(nComp.gravityScale);
+                // Most updates are write backs by this system which do not change these properties
+                if (oComp.type != nComp.type)
+                    rigidbodies.at(entity)->setRigidBodyType(nComp.type);
+                if (oComp.angularFactor != nComp.angularFactor)
+                    rigidbodies.at(entity)->setAngularFactor(nComp.angularFactor);
+                if (oComp.gravityScale != nComp.gravityScale)
+                    rigidbodies.at(entity)->setGravityScale(nComp.gravityScale);
             }
         } else if (oldComponent.getType() == typeid(Collider2DComponent)) {
             auto &oComp = dynamic_cast<const Collider2DComponent &>(oldComponent);
@@ -249,6 +340,7 @@ namespace xng {
             if (rigidbodies.find(entity) != rigidbodies.end()) {
                 rigidbodiesReverse.erase(rigidbodies.at(entity).get());
                 rigidbodies.erase(entity);
+                bodyStates.erase(entity);
             }
         }
     }
@@ -297,5 +389,6 @@ namespace xng {
             rigidbodies.erase(entity);
             rigidbodiesReverse.erase(ptr);
         }
+        bodyStates.erase(entity);
     }
 }
\ No newline at end of file
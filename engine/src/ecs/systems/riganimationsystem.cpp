@@ -20,9 +20,99 @@
 #include "xng/ecs/systems/riganimationsystem.hpp"
 #include "xng/ecs/components/riganimationcomponent.hpp"
 #include "xng/ecs/components/skinnedmeshcomponent.hpp"
+#include "xng/ecs/components/cameracomponent.hpp"
+#include "xng/ecs/components/transformcomponent.hpp"
 #include "xng/util/time.hpp"
+#include "xng/math/matrixmath.hpp"
+#include "xng/math/quaternion.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace xng {
+    struct BoneTransform {
+        Vec3f translation;
+        Quaternion rotation;
+        Vec3f scale;
+    };
+
+    /**
+     * Shear is not representable and is discarded, the bone matrices of rigs without non uniform scale contain none.
+     */
+    static BoneTransform decompose(const Mat4f &mat) {
+        BoneTransform ret;
+        ret.translation = Vec3f(mat.get(3, 0), mat.get(3, 1), mat.get(3, 2));
+
+        Vec3f axes[3];
+        for (auto col = 0; col < 3; col++) {
+            axes[col] = Vec3f(mat.get(col, 0), mat.get(col, 1), mat.get(col, 2));
+        }
+
+        auto determinant = axes[0].x * (axes[1].y * axes[2].z - axes[1].z * axes[2].y)
+                           - axes[1].x * (axes[0].y * axes[2].z - axes[0].z * axes[2].y)
+                           + axes[2].x * (axes[0].y * axes[1].z - axes[0].z * axes[1].y);
+
+        float scale[3];
+        for (auto col = 0; col < 3; col++) {
+            scale[col] = axes[col].magnitude();
+            if (scale[col] > 0) {
+                axes[col] = axes[col] / scale[col];
+            }
+        }
+        // Mirrored matrices are represented by a negative x scale
+        if (determinant < 0) {
+            scale[0] = -scale[0];
+            axes[0] = axes[0] * -1.0f;
+        }
+        ret.scale = Vec3f(scale[0], scale[1], scale[2]);
+
+        // r(row, col) of the rotation matrix
+        auto r = [&](int row, int col) {
+            auto &axis = axes[col];
+            return row == 0 ? axis.x : (row == 1 ? axis.y : axis.z);
+        };
+
+        auto trace = r(0, 0) + r(1, 1) + r(2, 2);
+        if (trace > 0) {
+            auto s = std::sqrt(trace + 1) * 2;
+            ret.rotation = Quaternion(0.25f * s, (r(2, 1) - r(1, 2)) / s, (r(0, 2) - r(2, 0)) / s, (r(1, 0) - r(0, 1)) / s);
+        } else if (r(0, 0) > r(1, 1) && r(0, 0) > r(2, 2)) {
+            auto s = std::sqrt(1 + r(0, 0) - r(1, 1) - r(2, 2)) * 2;
+            ret.rotation = Quaternion((r(2, 1) - r(1, 2)) / s, 0.25f * s, (r(0, 1) + r(1, 0)) / s, (r(0, 2) + r(2, 0)) / s);
+        } else if (r(1, 1) > r(2, 2)) {
+            auto s = std::sqrt(1 + r(1, 1) - r(0, 0) - r(2, 2)) * 2;
+            ret.rotation = Quaternion((r(0, 2) - r(2, 0)) / s, (r(0, 1) + r(1, 0)) / s, 0.25f * s, (r(1, 2) + r(2, 1)) / s);
+        } else {
+            auto s = std::sqrt(1 + r(2, 2) - r(0, 0) - r(1, 1)) * 2;
+            ret.rotation = Quaternion((r(1, 0) - r(0, 1)) / s, (r(0, 2) + r(2, 0)) / s, (r(1, 2) + r(2, 1)) / s, 0.25f * s);
+        }
+        ret.rotation.normalize();
+
+        return ret;
+    }
+
+    /**
+     * Blends the decomposed bone transforms, lerping the matrix elements instead would shear and shrink rotations.
+     */
+    static std::vector<Mat4f> blend(const std::vector<Mat4f> &a,
+                                    const std::vector<Mat4f> &b,
+                                    float t) {
+        std::vector<Mat4f> ret = b;
+        for (auto bone = 0; bone < std::min(a.size(), ret.size()); bone++) {
+            auto from = decompose(a[bone]);
+            auto to = decompose(ret[bone]);
+            auto translation = from.translation + (to.translation - from.translation) * t;
+            auto rotation = Quaternion::slerp(from.rotation, to.rotation, t).normalize();
+            auto scale = from.scale + (to.scale - from.scale) * t;
+            ret[bone] = MatrixMath::translate(translation) * rotation.matrix() * MatrixMath::scale(scale);
+        }
+        return ret;
+    }
+
+    RigAnimationSystem::RigAnimationSystem(LodSettings settings)
+            : settings(std::move(settings)) {
+    }
+
     void RigAnimationSystem::start(EntityScene &scene, EventBus &eventBus) {
         scene.addListener(*this);
     }
@@ -32,22 +122,101 @@ namespace xng {
     }
 
     void RigAnimationSystem::update(DeltaTime deltaTime, EntityScene &scene, EventBus &eventBus) {
+        frame++;
+
+        bool hasCamera = false;
+        Vec3f cameraPosition;
+        for (auto &pair: scene.getPool<CameraComponent>()) {
+            if (!scene.checkComponent<TransformComponent>(pair.first))
+                continue;
+            auto &tcomp = scene.getComponent<TransformComponent>(pair.first);
+            if (!tcomp.enabled)
+                continue;
+            cameraPosition = TransformComponent::walkHierarchy(tcomp, scene).getPosition();
+            hasCamera = true;
+            break;
+        }
+
+        std::vector<std::pair<EntityHandle, size_t>> dueRigs;
         std::map<EntityHandle, RigAnimationComponent> cUpdates;
         for (auto &c: scene.getPool<RigAnimationComponent>()) {
             if (scene.checkComponent<SkinnedMeshComponent>(c.first)) {
-                if (rigAnimators.find(c.first) == rigAnimators.end()) {
+                if (rigs.find(c.first) == rigs.end()) {
                     auto &meshComponent = scene.getComponent<SkinnedMeshComponent>(c.first);
-                    rigAnimators[c.first] = RigAnimator(meshComponent.mesh.get().rig);
+                    auto &state = rigs[c.first];
+                    state.animator = RigAnimator(meshComponent.mesh.get().rig);
                     for (auto &pair: c.second.channels) {
-                        rigAnimators.at(c.first).start(pair.second.animation.get(),
-                                                       pair.second.blendDuration,
-                                                       pair.second.loop,
-                                                       pair.first);
+                        state.animator.start(pair.second.animation.get(),
+                                             pair.second.blendDuration,
+                                             pair.second.loop,
+                                             pair.first);
                     }
+                    state.deferred = true; // Evaluate new rigs immediately
+                }
+
+                auto &state = rigs.at(c.first);
+                state.pendingTime += deltaTime;
+                state.framesSinceUpdate++;
+
+                size_t lod = 0;
+                if (hasCamera && scene.checkComponent<TransformComponent>(c.first)) {
+                    auto &tcomp = scene.getComponent<TransformComponent>(c.first);
+                    auto position = TransformComponent::walkHierarchy(tcomp, scene).getPosition();
+                    lod = getLodLevel(position.distance(cameraPosition));
+                }
+
+                auto interval = lod < settings.levels.size()
+                                ? std::max(1, settings.levels.at(lod).updateInterval)
+                                : 1;
+
+                // Offset the update frame by the entity id to spread the evaluation of rigs across frames.
+                if (state.deferred
+                    || (state.framesSinceUpdate >= interval
+                        && (frame + static_cast<unsigned long>(c.first.id)) % interval == 0)) {
+                    dueRigs.emplace_back(c.first, lod);
+                } else if (settings.interpolate && !state.previousTransforms.empty()) {
+                    auto t = std::min(1.0f, static_cast<float>(state.framesSinceUpdate) / static_cast<float>(interval));
+                    cUpdates[c.first] = c.second;
+                    cUpdates.at(c.first).boneTransforms = blend(state.previousTransforms,
+                                                                state.animator.getBoneTransforms(),
+                                                                t);
                 }
-                rigAnimators.at(c.first).update(deltaTime);
-                cUpdates[c.first] = c.second;
-                cUpdates.at(c.first).boneTransforms = rigAnimators.at(c.first).getBoneTransforms();
+            }
+        }
+
+        // Evaluate the rigs which waited the longest first so that rigs skipped by the budget cannot starve.
+        std::sort(dueRigs.begin(), dueRigs.end(), [this](const auto &a, const auto &b) {
+            return rigs.at(a.first).pendingTime > rigs.at(b.first).pendingTime;
+        });
+
+        auto budgetStart = std::chrono::steady_clock::now();
+        for (auto &pair: dueRigs) {
+            auto &state = rigs.at(pair.first);
+            if (settings.budget.count() > 0
+                && std::chrono::steady_clock::now() - budgetStart > settings.budget) {
+                state.deferred = true;
+                continue;
+            }
+
+            auto maxBoneDepth = pair.second < settings.levels.size()
+                                ? settings.levels.at(pair.second).maxBoneDepth
+                                : std::numeric_limits<size_t>::max();
+
+            if (settings.interpolate) {
+                state.previousTransforms = state.animator.getBoneTransforms();
+            }
+
+            state.animator.update(state.pendingTime, maxBoneDepth);
+            state.pendingTime = 0;
+            state.framesSinceUpdate = 0;
+            state.deferred = false;
+
+            auto &component = scene.getComponent<RigAnimationComponent>(pair.first);
+            cUpdates[pair.first] = component;
+            if (settings.interpolate && !state.previousTransforms.empty()) {
+                cUpdates.at(pair.first).boneTransforms = state.previousTransforms;
+            } else {
+                cUpdates.at(pair.first).boneTransforms = state.animator.getBoneTransforms();
             }
         }
 
@@ -56,17 +225,29 @@ namespace xng {
         }
     }
 
+    size_t RigAnimationSystem::getLodLevel(float distance) const {
+        size_t ret = 0;
+        for (auto i = 0; i < settings.levels.size(); i++) {
+            if (distance >= settings.levels.at(i).distance) {
+                ret = i;
+            } else {
+                break;
+            }
+        }
+        return ret;
+    }
+
     void RigAnimationSystem::onComponentCreate(const EntityHandle &entity, const Component &component) {
         if (component.getType() == typeid(SkinnedMeshComponent)
             || component.getType() == typeid(RigAnimationComponent)) {
-            rigAnimators.erase(entity);
+            rigs.erase(entity);
         }
     }
 
     void RigAnimationSystem::onComponentDestroy(const EntityHandle &entity, const Component &component) {
         if (component.getType() == typeid(SkinnedMeshComponent)
             || component.getType() == typeid(RigAnimationComponent)) {
-            rigAnimators.erase(entity);
+            rigs.erase(entity);
         }
     }
 
@@ -74,13 +255,17 @@ namespace xng {
                                                const Component &oldComponent,
                                                const Component &newComponent) {
         if (oldComponent.getType() == typeid(SkinnedMeshComponent)) {
-            rigAnimators.erase(entity);
+            rigs.erase(entity);
         } else if (oldComponent.getType() == typeid(RigAnimationComponent)) {
+            auto it = rigs.find(entity);
+            if (it == rigs.end())
+                return;
+            auto &animator = it->second.animator;
             auto &oc = dynamic_cast<const RigAnimationComponent &>(oldComponent);
             auto &nc = dynamic_cast<const RigAnimationComponent &>(newComponent);
             for (auto &pair: oc.channels) {
                 if (nc.channels.find(pair.first) == nc.channels.end()) {
-                    rigAnimators.at(entity).stop(pair.first);
+                    animator.stop(pair.first);
                 }
             }
             for (auto &pair: nc.channels) {
@@ -92,16 +277,16 @@ namespace xng {
                     }
                 }
                 if (!skipUpdate) {
-                    rigAnimators.at(entity).start(pair.second.animation.get(),
-                                                      pair.second.blendDuration,
-                                                      pair.second.loop,
-                                                      pair.first);
+                    animator.start(pair.second.animation.get(),
+                                   pair.second.blendDuration,
+                                   pair.second.loop,
+                                   pair.first);
                 }
             }
         }
     }
 
     void RigAnimationSystem::onEntityDestroy(const EntityHandle &entity) {
-        rigAnimators.erase(entity);
+        rigs.erase(entity);
     }
 }
\ No newline at end of file
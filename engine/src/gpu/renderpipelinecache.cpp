@@ -0,0 +1,196 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/gpu/renderpipelinecache.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "xng/util/stablehash.hpp"
+
+namespace xng {
+    static void hashLayout(StableHash &hash, const VertexLayout &layout) {
+        hash.add(static_cast<uint64_t>(layout.attributes.size()));
+        for (auto &attribute: layout.attributes) {
+            hash.add(attribute.type);
+            hash.add(attribute.component);
+            hash.add(static_cast<uint64_t>(attribute.offset));
+            hash.add(attribute.normalized);
+        }
+    }
+
+    RenderPipelineCache::RenderPipelineCache(RenderDevice &device,
+                                             ShaderDecompiler &decompiler,
+                                             size_t capacity,
+                                             const std::filesystem::path &directory)
+            : device(device),
+              decompilerCache(decompiler),
+              capacity(capacity) {
+        // Pipeline binaries are only valid for the driver which created them
+        auto &info = device.getInfo();
+        StableHash hash;
+        hash.add(info.name);
+        hash.add(info.renderer);
+        hash.add(info.vendor);
+        hash.add(info.version);
+        deviceHash = hash.get();
+
+        setDirectory(directory);
+    }
+
+    RenderPipeline &RenderPipelineCache::get(const RenderPipelineDesc &desc) {
+        auto key = getStableHash(desc);
+        auto range = entries.equal_range(key);
+        for (auto it = range.first; it != range.second; it++) {
+            auto entry = it->second;
+            if (entry->desc == desc) {
+                lru.splice(lru.begin(), lru, entry);
+                entry->frame = frame;
+                return *entry->pipeline;
+            }
+        }
+
+        // Descriptions with colliding hashes are chained in the same bucket and not stored on disk
+        // because the file name of the binary is derived from the hash.
+        auto persistent = range.first == range.second;
+
+        Entry entry;
+        entry.key = key;
+        entry.desc = desc;
+        entry.pipeline = create(desc, key, persistent);
+        entry.frame = frame;
+        lru.emplace_front(std::move(entry));
+        entries.emplace(key, lru.begin());
+        return *lru.front().pipeline;
+    }
+
+    void RenderPipelineCache::collect() {
+        while (entries.size() > capacity) {
+            auto entry = std::prev(lru.end());
+            if (entry->frame == frame) {
+                break;
+            }
+            auto range = entries.equal_range(entry->key);
+            for (auto it = range.first; it != range.second; it++) {
+                if (it->second == entry) {
+                    entries.erase(it);
+                    break;
+                }
+            }
+            lru.pop_back();
+        }
+        frame++;
+    }
+
+    void RenderPipelineCache::clear() {
+        entries.clear();
+        lru.clear();
+        decompilerCache.clear();
+    }
+
+    void RenderPipelineCache::setDirectory(const std::filesystem::path &value) {
+        directory = value;
+        decompilerCache.setDirectory(directory);
+    }
+
+    uint64_t RenderPipelineCache::getStableHash(const RenderPipelineDesc &desc) {
+        StableHash hash;
+        hash.add(static_cast<uint64_t>(desc.shaders.size()));
+        for (auto &pair: desc.shaders) {
+            hash.add(pair.first);
+            hash.add(pair.second.getEnvironment());
+            hash.add(pair.second.getStage());
+            hash.add(pair.second.getEntryPoint());
+            hash.add(pair.second.getBlob());
+        }
+
+        hash.add(static_cast<uint64_t>(desc.bindings.size()));
+        for (auto &binding: desc.bindings) {
+            hash.add(binding);
+        }
+
+        hash.add(desc.primitive);
+        hashLayout(hash, desc.vertexLayout);
+        hashLayout(hash, desc.instanceArrayLayout);
+
+        hash.add(desc.multiSample);
+        hash.add(desc.multiSampleEnableFrequency);
+        hash.add(desc.multiSampleFrequency);
+        hash.add(desc.enableDepthTest);
+        hash.add(desc.depthTestWrite);
+        hash.add(desc.depthTestMode);
+        hash.add(desc.enableStencilTest);
+        hash.add(desc.stencilTestMask);
+        hash.add(desc.stencilMode);
+        hash.add(desc.stencilReference);
+        hash.add(desc.stencilFunctionMask);
+        hash.add(desc.stencilFail);
+        hash.add(desc.stencilDepthFail);
+        hash.add(desc.stencilPass);
+        hash.add(desc.enableFaceCulling);
+        hash.add(desc.faceCullMode);
+        hash.add(desc.faceCullClockwiseWinding);
+        hash.add(desc.enableBlending);
+        hash.add(desc.colorBlendSourceMode);
+        hash.add(desc.colorBlendDestinationMode);
+        hash.add(desc.alphaBlendSourceMode);
+        hash.add(desc.alphaBlendDestinationMode);
+        hash.add(desc.colorBlendEquation);
+        hash.add(desc.alphaBlendEquation);
+        return hash.get();
+    }
+
+    std::unique_ptr<RenderPipeline> RenderPipelineCache::create(const RenderPipelineDesc &desc,
+                                                                uint64_t key,
+                                                                bool persistent) {
+        if (directory.empty() || !persistent) {
+            return device.createRenderPipeline(desc, decompilerCache);
+        }
+
+        std::stringstream name;
+        name << std::hex << std::setw(16) << std::setfill('0') << key
+             << "_" << std::setw(16) << std::setfill('0') << deviceHash << ".pipeline";
+        auto path = directory / name.str();
+
+        std::ifstream input(path, std::ios::binary);
+        if (input) {
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+            if (!data.empty()) {
+                return device.createRenderPipeline(desc, data, decompilerCache);
+            }
+        }
+
+        auto ret = device.createRenderPipeline(desc, decompilerCache);
+
+        auto data = ret->cache();
+        if (!data.empty()) {
+            auto tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream output(tmp, std::ios::binary);
+                output.write(reinterpret_cast<const char *>(data.data()), static_cast<std::streamsize>(data.size()));
+            }
+            std::error_code error;
+            std::filesystem::rename(tmp, path, error);
+        }
+
+        return ret;
+    }
+}
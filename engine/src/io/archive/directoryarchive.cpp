@@ -22,6 +22,8 @@
 
 #include "xng/io/archive/directoryarchive.hpp"
 
+#include "io/mappedfile.hpp"
+
 namespace xng {
     DirectoryArchive::DirectoryArchive(std::filesystem::path directory, bool readOnly)
             : directory(std::move(directory)),
@@ -50,6 +52,11 @@ namespace xng {
         return std::move(ret);
     }
 
+    ReadBuffer DirectoryArchive::openBuffer(const std::string &path) {
+        auto file = std::make_shared<MappedFile>(getAbsolutePath(path));
+        return {file->data(), file->size(), file};
+    }
+
     std::unique_ptr<std::iostream> DirectoryArchive::openRW(const std::string &path) {
         if (readOnly)
             throw std::runtime_error("Attempted to open RW on read only directory archive.");
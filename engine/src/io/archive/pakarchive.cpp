@@ -20,7 +20,6 @@
 #include "xng/io/archive/pakarchive.hpp"
 
 #include <filesystem>
-#include <sstream>
 #include <utility>
 
 namespace xng {
@@ -33,11 +32,11 @@ namespace xng {
     }
 
     std::unique_ptr<std::istream> PakArchive::open(const std::string &path) {
-        std::lock_guard<std::mutex> guard(mutex);
-        auto data = pak.get(path, verifyHashes);
-        auto ret = std::make_unique<std::stringstream>(std::string(data.begin(), data.end()));
-        std::noskipws(*ret);
-        return std::move(ret);
+        return std::make_unique<ReadBufferStream>(openBuffer(path));
+    }
+
+    ReadBuffer PakArchive::openBuffer(const std::string &path) {
+        return pak.getBuffer(path, verifyHashes);
     }
 
     std::unique_ptr<std::iostream> PakArchive::openRW(const std::string &name) {
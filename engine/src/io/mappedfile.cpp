@@ -0,0 +1,133 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/mappedfile.hpp"
+
+#include <stdexcept>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fstream>
+#endif
+#endif
+
+namespace xng {
+#ifdef __linux__
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Failed to open file " + path.string());
+        }
+
+        struct stat st{};
+        if (fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("Failed to stat file " + path.string());
+        }
+
+        length = static_cast<size_t>(st.st_size);
+        if (length > 0) {
+            void *mapping = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapping == MAP_FAILED) {
+                ::close(fd);
+                throw std::runtime_error("Failed to map file " + path.string());
+            }
+            // Importers read the whole file front to back
+            madvise(mapping, length, MADV_SEQUENTIAL);
+            ptr = static_cast<const uint8_t *>(mapping);
+        }
+
+        // The mapping stays valid after closing the descriptor
+        ::close(fd);
+    }
+
+    MappedFile::~MappedFile() {
+        if (ptr != nullptr) {
+            munmap(const_cast<uint8_t *>(ptr), length);
+        }
+    }
+#else
+#ifdef _WIN32
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        fileHandle = CreateFileW(path.c_str(),
+                                 GENERIC_READ,
+                                 FILE_SHARE_READ,
+                                 nullptr,
+                                 OPEN_EXISTING,
+                                 FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+                                 nullptr);
+        if (fileHandle == INVALID_HANDLE_VALUE) {
+            fileHandle = nullptr;
+            throw std::runtime_error("Failed to open file " + path.string());
+        }
+
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(fileHandle, &fileSize)) {
+            CloseHandle(fileHandle);
+            throw std::runtime_error("Failed to get file size " + path.string());
+        }
+
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0) {
+            mappingHandle = CreateFileMappingW(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mappingHandle == nullptr) {
+                CloseHandle(fileHandle);
+                throw std::runtime_error("Failed to map file " + path.string());
+            }
+            ptr = static_cast<const uint8_t *>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            if (ptr == nullptr) {
+                CloseHandle(mappingHandle);
+                CloseHandle(fileHandle);
+                throw std::runtime_error("Failed to map file " + path.string());
+            }
+        }
+    }
+
+    MappedFile::~MappedFile() {
+        if (ptr != nullptr)
+            UnmapViewOfFile(ptr);
+        if (mappingHandle != nullptr)
+            CloseHandle(mappingHandle);
+        if (fileHandle != nullptr)
+            CloseHandle(fileHandle);
+    }
+#else
+    MappedFile::MappedFile(const std::filesystem::path &path) {
+        std::ifstream stream(path, std::ios_base::in | std::ios_base::binary | std::ios_base::ate);
+        if (!stream) {
+            throw std::runtime_error("Failed to open file " + path.string());
+        }
+        fallback.resize(static_cast<size_t>(stream.tellg()));
+        stream.seekg(0);
+        stream.read(reinterpret_cast<char *>(fallback.data()), static_cast<std::streamsize>(fallback.size()));
+        ptr = fallback.data();
+        length = fallback.size();
+    }
+
+    MappedFile::~MappedFile() = default;
+#endif
+#endif
+}
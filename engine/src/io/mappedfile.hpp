@@ -0,0 +1,59 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_MAPPEDFILE_HPP
+#define XENGINE_MAPPEDFILE_HPP
+
+#include <filesystem>
+#include <cstdint>
+#include <vector>
+
+namespace xng {
+    /**
+     * A read only memory mapping of a file.
+     *
+     * On platforms without memory mapping support the file contents are read into heap memory.
+     */
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::filesystem::path &path);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile &other) = delete;
+
+        MappedFile &operator=(const MappedFile &other) = delete;
+
+        const uint8_t *data() const { return ptr; }
+
+        size_t size() const { return length; }
+
+    private:
+        const uint8_t *ptr = nullptr;
+        size_t length = 0;
+#ifdef _WIN32
+        void *fileHandle = nullptr;
+        void *mappingHandle = nullptr;
+#elif !defined(__linux__)
+        std::vector<uint8_t> fallback;
+#endif
+    };
+}
+
+#endif //XENGINE_MAPPEDFILE_HPP
@@ -21,6 +21,12 @@
 
 #include <utility>
 #include <filesystem>
+#include <algorithm>
+#include <limits>
+#include <cstring>
+#include <cctype>
+#include <atomic>
+#include <condition_variable>
 
 #include "thirdparty/json.hpp"
 #include "thirdparty/base64.hpp"
@@ -28,19 +34,133 @@
 #include "xng/io/readfile.hpp"
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
+#include "xng/async/threadpool.hpp"
+
+#include "io/pakcodec.hpp"
+#include "io/pakheader.hpp"
 
 namespace xng {
-    Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams, GZip &gzip, SHA &sha)
-            : streams(std::move(streams)), gzip(&gzip), sha(&sha) {
+    static const size_t PARALLEL_DECODE_MIN_BLOCKS = 8;
+
+    /**
+     * Decode the blocks of a framed entry into output.
+     *
+     * Large entries are decoded in parallel on the thread pool. The calling thread claims blocks too
+     * and only waits for blocks that are being decoded, so this does not deadlock when called from a pool task.
+     */
+    static void decodeBlocks(Pak::Codec codec, GZip *gzip, const PakFrame &frame, const ReadBuffer &data, char *output) {
+        auto count = frame.getBlockCount();
+        auto helpers = std::min(static_cast<size_t>(std::max(std::thread::hardware_concurrency(), 1u)), count) - 1;
+
+        if (count < PARALLEL_DECODE_MIN_BLOCKS || helpers == 0) {
+            for (size_t i = 0; i < count; i++) {
+                decodePakBlock(codec, gzip, frame, data, i, output + i * frame.blockSize);
+            }
+            return;
+        }
+
+        struct State {
+            std::atomic<size_t> next = 0;
+            size_t done = 0;
+            std::exception_ptr exception;
+            std::mutex mutex;
+            std::condition_variable condition;
+        };
+
+        auto state = std::make_shared<State>();
+
+        // Helpers which start after all blocks were claimed return without touching the captured references
+        auto work = [state, count, codec, gzip, &frame, &data, output]() {
+            size_t index;
+            while ((index = state->next++) < count) {
+                std::exception_ptr exception;
+                try {
+                    decodePakBlock(codec, gzip, frame, data, index, output + index * frame.blockSize);
+                } catch (...) {
+                    exception = std::current_exception();
+                }
+                std::lock_guard<std::mutex> guard(state->mutex);
+                if (exception)
+                    state->exception = exception;
+                if (++state->done == count)
+                    state->condition.notify_all();
+            }
+        };
+
+        for (size_t i = 0; i < helpers; i++) {
+            ThreadPool::getPool().addTask(work);
+        }
+
+        work();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->condition.wait(lock, [&]() { return state->done == count; });
+
+        if (state->exception)
+            std::rethrow_exception(state->exception);
+    }
+
+    /**
+     * Decompresses the blocks of a framed entry while reading.
+     */
+    class PakBlockStreamBuf : public std::streambuf {
+    public:
+        PakBlockStreamBuf(Pak::Codec codec, GZip *gzip, ReadBuffer data)
+                : codec(codec), gzip(gzip), data(std::move(data)), frame(readPakFrame(this->data)) {}
+
+    protected:
+        int_type underflow() override {
+            if (gptr() < egptr())
+                return traits_type::to_int_type(*gptr());
+            if (block >= frame.getBlockCount())
+                return traits_type::eof();
+            buffer.resize(frame.getBlockSize(block));
+            decodePakBlock(codec, gzip, frame, data, block++, buffer.data());
+            setg(buffer.data(), buffer.data(), buffer.data() + buffer.size());
+            return traits_type::to_int_type(*gptr());
+        }
+
+    private:
+        Pak::Codec codec;
+        GZip *gzip;
+        ReadBuffer data;
+        PakFrame frame;
+        size_t block = 0;
+        std::vector<char> buffer;
+    };
+
+    class PakBlockStream : public std::istream {
+    public:
+        PakBlockStream(Pak::Codec codec, GZip *gzip, ReadBuffer data)
+                : std::istream(nullptr), streamBuf(codec, gzip, std::move(data)) {
+            rdbuf(&streamBuf);
+            std::noskipws(*this);
+        }
+
+    private:
+        PakBlockStreamBuf streamBuf;
+    };
+
+    static std::vector<std::shared_ptr<RandomAccessReader>> createReaders(
+            const std::vector<std::reference_wrapper<std::istream>> &streams) {
+        std::vector<std::shared_ptr<RandomAccessReader>> ret;
+        for (auto &stream: streams) {
+            ret.emplace_back(RandomAccessReader::fromStream(stream));
+        }
+        return ret;
+    }
+
+    Pak::Pak(std::vector<std::shared_ptr<RandomAccessReader>> chunks, GZip &gzip, SHA &sha)
+            : chunks(std::move(chunks)), gzip(&gzip), sha(&sha) {
         loadHeader();
     }
 
-    Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams,
+    Pak::Pak(std::vector<std::shared_ptr<RandomAccessReader>> chunks,
              GZip &gzip,
              SHA &sha,
              AES &aes,
              AES::Key key)
-            : streams(std::move(streams)),
+            : chunks(std::move(chunks)),
               key(std::move(key)),
               gzip(&gzip),
               sha(&sha),
@@ -48,149 +168,217 @@ namespace xng {
         loadHeader();
     }
 
-    std::vector<char> Pak::get(const std::string &path, bool verifyHash) {
-        std::vector<char> ret;
-        auto hEntry = entries.at(path);
+    Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams, GZip &gzip, SHA &sha)
+            : Pak(createReaders(streams), gzip, sha) {}
 
-        if (chunkSize == 0) {
-            auto &stream = getStreamForOffset(hEntry.offset);
-            std::vector<char> tmp(hEntry.size);
-            stream.seekg(static_cast<std::streamoff>(hEntry.offset));
-            stream.read(tmp.data(), static_cast<std::streamoff>(hEntry.size));
-            if (stream.gcount() != hEntry.size)
-                throw std::runtime_error("Failed to read pak entry");
-            ret.insert(ret.begin(), tmp.begin(), tmp.end());
+    Pak::Pak(std::vector<std::reference_wrapper<std::istream>> streams,
+             GZip &gzip,
+             SHA &sha,
+             AES &aes,
+             AES::Key key)
+            : Pak(createReaders(streams), gzip, sha, aes, std::move(key)) {}
+
+    std::vector<char> Pak::get(const std::string &path, bool verifyHash) const {
+        auto hEntry = getEntry(path);
+        auto data = readData(hEntry.offset, hEntry.size);
+
+        std::vector<char> ret;
+        if (encrypted || hEntry.codec != CODEC_STORE) {
+            ret = decode(hEntry, data);
         } else {
-            auto beginOffset = hEntry.offset % chunkSize; // The offset into the first chunk stream
-            auto beginCount = chunkSize - beginOffset; // The number of bytes in the first chunk stream
+            ret.assign(data.chars(), data.chars() + data.size());
+        }
 
-            if (hEntry.size < beginCount) {
-                beginCount = hEntry.size;
-            }
+        if (verifyHash) {
+            verify(hEntry, ret.data(), ret.size());
+        }
 
-            auto remainingCount = static_cast<int>(hEntry.size - beginCount); // The number of remaining bytes
+        return ret;
+    }
 
-            auto remainChunks = remainingCount / chunkSize; // The number of full chunks that the remaining bytes fill
+    ReadBuffer Pak::getBuffer(const std::string &path, bool verifyHash) const {
+        auto hEntry = getEntry(path);
+        auto data = readData(hEntry.offset, hEntry.size);
 
-            auto lastCount = remainingCount %
-                             chunkSize; // The number of bytes in the last partial chunk stream. If the data size matches chunk size a "middle" chunk is the end.
+        if (encrypted || hEntry.codec != CODEC_STORE) {
+            auto decoded = std::make_shared<const std::vector<char>>(decode(hEntry, data));
+            data = ReadBuffer(reinterpret_cast<const uint8_t *>(decoded->data()), decoded->size(), decoded);
+        }
 
-            // Read first chunk
-            if (beginCount > 0) {
-                auto &firstStream = getStreamForOffset(hEntry.offset);
-                std::vector<char> tmp(beginCount);
-                firstStream.seekg(static_cast<std::streamoff>(beginOffset));
-                firstStream.read(tmp.data(), static_cast<std::streamoff>(beginCount));
-                if (firstStream.gcount() != beginCount)
-                    throw std::runtime_error("Failed to read pak entry");
-                ret.insert(ret.begin(), tmp.begin(), tmp.end());
-            }
+        if (verifyHash) {
+            verify(hEntry, data.chars(), data.size());
+        }
 
-            if (remainChunks > 0) {
-                //Read full chunks
-                for (int i = 0; i < remainChunks; i++) {
-                    std::vector<char> chunk(chunkSize);
-                    auto gOffset = hEntry.offset + beginCount + (i * chunkSize);
-                    auto &stream = getStreamForOffset(gOffset);
-                    stream.seekg(0);
-                    stream.read(chunk.data(), static_cast<std::streamoff>(chunk.size()));
-                    if (stream.gcount() != chunk.size())
-                        throw std::runtime_error("Failed to read pak chunk");
-                    ret.insert(ret.end(), chunk.begin(), chunk.end());
-                }
-            }
+        return data;
+    }
 
-            if (lastCount > 0) {
-                // Read last partial chunk
-                std::vector<char> lastChunk(lastCount);
-                auto gOffset = hEntry.offset + beginCount + (remainChunks * chunkSize);
-                auto &lastStream = getStreamForOffset(gOffset);
-                lastStream.seekg(0);
-                lastStream.read(lastChunk.data(), static_cast<std::streamoff>(lastChunk.size()));
-
-                if (lastStream.gcount() != lastChunk.size())
-                    throw std::runtime_error("Failed to read pak chunk");
-
-                ret.insert(ret.begin()
-                           + static_cast<std::streamoff>(beginCount)
-                           + static_cast<std::streamoff>(remainChunks) * chunkSize,
-                           lastChunk.begin(),
-                           lastChunk.end());
-            }
+    std::unique_ptr<std::istream> Pak::stream(const std::string &path) const {
+        auto hEntry = getEntry(path);
+        if (!hEntry.framed) {
+            return std::make_unique<ReadBufferStream>(getBuffer(path, false));
+        }
+        return std::make_unique<PakBlockStream>(hEntry.codec, gzip, decrypt(readData(hEntry.offset, hEntry.size)));
+    }
+
+    ReadBuffer Pak::readData(size_t offset, size_t size) const {
+        if (size == 0)
+            return {};
+
+        if (chunkSize == 0) {
+            auto ret = chunks.at(0)->view(offset, size);
+            if (ret.size() != size)
+                throw std::runtime_error("Failed to read pak entry");
+            return ret;
         }
 
-        if (encrypted) {
-            ret = aes->decrypt(key, iv, ret);
+        auto chunkIndex = offset / chunkSize;
+        auto chunkOffset = offset % chunkSize;
+
+        if (chunkOffset + size <= chunkSize) {
+            // The data is contained in a single chunk
+            auto ret = chunks.at(chunkIndex)->view(chunkOffset, size);
+            if (ret.size() != size)
+                throw std::runtime_error("Failed to read pak chunk");
+            return ret;
         }
 
-        if (compressed) {
-            ret = gzip->decompress(ret);
+        std::vector<uint8_t> ret(size);
+        size_t count = 0;
+        while (count < size) {
+            auto n = std::min(size - count, chunkSize - chunkOffset);
+            if (chunks.at(chunkIndex)->read(chunkOffset, ret.data() + count, n) != n)
+                throw std::runtime_error("Failed to read pak chunk");
+            count += n;
+            chunkIndex++;
+            chunkOffset = 0;
         }
+        return ReadBuffer(std::move(ret));
+    }
 
-        if (verifyHash) {
-            auto hash = sha->sha256(ret);
-            if (hEntry.hash != hash) {
-                throw std::runtime_error("Pak entry data hash mismatch");
+    ReadBuffer Pak::decrypt(const ReadBuffer &data) const {
+        if (!encrypted)
+            return data;
+        auto decrypted = std::make_shared<const std::vector<char>>(
+                aes->decrypt(key, iv, std::vector<char>(data.chars(), data.chars() + data.size())));
+        return {reinterpret_cast<const uint8_t *>(decrypted->data()), decrypted->size(), decrypted};
+    }
+
+    std::vector<char> Pak::decode(const HeaderEntry &entry, const ReadBuffer &data) const {
+        auto plain = decrypt(data);
+        if (entry.codec == CODEC_STORE) {
+            return {plain.chars(), plain.chars() + plain.size()};
+        } else if (!entry.framed) {
+            return gzip->decompress(plain.chars(), plain.size());
+        }
+
+        auto frame = readPakFrame(plain);
+        std::vector<char> ret(frame.size);
+        decodeBlocks(entry.codec, gzip, frame, plain, ret.data());
+        return ret;
+    }
+
+    void Pak::verify(const HeaderEntry &entry, const char *data, size_t size) const {
+        // Binary headers store the hash as bytes, the hex case of the sha implementation is not preserved
+        auto hash = sha->sha256(data, size);
+        if (!std::equal(entry.hash.begin(), entry.hash.end(), hash.begin(), hash.end(), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        })) {
+            throw std::runtime_error("Pak entry data hash mismatch");
+        }
+    }
+
+    bool Pak::exists(const std::string &path) const {
+        HeaderEntry entry;
+        return findEntry(path, entry);
+    }
+
+    const std::map<std::string, Pak::HeaderEntry> &Pak::getEntries() const {
+        std::lock_guard<std::mutex> guard(*entriesMutex);
+        if (!entriesLoaded) {
+            for (size_t i = 0; i < binaryHeader->getEntryCount(); i++) {
+                auto entry = binaryHeader->getEntry(i);
+                entry.offset += dataBegin;
+                entries[std::string(binaryHeader->getPath(i))] = entry;
             }
+            entriesLoaded = true;
+        }
+        return entries;
+    }
+
+    bool Pak::findEntry(const std::string &path, HeaderEntry &entry) const {
+        if (binaryHeader) {
+            auto index = binaryHeader->find(path);
+            if (index == binaryHeader->getEntryCount())
+                return false;
+            entry = binaryHeader->getEntry(index);
+            entry.offset += dataBegin;
+            return true;
+        } else {
+            auto it = entries.find(path);
+            if (it == entries.end())
+                return false;
+            entry = it->second;
+            return true;
         }
+    }
 
+    Pak::HeaderEntry Pak::getEntry(const std::string &path) const {
+        HeaderEntry ret;
+        if (!findEntry(path, ret))
+            throw std::runtime_error("Pak entry not found: " + path);
         return ret;
     }
 
     void Pak::loadHeader() {
-        size_t dataBegin{};
-        std::string headerStr{};
-        std::string headerSizeStr{};
-        size_t headerSize{};
-        int scope = -1;
-        char c;
-        int streamIndex = 0;
-        auto calChunkSize = 0;
-        for (auto i = 0; i < std::numeric_limits<size_t>::max(); i++) {
-            auto &s = streams.at(streamIndex).get();
-            auto offset = i - ((calChunkSize) * streamIndex);
-
-            s.seekg(static_cast<std::streamoff>(offset));
-            s.read(&c, 1);
-
-            if (s.eof()) {
-                if (streams.size() < streamIndex + 1) {
+        if (chunks.empty())
+            throw std::runtime_error("Failed to load header (No chunks)");
+
+        // Until the header is parsed the chunk size is derived from the size of the first chunk
+        chunkSize = chunks.size() > 1 ? chunks.at(0)->size() : 0;
+
+        size_t totalSize = 0;
+        for (auto &chunk: chunks) {
+            totalSize += chunk->size();
+        }
+
+        if (totalSize >= PAK_BINARY_HEADER_SIZE) {
+            auto fixedHeader = readData(0, PAK_BINARY_HEADER_SIZE);
+            if (std::memcmp(fixedHeader.data(), PAK_BINARY_HEADER_MAGIC.data(), PAK_BINARY_HEADER_MAGIC.size()) == 0) {
+                auto headerSize = PakBinaryHeader::readHeaderSize(fixedHeader);
+                if (headerSize > totalSize)
                     throw std::runtime_error("Failed to load header (End of file)");
-                }
+                // The header is used in place if the chunk is memory resident
+                binaryHeader = std::make_shared<const PakBinaryHeader>(readData(0, headerSize));
+                chunkSize = binaryHeader->getChunkSize();
+                dataBegin = headerSize;
+                return;
+            }
+        }
 
-                if (calChunkSize == 0)
-                    calChunkSize = i;
+        entriesLoaded = true;
 
-                streamIndex++;
+        // Magic, \xa7, decimal header size, \xa7
+        auto prefixSize = std::min(totalSize, PAK_HEADER_MAGIC.size() + std::numeric_limits<size_t>::digits10 + 3);
+        auto prefix = readData(0, prefixSize);
+        auto prefixStr = std::string(prefix.chars(), prefix.size());
 
-                offset = i - ((calChunkSize) * streamIndex);
+        if (prefixStr.find(PAK_HEADER_MAGIC) != 0)
+            throw std::runtime_error("Failed to load header (Invalid magic)");
 
-                auto &tmp = streams.at(streamIndex).get();
-                tmp.seekg(static_cast<std::streamoff>(offset));
-                tmp.read(&c, 1);
-            } else if (s.gcount() == 0) {
-                throw std::runtime_error("Failed to load header (End of file gcount)");
-            }
+        auto sizeBegin = PAK_HEADER_MAGIC.size();
+        auto sizeEnd = prefixStr.find('\xa7', sizeBegin + 1);
+        if (prefixStr.size() <= sizeBegin || prefixStr.at(sizeBegin) != '\xa7' || sizeEnd == std::string::npos)
+            throw std::runtime_error("Failed to load header (End of file)");
 
-            if (i < PAK_HEADER_MAGIC.size())
-                continue;
+        size_t headerSize = std::stoul(prefixStr.substr(sizeBegin + 1, sizeEnd - sizeBegin - 1));
+        size_t headerBegin = sizeEnd + 1;
+        dataBegin = headerBegin + headerSize;
 
-            if (c == '\xa7' && scope != 2) {
-                if (scope == -1) {
-                    scope = 1;
-                } else {
-                    headerSize = std::stoul(headerSizeStr);
-                    dataBegin = i + 1 + headerSize;
-                    scope = 2;
-                }
-            } else if (scope == 1) {
-                headerSizeStr += c;
-            } else if (scope == 2) {
-                headerStr += c;
-                if (headerStr.size() == headerSize)
-                    break;
-            }
-        }
+        if (dataBegin > totalSize)
+            throw std::runtime_error("Failed to load header (End of file)");
+
+        auto header = readData(headerBegin, headerSize);
+        auto headerStr = std::string(header.chars(), header.size());
 
         auto headerJson = nlohmann::json::from_bson(headerStr);
         if (headerJson.contains("edata")) {
@@ -226,26 +414,12 @@ namespace xng {
             size_t offset = entry["offset"];
             size_t size = entry["size"];
             std::string hash = entry["hash"];
-            entries[path] = {dataBegin + offset, size, hash};
-        }
-    }
-
-    size_t Pak::getRelativeOffset(size_t globalOffset) {
-        if (chunkSize <= 0)
-            return globalOffset;
-
-        if (globalOffset < chunkSize) {
-            return globalOffset;
-        } else {
-            auto rChunk = globalOffset % chunkSize; // The relative offset ( Remainder )
-            return rChunk;
+            Codec codec = compressed ? CODEC_GZIP : CODEC_STORE;
+            bool framed = entry.contains("codec");
+            if (framed) {
+                codec = static_cast<Codec>(entry["codec"].get<int>());
+            }
+            entries[path] = {dataBegin + offset, size, hash, codec, framed && codec != CODEC_STORE};
         }
     }
-
-    std::istream &Pak::getStreamForOffset(size_t globalOffset) {
-        if (chunkSize <= 0)
-            return streams.at(0);
-        auto nChunk = globalOffset / chunkSize;
-        return streams.at(nChunk);
-    }
-}
\ No newline at end of file
+}
@@ -19,60 +19,127 @@
 
 #include "xng/io/pakbuilder.hpp"
 
+#include <fstream>
+#include <sstream>
+#include <deque>
+#include <atomic>
+
 #include "thirdparty/json.hpp"
 #include "thirdparty/base64.hpp"
 #include "xng/crypto/gzip.hpp"
 #include "xng/crypto/sha.hpp"
+#include "xng/async/threadpool.hpp"
+
+#include "io/pakcodec.hpp"
+#include "io/pakheader.hpp"
 
 namespace xng {
-    void PakBuilder::addEntry(const std::string &name, const std::vector<char> &buffer) {
-        if (entries.find(name) != entries.end())
-            throw std::runtime_error("Entry with name " + name + " already exists");
-        entries[name] = buffer;
-    }
+    static const size_t MAX_HEADER_VALUE = 1ull << 62; // Used in place of offsets and sizes when reserving the header space
 
-    std::vector<std::vector<char>> PakBuilder::build(size_t chunkSize,
-                                                     bool compressData,
-                                                     bool encryptData,
-                                                     SHA &sha,
-                                                     GZip &zip,
-                                                     AES &aes,
-                                                     const AES::Key &key,
-                                                     const AES::InitializationVector &iv) {
-        std::vector<char> data;
-        size_t currentOffset = 0;
+    /**
+     * Writes to the chunk streams at global offsets.
+     */
+    class ChunkWriter {
+    public:
+        ChunkWriter(size_t chunkSize, const std::function<std::ostream &(size_t)> &createChunk)
+                : chunkSize(chunkSize), createChunk(createChunk) {}
 
-        std::map<std::string, Pak::HeaderEntry> headerEntries;
-        for (auto &pair: entries) {
-            auto d = pair.second;
-
-            if (compressData) {
-                d = zip.compress(d);
+        void write(const char *data, size_t size) {
+            while (size > 0) {
+                if (chunks.empty() || (chunkSize > 0 && position == chunks.size() * chunkSize)) {
+                    chunks.emplace_back(&createChunk(chunks.size()));
+                }
+                auto count = chunkSize == 0 ? size : std::min(size, chunkSize - position % chunkSize);
+                chunks.back()->write(data, static_cast<std::streamsize>(count));
+                if (!*chunks.back())
+                    throw std::runtime_error("Failed to write pak chunk");
+                position += count;
+                data += count;
+                size -= count;
             }
+        }
 
-            if (encryptData) {
-                d = aes.encrypt(key, iv, d);
+        void write(const std::vector<char> &data) {
+            write(data.data(), data.size());
+        }
+
+        void writeZeros(size_t size) {
+            std::vector<char> zeros(std::min<size_t>(size, 64 * 1024), 0);
+            while (size > 0) {
+                auto count = std::min(size, zeros.size());
+                write(zeros.data(), count);
+                size -= count;
             }
+        }
 
-            headerEntries[pair.first].offset = currentOffset;
-            headerEntries[pair.first].size = d.size();
-            headerEntries[pair.first].hash = sha.sha256(pair.second);
+        /**
+         * Overwrite previously written data.
+         */
+        void writeAt(size_t offset, const char *data, size_t size) {
+            while (size > 0) {
+                auto index = chunkSize == 0 ? 0 : offset / chunkSize;
+                auto local = chunkSize == 0 ? offset : offset % chunkSize;
+                auto count = chunkSize == 0 ? size : std::min(size, chunkSize - local);
+                auto &stream = *chunks.at(index);
+                auto end = stream.tellp();
+                stream.seekp(static_cast<std::streamoff>(local));
+                stream.write(data, static_cast<std::streamsize>(count));
+                stream.seekp(end);
+                if (!stream)
+                    throw std::runtime_error("Failed to write pak chunk");
+                offset += count;
+                data += count;
+                size -= count;
+            }
+        }
 
-            currentOffset += d.size();
+        void flush() {
+            for (auto *chunk: chunks) {
+                chunk->flush();
+            }
+        }
 
-            data.insert(data.end(), d.begin(), d.end());
+        size_t tell() const {
+            return position;
         }
 
+    private:
+        size_t chunkSize;
+        const std::function<std::ostream &(size_t)> &createChunk;
+        std::vector<std::ostream *> chunks;
+        size_t position = 0;
+    };
+
+    static nlohmann::json createHeader(size_t chunkSize,
+                                       bool compressData,
+                                       const std::map<std::string, Pak::HeaderEntry> &headerEntries,
+                                       const std::string &padding) {
         nlohmann::json headerJson;
         headerJson["chunkSize"] = chunkSize;
         headerJson["compressed"] = compressData;
+        headerJson["padding"] = padding;
         for (auto &pair: headerEntries) {
             auto &element = headerJson["entries"][pair.first];
             element["offset"] = pair.second.offset;
             element["size"] = pair.second.size;
             element["hash"] = pair.second.hash;
+            element["codec"] = static_cast<int>(pair.second.codec);
         }
+        return headerJson;
+    }
 
+    /**
+     * @return The size of the header before encryption
+     */
+    static size_t getHeaderSize(const nlohmann::json &headerJson, bool encryptData) {
+        return encryptData ? headerJson.dump().size() : nlohmann::json::to_bson(headerJson).size();
+    }
+
+    static std::string serializeHeader(const nlohmann::json &headerJson,
+                                       bool encryptData,
+                                       AES &aes,
+                                       const AES::Key &key,
+                                       const AES::InitializationVector &iv) {
         auto headerStr = headerJson.dump();
 
         if (encryptData) {
@@ -89,39 +156,352 @@ namespace xng {
 
         auto outHeader = nlohmann::json::to_bson(outHeaderJson);
 
-        auto outHeaderStr = std::string(outHeader.begin(), outHeader.end());
+        return {outHeader.begin(), outHeader.end()};
+    }
+
+    PakBuilder::PakBuilder(size_t blockSize)
+            : blockSize(blockSize) {
+        if (blockSize == 0)
+            throw std::runtime_error("Invalid block size");
+    }
+
+    void PakBuilder::addEntry(const std::string &name, const std::vector<char> &buffer) {
+        if (entries.find(name) != entries.end())
+            throw std::runtime_error("Entry with name " + name + " already exists");
+        entries[name] = {buffer, {}, true, Pak::CODEC_STORE};
+    }
+
+    void PakBuilder::addEntry(const std::string &name, const std::vector<char> &buffer, Pak::Codec codec) {
+        if (entries.find(name) != entries.end())
+            throw std::runtime_error("Entry with name " + name + " already exists");
+        entries[name] = {buffer, {}, false, codec};
+    }
+
+    void PakBuilder::addFile(const std::string &name, const std::filesystem::path &path) {
+        if (entries.find(name) != entries.end())
+            throw std::runtime_error("Entry with name " + name + " already exists");
+        entries[name] = {{}, path, true, Pak::CODEC_STORE};
+    }
+
+    void PakBuilder::addFile(const std::string &name, const std::filesystem::path &path, Pak::Codec codec) {
+        if (entries.find(name) != entries.end())
+            throw std::runtime_error("Entry with name " + name + " already exists");
+        entries[name] = {{}, path, false, codec};
+    }
+
+    std::vector<std::vector<char>> PakBuilder::build(size_t chunkSize,
+                                                     bool compressData,
+                                                     bool encryptData,
+                                                     SHA &sha,
+                                                     GZip &zip,
+                                                     AES &aes,
+                                                     const AES::Key &key,
+                                                     const AES::InitializationVector &iv) {
+        std::vector<std::unique_ptr<std::stringstream>> streams;
+        build([&](size_t) -> std::ostream & {
+                  streams.emplace_back(std::make_unique<std::stringstream>());
+                  return *streams.back();
+              },
+              chunkSize,
+              compressData,
+              encryptData,
+              sha,
+              zip,
+              aes,
+              key,
+              iv);
+
+        std::vector<std::vector<char>> ret;
+        for (auto &stream: streams) {
+            auto str = stream->str();
+            ret.emplace_back(str.begin(), str.end());
+        }
+        return ret;
+    }
 
-        auto hdr = PAK_HEADER_MAGIC + "\xa7" + std::to_string(outHeaderStr.size()) + "\xa7" + outHeaderStr;
+    void PakBuilder::build(const std::function<std::ostream &(size_t)> &createChunk,
+                           size_t chunkSize,
+                           bool compressData,
+                           bool encryptData,
+                           SHA &sha,
+                           GZip &zip,
+                           AES &aes,
+                           const AES::Key &key,
+                           const AES::InitializationVector &iv) {
+        struct EntryState {
+            const std::string *name;
+            const Entry *entry;
+            Pak::Codec codec; // The requested codec
+            size_t size;
+            size_t blockCount;
+            std::ifstream file;
+        };
 
-        if (chunkSize > 0) {
-            auto totalSize = hdr.size() + data.size();
-            auto totalWholeChunks = totalSize / chunkSize;
-            auto totalRemainder = totalSize % chunkSize;
+        /**
+         * A block of an entry, or a complete entry when encrypting.
+         *
+         * Items are processed by a pool task or by the writing thread, whichever claims the item first.
+         */
+        struct Item {
+            size_t entry;
+            size_t block;
+            std::vector<char> raw;
+            std::vector<char> encoded;
+            Pak::Codec codec; // The codec which was used for complete entries
+            std::string hash;
+            std::atomic<bool> claimed = false;
+            std::shared_ptr<Task> task;
+        };
 
-            auto totalChunks = totalWholeChunks;
-            if (totalRemainder != 0)
-                totalChunks += 1;
+        std::vector<EntryState> states;
+        states.reserve(entries.size());
+        for (auto &pair: entries) {
+            auto &entry = pair.second;
+            EntryState state;
+            state.name = &pair.first;
+            state.entry = &entry;
+            state.codec = entry.defaultCodec ? (compressData ? Pak::CODEC_GZIP : Pak::CODEC_STORE) : entry.codec;
+            state.size = entry.file.empty() ? entry.data.size() : std::filesystem::file_size(entry.file);
+            state.blockCount = (state.size + blockSize - 1) / blockSize;
+            states.emplace_back(std::move(state));
+        }
 
-            std::vector<std::vector<char>> ret(totalChunks);
+        // Reserve the space for the header, the final header is padded to the same size
+        std::map<std::string, Pak::HeaderEntry> headerEntries;
+        auto hashSize = sha.sha256(nullptr, 0).size();
+
+        // Unencrypted paks use the binary header which readers can use in place,
+        // the header of encrypted paks must be decrypted and therefore stays bson.
+        const bool binaryHeader = !encryptData;
+
+        std::string prefix;
+        size_t reservedHeaderSize = 0;
+        size_t headerSize;
+        if (binaryHeader) {
+            std::vector<std::string> paths;
+            paths.reserve(states.size());
+            for (auto &state: states) {
+                paths.emplace_back(*state.name);
+            }
+            headerSize = getPakBinaryHeaderSize(paths, hashSize / 2);
+        } else {
+            for (auto &state: states) {
+                headerEntries[*state.name] = {MAX_HEADER_VALUE,
+                                              MAX_HEADER_VALUE,
+                                              std::string(hashSize, '0'),
+                                              Pak::CODEC_LZ4};
+            }
+            auto reservedHeader = createHeader(chunkSize, compressData, headerEntries, "");
+            reservedHeaderSize = getHeaderSize(reservedHeader, encryptData);
+            headerSize = serializeHeader(reservedHeader, encryptData, aes, key, iv).size();
+            headerEntries.clear();
+            prefix = PAK_HEADER_MAGIC + "\xa7" + std::to_string(headerSize) + "\xa7";
+        }
 
-            size_t chunkIndex = 0;
-            for (auto i = 0; i < totalSize; i++) {
-                auto &chunk = ret.at(chunkIndex);
+        size_t dataBegin = prefix.size() + headerSize;
+
+        ChunkWriter writer(chunkSize, createChunk);
+        writer.write(prefix.data(), prefix.size());
+        writer.writeZeros(headerSize);
+
+        auto process = [&](Item &item) {
+            auto &state = states.at(item.entry);
+            if (encryptData) {
+                item.codec = state.codec;
+                item.encoded = aes.encrypt(key,
+                                           iv,
+                                           encodePakEntry(item.codec,
+                                                          &zip,
+                                                          item.raw.data(),
+                                                          item.raw.size(),
+                                                          blockSize));
+                item.hash = sha.sha256(item.raw);
+            } else if (state.codec != Pak::CODEC_STORE) {
+                item.encoded = encodePakBlock(state.codec, &zip, item.raw.data(), item.raw.size());
+            }
+        };
+
+        std::deque<std::shared_ptr<Item>> window;
+        const size_t maxItems = 4 * std::max(std::thread::hardware_concurrency(), 1u);
+
+        // The state of the entry currently being written
+        size_t entryBegin = 0;
+        bool entryDecided = false;
+        bool entryFramed = false;
+        std::vector<std::shared_ptr<Item>> pending;
+        std::vector<size_t> storedSizes;
+        std::unique_ptr<SHA::Hasher> hasher;
+
+        auto writeBlock = [&](const Item &item) {
+            hasher->update(item.raw.data(), item.raw.size());
+            if (entryFramed) {
+                writer.write(item.encoded);
+                storedSizes.emplace_back(item.encoded.size());
+            } else {
+                writer.write(item.raw);
+            }
+        };
+
+        auto write = [&](const std::shared_ptr<Item> &item) {
+            auto &state = states.at(item->entry);
+
+            if (encryptData) {
+                headerEntries[*state.name] = {writer.tell() - dataBegin, item->encoded.size(), item->hash, item->codec};
+                writer.write(item->encoded);
+                return;
+            }
+
+            if (item->block == 0) {
+                entryBegin = writer.tell();
+                entryDecided = state.codec == Pak::CODEC_STORE;
+                entryFramed = false;
+                storedSizes.clear();
+                hasher = sha.createSha256();
+            }
 
-                if (i < hdr.size()) {
-                    chunk.emplace_back(hdr.at(i));
+            auto last = item->block + 1 == state.blockCount;
+
+            if (entryDecided) {
+                writeBlock(*item);
+            } else {
+                // Like encodePakEntry the entry is framed if any block compresses.
+                // Blocks are held back until one compresses, which bounds the memory to maxItems blocks,
+                // so an entry whose first maxItems blocks do not compress is stored even if a later block would.
+                pending.emplace_back(item);
+                auto compressed = item->encoded.size() < item->raw.size();
+                if (!compressed && !last && pending.size() < maxItems) {
+                    return;
+                }
+
+                entryDecided = true;
+                entryFramed = compressed;
+                if (entryFramed) {
+                    // Written when the stored sizes of all blocks are known
+                    writer.writeZeros(encodePakFrameHeader(state.size,
+                                                           blockSize,
+                                                           std::vector<size_t>(state.blockCount)).size());
+                }
+                for (auto &block: pending) {
+                    writeBlock(*block);
+                }
+                pending.clear();
+            }
+
+            if (last) {
+                if (entryFramed) {
+                    auto frameHeader = encodePakFrameHeader(state.size, blockSize, storedSizes);
+                    writer.writeAt(entryBegin, frameHeader.data(), frameHeader.size());
+                }
+                headerEntries[*state.name] = {entryBegin - dataBegin,
+                                              writer.tell() - entryBegin,
+                                              hasher->final(),
+                                              entryFramed ? state.codec : Pak::CODEC_STORE};
+            }
+        };
+
+        auto complete = [&]() {
+            auto item = window.front();
+            window.pop_front();
+            if (!item->claimed.exchange(true)) {
+                process(*item);
+            } else {
+                auto exception = item->task->join();
+                if (exception)
+                    std::rethrow_exception(exception);
+            }
+            item->task = nullptr; // The task references the item
+            write(item);
+        };
+
+        auto submit = [&](std::shared_ptr<Item> item) {
+            item->task = ThreadPool::getPool().addTask([item, &process]() {
+                if (!item->claimed.exchange(true)) {
+                    process(*item);
+                }
+            });
+            window.emplace_back(std::move(item));
+            while (window.size() >= maxItems) {
+                complete();
+            }
+        };
+
+        try {
+            for (size_t i = 0; i < states.size(); i++) {
+                auto &state = states.at(i);
+
+                if (state.size == 0 && !encryptData) {
+                    headerEntries[*state.name] = {0, 0, sha.sha256(nullptr, 0), Pak::CODEC_STORE};
+                    continue;
+                }
+
+                if (!state.entry->file.empty()) {
+                    state.file = std::ifstream(state.entry->file, std::ios_base::in | std::ios::binary);
+                    if (!state.file)
+                        throw std::runtime_error("Failed to open file " + state.entry->file.string());
+                }
+
+                auto read = [&](size_t offset, size_t count) {
+                    std::vector<char> ret;
+                    if (state.entry->file.empty()) {
+                        ret.assign(state.entry->data.begin() + static_cast<std::ptrdiff_t>(offset),
+                                   state.entry->data.begin() + static_cast<std::ptrdiff_t>(offset + count));
+                    } else {
+                        ret.resize(count);
+                        state.file.read(ret.data(), static_cast<std::streamsize>(count));
+                        if (static_cast<size_t>(state.file.gcount()) != count)
+                            throw std::runtime_error("Failed to read file " + state.entry->file.string());
+                    }
+                    return ret;
+                };
+
+                if (encryptData) {
+                    auto item = std::make_shared<Item>();
+                    item->entry = i;
+                    item->block = 0;
+                    item->raw = read(0, state.size);
+                    submit(item);
                 } else {
-                    chunk.emplace_back(data.at(i - hdr.size()));
+                    for (size_t block = 0; block < state.blockCount; block++) {
+                        auto offset = block * blockSize;
+                        auto item = std::make_shared<Item>();
+                        item->entry = i;
+                        item->block = block;
+                        item->raw = read(offset, std::min(blockSize, state.size - offset));
+                        submit(item);
+                    }
                 }
 
-                if (chunk.size() == chunkSize)
-                    chunkIndex++;
+                state.file = {};
             }
 
-            return ret;
+            while (!window.empty()) {
+                complete();
+            }
+        } catch (...) {
+            // Wait for the items which are being processed, they reference the local state
+            for (auto &item: window) {
+                if (item->claimed.exchange(true)) {
+                    item->task->join();
+                }
+                item->task = nullptr;
+            }
+            throw;
+        }
+
+        std::string header;
+        if (binaryHeader) {
+            auto binary = encodePakBinaryHeader(chunkSize, hashSize / 2, headerEntries);
+            header = std::string(binary.begin(), binary.end());
         } else {
-            data.insert(data.begin(), hdr.begin(), hdr.end());
-            return {data};
+            auto headerJson = createHeader(chunkSize, compressData, headerEntries, "");
+            headerJson["padding"] = std::string(reservedHeaderSize - getHeaderSize(headerJson, encryptData), ' ');
+            header = serializeHeader(headerJson, encryptData, aes, key, iv);
         }
+
+        if (header.size() != headerSize)
+            throw std::runtime_error("Pak header size mismatch");
+
+        writer.writeAt(prefix.size(), header.data(), header.size());
+        writer.flush();
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,157 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/pakcodec.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "xng/crypto/lz4.hpp"
+
+namespace xng {
+    static const size_t FRAME_HEADER_SIZE = 16;
+
+    static void writeUInt(std::vector<char> &out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            out.emplace_back(static_cast<char>((value >> (i * 8)) & 0xFF));
+        }
+    }
+
+    static uint64_t readUInt(const uint8_t *data, size_t bytes) {
+        uint64_t ret = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            ret |= static_cast<uint64_t>(data[i]) << (i * 8);
+        }
+        return ret;
+    }
+
+    std::vector<char> encodePakBlock(Pak::Codec codec, GZip *gzip, const char *data, size_t size) {
+        std::vector<char> ret;
+        switch (codec) {
+            case Pak::CODEC_GZIP:
+                ret = gzip->compress(data, size);
+                break;
+            case Pak::CODEC_LZ4:
+                ret = LZ4::compress(data, size);
+                break;
+            default:
+                break;
+        }
+        if (codec == Pak::CODEC_STORE || ret.size() >= size) {
+            ret.assign(data, data + size);
+        }
+        return ret;
+    }
+
+    std::vector<char> encodePakFrameHeader(size_t size, size_t blockSize, const std::vector<size_t> &blockSizes) {
+        std::vector<char> ret;
+        ret.reserve(FRAME_HEADER_SIZE + blockSizes.size() * 4);
+        writeUInt(ret, size, 8);
+        writeUInt(ret, blockSize, 4);
+        writeUInt(ret, blockSizes.size(), 4);
+        for (auto blockSizeValue: blockSizes) {
+            writeUInt(ret, blockSizeValue, 4);
+        }
+        return ret;
+    }
+
+    std::vector<char> encodePakEntry(Pak::Codec &codec, GZip *gzip, const char *data, size_t size, size_t blockSize) {
+        if (codec == Pak::CODEC_STORE) {
+            return {data, data + size};
+        }
+
+        std::vector<std::vector<char>> blocks;
+        std::vector<size_t> blockSizes;
+        bool compressed = false;
+        for (size_t offset = 0; offset < size; offset += blockSize) {
+            auto count = std::min(blockSize, size - offset);
+            blocks.emplace_back(encodePakBlock(codec, gzip, data + offset, count));
+            blockSizes.emplace_back(blocks.back().size());
+            compressed = compressed || blocks.back().size() < count;
+        }
+
+        if (!compressed) {
+            codec = Pak::CODEC_STORE;
+            return {data, data + size};
+        }
+
+        auto ret = encodePakFrameHeader(size, blockSize, blockSizes);
+        for (auto &block: blocks) {
+            ret.insert(ret.end(), block.begin(), block.end());
+        }
+        return ret;
+    }
+
+    PakFrame readPakFrame(const ReadBuffer &data) {
+        if (data.size() < FRAME_HEADER_SIZE)
+            throw std::runtime_error("Invalid pak entry frame");
+
+        PakFrame ret;
+        ret.size = readUInt(data.data(), 8);
+        ret.blockSize = readUInt(data.data() + 8, 4);
+        auto blockCount = readUInt(data.data() + 12, 4);
+
+        if (ret.blockSize == 0
+            || blockCount != (ret.size + ret.blockSize - 1) / ret.blockSize
+            || data.size() < FRAME_HEADER_SIZE + blockCount * 4)
+            throw std::runtime_error("Invalid pak entry frame");
+
+        ret.offsets.resize(blockCount + 1);
+        ret.offsets[0] = FRAME_HEADER_SIZE + blockCount * 4;
+        for (size_t i = 0; i < blockCount; i++) {
+            ret.offsets[i + 1] = ret.offsets[i] + readUInt(data.data() + FRAME_HEADER_SIZE + i * 4, 4);
+        }
+
+        if (ret.offsets.back() > data.size())
+            throw std::runtime_error("Invalid pak entry frame");
+
+        return ret;
+    }
+
+    void decodePakBlock(Pak::Codec codec,
+                        GZip *gzip,
+                        const PakFrame &frame,
+                        const ReadBuffer &data,
+                        size_t index,
+                        char *output) {
+        auto *block = data.chars() + frame.offsets.at(index);
+        auto storedSize = frame.offsets.at(index + 1) - frame.offsets.at(index);
+        auto size = frame.getBlockSize(index);
+
+        if (storedSize == size) {
+            std::memcpy(output, block, size);
+            return;
+        }
+
+        switch (codec) {
+            case Pak::CODEC_GZIP: {
+                auto decompressed = gzip->decompress(block, storedSize);
+                if (decompressed.size() != size)
+                    throw std::runtime_error("Invalid pak entry block size");
+                std::memcpy(output, decompressed.data(), size);
+                break;
+            }
+            case Pak::CODEC_LZ4:
+                LZ4::decompress(block, storedSize, output, size);
+                break;
+            default:
+                throw std::runtime_error("Invalid pak entry codec");
+        }
+    }
+}
@@ -0,0 +1,89 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_PAKCODEC_HPP
+#define XENGINE_PAKCODEC_HPP
+
+#include "xng/io/pak.hpp"
+
+namespace xng {
+    /**
+     * The block framing of compressed pak entries (Little endian):
+     *
+     * uint64 Uncompressed size
+     * uint32 Uncompressed block size
+     * uint32 Block count
+     * uint32 Stored size of each block
+     * Block data
+     *
+     * Every block is compressed independently so that entries can be decompressed incrementally or in parallel.
+     * A block whose stored size equals its uncompressed size did not compress and is stored raw.
+     */
+    struct PakFrame {
+        size_t size = 0; // The uncompressed size of the entry
+        size_t blockSize = 0;
+        std::vector<size_t> offsets; // The offset of each block in the entry data, followed by the end offset
+
+        size_t getBlockCount() const {
+            return offsets.empty() ? 0 : offsets.size() - 1;
+        }
+
+        /**
+         * @param index
+         * @return The uncompressed size of the block
+         */
+        size_t getBlockSize(size_t index) const {
+            return std::min(blockSize, size - index * blockSize);
+        }
+    };
+
+    /**
+     * Compress a single block, the raw data is returned if the block does not compress.
+     */
+    std::vector<char> encodePakBlock(Pak::Codec codec, GZip *gzip, const char *data, size_t size);
+
+    /**
+     * Create the frame header for blocks with the given stored sizes.
+     */
+    std::vector<char> encodePakFrameHeader(size_t size, size_t blockSize, const std::vector<size_t> &blockSizes);
+
+    /**
+     * Encode the entry data with the given codec.
+     *
+     * If none of the blocks compress the codec is changed to CODEC_STORE and the raw data is returned.
+     *
+     * @param codec The requested codec, set to the codec which was used
+     * @return The encoded entry data
+     */
+    std::vector<char> encodePakEntry(Pak::Codec &codec, GZip *gzip, const char *data, size_t size, size_t blockSize);
+
+    PakFrame readPakFrame(const ReadBuffer &data);
+
+    /**
+     * Decompress the block at index into output, output must hold frame.getBlockSize(index) bytes.
+     */
+    void decodePakBlock(Pak::Codec codec,
+                        GZip *gzip,
+                        const PakFrame &frame,
+                        const ReadBuffer &data,
+                        size_t index,
+                        char *output);
+}
+
+#endif //XENGINE_PAKCODEC_HPP
@@ -0,0 +1,182 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "io/pakheader.hpp"
+
+#include <cstring>
+
+namespace xng {
+    static void writeUInt(char *out, uint64_t value, size_t bytes) {
+        for (size_t i = 0; i < bytes; i++) {
+            out[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+        }
+    }
+
+    static uint64_t readUInt(const uint8_t *data, size_t bytes) {
+        uint64_t ret = 0;
+        for (size_t i = 0; i < bytes; i++) {
+            ret |= static_cast<uint64_t>(data[i]) << (i * 8);
+        }
+        return ret;
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9')
+            return c - '0';
+        if (c >= 'a' && c <= 'f')
+            return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F')
+            return c - 'A' + 10;
+        throw std::runtime_error("Pak entry hash is not hex encoded");
+    }
+
+    size_t getPakBinaryHeaderSize(const std::vector<std::string> &paths, size_t hashSize) {
+        size_t ret = PAK_BINARY_HEADER_SIZE + paths.size() * (PAK_BINARY_RECORD_SIZE + hashSize);
+        for (auto &path: paths) {
+            ret += path.size();
+        }
+        return ret;
+    }
+
+    std::vector<char> encodePakBinaryHeader(size_t chunkSize,
+                                            size_t hashSize,
+                                            const std::map<std::string, Pak::HeaderEntry> &entries) {
+        std::vector<std::string> paths;
+        for (auto &pair: entries) {
+            paths.emplace_back(pair.first);
+        }
+
+        auto recordSize = PAK_BINARY_RECORD_SIZE + hashSize;
+        auto stringTableOffset = PAK_BINARY_HEADER_SIZE + entries.size() * recordSize;
+        auto headerSize = getPakBinaryHeaderSize(paths, hashSize);
+
+        std::vector<char> ret(headerSize, 0);
+        std::memcpy(ret.data(), PAK_BINARY_HEADER_MAGIC.data(), PAK_BINARY_HEADER_MAGIC.size());
+        writeUInt(ret.data() + 8, headerSize, 8);
+        writeUInt(ret.data() + 16, chunkSize, 8);
+        writeUInt(ret.data() + 24, entries.size(), 8);
+        writeUInt(ret.data() + 32, recordSize, 8);
+        writeUInt(ret.data() + 40, hashSize, 8);
+        writeUInt(ret.data() + 48, stringTableOffset, 8);
+        writeUInt(ret.data() + 56, headerSize - stringTableOffset, 8);
+
+        // std::map iterates in the same byte wise order used by the binary search
+        size_t index = 0;
+        size_t pathOffset = 0;
+        for (auto &pair: entries) {
+            auto &entry = pair.second;
+            auto *record = ret.data() + PAK_BINARY_HEADER_SIZE + index * recordSize;
+
+            if (entry.hash.size() != hashSize * 2)
+                throw std::runtime_error("Invalid pak entry hash size");
+
+            writeUInt(record, entry.offset, 8);
+            writeUInt(record + 8, entry.size, 8);
+            writeUInt(record + 16, pathOffset, 4);
+            writeUInt(record + 20, pair.first.size(), 4);
+            record[24] = static_cast<char>(entry.codec);
+            for (size_t i = 0; i < hashSize; i++) {
+                record[PAK_BINARY_RECORD_SIZE + i] = static_cast<char>((hexValue(entry.hash[i * 2]) << 4)
+                                                                       | hexValue(entry.hash[i * 2 + 1]));
+            }
+
+            std::memcpy(ret.data() + stringTableOffset + pathOffset, pair.first.data(), pair.first.size());
+
+            pathOffset += pair.first.size();
+            index++;
+        }
+
+        return ret;
+    }
+
+    PakBinaryHeader::PakBinaryHeader(ReadBuffer data)
+            : data(std::move(data)) {
+        auto *header = this->data.data();
+        if (this->data.size() < PAK_BINARY_HEADER_SIZE || readHeaderSize(this->data) != this->data.size())
+            throw std::runtime_error("Invalid pak header");
+
+        chunkSize = readUInt(header + 16, 8);
+        entryCount = readUInt(header + 24, 8);
+        recordSize = readUInt(header + 32, 8);
+        hashSize = readUInt(header + 40, 8);
+        stringTableOffset = readUInt(header + 48, 8);
+        stringTableSize = readUInt(header + 56, 8);
+
+        if (recordSize < PAK_BINARY_RECORD_SIZE + hashSize
+            || stringTableOffset < PAK_BINARY_HEADER_SIZE + entryCount * recordSize
+            || stringTableOffset + stringTableSize > this->data.size())
+            throw std::runtime_error("Invalid pak header");
+
+        for (size_t i = 0; i < entryCount; i++) {
+            auto *record = getRecord(i);
+            if (readUInt(record + 16, 4) + readUInt(record + 20, 4) > stringTableSize)
+                throw std::runtime_error("Invalid pak header");
+        }
+    }
+
+    size_t PakBinaryHeader::readHeaderSize(const ReadBuffer &fixedHeader) {
+        if (fixedHeader.size() < PAK_BINARY_HEADER_SIZE)
+            throw std::runtime_error("Invalid pak header");
+        return readUInt(fixedHeader.data() + 8, 8);
+    }
+
+    std::string_view PakBinaryHeader::getPath(size_t index) const {
+        auto *record = getRecord(index);
+        return {data.chars() + stringTableOffset + readUInt(record + 16, 4), readUInt(record + 20, 4)};
+    }
+
+    Pak::HeaderEntry PakBinaryHeader::getEntry(size_t index) const {
+        static const char *digits = "0123456789ABCDEF";
+
+        auto *record = getRecord(index);
+
+        Pak::HeaderEntry ret;
+        ret.offset = readUInt(record, 8);
+        ret.size = readUInt(record + 8, 8);
+        ret.codec = static_cast<Pak::Codec>(record[24]);
+        ret.framed = ret.codec != Pak::CODEC_STORE;
+        ret.hash.resize(hashSize * 2);
+        for (size_t i = 0; i < hashSize; i++) {
+            ret.hash[i * 2] = digits[record[PAK_BINARY_RECORD_SIZE + i] >> 4];
+            ret.hash[i * 2 + 1] = digits[record[PAK_BINARY_RECORD_SIZE + i] & 0xF];
+        }
+        return ret;
+    }
+
+    size_t PakBinaryHeader::find(std::string_view path) const {
+        size_t begin = 0;
+        size_t end = entryCount;
+        while (begin < end) {
+            auto middle = begin + (end - begin) / 2;
+            auto comparison = getPath(middle).compare(path);
+            if (comparison == 0) {
+                return middle;
+            } else if (comparison < 0) {
+                begin = middle + 1;
+            } else {
+                end = middle;
+            }
+        }
+        return entryCount;
+    }
+
+    const uint8_t *PakBinaryHeader::getRecord(size_t index) const {
+        return data.data() + PAK_BINARY_HEADER_SIZE + index * recordSize;
+    }
+}
@@ -0,0 +1,113 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_PAKHEADER_HPP
+#define XENGINE_PAKHEADER_HPP
+
+#include <string_view>
+
+#include "xng/io/pak.hpp"
+
+namespace xng {
+    /**
+     * The binary pak header (Little endian):
+     *
+     * char[8] PAK_BINARY_HEADER_MAGIC
+     * uint64 Header size, the entry data begins directly after the header
+     * uint64 Chunk size
+     * uint64 Entry count
+     * uint64 Record size
+     * uint64 Hash size
+     * uint64 String table offset
+     * uint64 String table size
+     * Record[Entry count] sorted by path
+     * String table
+     *
+     * Record:
+     * uint64 Offset relative to the data begin
+     * uint64 Size
+     * uint32 Path offset in the string table
+     * uint32 Path length
+     * uint8 Codec
+     * uint8[7] Reserved
+     * uint8[Hash size] Hash
+     *
+     * The header is used in place without parsing, entries are found by binary search over the records.
+     */
+    static const size_t PAK_BINARY_HEADER_SIZE = 64;
+    static const size_t PAK_BINARY_RECORD_SIZE = 32;
+
+    /**
+     * @return The size of the binary header for the given entry paths
+     */
+    size_t getPakBinaryHeaderSize(const std::vector<std::string> &paths, size_t hashSize);
+
+    /**
+     * @param entries The entries with offsets relative to the data begin and hex encoded hashes
+     */
+    std::vector<char> encodePakBinaryHeader(size_t chunkSize,
+                                            size_t hashSize,
+                                            const std::map<std::string, Pak::HeaderEntry> &entries);
+
+    /**
+     * A view of a binary pak header
+     */
+    class PakBinaryHeader {
+    public:
+        PakBinaryHeader() = default;
+
+        explicit PakBinaryHeader(ReadBuffer data);
+
+        /**
+         * Read the header size from the fixed size part of the header
+         */
+        static size_t readHeaderSize(const ReadBuffer &fixedHeader);
+
+        size_t getChunkSize() const { return chunkSize; }
+
+        size_t getEntryCount() const { return entryCount; }
+
+        std::string_view getPath(size_t index) const;
+
+        /**
+         * @param index
+         * @return The entry with the offset relative to the data begin
+         */
+        Pak::HeaderEntry getEntry(size_t index) const;
+
+        /**
+         * @param path
+         * @return The index of the entry or getEntryCount() if not found
+         */
+        size_t find(std::string_view path) const;
+
+    private:
+        const uint8_t *getRecord(size_t index) const;
+
+        ReadBuffer data;
+        size_t chunkSize = 0;
+        size_t entryCount = 0;
+        size_t recordSize = 0;
+        size_t hashSize = 0;
+        size_t stringTableOffset = 0;
+        size_t stringTableSize = 0;
+    };
+}
+
+#endif //XENGINE_PAKHEADER_HPP
@@ -0,0 +1,126 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/io/protocol/binaryprotocol.hpp"
+
+#include "xng/io/readbuffer.hpp"
+
+namespace xng {
+    static const size_t MAX_MESSAGE_DEPTH = 512;
+
+    static void writeMessage(BinaryWriter &writer, const Message &message) {
+        writer.writeUInt8(message.getType());
+        switch (message.getType()) {
+            case Message::NUL:
+                break;
+            case Message::SIGNED_INTEGER:
+                writer.writeInt(message.as<long long>());
+                break;
+            case Message::UNSIGNED_INTEGER:
+                writer.writeUInt(message.as<unsigned long long>());
+                break;
+            case Message::FLOAT:
+                writer.writeDouble(message.as<double>());
+                break;
+            case Message::STRING:
+                writer.writeString(message.as<std::string>());
+                break;
+            case Message::DICTIONARY:
+                writer.writeUInt(message.size());
+                message.forEachEntry([&writer](const std::string &key, const Message &value) {
+                    writer.writeKey(key);
+                    writeMessage(writer, value);
+                });
+                break;
+            case Message::LIST:
+                writer.writeUInt(message.size());
+                message.forEachElement([&writer](const Message &value) {
+                    writeMessage(writer, value);
+                });
+                break;
+            default:
+                throw std::runtime_error("Invalid message type");
+        }
+    }
+
+    static Message readMessage(BinaryReader &reader, size_t depth) {
+        if (depth > MAX_MESSAGE_DEPTH)
+            throw std::runtime_error("Binary message nesting too deep");
+        auto type = static_cast<Message::DataType>(reader.readUInt8());
+        switch (type) {
+            case Message::NUL:
+                return Message();
+            case Message::SIGNED_INTEGER:
+                return reader.readInt();
+            case Message::UNSIGNED_INTEGER:
+                return reader.readUInt();
+            case Message::FLOAT:
+                return reader.readDouble();
+            case Message::STRING:
+                return reader.readString();
+            case Message::DICTIONARY: {
+                auto count = reader.readUInt();
+                std::map<std::string, Message> dictionary;
+                for (size_t i = 0; i < count; i++) {
+                    auto &key = reader.readKey();
+                    dictionary[key] = readMessage(reader, depth + 1);
+                }
+                return dictionary;
+            }
+            case Message::LIST: {
+                auto count = reader.readUInt();
+                if (count > reader.remaining())
+                    throw std::runtime_error("Invalid binary message list size");
+                std::vector<Message> list;
+                list.reserve(count);
+                for (size_t i = 0; i < count; i++) {
+                    list.emplace_back(readMessage(reader, depth + 1));
+                }
+                return list;
+            }
+            default:
+                throw std::runtime_error("Invalid binary message type");
+        }
+    }
+
+    void BinaryProtocol::writeMessage(BinaryWriter &writer, const Message &message) {
+        xng::writeMessage(writer, message);
+    }
+
+    Message BinaryProtocol::readMessage(BinaryReader &reader) {
+        return xng::readMessage(reader, 0);
+    }
+
+    void BinaryProtocol::serialize(std::ostream &stream, const Message &message) {
+        BinaryWriter writer;
+        writer.write(BINARY_PROTOCOL_MAGIC.data(), BINARY_PROTOCOL_MAGIC.size());
+        writeMessage(writer, message);
+        stream.write(writer.getData().data(), static_cast<std::streamsize>(writer.size()));
+    }
+
+    Message BinaryProtocol::deserialize(std::istream &stream) {
+        auto buffer = ReadBuffer::fromStream(stream);
+        BinaryReader reader(buffer.chars(), buffer.size());
+        std::string magic(BINARY_PROTOCOL_MAGIC.size(), 0);
+        reader.read(magic.data(), magic.size());
+        if (magic != BINARY_PROTOCOL_MAGIC)
+            throw std::runtime_error("Invalid binary message magic");
+        return readMessage(reader);
+    }
+}
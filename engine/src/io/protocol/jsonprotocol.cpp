@@ -38,14 +38,14 @@ namespace xng {
                 ret = message.as<std::string>();
                 break;
             case Message::DICTIONARY:
-                for (auto &m: message.as<std::map<std::string, Message>>()) {
-                    ret[m.first] = convertMessage(m.second);
-                }
+                message.forEachEntry([&ret](const std::string &key, const Message &value) {
+                    ret[key] = convertMessage(value);
+                });
                 break;
             case Message::LIST:
-                for (auto &m: message.as<std::vector<Message>>()) {
-                    ret.emplace_back(convertMessage(m));
-                }
+                message.forEachElement([&ret](const Message &value) {
+                    ret.emplace_back(convertMessage(value));
+                });
                 break;
             default:
                 break;
@@ -72,8 +72,8 @@ namespace xng {
             return msgs;
         } else if (j.is_object()) {
             std::map<std::string, Message> msgs;
-            for (auto &it: j.get<nlohmann::json::object_t>()) {
-                msgs[it.first] = convertMessage(it.second);
+            for (auto &it: j.items()) {
+                msgs[it.key()] = convertMessage(it.value());
             }
             return msgs;
         } else {
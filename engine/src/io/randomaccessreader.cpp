@@ -0,0 +1,93 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/io/randomaccessreader.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <cstring>
+
+#include "io/mappedfile.hpp"
+
+namespace xng {
+    class BufferReader : public RandomAccessReader {
+    public:
+        explicit BufferReader(ReadBuffer buffer) : buffer(std::move(buffer)) {}
+
+        size_t size() const override {
+            return buffer.size();
+        }
+
+        size_t read(size_t offset, uint8_t *out, size_t count) override {
+            if (offset >= buffer.size())
+                return 0;
+            count = std::min(count, buffer.size() - offset);
+            std::memcpy(out, buffer.data() + offset, count);
+            return count;
+        }
+
+        ReadBuffer view(size_t offset, size_t count) override {
+            if (offset >= buffer.size())
+                return {};
+            return buffer.slice(offset, std::min(count, buffer.size() - offset));
+        }
+
+    private:
+        ReadBuffer buffer;
+    };
+
+    class StreamReader : public RandomAccessReader {
+    public:
+        explicit StreamReader(std::istream &stream) : stream(stream) {
+            stream.clear();
+            stream.seekg(0, std::ios::end);
+            length = static_cast<size_t>(stream.tellg());
+        }
+
+        size_t size() const override {
+            return length;
+        }
+
+        size_t read(size_t offset, uint8_t *out, size_t count) override {
+            std::lock_guard<std::mutex> guard(mutex);
+            stream.clear();
+            stream.seekg(static_cast<std::streamoff>(offset));
+            stream.read(reinterpret_cast<char *>(out), static_cast<std::streamsize>(count));
+            return static_cast<size_t>(stream.gcount());
+        }
+
+    private:
+        std::mutex mutex;
+        std::istream &stream;
+        size_t length;
+    };
+
+    std::shared_ptr<RandomAccessReader> RandomAccessReader::open(const std::filesystem::path &path) {
+        auto file = std::make_shared<MappedFile>(path);
+        return std::make_shared<BufferReader>(ReadBuffer(file->data(), file->size(), file));
+    }
+
+    std::shared_ptr<RandomAccessReader> RandomAccessReader::fromStream(std::istream &stream) {
+        return std::make_shared<StreamReader>(stream);
+    }
+
+    std::shared_ptr<RandomAccessReader> RandomAccessReader::fromBuffer(ReadBuffer buffer) {
+        return std::make_shared<BufferReader>(std::move(buffer));
+    }
+}
@@ -19,13 +19,6 @@
 
 #include "xng/math/interpolation.hpp"
 
-#include<glm/glm.hpp>
-#include<glm/gtc/quaternion.hpp>
-#include<glm/common.hpp>
-
 xng::Quaternion xng::slerp(const xng::Quaternion &a, const xng::Quaternion &b, float t) {
-    glm::quat qa(a.w, a.x, a.y, a.z);
-    glm::quat qb(b.w, b.x, b.y, b.z);
-    auto ret = glm::slerp(qa, qb, t);
-    return {ret.w, ret.x, ret.y, ret.z};
+    return Quaternion::slerp(a, b, t);
 }
@@ -19,6 +19,8 @@
 
 #include "xng/math/matrixmath.hpp"
 
+#include "math/simd.hpp"
+
 #include <glm/glm.hpp>
 #include <glm/gtc/matrix_transform.hpp>
 
@@ -52,19 +54,47 @@ namespace xng {
     }
 
     Mat4f MatrixMath::inverse(const Mat4f &mat) {
-        return convert(glm::inverse(convert(mat)));
+        Mat4f ret;
+        simd::mat4Inverse(mat.data, ret.data);
+        return ret;
     }
 
     Mat4f MatrixMath::transpose(const Mat4f &mat) {
         Mat4f ret;
-        for (int r = 0; r < mat.height(); r++) {
-            for (int c = 0; c < mat.width(); c++) {
-                ret.set(r, c, mat.get(c, r));
-            }
-        }
+        simd::mat4Transpose(mat.data, ret.data);
         return ret;
     }
 
+    void MatrixMath::multiply(const Mat4f &lhs, const Mat4f *rhs, Mat4f *out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            simd::mat4Mul(lhs.data, rhs[i].data, out[i].data);
+        }
+    }
+
+    void MatrixMath::multiply(const Mat4f *lhs, const Mat4f &rhs, Mat4f *out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            simd::mat4Mul(lhs[i].data, rhs.data, out[i].data);
+        }
+    }
+
+    void MatrixMath::transform(const Mat4f &mat, const Vec4f *vectors, Vec4f *out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            float vec[4] = {vectors[i].x, vectors[i].y, vectors[i].z, vectors[i].w};
+            float res[4];
+            simd::mat4MulVec4(mat.data, vec, res);
+            out[i] = Vec4f(res[0], res[1], res[2], res[3]);
+        }
+    }
+
+    void MatrixMath::transformPoints(const Mat4f &mat, const Vec3f *points, Vec3f *out, size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            float vec[4] = {points[i].x, points[i].y, points[i].z, 1};
+            float res[4];
+            simd::mat4MulVec4(mat.data, vec, res);
+            out[i] = Vec3f(res[0], res[1], res[2]);
+        }
+    }
+
     Mat4f MatrixMath::perspective(float fovy, float aspect, float zNear, float zFar) {
         return convert(glm::perspective(glm::radians(fovy), aspect, zNear, zFar));
     }
@@ -22,6 +22,8 @@
 #include "xng/math/rotation.hpp"
 #include "xng/math/matrixmath.hpp"
 
+#include "math/simd.hpp"
+
 #include<glm/glm.hpp>
 #include<glm/gtc/quaternion.hpp>
 #include<glm/common.hpp>
@@ -102,11 +104,12 @@ namespace xng {
     }
 
     Quaternion& Quaternion::normalize() {
-        float m = magnitude();
-        w /= m;
-        x /= m;
-        y /= m;
-        z /= m;
+        float q[4] = {w, x, y, z};
+        simd::quatNormalize(q, q);
+        w = q[0];
+        x = q[1];
+        y = q[2];
+        z = q[3];
         return *this;
     }
 
@@ -117,10 +120,11 @@ namespace xng {
     }
 
     Quaternion Quaternion::slerp(const Quaternion &a, const Quaternion &b, float advance) {
-        glm::quat qa(a.w, a.x, a.y, a.z);
-        glm::quat qb(b.w, b.x, b.y, b.z);
-        auto ret = glm::slerp(qa, qb, advance);
-        return {ret.w, ret.x, ret.y, ret.z};
+        float qa[4] = {a.w, a.x, a.y, a.z};
+        float qb[4] = {b.w, b.x, b.y, b.z};
+        float ret[4];
+        simd::quatSlerp(qa, qb, advance, ret);
+        return {ret[0], ret[1], ret[2], ret[3]};
     }
 
     Messageable &Quaternion::operator<<(const Message &message) {
@@ -0,0 +1,389 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#ifndef XENGINE_SIMD_HPP
+#define XENGINE_SIMD_HPP
+
+#include <cmath>
+
+#if defined(XENGINE_SIMD_DISABLE)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define XENGINE_SIMD_SSE
+#include <emmintrin.h>
+#if defined(__AVX__)
+#define XENGINE_SIMD_AVX
+#include <immintrin.h>
+#endif
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define XENGINE_SIMD_NEON
+#include <arm_neon.h>
+#endif
+
+/**
+ * Internal math kernels operating on raw float arrays.
+ *
+ * Matrices are 16 floats in column major layout, vectors are 4 floats (x, y, z, w)
+ * and quaternions are 4 floats in the member order of Quaternion (w, x, y, z).
+ *
+ * The output pointer may alias any of the input pointers.
+ */
+namespace xng::simd {
+    inline void mat4Inverse_scalar(const float *m, float *out) {
+        float inv[16];
+
+        inv[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15]
+                 + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+        inv[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15]
+                 - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+        inv[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15]
+                 + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+        inv[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14]
+                  - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+        inv[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15]
+                 - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+        inv[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15]
+                 + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+        inv[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15]
+                 - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+        inv[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14]
+                  + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+        inv[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15]
+                 + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+        inv[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15]
+                 - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+        inv[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15]
+                  + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+        inv[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14]
+                  - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+        inv[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11]
+                 - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+        inv[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11]
+                 + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+        inv[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11]
+                  - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+        inv[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10]
+                  + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+        float det = m[0] * inv[0] + m[1] * inv[4] + m[2] * inv[8] + m[3] * inv[12];
+        float invDet = 1.0f / det;
+        for (int i = 0; i < 16; i++) {
+            out[i] = inv[i] * invDet;
+        }
+    }
+
+    inline float quatDot_scalar(const float *a, const float *b) {
+        return a[0] * b[0] + a[1] * b[1] + a[2] * b[2] + a[3] * b[3];
+    }
+
+#if defined(XENGINE_SIMD_SSE)
+    inline __m128 dot4(__m128 a, __m128 b) {
+        __m128 m = _mm_mul_ps(a, b);
+        __m128 s = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm_add_ps(s, _mm_shuffle_ps(s, s, _MM_SHUFFLE(1, 0, 3, 2)));
+    }
+
+    // 2x2 matrix helpers for the block wise inverse, the 2x2 matrices are stored as (m00, m01, m10, m11)
+    inline __m128 mat2Mul(__m128 a, __m128 b) {
+        return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    // adj(a) * b
+    inline __m128 mat2AdjMul(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    // a * adj(b)
+    inline __m128 mat2MulAdj(__m128 a, __m128 b) {
+        return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+                          _mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+                                     _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+#elif defined(XENGINE_SIMD_NEON)
+    inline float dot4(float32x4_t a, float32x4_t b) {
+        float32x4_t m = vmulq_f32(a, b);
+        float32x2_t s = vadd_f32(vget_low_f32(m), vget_high_f32(m));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+    }
+#endif
+
+    inline void mat4Mul(const float *a, const float *b, float *out) {
+#if defined(XENGINE_SIMD_AVX)
+        __m256 a01 = _mm256_loadu_ps(a);
+        __m256 a23 = _mm256_loadu_ps(a + 8);
+        __m256 a00 = _mm256_permute2f128_ps(a01, a01, 0x00);
+        __m256 a11 = _mm256_permute2f128_ps(a01, a01, 0x11);
+        __m256 a22 = _mm256_permute2f128_ps(a23, a23, 0x00);
+        __m256 a33 = _mm256_permute2f128_ps(a23, a23, 0x11);
+        // Two result columns per iteration
+        __m256 r[2];
+        for (int i = 0; i < 2; i++) {
+            const float *c = b + i * 8;
+            __m256 x = _mm256_setr_ps(c[0], c[0], c[0], c[0], c[4], c[4], c[4], c[4]);
+            __m256 y = _mm256_setr_ps(c[1], c[1], c[1], c[1], c[5], c[5], c[5], c[5]);
+            __m256 z = _mm256_setr_ps(c[2], c[2], c[2], c[2], c[6], c[6], c[6], c[6]);
+            __m256 w = _mm256_setr_ps(c[3], c[3], c[3], c[3], c[7], c[7], c[7], c[7]);
+            r[i] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(a00, x), _mm256_mul_ps(a11, y)),
+                                 _mm256_add_ps(_mm256_mul_ps(a22, z), _mm256_mul_ps(a33, w)));
+        }
+        _mm256_storeu_ps(out, r[0]);
+        _mm256_storeu_ps(out + 8, r[1]);
+#elif defined(XENGINE_SIMD_SSE)
+        __m128 a0 = _mm_loadu_ps(a);
+        __m128 a1 = _mm_loadu_ps(a + 4);
+        __m128 a2 = _mm_loadu_ps(a + 8);
+        __m128 a3 = _mm_loadu_ps(a + 12);
+        __m128 r[4];
+        for (int i = 0; i < 4; i++) {
+            const float *c = b + i * 4;
+            r[i] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, _mm_set1_ps(c[0])), _mm_mul_ps(a1, _mm_set1_ps(c[1]))),
+                              _mm_add_ps(_mm_mul_ps(a2, _mm_set1_ps(c[2])), _mm_mul_ps(a3, _mm_set1_ps(c[3]))));
+        }
+        for (int i = 0; i < 4; i++) {
+            _mm_storeu_ps(out + i * 4, r[i]);
+        }
+#elif defined(XENGINE_SIMD_NEON)
+        float32x4_t a0 = vld1q_f32(a);
+        float32x4_t a1 = vld1q_f32(a + 4);
+        float32x4_t a2 = vld1q_f32(a + 8);
+        float32x4_t a3 = vld1q_f32(a + 12);
+        float32x4_t r[4];
+        for (int i = 0; i < 4; i++) {
+            const float *c = b + i * 4;
+            r[i] = vmulq_n_f32(a0, c[0]);
+            r[i] = vmlaq_n_f32(r[i], a1, c[1]);
+            r[i] = vmlaq_n_f32(r[i], a2, c[2]);
+            r[i] = vmlaq_n_f32(r[i], a3, c[3]);
+        }
+        for (int i = 0; i < 4; i++) {
+            vst1q_f32(out + i * 4, r[i]);
+        }
+#else
+        float r[16];
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                r[col * 4 + row] = a[row] * b[col * 4]
+                                   + a[4 + row] * b[col * 4 + 1]
+                                   + a[8 + row] * b[col * 4 + 2]
+                                   + a[12 + row] * b[col * 4 + 3];
+            }
+        }
+        for (int i = 0; i < 16; i++) {
+            out[i] = r[i];
+        }
+#endif
+    }
+
+    inline void mat4MulVec4(const float *m, const float *v, float *out) {
+#if defined(XENGINE_SIMD_SSE)
+        __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m), _mm_set1_ps(v[0])),
+                                         _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(v[1]))),
+                              _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(v[2])),
+                                         _mm_mul_ps(_mm_loadu_ps(m + 12), _mm_set1_ps(v[3]))));
+        _mm_storeu_ps(out, r);
+#elif defined(XENGINE_SIMD_NEON)
+        float32x4_t r = vmulq_n_f32(vld1q_f32(m), v[0]);
+        r = vmlaq_n_f32(r, vld1q_f32(m + 4), v[1]);
+        r = vmlaq_n_f32(r, vld1q_f32(m + 8), v[2]);
+        r = vmlaq_n_f32(r, vld1q_f32(m + 12), v[3]);
+        vst1q_f32(out, r);
+#else
+        float r[4];
+        for (int row = 0; row < 4; row++) {
+            r[row] = m[row] * v[0] + m[4 + row] * v[1] + m[8 + row] * v[2] + m[12 + row] * v[3];
+        }
+        for (int i = 0; i < 4; i++) {
+            out[i] = r[i];
+        }
+#endif
+    }
+
+    inline void mat4Transpose(const float *m, float *out) {
+#if defined(XENGINE_SIMD_SSE)
+        __m128 c0 = _mm_loadu_ps(m);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+        _MM_TRANSPOSE4_PS(c0, c1, c2, c3);
+        _mm_storeu_ps(out, c0);
+        _mm_storeu_ps(out + 4, c1);
+        _mm_storeu_ps(out + 8, c2);
+        _mm_storeu_ps(out + 12, c3);
+#elif defined(XENGINE_SIMD_NEON)
+        float32x4x2_t t0 = vtrnq_f32(vld1q_f32(m), vld1q_f32(m + 4));
+        float32x4x2_t t1 = vtrnq_f32(vld1q_f32(m + 8), vld1q_f32(m + 12));
+        vst1q_f32(out, vcombine_f32(vget_low_f32(t0.val[0]), vget_low_f32(t1.val[0])));
+        vst1q_f32(out + 4, vcombine_f32(vget_low_f32(t0.val[1]), vget_low_f32(t1.val[1])));
+        vst1q_f32(out + 8, vcombine_f32(vget_high_f32(t0.val[0]), vget_high_f32(t1.val[0])));
+        vst1q_f32(out + 12, vcombine_f32(vget_high_f32(t0.val[1]), vget_high_f32(t1.val[1])));
+#else
+        float r[16];
+        for (int col = 0; col < 4; col++) {
+            for (int row = 0; row < 4; row++) {
+                r[row * 4 + col] = m[col * 4 + row];
+            }
+        }
+        for (int i = 0; i < 16; i++) {
+            out[i] = r[i];
+        }
+#endif
+    }
+
+    inline void mat4Inverse(const float *m, float *out) {
+#if defined(XENGINE_SIMD_SSE)
+        // Block wise inversion of the 2x2 sub matrices, the result for a transposed input is the transposed inverse
+        // so the same code works for column major data.
+        __m128 c0 = _mm_loadu_ps(m);
+        __m128 c1 = _mm_loadu_ps(m + 4);
+        __m128 c2 = _mm_loadu_ps(m + 8);
+        __m128 c3 = _mm_loadu_ps(m + 12);
+
+        __m128 A = _mm_movelh_ps(c0, c1);
+        __m128 B = _mm_movehl_ps(c1, c0);
+        __m128 C = _mm_movelh_ps(c2, c3);
+        __m128 D = _mm_movehl_ps(c3, c2);
+
+        // (|A|, |B|, |C|, |D|)
+        __m128 detSub = _mm_sub_ps(
+                _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(2, 0, 2, 0)),
+                           _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(3, 1, 3, 1))),
+                _mm_mul_ps(_mm_shuffle_ps(c0, c2, _MM_SHUFFLE(3, 1, 3, 1)),
+                           _mm_shuffle_ps(c1, c3, _MM_SHUFFLE(2, 0, 2, 0))));
+        __m128 detA = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(0, 0, 0, 0));
+        __m128 detB = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(1, 1, 1, 1));
+        __m128 detC = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(2, 2, 2, 2));
+        __m128 detD = _mm_shuffle_ps(detSub, detSub, _MM_SHUFFLE(3, 3, 3, 3));
+
+        __m128 D_C = mat2AdjMul(D, C);
+        __m128 A_B = mat2AdjMul(A, B);
+        __m128 X_ = _mm_sub_ps(_mm_mul_ps(detD, A), mat2Mul(B, D_C));
+        __m128 W_ = _mm_sub_ps(_mm_mul_ps(detA, D), mat2Mul(C, A_B));
+        __m128 Y_ = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdj(D, A_B));
+        __m128 Z_ = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdj(A, D_C));
+
+        // |M| = |A| * |D| + |B| * |C| - tr((A#B)(D#C))
+        __m128 tr = _mm_mul_ps(A_B, _mm_shuffle_ps(D_C, D_C, _MM_SHUFFLE(3, 1, 2, 0)));
+        tr = dot4(tr, _mm_set1_ps(1));
+        __m128 detM = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC)), tr);
+
+        __m128 rDetM = _mm_div_ps(_mm_setr_ps(1.f, -1.f, -1.f, 1.f), detM);
+
+        X_ = _mm_mul_ps(X_, rDetM);
+        Y_ = _mm_mul_ps(Y_, rDetM);
+        Z_ = _mm_mul_ps(Z_, rDetM);
+        W_ = _mm_mul_ps(W_, rDetM);
+
+        _mm_storeu_ps(out, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 4, _mm_shuffle_ps(X_, Y_, _MM_SHUFFLE(0, 2, 0, 2)));
+        _mm_storeu_ps(out + 8, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(1, 3, 1, 3)));
+        _mm_storeu_ps(out + 12, _mm_shuffle_ps(Z_, W_, _MM_SHUFFLE(0, 2, 0, 2)));
+#else
+        mat4Inverse_scalar(m, out);
+#endif
+    }
+
+    inline void quatNormalize(const float *q, float *out) {
+#if defined(XENGINE_SIMD_SSE)
+        __m128 v = _mm_loadu_ps(q);
+        _mm_storeu_ps(out, _mm_div_ps(v, _mm_sqrt_ps(dot4(v, v))));
+#elif defined(XENGINE_SIMD_NEON)
+        float32x4_t v = vld1q_f32(q);
+        vst1q_f32(out, vmulq_n_f32(v, 1.0f / std::sqrt(dot4(v, v))));
+#else
+        float m = std::sqrt(quatDot_scalar(q, q));
+        for (int i = 0; i < 4; i++) {
+            out[i] = q[i] / m;
+        }
+#endif
+    }
+
+    /**
+     * Spherical interpolation along the shortest path, equivalent to glm::slerp.
+     */
+    inline void quatSlerp(const float *a, const float *b, float t, float *out) {
+#if defined(XENGINE_SIMD_SSE)
+        __m128 va = _mm_loadu_ps(a);
+        __m128 vb = _mm_loadu_ps(b);
+        float cosTheta = _mm_cvtss_f32(dot4(va, vb));
+        if (cosTheta < 0) {
+            vb = _mm_sub_ps(_mm_setzero_ps(), vb);
+            cosTheta = -cosTheta;
+        }
+        float sa, sb;
+        if (cosTheta > 1.0f - 1e-6f) {
+            sa = 1.0f - t;
+            sb = t;
+        } else {
+            float angle = std::acos(cosTheta);
+            float invSin = 1.0f / std::sin(angle);
+            sa = std::sin((1.0f - t) * angle) * invSin;
+            sb = std::sin(t * angle) * invSin;
+        }
+        _mm_storeu_ps(out, _mm_add_ps(_mm_mul_ps(va, _mm_set1_ps(sa)), _mm_mul_ps(vb, _mm_set1_ps(sb))));
+#elif defined(XENGINE_SIMD_NEON)
+        float32x4_t va = vld1q_f32(a);
+        float32x4_t vb = vld1q_f32(b);
+        float cosTheta = dot4(va, vb);
+        if (cosTheta < 0) {
+            vb = vnegq_f32(vb);
+            cosTheta = -cosTheta;
+        }
+        float sa, sb;
+        if (cosTheta > 1.0f - 1e-6f) {
+            sa = 1.0f - t;
+            sb = t;
+        } else {
+            float angle = std::acos(cosTheta);
+            float invSin = 1.0f / std::sin(angle);
+            sa = std::sin((1.0f - t) * angle) * invSin;
+            sb = std::sin(t * angle) * invSin;
+        }
+        vst1q_f32(out, vmlaq_n_f32(vmulq_n_f32(va, sa), vb, sb));
+#else
+        float sign = 1;
+        float cosTheta = quatDot_scalar(a, b);
+        if (cosTheta < 0) {
+            sign = -1;
+            cosTheta = -cosTheta;
+        }
+        float sa, sb;
+        if (cosTheta > 1.0f - 1e-6f) {
+            sa = 1.0f - t;
+            sb = t;
+        } else {
+            float angle = std::acos(cosTheta);
+            float invSin = 1.0f / std::sin(angle);
+            sa = std::sin((1.0f - t) * angle) * invSin;
+            sb = std::sin(t * angle) * invSin;
+        }
+        float r[4];
+        for (int i = 0; i < 4; i++) {
+            r[i] = a[i] * sa + b[i] * sign * sb;
+        }
+        for (int i = 0; i < 4; i++) {
+            out[i] = r[i];
+        }
+#endif
+    }
+}
+
+#endif //XENGINE_SIMD_HPP
@@ -0,0 +1,214 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/render/atlas/packedtextureatlas.hpp"
+
+#include <algorithm>
+
+namespace xng {
+    ImageRGBA PackedTextureAtlas::getPaddedImage(const ImageRGBA &texture, const Region &region) {
+        auto resolution = texture.getResolution();
+        if (resolution != region.size) {
+            throw std::runtime_error("Texture size does not match the region size");
+        }
+
+        auto border = region.offset - region.allocationOffset;
+
+        ImageRGBA ret(region.allocationSize);
+        for (auto y = 0; y < region.allocationSize.y; y++) {
+            auto sy = std::clamp(y - border.y, 0, resolution.y - 1);
+            for (auto x = 0; x < region.allocationSize.x; x++) {
+                auto sx = std::clamp(x - border.x, 0, resolution.x - 1);
+                ret.setPixel(x, y, texture.getPixel(sx, sy));
+            }
+        }
+        return ret;
+    }
+
+    PackedTextureAtlas::PackedTextureAtlas(Vec2i layerSize, int padding, int mipMapLevels)
+            : layerSize(layerSize),
+              padding(padding),
+              mipMapLevels(mipMapLevels) {
+        if (mipMapLevels < 1 || padding < 0) {
+            throw std::runtime_error("Invalid packed texture atlas parameters");
+        }
+        alignment = 1 << (mipMapLevels - 1);
+        if (layerSize.x <= 0 || layerSize.y <= 0 || layerSize.x % alignment != 0 || layerSize.y % alignment != 0) {
+            throw std::runtime_error("Layer size must be a multiple of the mip map alignment");
+        }
+    }
+
+    size_t PackedTextureAtlas::add(const Vec2i &size) {
+        if (size.x <= 0 || size.y <= 0) {
+            throw std::runtime_error("Invalid texture size");
+        }
+
+        Region region;
+        auto layerIndex = layers.size();
+        for (size_t i = 0; i < layers.size(); i++) {
+            if (allocate(layers.at(i), i, size, region)) {
+                layerIndex = i;
+                break;
+            }
+        }
+
+        if (layerIndex == layers.size()) {
+            Layer layer;
+            layer.packer = SkylinePacker(layerSize / alignment);
+            if (!allocate(layer, layerIndex, size, region)) {
+                throw std::runtime_error("Texture does not fit into the atlas layer size");
+            }
+            layers.emplace_back(std::move(layer));
+        }
+
+        auto handle = handleCounter++;
+        auto &layer = layers.at(layerIndex);
+        layer.handles.insert(handle);
+        layer.liveArea += static_cast<size_t>(region.allocationSize.x) * static_cast<size_t>(region.allocationSize.y);
+        regions[handle] = region;
+        return handle;
+    }
+
+    void PackedTextureAtlas::remove(size_t handle) {
+        auto it = regions.find(handle);
+        if (it == regions.end()) {
+            throw std::runtime_error("Texture already removed");
+        }
+
+        auto &layer = layers.at(it->second.layer);
+        layer.handles.erase(handle);
+        layer.liveArea -= static_cast<size_t>(it->second.allocationSize.x)
+                          * static_cast<size_t>(it->second.allocationSize.y);
+        if (layer.handles.empty()) {
+            layer.packer.reset();
+            layer.liveArea = 0;
+        }
+
+        regions.erase(it);
+    }
+
+    std::vector<PackedTextureAtlas::Move> PackedTextureAtlas::defragment(float maxOccupancy) {
+        auto sourceIndex = layers.size();
+        auto lowestOccupancy = maxOccupancy;
+        for (size_t i = 0; i < layers.size(); i++) {
+            if (layers.at(i).handles.empty())
+                continue;
+            auto occupancy = getOccupancy(i);
+            if (occupancy < lowestOccupancy) {
+                lowestOccupancy = occupancy;
+                sourceIndex = i;
+            }
+        }
+
+        if (sourceIndex == layers.size()) {
+            return {};
+        }
+
+        // Copies within the same layer could overlap, so the regions are always moved into a different layer.
+        auto targetIndex = layers.size();
+        for (size_t i = 0; i < layers.size(); i++) {
+            if (i != sourceIndex && layers.at(i).handles.empty()) {
+                targetIndex = i;
+                break;
+            }
+        }
+
+        Layer target;
+        target.packer = SkylinePacker(layerSize / alignment);
+
+        auto &source = layers.at(sourceIndex);
+
+        // Placing the tallest regions first leaves a flat skyline for the remaining regions.
+        std::vector<size_t> handles(source.handles.begin(), source.handles.end());
+        std::sort(handles.begin(), handles.end(), [this](size_t a, size_t b) {
+            auto &ra = regions.at(a);
+            auto &rb = regions.at(b);
+            if (ra.allocationSize.y != rb.allocationSize.y)
+                return ra.allocationSize.y > rb.allocationSize.y;
+            if (ra.allocationSize.x != rb.allocationSize.x)
+                return ra.allocationSize.x > rb.allocationSize.x;
+            return a < b;
+        });
+
+        std::vector<Move> ret;
+        for (auto handle: handles) {
+            Move move;
+            move.handle = handle;
+            move.source = regions.at(handle);
+            if (!allocate(target, targetIndex, move.source.size, move.target)) {
+                // The packing order differs from the original one so a full layer may not fit again.
+                return {};
+            }
+            ret.emplace_back(move);
+        }
+
+        // Skip the compaction if it would not free up any space.
+        if (target.packer.getCoveredArea() >= source.packer.getCoveredArea()) {
+            return {};
+        }
+
+        for (auto &move: ret) {
+            regions.at(move.handle) = move.target;
+            target.handles.insert(move.handle);
+        }
+        target.liveArea = source.liveArea;
+
+        source.handles.clear();
+        source.packer.reset();
+        source.liveArea = 0;
+
+        if (targetIndex == layers.size()) {
+            layers.emplace_back(std::move(target));
+        } else {
+            layers.at(targetIndex) = std::move(target);
+        }
+
+        return ret;
+    }
+
+    float PackedTextureAtlas::getOccupancy(size_t layer) const {
+        auto &l = layers.at(layer);
+        auto covered = l.packer.getCoveredArea() * static_cast<size_t>(alignment) * static_cast<size_t>(alignment);
+        if (covered == 0)
+            return 1;
+        return static_cast<float>(l.liveArea) / static_cast<float>(covered);
+    }
+
+    Vec2i PackedTextureAtlas::getAllocationSize(const Vec2i &size) const {
+        auto alignUp = [this](int value) {
+            return (value + alignment - 1) / alignment * alignment;
+        };
+        return {alignUp(size.x + padding * 2), alignUp(size.y + padding * 2)};
+    }
+
+    bool PackedTextureAtlas::allocate(Layer &layer, size_t layerIndex, const Vec2i &size, Region &region) const {
+        auto allocationSize = getAllocationSize(size);
+        Vec2i offset;
+        if (!layer.packer.pack(allocationSize / alignment, offset)) {
+            return false;
+        }
+        region.layer = layerIndex;
+        region.size = size;
+        region.allocationSize = allocationSize;
+        region.allocationOffset = offset * alignment;
+        region.offset = region.allocationOffset + Vec2i(padding, padding);
+        return true;
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/render/atlas/skylinepacker.hpp"
+
+#include <limits>
+
+namespace xng {
+    SkylinePacker::SkylinePacker(Vec2i size)
+            : size(size) {
+        reset();
+    }
+
+    bool SkylinePacker::pack(const Vec2i &rect, Vec2i &offset) {
+        if (rect.x <= 0 || rect.y <= 0 || rect.x > size.x || rect.y > size.y) {
+            return false;
+        }
+
+        auto bestIndex = skyline.size();
+        auto bestTop = std::numeric_limits<int>::max();
+        auto bestWidth = std::numeric_limits<int>::max();
+        auto bestY = 0;
+
+        for (size_t i = 0; i < skyline.size(); i++) {
+            auto y = fit(i, rect);
+            if (y < 0)
+                continue;
+            auto top = y + rect.y;
+            // Prefer the lowest top edge and on ties the narrowest segment to leave wide segments for wide rectangles.
+            if (top < bestTop || (top == bestTop && skyline.at(i).width < bestWidth)) {
+                bestIndex = i;
+                bestTop = top;
+                bestWidth = skyline.at(i).width;
+                bestY = y;
+            }
+        }
+
+        if (bestIndex == skyline.size()) {
+            return false;
+        }
+
+        offset = {skyline.at(bestIndex).x, bestY};
+
+        skyline.insert(skyline.begin() + static_cast<long>(bestIndex), Node{offset.x, bestTop, rect.x});
+
+        // Shrink or remove the nodes which are now covered by the new node.
+        auto right = offset.x + rect.x;
+        for (auto i = bestIndex + 1; i < skyline.size();) {
+            auto &node = skyline.at(i);
+            if (node.x >= right)
+                break;
+            auto nodeRight = node.x + node.width;
+            if (nodeRight <= right) {
+                skyline.erase(skyline.begin() + static_cast<long>(i));
+            } else {
+                node.width = nodeRight - right;
+                node.x = right;
+                break;
+            }
+        }
+
+        // Merge neighbouring nodes of the same height.
+        for (size_t i = 0; i + 1 < skyline.size();) {
+            if (skyline.at(i).y == skyline.at(i + 1).y) {
+                skyline.at(i).width += skyline.at(i + 1).width;
+                skyline.erase(skyline.begin() + static_cast<long>(i + 1));
+            } else {
+                i++;
+            }
+        }
+
+        usedArea += static_cast<size_t>(rect.x) * static_cast<size_t>(rect.y);
+
+        return true;
+    }
+
+    void SkylinePacker::reset() {
+        skyline.clear();
+        skyline.emplace_back(Node{0, 0, size.x});
+        usedArea = 0;
+    }
+
+    size_t SkylinePacker::getCoveredArea() const {
+        size_t ret = 0;
+        for (auto &node: skyline) {
+            ret += static_cast<size_t>(node.width) * static_cast<size_t>(node.y);
+        }
+        return ret;
+    }
+
+    int SkylinePacker::fit(size_t index, const Vec2i &rect) const {
+        auto x = skyline.at(index).x;
+        if (x + rect.x > size.x)
+            return -1;
+
+        auto y = skyline.at(index).y;
+        auto remaining = rect.x;
+        for (auto i = index; remaining > 0; i++) {
+            auto &node = skyline.at(i);
+            if (node.y > y)
+                y = node.y;
+            if (y + rect.y > size.y)
+                return -1;
+            remaining -= node.width;
+        }
+        return y;
+    }
+}
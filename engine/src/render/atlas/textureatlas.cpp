@@ -37,7 +37,6 @@ namespace xng {
                               const TextureAtlasHandle &handle,
                               const std::map<TextureAtlasResolution, FrameGraphResource> &atlasBuffers,
                               const ImageRGBA &texture) {
-        auto img = getAlignedImage(texture, handle.level);
         builder.upload(atlasBuffers.at(handle.level),
                        handle.index,
                        0,
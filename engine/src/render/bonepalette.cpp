@@ -0,0 +1,178 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <cmath>
+
+#include "xng/render/scene/bonepalette.hpp"
+
+#include "xng/math/matrixmath.hpp"
+
+namespace xng {
+    static Vec3f cross(const Vec3f &a, const Vec3f &b) {
+        return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+    }
+
+    static float dot(const Vec3f &a, const Vec3f &b) {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // Returns the normalized rotation quaternion of the upper 3x3 part of the transform as x, y, z, w
+    static Vec4f getRotation(const Mat4f &transform) {
+        float m[3][3];
+        for (auto col = 0; col < 3; col++) {
+            Vec3f axis(transform.get(col, 0), transform.get(col, 1), transform.get(col, 2));
+            auto length = axis.magnitude();
+            if (length > 0) {
+                axis = axis / length;
+            }
+            m[0][col] = axis.x;
+            m[1][col] = axis.y;
+            m[2][col] = axis.z;
+        }
+
+        Vec4f ret;
+        auto trace = m[0][0] + m[1][1] + m[2][2];
+        if (trace > 0) {
+            auto s = std::sqrt(trace + 1.0f) * 2;
+            ret = Vec4f((m[2][1] - m[1][2]) / s, (m[0][2] - m[2][0]) / s, (m[1][0] - m[0][1]) / s, 0.25f * s);
+        } else if (m[0][0] > m[1][1] && m[0][0] > m[2][2]) {
+            auto s = std::sqrt(1.0f + m[0][0] - m[1][1] - m[2][2]) * 2;
+            ret = Vec4f(0.25f * s, (m[0][1] + m[1][0]) / s, (m[0][2] + m[2][0]) / s, (m[2][1] - m[1][2]) / s);
+        } else if (m[1][1] > m[2][2]) {
+            auto s = std::sqrt(1.0f + m[1][1] - m[0][0] - m[2][2]) * 2;
+            ret = Vec4f((m[0][1] + m[1][0]) / s, 0.25f * s, (m[1][2] + m[2][1]) / s, (m[0][2] - m[2][0]) / s);
+        } else {
+            auto s = std::sqrt(1.0f + m[2][2] - m[0][0] - m[1][1]) * 2;
+            ret = Vec4f((m[0][2] + m[2][0]) / s, (m[1][2] + m[2][1]) / s, 0.25f * s, (m[1][0] - m[0][1]) / s);
+        }
+
+        auto length = std::sqrt(ret.x * ret.x + ret.y * ret.y + ret.z * ret.z + ret.w * ret.w);
+        return ret / length;
+    }
+
+    size_t BonePalette::getStride(Format format) {
+        switch (format) {
+            case MATRIX_3X4:
+                return 3;
+            case DUAL_QUATERNION:
+                return 2;
+            default:
+                throw std::runtime_error("Invalid bone palette format");
+        }
+    }
+
+    void BonePalette::encode(const Mat4f &transform, Format format, float *out) {
+        switch (format) {
+            case MATRIX_3X4:
+                for (auto row = 0; row < 3; row++) {
+                    for (auto col = 0; col < 4; col++) {
+                        out[row * 4 + col] = transform.get(col, row);
+                    }
+                }
+                break;
+            case DUAL_QUATERNION: {
+                auto r = getRotation(transform);
+                Vec3f t(transform.get(3, 0), transform.get(3, 1), transform.get(3, 2));
+                Vec3f v(r.x, r.y, r.z);
+
+                // d = 0.5 * (0, t) * r
+                auto dv = (t * r.w + cross(t, v)) * 0.5f;
+                auto dw = -0.5f * dot(t, v);
+
+                out[0] = r.x;
+                out[1] = r.y;
+                out[2] = r.z;
+                out[3] = r.w;
+                out[4] = dv.x;
+                out[5] = dv.y;
+                out[6] = dv.z;
+                out[7] = dw;
+                break;
+            }
+            default:
+                throw std::runtime_error("Invalid bone palette format");
+        }
+    }
+
+    Mat4f BonePalette::decode(const float *data, Format format) {
+        auto ret = MatrixMath::identity();
+        switch (format) {
+            case MATRIX_3X4:
+                for (auto row = 0; row < 3; row++) {
+                    for (auto col = 0; col < 4; col++) {
+                        ret.set(col, row, data[row * 4 + col]);
+                    }
+                }
+                break;
+            case DUAL_QUATERNION: {
+                auto x = data[0], y = data[1], z = data[2], w = data[3];
+                Vec3f v(x, y, z);
+                Vec3f dv(data[4], data[5], data[6]);
+                auto dw = data[7];
+
+                ret.set(0, 0, 1 - 2 * (y * y + z * z));
+                ret.set(1, 0, 2 * (x * y - w * z));
+                ret.set(2, 0, 2 * (x * z + w * y));
+                ret.set(0, 1, 2 * (x * y + w * z));
+                ret.set(1, 1, 1 - 2 * (x * x + z * z));
+                ret.set(2, 1, 2 * (y * z - w * x));
+                ret.set(0, 2, 2 * (x * z - w * y));
+                ret.set(1, 2, 2 * (y * z + w * x));
+                ret.set(2, 2, 1 - 2 * (x * x + y * y));
+
+                // t = 2 * d * conjugate(r)
+                auto t = (dv * w - v * dw + cross(v, dv)) * 2.0f;
+                ret.set(3, 0, t.x);
+                ret.set(3, 1, t.y);
+                ret.set(3, 2, t.z);
+                break;
+            }
+            default:
+                throw std::runtime_error("Invalid bone palette format");
+        }
+        return ret;
+    }
+
+    BonePalette::BonePalette() {
+        clear();
+    }
+
+    size_t BonePalette::add(const std::vector<Mat4f> &value) {
+        if (value.empty())
+            return 0;
+        auto ret = transforms.size();
+        transforms.insert(transforms.end(), value.begin(), value.end());
+        return ret;
+    }
+
+    void BonePalette::clear() {
+        transforms.clear();
+        transforms.emplace_back(MatrixMath::identity());
+    }
+
+    std::vector<float> BonePalette::encode(Format format) const {
+        auto stride = getStride(format) * 4;
+        std::vector<float> ret(transforms.size() * stride);
+        for (auto i = 0; i < transforms.size(); i++) {
+            encode(transforms.at(i), format, ret.data() + i * stride);
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include <array>
+
+#include "xng/render/graph/framegraphbonepalette.hpp"
+#include "xng/render/graph/framegraphsettings.hpp"
+
+namespace xng {
+    FrameGraphResource FrameGraphBonePalette::getPaletteBuffer(FrameGraphBuilder &builder) {
+        if (builder.checkSlot(SLOT_BONE_PALETTE)) {
+            return builder.getSlot(SLOT_BONE_PALETTE);
+        }
+
+        auto format = static_cast<BonePalette::Format>(
+                builder.getSettings().get<int>(FrameGraphSettings::SETTING_BONE_PALETTE_FORMAT));
+        auto data = builder.getScene().bonePalette.encode(format);
+
+        std::array<int, 4> header{static_cast<int>(format), 0, 0, 0};
+
+        auto buffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = RenderBufferType::HOST_VISIBLE,
+                .size = sizeof(header) + sizeof(float) * data.size()
+        });
+
+        builder.upload(buffer,
+                       [header]() {
+                           return FrameGraphUploadBuffer::createValue(header);
+                       });
+        builder.upload(buffer,
+                       sizeof(header),
+                       [data]() {
+                           return FrameGraphUploadBuffer::createArray(data);
+                       });
+
+        builder.assignSlot(SLOT_BONE_PALETTE, buffer);
+
+        return buffer;
+    }
+
+    int FrameGraphBonePalette::addBoneIndices(const Scene &scene,
+                                              const Node &node,
+                                              size_t subMesh,
+                                              std::vector<uint32_t> &indices) {
+        auto &meshHandle = node.getProperty<SkinnedMeshProperty>().mesh;
+
+        // Read before resolving the mesh so that a reload during this call is mapped again by the next call
+        auto generation = meshHandle.getGeneration();
+        auto &skinnedMesh = meshHandle.get();
+
+        auto &entry = entries[meshHandle.getUri()];
+        if (entry.rigIndices.empty() || entry.generation != generation) {
+            entry.generation = generation;
+            entry.rigIndices.clear();
+            for (auto i = 0; i < skinnedMesh.subMeshes.size() + 1; i++) {
+                const Mesh &mesh = i == 0 ? skinnedMesh : skinnedMesh.subMeshes.at(i - 1);
+                std::vector<uint32_t> rigIndices;
+                for (auto &bone: mesh.bones) {
+                    rigIndices.emplace_back(skinnedMesh.rig.hasBone(bone)
+                                            ? static_cast<uint32_t>(skinnedMesh.rig.getBoneIndex(bone))
+                                            : NO_BONE);
+                }
+                entry.rigIndices.emplace_back(std::move(rigIndices));
+            }
+        }
+        entry.used = true;
+
+        auto &rigIndices = entry.rigIndices.at(subMesh);
+        if (rigIndices.empty()) {
+            return -1;
+        }
+
+        size_t paletteOffset = 0;
+        auto it = node.properties.find(typeid(BoneTransformsProperty));
+        if (it != node.properties.end()) {
+            paletteOffset = it->second->get<BoneTransformsProperty>().paletteOffset;
+        }
+
+        auto paletteSize = scene.bonePalette.size();
+
+        auto ret = static_cast<int>(indices.size());
+        for (auto rigIndex: rigIndices) {
+            if (paletteOffset == 0
+                || rigIndex == NO_BONE
+                || paletteOffset + rigIndex >= paletteSize) {
+                indices.emplace_back(0);
+            } else {
+                indices.emplace_back(static_cast<uint32_t>(paletteOffset + rigIndex));
+            }
+        }
+        return ret;
+    }
+
+    void FrameGraphBonePalette::releaseUnused() {
+        for (auto it = entries.begin(); it != entries.end();) {
+            if (it->second.used) {
+                it->second.used = false;
+                ++it;
+            } else {
+                it = entries.erase(it);
+            }
+        }
+    }
+}
@@ -145,6 +145,31 @@ namespace xng {
         commands.emplace_back(cmd);
     }
 
+    void FrameGraphBuilder::copyTextureRegion(FrameGraphResource source,
+                                              FrameGraphResource dest,
+                                              size_t sourceIndex,
+                                              size_t targetIndex,
+                                              Vec2i sourceOffset,
+                                              Vec2i targetOffset,
+                                              Vec2i size,
+                                              int mipMapLevels) {
+        if (!source.assigned)
+            throw std::runtime_error("Unassigned resource");
+        if (!dest.assigned)
+            throw std::runtime_error("Unassigned resource");
+        auto cmd = FrameGraphCommand();
+        cmd.type = FrameGraphCommand::COPY_TEXTURE_REGION;
+        cmd.resources.emplace_back(source);
+        cmd.resources.emplace_back(dest);
+        cmd.data = FrameGraphCommand::CopyTextureRegionData{sourceIndex,
+                                                            targetIndex,
+                                                            sourceOffset,
+                                                            targetOffset,
+                                                            size,
+                                                            mipMapLevels};
+        commands.emplace_back(cmd);
+    }
+
     void FrameGraphBuilder::generateMipMaps(FrameGraphResource buffer) {
         if (!buffer.assigned)
             throw std::runtime_error("Unassigned resource");
@@ -0,0 +1,260 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/graph/materialtable.hpp"
+
+#include "xng/render/atlas/textureatlas.hpp"
+
+namespace xng {
+    /**
+     * @return The assigned texture handles of the material in the order in which resolve() adds them
+     */
+    static std::vector<const ResourceHandle<Texture> *> getTextureHandles(const Material &material) {
+        std::vector<const ResourceHandle<Texture> *> ret;
+        for (auto *texture: {&material.normal,
+                             &material.metallicTexture,
+                             &material.roughnessTexture,
+                             &material.ambientOcclusionTexture,
+                             &material.albedoTexture}) {
+            if (texture->assigned()) {
+                ret.emplace_back(texture);
+            }
+        }
+        return ret;
+    }
+
+    MaterialTable::MaterialTable(FrameGraphTextureAtlas &atlas)
+            : atlas(atlas) {
+        Entry entry;
+        entry.material = &defaultMaterial;
+        entries.emplace_back(std::move(entry));
+        shaderData.emplace_back();
+        resolve(entries.at(DEFAULT_MATERIAL));
+    }
+
+    uint32_t MaterialTable::getMaterial(const ResourceHandle<Material> &material) {
+        if (!material.assigned()) {
+            return DEFAULT_MATERIAL;
+        }
+
+        auto it = materials.find(material.getUri());
+        if (it == materials.end()) {
+            uint32_t id;
+            if (freeIds.empty()) {
+                id = static_cast<uint32_t>(entries.size());
+                entries.emplace_back();
+                shaderData.emplace_back();
+            } else {
+                id = freeIds.back();
+                freeIds.pop_back();
+            }
+            it = materials.insert({material.getUri(), id}).first;
+
+            auto &entry = entries.at(id);
+            entry.handle = material;
+            entry.material = nullptr;
+        }
+
+        auto &entry = entries.at(it->second);
+        if (!entry.used) {
+            // The handle is only resolved on the first use in a frame so that reloaded resources are picked up.
+            // The generation is read before resolving so that a reload during this call is picked up by the next frame.
+            auto generation = entry.handle.getGeneration();
+            auto &data = entry.handle.get();
+            if (entry.material == nullptr || entry.generation != generation || hasReloadedTextures(entry)) {
+                entry.material = &data;
+                entry.generation = generation;
+                resolve(entry);
+            }
+            entry.used = true;
+        }
+
+        return it->second;
+    }
+
+    FrameGraphResource MaterialTable::setup(FrameGraphBuilder &builder) {
+        std::vector<Uri> unused;
+        for (auto &pair: materials) {
+            auto &entry = entries.at(pair.second);
+            if (!entry.used) {
+                unused.emplace_back(pair.first);
+            }
+            entry.used = false;
+        }
+
+        for (auto &uri: unused) {
+            auto id = materials.at(uri);
+            auto &entry = entries.at(id);
+            releaseTextures(entry);
+            {
+                // Swapped out so that the reference is released by the destructor
+                ResourceHandle<Material> released;
+                std::swap(entry.handle, released);
+            }
+            entry.material = nullptr;
+            shaderData.at(id) = {};
+            dirtyIds.erase(id);
+            freeIds.emplace_back(id);
+            materials.erase(uri);
+        }
+
+        if (!buffer.assigned || bufferCapacity < entries.size()) {
+            size_t capacity = std::max<size_t>(bufferCapacity, 1);
+            while (capacity < entries.size()) {
+                capacity *= 2;
+            }
+            buffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                    .size = sizeof(ShaderMaterial) * capacity
+            });
+            bufferCapacity = capacity;
+
+            // The contents of the previous buffer are not copied
+            for (uint32_t id = 0; id < entries.size(); id++) {
+                dirtyIds.insert(id);
+            }
+        }
+
+        builder.persist(buffer);
+
+        // Upload contiguous ranges of changed entries
+        auto it = dirtyIds.begin();
+        while (it != dirtyIds.end()) {
+            auto start = *it;
+            auto end = start + 1;
+            ++it;
+            while (it != dirtyIds.end() && *it == end) {
+                end++;
+                ++it;
+            }
+            std::vector<ShaderMaterial> range(shaderData.begin() + start, shaderData.begin() + end);
+            builder.upload(buffer,
+                           sizeof(ShaderMaterial) * start,
+                           [range]() {
+                               return FrameGraphUploadBuffer::createArray(range);
+                           });
+        }
+        dirtyIds.clear();
+
+        return buffer;
+    }
+
+    void MaterialTable::resolve(Entry &entry) {
+        auto id = static_cast<uint32_t>(&entry - entries.data());
+
+        // Textures of the previous resource data are released after adding the new references
+        // so that textures which are still used are not removed from the atlas.
+        auto previousTextures = std::move(entry.textures);
+        entry.textures.clear();
+
+        auto &material = *entry.material;
+        ShaderMaterial data;
+
+        // Added in the order of getTextureHandles
+
+        data.metallic_roughness_ambientOcclusion[0] = material.metallic;
+        data.metallic_roughness_ambientOcclusion[1] = material.roughness;
+        data.metallic_roughness_ambientOcclusion[2] = material.ambientOcclusion;
+
+        auto col = material.albedo.divide().getMemory();
+        data.albedoColor[0] = col[0];
+        data.albedoColor[1] = col[1];
+        data.albedoColor[2] = col[2];
+        data.albedoColor[3] = col[3];
+
+        data.normalIntensity[0] = material.normalIntensity;
+
+        if (material.normal.assigned()) {
+            data.normal = getTexture(material.normal, entry);
+        }
+        if (material.metallicTexture.assigned()) {
+            data.metallic = getTexture(material.metallicTexture, entry);
+        }
+        if (material.roughnessTexture.assigned()) {
+            data.roughness = getTexture(material.roughnessTexture, entry);
+        }
+        if (material.ambientOcclusionTexture.assigned()) {
+            data.ambientOcclusion = getTexture(material.ambientOcclusionTexture, entry);
+        }
+        if (material.albedoTexture.assigned()) {
+            data.albedo = getTexture(material.albedoTexture, entry);
+        }
+
+        std::swap(previousTextures, entry.textures);
+        releaseTextures(entry);
+        entry.textures = std::move(previousTextures);
+
+        shaderData.at(id) = data;
+        dirtyIds.insert(id);
+    }
+
+    bool MaterialTable::hasReloadedTextures(const Entry &entry) const {
+        auto handles = getTextureHandles(*entry.material);
+        for (size_t i = 0; i < handles.size(); i++) {
+            if (handles.at(i)->getGeneration() != entry.textures.at(i).generation) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void MaterialTable::releaseTextures(Entry &entry) {
+        for (auto &entryTexture: entry.textures) {
+            auto &texture = textures.at(entryTexture.uri);
+            if (--texture.refCount == 0) {
+                atlas.remove(texture.handle);
+                textures.erase(entryTexture.uri);
+            }
+        }
+        entry.textures.clear();
+    }
+
+    MaterialTable::ShaderAtlasTexture MaterialTable::getTexture(const ResourceHandle<Texture> &texture, Entry &entry) {
+        auto generation = texture.getGeneration();
+        auto &tex = texture.get();
+
+        auto it = textures.find(texture.getUri());
+        if (it == textures.end()) {
+            it = textures.insert({texture.getUri(), TextureEntry{atlas.add(tex.image.get()), 0, generation}}).first;
+        } else if (it->second.generation != generation) {
+            // The texture was reloaded, the other materials referencing it are resolved again on their next use
+            atlas.remove(it->second.handle);
+            it->second.handle = atlas.add(tex.image.get());
+            it->second.generation = generation;
+        }
+        it->second.refCount++;
+        entry.textures.emplace_back(EntryTexture{texture.getUri(), generation});
+
+        auto &handle = it->second.handle;
+
+        ShaderAtlasTexture ret;
+        ret.level_index_filtering_assigned[0] = handle.level;
+        ret.level_index_filtering_assigned[1] = static_cast<int>(handle.index);
+        ret.level_index_filtering_assigned[2] = tex.description.filterMag;
+        ret.level_index_filtering_assigned[3] = 1;
+
+        auto atlasScale = handle.size.convert<float>()
+                          / TextureAtlas::getResolutionLevelSize(handle.level).convert<float>();
+
+        ret.atlasScale_texSize[0] = atlasScale.x;
+        ret.atlasScale_texSize[1] = atlasScale.y;
+        ret.atlasScale_texSize[2] = static_cast<float>(handle.size.x);
+        ret.atlasScale_texSize[3] = static_cast<float>(handle.size.y);
+        return ret;
+    }
+}
@@ -0,0 +1,112 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/graph/meshlodselector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "xng/math/rotation.hpp"
+
+namespace xng {
+    void MeshLodSelector::beginFrame(const Camera &camera,
+                                     const Transform &cameraTransform,
+                                     const Vec2i &resolution,
+                                     float lodThreshold,
+                                     float lodHysteresis) {
+        for (auto it = states.begin(); it != states.end();) {
+            if (it->second.frame != frame) {
+                it = states.erase(it);
+            } else {
+                it++;
+            }
+        }
+        frame++;
+
+        cameraType = camera.type;
+        cameraPosition = cameraTransform.getPosition();
+        nearClip = camera.nearClip;
+        threshold = lodThreshold;
+        hysteresis = std::clamp(lodHysteresis, 0.0f, 1.0f);
+
+        auto height = static_cast<float>(resolution.y);
+        if (camera.type == ORTHOGRAPHIC) {
+            projectionScale = height / std::max(std::abs(camera.top - camera.bottom), std::numeric_limits<float>::epsilon());
+        } else {
+            projectionScale = height / (2 * std::tan(degreesToRadians(camera.fov) / 2));
+        }
+    }
+
+    size_t MeshLodSelector::select(uint64_t object,
+                                   const MeshAllocator::MeshAllocation &mesh,
+                                   const Transform &transform,
+                                   size_t bias) {
+        auto &state = states[object];
+        state.frame = frame;
+
+        auto &errors = mesh.lodErrors;
+        if (errors.size() < 2) {
+            state.lod = 0;
+            return 0;
+        }
+
+        auto &scale = transform.getScale();
+        auto maxScale = std::max({std::abs(scale.x), std::abs(scale.y), std::abs(scale.z)});
+
+        auto center = transform.model() * Vec4f(mesh.bounds.x, mesh.bounds.y, mesh.bounds.z, 1);
+        auto distance = Vec3f(center.x, center.y, center.z).distance(cameraPosition) - mesh.bounds.w * maxScale;
+
+        auto pixels = getPixelsPerUnit(std::max(distance, nearClip)) * maxScale;
+
+        auto fits = [&](size_t lod, float maxPixels) {
+            return errors.at(lod) * pixels <= maxPixels;
+        };
+
+        auto lod = std::min(state.lod, errors.size() - 1);
+        if (!fits(lod, threshold)) {
+            while (lod > 0 && !fits(lod, threshold)) {
+                lod--;
+            }
+        } else {
+            while (lod + 1 < errors.size() && fits(lod + 1, threshold * (1 - hysteresis))) {
+                lod++;
+            }
+        }
+        state.lod = lod;
+
+        return std::min(lod + bias, errors.size() - 1);
+    }
+
+    uint64_t MeshLodSelector::getObjectId(const SkinnedMeshProperty &property, size_t nodeIndex) {
+        if (property.objectId >= 0) {
+            return static_cast<uint64_t>(property.objectId);
+        } else {
+            return (static_cast<uint64_t>(1) << 63) | nodeIndex;
+        }
+    }
+
+    float MeshLodSelector::getPixelsPerUnit(float distance) const {
+        if (cameraType == ORTHOGRAPHIC) {
+            return projectionScale;
+        } else {
+            return projectionScale / distance;
+        }
+    }
+}
@@ -19,6 +19,7 @@
 
 #include "xng/render/graph/passes/constructionpass.hpp"
 #include "xng/render/graph/framegraphbuilder.hpp"
+#include "xng/render/graph/framegraphsettings.hpp"
 
 #include "xng/render/atlas/textureatlas.hpp"
 
@@ -26,35 +27,34 @@
 
 #include "graph/constructionpass_vs.hpp" // Generated by cmake
 #include "graph/constructionpass_vs_skinned.hpp" // Generated by cmake
+#include "graph/constructionpass_vs_skinned_compact.hpp" // Generated by cmake
 #include "graph/constructionpass_fs.hpp" // Generated by cmake
 
 namespace xng {
 #pragma pack(push, 1)
-    struct ShaderAtlasTexture {
-        int level_index_filtering_assigned[4]{0, 0, 0, 0};
-        float atlasScale_texSize[4]{0, 0, 0, 0};
-    };
-
     struct ShaderDrawData {
         Mat4f model;
         Mat4f mvp;
 
-        int objectID_boneOffset_shadows[4]{0, 0, 0, 0};
-
-        float metallic_roughness_ambientOcclusion[4]{0, 0, 0, 0};
-        float albedoColor[4]{0, 0, 0, 0};
+        int objectID_boneOffset_shadows_material[4]{0, 0, 0, 0};
 
-        float normalIntensity[4]{0, 0, 0, 0};
-
-        ShaderAtlasTexture normal;
-
-        ShaderAtlasTexture metallic;
-        ShaderAtlasTexture roughness;
-        ShaderAtlasTexture ambientOcclusion;
-        ShaderAtlasTexture albedo;
+        float positionOffset[4]{0, 0, 0, 0};
+        float positionScale[4]{1, 1, 1, 1};
     };
 #pragma pack(pop)
 
+    static const ResourceHandle<Material> &getMaterialHandle(const Mesh &mesh,
+                                                             const MaterialProperty *property,
+                                                             size_t index) {
+        if (property != nullptr) {
+            auto it = property->materials.find(index);
+            if (it != property->materials.end()) {
+                return it->second;
+            }
+        }
+        return mesh.material;
+    }
+
     void ConstructionPass::setup(FrameGraphBuilder &builder) {
         auto resolution = builder.getRenderResolution();
 
@@ -75,7 +75,10 @@ namespace xng {
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_TEXTURE_ARRAY_BUFFER,
-                            BIND_TEXTURE_ARRAY_BUFFER
+                            BIND_TEXTURE_ARRAY_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
                     .vertexLayout = Mesh::getDefaultVertexLayout(),
                     .enableDepthTest = true,
@@ -87,9 +90,25 @@ namespace xng {
         }
         builder.persist(renderPipeline);
 
+        auto compactVertexLayout = builder.getSettings().get<bool>(FrameGraphSettings::SETTING_COMPACT_VERTEX_LAYOUT);
+        auto vertexLayout = compactVertexLayout
+                            ? SkinnedMesh::getCompactVertexLayout()
+                            : SkinnedMesh::getDefaultVertexLayout();
+        if (meshAllocator.getVertexLayout() != vertexLayout) {
+            // The meshes are uploaded again in the new layout
+            meshAllocator = MeshAllocator(vertexLayout);
+            renderPipelineSkinned = {};
+            vertexBuffer = {};
+            indexBuffer = {};
+            currentVertexBufferSize = 0;
+            currentIndexBufferSize = 0;
+        }
+
         if (!renderPipelineSkinned.assigned) {
             renderPipelineSkinned = builder.createRenderPipeline(RenderPipelineDesc{
-                    .shaders = {{VERTEX,   constructionpass_vs_skinned},
+                    .shaders = {{VERTEX,   compactVertexLayout
+                                           ? constructionpass_vs_skinned_compact
+                                           : constructionpass_vs_skinned},
                                 {FRAGMENT, constructionpass_fs}},
                     .bindings = {
                             BIND_SHADER_STORAGE_BUFFER,
@@ -106,8 +125,10 @@ namespace xng {
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
-                    .vertexLayout = SkinnedMesh::getDefaultVertexLayout(),
+                    .vertexLayout = vertexLayout,
                     .enableDepthTest = true,
                     .depthTestWrite = true,
                     .depthTestMode = DEPTH_TEST_LESS,
@@ -139,91 +160,52 @@ namespace xng {
         auto gBufferDepth = builder.createTextureBuffer(desc);
 
         std::vector<Node> objects;
+        std::vector<std::vector<uint32_t>> objectMaterials; // The material ids of the meshes of each object
         size_t totalShaderBufferSize = 0;
 
-        std::set<Uri> usedTextures;
         std::set<Uri> usedMeshes;
 
-        size_t boneCount = 0;
-
         auto tmp = builder.getScene().rootNode.findAll({typeid(SkinnedMeshProperty)});
         for (auto id = 0; id < tmp.size(); id++) {
             auto &object = tmp.at(id);
             auto &meshProp = object.getProperty<SkinnedMeshProperty>();
             if (meshProp.mesh.assigned()) {
+                const MaterialProperty *matProp = nullptr;
                 auto it = object.properties.find(typeid(MaterialProperty));
-                MaterialProperty matProp;
                 if (it != object.properties.end()) {
-                    matProp = it->second->get<MaterialProperty>();
+                    matProp = &it->second->get<MaterialProperty>();
                 }
 
                 meshAllocator.prepareMeshAllocation(meshProp.mesh);
                 usedMeshes.insert(meshProp.mesh.getUri());
 
-                for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
-                    const Mesh& mesh = i == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
+                auto &skinnedMesh = meshProp.mesh.get();
 
-                    Material mat = mesh.material.get();
+                std::vector<uint32_t> meshMaterials;
+                for (auto i = 0; i < skinnedMesh.subMeshes.size() + 1; i++) {
+                    const Mesh &mesh = i == 0 ? skinnedMesh : skinnedMesh.subMeshes.at(i - 1);
 
-                    auto mi = matProp.materials.find(i);
-                    if (mi != matProp.materials.end()) {
-                        mat = mi->second.get();
-                    }
+                    auto materialId = materials.getMaterial(getMaterialHandle(mesh, matProp, i));
+                    meshMaterials.emplace_back(materialId);
 
-                    if (mat.transparent) {
+                    if (materials.get(materialId).transparent) {
                         continue;
                     }
 
-                    boneCount += mesh.bones.size();
-
-                    if (mat.normal.assigned()) {
-                        if (textures.find(mat.normal.getUri()) == textures.end()) {
-                            textures[mat.normal.getUri()] = atlas.add(mat.normal.get().image.get());
-                        }
-                        usedTextures.insert(mat.normal.getUri());
-                    }
-                    if (mat.metallicTexture.assigned()) {
-                        if (textures.find(mat.metallicTexture.getUri()) == textures.end()) {
-                            textures[mat.metallicTexture.getUri()] = atlas.add(mat.metallicTexture.get().image.get());
-                        }
-                        usedTextures.insert(mat.metallicTexture.getUri());
-                    }
-                    if (mat.roughnessTexture.assigned()) {
-                        if (textures.find(mat.roughnessTexture.getUri()) == textures.end()) {
-                            textures[mat.roughnessTexture.getUri()] = atlas.add(mat.roughnessTexture.get().image.get());
-                        }
-                        usedTextures.insert(mat.roughnessTexture.getUri());
-                    }
-                    if (mat.ambientOcclusionTexture.assigned()) {
-                        if (textures.find(mat.ambientOcclusionTexture.getUri()) == textures.end()) {
-                            textures[mat.ambientOcclusionTexture.getUri()] = atlas.add(
-                                    mat.ambientOcclusionTexture.get().image.get());
-                        }
-                        usedTextures.insert(mat.ambientOcclusionTexture.getUri());
-                    }
-                    if (mat.albedoTexture.assigned()) {
-                        if (textures.find(mat.albedoTexture.getUri()) == textures.end()) {
-                            textures[mat.albedoTexture.getUri()] = atlas.add(mat.albedoTexture.get().image.get());
-                        }
-                        usedTextures.insert(mat.albedoTexture.getUri());
-                    }
-
                     totalShaderBufferSize += sizeof(ShaderDrawData);
                 }
                 objects.emplace_back(object);
+                objectMaterials.emplace_back(std::move(meshMaterials));
             }
         }
 
+        auto materialBuffer = materials.setup(builder);
+
         auto shaderBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
                 .bufferType = RenderBufferType::HOST_VISIBLE,
                 .size = totalShaderBufferSize
         });
 
-        auto boneBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .bufferType = RenderBufferType::HOST_VISIBLE,
-                .size = sizeof(Mat4f) * boneCount
-        });
-
         atlas.setup(builder);
 
         if (vertexBuffer.assigned) {
@@ -283,75 +265,44 @@ namespace xng {
             meshAllocator.deallocateMesh(ResourceHandle<SkinnedMesh>(uri));
         }
 
-        // Deallocate unused textures
-        dealloc.clear();
-        for (auto &pair: textures) {
-            if (usedTextures.find(pair.first) == usedTextures.end()) {
-                dealloc.insert(pair.first);
-            }
-        }
-        for (auto &uri: dealloc) {
-            deallocateTexture(ResourceHandle<Texture>(uri));
-        }
-
         // Draw geometry buffer
         auto projection = camera.projection();
         auto view = Camera::view(cameraTransform);
 
+        lodSelector.beginFrame(camera,
+                               cameraTransform,
+                               resolution,
+                               builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_THRESHOLD),
+                               builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_HYSTERESIS));
+
         std::vector<DrawCall> drawCalls;
         std::vector<size_t> baseVertices;
         std::vector<ShaderDrawData> shaderData;
-        std::vector<Mat4f> boneMatrices;
+        std::vector<uint32_t> boneIndices;
+
+        bonePalette.releaseUnused();
 
         for (auto oi = 0; oi < objects.size(); oi++) {
             auto &node = objects.at(oi);
             auto &meshProp = node.getProperty<SkinnedMeshProperty>();
 
-            auto rig = meshProp.mesh.get().rig;
-
-            std::map<std::string, Mat4f> boneTransforms;
-            auto it = node.properties.find(typeid(BoneTransformsProperty));
-            if (it != node.properties.end()) {
-                boneTransforms = it->second->get<BoneTransformsProperty>().boneTransforms;
-            }
-
-            std::map<size_t, ResourceHandle<Material>> mats;
-            it = node.properties.find(typeid(MaterialProperty));
-            if (it != node.properties.end()) {
-                mats = it->second->get<MaterialProperty>().materials;
-            }
+            auto &meshMaterials = objectMaterials.at(oi);
 
             auto drawData = meshAllocator.getAllocatedMesh(meshProp.mesh);
 
+            auto lod = lodSelector.select(MeshLodSelector::getObjectId(meshProp, oi), drawData, node.getProperty<TransformProperty>().transform);
+
             for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
                 auto model = node.getProperty<TransformProperty>().transform.model();
 
                 const Mesh& mesh = i == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
 
-                auto material = mesh.material.get();
-
-                auto mIt = mats.find(i);
-                if (mIt != mats.end()) {
-                    material = mIt->second.get();
-                }
-
-                if (material.transparent) {
+                auto materialId = meshMaterials.at(i);
+                if (materials.get(materialId).transparent) {
                     continue;
                 }
 
-                auto boneOffset = boneMatrices.size();
-                if (mesh.bones.empty()) {
-                    boneOffset = -1;
-                } else {
-                    for (auto &bone: mesh.bones) {
-                        auto bt = boneTransforms.find(bone);
-                        if (bt != boneTransforms.end()) {
-                            boneMatrices.emplace_back(bt->second);
-                        } else {
-                            boneMatrices.emplace_back(MatrixMath::identity());
-                        }
-                    }
-                }
+                auto boneOffset = bonePalette.addBoneIndices(builder.getScene(), node, i, boneIndices);
 
                 bool receiveShadows = true;
                 if (node.hasProperty<ShadowProperty>()) {
@@ -362,115 +313,36 @@ namespace xng {
 
                 data.model = model;
                 data.mvp = projection * view * model;
-                data.objectID_boneOffset_shadows[0] = static_cast<int>(oi);
-                data.objectID_boneOffset_shadows[1] = static_cast<int>(boneOffset);
-                data.objectID_boneOffset_shadows[2] = receiveShadows;
-
-                data.metallic_roughness_ambientOcclusion[0] = material.metallic;
-                data.metallic_roughness_ambientOcclusion[1] = material.roughness;
-                data.metallic_roughness_ambientOcclusion[2] = material.ambientOcclusion;
-
-                auto col = material.albedo.divide().getMemory();
-                data.albedoColor[0] = col[0];
-                data.albedoColor[1] = col[1];
-                data.albedoColor[2] = col[2];
-                data.albedoColor[3] = col[3];
-
-                data.normalIntensity[0] = material.normalIntensity;
-
-                if (material.metallicTexture.assigned()) {
-                    auto tex = getTexture(material.metallicTexture, atlasBuffers);
-
-                    data.metallic.level_index_filtering_assigned[0] = tex.level;
-                    data.metallic.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                    data.metallic.level_index_filtering_assigned[2] = material.metallicTexture.get().description.filterMag;
-                    data.metallic.level_index_filtering_assigned[3] = 1;
-
-                    auto atlasScale = tex.size.convert<float>()
-                                      / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                    data.metallic.atlasScale_texSize[0] = atlasScale.x;
-                    data.metallic.atlasScale_texSize[1] = atlasScale.y;
-                    data.metallic.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                    data.metallic.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                }
-
-                if (material.roughnessTexture.assigned()) {
-                    auto tex = getTexture(material.roughnessTexture, atlasBuffers);
-
-                    data.roughness.level_index_filtering_assigned[0] = tex.level;
-                    data.roughness.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                    data.roughness.level_index_filtering_assigned[2] = material.roughnessTexture.get().description.filterMag;
-                    data.roughness.level_index_filtering_assigned[3] = 1;
-
-                    auto atlasScale = tex.size.convert<float>()
-                                      / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                    data.roughness.atlasScale_texSize[0] = atlasScale.x;
-                    data.roughness.atlasScale_texSize[1] = atlasScale.y;
-                    data.roughness.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                    data.roughness.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                }
-
-                if (material.ambientOcclusionTexture.assigned()) {
-                    auto tex = getTexture(material.ambientOcclusionTexture, atlasBuffers);
-
-                    data.ambientOcclusion.level_index_filtering_assigned[0] = tex.level;
-                    data.ambientOcclusion.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                    data.ambientOcclusion.level_index_filtering_assigned[2] = material.ambientOcclusionTexture.get().description.filterMag;
-                    data.ambientOcclusion.level_index_filtering_assigned[3] = 1;
-
-                    auto atlasScale = tex.size.convert<float>()
-                                      / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
+                data.objectID_boneOffset_shadows_material[0] = static_cast<int>(oi);
+                data.objectID_boneOffset_shadows_material[1] = boneOffset;
+                data.objectID_boneOffset_shadows_material[2] = receiveShadows;
+                data.objectID_boneOffset_shadows_material[3] = static_cast<int>(materialId);
 
-                    data.ambientOcclusion.atlasScale_texSize[0] = atlasScale.x;
-                    data.ambientOcclusion.atlasScale_texSize[1] = atlasScale.y;
-                    data.ambientOcclusion.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                    data.ambientOcclusion.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                }
-
-                if (material.albedoTexture.assigned()) {
-                    auto tex = getTexture(material.albedoTexture, atlasBuffers);
-
-                    data.albedo.level_index_filtering_assigned[0] = tex.level;
-                    data.albedo.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                    data.albedo.level_index_filtering_assigned[2] = material.albedoTexture.get().description.filterMag;
-                    data.albedo.level_index_filtering_assigned[3] = 1;
-
-                    auto atlasScale = tex.size.convert<float>()
-                                      / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                    data.albedo.atlasScale_texSize[0] = atlasScale.x;
-                    data.albedo.atlasScale_texSize[1] = atlasScale.y;
-                    data.albedo.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                    data.albedo.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                }
-
-                if (material.normal.assigned()) {
-                    auto tex = getTexture(material.normal, atlasBuffers);
-
-                    data.normal.level_index_filtering_assigned[0] = tex.level;
-                    data.normal.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                    data.normal.level_index_filtering_assigned[2] = material.normal.get().description.filterMag;
-                    data.normal.level_index_filtering_assigned[3] = 1;
-
-                    auto atlasScale = tex.size.convert<float>()
-                                      / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
+                auto &draw = drawData.data.at(i);
 
-                    data.normal.atlasScale_texSize[0] = atlasScale.x;
-                    data.normal.atlasScale_texSize[1] = atlasScale.y;
-                    data.normal.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                    data.normal.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                }
+                data.positionOffset[0] = draw.positionOffset.x;
+                data.positionOffset[1] = draw.positionOffset.y;
+                data.positionOffset[2] = draw.positionOffset.z;
+                data.positionScale[0] = draw.positionScale.x;
+                data.positionScale[1] = draw.positionScale.y;
+                data.positionScale[2] = draw.positionScale.z;
 
                 shaderData.emplace_back(data);
 
-                auto &draw = drawData.data.at(i);
-                drawCalls.emplace_back(draw.drawCall);
+                drawCalls.emplace_back(draw.getDrawCall(lod));
                 baseVertices.emplace_back(draw.baseVertex);
             }
         }
 
+        auto paletteBuffer = FrameGraphBonePalette::getPaletteBuffer(builder);
+
+        // Keeps the index buffer from being empty when no skinned meshes are drawn
+        boneIndices.emplace_back(0);
+        auto boneIndexBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = RenderBufferType::HOST_VISIBLE,
+                .size = sizeof(uint32_t) * boneIndices.size()
+        });
+
         builder.beginPass({
                                   FrameGraphAttachment::texture(gBufferPosition),
                                   FrameGraphAttachment::texture(gBufferNormal),
@@ -492,13 +364,13 @@ namespace xng {
                                return FrameGraphUploadBuffer::createArray(shaderData);
                            });
 
-            builder.upload(boneBuffer,
-                           [boneMatrices]() {
-                               return FrameGraphUploadBuffer::createArray(boneMatrices);
+            builder.upload(boneIndexBuffer,
+                           [boneIndices]() {
+                               return FrameGraphUploadBuffer::createArray(boneIndices);
                            });
 
             builder.bindPipeline(renderPipelineSkinned);
-            builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, SkinnedMesh::getDefaultVertexLayout(), {});
+            builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, vertexLayout, {});
             builder.bindShaderResources(std::vector<FrameGraphCommand::ShaderData>{
                     {shaderBuffer,                               {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
                     {atlasBuffers.at(TEXTURE_ATLAS_8x8),         {{{FRAGMENT, ShaderResource::READ}}}},
@@ -513,7 +385,9 @@ namespace xng {
                     {atlasBuffers.at(TEXTURE_ATLAS_4096x4096),   {{{FRAGMENT, ShaderResource::READ}}}},
                     {atlasBuffers.at(TEXTURE_ATLAS_8192x8192),   {{{FRAGMENT, ShaderResource::READ}}}},
                     {atlasBuffers.at(TEXTURE_ATLAS_16384x16384), {{{FRAGMENT, ShaderResource::READ}}}},
-                    {boneBuffer,                                 {{VERTEX, ShaderResource::READ}}},
+                    {paletteBuffer,                              {{VERTEX, ShaderResource::READ}}},
+                    {materialBuffer,                             {{FRAGMENT, ShaderResource::READ}}},
+                    {boneIndexBuffer,                            {{VERTEX, ShaderResource::READ}}},
             });
 
             builder.multiDrawIndexed(drawCalls, baseVertices);
@@ -525,18 +399,4 @@ namespace xng {
     std::type_index ConstructionPass::getTypeIndex() const {
         return typeid(ConstructionPass);
     }
-
-    TextureAtlasHandle ConstructionPass::getTexture(const ResourceHandle<Texture> &texture,
-                                                    std::map<TextureAtlasResolution, FrameGraphResource> &atlasBuffers) {
-        if (textures.find(texture.getUri()) == textures.end()) {
-            auto handle = atlas.add(texture.get().image.get());
-            textures[texture.getUri()] = handle;
-        }
-        return textures.at(texture.getUri());
-    }
-
-    void ConstructionPass::deallocateTexture(const ResourceHandle<Texture> &texture) {
-        atlas.remove(textures.at(texture.getUri()));
-        textures.erase(texture.getUri());
-    }
 }
@@ -55,7 +55,7 @@ namespace xng {
     };
 #pragma pack(pop)
 
-    static std::pair<std::vector<PointLightData>, std::vector<PointLightData>> getPointLights(const Scene &scene) {
+    static std::pair<std::vector<PointLightData>, std::vector<PointLightData>> getPointLights(const Scene &scene, float threshold) {
         std::vector<PointLightData> lights;
         std::vector<PointLightData> shadowLights;
         for (auto &node: scene.rootNode.findAll({typeid(PointLightProperty)})) {
@@ -68,7 +68,7 @@ namespace xng {
                                        t.getPosition().z,
                                        0).getMemory(),
                     .color = Vec4f(v.x * l.power, v.y * l.power, v.z * l.power, 1).getMemory(),
-                    .farPlane = Vec4f(l.shadowFarPlane, 0, 0, 0).getMemory()
+                    .farPlane = Vec4f(l.shadowFarPlane, LightClusterGrid::getRadius(l, threshold), 0, 0).getMemory()
             };
             if (l.castShadows)
                 shadowLights.emplace_back(tmp);
@@ -105,7 +105,7 @@ namespace xng {
         return std::cos(degreesToRadians(angleDegrees));
     }
 
-    static std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> getSpotLights(const Scene &scene) {
+    static std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> getSpotLights(const Scene &scene, float threshold) {
         std::vector<SpotLightData> lights;
         std::vector<SpotLightData> shadowLights;
         for (auto &node: scene.rootNode.findAll({typeid(SpotLightProperty)})) {
@@ -122,7 +122,7 @@ namespace xng {
                                                   l.direction.z,
                                                   l.quadratic).getMemory(),
                     .color = Vec4f(v.x * l.power, v.y * l.power, v.z * l.power, 1).getMemory(),
-                    .farPlane = Vec4f(l.shadowFarPlane, 0, 0, 0).getMemory(),
+                    .farPlane = Vec4f(l.shadowFarPlane, LightClusterGrid::getRadius(l, threshold), 0, 0).getMemory(),
                     .cutOff_outerCutOff_constant_linear = Vec4f(getCutOff(l.cutOff),
                                                                 getCutOff(l.outerCutOff),
                                                                 l.constant,
@@ -136,6 +136,41 @@ namespace xng {
         return {lights, shadowLights};
     }
 
+    static std::vector<LightClusterGrid::LightBounds> getLightBounds(
+            const std::pair<std::vector<PointLightData>, std::vector<PointLightData>> &pointLights,
+            const std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> &spotLights) {
+        std::vector<LightClusterGrid::LightBounds> ret;
+        auto add = [&ret](const std::array<float, 4> &position,
+                          const std::array<float, 4> &farPlane,
+                          LightClusterGrid::LightType type,
+                          size_t index) {
+            ret.emplace_back(LightClusterGrid::LightBounds{
+                    .position = Vec3f(position.at(0), position.at(1), position.at(2)),
+                    .radius = farPlane.at(1),
+                    .index = LightClusterGrid::encodeLightIndex(type, static_cast<uint32_t>(index))
+            });
+        };
+        for (size_t i = 0; i < pointLights.first.size(); i++) {
+            add(pointLights.first.at(i).position, pointLights.first.at(i).farPlane, LightClusterGrid::LIGHT_POINT, i);
+        }
+        for (size_t i = 0; i < pointLights.second.size(); i++) {
+            add(pointLights.second.at(i).position,
+                pointLights.second.at(i).farPlane,
+                LightClusterGrid::LIGHT_POINT_SHADOW,
+                i);
+        }
+        for (size_t i = 0; i < spotLights.first.size(); i++) {
+            add(spotLights.first.at(i).position, spotLights.first.at(i).farPlane, LightClusterGrid::LIGHT_SPOT, i);
+        }
+        for (size_t i = 0; i < spotLights.second.size(); i++) {
+            add(spotLights.second.at(i).position,
+                spotLights.second.at(i).farPlane,
+                LightClusterGrid::LIGHT_SPOT_SHADOW,
+                i);
+        }
+        return ret;
+    }
+
     void DeferredLightingPass::setup(FrameGraphBuilder &builder) {
         auto scene = builder.getScene();
 
@@ -184,6 +219,10 @@ namespace xng {
                                  BIND_SHADER_STORAGE_BUFFER,
                                  BIND_SHADER_STORAGE_BUFFER,
                                  BIND_SHADER_STORAGE_BUFFER,
+                                 BIND_SHADER_STORAGE_BUFFER,
+                                 BIND_SHADER_STORAGE_BUFFER,
+                                 BIND_SHADER_STORAGE_BUFFER,
+                                 BIND_SHADER_STORAGE_BUFFER,
                     },
                     .primitive = TRIANGLES,
                     .vertexLayout = quadMesh.vertexLayout,
@@ -216,24 +255,10 @@ namespace xng {
         size_t dirLightCount = 0;
         size_t shadowDirLightCount = 0;
 
-        std::vector<Mat4f> dirShadowMatrices;
-        std::vector<Mat4f> spotShadowMatrices;
-
         for (auto l: dirLightNodes) {
-            if (l.getProperty<DirectionalLightProperty>().light.castShadows) {
-                auto &light = l.getProperty<DirectionalLightProperty>().light;
-                dirShadowMatrices.emplace_back(MatrixMath::ortho(-light.shadowProjectionExtent,
-                                                                 light.shadowProjectionExtent,
-                                                                 -light.shadowProjectionExtent,
-                                                                 light.shadowProjectionExtent,
-                                                                 light.shadowNearPlane,
-                                                                 light.shadowFarPlane)
-                                               * MatrixMath::lookAt(
-                        Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y),
-                        Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y) + light.direction,
-                        Vec3f(0, 1, 0)));
+            if (l.getProperty<DirectionalLightProperty>().light.castShadows)
                 shadowDirLightCount++;
-            } else
+            else
                 dirLightCount++;
         }
 
@@ -242,23 +267,10 @@ namespace xng {
         size_t spotLightCount = 0;
         size_t shadowSpotLightCount = 0;
 
-        auto spotShadowResolution = builder.getSettings().get<Vec2i>(
-                FrameGraphSettings::SETTING_SHADOW_MAPPING_SPOT_RESOLUTION);
-
         for (auto l: spotLightNodes) {
-            if (l.getProperty<SpotLightProperty>().light.castShadows) {
-                auto &transform = l.getProperty<TransformProperty>().transform;
-                auto &light = l.getProperty<SpotLightProperty>().light;
-                float aspect = (float) spotShadowResolution.x / (float) spotShadowResolution.y;
-                spotShadowMatrices.emplace_back(MatrixMath::perspective(45,
-                                                                        aspect,
-                                                                        light.shadowNearPlane,
-                                                                        light.shadowFarPlane)
-                                                * MatrixMath::lookAt(transform.getPosition(),
-                                                                     transform.getPosition() + light.direction,
-                                                                     Vec3f(0, 1, 0)));
+            if (l.getProperty<SpotLightProperty>().light.castShadows)
                 shadowSpotLightCount++;
-            } else
+            else
                 spotLightCount++;
         }
 
@@ -289,17 +301,11 @@ namespace xng {
                 .size = sizeof(SpotLightData) * shadowSpotLightCount
         });
 
-        auto dirShadowTransformBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .size = sizeof(Mat4f) * dirShadowMatrices.size()
-        });
-
-        auto spotShadowTransformBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .size = sizeof(Mat4f) * spotShadowMatrices.size()
-        });
+        auto lightThreshold = builder.getSettings().get<float>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_THRESHOLD);
 
-        auto pointLights = getPointLights(scene);
+        auto pointLights = getPointLights(scene, lightThreshold);
         auto dirLights = getDirLights(scene);
-        auto spotLights = getSpotLights(scene);
+        auto spotLights = getSpotLights(scene, lightThreshold);
 
         builder.upload(pointLightBuffer,
                        [pointLights]() {
@@ -328,15 +334,6 @@ namespace xng {
                            return FrameGraphUploadBuffer::createArray(spotLights.second);
                        });
 
-        builder.upload(dirShadowTransformBuffer,
-                       [dirShadowMatrices]() {
-                           return FrameGraphUploadBuffer::createArray(dirShadowMatrices);
-                       });
-        builder.upload(spotShadowTransformBuffer,
-                       [spotShadowMatrices]() {
-                           return FrameGraphUploadBuffer::createArray(spotShadowMatrices);
-                       });
-
         auto gBufferPosition = builder.getSlot(SLOT_GBUFFER_POSITION);
         auto gBufferNormal = builder.getSlot(SLOT_GBUFFER_NORMAL);
         auto gBufferRoughnessMetallicAO = builder.getSlot(SLOT_GBUFFER_ROUGHNESS_METALLIC_AO);
@@ -344,9 +341,45 @@ namespace xng {
         auto gBufferModelObject = builder.getSlot(SLOT_GBUFFER_OBJECT_SHADOWS);
         auto gBufferDepth = builder.getSlot(SLOT_GBUFFER_DEPTH);
 
+        auto camera = builder.getScene().rootNode.find<CameraProperty>().getProperty<CameraProperty>().camera;
         auto cameraTransform = builder.getScene().rootNode.find<CameraProperty>()
                 .getProperty<TransformProperty>().transform;
 
+        auto clusterTiles = builder.getSettings().get<Vec2i>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_TILES);
+        auto clusterSlices = builder.getSettings().get<int>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_SLICES);
+        if (lightClusters.getTilesX() != clusterTiles.x
+            || lightClusters.getTilesY() != clusterTiles.y
+            || lightClusters.getSlices() != clusterSlices) {
+            lightClusters = LightClusterGrid(clusterTiles.x, clusterTiles.y, clusterSlices);
+        }
+
+        lightClusters.build(camera, Camera::view(cameraTransform), resolution, getLightBounds(pointLights, spotLights));
+
+        auto lightClusterInfoBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(LightClusterInfo)
+        });
+
+        auto lightClusterBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(LightCluster) * lightClusters.getClusters().size()
+        });
+
+        auto lightIndexBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(uint32_t) * lightClusters.getLightIndices().size()
+        });
+
+        builder.upload(lightClusterInfoBuffer,
+                       [info = lightClusters.getInfo()]() {
+                           return FrameGraphUploadBuffer::createValue(info);
+                       });
+        builder.upload(lightClusterBuffer,
+                       [clusters = lightClusters.getClusters()]() {
+                           return FrameGraphUploadBuffer::createArray(clusters);
+                       });
+        builder.upload(lightIndexBuffer,
+                       [indices = lightClusters.getLightIndices()]() {
+                           return FrameGraphUploadBuffer::createArray(indices);
+                       });
+
         FrameGraphResource pointLightShadowMap{};
         if (builder.checkSlot(SLOT_SHADOW_MAP_POINT)) {
             pointLightShadowMap = builder.getSlot(FrameGraphSlot::SLOT_SHADOW_MAP_POINT);
@@ -364,6 +397,17 @@ namespace xng {
 
         auto defaultShadowMap = builder.createTextureArrayBuffer({});
 
+        // The layers and transforms of the shadow maps, lights without data are not shadowed
+        auto pointShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_POINT_DATA)
+                                     ? builder.getSlot(SLOT_SHADOW_MAP_POINT_DATA)
+                                     : builder.createShaderStorageBuffer({});
+        auto dirShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_DIRECTIONAL_DATA)
+                                   ? builder.getSlot(SLOT_SHADOW_MAP_DIRECTIONAL_DATA)
+                                   : builder.createShaderStorageBuffer({});
+        auto spotShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_SPOT_DATA)
+                                    ? builder.getSlot(SLOT_SHADOW_MAP_SPOT_DATA)
+                                    : builder.createShaderStorageBuffer({});
+
         builder.upload(shaderDataBuffer,
                        [cameraTransform, pointLightShadowMap]() {
                            ShaderStorageData buf;
@@ -400,8 +444,12 @@ namespace xng {
                                             {shadowDirLightBuffer,       {{FRAGMENT, ShaderResource::READ}}},
                                             {spotLightBuffer,            {{FRAGMENT, ShaderResource::READ}}},
                                             {shadowSpotLightBuffer,      {{FRAGMENT, ShaderResource::READ}}},
-                                            {dirShadowTransformBuffer,   {{FRAGMENT, ShaderResource::READ}}},
-                                            {spotShadowTransformBuffer,  {{FRAGMENT, ShaderResource::READ}}},
+                                            {dirShadowDataBuffer,        {{FRAGMENT, ShaderResource::READ}}},
+                                            {spotShadowDataBuffer,       {{FRAGMENT, ShaderResource::READ}}},
+                                            {lightClusterInfoBuffer,     {{FRAGMENT, ShaderResource::READ}}},
+                                            {lightClusterBuffer,         {{FRAGMENT, ShaderResource::READ}}},
+                                            {lightIndexBuffer,           {{FRAGMENT, ShaderResource::READ}}},
+                                            {pointShadowDataBuffer,      {{FRAGMENT, ShaderResource::READ}}},
                                     });
         builder.drawArray(DrawCall(0, quadMesh.vertices.size()));
         builder.finishPass();
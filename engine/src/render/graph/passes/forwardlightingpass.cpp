@@ -49,11 +49,6 @@ namespace xng {
         std::array<float, 4> cutOff_outerCutOff_constant_linear;
     };
 
-    struct ShaderAtlasTexture {
-        int level_index_filtering_assigned[4]{0, 0, 0, 0};
-        float atlasScale_texSize[4]{0, 0, 0, 0};
-    };
-
     struct ShaderViewData {
         std::array<float, 4> viewPosition;
         std::array<float, 4> viewSize;
@@ -63,24 +58,24 @@ namespace xng {
         Mat4f model;
         Mat4f mvp;
 
-        int objectID_shadows[4]{0, 0, 0, 0};
-
-        float metallic_roughness_ambientOcclusion[4]{0, 0, 0, 0};
-        float albedoColor[4]{0, 0, 0, 0};
-
-        float normalIntensity[4]{0, 0, 0, 0};
-
-        ShaderAtlasTexture normal;
-
-        ShaderAtlasTexture metallic;
-        ShaderAtlasTexture roughness;
-        ShaderAtlasTexture ambientOcclusion;
-        ShaderAtlasTexture albedo;
+        int objectID_shadows_material[4]{0, 0, 0, 0};
     };
 #pragma pack(pop)
 
+    static const ResourceHandle<Material> &getMaterialHandle(const Mesh &mesh,
+                                                             const MaterialProperty *property,
+                                                             size_t index) {
+        if (property != nullptr) {
+            auto it = property->materials.find(index);
+            if (it != property->materials.end()) {
+                return it->second;
+            }
+        }
+        return mesh.material;
+    }
+
     static std::pair<std::vector<PointLightData>, std::vector<PointLightData>>
-    getPointLights(const Scene &scene) {
+    getPointLights(const Scene &scene, float threshold) {
         std::vector<PointLightData> pointLights;
         std::vector<PointLightData> shadowLights;
         for (auto &node: scene.rootNode.findAll({typeid(PointLightProperty)})) {
@@ -93,7 +88,7 @@ namespace xng {
                                        t.getPosition().z,
                                        0).getMemory(),
                     .color = Vec4f(v.x * l.power, v.y * l.power, v.z * l.power, 1).getMemory(),
-                    .farPlane = Vec4f(l.shadowFarPlane, 0, 0, 0).getMemory(),
+                    .farPlane = Vec4f(l.shadowFarPlane, LightClusterGrid::getRadius(l, threshold), 0, 0).getMemory(),
             };
             if (l.castShadows)
                 shadowLights.emplace_back(tmp);
@@ -130,7 +125,7 @@ namespace xng {
         return std::cos(degreesToRadians(angleDegrees));
     }
 
-    static std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> getSpotLights(const Scene &scene) {
+    static std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> getSpotLights(const Scene &scene, float threshold) {
         std::vector<SpotLightData> lights;
         std::vector<SpotLightData> shadowLights;
         for (auto &node: scene.rootNode.findAll({typeid(SpotLightProperty)})) {
@@ -147,7 +142,7 @@ namespace xng {
                                                   l.direction.z,
                                                   l.quadratic).getMemory(),
                     .color = Vec4f(v.x * l.power, v.y * l.power, v.z * l.power, 1).getMemory(),
-                    .farPlane = Vec4f(l.shadowFarPlane, 0, 0, 0).getMemory(),
+                    .farPlane = Vec4f(l.shadowFarPlane, LightClusterGrid::getRadius(l, threshold), 0, 0).getMemory(),
                     .cutOff_outerCutOff_constant_linear = Vec4f(getCutOff(l.cutOff),
                                                                 getCutOff(l.outerCutOff),
                                                                 l.constant,
@@ -161,6 +156,41 @@ namespace xng {
         return {lights, shadowLights};
     }
 
+    static std::vector<LightClusterGrid::LightBounds> getLightBounds(
+            const std::pair<std::vector<PointLightData>, std::vector<PointLightData>> &pointLights,
+            const std::pair<std::vector<SpotLightData>, std::vector<SpotLightData>> &spotLights) {
+        std::vector<LightClusterGrid::LightBounds> ret;
+        auto add = [&ret](const std::array<float, 4> &position,
+                          const std::array<float, 4> &farPlane,
+                          LightClusterGrid::LightType type,
+                          size_t index) {
+            ret.emplace_back(LightClusterGrid::LightBounds{
+                    .position = Vec3f(position.at(0), position.at(1), position.at(2)),
+                    .radius = farPlane.at(1),
+                    .index = LightClusterGrid::encodeLightIndex(type, static_cast<uint32_t>(index))
+            });
+        };
+        for (size_t i = 0; i < pointLights.first.size(); i++) {
+            add(pointLights.first.at(i).position, pointLights.first.at(i).farPlane, LightClusterGrid::LIGHT_POINT, i);
+        }
+        for (size_t i = 0; i < pointLights.second.size(); i++) {
+            add(pointLights.second.at(i).position,
+                pointLights.second.at(i).farPlane,
+                LightClusterGrid::LIGHT_POINT_SHADOW,
+                i);
+        }
+        for (size_t i = 0; i < spotLights.first.size(); i++) {
+            add(spotLights.first.at(i).position, spotLights.first.at(i).farPlane, LightClusterGrid::LIGHT_SPOT, i);
+        }
+        for (size_t i = 0; i < spotLights.second.size(); i++) {
+            add(spotLights.second.at(i).position,
+                spotLights.second.at(i).farPlane,
+                LightClusterGrid::LIGHT_SPOT_SHADOW,
+                i);
+        }
+        return ret;
+    }
+
     void ForwardLightingPass::setup(FrameGraphBuilder &builder) {
         auto resolution = builder.getRenderResolution();
         auto scene = builder.getScene();
@@ -179,65 +209,28 @@ namespace xng {
 
         auto dirLightNodes = scene.rootNode.findAll({typeid(DirectionalLightProperty)});
 
-        std::vector<Mat4f> dirLightTransforms;
-
         size_t dirLightCount = 0;
         size_t shadowDirLightCount = 0;
 
         for (auto l: dirLightNodes) {
-            if (l.getProperty<DirectionalLightProperty>().light.castShadows) {
+            if (l.getProperty<DirectionalLightProperty>().light.castShadows)
                 shadowDirLightCount++;
-
-                auto &transform = l.getProperty<TransformProperty>().transform;
-                auto &light = l.getProperty<DirectionalLightProperty>().light;
-                dirLightTransforms.emplace_back(MatrixMath::ortho(-light.shadowProjectionExtent,
-                                                                  light.shadowProjectionExtent,
-                                                                  -light.shadowProjectionExtent,
-                                                                  light.shadowProjectionExtent,
-                                                                  light.shadowNearPlane,
-                                                                  light.shadowFarPlane)
-                                                * MatrixMath::lookAt(Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y),
-                                                                     Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y) + light.direction,
-                                                                     Vec3f(0, 1, 0)));
-            } else
+            else
                 dirLightCount++;
         }
 
         auto spotLightNodes = scene.rootNode.findAll({typeid(SpotLightProperty)});
 
-        std::vector<Mat4f> spotLightTransforms;
-
         size_t spotLightCount = 0;
         size_t shadowSpotLightCount = 0;
 
-        auto spotShadowResolution = builder.getSettings().get<Vec2i>(
-                FrameGraphSettings::SETTING_SHADOW_MAPPING_SPOT_RESOLUTION);
-
         for (auto l: spotLightNodes) {
-            if (l.getProperty<SpotLightProperty>().light.castShadows) {
+            if (l.getProperty<SpotLightProperty>().light.castShadows)
                 shadowSpotLightCount++;
-                auto &transform = l.getProperty<TransformProperty>().transform;
-                auto &light = l.getProperty<SpotLightProperty>().light;
-                float aspect = (float) spotShadowResolution.x / (float) spotShadowResolution.y;
-                spotLightTransforms.emplace_back(MatrixMath::perspective(45,
-                                                                         aspect,
-                                                                         light.shadowNearPlane,
-                                                                         light.shadowFarPlane)
-                                                 * MatrixMath::lookAt(transform.getPosition(),
-                                                                      transform.getPosition() + light.direction,
-                                                                      Vec3f(0, 1, 0)));
-            } else
+            else
                 spotLightCount++;
         }
 
-        auto dirTransformBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .size = sizeof(Mat4f) * shadowDirLightCount
-        });
-
-        auto spotTransformBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .size = sizeof(Mat4f) * shadowSpotLightCount
-        });
-
         auto pointLightBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
                 .size = sizeof(PointLightData) * pointLightCount
         });
@@ -293,6 +286,11 @@ namespace xng {
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_TEXTURE_ARRAY_BUFFER,
                             BIND_TEXTURE_ARRAY_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
                     .vertexLayout = SkinnedMesh::getDefaultVertexLayout(),
                     .enableDepthTest = true,
@@ -313,7 +311,7 @@ namespace xng {
         size_t totalShaderBufferSize = 0;
 
         std::vector<Node> nodes;
-        std::set<Uri> usedTextures;
+        std::vector<std::vector<uint32_t>> nodeMaterials; // The material ids of the meshes of each node
         std::set<Uri> usedMeshes;
         for (auto &node: scene.rootNode.findAll({typeid(SkinnedMeshProperty)})) {
             auto &meshProp = node.getProperty<SkinnedMeshProperty>();
@@ -326,69 +324,36 @@ namespace xng {
 
             const Mesh &mesh = meshProp.mesh.get();
 
+            const MaterialProperty *matProp = nullptr;
             auto it = node.properties.find(typeid(MaterialProperty));
-            MaterialProperty matProp;
             if (it != node.properties.end()) {
-                matProp = it->second->get<MaterialProperty>();
+                matProp = &it->second->get<MaterialProperty>();
             }
 
             bool gotMesh = false;
+            std::vector<uint32_t> meshMaterials;
             for (auto i = 0; i < mesh.subMeshes.size() + 1; i++) {
                 auto &cMesh = i <= 0 ? mesh : mesh.subMeshes.at(i - 1);
 
-                Material mat;
-                if (cMesh.material.assigned()) {
-                    mat = cMesh.material.get();
-                }
+                auto materialId = materials.getMaterial(getMaterialHandle(cMesh, matProp, i));
+                meshMaterials.emplace_back(materialId);
 
-                auto mi = matProp.materials.find(i);
-                if (mi != matProp.materials.end()) {
-                    mat = mi->second.get();
-                }
-
-                if (!mat.transparent)
+                if (!materials.get(materialId).transparent)
                     continue;
 
                 gotMesh = true;
 
-                usedTextures.insert(mat.normal.getUri());
-                usedTextures.insert(mat.metallicTexture.getUri());
-                usedTextures.insert(mat.roughnessTexture.getUri());
-                usedTextures.insert(mat.ambientOcclusionTexture.getUri());
-                usedTextures.insert(mat.albedoTexture.getUri());
-
-                if (mat.normal.assigned()
-                    && textures.find(mat.normal.getUri()) == textures.end()) {
-                    textures[mat.normal.getUri()] = atlas.add(mat.normal.get().image.get());
-                }
-                if (mat.metallicTexture.assigned()
-                    && textures.find(mat.metallicTexture.getUri()) == textures.end()) {
-                    textures[mat.metallicTexture.getUri()] = atlas.add(
-                            mat.metallicTexture.get().image.get());
-                }
-                if (mat.roughnessTexture.assigned()
-                    && textures.find(mat.roughnessTexture.getUri()) == textures.end()) {
-                    textures[mat.roughnessTexture.getUri()] = atlas.add(
-                            mat.roughnessTexture.get().image.get());
-                }
-                if (mat.ambientOcclusionTexture.assigned()
-                    && textures.find(mat.ambientOcclusionTexture.getUri()) == textures.end()) {
-                    textures[mat.ambientOcclusionTexture.getUri()] = atlas.add(
-                            mat.ambientOcclusionTexture.get().image.get());
-                }
-                if (mat.albedoTexture.assigned()
-                    && textures.find(mat.albedoTexture.getUri()) == textures.end()) {
-                    textures[mat.albedoTexture.getUri()] = atlas.add(
-                            mat.albedoTexture.get().image.get());
-                }
-
                 totalShaderBufferSize += sizeof(ShaderDrawData);
             }
 
-            if (gotMesh)
+            if (gotMesh) {
                 nodes.emplace_back(node);
+                nodeMaterials.emplace_back(std::move(meshMaterials));
+            }
         }
 
+        auto materialBuffer = materials.setup(builder);
+
         size_t maxBufferSize = builder.getDeviceInfo().storageBufferMaxSize;
 
         size_t drawCycles = 0;
@@ -457,6 +422,17 @@ namespace xng {
         auto forwardDepth = builder.getSlot(SLOT_FORWARD_DEPTH);
         auto deferredDepth = builder.getSlot(SLOT_DEFERRED_DEPTH);
 
+        // The layers and transforms of the shadow maps, lights without data are not shadowed
+        auto pointShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_POINT_DATA)
+                                     ? builder.getSlot(SLOT_SHADOW_MAP_POINT_DATA)
+                                     : builder.createShaderStorageBuffer({});
+        auto dirShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_DIRECTIONAL_DATA)
+                                   ? builder.getSlot(SLOT_SHADOW_MAP_DIRECTIONAL_DATA)
+                                   : builder.createShaderStorageBuffer({});
+        auto spotShadowDataBuffer = builder.checkSlot(SLOT_SHADOW_MAP_SPOT_DATA)
+                                    ? builder.getSlot(SLOT_SHADOW_MAP_SPOT_DATA)
+                                    : builder.createShaderStorageBuffer({});
+
         FrameGraphResource pointLightShadowMap{};
         if (builder.checkSlot(SLOT_SHADOW_MAP_POINT)) {
             pointLightShadowMap = builder.getSlot(FrameGraphSlot::SLOT_SHADOW_MAP_POINT);
@@ -476,9 +452,11 @@ namespace xng {
 
         auto atlasBuffers = atlas.getAtlasBuffers(builder);
 
-        auto pointLights = getPointLights(scene);
+        auto lightThreshold = builder.getSettings().get<float>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_THRESHOLD);
+
+        auto pointLights = getPointLights(scene, lightThreshold);
         auto dirLights = getDirLights(scene);
-        auto spotLights = getSpotLights(scene);
+        auto spotLights = getSpotLights(scene, lightThreshold);
 
         builder.upload(pointLightBuffer,
                        [pointLights]() {
@@ -507,13 +485,39 @@ namespace xng {
                            return FrameGraphUploadBuffer::createArray(spotLights.second);
                        });
 
-        builder.upload(dirTransformBuffer,
-                       [dirLightTransforms]() {
-                           return FrameGraphUploadBuffer::createArray(dirLightTransforms);
+        auto clusterTiles = builder.getSettings().get<Vec2i>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_TILES);
+        auto clusterSlices = builder.getSettings().get<int>(FrameGraphSettings::SETTING_LIGHT_CLUSTER_SLICES);
+        if (lightClusters.getTilesX() != clusterTiles.x
+            || lightClusters.getTilesY() != clusterTiles.y
+            || lightClusters.getSlices() != clusterSlices) {
+            lightClusters = LightClusterGrid(clusterTiles.x, clusterTiles.y, clusterSlices);
+        }
+
+        lightClusters.build(camera, Camera::view(cameraTransform), resolution, getLightBounds(pointLights, spotLights));
+
+        auto lightClusterInfoBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(LightClusterInfo)
+        });
+
+        auto lightClusterBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(LightCluster) * lightClusters.getClusters().size()
+        });
+
+        auto lightIndexBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(uint32_t) * lightClusters.getLightIndices().size()
+        });
+
+        builder.upload(lightClusterInfoBuffer,
+                       [info = lightClusters.getInfo()]() {
+                           return FrameGraphUploadBuffer::createValue(info);
                        });
-        builder.upload(spotTransformBuffer,
-                       [spotLightTransforms]() {
-                           return FrameGraphUploadBuffer::createArray(spotLightTransforms);
+        builder.upload(lightClusterBuffer,
+                       [clusters = lightClusters.getClusters()]() {
+                           return FrameGraphUploadBuffer::createArray(clusters);
+                       });
+        builder.upload(lightIndexBuffer,
+                       [indices = lightClusters.getLightIndices()]() {
+                           return FrameGraphUploadBuffer::createArray(indices);
                        });
         meshAllocator.uploadMeshes(builder, vertexBuffer, indexBuffer);
 
@@ -529,21 +533,16 @@ namespace xng {
             meshAllocator.deallocateMesh(ResourceHandle<SkinnedMesh>(uri));
         }
 
-        // Deallocate unused textures
-        dealloc.clear();
-        for (auto &pair: textures) {
-            if (usedTextures.find(pair.first) == usedTextures.end()) {
-                dealloc.insert(pair.first);
-            }
-        }
-        for (auto &uri: dealloc) {
-            deallocateTexture(ResourceHandle<Texture>(uri));
-        }
-
         // Draw objects
         auto projection = camera.projection();
         auto view = Camera::view(cameraTransform);
 
+        lodSelector.beginFrame(camera,
+                               cameraTransform,
+                               resolution,
+                               builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_THRESHOLD),
+                               builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_HYSTERESIS));
+
         if (!nodes.empty()) {
             auto passesPerDrawCycle = nodes.size() / drawCycles;
 
@@ -556,22 +555,16 @@ namespace xng {
                     auto &transformProp = node.getProperty<TransformProperty>();
                     auto &meshProp = node.getProperty<SkinnedMeshProperty>();
 
-                    auto it = node.properties.find(typeid(MaterialProperty));
-                    MaterialProperty matProp;
-                    if (it != node.properties.end()) {
-                        matProp = it->second->get<MaterialProperty>();
-                    }
+                    auto &meshMaterials = nodeMaterials.at(oi + (drawCycle * passesPerDrawCycle));
 
-                    for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
-                        const Mesh &mesh = i <= 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
-
-                        auto material = mesh.material.get();
-                        auto mi = matProp.materials.find(i);
-                        if (mi != matProp.materials.end()) {
-                            material = mi->second.get();
-                        }
+                    auto drawData = meshAllocator.getAllocatedMesh(meshProp.mesh);
+                    auto lod = lodSelector.select(MeshLodSelector::getObjectId(meshProp, oi + (drawCycle * passesPerDrawCycle)),
+                                                  drawData,
+                                                  transformProp.transform);
 
-                        if (!material.transparent)
+                    for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
+                        auto materialId = meshMaterials.at(i);
+                        if (!materials.get(materialId).transparent)
                             continue;
 
                         auto model = transformProp.transform.model();
@@ -588,112 +581,15 @@ namespace xng {
 
                         data.model = model;
                         data.mvp = projection * view * model;
-                        data.objectID_shadows[0] = static_cast<int>(oi);
-                        data.objectID_shadows[1] = shadows;
-
-                        data.metallic_roughness_ambientOcclusion[0] = material.metallic;
-                        data.metallic_roughness_ambientOcclusion[1] = material.roughness;
-                        data.metallic_roughness_ambientOcclusion[2] = material.ambientOcclusion;
-
-                        auto col = material.albedo.divide().getMemory();
-                        data.albedoColor[0] = col[0];
-                        data.albedoColor[1] = col[1];
-                        data.albedoColor[2] = col[2];
-                        data.albedoColor[3] = col[3];
-
-                        data.normalIntensity[0] = material.normalIntensity;
-
-                        if (material.metallicTexture.assigned()) {
-                            auto tex = getTexture(material.metallicTexture, atlasBuffers);
-
-                            data.metallic.level_index_filtering_assigned[0] = tex.level;
-                            data.metallic.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                            data.metallic.level_index_filtering_assigned[2] = material.metallicTexture.get().description.filterMag;
-                            data.metallic.level_index_filtering_assigned[3] = 1;
-
-                            auto atlasScale = tex.size.convert<float>()
-                                              / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                            data.metallic.atlasScale_texSize[0] = atlasScale.x;
-                            data.metallic.atlasScale_texSize[1] = atlasScale.y;
-                            data.metallic.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                            data.metallic.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                        }
-
-                        if (material.roughnessTexture.assigned()) {
-                            auto tex = getTexture(material.roughnessTexture, atlasBuffers);
-
-                            data.roughness.level_index_filtering_assigned[0] = tex.level;
-                            data.roughness.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                            data.roughness.level_index_filtering_assigned[2] = material.roughnessTexture.get().description.filterMag;
-                            data.roughness.level_index_filtering_assigned[3] = 1;
-
-                            auto atlasScale = tex.size.convert<float>()
-                                              / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                            data.roughness.atlasScale_texSize[0] = atlasScale.x;
-                            data.roughness.atlasScale_texSize[1] = atlasScale.y;
-                            data.roughness.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                            data.roughness.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                        }
-
-                        if (material.ambientOcclusionTexture.assigned()) {
-                            auto tex = getTexture(material.ambientOcclusionTexture, atlasBuffers);
-
-                            data.ambientOcclusion.level_index_filtering_assigned[0] = tex.level;
-                            data.ambientOcclusion.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                            data.ambientOcclusion.level_index_filtering_assigned[2] = material.ambientOcclusionTexture.get().description.filterMag;
-                            data.ambientOcclusion.level_index_filtering_assigned[3] = 1;
-
-                            auto atlasScale = tex.size.convert<float>()
-                                              / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                            data.ambientOcclusion.atlasScale_texSize[0] = atlasScale.x;
-                            data.ambientOcclusion.atlasScale_texSize[1] = atlasScale.y;
-                            data.ambientOcclusion.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                            data.ambientOcclusion.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                        }
-
-                        if (material.albedoTexture.assigned()) {
-                            auto tex = getTexture(material.albedoTexture, atlasBuffers);
-
-                            data.albedo.level_index_filtering_assigned[0] = tex.level;
-                            data.albedo.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                            data.albedo.level_index_filtering_assigned[2] = material.albedoTexture.get().description.filterMag;
-                            data.albedo.level_index_filtering_assigned[3] = 1;
-
-                            auto atlasScale = tex.size.convert<float>()
-                                              / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                            data.albedo.atlasScale_texSize[0] = atlasScale.x;
-                            data.albedo.atlasScale_texSize[1] = atlasScale.y;
-                            data.albedo.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                            data.albedo.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                        }
-
-                        if (material.normal.assigned()) {
-                            auto tex = getTexture(material.normal, atlasBuffers);
-
-                            data.normal.level_index_filtering_assigned[0] = tex.level;
-                            data.normal.level_index_filtering_assigned[1] = static_cast<int>(tex.index);
-                            data.normal.level_index_filtering_assigned[2] = material.normal.get().description.filterMag;
-                            data.normal.level_index_filtering_assigned[3] = 1;
-
-                            auto atlasScale = tex.size.convert<float>()
-                                              / TextureAtlas::getResolutionLevelSize(tex.level).convert<float>();
-
-                            data.normal.atlasScale_texSize[0] = atlasScale.x;
-                            data.normal.atlasScale_texSize[1] = atlasScale.y;
-                            data.normal.atlasScale_texSize[2] = static_cast<float>(tex.size.x);
-                            data.normal.atlasScale_texSize[3] = static_cast<float>(tex.size.y);
-                        }
+                        data.objectID_shadows_material[0] = static_cast<int>(oi);
+                        data.objectID_shadows_material[1] = shadows;
+                        data.objectID_shadows_material[2] = static_cast<int>(materialId);
 
                         shaderData.emplace_back(data);
 
-                        auto drawData = meshAllocator.getAllocatedMesh(meshProp.mesh);
                         auto &draw = drawData.data.at(i);
 
-                        drawCalls.emplace_back(draw.drawCall);
+                        drawCalls.emplace_back(draw.getDrawCall(lod));
                         baseVertices.emplace_back(draw.baseVertex);
                     }
                 }
@@ -732,8 +628,8 @@ namespace xng {
                                                     {shadowDirLightBuffer,              {{FRAGMENT, ShaderResource::READ}}},
                                                     {spotLightBuffer,                   {{FRAGMENT, ShaderResource::READ}}},
                                                     {shadowSpotLightBuffer,             {{FRAGMENT, ShaderResource::READ}}},
-                                                    {dirTransformBuffer,                {{FRAGMENT, ShaderResource::READ}}},
-                                                    {spotTransformBuffer,               {{FRAGMENT, ShaderResource::READ}}},
+                                                    {dirShadowDataBuffer,               {{FRAGMENT, ShaderResource::READ}}},
+                                                    {spotShadowDataBuffer,              {{FRAGMENT, ShaderResource::READ}}},
                                                     {dirMap,                            {{FRAGMENT, ShaderResource::READ}}},
                                                     {spotMap,                           {{FRAGMENT, ShaderResource::READ}}},
                                                     {atlasBuffers.at(
@@ -760,6 +656,11 @@ namespace xng {
                                                             TEXTURE_ATLAS_8192x8192),   {{{FRAGMENT, ShaderResource::READ}}}},
                                                     {atlasBuffers.at(
                                                             TEXTURE_ATLAS_16384x16384), {{{FRAGMENT, ShaderResource::READ}}}},
+                                                    {lightClusterInfoBuffer,            {{FRAGMENT, ShaderResource::READ}}},
+                                                    {lightClusterBuffer,                {{FRAGMENT, ShaderResource::READ}}},
+                                                    {lightIndexBuffer,                  {{FRAGMENT, ShaderResource::READ}}},
+                                                    {pointShadowDataBuffer,             {{FRAGMENT, ShaderResource::READ}}},
+                                                    {materialBuffer,                    {{FRAGMENT, ShaderResource::READ}}},
                                             });
                 builder.multiDrawIndexed(drawCalls, baseVertices);
                 builder.finishPass();
@@ -770,18 +671,4 @@ namespace xng {
     std::type_index ForwardLightingPass::getTypeIndex() const {
         return typeid(ForwardLightingPass);
     }
-
-    TextureAtlasHandle ForwardLightingPass::getTexture(const ResourceHandle<Texture> &texture,
-                                                       std::map<TextureAtlasResolution, FrameGraphResource> &atlasBuffers) {
-        if (textures.find(texture.getUri()) == textures.end()) {
-            auto handle = atlas.add(texture.get().image.get());
-            textures[texture.getUri()] = handle;
-        }
-        return textures.at(texture.getUri());
-    }
-
-    void ForwardLightingPass::deallocateTexture(const ResourceHandle<Texture> &texture) {
-        atlas.remove(textures.at(texture.getUri()));
-        textures.erase(texture.getUri());
-    }
-}
\ No newline at end of file
+}
@@ -0,0 +1,173 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "xng/render/graph/passes/particlepass.hpp"
+
+#include <algorithm>
+
+#include "xng/render/graph/framegraphbuilder.hpp"
+
+#include "xng/render/geometry/vertexstream.hpp"
+
+#include "graph/particlepass_vs.hpp" // Generated by cmake
+#include "graph/particlepass_fs.hpp" // Generated by cmake
+
+namespace xng {
+#pragma pack(push, 1)
+    struct ShaderDrawDataParticle {
+        Mat4f viewProjection;
+        float cameraRight[4]{0, 0, 0, 0};
+        float cameraUp[4]{0, 0, 0, 0};
+    };
+#pragma pack(pop)
+
+    void ParticlePass::setup(FrameGraphBuilder &builder) {
+        auto nodes = builder.getScene().rootNode.findAll({typeid(ParticleProperty)});
+        auto cameras = builder.getScene().rootNode.findAll({typeid(CameraProperty)});
+        if (nodes.empty() || cameras.empty())
+            return;
+
+        auto resolution = builder.getRenderResolution();
+
+        if (!pipeline.assigned) {
+            RenderPipelineDesc pdesc{};
+            pdesc.shaders = {
+                    {VERTEX,   particlepass_vs},
+                    {FRAGMENT, particlepass_fs}
+            };
+            pdesc.bindings = {
+                    BIND_SHADER_STORAGE_BUFFER,
+                    BIND_SHADER_STORAGE_BUFFER
+            };
+            pdesc.primitive = TRIANGLES;
+            pdesc.vertexLayout = mesh.vertexLayout;
+            pdesc.enableDepthTest = true;
+            pdesc.depthTestWrite = false;
+            pdesc.depthTestMode = DEPTH_TEST_LESS;
+            pdesc.enableBlending = true;
+            pdesc.colorBlendSourceMode = SRC_ALPHA;
+            pdesc.colorBlendDestinationMode = ONE_MINUS_SRC_ALPHA;
+            pdesc.alphaBlendSourceMode = ONE;
+            pdesc.alphaBlendDestinationMode = ONE_MINUS_SRC_ALPHA;
+            pipeline = builder.createRenderPipeline(pdesc);
+        }
+
+        builder.persist(pipeline);
+
+        if (!vertexBuffer.assigned) {
+            VertexBufferDesc desc;
+            desc.size = mesh.vertices.size() * mesh.vertexLayout.getSize();
+            vertexBuffer = builder.createVertexBuffer(desc);
+
+            builder.upload(vertexBuffer,
+                           [this]() {
+                               return FrameGraphUploadBuffer::createArray(VertexStream()
+                                                                                  .addVertices(mesh.vertices)
+                                                                                  .getVertexBuffer());
+                           });
+        }
+
+        builder.persist(vertexBuffer);
+
+        auto &cameraNode = cameras.at(0);
+        auto camera = cameraNode.getProperty<CameraProperty>().camera;
+        auto cameraTransform = cameraNode.getProperty<TransformProperty>().transform;
+        auto cameraPosition = cameraTransform.getPosition();
+
+        // Draw emitters back to front, the first instance of each emitter is its farthest particle.
+        std::vector<std::pair<float, std::shared_ptr<const std::vector<ParticleInstance>>>> emitters;
+        size_t particleCount = 0;
+        for (auto &node: nodes) {
+            auto &instances = node.getProperty<ParticleProperty>().instances;
+            if (!instances || instances->empty())
+                continue;
+            auto &p = instances->at(0).position;
+            auto distance = Vec3f(p[0], p[1], p[2]).distance(cameraPosition);
+            emitters.emplace_back(distance, instances);
+            particleCount += instances->size();
+        }
+
+        if (particleCount == 0)
+            return;
+
+        std::sort(emitters.begin(), emitters.end(), [](const auto &a, const auto &b) {
+            return a.first > b.first;
+        });
+
+        auto view = Camera::view(cameraTransform);
+
+        ShaderDrawDataParticle drawData;
+        drawData.viewProjection = camera.projection() * view;
+        // The first two rows of the view matrix are the camera right and up vectors in world space
+        drawData.cameraRight[0] = view.data[0];
+        drawData.cameraRight[1] = view.data[4];
+        drawData.cameraRight[2] = view.data[8];
+        drawData.cameraUp[0] = view.data[1];
+        drawData.cameraUp[1] = view.data[5];
+        drawData.cameraUp[2] = view.data[9];
+
+        auto particleBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = RenderBufferType::HOST_VISIBLE,
+                .size = sizeof(ParticleInstance) * particleCount
+        });
+
+        auto shaderBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = RenderBufferType::HOST_VISIBLE,
+                .size = sizeof(ShaderDrawDataParticle)
+        });
+
+        builder.upload(particleBuffer,
+                       [emitters, particleCount]() {
+                           std::vector<ParticleInstance> instances;
+                           instances.reserve(particleCount);
+                           for (auto &pair: emitters) {
+                               instances.insert(instances.end(), pair.second->begin(), pair.second->end());
+                           }
+                           return FrameGraphUploadBuffer::createArray(instances);
+                       });
+
+        builder.upload(shaderBuffer,
+                       [drawData]() {
+                           return FrameGraphUploadBuffer::createValue(drawData);
+                       });
+
+        auto screenColor = builder.getSlot(SLOT_SCREEN_COLOR);
+        auto screenDepth = builder.getSlot(SLOT_SCREEN_DEPTH);
+
+        builder.beginPass({FrameGraphAttachment::texture(screenColor)},
+                          FrameGraphAttachment::texture(screenDepth));
+
+        builder.setViewport({}, resolution);
+
+        builder.bindPipeline(pipeline);
+        builder.bindVertexBuffers(vertexBuffer, {}, {}, mesh.vertexLayout, {});
+        builder.bindShaderResources(std::vector<FrameGraphCommand::ShaderData>{
+                {particleBuffer, {{VERTEX, ShaderResource::READ}}},
+                {shaderBuffer,   {{VERTEX, ShaderResource::READ}}},
+        });
+
+        builder.instancedDrawArray(DrawCall(0, mesh.vertices.size()), particleCount);
+
+        builder.finishPass();
+    }
+
+    std::type_index ParticlePass::getTypeIndex() const {
+        return typeid(ParticlePass);
+    }
+}
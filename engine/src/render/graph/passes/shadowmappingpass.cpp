@@ -25,16 +25,22 @@
 
 #include "graph/shadowmappingpass_fs.hpp"
 #include "graph/shadowmappingpass_vs.hpp"
+#include "graph/shadowmappingpass_vs_compact.hpp"
 #include "graph/shadowmappingpass_gs.hpp"
 #include "graph/shadowmappingpass_dir_vs.hpp"
+#include "graph/shadowmappingpass_dir_vs_compact.hpp"
 #include "graph/shadowmappingpass_dir_fs.hpp"
 #include "graph/shadowmappingpass_dir_gs.hpp"
 
 #include "xng/math/rotation.hpp"
 
+#include "xng/util/stablehash.hpp"
+
 struct ShadowShaderDrawData {
     std::array<int, 4> boneOffset{};
     Mat4f model;
+    std::array<float, 4> positionOffset{};
+    std::array<float, 4> positionScale{1, 1, 1, 1};
 };
 
 struct ShadowPointLightData {
@@ -47,7 +53,255 @@ struct ShadowDirLightData {
     Mat4f shadowMatrix;
 };
 
+// The layouts of the shadow map data slots, see ShadowPointData, ShadowDirectionalData and ShadowSpotData in shadow.glsl
+struct ShadowPointMapData {
+    std::array<int, 4> layer{};
+};
+
+struct ShadowDirectionalMapData {
+    std::array<int, 4> layers{};
+    std::array<float, 4> cascadeSplits{};
+    std::array<int, 4> cascadeCount{};
+    std::array<Mat4f, 4> transforms;
+};
+
+struct ShadowSpotMapData {
+    std::array<int, 4> layer{};
+    Mat4f transform;
+};
+
 namespace xng {
+    static const int MAX_CASCADES = 4;
+    static const float CASCADE_SPLIT_LAMBDA = 0.75f; // The blend factor between logarithmic and uniform cascade splits
+
+    // The bounding sphere of a shadow casting light or its projection
+    struct ShadowLightRange {
+        Vec3f center;
+        float radius;
+    };
+
+    static uint64_t getLightHash(int type, int cascade, const Mat4f &matrix, float farPlane) {
+        StableHash hash;
+        hash.add(type);
+        hash.add(cascade);
+        hash.add(matrix.data, sizeof(matrix.data));
+        hash.add(farPlane);
+        return hash.get();
+    }
+
+    static float getMaxScale(const Mat4f &model) {
+        float ret = 0;
+        for (int col = 0; col < 3; col++) {
+            auto x = model.get(col, 0);
+            auto y = model.get(col, 1);
+            auto z = model.get(col, 2);
+            ret = std::max(ret, std::sqrt(x * x + y * y + z * z));
+        }
+        return ret;
+    }
+
+    static std::array<Mat4f, 6> getPointShadowMatrices(const Vec3f &lightPos, float aspect, float near, float far) {
+        Mat4f shadowProj = MatrixMath::perspective(90.0f, aspect, near, far);
+        return {shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(1.0, 0.0, 0.0), Vec3f(0.0, -1.0, 0.0)),
+                shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(-1.0, 0.0, 0.0), Vec3f(0.0, -1.0, 0.0)),
+                shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 1.0, 0.0), Vec3f(0.0, 0.0, 1.0)),
+                shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, -1.0, 0.0), Vec3f(0.0, 0.0, -1.0)),
+                shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 0.0, 1.0), Vec3f(0.0, -1.0, 0.0)),
+                shadowProj * MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 0.0, -1.0), Vec3f(0.0, -1.0, 0.0))};
+    }
+
+    /**
+     * The fixed projection of a directional light defined by its shadow position and extent.
+     */
+    static Mat4f getDirectionalShadowMatrix(const DirectionalLight &light, ShadowLightRange &range) {
+        auto eye = Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y);
+        auto direction = light.direction;
+        auto length = std::sqrt(direction.x * direction.x + direction.y * direction.y + direction.z * direction.z);
+        if (length > 0)
+            direction = direction / length;
+
+        auto halfDepth = (light.shadowFarPlane - light.shadowNearPlane) / 2;
+        range.center = eye + direction * (light.shadowNearPlane + halfDepth);
+        range.radius = std::sqrt(2 * light.shadowProjectionExtent * light.shadowProjectionExtent + halfDepth * halfDepth);
+
+        return MatrixMath::ortho(-light.shadowProjectionExtent,
+                                 light.shadowProjectionExtent,
+                                 -light.shadowProjectionExtent,
+                                 light.shadowProjectionExtent,
+                                 light.shadowNearPlane,
+                                 light.shadowFarPlane)
+               * MatrixMath::lookAt(eye, eye + light.direction, Vec3f(0, 1, 0));
+    }
+
+    /**
+     * Fit an orthographic projection around the bounding sphere of the camera frustum slice between nearDepth and farDepth.
+     * The projection is snapped to shadow map texels so that the shadows do not shimmer when the camera moves.
+     */
+    static Mat4f getCascadeShadowMatrix(const DirectionalLight &light,
+                                        const Camera &camera,
+                                        const Transform &cameraTransform,
+                                        float nearDepth,
+                                        float farDepth,
+                                        int resolution,
+                                        ShadowLightRange &range) {
+        auto rotation = cameraTransform.getRotation().matrix();
+        auto toWorld = [&](float x, float y, float depth) {
+            // The rotation matrix is orthonormal, the inverse rotation is the transpose
+            Vec3f v(x, y, -depth);
+            Vec3f ret;
+            ret.x = rotation.get(0, 0) * v.x + rotation.get(0, 1) * v.y + rotation.get(0, 2) * v.z;
+            ret.y = rotation.get(1, 0) * v.x + rotation.get(1, 1) * v.y + rotation.get(1, 2) * v.z;
+            ret.z = rotation.get(2, 0) * v.x + rotation.get(2, 1) * v.y + rotation.get(2, 2) * v.z;
+            return cameraTransform.getPosition() + ret;
+        };
+
+        std::vector<Vec3f> corners;
+        for (auto depth: {nearDepth, farDepth}) {
+            float left, right, bottom, top;
+            if (camera.type == PERSPECTIVE) {
+                auto tanY = std::tan(degreesToRadians(camera.fov) / 2);
+                top = tanY * depth;
+                bottom = -top;
+                right = top * camera.aspectRatio;
+                left = -right;
+            } else {
+                left = camera.left;
+                right = camera.right;
+                bottom = camera.bottom;
+                top = camera.top;
+            }
+            corners.emplace_back(toWorld(left, bottom, depth));
+            corners.emplace_back(toWorld(right, bottom, depth));
+            corners.emplace_back(toWorld(left, top, depth));
+            corners.emplace_back(toWorld(right, top, depth));
+        }
+
+        Vec3f center;
+        for (auto &corner: corners) {
+            center += corner;
+        }
+        center = center / static_cast<float>(corners.size());
+
+        float radius = 0;
+        for (auto &corner: corners) {
+            radius = std::max(radius, corner.distance(center));
+        }
+        // Quantize the radius so that the projection size does not change with the camera rotation
+        radius = std::ceil(radius * 16.0f) / 16.0f;
+
+        auto direction = light.direction;
+        auto up = std::abs(direction.y) > 0.99f * direction.magnitude(direction) ? Vec3f(0, 0, 1) : Vec3f(0, 1, 0);
+        auto lightView = MatrixMath::lookAt(Vec3f(), direction, up);
+
+        auto lightSpaceCenter = lightView * Vec4f(center.x, center.y, center.z, 1);
+        auto texelSize = (radius * 2) / static_cast<float>(resolution);
+        auto x = std::floor(lightSpaceCenter.x / texelSize) * texelSize;
+        auto y = std::floor(lightSpaceCenter.y / texelSize) * texelSize;
+
+        // Extend the projection towards the light so that casters outside the view frustum are included
+        auto backDistance = std::max(radius, light.shadowFarPlane);
+
+        auto dirLength = direction.magnitude(direction);
+        auto normalizedDirection = dirLength > 0 ? direction / dirLength : direction;
+        range.center = center - normalizedDirection * ((backDistance - radius) / 2);
+        range.radius = std::sqrt(2 * radius * radius + std::pow((backDistance + radius) / 2, 2.0f));
+
+        return MatrixMath::ortho(x - radius,
+                                 x + radius,
+                                 y - radius,
+                                 y + radius,
+                                 -lightSpaceCenter.z - backDistance,
+                                 -lightSpaceCenter.z + radius)
+               * lightView;
+    }
+
+    static std::vector<float> getCascadeSplits(const Camera &camera, int cascades, float distance) {
+        auto near = std::max(camera.nearClip, 0.0001f);
+        auto far = std::max(std::min(distance, camera.farClip), near * 1.0001f);
+        std::vector<float> ret;
+        for (int i = 0; i <= cascades; i++) {
+            auto t = static_cast<float>(i) / static_cast<float>(cascades);
+            auto logSplit = near * std::pow(far / near, t);
+            auto uniformSplit = near + (far - near) * t;
+            ret.emplace_back(CASCADE_SPLIT_LAMBDA * logSplit + (1 - CASCADE_SPLIT_LAMBDA) * uniformSplit);
+        }
+        return ret;
+    }
+
+    static void clearShadowMapLayer(FrameGraphBuilder &builder, FrameGraphResource shadowMap, size_t layer, bool cubeMap) {
+        if (cubeMap) {
+            for (auto face = 0; face < 6; face++) {
+                builder.beginPass({}, FrameGraphAttachment::textureArrayCubeMap(shadowMap,
+                                                                                layer,
+                                                                                static_cast<CubeMapFace>(face)));
+                builder.clearDepth(1);
+                builder.finishPass();
+            }
+        } else {
+            builder.beginPass({}, FrameGraphAttachment::textureArray(shadowMap, layer));
+            builder.clearDepth(1);
+            builder.finishPass();
+        }
+    }
+
+    static size_t countRenders(const std::vector<ShadowMapCache::Allocation> &allocations) {
+        size_t ret = 0;
+        for (auto &allocation: allocations) {
+            if (allocation.render)
+                ret++;
+        }
+        return ret;
+    }
+
+    ShadowMappingPass::ShadowCaster ShadowMappingPass::getShadowCaster(const ResourceHandle<SkinnedMesh> &mesh,
+                                                                       const Mat4f &model,
+                                                                       const BonePalette &bonePalette,
+                                                                       size_t paletteOffset,
+                                                                       size_t lod) {
+        auto it = meshBounds.find(mesh.getUri());
+        if (it == meshBounds.end()) {
+            Vec3f min(std::numeric_limits<float>::max());
+            Vec3f max(std::numeric_limits<float>::lowest());
+            std::vector<Vec3f> positions;
+            for (auto i = 0; i < mesh.get().subMeshes.size() + 1; i++) {
+                const Mesh &m = i == 0 ? mesh.get() : mesh.get().subMeshes.at(i - 1);
+                for (auto &vertex: m.vertices) {
+                    // The position is the first attribute of the vertex layout
+                    Vec3f position;
+                    std::memcpy(&position.x, vertex.buffer.data(), sizeof(float) * 3);
+                    positions.emplace_back(position);
+                    min = Vec3f(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+                    max = Vec3f(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+                }
+            }
+            Vec3f center = positions.empty() ? Vec3f() : (min + max) / 2.0f;
+            float radius = 0;
+            for (auto &position: positions) {
+                radius = std::max(radius, position.distance(center));
+            }
+            it = meshBounds.insert({mesh.getUri(), Vec4f(center.x, center.y, center.z, radius)}).first;
+        }
+
+        auto &bounds = it->second;
+        auto center = model * Vec4f(bounds.x, bounds.y, bounds.z, 1);
+
+        StableHash hash;
+        hash.add(mesh.getUri().toString());
+        hash.add(model.data, sizeof(model.data));
+        hash.add(lod);
+        auto &palette = bonePalette.getTransforms();
+        if (paletteOffset > 0 && paletteOffset < palette.size()) {
+            auto boneCount = std::min(mesh.get().rig.getBones().size(), palette.size() - paletteOffset);
+            hash.add(palette.data() + paletteOffset, sizeof(Mat4f) * boneCount);
+        }
+
+        return ShadowCaster{
+                .center = Vec3f(center.x, center.y, center.z),
+                .radius = bounds.w * getMaxScale(model),
+                .hash = hash.get()
+        };
+    }
+
     void ShadowMappingPass::setup(FrameGraphBuilder &builder) {
         auto pointShadowResolution = builder.getSettings().get<Vec2i>(
                 FrameGraphSettings::SETTING_SHADOW_MAPPING_POINT_RESOLUTION);
@@ -63,6 +317,14 @@ namespace xng {
         if (spotShadowResolution.x / spotShadowResolution.y != 1)
             throw std::runtime_error("Shadow Map Resolution must be square");
 
+        auto updateBudget = builder.getSettings().get<int>(FrameGraphSettings::SETTING_SHADOW_MAPPING_UPDATE_BUDGET);
+        size_t budget = updateBudget < 1 ? std::numeric_limits<size_t>::max() : static_cast<size_t>(updateBudget);
+
+        auto cascades = std::clamp(builder.getSettings().get<int>(
+                FrameGraphSettings::SETTING_SHADOW_MAPPING_DIRECTIONAL_CASCADES), 1, MAX_CASCADES);
+        auto cascadeDistance = builder.getSettings().get<float>(
+                FrameGraphSettings::SETTING_SHADOW_MAPPING_DIRECTIONAL_CASCADE_DISTANCE);
+
         std::vector<Node> meshNodes;
 
         std::vector<Node> pointLightNodes;
@@ -90,45 +352,47 @@ namespace xng {
             }
         }
 
-        TextureArrayBufferDesc desc;
-        desc.textureDesc.size = pointShadowResolution;
-        desc.textureDesc.textureType = TEXTURE_CUBE_MAP;
-        desc.textureDesc.format = DEPTH_STENCIL;
-        desc.textureCount = pointLightNodes.size();
-
-        auto pointLightShadowMap = builder.createTextureArrayBuffer(desc);
-
-        desc = {};
-        desc.textureDesc.size = dirShadowResolution;
-        desc.textureDesc.textureType = TEXTURE_2D;
-        desc.textureDesc.format = DEPTH_STENCIL;
-        desc.textureCount = dirLightNodes.size();
-
-        auto dirLightShadowMap = builder.createTextureArrayBuffer(desc);
-
-        desc = {};
-        desc.textureDesc.size = spotShadowResolution;
-        desc.textureDesc.textureType = TEXTURE_2D;
-        desc.textureDesc.format = DEPTH_STENCIL;
-        desc.textureCount = spotLightNodes.size();
-
-        auto spotLightShadowMap = builder.createTextureArrayBuffer(desc);
-
-        builder.assignSlot(SLOT_SHADOW_MAP_POINT, pointLightShadowMap);
-        builder.assignSlot(SLOT_SHADOW_MAP_DIRECTIONAL, dirLightShadowMap);
-        builder.assignSlot(SLOT_SHADOW_MAP_SPOT, spotLightShadowMap);
+        auto cameraNodes = builder.getScene().rootNode.findAll({typeid(CameraProperty)});
+        if (cameraNodes.empty()) {
+            cascades = 1;
+        } else {
+            // Casters use the level of detail selected for the camera offset by the bias
+            lodSelector.beginFrame(cameraNodes.at(0).getProperty<CameraProperty>().camera,
+                                   cameraNodes.at(0).getProperty<TransformProperty>().transform,
+                                   builder.getRenderResolution(),
+                                   builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_THRESHOLD),
+                                   builder.getSettings().get<float>(FrameGraphSettings::SETTING_LOD_HYSTERESIS));
+        }
+        auto lodBias = static_cast<size_t>(std::max(0, builder.getSettings().get<int>(
+                FrameGraphSettings::SETTING_SHADOW_MAPPING_LOD_BIAS)));
+
+        auto compactVertexLayout = builder.getSettings().get<bool>(FrameGraphSettings::SETTING_COMPACT_VERTEX_LAYOUT);
+        auto vertexLayout = compactVertexLayout
+                            ? SkinnedMesh::getCompactVertexLayout()
+                            : SkinnedMesh::getDefaultVertexLayout();
+        if (meshAllocator.getVertexLayout() != vertexLayout) {
+            // The meshes are uploaded again in the new layout
+            meshAllocator = MeshAllocator(vertexLayout);
+            pointPipeline = {};
+            dirPipeline = {};
+            vertexBuffer = {};
+            indexBuffer = {};
+            currentVertexBufferSize = 0;
+            currentIndexBufferSize = 0;
+        }
 
         if (!pointPipeline.assigned) {
             pointPipeline = builder.createRenderPipeline(RenderPipelineDesc{
-                    .shaders = {{VERTEX,   shadowmappingpass_vs},
+                    .shaders = {{VERTEX,   compactVertexLayout ? shadowmappingpass_vs_compact : shadowmappingpass_vs},
                                 {FRAGMENT, shadowmappingpass_fs},
                                 {GEOMETRY, shadowmappingpass_gs}},
                     .bindings = {
                             BIND_SHADER_STORAGE_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
-                    .vertexLayout = SkinnedMesh::getDefaultVertexLayout(),
+                    .vertexLayout = vertexLayout,
                     .enableDepthTest = true,
                     .depthTestWrite = true,
                     .depthTestMode = DEPTH_TEST_LESS,
@@ -141,15 +405,18 @@ namespace xng {
 
         if (!dirPipeline.assigned) {
             dirPipeline = builder.createRenderPipeline(RenderPipelineDesc{
-                    .shaders = {{VERTEX,   shadowmappingpass_dir_vs},
+                    .shaders = {{VERTEX,   compactVertexLayout
+                                           ? shadowmappingpass_dir_vs_compact
+                                           : shadowmappingpass_dir_vs},
                                 {FRAGMENT, shadowmappingpass_dir_fs},
                                 {GEOMETRY, shadowmappingpass_dir_gs}},
                     .bindings = {
                             BIND_SHADER_STORAGE_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
-                    .vertexLayout = SkinnedMesh::getDefaultVertexLayout(),
+                    .vertexLayout = vertexLayout,
                     .enableDepthTest = true,
                     .depthTestWrite = true,
                     .depthTestMode = DEPTH_TEST_LESS,
@@ -163,7 +430,6 @@ namespace xng {
         std::set<Uri> usedMeshes;
 
         size_t totalShaderBufferSize = 0;
-        size_t boneCount = 0;
         for (auto &node: builder.getScene().rootNode.findAll({typeid(SkinnedMeshProperty)})) {
             auto &meshProp = node.getProperty<SkinnedMeshProperty>();
             if (meshProp.mesh.assigned()) {
@@ -171,15 +437,11 @@ namespace xng {
                 usedMeshes.insert(meshProp.mesh.getUri());
 
                 for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
-                    Mesh mesh = i == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
-
                     if (node.hasProperty<ShadowProperty>()) {
                         if (!node.getProperty<ShadowProperty>().castShadows)
                             continue;
                     }
 
-                    boneCount += mesh.bones.size();
-
                     totalShaderBufferSize += sizeof(ShadowShaderDrawData);
                 }
                 meshNodes.emplace_back(node);
@@ -191,11 +453,6 @@ namespace xng {
                 .size = totalShaderBufferSize
         });
 
-        auto boneBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .bufferType = RenderBufferType::HOST_VISIBLE,
-                .size = sizeof(Mat4f) * boneCount
-        });
-
         if (vertexBuffer.assigned) {
             builder.persist(vertexBuffer);
         }
@@ -247,250 +504,414 @@ namespace xng {
         }
         for (auto &uri: dealloc) {
             meshAllocator.deallocateMesh(ResourceHandle<SkinnedMesh>(uri));
-        }
-
-        auto pointLightBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .bufferType = HOST_VISIBLE,
-                .size = sizeof(ShadowPointLightData)
-        });
-
-        auto dirLightBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .bufferType = HOST_VISIBLE,
-                .size = sizeof(ShadowDirLightData)
-        });
-
-        if (!pointLightNodes.empty()) {
-            builder.beginPass({}, FrameGraphAttachment::textureArrayLayered(pointLightShadowMap));
-            builder.clearDepth(1);
-            builder.finishPass();
-        }
-
-        if (!dirLightNodes.empty()) {
-            builder.beginPass({}, FrameGraphAttachment::textureArrayLayered(dirLightShadowMap));
-            builder.clearDepth(1);
-            builder.finishPass();
-        }
-
-        if (!spotLightNodes.empty()) {
-            builder.beginPass({}, FrameGraphAttachment::textureArrayLayered(spotLightShadowMap));
-            builder.clearDepth(1);
-            builder.finishPass();
+            meshBounds.erase(uri);
         }
 
         std::vector<DrawCall> drawCalls;
         std::vector<size_t> baseVertices;
         std::vector<ShadowShaderDrawData> shaderData;
-        std::vector<Mat4f> boneMatrices;
+        std::vector<uint32_t> boneIndices;
+        std::vector<ShadowCaster> casters;
 
-        for (auto &node: meshNodes) {
-            auto &meshProp = node.getProperty<SkinnedMeshProperty>();
+        bonePalette.releaseUnused();
 
-            auto rig = meshProp.mesh.get().rig;
+        for (auto ni = 0; ni < meshNodes.size(); ni++) {
+            auto &node = meshNodes.at(ni);
+            auto &meshProp = node.getProperty<SkinnedMeshProperty>();
 
-            std::map<std::string, Mat4f> boneTransforms;
+            size_t paletteOffset = 0;
             auto it = node.properties.find(typeid(BoneTransformsProperty));
             if (it != node.properties.end()) {
-                boneTransforms = it->second->get<BoneTransformsProperty>().boneTransforms;
+                paletteOffset = it->second->get<BoneTransformsProperty>().paletteOffset;
             }
 
             auto drawData = meshAllocator.getAllocatedMesh(meshProp.mesh);
 
+            size_t lod = 0;
+            if (!drawData.lodErrors.empty()) {
+                if (cameraNodes.empty()) {
+                    lod = std::min(lodBias, drawData.lodErrors.size() - 1);
+                } else {
+                    lod = lodSelector.select(MeshLodSelector::getObjectId(meshProp, ni),
+                                             drawData,
+                                             node.getProperty<TransformProperty>().transform,
+                                             lodBias);
+                }
+            }
+
+            if (!node.hasProperty<ShadowProperty>() || node.getProperty<ShadowProperty>().castShadows) {
+                casters.emplace_back(getShadowCaster(meshProp.mesh,
+                                                     node.getProperty<TransformProperty>().transform.model(),
+                                                     builder.getScene().bonePalette,
+                                                     paletteOffset,
+                                                     lod));
+            }
+
             for (auto mi = 0; mi < meshProp.mesh.get().subMeshes.size() + 1; mi++) {
                 auto model = node.getProperty<TransformProperty>().transform.model();
 
-                Mesh mesh = mi == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(mi - 1);
-
                 if (node.hasProperty<ShadowProperty>()) {
                     if (!node.getProperty<ShadowProperty>().castShadows)
                         continue;
                 }
 
-                auto boneOffset = boneMatrices.size();
-                if (mesh.bones.empty()) {
-                    boneOffset = -1;
-                } else {
-                    for (auto &bone: mesh.bones) {
-                        auto bt = boneTransforms.find(bone);
-                        if (bt != boneTransforms.end()) {
-                            boneMatrices.emplace_back(bt->second);
-                        } else {
-                            boneMatrices.emplace_back(MatrixMath::identity());
-                        }
-                    }
-                }
+                auto boneOffset = bonePalette.addBoneIndices(builder.getScene(), node, mi, boneIndices);
 
                 auto data = ShadowShaderDrawData();
 
+                auto &draw = drawData.data.at(mi);
+
                 data.model = model;
-                data.boneOffset[0] = static_cast<int>(boneOffset);
+                data.boneOffset[0] = boneOffset;
+                data.positionOffset = {draw.positionOffset.x, draw.positionOffset.y, draw.positionOffset.z, 0};
+                data.positionScale = {draw.positionScale.x, draw.positionScale.y, draw.positionScale.z, 1};
 
                 shaderData.emplace_back(data);
 
-                auto &draw = drawData.data.at(mi);
-                drawCalls.emplace_back(draw.drawCall);
+                drawCalls.emplace_back(draw.getDrawCall(lod));
                 baseVertices.emplace_back(draw.baseVertex);
             }
         }
 
+
         builder.upload(shaderBuffer,
                        [shaderData]() {
                            return FrameGraphUploadBuffer::createArray(shaderData);
                        });
-        builder.upload(boneBuffer,
-                       [boneMatrices]() {
-                           return FrameGraphUploadBuffer::createArray(boneMatrices);
+
+        auto paletteBuffer = FrameGraphBonePalette::getPaletteBuffer(builder);
+
+        // Keeps the index buffer from being empty when no skinned meshes are drawn
+        boneIndices.emplace_back(0);
+        auto boneIndexBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = RenderBufferType::HOST_VISIBLE,
+                .size = sizeof(uint32_t) * boneIndices.size()
+        });
+        builder.upload(boneIndexBuffer,
+                       [boneIndices]() {
+                           return FrameGraphUploadBuffer::createArray(boneIndices);
                        });
 
-        // Draw point shadow maps
-        for (auto li = 0; li < pointLightNodes.size(); li++) {
-            auto &lightNode = pointLightNodes.at(li);
+        // Compute the shadow projections and the casters within range of each shadow map
+        float pointAspect = (float) pointShadowResolution.x / (float) pointShadowResolution.y;
+        float spotAspect = (float) spotShadowResolution.x / (float) spotShadowResolution.y;
+
+        std::vector<ShadowPointLightData> pointLights;
+        std::vector<ShadowMapCache::Request> pointRequests;
+        for (auto &lightNode: pointLightNodes) {
             auto &light = lightNode.getProperty<PointLightProperty>().light;
+            auto &lightPos = lightNode.getProperty<TransformProperty>().transform.getPosition();
+
+            ShadowPointLightData lightData;
+            lightData.shadowMatrices = getPointShadowMatrices(lightPos,
+                                                              pointAspect,
+                                                              light.shadowNearPlane,
+                                                              light.shadowFarPlane);
+            lightData.lightPosFarPlane = Vec4f(lightPos.x, lightPos.y, lightPos.z, light.shadowFarPlane).getMemory();
+            pointLights.emplace_back(lightData);
+
+            pointRequests.emplace_back(ShadowMapCache::Request{
+                    .lightHash = getLightHash(0, 0, lightData.shadowMatrices[0], light.shadowFarPlane),
+                    .casterHash = ShadowMapCache::getCasterHash(casters, lightPos, light.shadowFarPlane)
+            });
+        }
+
+        std::vector<ShadowDirectionalMapData> dirLights;
+        std::vector<Mat4f> dirCascadeMatrices;
+        std::vector<ShadowMapCache::Request> dirRequests;
+        for (auto &lightNode: dirLightNodes) {
+            auto &light = lightNode.getProperty<DirectionalLightProperty>().light;
+
+            ShadowDirectionalMapData data;
+            data.cascadeCount[0] = cascades;
+            if (cascades == 1) {
+                ShadowLightRange range{};
+                data.transforms[0] = getDirectionalShadowMatrix(light, range);
+                data.cascadeSplits[0] = std::numeric_limits<float>::max();
+                dirRequests.emplace_back(ShadowMapCache::Request{
+                        .lightHash = getLightHash(1, 0, data.transforms[0], light.shadowFarPlane),
+                        .casterHash = ShadowMapCache::getCasterHash(casters, range.center, range.radius)
+                });
+                dirCascadeMatrices.emplace_back(data.transforms[0]);
+            } else {
+                auto &cameraNode = cameraNodes.at(0);
+                auto &camera = cameraNode.getProperty<CameraProperty>().camera;
+                auto &cameraTransform = cameraNode.getProperty<TransformProperty>().transform;
+                auto splits = getCascadeSplits(camera, cascades, cascadeDistance);
+                for (auto cascade = 0; cascade < cascades; cascade++) {
+                    ShadowLightRange range{};
+                    data.transforms[cascade] = getCascadeShadowMatrix(light,
+                                                                      camera,
+                                                                      cameraTransform,
+                                                                      splits.at(cascade),
+                                                                      splits.at(cascade + 1),
+                                                                      dirShadowResolution.x,
+                                                                      range);
+                    data.cascadeSplits[cascade] = splits.at(cascade + 1);
+                    dirRequests.emplace_back(ShadowMapCache::Request{
+                            .lightHash = getLightHash(1, cascade, data.transforms[cascade], light.shadowFarPlane),
+                            .casterHash = ShadowMapCache::getCasterHash(casters, range.center, range.radius)
+                    });
+                    dirCascadeMatrices.emplace_back(data.transforms[cascade]);
+                }
+            }
+            dirLights.emplace_back(data);
+        }
+
+        std::vector<ShadowSpotMapData> spotLights;
+        std::vector<ShadowMapCache::Request> spotRequests;
+        for (auto &lightNode: spotLightNodes) {
+            auto &light = lightNode.getProperty<SpotLightProperty>().light;
             auto &transform = lightNode.getProperty<TransformProperty>().transform;
-            float aspect = (float) pointShadowResolution.x / (float) pointShadowResolution.y;
-            float near = light.shadowNearPlane;
-            float far = light.shadowFarPlane;
 
-            Mat4f shadowProj = MatrixMath::perspective(90.0f, aspect, near, far);
+            ShadowSpotMapData data;
+            data.transform = MatrixMath::perspective(45,
+                                                     spotAspect,
+                                                     light.shadowNearPlane,
+                                                     light.shadowFarPlane)
+                             * MatrixMath::lookAt(transform.getPosition(),
+                                                  transform.getPosition() + light.direction,
+                                                  Vec3f(0, 1, 0));
+            spotLights.emplace_back(data);
+
+            spotRequests.emplace_back(ShadowMapCache::Request{
+                    .lightHash = getLightHash(2, 0, data.transform, light.shadowFarPlane),
+                    .casterHash = ShadowMapCache::getCasterHash(casters, transform.getPosition(), light.shadowFarPlane)
+            });
+        }
+
+        // Assign the persistent layers, the budget is shared by all light types
+        if (pointShadowResolution != currentPointResolution)
+            pointShadowCache.invalidate();
+        if (dirShadowResolution != currentDirResolution)
+            dirShadowCache.invalidate();
+        if (spotShadowResolution != currentSpotResolution)
+            spotShadowCache.invalidate();
+
+        auto pointAllocations = pointShadowCache.update(pointRequests, budget);
+        budget -= std::min(budget, countRenders(pointAllocations));
+        auto dirAllocations = dirShadowCache.update(dirRequests, budget);
+        budget -= std::min(budget, countRenders(dirAllocations));
+        auto spotAllocations = spotShadowCache.update(spotRequests, budget);
+
+        if (!pointLightShadowMap.assigned
+            || pointShadowCapacity != pointShadowCache.getCapacity()
+            || pointShadowResolution != currentPointResolution) {
+            TextureArrayBufferDesc desc;
+            desc.textureDesc.size = pointShadowResolution;
+            desc.textureDesc.textureType = TEXTURE_CUBE_MAP;
+            desc.textureDesc.format = DEPTH_STENCIL;
+            desc.textureCount = pointShadowCache.getCapacity();
+            pointLightShadowMap = builder.createTextureArrayBuffer(desc);
+            pointShadowCapacity = desc.textureCount;
+            currentPointResolution = pointShadowResolution;
+        }
 
-            auto &lightPos = transform.getPosition();
+        if (!dirLightShadowMap.assigned
+            || dirShadowCapacity != dirShadowCache.getCapacity()
+            || dirShadowResolution != currentDirResolution) {
+            TextureArrayBufferDesc desc;
+            desc.textureDesc.size = dirShadowResolution;
+            desc.textureDesc.textureType = TEXTURE_2D;
+            desc.textureDesc.format = DEPTH_STENCIL;
+            desc.textureCount = dirShadowCache.getCapacity();
+            dirLightShadowMap = builder.createTextureArrayBuffer(desc);
+            dirShadowCapacity = desc.textureCount;
+            currentDirResolution = dirShadowResolution;
+        }
 
-            ShadowPointLightData lightData;
+        if (!spotLightShadowMap.assigned
+            || spotShadowCapacity != spotShadowCache.getCapacity()
+            || spotShadowResolution != currentSpotResolution) {
+            TextureArrayBufferDesc desc;
+            desc.textureDesc.size = spotShadowResolution;
+            desc.textureDesc.textureType = TEXTURE_2D;
+            desc.textureDesc.format = DEPTH_STENCIL;
+            desc.textureCount = spotShadowCache.getCapacity();
+            spotLightShadowMap = builder.createTextureArrayBuffer(desc);
+            spotShadowCapacity = desc.textureCount;
+            currentSpotResolution = spotShadowResolution;
+        }
+
+        builder.persist(pointLightShadowMap);
+        builder.persist(dirLightShadowMap);
+        builder.persist(spotLightShadowMap);
+
+        builder.assignSlot(SLOT_SHADOW_MAP_POINT, pointLightShadowMap);
+        builder.assignSlot(SLOT_SHADOW_MAP_DIRECTIONAL, dirLightShadowMap);
+        builder.assignSlot(SLOT_SHADOW_MAP_SPOT, spotLightShadowMap);
+
+        // Publish the layers and transforms for the lighting passes
+        std::vector<ShadowPointMapData> pointMapData;
+        for (auto &allocation: pointAllocations) {
+            ShadowPointMapData data;
+            data.layer[0] = static_cast<int>(allocation.layer);
+            pointMapData.emplace_back(data);
+        }
+
+        size_t cascadeIndex = 0;
+        for (auto &data: dirLights) {
+            for (auto cascade = 0; cascade < data.cascadeCount[0]; cascade++) {
+                data.layers[cascade] = static_cast<int>(dirAllocations.at(cascadeIndex++).layer);
+            }
+        }
 
-            lightData.shadowMatrices[0] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(1.0, 0.0, 0.0),
-                                                              Vec3f(0.0, -1.0, 0.0)));
-            lightData.shadowMatrices[1] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(-1.0, 0.0, 0.0),
-                                                              Vec3f(0.0, -1.0, 0.0)));
-            lightData.shadowMatrices[2] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 1.0, 0.0),
-                                                              Vec3f(0.0, 0.0, 1.0)));
-            lightData.shadowMatrices[3] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, -1.0, 0.0),
-                                                              Vec3f(0.0, 0.0, -1.0)));
-            lightData.shadowMatrices[4] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 0.0, 1.0),
-                                                              Vec3f(0.0, -1.0, 0.0)));
-            lightData.shadowMatrices[5] = (shadowProj *
-                                           MatrixMath::lookAt(lightPos, lightPos + Vec3f(0.0, 0.0, -1.0),
-                                                              Vec3f(0.0, -1.0, 0.0)));
-
-            lightData.lightPosFarPlane = Vec4f(lightPos.x, lightPos.y, lightPos.z, far).getMemory();
-
-            lightData.layer[0] = static_cast<int>(li);
+        for (auto i = 0; i < spotLights.size(); i++) {
+            spotLights.at(i).layer[0] = static_cast<int>(spotAllocations.at(i).layer);
+        }
+
+        auto pointMapDataBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(ShadowPointMapData) * pointMapData.size()
+        });
+        auto dirMapDataBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(ShadowDirectionalMapData) * dirLights.size()
+        });
+        auto spotMapDataBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .size = sizeof(ShadowSpotMapData) * spotLights.size()
+        });
+
+        builder.upload(pointMapDataBuffer,
+                       [pointMapData]() {
+                           return FrameGraphUploadBuffer::createArray(pointMapData);
+                       });
+        builder.upload(dirMapDataBuffer,
+                       [dirLights]() {
+                           return FrameGraphUploadBuffer::createArray(dirLights);
+                       });
+        builder.upload(spotMapDataBuffer,
+                       [spotLights]() {
+                           return FrameGraphUploadBuffer::createArray(spotLights);
+                       });
+
+        builder.assignSlot(SLOT_SHADOW_MAP_POINT_DATA, pointMapDataBuffer);
+        builder.assignSlot(SLOT_SHADOW_MAP_DIRECTIONAL_DATA, dirMapDataBuffer);
+        builder.assignSlot(SLOT_SHADOW_MAP_SPOT_DATA, spotMapDataBuffer);
+
+        auto pointLightBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = HOST_VISIBLE,
+                .size = sizeof(ShadowPointLightData)
+        });
+
+        auto dirLightBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                .bufferType = HOST_VISIBLE,
+                .size = sizeof(ShadowDirLightData)
+        });
+
+        // Draw point shadow maps
+        for (auto li = 0; li < pointLights.size(); li++) {
+            auto &allocation = pointAllocations.at(li);
+            if (!allocation.render && !allocation.clear)
+                continue;
+
+            clearShadowMapLayer(builder, pointLightShadowMap, allocation.layer, true);
+
+            if (!allocation.render || meshNodes.empty())
+                continue;
+
+            auto lightData = pointLights.at(li);
+            lightData.layer[0] = static_cast<int>(allocation.layer);
 
             builder.upload(pointLightBuffer,
                            [lightData]() {
                                return FrameGraphUploadBuffer::createValue(lightData);
                            });
 
-            if (!meshNodes.empty()) {
-                builder.beginPass({},
-                                  FrameGraphAttachment::textureArrayLayered(pointLightShadowMap));
-                builder.setViewport({}, pointShadowResolution);
-                builder.bindPipeline(pointPipeline);
-                builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, SkinnedMesh::getDefaultVertexLayout(), {});
+            builder.beginPass({},
+                              FrameGraphAttachment::textureArrayLayered(pointLightShadowMap));
+            builder.setViewport({}, pointShadowResolution);
+            builder.bindPipeline(pointPipeline);
+            builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, vertexLayout, {});
 
-                builder.bindShaderResources({
-                                                    {shaderBuffer,     {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                                    {boneBuffer,       {{VERTEX, ShaderResource::READ}}},
-                                                    {pointLightBuffer, {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                            });
+            builder.bindShaderResources({
+                                                {shaderBuffer,     {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {paletteBuffer,    {{VERTEX, ShaderResource::READ}}},
+                                                {pointLightBuffer, {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {boneIndexBuffer,  {{VERTEX, ShaderResource::READ}}},
+                                        });
 
-                builder.multiDrawIndexed(drawCalls, baseVertices);
+            builder.multiDrawIndexed(drawCalls, baseVertices);
 
-                builder.finishPass();
-            }
+            builder.finishPass();
         }
 
         // Draw Directional shadow maps
-        for (auto li = 0; li < dirLightNodes.size(); li++) {
-            auto &lightNode = dirLightNodes.at(li);
-            auto &light = lightNode.getProperty<DirectionalLightProperty>().light;
+        for (auto ci = 0; ci < dirCascadeMatrices.size(); ci++) {
+            auto &allocation = dirAllocations.at(ci);
+            if (!allocation.render && !allocation.clear)
+                continue;
+
+            clearShadowMapLayer(builder, dirLightShadowMap, allocation.layer, false);
 
-            Mat4f shadowProj = MatrixMath::ortho(-light.shadowProjectionExtent,
-                                                 light.shadowProjectionExtent,
-                                                 -light.shadowProjectionExtent,
-                                                 light.shadowProjectionExtent,
-                                                 light.shadowNearPlane,
-                                                 light.shadowFarPlane)
-                               * MatrixMath::lookAt(Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y),
-                                                    Vec3f(light.shadowPosition.x, 0, light.shadowPosition.y) + light.direction,
-                                                    Vec3f(0, 1, 0));
+            if (!allocation.render || meshNodes.empty())
+                continue;
 
             ShadowDirLightData lightData;
-            lightData.shadowMatrix = shadowProj;
-            lightData.layer[0] = static_cast<int>(li);
+            lightData.shadowMatrix = dirCascadeMatrices.at(ci);
+            lightData.layer[0] = static_cast<int>(allocation.layer);
 
             builder.upload(dirLightBuffer,
                            [lightData]() {
                                return FrameGraphUploadBuffer::createValue(lightData);
                            });
 
-            if (!meshNodes.empty()) {
-                builder.beginPass({},
-                                  FrameGraphAttachment::textureArrayLayered(dirLightShadowMap));
-                builder.setViewport({}, dirShadowResolution);
-                builder.bindPipeline(dirPipeline);
-                builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, SkinnedMesh::getDefaultVertexLayout(), {});
+            builder.beginPass({},
+                              FrameGraphAttachment::textureArrayLayered(dirLightShadowMap));
+            builder.setViewport({}, dirShadowResolution);
+            builder.bindPipeline(dirPipeline);
+            builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, vertexLayout, {});
 
-                builder.bindShaderResources({
-                                                    {shaderBuffer,   {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                                    {boneBuffer,     {{VERTEX, ShaderResource::READ}}},
-                                                    {dirLightBuffer, {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                            });
+            builder.bindShaderResources({
+                                                {shaderBuffer,    {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {paletteBuffer,   {{VERTEX, ShaderResource::READ}}},
+                                                {dirLightBuffer,  {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {boneIndexBuffer, {{VERTEX, ShaderResource::READ}}},
+                                        });
 
-                builder.multiDrawIndexed(drawCalls, baseVertices);
+            builder.multiDrawIndexed(drawCalls, baseVertices);
 
-                builder.finishPass();
-            }
+            builder.finishPass();
         }
 
         // Draw Spot shadow maps
-        for (auto li = 0; li < spotLightNodes.size(); li++) {
-            auto &lightNode = spotLightNodes.at(li);
-            auto &light = lightNode.getProperty<SpotLightProperty>().light;
-            auto &transform = lightNode.getProperty<TransformProperty>().transform;
-            float aspect = (float) spotShadowResolution.x / (float) spotShadowResolution.y;
+        for (auto li = 0; li < spotLights.size(); li++) {
+            auto &allocation = spotAllocations.at(li);
+            if (!allocation.render && !allocation.clear)
+                continue;
+
+            clearShadowMapLayer(builder, spotLightShadowMap, allocation.layer, false);
 
-            Mat4f shadowProj = MatrixMath::perspective(45,
-                                                       aspect,
-                                                       light.shadowNearPlane,
-                                                       light.shadowFarPlane)
-                               * MatrixMath::lookAt(transform.getPosition(),
-                                                    transform.getPosition() + light.direction,
-                                                    Vec3f(0, 1, 0));
+            if (!allocation.render || meshNodes.empty())
+                continue;
 
             ShadowDirLightData lightData;
-            lightData.shadowMatrix = shadowProj;
-            lightData.layer[0] = static_cast<int>(li);
+            lightData.shadowMatrix = spotLights.at(li).transform;
+            lightData.layer[0] = static_cast<int>(allocation.layer);
 
             builder.upload(dirLightBuffer,
                            [lightData]() {
                                return FrameGraphUploadBuffer::createValue(lightData);
                            });
 
-            if (!meshNodes.empty()) {
-                builder.beginPass({},
-                                  FrameGraphAttachment::textureArrayLayered(spotLightShadowMap));
-                builder.setViewport({}, spotShadowResolution);
-                builder.bindPipeline(dirPipeline);
-                builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, SkinnedMesh::getDefaultVertexLayout(), {});
+            builder.beginPass({},
+                              FrameGraphAttachment::textureArrayLayered(spotLightShadowMap));
+            builder.setViewport({}, spotShadowResolution);
+            builder.bindPipeline(dirPipeline);
+            builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, vertexLayout, {});
 
-                builder.bindShaderResources({
-                                                    {shaderBuffer,   {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                                    {boneBuffer,     {{VERTEX, ShaderResource::READ}}},
-                                                    {dirLightBuffer, {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                                            });
+            builder.bindShaderResources({
+                                                {shaderBuffer,    {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {paletteBuffer,   {{VERTEX, ShaderResource::READ}}},
+                                                {dirLightBuffer,  {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                                                {boneIndexBuffer, {{VERTEX, ShaderResource::READ}}},
+                                        });
 
-                builder.multiDrawIndexed(drawCalls, baseVertices);
+            builder.multiDrawIndexed(drawCalls, baseVertices);
 
-                builder.finishPass();
-            }
+            builder.finishPass();
         }
     }
 
     std::type_index ShadowMappingPass::getTypeIndex() const {
         return typeid(ShadowMappingPass);
     }
-}
\ No newline at end of file
+}
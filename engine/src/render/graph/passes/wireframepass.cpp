@@ -48,6 +48,7 @@ namespace xng {
                     .bindings = {
                             BIND_SHADER_STORAGE_BUFFER,
                             BIND_SHADER_STORAGE_BUFFER,
+                            BIND_SHADER_STORAGE_BUFFER,
                     },
                     .primitive = LINES,
                     .vertexLayout = SkinnedMesh::getDefaultVertexLayout(),
@@ -65,8 +66,6 @@ namespace xng {
 
         std::set<Uri> usedMeshes;
 
-        size_t boneCount = 0;
-
         auto tmp = builder.getScene().rootNode.findAll({typeid(SkinnedMeshProperty)});
         for (auto id = 0; id < tmp.size(); id++) {
             auto &object = tmp.at(id);
@@ -76,10 +75,6 @@ namespace xng {
                 usedMeshes.insert(meshProp.mesh.getUri());
 
                 for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
-                    const Mesh &mesh = i == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
-
-                    boneCount += mesh.bones.size();
-
                     totalShaderBufferSize += sizeof(ShaderDrawDataWireframe);
                 }
                 objects.emplace_back(object);
@@ -91,11 +86,6 @@ namespace xng {
                 .size = totalShaderBufferSize
         });
 
-        auto boneBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
-                .bufferType = RenderBufferType::HOST_VISIBLE,
-                .size = sizeof(Mat4f) * boneCount
-        });
-
         if (vertexBuffer.assigned) {
             builder.persist(vertexBuffer);
         }
@@ -153,40 +143,20 @@ namespace xng {
         std::vector<DrawCall> drawCalls;
         std::vector<size_t> baseVertices;
         std::vector<ShaderDrawDataWireframe> shaderData;
-        std::vector<Mat4f> boneMatrices;
+        std::vector<uint32_t> boneIndices;
+
+        bonePalette.releaseUnused();
 
         for (auto oi = 0; oi < objects.size(); oi++) {
             auto &node = objects.at(oi);
             auto &meshProp = node.getProperty<SkinnedMeshProperty>();
 
-            auto rig = meshProp.mesh.get().rig;
-
-            std::map<std::string, Mat4f> boneTransforms;
-            auto it = node.properties.find(typeid(BoneTransformsProperty));
-            if (it != node.properties.end()) {
-                boneTransforms = it->second->get<BoneTransformsProperty>().boneTransforms;
-            }
-
             auto drawData = meshAllocator.getAllocatedMesh(meshProp.mesh);
 
             for (auto i = 0; i < meshProp.mesh.get().subMeshes.size() + 1; i++) {
                 auto model = node.getProperty<TransformProperty>().transform.model();
 
-                const Mesh &mesh = i == 0 ? meshProp.mesh.get() : meshProp.mesh.get().subMeshes.at(i - 1);
-
-                auto boneOffset = boneMatrices.size();
-                if (mesh.bones.empty()) {
-                    boneOffset = -1;
-                } else {
-                    for (auto &bone: mesh.bones) {
-                        auto bt = boneTransforms.find(bone);
-                        if (bt != boneTransforms.end()) {
-                            boneMatrices.emplace_back(bt->second);
-                        } else {
-                            boneMatrices.emplace_back(MatrixMath::identity());
-                        }
-                    }
-                }
+                auto boneOffset = bonePalette.addBoneIndices(builder.getScene(), node, i, boneIndices);
 
                 ColorRGBA wireColor = ColorRGBA::white();
                 if (node.hasProperty<WireframeProperty>()) {
@@ -198,7 +168,7 @@ namespace xng {
                 data.model = model;
                 data.mvp = projection * view * model;
                 data.objectID_boneOffset[0] = static_cast<int>(oi);
-                data.objectID_boneOffset[1] = static_cast<int>(boneOffset);
+                data.objectID_boneOffset[1] = boneOffset;
 
                 auto col = wireColor.divide().getMemory();
                 data.wireColor[0] = col[0];
@@ -221,9 +191,17 @@ namespace xng {
                                return FrameGraphUploadBuffer::createArray(shaderData);
                            });
 
-            builder.upload(boneBuffer,
-                           [boneMatrices]() {
-                               return FrameGraphUploadBuffer::createArray(boneMatrices);
+            auto paletteBuffer = FrameGraphBonePalette::getPaletteBuffer(builder);
+
+            // Keeps the index buffer from being empty when no skinned meshes are drawn
+            boneIndices.emplace_back(0);
+            auto boneIndexBuffer = builder.createShaderStorageBuffer(ShaderStorageBufferDesc{
+                    .bufferType = RenderBufferType::HOST_VISIBLE,
+                    .size = sizeof(uint32_t) * boneIndices.size()
+            });
+            builder.upload(boneIndexBuffer,
+                           [boneIndices]() {
+                               return FrameGraphUploadBuffer::createArray(boneIndices);
                            });
 
             builder.beginPass({
@@ -236,8 +214,9 @@ namespace xng {
             builder.bindPipeline(renderPipeline);
             builder.bindVertexBuffers(vertexBuffer, indexBuffer, {}, SkinnedMesh::getDefaultVertexLayout(), {});
             builder.bindShaderResources(std::vector<FrameGraphCommand::ShaderData>{
-                    {shaderBuffer, {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
-                    {boneBuffer,   {{VERTEX, ShaderResource::READ}}},
+                    {shaderBuffer,    {{VERTEX, ShaderResource::READ}, {FRAGMENT, ShaderResource::READ}}},
+                    {paletteBuffer,   {{VERTEX, ShaderResource::READ}}},
+                    {boneIndexBuffer, {{VERTEX, ShaderResource::READ}}},
             });
 
             builder.multiDrawIndexed(drawCalls, baseVertices);
@@ -29,7 +29,8 @@ namespace xng {
             : backBuffer(backBuffer),
               device(device),
               shaderCompiler(shaderCompiler),
-              shaderDecompiler(shaderDecompiler) {
+              shaderDecompiler(shaderDecompiler),
+              pipelineCache(device, shaderDecompiler) {
         for (auto type = FrameGraphCommand::Type::CREATE_RENDER_PIPELINE;
              type <= FrameGraphCommand::Type::CREATE_SHADER_STORAGE_BUFFER;
              type = (FrameGraphCommand::Type) ((int) type + 1)) {
@@ -38,6 +39,8 @@ namespace xng {
 
         commandJumpTable[FrameGraphCommand::UPLOAD] = [this](const FrameGraphCommand &cmd) { cmdUpload(cmd); };
         commandJumpTable[FrameGraphCommand::COPY] = [this](const FrameGraphCommand &cmd) { cmdCopy(cmd); };
+        commandJumpTable[FrameGraphCommand::COPY_TEXTURE_REGION] = [this](
+                const FrameGraphCommand &cmd) { cmdCopyTextureRegion(cmd); };
 
         commandJumpTable[FrameGraphCommand::GENERATE_MIPMAPS] = [this](
                 const FrameGraphCommand &cmd) { cmdGenerateMipMap(cmd); };
@@ -288,6 +291,31 @@ namespace xng {
         dirtyBuffers.insert(cmd.resources.at(1));
     }
 
+    void FrameGraphRuntimeSimple::cmdCopyTextureRegion(const FrameGraphCommand &cmd) {
+        auto &data = std::get<FrameGraphCommand::CopyTextureRegionData>(cmd.data);
+
+        auto objA = &getObject(cmd.resources.at(0));
+        auto objB = &getObject(cmd.resources.at(1));
+
+        if (objA->getType() != RenderObject::RENDER_OBJECT_TEXTURE_ARRAY_BUFFER
+            || objB->getType() != RenderObject::RENDER_OBJECT_TEXTURE_ARRAY_BUFFER) {
+            throw std::runtime_error("Texture region copies require texture array buffers");
+        }
+
+        auto &tbA = dynamic_cast<TextureArrayBuffer &>(*objA);
+        auto &tbB = dynamic_cast<TextureArrayBuffer &>(*objB);
+        pendingBufferCommands.emplace_back(tbB.copy(tbA,
+                                                    data.sourceIndex,
+                                                    data.targetIndex,
+                                                    data.sourceOffset,
+                                                    data.targetOffset,
+                                                    data.size,
+                                                    data.mipMapLevels));
+
+        dirtyBuffers.insert(cmd.resources.at(0));
+        dirtyBuffers.insert(cmd.resources.at(1));
+    }
+
     void FrameGraphRuntimeSimple::cmdGenerateMipMap(const FrameGraphCommand &cmd) {
         auto &obj = getObject(cmd.resources.at(0));
         switch (obj.getType()) {
@@ -921,16 +949,10 @@ namespace xng {
 
         objects.clear();
 
-        // Resize object pools
-        std::unordered_set<RenderPipelineDesc> pipelineDel;
-        for (auto &pair: pipelines) {
-            if (usedPipelines.find(pair.first) == usedPipelines.end()) {
-                pipelineDel.insert(pair.first);
-            }
-        }
-        for (auto &val: pipelineDel)
-            pipelines.erase(val);
+        // Pipelines are kept alive across frames by the pipeline cache
+        pipelineCache.collect();
 
+        // Resize object pools
         std::unordered_set<RenderPassDesc> passDel;
         for (auto &pair: passes) {
             if (usedPasses.find(pair.first) == usedPasses.end()) {
@@ -1032,7 +1054,6 @@ namespace xng {
             commandBuffers.resize(usedCommandBuffers);
         }
 
-        usedPipelines.clear();
         usedPasses.clear();
         usedVertexBuffers.clear();
         usedIndexBuffers.clear();
@@ -1046,10 +1067,7 @@ namespace xng {
     }
 
     RenderPipeline &FrameGraphRuntimeSimple::getPipeline(const RenderPipelineDesc &desc) {
-        if (usedPipelines[desc]++ == 0) {
-            pipelines[desc] = device.createRenderPipeline(desc, shaderDecompiler);
-        }
-        return *pipelines.at(desc);
+        return pipelineCache.get(desc);
     }
 
     RenderPass &FrameGraphRuntimeSimple::getRenderPass(const RenderPassDesc &desc) {
@@ -1292,12 +1310,7 @@ namespace xng {
             }
             case RenderObject::RENDER_OBJECT_RENDER_PIPELINE: {
                 auto &pip = dynamic_cast<RenderPipeline &>(obj);
-                auto ret = device.createRenderPipeline(pip.getDescription(), shaderDecompiler);
-                if (--usedPipelines[pip.getDescription()] == 0) {
-                    usedPipelines.erase(pip.getDescription());
-                    pipelines.erase(pip.getDescription());
-                }
-                return ret;
+                return device.createRenderPipeline(pip.getDescription(), pipelineCache.getDecompiler());
             }
             case RenderObject::RENDER_OBJECT_RENDER_PASS: {
                 auto &p = dynamic_cast<RenderPass &>(obj);
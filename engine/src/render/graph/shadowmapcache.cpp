@@ -0,0 +1,153 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "xng/render/graph/shadowmapcache.hpp"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "xng/util/stablehash.hpp"
+
+namespace xng {
+    ShadowMapCache::ShadowMapCache(size_t minCapacity)
+            : minCapacity(std::max<size_t>(minCapacity, 1)) {}
+
+    std::vector<ShadowMapCache::Allocation> ShadowMapCache::update(const std::vector<Request> &requests,
+                                                                   size_t budget) {
+        frame++;
+
+        if (requests.size() > slots.size()) {
+            size_t capacity = std::max<size_t>(minCapacity, 1);
+            while (capacity < requests.size()) {
+                capacity *= 2;
+            }
+            slots.resize(capacity);
+            invalidate();
+        }
+
+        std::vector<Allocation> ret(requests.size());
+        std::vector<bool> assigned(requests.size(), false);
+        std::vector<bool> claimed(slots.size(), false);
+
+        // Lights which did not change keep their layer
+        std::unordered_multimap<uint64_t, size_t> usedSlots;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (slots[i].used) {
+                usedSlots.emplace(slots[i].lightHash, i);
+            }
+        }
+
+        for (size_t i = 0; i < requests.size(); i++) {
+            auto range = usedSlots.equal_range(requests[i].lightHash);
+            for (auto it = range.first; it != range.second; it++) {
+                if (!claimed[it->second]) {
+                    claimed[it->second] = true;
+                    assigned[i] = true;
+                    ret[i].layer = it->second;
+                    break;
+                }
+            }
+        }
+
+        // Changed or new lights take over the layers of removed or changed lights first and then the free layers
+        std::vector<size_t> freeSlots;
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!claimed[i] && slots[i].used) {
+                freeSlots.emplace_back(i);
+            }
+        }
+        for (size_t i = 0; i < slots.size(); i++) {
+            if (!claimed[i] && !slots[i].used) {
+                freeSlots.emplace_back(i);
+            }
+        }
+
+        auto freeIt = freeSlots.begin();
+        for (size_t i = 0; i < requests.size(); i++) {
+            if (!assigned[i]) {
+                auto layer = *freeIt++;
+                claimed[layer] = true;
+                auto &slot = slots[layer];
+                slot.lightHash = requests[i].lightHash;
+                slot.valid = false;
+                ret[i].layer = layer;
+            }
+        }
+
+        for (size_t i = 0; i < slots.size(); i++) {
+            slots[i].used = claimed[i];
+        }
+
+        // Schedule the outdated shadow maps, never rendered shadow maps first and then the least recently rendered
+        std::vector<size_t> outdated;
+        for (size_t i = 0; i < requests.size(); i++) {
+            auto &slot = slots[ret[i].layer];
+            if (!slot.valid || slot.casterHash != requests[i].casterHash) {
+                outdated.emplace_back(i);
+            }
+        }
+
+        std::stable_sort(outdated.begin(), outdated.end(), [&](size_t a, size_t b) {
+            auto &slotA = slots[ret[a].layer];
+            auto &slotB = slots[ret[b].layer];
+            if (slotA.valid != slotB.valid)
+                return !slotA.valid;
+            return slotA.renderFrame < slotB.renderFrame;
+        });
+
+        for (size_t i = 0; i < outdated.size(); i++) {
+            auto index = outdated[i];
+            auto &slot = slots[ret[index].layer];
+            if (i < budget) {
+                slot.valid = true;
+                slot.casterHash = requests[index].casterHash;
+                slot.renderFrame = frame;
+                ret[index].render = true;
+            } else if (!slot.valid) {
+                ret[index].clear = true;
+            }
+        }
+
+        return ret;
+    }
+
+    uint64_t ShadowMapCache::getCasterHash(const std::vector<Caster> &casters, const Vec3f &center, float radius) {
+        // The sum is independent of the order of the casters
+        uint64_t sum = 0;
+        uint64_t count = 0;
+        for (auto &caster: casters) {
+            auto maxDistance = caster.radius + radius;
+            auto d = caster.center - center;
+            if (d.x * d.x + d.y * d.y + d.z * d.z <= maxDistance * maxDistance) {
+                sum += caster.hash;
+                count++;
+            }
+        }
+        StableHash hash;
+        hash.add(sum);
+        hash.add(count);
+        return hash.get();
+    }
+
+    void ShadowMapCache::invalidate() {
+        for (auto &slot: slots) {
+            slot.valid = false;
+        }
+    }
+}
@@ -0,0 +1,248 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/lighting/lightclustergrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+#include "async/parallelchunks.hpp"
+#include "xng/math/rotation.hpp"
+
+namespace xng {
+    static float getMaxChannel(const ColorRGBA &color, float power) {
+        auto v = color.divide();
+        return std::max(std::max(v.x, v.y), v.z) * power;
+    }
+
+    static float getNearClip(const Camera &camera) {
+        return std::max(camera.nearClip, 0.0001f);
+    }
+
+    static float getFarClip(const Camera &camera) {
+        return std::max(camera.farClip, getNearClip(camera) * 1.0001f);
+    }
+
+    float LightClusterGrid::getRadius(const PointLight &light, float threshold) {
+        if (threshold <= 0)
+            return std::numeric_limits<float>::infinity();
+        // The point light attenuation is 1 / d^2
+        return std::sqrt(getMaxChannel(light.color, light.power) / threshold);
+    }
+
+    float LightClusterGrid::getRadius(const SpotLight &light, float threshold) {
+        if (threshold <= 0)
+            return std::numeric_limits<float>::infinity();
+        // The spot light attenuation is 1 / (constant + linear * d + quadratic * d^2)
+        auto target = getMaxChannel(light.color, light.power) / threshold;
+        auto c = light.constant - target;
+        if (c >= 0)
+            return 0;
+        if (light.quadratic > 0) {
+            return (-light.linear + std::sqrt(light.linear * light.linear - 4 * light.quadratic * c))
+                   / (2 * light.quadratic);
+        } else if (light.linear > 0) {
+            return -c / light.linear;
+        } else {
+            return std::numeric_limits<float>::infinity();
+        }
+    }
+
+    LightClusterGrid::LightClusterGrid(int tilesX, int tilesY, int slices, size_t parallelThreshold)
+            : tilesX(tilesX),
+              tilesY(tilesY),
+              slices(slices),
+              parallelThreshold(parallelThreshold) {
+        if (tilesX < 1 || tilesY < 1 || slices < 1)
+            throw std::runtime_error("Invalid light cluster grid size");
+        bins.resize(static_cast<size_t>(tilesX) * tilesY * slices);
+        clusters.resize(bins.size());
+        info.gridSize = {tilesX, tilesY, slices, 0};
+    }
+
+    void LightClusterGrid::updateBounds(const Camera &camera) {
+        std::array<float, 9> key = {static_cast<float>(camera.type),
+                                    camera.nearClip,
+                                    camera.farClip,
+                                    camera.fov,
+                                    camera.aspectRatio,
+                                    camera.left,
+                                    camera.right,
+                                    camera.top,
+                                    camera.bottom};
+        if (boundsValid && key == boundsKey)
+            return;
+
+        auto nearClip = getNearClip(camera);
+        auto farClip = getFarClip(camera);
+
+        sliceDepths.resize(slices);
+        for (int slice = 0; slice < slices; slice++) {
+            // Slice 0 starts at the camera so that lights between the camera and the near plane are binned
+            auto begin = slice == 0
+                         ? 0
+                         : nearClip * std::pow(farClip / nearClip, static_cast<float>(slice) / slices);
+            auto end = slice == slices - 1
+                       ? farClip
+                       : nearClip * std::pow(farClip / nearClip, static_cast<float>(slice + 1) / slices);
+            sliceDepths.at(slice) = {begin, end};
+        }
+
+        // The view space extent of a tile edge at the given depth
+        auto tileEdge = [&camera](int tile, int tiles, bool horizontal, float depth) {
+            auto t = static_cast<float>(tile) / static_cast<float>(tiles);
+            if (camera.type == PERSPECTIVE) {
+                auto tanY = std::tan(degreesToRadians(camera.fov) / 2);
+                auto extent = horizontal ? tanY * camera.aspectRatio : tanY;
+                return (t * 2 - 1) * extent * depth;
+            } else if (horizontal) {
+                return camera.left + (camera.right - camera.left) * t;
+            } else {
+                return camera.bottom + (camera.top - camera.bottom) * t;
+            }
+        };
+
+        // The frustum edges are linear in depth, the bounds of a tile are given by the edges at the slice depth bounds
+        auto getRange = [&tileEdge](int tile, int tiles, bool horizontal, const Range &depth) {
+            auto a0 = tileEdge(tile, tiles, horizontal, depth.min);
+            auto a1 = tileEdge(tile, tiles, horizontal, depth.max);
+            auto b0 = tileEdge(tile + 1, tiles, horizontal, depth.min);
+            auto b1 = tileEdge(tile + 1, tiles, horizontal, depth.max);
+            return Range{std::min(a0, a1), std::max(b0, b1)};
+        };
+
+        columnRanges.resize(static_cast<size_t>(slices) * tilesX);
+        rowRanges.resize(static_cast<size_t>(slices) * tilesY);
+        for (int slice = 0; slice < slices; slice++) {
+            for (int x = 0; x < tilesX; x++) {
+                columnRanges.at(slice * tilesX + x) = getRange(x, tilesX, true, sliceDepths.at(slice));
+            }
+            for (int y = 0; y < tilesY; y++) {
+                rowRanges.at(slice * tilesY + y) = getRange(y, tilesY, false, sliceDepths.at(slice));
+            }
+        }
+
+        auto logRatio = std::log(farClip / nearClip);
+        info.viewportSize_depthScale_depthBias.at(2) = static_cast<float>(slices) / logRatio;
+        info.viewportSize_depthScale_depthBias.at(3) = static_cast<float>(slices) * std::log(nearClip) / logRatio;
+
+        boundsKey = key;
+        boundsValid = true;
+    }
+
+    void LightClusterGrid::binSlice(int slice,
+                                    const std::vector<Vec4f> &viewLights,
+                                    const std::vector<LightBounds> &lights) {
+        auto &depth = sliceDepths.at(slice);
+        auto *columns = columnRanges.data() + slice * tilesX;
+        auto *rows = rowRanges.data() + slice * tilesY;
+        auto sliceOffset = static_cast<size_t>(slice) * tilesX * tilesY;
+
+        for (size_t i = 0; i < viewLights.size(); i++) {
+            auto &light = viewLights[i];
+            auto radius = light.w;
+            if (light.z + radius < depth.min || light.z - radius > depth.max)
+                continue;
+
+            auto dz = std::max(std::max(depth.min - light.z, 0.0f), light.z - depth.max);
+            auto radiusSq = radius * radius - dz * dz;
+
+            for (int y = 0; y < tilesY; y++) {
+                auto &row = rows[y];
+                if (light.y + radius < row.min || light.y - radius > row.max)
+                    continue;
+                auto dy = std::max(std::max(row.min - light.y, 0.0f), light.y - row.max);
+                auto remainingSq = radiusSq - dy * dy;
+                if (remainingSq < 0)
+                    continue;
+                for (int x = 0; x < tilesX; x++) {
+                    auto &column = columns[x];
+                    auto dx = std::max(std::max(column.min - light.x, 0.0f), light.x - column.max);
+                    if (dx * dx > remainingSq)
+                        continue;
+                    bins.at(sliceOffset + y * tilesX + x).emplace_back(lights[i].index);
+                }
+            }
+        }
+    }
+
+    void LightClusterGrid::build(const Camera &camera,
+                                 const Mat4f &viewMatrix,
+                                 const Vec2i &viewportSize,
+                                 const std::vector<LightBounds> &lights) {
+        updateBounds(camera);
+
+        info.view = viewMatrix;
+        info.viewportSize_depthScale_depthBias.at(0) = static_cast<float>(viewportSize.x);
+        info.viewportSize_depthScale_depthBias.at(1) = static_cast<float>(viewportSize.y);
+
+        // xyz = view space position with z as positive depth, w = radius
+        std::vector<Vec4f> viewLights;
+        viewLights.reserve(lights.size());
+        for (auto &light: lights) {
+            auto v = viewMatrix * Vec4f(light.position.x, light.position.y, light.position.z, 1);
+            viewLights.emplace_back(v.x, v.y, -v.z, light.radius);
+        }
+
+        for (auto &bin: bins) {
+            bin.clear();
+        }
+
+        size_t chunks = 1;
+        if (lights.size() >= parallelThreshold) {
+            chunks = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(), slices));
+        }
+
+        parallelChunks(chunks, [&](size_t chunk) {
+            for (auto slice = chunk; slice < static_cast<size_t>(slices); slice += chunks) {
+                binSlice(static_cast<int>(slice), viewLights, lights);
+            }
+        });
+
+        size_t total = 0;
+        for (size_t i = 0; i < bins.size(); i++) {
+            clusters[i].offset = static_cast<uint32_t>(total);
+            clusters[i].count = static_cast<uint32_t>(bins[i].size());
+            total += bins[i].size();
+        }
+
+        lightIndices.resize(total);
+        for (size_t i = 0; i < bins.size(); i++) {
+            std::copy(bins[i].begin(), bins[i].end(), lightIndices.begin() + clusters[i].offset);
+        }
+    }
+
+    size_t LightClusterGrid::getClusterIndex(const Vec3f &worldPosition, const Vec2f &fragCoord) const {
+        auto v = info.view * Vec4f(worldPosition.x, worldPosition.y, worldPosition.z, 1);
+        auto depth = std::max(-v.z, std::numeric_limits<float>::min());
+
+        auto &params = info.viewportSize_depthScale_depthBias;
+        auto slice = static_cast<int>(std::floor(std::log(depth) * params.at(2) - params.at(3)));
+        auto x = static_cast<int>(std::floor(fragCoord.x / params.at(0) * static_cast<float>(tilesX)));
+        auto y = static_cast<int>(std::floor(fragCoord.y / params.at(1) * static_cast<float>(tilesY)));
+
+        slice = std::clamp(slice, 0, slices - 1);
+        x = std::clamp(x, 0, tilesX - 1);
+        y = std::clamp(y, 0, tilesY - 1);
+
+        return static_cast<size_t>(slice) * tilesX * tilesY + y * tilesX + x;
+    }
+}
@@ -27,6 +27,8 @@
 #include "resource/staticresource.hpp"
 
 #include "xng/render/geometry/vertexbuilder.hpp"
+#include "xng/render/geometry/meshsimplifier.hpp"
+#include "xng/render/geometry/vertexquantizer.hpp"
 
 static const std::string NORM_CUBE_OBJ = std::string(R"###(
 o Cube
@@ -188,6 +190,61 @@ namespace xng {
         throw std::runtime_error("Not Implemented");
     }
 
+    MeshOptimizer::Report Mesh::optimize() {
+        MeshOptimizer::Report ret;
+
+        if (primitive == TRIANGLES && !indices.empty()) {
+            ret.before = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+
+            std::vector<Vec3f> positions;
+            if (VertexQuantizer::isCompact(*this)
+                || (!vertexLayout.attributes.empty()
+                    && vertexLayout.attributes.at(0).type == VertexAttribute::VECTOR3
+                    && vertexLayout.attributes.at(0).component == VertexAttribute::FLOAT)) {
+                positions = MeshSimplifier::getPositions(*this);
+            }
+
+            auto optimizeIndices = [&](const std::vector<unsigned int> &value) {
+                auto optimized = MeshOptimizer::optimizeVertexCache(value, vertices.size());
+                if (!positions.empty()) {
+                    optimized = MeshOptimizer::optimizeOverdraw(optimized, positions);
+                }
+                return optimized;
+            };
+
+            indices = optimizeIndices(indices);
+            for (auto &lod: lods) {
+                lod.indices = optimizeIndices(lod.indices);
+            }
+
+            // The levels of detail are subsets of the full resolution mesh and share its vertex order
+            auto remap = MeshOptimizer::getVertexFetchRemap(indices, vertices.size());
+
+            std::vector<Vertex> remappedVertices(vertices.size());
+            for (size_t i = 0; i < vertices.size(); i++) {
+                remappedVertices.at(remap.at(i)) = std::move(vertices.at(i));
+            }
+            vertices = std::move(remappedVertices);
+
+            for (auto &index: indices) {
+                index = remap.at(index);
+            }
+            for (auto &lod: lods) {
+                for (auto &index: lod.indices) {
+                    index = remap.at(index);
+                }
+            }
+
+            ret.after = MeshOptimizer::analyzeVertexCache(indices, vertices.size());
+        }
+
+        for (auto &mesh: subMeshes) {
+            ret += mesh.optimize();
+        }
+
+        return ret;
+    }
+
     std::type_index Mesh::getTypeIndex() const {
         return typeid(Mesh);
     }
@@ -20,8 +20,18 @@
 #include "xng/render/graph/meshallocator.hpp"
 
 #include "xng/render/geometry/vertexstream.hpp"
+#include "xng/render/geometry/meshsimplifier.hpp"
+#include "xng/render/geometry/vertexquantizer.hpp"
 
 namespace xng {
+    MeshAllocator::MeshAllocator(VertexLayout vertexLayout)
+            : vertexLayout(std::move(vertexLayout)) {
+        if (this->vertexLayout != SkinnedMesh::getDefaultVertexLayout()
+            && this->vertexLayout != SkinnedMesh::getCompactVertexLayout()) {
+            throw std::runtime_error("Unsupported mesh allocator vertex layout");
+        }
+    }
+
     MeshAllocator::MeshAllocation MeshAllocator::getAllocatedMesh(const ResourceHandle<SkinnedMesh> &mesh) {
         return meshAllocations.at(mesh.getUri());
     }
@@ -37,6 +47,15 @@ namespace xng {
         auto vertexSize = mesh.vertices.size() * mesh.vertexLayout.getSize();
         auto baseVertex = allocateVertexData(vertexSize);
         data.baseVertex = baseVertex / mesh.vertexLayout.getSize();
+        data.positionOffset = mesh.positionOffset;
+        data.positionScale = mesh.positionScale;
+
+        for (auto &lod: mesh.lods) {
+            DrawCall drawCall;
+            drawCall.count = lod.indices.size();
+            drawCall.offset = allocateIndexData(lod.indices.size() * sizeof(unsigned int));
+            data.lods.emplace_back(drawCall);
+        }
 
         ret.data.emplace_back(data);
 
@@ -51,14 +70,60 @@ namespace xng {
     void MeshAllocator::prepareMeshAllocation(const ResourceHandle<SkinnedMesh> &mesh) {
         if (mesh.get().primitive != TRIANGLES) {
             throw std::runtime_error("Unsupported mesh primitive");
-        } else if (mesh.get().vertexLayout != SkinnedMesh::getDefaultVertexLayout()) {
+        } else if (mesh.get().vertexLayout != SkinnedMesh::getDefaultVertexLayout()
+                   && mesh.get().vertexLayout != SkinnedMesh::getCompactVertexLayout()) {
             throw std::runtime_error("Unsupported mesh vertex layout");
         } else if (mesh.get().indices.empty()) {
             throw std::runtime_error("Arrayed mesh not supported, must be indexed");
         }
         if (meshAllocations.find(mesh.getUri()) == meshAllocations.end()
             && pendingMeshAllocations.find(mesh.getUri()) == pendingMeshAllocations.end()) {
-            MeshAllocation mdata = allocateMesh(mesh.get());
+            const SkinnedMesh *uploadMesh = &mesh.get();
+            if (uploadMesh->vertexLayout != vertexLayout) {
+                auto converted = mesh.get();
+                if (vertexLayout == SkinnedMesh::getCompactVertexLayout()) {
+                    VertexQuantizer::quantize(converted);
+                } else {
+                    VertexQuantizer::dequantize(converted);
+                }
+                uploadMesh = &(pendingConvertedMeshes[mesh.getUri()] = std::move(converted));
+            }
+
+            MeshAllocation mdata = allocateMesh(*uploadMesh);
+
+            Vec3f min(std::numeric_limits<float>::max());
+            Vec3f max(std::numeric_limits<float>::lowest());
+            std::vector<Vec3f> positions;
+            for (auto i = 0; i < mesh.get().subMeshes.size() + 1; i++) {
+                const Mesh &m = i == 0 ? mesh.get() : mesh.get().subMeshes.at(i - 1);
+
+                for (auto &position: MeshSimplifier::getPositions(m)) {
+                    min = Vec3f(std::min(min.x, position.x), std::min(min.y, position.y), std::min(min.z, position.z));
+                    max = Vec3f(std::max(max.x, position.x), std::max(max.y, position.y), std::max(max.z, position.z));
+                    positions.emplace_back(position);
+                }
+
+                if (mdata.lodErrors.size() < m.lods.size() + 1) {
+                    mdata.lodErrors.resize(m.lods.size() + 1, 0);
+                }
+            }
+
+            // Sub meshes with fewer levels draw their coarsest level
+            for (auto i = 0; i < mesh.get().subMeshes.size() + 1; i++) {
+                const Mesh &m = i == 0 ? mesh.get() : mesh.get().subMeshes.at(i - 1);
+                for (auto lod = 1; lod < mdata.lodErrors.size(); lod++) {
+                    auto error = m.lods.empty() ? 0 : m.lods.at(std::min<size_t>(lod, m.lods.size()) - 1).error;
+                    mdata.lodErrors.at(lod) = std::max(mdata.lodErrors.at(lod), error);
+                }
+            }
+
+            Vec3f center = positions.empty() ? Vec3f() : (min + max) / 2.0f;
+            float radius = 0;
+            for (auto &position: positions) {
+                radius = std::max(radius, position.distance(center));
+            }
+            mdata.bounds = Vec4f(center.x, center.y, center.z, radius);
+
             pendingMeshAllocations[mesh.getUri()] = mdata;
             pendingMeshHandles[mesh.getUri()] = mesh;
         }
@@ -69,9 +134,11 @@ namespace xng {
                                      FrameGraphResource indexBuffer) {
         for (auto &pair: pendingMeshAllocations) {
             auto meshHandle = pendingMeshHandles.at(pair.first);
-            for (auto i = 0; i < meshHandle.get().subMeshes.size() + 1; i++) {
+            auto converted = pendingConvertedMeshes.find(pair.first);
+            const SkinnedMesh &mesh = converted == pendingConvertedMeshes.end() ? meshHandle.get() : converted->second;
+            for (auto i = 0; i < mesh.subMeshes.size() + 1; i++) {
                 auto &data = pair.second.data.at(i);
-                auto &curMesh = i == 0 ? meshHandle.get() : meshHandle.get().subMeshes.at(i - 1);
+                const Mesh &curMesh = i == 0 ? mesh : mesh.subMeshes.at(i - 1);
 
                 builder.upload(vertexBuffer,
                                data.baseVertex * curMesh.vertexLayout.getSize(),
@@ -87,19 +154,30 @@ namespace xng {
                                    assert(pair.second.data.size() > i);
                                    return FrameGraphUploadBuffer::createArray(curMesh.indices);
                                });
+                for (auto lod = 0; lod < data.lods.size(); lod++) {
+                    builder.upload(indexBuffer,
+                                   data.lods.at(lod).offset,
+                                   [curMesh, lod]() {
+                                       return FrameGraphUploadBuffer::createArray(curMesh.lods.at(lod).indices);
+                                   });
+                }
             }
             meshAllocations[pair.first] = pair.second;
         }
         pendingMeshAllocations.clear();
         pendingMeshHandles.clear();
+        pendingConvertedMeshes.clear();
     }
 
     void MeshAllocator::deallocateMesh(const ResourceHandle<SkinnedMesh> &mesh) {
         auto alloc = meshAllocations.at(mesh.getUri());
         meshAllocations.erase(mesh.getUri());
         for (auto &data: alloc.data) {
-            deallocateVertexData(data.baseVertex * mesh.get().vertexLayout.getSize());
+            deallocateVertexData(data.baseVertex * vertexLayout.getSize());
             deallocateIndexData(data.drawCall.offset);
+            for (auto &lod: data.lods) {
+                deallocateIndexData(lod.offset);
+            }
         }
         mergeFreeVertexBufferRanges();
         mergeFreeIndexBufferRanges();
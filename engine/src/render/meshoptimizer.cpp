@@ -0,0 +1,394 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/geometry/meshoptimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace xng {
+    namespace {
+        const size_t FORSYTH_CACHE_SIZE = 32;
+        const float FORSYTH_LAST_TRIANGLE_SCORE = 0.75f;
+        const float FORSYTH_CACHE_DECAY_POWER = 1.5f;
+        const float FORSYTH_VALENCE_BOOST_SCALE = 2.0f;
+        const float FORSYTH_VALENCE_BOOST_POWER = 0.5f;
+
+        // The cache size used for the overdraw cluster boundaries
+        const size_t OVERDRAW_CACHE_SIZE = 16;
+
+        float getVertexScore(int cachePosition, unsigned int valence) {
+            if (valence == 0) {
+                return -1;
+            }
+
+            float ret = 0;
+            if (cachePosition >= 0) {
+                if (cachePosition < 3) {
+                    // The vertices of the last triangle are penalized so that strips do not turn back
+                    ret = FORSYTH_LAST_TRIANGLE_SCORE;
+                } else {
+                    auto scale = 1.0f / static_cast<float>(FORSYTH_CACHE_SIZE - 3);
+                    ret = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, FORSYTH_CACHE_DECAY_POWER);
+                }
+            }
+
+            // Vertices with few remaining triangles are preferred so that lone triangles are not left behind
+            ret += FORSYTH_VALENCE_BOOST_SCALE * std::pow(static_cast<float>(valence), -FORSYTH_VALENCE_BOOST_POWER);
+            return ret;
+        }
+
+        /**
+         * FIFO cache simulation which uses the time at which each vertex was inserted instead of a queue.
+         */
+        class CacheSimulation {
+        public:
+            CacheSimulation(size_t vertexCount, size_t cacheSize)
+                    : timestamps(vertexCount, 0), cacheSize(cacheSize), time(cacheSize + 1) {}
+
+            /**
+             * @return The number of misses
+             */
+            size_t addTriangle(unsigned int a, unsigned int b, unsigned int c) {
+                return addVertex(a) + addVertex(b) + addVertex(c);
+            }
+
+            void flush() {
+                time += cacheSize + 1;
+            }
+
+        private:
+            size_t addVertex(unsigned int v) {
+                if (time - timestamps.at(v) > cacheSize) {
+                    timestamps.at(v) = time++;
+                    return 1;
+                }
+                return 0;
+            }
+
+            std::vector<size_t> timestamps;
+            size_t cacheSize;
+            size_t time;
+        };
+
+        void checkIndices(const std::vector<unsigned int> &indices, size_t vertexCount) {
+            if (indices.size() % 3 != 0) {
+                throw std::runtime_error("Mesh optimization requires a triangle list");
+            }
+            for (auto index: indices) {
+                if (index >= vertexCount) {
+                    throw std::runtime_error("Mesh index out of range");
+                }
+            }
+        }
+    }
+
+    MeshOptimizer::Statistics MeshOptimizer::analyzeVertexCache(const std::vector<unsigned int> &indices,
+                                                                size_t vertexCount,
+                                                                size_t cacheSize) {
+        checkIndices(indices, vertexCount);
+
+        Statistics ret;
+        ret.triangles = indices.size() / 3;
+
+        std::vector<bool> used(vertexCount, false);
+        CacheSimulation cache(vertexCount, cacheSize);
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            ret.transformedVertices += cache.addTriangle(indices.at(i), indices.at(i + 1), indices.at(i + 2));
+        }
+        for (auto index: indices) {
+            if (!used.at(index)) {
+                used.at(index) = true;
+                ret.vertices++;
+            }
+        }
+        return ret;
+    }
+
+    std::vector<unsigned int> MeshOptimizer::optimizeVertexCache(const std::vector<unsigned int> &indices,
+                                                                 size_t vertexCount) {
+        checkIndices(indices, vertexCount);
+
+        auto triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return indices;
+        }
+
+        // Vertex to triangle adjacency, the first liveTriangles entries of each vertex are the triangles not yet emitted
+        std::vector<unsigned int> liveTriangles(vertexCount, 0);
+        for (auto index: indices) {
+            liveTriangles.at(index)++;
+        }
+        std::vector<unsigned int> offsets(vertexCount + 1, 0);
+        for (size_t i = 0; i < vertexCount; i++) {
+            offsets.at(i + 1) = offsets.at(i) + liveTriangles.at(i);
+        }
+        std::vector<unsigned int> adjacency(indices.size());
+        {
+            auto fill = offsets;
+            for (size_t i = 0; i < indices.size(); i++) {
+                adjacency.at(fill.at(indices.at(i))++) = static_cast<unsigned int>(i / 3);
+            }
+        }
+
+        std::vector<int> cachePositions(vertexCount, -1);
+        std::vector<float> vertexScores(vertexCount);
+        for (size_t i = 0; i < vertexCount; i++) {
+            vertexScores.at(i) = getVertexScore(-1, liveTriangles.at(i));
+        }
+
+        std::vector<float> triangleScores(triangleCount);
+        for (size_t t = 0; t < triangleCount; t++) {
+            triangleScores.at(t) = vertexScores.at(indices.at(t * 3))
+                                   + vertexScores.at(indices.at(t * 3 + 1))
+                                   + vertexScores.at(indices.at(t * 3 + 2));
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+
+        std::vector<unsigned int> cache;
+        std::vector<unsigned int> newCache;
+        cache.reserve(FORSYTH_CACHE_SIZE + 3);
+        newCache.reserve(FORSYTH_CACHE_SIZE + 3);
+
+        std::vector<unsigned int> ret;
+        ret.reserve(indices.size());
+
+        auto bestTriangle = static_cast<size_t>(std::max_element(triangleScores.begin(), triangleScores.end())
+                                                - triangleScores.begin());
+        size_t nextUnemitted = 0;
+
+        while (ret.size() < indices.size()) {
+            if (bestTriangle == std::numeric_limits<size_t>::max()) {
+                // No triangle of the cached vertices remains, continue with the next triangle in input order
+                while (emitted.at(nextUnemitted)) {
+                    nextUnemitted++;
+                }
+                bestTriangle = nextUnemitted;
+            }
+
+            auto triangle = bestTriangle;
+            emitted.at(triangle) = true;
+
+            newCache.clear();
+            for (int v = 0; v < 3; v++) {
+                auto vertex = indices.at(triangle * 3 + v);
+                ret.emplace_back(vertex);
+                newCache.emplace_back(vertex);
+
+                // Remove the triangle from the live triangles of the vertex
+                auto begin = adjacency.begin() + offsets.at(vertex);
+                auto end = begin + liveTriangles.at(vertex);
+                auto it = std::find(begin, end, static_cast<unsigned int>(triangle));
+                std::iter_swap(it, end - 1);
+                liveTriangles.at(vertex)--;
+            }
+
+            for (auto vertex: cache) {
+                if (newCache.size() >= FORSYTH_CACHE_SIZE + 3) {
+                    break;
+                }
+                if (vertex != newCache.at(0) && vertex != newCache.at(1) && vertex != newCache.at(2)) {
+                    newCache.emplace_back(vertex);
+                }
+            }
+
+            // Vertices which dropped out of the cache
+            for (auto vertex: cache) {
+                if (std::find(newCache.begin(), newCache.end(), vertex) == newCache.end()) {
+                    cachePositions.at(vertex) = -1;
+                    vertexScores.at(vertex) = getVertexScore(-1, liveTriangles.at(vertex));
+                }
+            }
+
+            for (size_t i = 0; i < newCache.size(); i++) {
+                auto vertex = newCache.at(i);
+                cachePositions.at(vertex) = i < FORSYTH_CACHE_SIZE ? static_cast<int>(i) : -1;
+                vertexScores.at(vertex) = getVertexScore(cachePositions.at(vertex), liveTriangles.at(vertex));
+            }
+
+            std::swap(cache, newCache);
+
+            // Only the triangles of cached vertices changed their score
+            bestTriangle = std::numeric_limits<size_t>::max();
+            float bestScore = -1;
+            for (auto vertex: cache) {
+                for (auto i = offsets.at(vertex); i < offsets.at(vertex) + liveTriangles.at(vertex); i++) {
+                    auto t = adjacency.at(i);
+                    auto score = vertexScores.at(indices.at(t * 3))
+                                 + vertexScores.at(indices.at(t * 3 + 1))
+                                 + vertexScores.at(indices.at(t * 3 + 2));
+                    triangleScores.at(t) = score;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestTriangle = t;
+                    }
+                }
+            }
+        }
+
+        return ret;
+    }
+
+    std::vector<unsigned int> MeshOptimizer::optimizeOverdraw(const std::vector<unsigned int> &indices,
+                                                              const std::vector<Vec3f> &positions,
+                                                              float threshold) {
+        checkIndices(indices, positions.size());
+
+        auto triangleCount = indices.size() / 3;
+        if (triangleCount == 0) {
+            return indices;
+        }
+
+        // Hard boundaries where the cache misses all vertices of a triangle
+        std::vector<size_t> hardBoundaries;
+        {
+            CacheSimulation cache(positions.size(), OVERDRAW_CACHE_SIZE);
+            for (size_t t = 0; t < triangleCount; t++) {
+                auto misses = cache.addTriangle(indices.at(t * 3), indices.at(t * 3 + 1), indices.at(t * 3 + 2));
+                if (t == 0 || misses == 3) {
+                    hardBoundaries.emplace_back(t);
+                }
+            }
+            hardBoundaries.emplace_back(triangleCount);
+        }
+
+        // Soft boundaries where the cache miss ratio of the cluster is below threshold times the ratio of the hard cluster
+        std::vector<size_t> boundaries;
+        {
+            CacheSimulation cache(positions.size(), OVERDRAW_CACHE_SIZE);
+            for (size_t c = 0; c + 1 < hardBoundaries.size(); c++) {
+                auto begin = hardBoundaries.at(c);
+                auto end = hardBoundaries.at(c + 1);
+
+                cache.flush();
+                size_t clusterMisses = 0;
+                for (auto t = begin; t < end; t++) {
+                    clusterMisses += cache.addTriangle(indices.at(t * 3), indices.at(t * 3 + 1), indices.at(t * 3 + 2));
+                }
+                auto clusterThreshold = threshold * static_cast<float>(clusterMisses) / static_cast<float>(end - begin);
+
+                cache.flush();
+                boundaries.emplace_back(begin);
+                auto start = begin;
+                size_t misses = 0;
+                for (auto t = begin; t < end; t++) {
+                    misses += cache.addTriangle(indices.at(t * 3), indices.at(t * 3 + 1), indices.at(t * 3 + 2));
+                    if (t + 1 < end
+                        && static_cast<float>(misses) <= clusterThreshold * static_cast<float>(t + 1 - start)) {
+                        boundaries.emplace_back(t + 1);
+                        start = t + 1;
+                        misses = 0;
+                        cache.flush();
+                    }
+                }
+            }
+            boundaries.emplace_back(triangleCount);
+        }
+
+        // Sort the clusters by how much they face away from the mesh center
+        auto getNormal = [&](size_t t, Vec3f &centroid) {
+            auto &a = positions.at(indices.at(t * 3));
+            auto &b = positions.at(indices.at(t * 3 + 1));
+            auto &c = positions.at(indices.at(t * 3 + 2));
+            auto u = b - a;
+            auto v = c - a;
+            centroid = (a + b + c) / 3.0f;
+            // The length of the cross product weights the normal and centroid by the triangle area
+            return Vec3f(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+        };
+
+        Vec3f meshCenter;
+        float meshArea = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            Vec3f centroid;
+            auto area = getNormal(t, centroid).magnitude();
+            meshCenter += centroid * area;
+            meshArea += area;
+        }
+        if (meshArea > 0) {
+            meshCenter = meshCenter / meshArea;
+        }
+
+        struct Cluster {
+            size_t begin;
+            size_t end;
+            float key;
+        };
+        std::vector<Cluster> clusters;
+        for (size_t c = 0; c + 1 < boundaries.size(); c++) {
+            Cluster cluster{boundaries.at(c), boundaries.at(c + 1), 0};
+
+            Vec3f center;
+            Vec3f normal;
+            float area = 0;
+            for (auto t = cluster.begin; t < cluster.end; t++) {
+                Vec3f centroid;
+                auto n = getNormal(t, centroid);
+                auto a = n.magnitude();
+                center += centroid * a;
+                normal += n;
+                area += a;
+            }
+            if (area > 0) {
+                center = center / area;
+                auto length = normal.magnitude();
+                if (length > 0) {
+                    normal = normal / length;
+                }
+                auto offset = center - meshCenter;
+                cluster.key = offset.x * normal.x + offset.y * normal.y + offset.z * normal.z;
+            }
+            clusters.emplace_back(cluster);
+        }
+
+        std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster &lhs, const Cluster &rhs) {
+            return lhs.key > rhs.key;
+        });
+
+        std::vector<unsigned int> ret;
+        ret.reserve(indices.size());
+        for (auto &cluster: clusters) {
+            ret.insert(ret.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+        }
+        return ret;
+    }
+
+    std::vector<unsigned int> MeshOptimizer::getVertexFetchRemap(const std::vector<unsigned int> &indices,
+                                                                 size_t vertexCount) {
+        checkIndices(indices, vertexCount);
+
+        const auto unassigned = std::numeric_limits<unsigned int>::max();
+        std::vector<unsigned int> ret(vertexCount, unassigned);
+        unsigned int next = 0;
+        for (auto index: indices) {
+            if (ret.at(index) == unassigned) {
+                ret.at(index) = next++;
+            }
+        }
+        for (auto &index: ret) {
+            if (index == unassigned) {
+                index = next++;
+            }
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,554 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/geometry/meshsimplifier.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "xng/render/geometry/vertexquantizer.hpp"
+
+namespace xng {
+    namespace {
+        struct Point {
+            double x = 0, y = 0, z = 0;
+
+            Point operator+(const Point &o) const { return {x + o.x, y + o.y, z + o.z}; }
+
+            Point operator-(const Point &o) const { return {x - o.x, y - o.y, z - o.z}; }
+
+            Point operator*(double s) const { return {x * s, y * s, z * s}; }
+
+            double dot(const Point &o) const { return x * o.x + y * o.y + z * o.z; }
+
+            Point cross(const Point &o) const { return {y * o.z - z * o.y, z * o.x - x * o.z, x * o.y - y * o.x}; }
+
+            double length() const { return std::sqrt(dot(*this)); }
+        };
+
+        /**
+         * The symmetric 4x4 matrix of the sum of squared distances to a set of planes, weighted by the plane areas.
+         */
+        struct Quadric {
+            double a00 = 0, a11 = 0, a22 = 0, a01 = 0, a02 = 0, a12 = 0;
+            double b0 = 0, b1 = 0, b2 = 0;
+            double c = 0;
+            double weight = 0;
+
+            void addPlane(const Point &n, double d, double w) {
+                a00 += w * n.x * n.x;
+                a11 += w * n.y * n.y;
+                a22 += w * n.z * n.z;
+                a01 += w * n.x * n.y;
+                a02 += w * n.x * n.z;
+                a12 += w * n.y * n.z;
+                b0 += w * n.x * d;
+                b1 += w * n.y * d;
+                b2 += w * n.z * d;
+                c += w * d * d;
+                weight += w;
+            }
+
+            void add(const Quadric &o) {
+                a00 += o.a00;
+                a11 += o.a11;
+                a22 += o.a22;
+                a01 += o.a01;
+                a02 += o.a02;
+                a12 += o.a12;
+                b0 += o.b0;
+                b1 += o.b1;
+                b2 += o.b2;
+                c += o.c;
+                weight += o.weight;
+            }
+
+            double evaluate(const Point &p) const {
+                auto r = a00 * p.x * p.x + a11 * p.y * p.y + a22 * p.z * p.z
+                         + 2 * (a01 * p.x * p.y + a02 * p.x * p.z + a12 * p.y * p.z)
+                         + 2 * (b0 * p.x + b1 * p.y + b2 * p.z)
+                         + c;
+                return std::fabs(r);
+            }
+        };
+
+        enum VertexKind {
+            VERTEX_MANIFOLD,
+            VERTEX_BORDER, // Only collapsed along border edges onto other border or locked vertices
+            VERTEX_LOCKED // Never collapsed
+        };
+
+        struct Collapse {
+            unsigned int from;
+            unsigned int to;
+            double cost;
+        };
+
+        // Border edges carry a larger weight so that the silhouette of open meshes is preserved
+        const double BORDER_WEIGHT = 10;
+
+        uint64_t getEdgeKey(unsigned int a, unsigned int b) {
+            return (static_cast<uint64_t>(a) << 32) | b;
+        }
+
+        struct PositionHash {
+            size_t operator()(const std::array<uint32_t, 3> &v) const {
+                return (v[0] * 73856093u) ^ (v[1] * 19349663u) ^ (v[2] * 83492791u);
+            }
+        };
+
+        Point closestPointOnTriangle(const Point &p, const Point &a, const Point &b, const Point &c) {
+            auto ab = b - a;
+            auto ac = c - a;
+            auto ap = p - a;
+            auto d1 = ab.dot(ap);
+            auto d2 = ac.dot(ap);
+            if (d1 <= 0 && d2 <= 0)
+                return a;
+
+            auto bp = p - b;
+            auto d3 = ab.dot(bp);
+            auto d4 = ac.dot(bp);
+            if (d3 >= 0 && d4 <= d3)
+                return b;
+
+            auto vc = d1 * d4 - d3 * d2;
+            if (vc <= 0 && d1 >= 0 && d3 <= 0)
+                return a + ab * (d1 / (d1 - d3));
+
+            auto cp = p - c;
+            auto d5 = ab.dot(cp);
+            auto d6 = ac.dot(cp);
+            if (d6 >= 0 && d5 <= d6)
+                return c;
+
+            auto vb = d5 * d2 - d1 * d6;
+            if (vb <= 0 && d2 >= 0 && d6 <= 0)
+                return a + ac * (d2 / (d2 - d6));
+
+            auto va = d3 * d6 - d5 * d4;
+            if (va <= 0 && (d4 - d3) >= 0 && (d5 - d6) >= 0)
+                return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+            auto denom = 1 / (va + vb + vc);
+            return a + ab * (vb * denom) + ac * (vc * denom);
+        }
+    }
+
+    MeshSimplifier::Result MeshSimplifier::simplify(const std::vector<Vec3f> &positions,
+                                                    const std::vector<unsigned int> &indices,
+                                                    size_t targetIndexCount,
+                                                    float maxError) {
+        if (indices.size() % 3 != 0) {
+            throw std::runtime_error("Mesh simplification requires a triangle list");
+        }
+
+        Result ret;
+        ret.indices = indices;
+
+        if (positions.empty() || indices.size() <= targetIndexCount) {
+            return ret;
+        }
+
+        // Positions are normalized to the unit cube for numerical stability and scale independent errors
+        Vec3f min(std::numeric_limits<float>::max());
+        Vec3f max(std::numeric_limits<float>::lowest());
+        for (auto &p: positions) {
+            min = Vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+            max = Vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+        }
+        double extent = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+        if (extent <= 0) {
+            extent = 1;
+        }
+
+        std::vector<Point> points(positions.size());
+        for (size_t i = 0; i < positions.size(); i++) {
+            auto &p = positions.at(i);
+            points[i] = Point{(p.x - min.x) / extent, (p.y - min.y) / extent, (p.z - min.z) / extent};
+        }
+
+        // Vertices which share their position with another vertex lie on an attribute seam
+        std::vector<bool> seam(positions.size(), false);
+        {
+            std::unordered_map<std::array<uint32_t, 3>, unsigned int, PositionHash> firstVertex;
+            for (unsigned int i = 0; i < positions.size(); i++) {
+                std::array<uint32_t, 3> key{};
+                std::memcpy(key.data(), &positions.at(i).x, sizeof(float) * 3);
+                auto it = firstVertex.insert({key, i});
+                if (!it.second) {
+                    seam.at(i) = true;
+                    seam.at(it.first->second) = true;
+                }
+            }
+        }
+
+        std::vector<Quadric> quadrics(positions.size());
+        std::vector<VertexKind> kinds(positions.size());
+        std::unordered_set<uint64_t> edges;
+
+        // The quadrics are computed once from the source triangles and accumulated by the collapses
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            for (int e = 0; e < 3; e++) {
+                edges.insert(getEdgeKey(indices.at(i + e), indices.at(i + (e + 1) % 3)));
+            }
+        }
+
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            auto &p0 = points.at(indices.at(i));
+            auto &p1 = points.at(indices.at(i + 1));
+            auto &p2 = points.at(indices.at(i + 2));
+            auto normal = (p1 - p0).cross(p2 - p0);
+            auto area = normal.length();
+            if (area <= 0) {
+                continue;
+            }
+            normal = normal * (1 / area);
+            auto d = -normal.dot(p0);
+            for (int v = 0; v < 3; v++) {
+                quadrics.at(indices.at(i + v)).addPlane(normal, d, area * 0.5);
+            }
+
+            for (int e = 0; e < 3; e++) {
+                auto a = indices.at(i + e);
+                auto b = indices.at(i + (e + 1) % 3);
+                if (edges.find(getEdgeKey(b, a)) == edges.end()) {
+                    auto edge = points.at(b) - points.at(a);
+                    auto borderNormal = edge.cross(normal);
+                    auto length = borderNormal.length();
+                    if (length <= 0) {
+                        continue;
+                    }
+                    borderNormal = borderNormal * (1 / length);
+                    auto borderD = -borderNormal.dot(points.at(a));
+                    auto weight = edge.dot(edge) * BORDER_WEIGHT;
+                    quadrics.at(a).addPlane(borderNormal, borderD, weight);
+                    quadrics.at(b).addPlane(borderNormal, borderD, weight);
+                }
+            }
+        }
+
+        auto maxCost = static_cast<double>(maxError) * static_cast<double>(maxError);
+        double errorCost = 0;
+
+        std::vector<unsigned int> remap(positions.size());
+        std::vector<bool> locked(positions.size());
+        std::vector<unsigned int> triangleOffsets(positions.size() + 1);
+        std::vector<unsigned int> triangles;
+        std::vector<Collapse> collapses;
+
+        auto &result = ret.indices;
+
+        // Each pass collapses the cheapest independent edges, vertices adjacent to a collapse are locked until the next pass
+        while (result.size() > targetIndexCount) {
+            // Vertex to triangle adjacency
+            std::fill(triangleOffsets.begin(), triangleOffsets.end(), 0);
+            for (auto index: result) {
+                triangleOffsets.at(index + 1)++;
+            }
+            for (size_t i = 1; i < triangleOffsets.size(); i++) {
+                triangleOffsets.at(i) += triangleOffsets.at(i - 1);
+            }
+            triangles.resize(result.size());
+            {
+                auto offsets = triangleOffsets;
+                for (size_t i = 0; i < result.size(); i++) {
+                    triangles.at(offsets.at(result.at(i))++) = static_cast<unsigned int>(i / 3);
+                }
+            }
+
+            // Whether a triangle contains the directed edge
+            auto hasEdge = [&](unsigned int a, unsigned int b) {
+                for (auto t = triangleOffsets.at(a); t < triangleOffsets.at(a + 1); t++) {
+                    auto triangle = triangles.at(t) * 3;
+                    for (int e = 0; e < 3; e++) {
+                        if (result.at(triangle + e) == a && result.at(triangle + (e + 1) % 3) == b) {
+                            return true;
+                        }
+                    }
+                }
+                return false;
+            };
+
+            std::fill(kinds.begin(), kinds.end(), VERTEX_MANIFOLD);
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (int e = 0; e < 3; e++) {
+                    auto a = result.at(i + e);
+                    auto b = result.at(i + (e + 1) % 3);
+                    if (!hasEdge(b, a)) {
+                        kinds.at(a) = VERTEX_BORDER;
+                        kinds.at(b) = VERTEX_BORDER;
+                    }
+                }
+            }
+            for (size_t i = 0; i < kinds.size(); i++) {
+                if (seam.at(i)) {
+                    kinds.at(i) = VERTEX_LOCKED;
+                }
+            }
+
+            auto getCost = [&](unsigned int from, unsigned int to) {
+                auto q = quadrics.at(from);
+                q.add(quadrics.at(to));
+                return q.weight > 0 ? q.evaluate(points.at(to)) / q.weight : 0.0;
+            };
+
+            auto canCollapse = [&](unsigned int from, unsigned int to) {
+                switch (kinds.at(from)) {
+                    case VERTEX_MANIFOLD:
+                        return true;
+                    case VERTEX_BORDER:
+                        // The edge must be a border edge in the direction of the collapse
+                        return kinds.at(to) != VERTEX_MANIFOLD
+                               && (!hasEdge(from, to) || !hasEdge(to, from));
+                    default:
+                        return false;
+                }
+            };
+
+            collapses.clear();
+            for (size_t i = 0; i < result.size(); i += 3) {
+                for (int e = 0; e < 3; e++) {
+                    auto a = result.at(i + e);
+                    auto b = result.at(i + (e + 1) % 3);
+                    bool border = !hasEdge(b, a);
+                    // Interior edges are visited from both adjacent triangles
+                    if (!border && a > b) {
+                        continue;
+                    }
+
+                    Collapse collapse{0, 0, std::numeric_limits<double>::max()};
+                    if (canCollapse(a, b)) {
+                        collapse = {a, b, getCost(a, b)};
+                    }
+                    if (canCollapse(b, a)) {
+                        auto cost = getCost(b, a);
+                        if (cost < collapse.cost) {
+                            collapse = {b, a, cost};
+                        }
+                    }
+                    if (collapse.cost <= maxCost) {
+                        collapses.emplace_back(collapse);
+                    }
+                }
+            }
+
+            std::sort(collapses.begin(), collapses.end(), [](const Collapse &lhs, const Collapse &rhs) {
+                return lhs.cost < rhs.cost;
+            });
+
+            // An interior collapse removes two triangles
+            auto collapseLimit = (result.size() - targetIndexCount) / 6 + 1;
+            size_t collapseCount = 0;
+
+            for (unsigned int i = 0; i < remap.size(); i++) {
+                remap.at(i) = i;
+            }
+            std::fill(locked.begin(), locked.end(), false);
+
+            for (auto &collapse: collapses) {
+                if (collapseCount >= collapseLimit) {
+                    break;
+                }
+
+                auto from = collapse.from;
+                auto to = collapse.to;
+                if (locked.at(from) || locked.at(to)) {
+                    continue;
+                }
+
+                // Reject collapses which flip the remaining triangles of the source vertex
+                bool flipped = false;
+                for (auto t = triangleOffsets.at(from); t < triangleOffsets.at(from + 1) && !flipped; t++) {
+                    auto triangle = triangles.at(t) * 3;
+                    std::array<unsigned int, 3> tri = {result.at(triangle),
+                                                       result.at(triangle + 1),
+                                                       result.at(triangle + 2)};
+                    if (tri[0] == to || tri[1] == to || tri[2] == to) {
+                        continue;
+                    }
+                    auto before = (points.at(tri[1]) - points.at(tri[0])).cross(points.at(tri[2]) - points.at(tri[0]));
+                    for (auto &v: tri) {
+                        if (v == from)
+                            v = to;
+                    }
+                    auto after = (points.at(tri[1]) - points.at(tri[0])).cross(points.at(tri[2]) - points.at(tri[0]));
+                    flipped = after.dot(before) <= 0;
+                }
+                if (flipped) {
+                    continue;
+                }
+
+                remap.at(from) = to;
+                quadrics.at(to).add(quadrics.at(from));
+                errorCost = std::max(errorCost, collapse.cost);
+                collapseCount++;
+
+                for (auto v: {from, to}) {
+                    for (auto t = triangleOffsets.at(v); t < triangleOffsets.at(v + 1); t++) {
+                        auto triangle = triangles.at(t) * 3;
+                        locked.at(result.at(triangle)) = true;
+                        locked.at(result.at(triangle + 1)) = true;
+                        locked.at(result.at(triangle + 2)) = true;
+                    }
+                }
+            }
+
+            if (collapseCount == 0) {
+                break;
+            }
+
+            // Apply the collapses and remove the degenerate triangles
+            size_t write = 0;
+            for (size_t i = 0; i < result.size(); i += 3) {
+                auto a = remap.at(result.at(i));
+                auto b = remap.at(result.at(i + 1));
+                auto c = remap.at(result.at(i + 2));
+                if (a != b && b != c && a != c) {
+                    result.at(write++) = a;
+                    result.at(write++) = b;
+                    result.at(write++) = c;
+                }
+            }
+            result.resize(write);
+        }
+
+        ret.error = static_cast<float>(std::sqrt(errorCost) * extent);
+
+        return ret;
+    }
+
+    void MeshSimplifier::generateLods(Mesh &mesh, const LodSettings &settings) {
+        mesh.lods.clear();
+
+        if (mesh.primitive == TRIANGLES
+            && !mesh.indices.empty()
+            && mesh.indices.size() / 3 >= settings.minTriangles) {
+            auto positions = getPositions(mesh);
+
+            Vec3f min(std::numeric_limits<float>::max());
+            Vec3f max(std::numeric_limits<float>::lowest());
+            for (auto &p: positions) {
+                min = Vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+                max = Vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+            }
+            auto extent = std::max({max.x - min.x, max.y - min.y, max.z - min.z});
+
+            auto previousCount = mesh.indices.size();
+            float previousError = 0;
+            auto target = static_cast<float>(mesh.indices.size());
+            for (size_t i = 0; i < settings.maxLods; i++) {
+                target *= settings.reduction;
+                auto targetCount = static_cast<size_t>(target) / 3 * 3;
+                if (targetCount < 3) {
+                    break;
+                }
+
+                auto result = simplify(positions, mesh.indices, targetCount, settings.maxError);
+
+                // The error bound was reached before the level became significantly smaller than the previous level
+                if (result.indices.empty()
+                    || static_cast<float>(result.indices.size())
+                    > static_cast<float>(previousCount) * (1 + settings.reduction) / 2) {
+                    break;
+                }
+
+                Mesh::Lod lod;
+                lod.indices = std::move(result.indices);
+                lod.error = std::max(result.error, previousError);
+                if (extent <= 0) {
+                    lod.error = 0;
+                }
+
+                previousCount = lod.indices.size();
+                previousError = lod.error;
+
+                mesh.lods.emplace_back(std::move(lod));
+            }
+        }
+
+        for (auto &subMesh: mesh.subMeshes) {
+            generateLods(subMesh, settings);
+        }
+    }
+
+    std::vector<Vec3f> MeshSimplifier::getPositions(const Mesh &mesh) {
+        if (VertexQuantizer::isCompact(mesh)) {
+            std::vector<Vec3f> ret;
+            ret.reserve(mesh.vertices.size());
+            for (auto &vertex: mesh.vertices) {
+                ret.emplace_back(VertexQuantizer::getPosition(mesh, vertex));
+            }
+            return ret;
+        }
+
+        if (mesh.vertexLayout.getSize() > 0) {
+            auto &attribute = mesh.vertexLayout.attributes.at(0);
+            if (attribute.type != VertexAttribute::VECTOR3 || attribute.component != VertexAttribute::FLOAT) {
+                throw std::runtime_error("The first vertex attribute must be a float vector3 position");
+            }
+        }
+
+        std::vector<Vec3f> ret;
+        ret.reserve(mesh.vertices.size());
+        for (auto &vertex: mesh.vertices) {
+            Vec3f position;
+            std::memcpy(&position.x, vertex.buffer.data(), sizeof(float) * 3);
+            ret.emplace_back(position);
+        }
+        return ret;
+    }
+
+    float MeshSimplifier::getDistanceError(const std::vector<Vec3f> &positions,
+                                           const std::vector<unsigned int> &indices,
+                                           const std::vector<unsigned int> &simplifiedIndices) {
+        auto toPoint = [](const Vec3f &v) {
+            return Point{v.x, v.y, v.z};
+        };
+
+        // Only vertices which are referenced by the source triangles are part of the surface
+        std::vector<bool> used(positions.size(), false);
+        for (auto index: indices) {
+            used.at(index) = true;
+        }
+
+        double ret = 0;
+        for (size_t i = 0; i < positions.size(); i++) {
+            if (!used.at(i)) {
+                continue;
+            }
+            auto p = toPoint(positions.at(i));
+            auto distance = std::numeric_limits<double>::max();
+            for (size_t t = 0; t < simplifiedIndices.size(); t += 3) {
+                auto closest = closestPointOnTriangle(p,
+                                                      toPoint(positions.at(simplifiedIndices.at(t))),
+                                                      toPoint(positions.at(simplifiedIndices.at(t + 1))),
+                                                      toPoint(positions.at(simplifiedIndices.at(t + 2))));
+                distance = std::min(distance, (closest - p).length());
+            }
+            ret = std::max(ret, distance);
+        }
+        return static_cast<float>(ret);
+    }
+}
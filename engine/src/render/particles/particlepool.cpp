@@ -0,0 +1,341 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Lesser General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 3 of the License, or (at your option) any later version.
+
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Lesser General Public License for more details.
+
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "xng/render/particles/particlepool.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cstring>
+
+#include "async/parallelchunks.hpp"
+
+namespace xng {
+    static const size_t MIN_CHUNK_SIZE = 4096;
+
+    static size_t getChunkCount(size_t size, size_t threshold) {
+        if (size >= threshold && size > MIN_CHUNK_SIZE) {
+            return std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+                                                        size / MIN_CHUNK_SIZE));
+        }
+        return 1;
+    }
+
+    /**
+     * Split the range [0, size) into chunks and invoke fn(begin, end, chunkIndex) for each chunk in parallel.
+     */
+    template<typename F>
+    static void parallelFor(size_t size, size_t threshold, F fn) {
+        auto chunks = getChunkCount(size, threshold);
+        auto chunkSize = (size + chunks - 1) / chunks;
+        parallelChunks(chunks, [&](size_t chunk) {
+            auto begin = std::min(size, chunk * chunkSize);
+            auto end = std::min(size, begin + chunkSize);
+            fn(begin, end, chunk);
+        });
+    }
+
+    // https://prng.di.unimi.it/splitmix64.c
+    static uint64_t splitMix64(uint64_t &state) {
+        uint64_t z = (state += 0x9e3779b97f4a7c15);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+        return z ^ (z >> 31);
+    }
+
+    static float randomFloat(uint64_t &state) {
+        return static_cast<float>(splitMix64(state) >> 40) / static_cast<float>(1 << 24);
+    }
+
+    static float randomRange(uint64_t &state, float min, float max) {
+        return min + (max - min) * randomFloat(state);
+    }
+
+    void ParticlePool::Arrays::resize(size_t size) {
+        posX.resize(size);
+        posY.resize(size);
+        posZ.resize(size);
+        velX.resize(size);
+        velY.resize(size);
+        velZ.resize(size);
+        age.resize(size);
+        lifetime.resize(size);
+    }
+
+    ParticlePool::ParticlePool(size_t capacity, size_t parallelThreshold)
+            : parallelThreshold(parallelThreshold) {
+        setCapacity(capacity);
+    }
+
+    size_t ParticlePool::spawn(size_t spawnCount, const Vec3f &origin, const ParticleEmitter &emitter, uint64_t seed) {
+        auto n = std::min(spawnCount, capacity - count);
+        if (n == 0)
+            return 0;
+
+        auto offset = count;
+        parallelFor(n, parallelThreshold, [&](size_t begin, size_t end, size_t chunk) {
+            uint64_t state = seed ^ (0x9e3779b97f4a7c15 * (chunk + 1));
+            for (auto i = offset + begin; i < offset + end; i++) {
+                arrays.posX[i] = origin.x + randomRange(state, -emitter.spawnExtent.x, emitter.spawnExtent.x);
+                arrays.posY[i] = origin.y + randomRange(state, -emitter.spawnExtent.y, emitter.spawnExtent.y);
+                arrays.posZ[i] = origin.z + randomRange(state, -emitter.spawnExtent.z, emitter.spawnExtent.z);
+                arrays.velX[i] = emitter.velocity.x
+                                 + randomRange(state, -emitter.velocityVariance.x, emitter.velocityVariance.x);
+                arrays.velY[i] = emitter.velocity.y
+                                 + randomRange(state, -emitter.velocityVariance.y, emitter.velocityVariance.y);
+                arrays.velZ[i] = emitter.velocity.z
+                                 + randomRange(state, -emitter.velocityVariance.z, emitter.velocityVariance.z);
+                arrays.age[i] = 0;
+                arrays.lifetime[i] = randomRange(state, emitter.lifetimeMin, emitter.lifetimeMax);
+            }
+        });
+
+        count += n;
+        orderValid = false;
+
+        return n;
+    }
+
+    void ParticlePool::integrate(float deltaTime, const ParticleEmitter &emitter) {
+        const auto damping = std::max(0.0f, 1.0f - emitter.drag * deltaTime);
+        const auto dvx = emitter.acceleration.x * deltaTime;
+        const auto dvy = emitter.acceleration.y * deltaTime;
+        const auto dvz = emitter.acceleration.z * deltaTime;
+
+        parallelFor(count, parallelThreshold, [&](size_t begin, size_t end, size_t) {
+            // Separate loops over plain float pointers so that each loop can be vectorized
+            auto *a = arrays.age.data();
+            for (auto i = begin; i < end; i++) {
+                a[i] += deltaTime;
+            }
+
+            auto *px = arrays.posX.data();
+            auto *vx = arrays.velX.data();
+            for (auto i = begin; i < end; i++) {
+                vx[i] = vx[i] * damping + dvx;
+                px[i] += vx[i] * deltaTime;
+            }
+
+            auto *py = arrays.posY.data();
+            auto *vy = arrays.velY.data();
+            for (auto i = begin; i < end; i++) {
+                vy[i] = vy[i] * damping + dvy;
+                py[i] += vy[i] * deltaTime;
+            }
+
+            auto *pz = arrays.posZ.data();
+            auto *vz = arrays.velZ.data();
+            for (auto i = begin; i < end; i++) {
+                vz[i] = vz[i] * damping + dvz;
+                pz[i] += vz[i] * deltaTime;
+            }
+        });
+    }
+
+    void ParticlePool::kill() {
+        if (count == 0)
+            return;
+
+        // Count the surviving particles of each chunk, compute the output offsets and scatter the survivors into the back arrays.
+        auto chunks = getChunkCount(count, parallelThreshold);
+        auto chunkSize = (count + chunks - 1) / chunks;
+
+        std::vector<size_t> alive(chunks, 0);
+        parallelChunks(chunks, [&](size_t chunk) {
+            auto start = std::min(count, chunk * chunkSize);
+            auto stop = std::min(count, start + chunkSize);
+            size_t n = 0;
+            for (auto i = start; i < stop; i++) {
+                n += arrays.age[i] < arrays.lifetime[i];
+            }
+            alive.at(chunk) = n;
+        });
+
+        std::vector<size_t> offsets(chunks, 0);
+        std::exclusive_scan(alive.begin(), alive.end(), offsets.begin(), static_cast<size_t>(0));
+        auto totalAlive = offsets.back() + alive.back();
+
+        if (totalAlive == count)
+            return;
+
+        parallelChunks(chunks, [&](size_t chunk) {
+            auto start = std::min(count, chunk * chunkSize);
+            auto stop = std::min(count, start + chunkSize);
+            auto o = offsets.at(chunk);
+            for (auto i = start; i < stop; i++) {
+                if (arrays.age[i] < arrays.lifetime[i]) {
+                    backArrays.posX[o] = arrays.posX[i];
+                    backArrays.posY[o] = arrays.posY[i];
+                    backArrays.posZ[o] = arrays.posZ[i];
+                    backArrays.velX[o] = arrays.velX[i];
+                    backArrays.velY[o] = arrays.velY[i];
+                    backArrays.velZ[o] = arrays.velZ[i];
+                    backArrays.age[o] = arrays.age[i];
+                    backArrays.lifetime[o] = arrays.lifetime[i];
+                    o++;
+                }
+            }
+        });
+
+        std::swap(arrays, backArrays);
+
+        count = totalAlive;
+        orderValid = false;
+    }
+
+    /**
+     * Sort the values by their upper 32 bits using a least significant digit radix sort with 8 bit digits.
+     * The number of passes is even so the sorted values end up in the values array.
+     */
+    static void radixSort(uint64_t *values, uint64_t *buffer, size_t size) {
+        for (int shift = 32; shift < 64; shift += 8) {
+            size_t offsets[256]{};
+            for (size_t i = 0; i < size; i++) {
+                offsets[(values[i] >> shift) & 0xFF]++;
+            }
+            size_t sum = 0;
+            for (auto &offset: offsets) {
+                auto c = offset;
+                offset = sum;
+                sum += c;
+            }
+            for (size_t i = 0; i < size; i++) {
+                buffer[offsets[(values[i] >> shift) & 0xFF]++] = values[i];
+            }
+            std::swap(values, buffer);
+        }
+    }
+
+    void ParticlePool::sort(const Vec3f &viewPosition) {
+        sortKeys.resize(count);
+        sortBuffer.resize(count);
+        order.resize(count);
+
+        // The bit pattern of a positive float increases monotonically with its value,
+        // inverting the bits of the squared distance yields ascending keys for back to front order.
+        parallelFor(count, parallelThreshold, [&](size_t begin, size_t end, size_t) {
+            for (auto i = begin; i < end; i++) {
+                auto x = arrays.posX[i] - viewPosition.x;
+                auto y = arrays.posY[i] - viewPosition.y;
+                auto z = arrays.posZ[i] - viewPosition.z;
+                float distance = x * x + y * y + z * z;
+                uint32_t bits;
+                std::memcpy(&bits, &distance, sizeof(float));
+                sortKeys[i] = (static_cast<uint64_t>(~bits) << 32) | static_cast<uint64_t>(i);
+            }
+        });
+
+        auto chunks = getChunkCount(count, parallelThreshold);
+        auto chunkSize = (count + chunks - 1) / chunks;
+
+        parallelChunks(chunks, [&](size_t chunk) {
+            auto start = std::min(count, chunk * chunkSize);
+            auto stop = std::min(count, start + chunkSize);
+            radixSort(sortKeys.data() + start, sortBuffer.data() + start, stop - start);
+        });
+
+        // Merge pairs of sorted ranges until a single range remains
+        for (auto width = chunkSize; width < count; width *= 2) {
+            auto merges = (count + 2 * width - 1) / (2 * width);
+            parallelChunks(merges, [&](size_t m) {
+                auto start = m * 2 * width;
+                auto mid = std::min(count, start + width);
+                auto stop = std::min(count, start + 2 * width);
+                std::merge(sortKeys.begin() + static_cast<long>(start),
+                           sortKeys.begin() + static_cast<long>(mid),
+                           sortKeys.begin() + static_cast<long>(mid),
+                           sortKeys.begin() + static_cast<long>(stop),
+                           sortBuffer.begin() + static_cast<long>(start));
+            });
+            std::swap(sortKeys, sortBuffer);
+        }
+
+        parallelFor(count, parallelThreshold, [&](size_t begin, size_t end, size_t) {
+            for (auto i = begin; i < end; i++) {
+                order[i] = static_cast<uint32_t>(sortKeys[i]);
+            }
+        });
+
+        orderValid = true;
+    }
+
+    void ParticlePool::writeInstances(const ParticleEmitter &emitter, std::vector<ParticleInstance> &instances) const {
+        instances.resize(count);
+
+        auto startColor = emitter.startColor.divide();
+        auto endColor = emitter.endColor.divide();
+
+        parallelFor(count, parallelThreshold, [&](size_t begin, size_t end, size_t) {
+            for (auto i = begin; i < end; i++) {
+                auto index = orderValid ? order[i] : i;
+                auto t = arrays.lifetime[index] > 0
+                         ? std::clamp(arrays.age[index] / arrays.lifetime[index], 0.0f, 1.0f)
+                         : 1.0f;
+
+                auto &instance = instances[i];
+                instance.position[0] = arrays.posX[index];
+                instance.position[1] = arrays.posY[index];
+                instance.position[2] = arrays.posZ[index];
+                instance.size = emitter.startSize + (emitter.endSize - emitter.startSize) * t;
+                instance.color[0] = startColor.x + (endColor.x - startColor.x) * t;
+                instance.color[1] = startColor.y + (endColor.y - startColor.y) * t;
+                instance.color[2] = startColor.z + (endColor.z - startColor.z) * t;
+                instance.color[3] = startColor.w + (endColor.w - startColor.w) * t;
+            }
+        });
+    }
+
+    void ParticlePool::update(float deltaTime,
+                              const Vec3f &origin,
+                              const Vec3f &viewPosition,
+                              const ParticleEmitter &emitter,
+                              float &spawnAccumulator,
+                              uint64_t seed) {
+        if (capacity != emitter.maxParticles) {
+            setCapacity(emitter.maxParticles);
+        }
+
+        integrate(deltaTime, emitter);
+        kill();
+
+        spawnAccumulator += emitter.spawnRate * deltaTime;
+        auto spawnCount = static_cast<size_t>(std::max(0.0f, std::floor(spawnAccumulator)));
+        spawnAccumulator -= static_cast<float>(spawnCount);
+        spawn(spawnCount, origin, emitter, seed);
+
+        if (emitter.sortParticles) {
+            sort(viewPosition);
+        } else {
+            orderValid = false;
+        }
+    }
+
+    void ParticlePool::clear() {
+        count = 0;
+        orderValid = false;
+    }
+
+    void ParticlePool::setCapacity(size_t value) {
+        capacity = value;
+        count = std::min(count, capacity);
+        arrays.resize(capacity);
+        backArrays.resize(capacity);
+        orderValid = false;
+    }
+}
@@ -0,0 +1,731 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/render/texture/blockcompressor.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace xng {
+    static const int BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+    /**
+     * Compute the mean and the principal axis of the first n channels of the given points by power iteration.
+     */
+    template<int N>
+    static void getPrincipalAxis(const float (*points)[4], const bool *mask, float *mean, float *axis) {
+        float count = 0;
+        for (int c = 0; c < N; c++) {
+            mean[c] = 0;
+        }
+        for (int i = 0; i < 16; i++) {
+            if (mask[i]) {
+                for (int c = 0; c < N; c++) {
+                    mean[c] += points[i][c];
+                }
+                count++;
+            }
+        }
+        for (int c = 0; c < N; c++) {
+            mean[c] /= count;
+        }
+
+        float covariance[N][N]{};
+        for (int i = 0; i < 16; i++) {
+            if (!mask[i])
+                continue;
+            for (int a = 0; a < N; a++) {
+                for (int b = 0; b < N; b++) {
+                    covariance[a][b] += (points[i][a] - mean[a]) * (points[i][b] - mean[b]);
+                }
+            }
+        }
+
+        // Start with the channel of the largest variance to avoid starting orthogonal to the principal axis.
+        int largest = 0;
+        for (int c = 1; c < N; c++) {
+            if (covariance[c][c] > covariance[largest][largest])
+                largest = c;
+        }
+        for (int c = 0; c < N; c++) {
+            axis[c] = c == largest ? 1.0f : 0.0f;
+        }
+
+        for (int iteration = 0; iteration < 8; iteration++) {
+            float next[N]{};
+            float length = 0;
+            for (int a = 0; a < N; a++) {
+                for (int b = 0; b < N; b++) {
+                    next[a] += covariance[a][b] * axis[b];
+                }
+                length += next[a] * next[a];
+            }
+            if (length <= std::numeric_limits<float>::epsilon())
+                break;
+            length = std::sqrt(length);
+            for (int c = 0; c < N; c++) {
+                axis[c] = next[c] / length;
+            }
+        }
+    }
+
+    /**
+     * Project the points onto the axis and return the extreme points along the axis.
+     */
+    template<int N>
+    static void getAxisExtremes(const float (*points)[4],
+                                const bool *mask,
+                                const float *mean,
+                                const float *axis,
+                                float *min,
+                                float *max) {
+        float minT = std::numeric_limits<float>::max();
+        float maxT = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < 16; i++) {
+            if (!mask[i])
+                continue;
+            float t = 0;
+            for (int c = 0; c < N; c++) {
+                t += (points[i][c] - mean[c]) * axis[c];
+            }
+            minT = std::min(minT, t);
+            maxT = std::max(maxT, t);
+        }
+        for (int c = 0; c < N; c++) {
+            min[c] = std::clamp(mean[c] + axis[c] * minT, 0.0f, 255.0f);
+            max[c] = std::clamp(mean[c] + axis[c] * maxT, 0.0f, 255.0f);
+        }
+    }
+
+    /**
+     * Solve for the two endpoints which minimize the squared error of the points given the interpolation weight of each point.
+     *
+     * @param weights The weight of endpoint a for each point
+     * @return False if the system is singular
+     */
+    template<int N>
+    static bool solveEndpoints(const float (*points)[4], const bool *mask, const float *weights, float *a, float *b) {
+        float aa = 0, ab = 0, bb = 0;
+        float ax[N]{}, bx[N]{};
+        for (int i = 0; i < 16; i++) {
+            if (!mask[i])
+                continue;
+            auto w = weights[i];
+            auto iw = 1.0f - w;
+            aa += w * w;
+            ab += w * iw;
+            bb += iw * iw;
+            for (int c = 0; c < N; c++) {
+                ax[c] += w * points[i][c];
+                bx[c] += iw * points[i][c];
+            }
+        }
+        auto det = aa * bb - ab * ab;
+        if (std::fabs(det) < 1e-6f)
+            return false;
+        for (int c = 0; c < N; c++) {
+            a[c] = std::clamp((ax[c] * bb - bx[c] * ab) / det, 0.0f, 255.0f);
+            b[c] = std::clamp((bx[c] * aa - ax[c] * ab) / det, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    static uint16_t pack565(const float *color) {
+        auto r = static_cast<uint16_t>(std::round(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f));
+        auto g = static_cast<uint16_t>(std::round(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f));
+        auto b = static_cast<uint16_t>(std::round(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f));
+        return static_cast<uint16_t>((r << 11) | (g << 5) | b);
+    }
+
+    static void unpack565(uint16_t value, int *color) {
+        auto r = (value >> 11) & 31;
+        auto g = (value >> 5) & 63;
+        auto b = value & 31;
+        color[0] = (r << 3) | (r >> 2);
+        color[1] = (g << 2) | (g >> 4);
+        color[2] = (b << 3) | (b >> 2);
+    }
+
+    /**
+     * @return The number of opaque palette entries, the palette of the 3 color mode has a transparent fourth entry.
+     */
+    static int getColorPalette(uint16_t c0, uint16_t c1, bool threeColor, int (*palette)[3]) {
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        if (threeColor) {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (palette[0][c] + palette[1][c]) / 2;
+                palette[3][c] = 0;
+            }
+            return 3;
+        } else {
+            for (int c = 0; c < 3; c++) {
+                palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+                palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+            }
+            return 4;
+        }
+    }
+
+    static float getColorIndices(const float (*points)[4],
+                                 const bool *opaque,
+                                 uint16_t c0,
+                                 uint16_t c1,
+                                 bool threeColor,
+                                 int *indices) {
+        int palette[4][3];
+        auto count = getColorPalette(c0, c1, threeColor, palette);
+        float error = 0;
+        for (int i = 0; i < 16; i++) {
+            if (!opaque[i]) {
+                indices[i] = 3;
+                continue;
+            }
+            float best = std::numeric_limits<float>::max();
+            for (int p = 0; p < count; p++) {
+                float d = 0;
+                for (int c = 0; c < 3; c++) {
+                    auto v = points[i][c] - static_cast<float>(palette[p][c]);
+                    d += v * v;
+                }
+                if (d < best) {
+                    best = d;
+                    indices[i] = p;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    static void encodeColorBlock(const ColorRGBA *pixels, uint8_t *output, bool alpha) {
+        float points[16][4];
+        bool opaque[16];
+        bool threeColor = false;
+        bool anyOpaque = false;
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 4; c++) {
+                points[i][c] = pixels[i].data[c];
+            }
+            opaque[i] = !alpha || pixels[i].a() >= 128;
+            threeColor |= !opaque[i];
+            anyOpaque |= opaque[i];
+        }
+
+        if (!anyOpaque) {
+            // Both endpoints zero selects the 3 color mode in which index 3 is transparent black.
+            std::memset(output, 0, 4);
+            std::memset(output + 4, 0xFF, 4);
+            return;
+        }
+
+        float mean[3], axis[3], min[3], max[3];
+        getPrincipalAxis<3>(points, opaque, mean, axis);
+        getAxisExtremes<3>(points, opaque, mean, axis, min, max);
+
+        uint16_t c0 = pack565(max);
+        uint16_t c1 = pack565(min);
+        int indices[16];
+        auto error = getColorIndices(points, opaque, c0, c1, threeColor, indices);
+
+        static const float weights4[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+        static const float weights3[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+        auto *paletteWeights = threeColor ? weights3 : weights4;
+
+        for (int iteration = 0; iteration < 2 && error > 0; iteration++) {
+            float weights[16];
+            for (int i = 0; i < 16; i++) {
+                weights[i] = paletteWeights[indices[i]];
+            }
+            float a[3], b[3];
+            if (!solveEndpoints<3>(points, opaque, weights, a, b))
+                break;
+            auto n0 = pack565(a);
+            auto n1 = pack565(b);
+            int newIndices[16];
+            auto newError = getColorIndices(points, opaque, n0, n1, threeColor, newIndices);
+            if (newError >= error)
+                break;
+            c0 = n0;
+            c1 = n1;
+            error = newError;
+            std::memcpy(indices, newIndices, sizeof(indices));
+        }
+
+        // The decoder selects the mode by the order of the packed endpoints.
+        if (threeColor) {
+            if (c0 > c1) {
+                std::swap(c0, c1);
+                for (auto &index: indices) {
+                    if (index < 2)
+                        index ^= 1;
+                }
+            }
+        } else {
+            if (c0 < c1) {
+                std::swap(c0, c1);
+                for (auto &index: indices) {
+                    index ^= 1;
+                }
+            } else if (c0 == c1) {
+                for (auto &index: indices) {
+                    index = 0;
+                }
+            }
+        }
+
+        uint32_t bits = 0;
+        for (int i = 0; i < 16; i++) {
+            bits |= static_cast<uint32_t>(indices[i]) << (i * 2);
+        }
+        output[0] = static_cast<uint8_t>(c0 & 0xFF);
+        output[1] = static_cast<uint8_t>(c0 >> 8);
+        output[2] = static_cast<uint8_t>(c1 & 0xFF);
+        output[3] = static_cast<uint8_t>(c1 >> 8);
+        for (int i = 0; i < 4; i++) {
+            output[4 + i] = static_cast<uint8_t>((bits >> (i * 8)) & 0xFF);
+        }
+    }
+
+    static void getAlphaPalette(int a0, int a1, int *palette) {
+        palette[0] = a0;
+        palette[1] = a1;
+        if (a0 > a1) {
+            for (int i = 1; i < 7; i++) {
+                palette[i + 1] = ((7 - i) * a0 + i * a1 + 3) / 7;
+            }
+        } else {
+            for (int i = 1; i < 5; i++) {
+                palette[i + 1] = ((5 - i) * a0 + i * a1 + 2) / 5;
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    static int getAlphaIndices(const uint8_t *values, int a0, int a1, int *indices) {
+        int palette[8];
+        getAlphaPalette(a0, a1, palette);
+        int error = 0;
+        for (int i = 0; i < 16; i++) {
+            int best = std::numeric_limits<int>::max();
+            for (int p = 0; p < 8; p++) {
+                auto d = std::abs(static_cast<int>(values[i]) - palette[p]);
+                if (d < best) {
+                    best = d;
+                    indices[i] = p;
+                }
+            }
+            error += best * best;
+        }
+        return error;
+    }
+
+    void BlockCompressor::encodeBC4(const uint8_t *values, uint8_t *output) {
+        int min = 255, max = 0;
+        int innerMin = 255, innerMax = 0;
+        for (int i = 0; i < 16; i++) {
+            min = std::min(min, static_cast<int>(values[i]));
+            max = std::max(max, static_cast<int>(values[i]));
+            if (values[i] != 0 && values[i] != 255) {
+                innerMin = std::min(innerMin, static_cast<int>(values[i]));
+                innerMax = std::max(innerMax, static_cast<int>(values[i]));
+            }
+        }
+
+        int a0, a1;
+        int indices[16];
+        if (min == max) {
+            a0 = a1 = min;
+            std::fill(std::begin(indices), std::end(indices), 0);
+        } else {
+            // 8 value mode spanning the full range
+            a0 = max;
+            a1 = min;
+            auto error = getAlphaIndices(values, a0, a1, indices);
+
+            // 6 value mode with explicit 0 and 255 which fits blocks with a few extreme values better
+            if (innerMin <= innerMax && (min == 0 || max == 255)) {
+                int inner[16];
+                auto innerError = getAlphaIndices(values, innerMin, innerMax, inner);
+                if (innerError < error) {
+                    a0 = innerMin;
+                    a1 = innerMax;
+                    std::memcpy(indices, inner, sizeof(indices));
+                }
+            }
+        }
+
+        uint64_t bits = 0;
+        for (int i = 0; i < 16; i++) {
+            bits |= static_cast<uint64_t>(indices[i]) << (i * 3);
+        }
+        output[0] = static_cast<uint8_t>(a0);
+        output[1] = static_cast<uint8_t>(a1);
+        for (int i = 0; i < 6; i++) {
+            output[2 + i] = static_cast<uint8_t>((bits >> (i * 8)) & 0xFF);
+        }
+    }
+
+    void BlockCompressor::encodeBC1(const ColorRGBA *pixels, uint8_t *output, bool alpha) {
+        encodeColorBlock(pixels, output, alpha);
+    }
+
+    void BlockCompressor::encodeBC3(const ColorRGBA *pixels, uint8_t *output) {
+        uint8_t alpha[16];
+        for (int i = 0; i < 16; i++) {
+            alpha[i] = pixels[i].a();
+        }
+        encodeBC4(alpha, output);
+        encodeColorBlock(pixels, output + 8, false);
+    }
+
+    void BlockCompressor::encodeBC5(const ColorRGBA *pixels, uint8_t *output) {
+        uint8_t red[16], green[16];
+        for (int i = 0; i < 16; i++) {
+            red[i] = pixels[i].r();
+            green[i] = pixels[i].g();
+        }
+        encodeBC4(red, output);
+        encodeBC4(green, output + 8);
+    }
+
+    static float getBC7Indices(const float (*points)[4], const int *e0, const int *e1, int *indices) {
+        int palette[16][4];
+        for (int p = 0; p < 16; p++) {
+            for (int c = 0; c < 4; c++) {
+                palette[p][c] = ((64 - BC7_WEIGHTS_4[p]) * e0[c] + BC7_WEIGHTS_4[p] * e1[c] + 32) >> 6;
+            }
+        }
+        float error = 0;
+        for (int i = 0; i < 16; i++) {
+            float best = std::numeric_limits<float>::max();
+            for (int p = 0; p < 16; p++) {
+                float d = 0;
+                for (int c = 0; c < 4; c++) {
+                    auto v = points[i][c] - static_cast<float>(palette[p][c]);
+                    d += v * v;
+                }
+                if (d < best) {
+                    best = d;
+                    indices[i] = p;
+                }
+            }
+            error += best;
+        }
+        return error;
+    }
+
+    /**
+     * Quantize the endpoints to 7 bits per channel with the shared p bit of each endpoint selected by the lowest error.
+     */
+    static float quantizeBC7Endpoints(const float (*points)[4],
+                                      const float *a,
+                                      const float *b,
+                                      int *e0,
+                                      int *e1,
+                                      int *p0,
+                                      int *p1,
+                                      int *indices) {
+        float best = std::numeric_limits<float>::max();
+        for (int pa = 0; pa < 2; pa++) {
+            for (int pb = 0; pb < 2; pb++) {
+                int qa[4], qb[4];
+                for (int c = 0; c < 4; c++) {
+                    auto va = std::clamp(static_cast<int>(std::round((a[c] - pa) / 2.0f)), 0, 127);
+                    auto vb = std::clamp(static_cast<int>(std::round((b[c] - pb) / 2.0f)), 0, 127);
+                    qa[c] = (va << 1) | pa;
+                    qb[c] = (vb << 1) | pb;
+                }
+                int candidate[16];
+                auto error = getBC7Indices(points, qa, qb, candidate);
+                if (error < best) {
+                    best = error;
+                    std::memcpy(e0, qa, sizeof(qa));
+                    std::memcpy(e1, qb, sizeof(qb));
+                    *p0 = pa;
+                    *p1 = pb;
+                    std::memcpy(indices, candidate, sizeof(candidate));
+                }
+            }
+        }
+        return best;
+    }
+
+    namespace {
+        class BitWriter {
+        public:
+            explicit BitWriter(uint8_t *output) : output(output) {
+                std::memset(output, 0, 16);
+            }
+
+            void write(uint32_t value, int count) {
+                for (int i = 0; i < count; i++, position++) {
+                    if ((value >> i) & 1) {
+                        output[position / 8] |= static_cast<uint8_t>(1 << (position % 8));
+                    }
+                }
+            }
+
+        private:
+            uint8_t *output;
+            int position = 0;
+        };
+
+        class BitReader {
+        public:
+            explicit BitReader(const uint8_t *input) : input(input) {}
+
+            uint32_t read(int count) {
+                uint32_t ret = 0;
+                for (int i = 0; i < count; i++, position++) {
+                    ret |= static_cast<uint32_t>((input[position / 8] >> (position % 8)) & 1) << i;
+                }
+                return ret;
+            }
+
+        private:
+            const uint8_t *input;
+            int position = 0;
+        };
+    }
+
+    void BlockCompressor::encodeBC7(const ColorRGBA *pixels, uint8_t *output) {
+        float points[16][4];
+        bool mask[16];
+        for (int i = 0; i < 16; i++) {
+            for (int c = 0; c < 4; c++) {
+                points[i][c] = pixels[i].data[c];
+            }
+            mask[i] = true;
+        }
+
+        float mean[4], axis[4], a[4], b[4];
+        getPrincipalAxis<4>(points, mask, mean, axis);
+        getAxisExtremes<4>(points, mask, mean, axis, a, b);
+
+        int e0[4], e1[4], p0, p1, indices[16];
+        auto error = quantizeBC7Endpoints(points, a, b, e0, e1, &p0, &p1, indices);
+
+        for (int iteration = 0; iteration < 2 && error > 0; iteration++) {
+            float weights[16];
+            for (int i = 0; i < 16; i++) {
+                weights[i] = 1.0f - static_cast<float>(BC7_WEIGHTS_4[indices[i]]) / 64.0f;
+            }
+            if (!solveEndpoints<4>(points, mask, weights, a, b))
+                break;
+            int n0[4], n1[4], np0, np1, newIndices[16];
+            auto newError = quantizeBC7Endpoints(points, a, b, n0, n1, &np0, &np1, newIndices);
+            if (newError >= error)
+                break;
+            error = newError;
+            std::memcpy(e0, n0, sizeof(n0));
+            std::memcpy(e1, n1, sizeof(n1));
+            p0 = np0;
+            p1 = np1;
+            std::memcpy(indices, newIndices, sizeof(newIndices));
+        }
+
+        // The most significant bit of the anchor index is implicitly zero.
+        if (indices[0] & 8) {
+            std::swap(e0, e1);
+            std::swap(p0, p1);
+            for (auto &index: indices) {
+                index = 15 - index;
+            }
+        }
+
+        BitWriter writer(output);
+        writer.write(1 << 6, 7);
+        for (int c = 0; c < 4; c++) {
+            writer.write(static_cast<uint32_t>(e0[c] >> 1), 7);
+            writer.write(static_cast<uint32_t>(e1[c] >> 1), 7);
+        }
+        writer.write(static_cast<uint32_t>(p0), 1);
+        writer.write(static_cast<uint32_t>(p1), 1);
+        writer.write(static_cast<uint32_t>(indices[0]), 3);
+        for (int i = 1; i < 16; i++) {
+            writer.write(static_cast<uint32_t>(indices[i]), 4);
+        }
+    }
+
+    void BlockCompressor::decodeBC1(const uint8_t *block, ColorRGBA *pixels) {
+        auto c0 = static_cast<uint16_t>(block[0] | (block[1] << 8));
+        auto c1 = static_cast<uint16_t>(block[2] | (block[3] << 8));
+        int palette[4][3];
+        auto threeColor = c0 <= c1;
+        getColorPalette(c0, c1, threeColor, palette);
+        uint32_t bits = block[4] | (block[5] << 8) | (block[6] << 16) | (static_cast<uint32_t>(block[7]) << 24);
+        for (int i = 0; i < 16; i++) {
+            auto index = (bits >> (i * 2)) & 3;
+            pixels[i] = ColorRGBA(static_cast<uint8_t>(palette[index][0]),
+                                  static_cast<uint8_t>(palette[index][1]),
+                                  static_cast<uint8_t>(palette[index][2]),
+                                  threeColor && index == 3 ? 0 : 255);
+        }
+    }
+
+    void BlockCompressor::decodeBC4(const uint8_t *block, uint8_t *values) {
+        int palette[8];
+        getAlphaPalette(block[0], block[1], palette);
+        uint64_t bits = 0;
+        for (int i = 0; i < 6; i++) {
+            bits |= static_cast<uint64_t>(block[2 + i]) << (i * 8);
+        }
+        for (int i = 0; i < 16; i++) {
+            values[i] = static_cast<uint8_t>(palette[(bits >> (i * 3)) & 7]);
+        }
+    }
+
+    void BlockCompressor::decodeBC3(const uint8_t *block, ColorRGBA *pixels) {
+        uint8_t alpha[16];
+        decodeBC4(block, alpha);
+        auto *color = block + 8;
+        auto c0 = static_cast<uint16_t>(color[0] | (color[1] << 8));
+        auto c1 = static_cast<uint16_t>(color[2] | (color[3] << 8));
+        int palette[4][3];
+        getColorPalette(c0, c1, false, palette);
+        uint32_t bits = color[4] | (color[5] << 8) | (color[6] << 16) | (static_cast<uint32_t>(color[7]) << 24);
+        for (int i = 0; i < 16; i++) {
+            auto index = (bits >> (i * 2)) & 3;
+            pixels[i] = ColorRGBA(static_cast<uint8_t>(palette[index][0]),
+                                  static_cast<uint8_t>(palette[index][1]),
+                                  static_cast<uint8_t>(palette[index][2]),
+                                  alpha[i]);
+        }
+    }
+
+    void BlockCompressor::decodeBC5(const uint8_t *block, ColorRGBA *pixels) {
+        uint8_t red[16], green[16];
+        decodeBC4(block, red);
+        decodeBC4(block + 8, green);
+        for (int i = 0; i < 16; i++) {
+            pixels[i] = ColorRGBA(red[i], green[i], 0, 255);
+        }
+    }
+
+    void BlockCompressor::decodeBC7(const uint8_t *block, ColorRGBA *pixels) {
+        if ((block[0] & 0x7F) != 0x40) {
+            throw std::runtime_error("Unsupported BC7 block mode");
+        }
+        BitReader reader(block);
+        reader.read(7);
+        int e0[4], e1[4];
+        for (int c = 0; c < 4; c++) {
+            e0[c] = static_cast<int>(reader.read(7)) << 1;
+            e1[c] = static_cast<int>(reader.read(7)) << 1;
+        }
+        auto p0 = static_cast<int>(reader.read(1));
+        auto p1 = static_cast<int>(reader.read(1));
+        for (int c = 0; c < 4; c++) {
+            e0[c] |= p0;
+            e1[c] |= p1;
+        }
+        for (int i = 0; i < 16; i++) {
+            auto weight = BC7_WEIGHTS_4[reader.read(i == 0 ? 3 : 4)];
+            for (int c = 0; c < 4; c++) {
+                pixels[i].data[c] = static_cast<uint8_t>(((64 - weight) * e0[c] + weight * e1[c] + 32) >> 6);
+            }
+        }
+    }
+
+    std::vector<uint8_t> BlockCompressor::compress(const ImageRGBA &image, ColorFormat format) {
+        auto blockSize = getBlockCompressedBlockSize(format);
+        auto blocksX = (image.getWidth() + 3) / 4;
+        auto blocksY = (image.getHeight() + 3) / 4;
+        std::vector<uint8_t> ret(getBlockCompressedSize(format, image.getWidth(), image.getHeight()));
+        if (image.empty()) {
+            return ret;
+        }
+
+        ColorRGBA pixels[16];
+        for (auto by = 0; by < blocksY; by++) {
+            for (auto bx = 0; bx < blocksX; bx++) {
+                for (int y = 0; y < 4; y++) {
+                    for (int x = 0; x < 4; x++) {
+                        pixels[y * 4 + x] = image.getPixel(std::min(bx * 4 + x, image.getWidth() - 1),
+                                                           std::min(by * 4 + y, image.getHeight() - 1));
+                    }
+                }
+                auto *output = ret.data() + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+                switch (format) {
+                    case BC1_RGBA:
+                        encodeBC1(pixels, output, true);
+                        break;
+                    case BC3_RGBA:
+                        encodeBC3(pixels, output);
+                        break;
+                    case BC5_RG:
+                        encodeBC5(pixels, output);
+                        break;
+                    case BC7_RGBA:
+                        encodeBC7(pixels, output);
+                        break;
+                    default:
+                        throw std::runtime_error("Color format is not block compressed");
+                }
+            }
+        }
+        return ret;
+    }
+
+    ImageRGBA BlockCompressor::decompress(const uint8_t *data,
+                                          size_t size,
+                                          const Vec2i &resolution,
+                                          ColorFormat format) {
+        if (size < getBlockCompressedSize(format, resolution.x, resolution.y)) {
+            throw std::runtime_error("Block compressed buffer is too small for the resolution");
+        }
+        auto blockSize = getBlockCompressedBlockSize(format);
+        auto blocksX = (resolution.x + 3) / 4;
+        auto blocksY = (resolution.y + 3) / 4;
+        ImageRGBA ret(resolution);
+
+        ColorRGBA pixels[16];
+        for (auto by = 0; by < blocksY; by++) {
+            for (auto bx = 0; bx < blocksX; bx++) {
+                auto *block = data + (static_cast<size_t>(by) * blocksX + bx) * blockSize;
+                switch (format) {
+                    case BC1_RGBA:
+                        decodeBC1(block, pixels);
+                        break;
+                    case BC3_RGBA:
+                        decodeBC3(block, pixels);
+                        break;
+                    case BC5_RG:
+                        decodeBC5(block, pixels);
+                        break;
+                    case BC7_RGBA:
+                        decodeBC7(block, pixels);
+                        break;
+                    default:
+                        throw std::runtime_error("Color format is not block compressed");
+                }
+                for (int y = 0; y < 4 && by * 4 + y < resolution.y; y++) {
+                    for (int x = 0; x < 4 && bx * 4 + x < resolution.x; x++) {
+                        ret.setPixel(bx * 4 + x, by * 4 + y, pixels[y * 4 + x]);
+                    }
+                }
+            }
+        }
+        return ret;
+    }
+}
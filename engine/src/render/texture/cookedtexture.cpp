@@ -0,0 +1,107 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/render/texture/cookedtexture.hpp"
+
+namespace xng {
+    void CookedTexture::upload(TextureBuffer &buffer) const {
+        for (auto i = 0; i < static_cast<int>(mipMapLevels.size()); i++) {
+            auto &level = mipMapLevels.at(i);
+            buffer.upload(description.format, level.data(), level.size(), i);
+        }
+    }
+
+    void CookedTexture::upload(FrameGraphBuilder &builder, FrameGraphResource buffer) const {
+        for (auto i = 0; i < static_cast<int>(mipMapLevels.size()); i++) {
+            auto level = mipMapLevels.at(i);
+            builder.upload(buffer,
+                           0,
+                           0,
+                           description.format,
+                           {},
+                           [level]() {
+                               return FrameGraphUploadBuffer(level.size(), level.data());
+                           },
+                           i);
+        }
+    }
+
+    void CookedTexture::serialize(BinaryWriter &writer) const {
+        writer.write(COOKED_TEXTURE_MAGIC.data(), COOKED_TEXTURE_MAGIC.size());
+        writer.writeInt(description.size.x);
+        writer.writeInt(description.size.y);
+        writer.writeInt(description.format);
+        writer.writeInt(description.wrapping);
+        writer.writeInt(description.filterMin);
+        writer.writeInt(description.filterMag);
+        writer.writeInt(description.mipMapFilter);
+        writer.writeUInt(mipMapLevels.size());
+        for (auto &level: mipMapLevels) {
+            writer.writeUInt(level.size());
+            writer.write(level.data(), level.size());
+        }
+    }
+
+    void CookedTexture::deserialize(const ReadBuffer &buffer) {
+        if (buffer.size() < COOKED_TEXTURE_MAGIC.size()
+            || !std::equal(COOKED_TEXTURE_MAGIC.begin(), COOKED_TEXTURE_MAGIC.end(), buffer.chars())) {
+            throw std::runtime_error("Invalid cooked texture magic");
+        }
+
+        BinaryReader reader(buffer.chars(), buffer.size());
+        reader.skip(COOKED_TEXTURE_MAGIC.size());
+
+        description = {};
+        description.size.x = static_cast<int>(reader.readInt());
+        description.size.y = static_cast<int>(reader.readInt());
+        description.format = static_cast<ColorFormat>(reader.readInt());
+        description.wrapping = static_cast<TextureWrapping>(reader.readInt());
+        description.filterMin = static_cast<TextureFiltering>(reader.readInt());
+        description.filterMag = static_cast<TextureFiltering>(reader.readInt());
+        description.mipMapFilter = static_cast<MipMapFiltering>(reader.readInt());
+
+        auto levelCount = reader.readUInt();
+        if (!isBlockCompressed(description.format) && description.format != RGBA) {
+            throw std::runtime_error("Unsupported cooked texture format");
+        }
+        if (description.size.x < 1
+            || description.size.y < 1
+            || levelCount < 1
+            || levelCount > static_cast<size_t>(TextureBufferDesc::getMipMapLevelCount(description.size))) {
+            throw std::runtime_error("Invalid cooked texture header");
+        }
+        description.mipMapLevels = static_cast<int>(levelCount);
+
+        mipMapLevels.clear();
+        for (size_t i = 0; i < levelCount; i++) {
+            auto size = reader.readUInt();
+            auto res = getMipMapResolution(static_cast<int>(i));
+            auto expectedSize = isBlockCompressed(description.format)
+                                ? getBlockCompressedSize(description.format, res.x, res.y)
+                                : static_cast<size_t>(res.x) * static_cast<size_t>(res.y) * 4;
+            if (size != expectedSize) {
+                throw std::runtime_error("Invalid cooked texture mip map level size");
+            }
+            auto offset = buffer.size() - reader.remaining();
+            reader.skip(size);
+            mipMapLevels.emplace_back(buffer.slice(offset, size));
+        }
+    }
+}
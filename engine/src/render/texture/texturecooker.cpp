@@ -0,0 +1,305 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/render/texture/texturecooker.hpp"
+#include "xng/render/texture/blockcompressor.hpp"
+
+#include <cmath>
+
+namespace xng {
+    namespace {
+        const float KAISER_RADIUS = 3.0f;
+        const float KAISER_ALPHA = 4.0f;
+
+        struct Tap {
+            int index;
+            float weight;
+        };
+
+        /**
+         * A float rgba image, the color channels are linear and premultiplied if the source contains translucent pixels.
+         */
+        struct FloatImage {
+            int width = 0;
+            int height = 0;
+            std::vector<float> pixels;
+
+            FloatImage(int width, int height)
+                    : width(width), height(height), pixels(static_cast<size_t>(width) * height * 4) {}
+
+            float *get(int x, int y) {
+                return pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+            }
+
+            const float *get(int x, int y) const {
+                return pixels.data() + (static_cast<size_t>(y) * width + x) * 4;
+            }
+        };
+
+        float besselI0(float x) {
+            float sum = 1.0f;
+            float term = 1.0f;
+            auto halfX = x / 2.0f;
+            for (int k = 1; k < 32 && term > sum * 1e-8f; k++) {
+                auto t = halfX / static_cast<float>(k);
+                term *= t * t;
+                sum += term;
+            }
+            return sum;
+        }
+
+        float sinc(float x) {
+            if (std::fabs(x) < 1e-6f)
+                return 1.0f;
+            auto px = static_cast<float>(M_PI) * x;
+            return std::sin(px) / px;
+        }
+
+        float kaiser(float t) {
+            if (std::fabs(t) >= KAISER_RADIUS)
+                return 0;
+            auto r = t / KAISER_RADIUS;
+            return sinc(t) * besselI0(KAISER_ALPHA * std::sqrt(1.0f - r * r)) / besselI0(KAISER_ALPHA);
+        }
+
+        int wrapIndex(int index, int length, TextureWrapping wrapping) {
+            switch (wrapping) {
+                case REPEAT:
+                    return ((index % length) + length) % length;
+                case MIRRORED_REPEAT: {
+                    auto period = length * 2;
+                    auto i = ((index % period) + period) % period;
+                    return i < length ? i : period - 1 - i;
+                }
+                default:
+                    return std::clamp(index, 0, length - 1);
+            }
+        }
+
+        /**
+         * @return The normalized filter taps in the source for each destination pixel
+         */
+        std::vector<std::vector<Tap>> getTaps(int sourceLength,
+                                              int destinationLength,
+                                              TextureCooker::MipMapFilter filter,
+                                              TextureWrapping wrapping) {
+            std::vector<std::vector<Tap>> ret(destinationLength);
+            auto scale = static_cast<float>(sourceLength) / static_cast<float>(destinationLength);
+            for (int x = 0; x < destinationLength; x++) {
+                auto &taps = ret.at(x);
+                if (filter == TextureCooker::FILTER_BOX) {
+                    auto begin = static_cast<float>(x) * scale;
+                    auto end = static_cast<float>(x + 1) * scale;
+                    for (auto i = static_cast<int>(std::floor(begin)); i < static_cast<int>(std::ceil(end)); i++) {
+                        auto weight = std::min(end, static_cast<float>(i + 1)) - std::max(begin, static_cast<float>(i));
+                        if (weight > 0)
+                            taps.emplace_back(Tap{wrapIndex(i, sourceLength, wrapping), weight});
+                    }
+                } else {
+                    auto center = (static_cast<float>(x) + 0.5f) * scale;
+                    auto radius = KAISER_RADIUS * scale;
+                    for (auto i = static_cast<int>(std::floor(center - radius));
+                         i <= static_cast<int>(std::ceil(center + radius));
+                         i++) {
+                        auto weight = kaiser((static_cast<float>(i) + 0.5f - center) / scale);
+                        if (weight != 0)
+                            taps.emplace_back(Tap{wrapIndex(i, sourceLength, wrapping), weight});
+                    }
+                }
+
+                float sum = 0;
+                for (auto &tap: taps) {
+                    sum += tap.weight;
+                }
+                for (auto &tap: taps) {
+                    tap.weight /= sum;
+                }
+            }
+            return ret;
+        }
+
+        float srgbToLinear(float value) {
+            return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        float linearToSrgb(float value) {
+            return value <= 0.0031308f ? value * 12.92f : 1.055f * std::pow(value, 1.0f / 2.4f) - 0.055f;
+        }
+
+        uint8_t toByte(float value) {
+            return static_cast<uint8_t>(std::round(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+        }
+
+        FloatImage toFloatImage(const ImageRGBA &image, const TextureCooker::Settings &settings, bool premultiply) {
+            float srgbTable[256];
+            for (int i = 0; i < 256; i++) {
+                srgbTable[i] = settings.sRGB ? srgbToLinear(static_cast<float>(i) / 255.0f) : static_cast<float>(i) / 255.0f;
+            }
+
+            FloatImage ret(image.getWidth(), image.getHeight());
+            for (int y = 0; y < image.getHeight(); y++) {
+                for (int x = 0; x < image.getWidth(); x++) {
+                    auto &pixel = image.getPixel(x, y);
+                    auto *out = ret.get(x, y);
+                    out[3] = static_cast<float>(pixel.a()) / 255.0f;
+                    for (int c = 0; c < 3; c++) {
+                        if (settings.normalMap) {
+                            out[c] = static_cast<float>(pixel.data[c]) / 255.0f * 2.0f - 1.0f;
+                        } else {
+                            out[c] = srgbTable[pixel.data[c]];
+                            if (premultiply)
+                                out[c] *= out[3];
+                        }
+                    }
+                }
+            }
+            return ret;
+        }
+
+        ImageRGBA toImage(const FloatImage &image, const TextureCooker::Settings &settings, bool premultiplied) {
+            ImageRGBA ret(image.width, image.height);
+            for (int y = 0; y < image.height; y++) {
+                for (int x = 0; x < image.width; x++) {
+                    auto *in = image.get(x, y);
+                    auto alpha = std::clamp(in[3], 0.0f, 1.0f);
+                    ColorRGBA pixel;
+                    pixel.a() = toByte(alpha);
+                    for (int c = 0; c < 3; c++) {
+                        auto value = in[c];
+                        if (settings.normalMap) {
+                            value = value * 0.5f + 0.5f;
+                        } else {
+                            if (premultiplied)
+                                value = alpha > 0 ? value / alpha : 0;
+                            value = std::clamp(value, 0.0f, 1.0f);
+                            if (settings.sRGB)
+                                value = linearToSrgb(value);
+                        }
+                        pixel.data[c] = toByte(value);
+                    }
+                    ret.setPixel(x, y, pixel);
+                }
+            }
+            return ret;
+        }
+
+        FloatImage downsample(const FloatImage &source, const TextureCooker::Settings &settings) {
+            auto width = std::max(1, source.width / 2);
+            auto height = std::max(1, source.height / 2);
+
+            auto horizontalTaps = getTaps(source.width, width, settings.filter, settings.wrapping);
+            auto verticalTaps = getTaps(source.height, height, settings.filter, settings.wrapping);
+
+            FloatImage horizontal(width, source.height);
+            for (int y = 0; y < source.height; y++) {
+                for (int x = 0; x < width; x++) {
+                    auto *out = horizontal.get(x, y);
+                    for (auto &tap: horizontalTaps.at(x)) {
+                        auto *in = source.get(tap.index, y);
+                        for (int c = 0; c < 4; c++) {
+                            out[c] += in[c] * tap.weight;
+                        }
+                    }
+                }
+            }
+
+            FloatImage ret(width, height);
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    auto *out = ret.get(x, y);
+                    for (auto &tap: verticalTaps.at(y)) {
+                        auto *in = horizontal.get(x, tap.index);
+                        for (int c = 0; c < 4; c++) {
+                            out[c] += in[c] * tap.weight;
+                        }
+                    }
+                    if (settings.normalMap) {
+                        auto length = std::sqrt(out[0] * out[0] + out[1] * out[1] + out[2] * out[2]);
+                        if (length > 0) {
+                            for (int c = 0; c < 3; c++) {
+                                out[c] /= length;
+                            }
+                        }
+                    }
+                }
+            }
+            return ret;
+        }
+    }
+
+    std::vector<ImageRGBA> TextureCooker::generateMipChain(const ImageRGBA &image, const Settings &settings) {
+        if (image.empty()) {
+            throw std::runtime_error("Cannot generate the mip chain of an empty image");
+        }
+
+        bool premultiply = false;
+        if (!settings.normalMap) {
+            for (auto &pixel: image.getBuffer()) {
+                if (pixel.a() != 255) {
+                    premultiply = true;
+                    break;
+                }
+            }
+        }
+
+        std::vector<ImageRGBA> ret;
+        ret.emplace_back(image);
+
+        auto level = toFloatImage(image, settings, premultiply);
+        while (level.width > 1 || level.height > 1) {
+            level = downsample(level, settings);
+            ret.emplace_back(toImage(level, settings, premultiply));
+        }
+        return ret;
+    }
+
+    CookedTexture TextureCooker::cook(const ImageRGBA &image, const Settings &settings) {
+        if (settings.format != RGBA && !isBlockCompressed(settings.format)) {
+            throw std::runtime_error("Unsupported cooked texture format");
+        }
+
+        std::vector<ImageRGBA> levels;
+        if (settings.generateMipMaps) {
+            levels = generateMipChain(image, settings);
+        } else {
+            levels.emplace_back(image);
+        }
+
+        CookedTexture ret;
+        ret.description.size = image.getResolution();
+        ret.description.format = settings.format;
+        ret.description.wrapping = settings.wrapping;
+        ret.description.filterMin = settings.filterMin;
+        ret.description.filterMag = settings.filterMag;
+        ret.description.mipMapFilter = settings.mipMapFilter;
+        ret.description.mipMapLevels = static_cast<int>(levels.size());
+
+        for (auto &level: levels) {
+            if (settings.format == RGBA) {
+                auto *begin = reinterpret_cast<const uint8_t *>(level.getBuffer().data());
+                ret.mipMapLevels.emplace_back(std::vector<uint8_t>(begin,
+                                                                   begin + level.getBuffer().size() * sizeof(ColorRGBA)));
+            } else {
+                ret.mipMapLevels.emplace_back(BlockCompressor::compress(level, settings.format));
+            }
+        }
+        return ret;
+    }
+}
@@ -0,0 +1,321 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/geometry/vertexquantizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#include "xng/render/scene/skinnedmesh.hpp"
+#include "xng/render/geometry/vertexbuilder.hpp"
+
+namespace xng {
+    namespace {
+        // The byte offsets of the attributes of the default layouts
+        const size_t DEFAULT_POSITION = 0;
+        const size_t DEFAULT_NORMAL = 12;
+        const size_t DEFAULT_UV = 24;
+        const size_t DEFAULT_TANGENT = 32;
+        const size_t DEFAULT_BITANGENT = 44;
+        const size_t DEFAULT_BONE_IDS = 56;
+        const size_t DEFAULT_BONE_WEIGHTS = 72;
+
+        // The byte offsets of the attributes of the compact layouts
+        const size_t COMPACT_POSITION = 0;
+        const size_t COMPACT_NORMAL_TANGENT = 8;
+        const size_t COMPACT_UV = 16;
+        const size_t COMPACT_BONE_IDS = 20;
+        const size_t COMPACT_BONE_WEIGHTS = 28;
+
+        template<typename T>
+        T read(const Vertex &vertex, size_t offset) {
+            T ret;
+            std::memcpy(&ret, vertex.buffer.data() + offset, sizeof(T));
+            return ret;
+        }
+
+        Vec3f readVec3(const Vertex &vertex, size_t offset) {
+            return {read<float>(vertex, offset),
+                    read<float>(vertex, offset + 4),
+                    read<float>(vertex, offset + 8)};
+        }
+
+        float dot(const Vec3f &a, const Vec3f &b) {
+            return a.x * b.x + a.y * b.y + a.z * b.z;
+        }
+
+        Vec3f cross(const Vec3f &a, const Vec3f &b) {
+            return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+        }
+
+        Vec3f normalize(const Vec3f &v) {
+            auto length = v.magnitude();
+            return length > 0 ? v / length : v;
+        }
+
+        bool isSkinned(const VertexLayout &layout) {
+            return layout == SkinnedMesh::getDefaultVertexLayout() || layout == SkinnedMesh::getCompactVertexLayout();
+        }
+
+        void checkLayout(const Mesh &mesh) {
+            if (mesh.vertexLayout != Mesh::getDefaultVertexLayout()
+                && mesh.vertexLayout != SkinnedMesh::getDefaultVertexLayout()
+                && !VertexQuantizer::isCompact(mesh)) {
+                throw std::runtime_error("Unsupported mesh vertex layout");
+            }
+        }
+    }
+
+    void VertexQuantizer::quantize(Mesh &mesh) {
+        checkLayout(mesh);
+
+        if (!isCompact(mesh)) {
+            auto skinned = isSkinned(mesh.vertexLayout);
+
+            Vec3f min(std::numeric_limits<float>::max());
+            Vec3f max(std::numeric_limits<float>::lowest());
+            for (auto &vertex: mesh.vertices) {
+                auto p = readVec3(vertex, DEFAULT_POSITION);
+                min = Vec3f(std::min(min.x, p.x), std::min(min.y, p.y), std::min(min.z, p.z));
+                max = Vec3f(std::max(max.x, p.x), std::max(max.y, p.y), std::max(max.z, p.z));
+            }
+
+            Vec3f offset;
+            Vec3f scale(1);
+            if (!mesh.vertices.empty()) {
+                offset = (min + max) / 2.0f;
+                auto extent = (max - min) / 2.0f;
+                // Flat axes keep a scale of 1, all positions quantize to 0 on those axes
+                scale = Vec3f(extent.x > 0 ? extent.x : 1,
+                              extent.y > 0 ? extent.y : 1,
+                              extent.z > 0 ? extent.z : 1);
+            }
+
+            std::vector<Vertex> vertices;
+            vertices.reserve(mesh.vertices.size());
+            for (auto &vertex: mesh.vertices) {
+                auto position = (readVec3(vertex, DEFAULT_POSITION) - offset) / scale;
+                auto normal = normalize(readVec3(vertex, DEFAULT_NORMAL));
+                auto tangent = normalize(readVec3(vertex, DEFAULT_TANGENT));
+                auto bitangent = readVec3(vertex, DEFAULT_BITANGENT);
+
+                auto bitangentSign = dot(cross(normal, tangent), bitangent) < 0 ? -1.0f : 1.0f;
+
+                auto octNormal = encodeOctahedral(normal);
+                auto octTangent = encodeOctahedral(tangent);
+
+                VertexBuilder builder;
+                builder.addValue(encodeSnorm16(position.x))
+                        .addValue(encodeSnorm16(position.y))
+                        .addValue(encodeSnorm16(position.z))
+                        .addValue(encodeSnorm16(bitangentSign))
+                        .addValue(encodeSnorm16(octNormal.x))
+                        .addValue(encodeSnorm16(octNormal.y))
+                        .addValue(encodeSnorm16(octTangent.x))
+                        .addValue(encodeSnorm16(octTangent.y))
+                        .addValue(encodeHalf(read<float>(vertex, DEFAULT_UV)))
+                        .addValue(encodeHalf(read<float>(vertex, DEFAULT_UV + 4)));
+
+                if (skinned) {
+                    for (auto i = 0; i < 4; i++) {
+                        auto id = read<int32_t>(vertex, DEFAULT_BONE_IDS + i * 4);
+                        if (id < std::numeric_limits<int16_t>::min() || id > std::numeric_limits<int16_t>::max()) {
+                            throw std::runtime_error("Bone id out of range of the compact vertex layout");
+                        }
+                        builder.addValue(static_cast<int16_t>(id));
+                    }
+                    for (auto i = 0; i < 4; i++) {
+                        auto weight = std::clamp(read<float>(vertex, DEFAULT_BONE_WEIGHTS + i * 4), 0.0f, 1.0f);
+                        builder.addValue(static_cast<uint8_t>(std::lround(weight * 255.0f)));
+                    }
+                }
+
+                vertices.emplace_back(builder.build());
+            }
+
+            mesh.vertices = std::move(vertices);
+            mesh.vertexLayout = skinned ? SkinnedMesh::getCompactVertexLayout() : Mesh::getCompactVertexLayout();
+            mesh.positionOffset = offset;
+            mesh.positionScale = scale;
+        }
+
+        for (auto &subMesh: mesh.subMeshes) {
+            quantize(subMesh);
+        }
+    }
+
+    void VertexQuantizer::dequantize(Mesh &mesh) {
+        checkLayout(mesh);
+
+        if (isCompact(mesh)) {
+            auto skinned = isSkinned(mesh.vertexLayout);
+
+            std::vector<Vertex> vertices;
+            vertices.reserve(mesh.vertices.size());
+            for (auto &vertex: mesh.vertices) {
+                auto normal = decodeOctahedral(Vec2f(decodeSnorm16(read<int16_t>(vertex, COMPACT_NORMAL_TANGENT)),
+                                                     decodeSnorm16(read<int16_t>(vertex, COMPACT_NORMAL_TANGENT + 2))));
+                auto tangent = decodeOctahedral(Vec2f(decodeSnorm16(read<int16_t>(vertex, COMPACT_NORMAL_TANGENT + 4)),
+                                                      decodeSnorm16(read<int16_t>(vertex, COMPACT_NORMAL_TANGENT + 6))));
+                auto bitangentSign = decodeSnorm16(read<int16_t>(vertex, COMPACT_POSITION + 6)) < 0 ? -1.0f : 1.0f;
+                auto uv = Vec2f(decodeHalf(read<uint16_t>(vertex, COMPACT_UV)),
+                                decodeHalf(read<uint16_t>(vertex, COMPACT_UV + 2)));
+
+                VertexBuilder builder;
+                builder.addVec3(getPosition(mesh, vertex))
+                        .addVec3(normal)
+                        .addVec2(uv)
+                        .addVec3(tangent)
+                        .addVec3(cross(normal, tangent) * bitangentSign);
+
+                if (skinned) {
+                    for (auto i = 0; i < 4; i++) {
+                        builder.addValue(static_cast<int32_t>(read<int16_t>(vertex, COMPACT_BONE_IDS + i * 2)));
+                    }
+                    for (auto i = 0; i < 4; i++) {
+                        builder.addValue(static_cast<float>(read<uint8_t>(vertex, COMPACT_BONE_WEIGHTS + i)) / 255.0f);
+                    }
+                }
+
+                vertices.emplace_back(builder.build());
+            }
+
+            mesh.vertices = std::move(vertices);
+            mesh.vertexLayout = skinned ? SkinnedMesh::getDefaultVertexLayout() : Mesh::getDefaultVertexLayout();
+            mesh.positionOffset = Vec3f();
+            mesh.positionScale = Vec3f(1);
+        }
+
+        for (auto &subMesh: mesh.subMeshes) {
+            dequantize(subMesh);
+        }
+    }
+
+    bool VertexQuantizer::isCompact(const Mesh &mesh) {
+        return mesh.vertexLayout == Mesh::getCompactVertexLayout()
+               || mesh.vertexLayout == SkinnedMesh::getCompactVertexLayout();
+    }
+
+    Vec3f VertexQuantizer::getPosition(const Mesh &mesh, const Vertex &vertex) {
+        if (isCompact(mesh)) {
+            auto position = Vec3f(decodeSnorm16(read<int16_t>(vertex, COMPACT_POSITION)),
+                                  decodeSnorm16(read<int16_t>(vertex, COMPACT_POSITION + 2)),
+                                  decodeSnorm16(read<int16_t>(vertex, COMPACT_POSITION + 4)));
+            return mesh.positionOffset + position * mesh.positionScale;
+        } else {
+            return readVec3(vertex, DEFAULT_POSITION);
+        }
+    }
+
+    Vec2f VertexQuantizer::encodeOctahedral(const Vec3f &normal) {
+        auto l1 = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+        if (l1 <= 0) {
+            return {};
+        }
+
+        Vec2f ret(normal.x / l1, normal.y / l1);
+        if (normal.z < 0) {
+            // Fold the lower hemisphere over the diagonals
+            ret = Vec2f((1 - std::abs(ret.y)) * (ret.x >= 0 ? 1.0f : -1.0f),
+                        (1 - std::abs(ret.x)) * (ret.y >= 0 ? 1.0f : -1.0f));
+        }
+        return ret;
+    }
+
+    Vec3f VertexQuantizer::decodeOctahedral(const Vec2f &value) {
+        Vec3f ret(value.x, value.y, 1 - std::abs(value.x) - std::abs(value.y));
+        auto t = std::max(-ret.z, 0.0f);
+        ret.x += ret.x >= 0 ? -t : t;
+        ret.y += ret.y >= 0 ? -t : t;
+        return normalize(ret);
+    }
+
+    uint16_t VertexQuantizer::encodeHalf(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(float));
+
+        auto sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+        auto exponent = static_cast<int>((bits >> 23) & 0xff);
+        uint32_t mantissa = bits & 0x7fffff;
+
+        if (exponent == 0xff) {
+            // Infinity or NaN
+            return sign | 0x7c00 | (mantissa != 0 ? 0x200 : 0);
+        }
+
+        auto halfExponent = exponent - 127 + 15;
+        if (halfExponent >= 31) {
+            return sign | 0x7c00;
+        }
+
+        uint32_t half;
+        uint32_t remainder;
+        uint32_t halfway;
+        if (halfExponent <= 0) {
+            // Subnormal half
+            if (halfExponent < -10) {
+                return sign;
+            }
+            mantissa |= 0x800000;
+            auto shift = static_cast<uint32_t>(14 - halfExponent);
+            half = mantissa >> shift;
+            remainder = mantissa & ((1u << shift) - 1);
+            halfway = 1u << (shift - 1);
+        } else {
+            half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+            remainder = mantissa & 0x1fff;
+            halfway = 0x1000;
+        }
+
+        // A carry out of the mantissa correctly increments the exponent
+        if (remainder > halfway || (remainder == halfway && (half & 1) != 0)) {
+            half++;
+        }
+
+        return static_cast<uint16_t>(sign | half);
+    }
+
+    float VertexQuantizer::decodeHalf(uint16_t value) {
+        auto exponent = (value >> 10) & 0x1f;
+        auto mantissa = value & 0x3ff;
+
+        float ret;
+        if (exponent == 0) {
+            ret = std::ldexp(static_cast<float>(mantissa), -24);
+        } else if (exponent == 31) {
+            ret = mantissa == 0 ? std::numeric_limits<float>::infinity() : std::numeric_limits<float>::quiet_NaN();
+        } else {
+            ret = std::ldexp(static_cast<float>(mantissa | 0x400), exponent - 25);
+        }
+
+        return (value & 0x8000) != 0 ? -ret : ret;
+    }
+
+    int16_t VertexQuantizer::encodeSnorm16(float value) {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+    }
+
+    float VertexQuantizer::decodeSnorm16(int16_t value) {
+        // Matches the conversion of normalized signed integer vertex attributes in OpenGL 4.2+ and Vulkan
+        return std::max(static_cast<float>(value) / 32767.0f, -1.0f);
+    }
+}
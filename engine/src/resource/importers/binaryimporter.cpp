@@ -0,0 +1,64 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/resource/importers/binaryimporter.hpp"
+#include "xng/resource/importers/jsonimporter.hpp"
+
+#include "xng/ecs/entityscene.hpp"
+
+#include "xng/io/protocol/binaryprotocol.hpp"
+
+namespace xng {
+    static bool hasMagic(const ReadBuffer &buffer, const std::string &magic) {
+        return buffer.size() >= magic.size() && std::equal(magic.begin(), magic.end(), buffer.chars());
+    }
+
+    ResourceBundle BinaryImporter::read(std::istream &stream,
+                                        const std::string &hint,
+                                        const std::string &path,
+                                        Archive *archive) {
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
+
+    ResourceBundle BinaryImporter::readBuffer(const ReadBuffer &buffer,
+                                              const std::string &hint,
+                                              const std::string &path,
+                                              Archive *archive) {
+        if (hasMagic(buffer, BINARY_SCENE_MAGIC)) {
+            BinaryReader reader(buffer.chars(), buffer.size());
+            auto scene = std::make_unique<EntityScene>();
+            scene->deserialize(reader);
+            auto name = scene->getName();
+            ResourceBundle ret;
+            ret.add(name, std::move(scene));
+            return ret;
+        } else if (hasMagic(buffer, BINARY_PROTOCOL_MAGIC)) {
+            BinaryReader reader(buffer.chars(), buffer.size());
+            reader.skip(BINARY_PROTOCOL_MAGIC.size());
+            return JsonImporter::readBundle(BinaryProtocol::readMessage(reader));
+        } else {
+            throw std::runtime_error("Invalid binary file");
+        }
+    }
+
+    const std::set<std::string> &BinaryImporter::getSupportedFormats() const {
+        static const std::set<std::string> formats = {".xbin"};
+        return formats;
+    }
+}
@@ -0,0 +1,48 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+
+#include "xng/resource/importers/cookedtextureimporter.hpp"
+
+#include "xng/render/texture/cookedtexture.hpp"
+
+namespace xng {
+    ResourceBundle CookedTextureImporter::read(std::istream &stream,
+                                               const std::string &hint,
+                                               const std::string &path,
+                                               Archive *archive) {
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
+
+    ResourceBundle CookedTextureImporter::readBuffer(const ReadBuffer &buffer,
+                                                     const std::string &hint,
+                                                     const std::string &path,
+                                                     Archive *archive) {
+        auto texture = std::make_unique<CookedTexture>();
+        texture->deserialize(buffer);
+        ResourceBundle ret;
+        ret.add("texture", std::move(texture));
+        return ret;
+    }
+
+    const std::set<std::string> &CookedTextureImporter::getSupportedFormats() const {
+        static const std::set<std::string> formats = {".xtex"};
+        return formats;
+    }
+}
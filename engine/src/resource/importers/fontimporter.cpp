@@ -28,18 +28,15 @@ namespace xng {
                                       const std::string &hint,
                                       const std::string &path,
                                       Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
 
+    ResourceBundle FontImporter::readBuffer(const ReadBuffer &buffer,
+                                            const std::string &hint,
+                                            const std::string &path,
+                                            Archive *archive) {
         ResourceBundle ret;
-        ret.add("", std::make_unique<Font>(Font(buffer)));
+        ret.add("", std::make_unique<Font>(Font(std::vector<char>(buffer.chars(), buffer.chars() + buffer.size()))));
         return ret;
     }
 
@@ -86,18 +86,15 @@ namespace xng {
         return ret;
     }
 
-    static ResourceBundle readJsonBundle(const std::vector<char> &buffer) {
-        auto stream = std::stringstream(std::string(buffer.begin(), buffer.end()));
-        const Message m = JsonProtocol().deserialize(stream);
-
+    ResourceBundle JsonImporter::readBundle(const Message &m) {
         ResourceBundle ret;
 
         if (m.has("name") || m.has("entities")) {
             // Parse as EntityScene
             auto name = m.getMessage("name", std::string()).asString();
-            EntityScene scene;
-            scene << m;
-            ret.add(name, std::make_unique<EntityScene>(scene));
+            auto scene = std::make_unique<EntityScene>();
+            *scene << m;
+            ret.add(name, std::move(scene));
         } else {
             // Parse as ResourceBundle
             if (m.has("materials") && m.at("materials").getType() == Message::LIST) {
@@ -152,17 +149,15 @@ namespace xng {
                                       const std::string &hint,
                                       const std::string &path,
                                       Archive *archive) {
-        std::vector<char> buffer;
-
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+        return readBundle(JsonProtocol().deserialize(stream));
+    }
 
-        return readJsonBundle(buffer);
+    ResourceBundle JsonImporter::readBuffer(const ReadBuffer &buffer,
+                                            const std::string &hint,
+                                            const std::string &path,
+                                            Archive *archive) {
+        ReadBufferStream stream(buffer);
+        return readBundle(JsonProtocol().deserialize(stream));
     }
 
     const std::set<std::string> &JsonImporter::getSupportedFormats() const {
@@ -26,7 +26,7 @@
 #include <cstring>
 
 namespace xng {
-    static ImageRGBA readImage(const std::vector<char> &buffer) {
+    static ImageRGBA readImage(const ReadBuffer &buffer) {
         int width, height, nrChannels;
         stbi_uc *data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>(buffer.data()),
                                               buffer.size(),
@@ -52,15 +52,13 @@ namespace xng {
                                       const std::string &hint,
                                       const std::string &path,
                                       Archive *archive) {
-        std::vector<char> buffer;
+        return readBuffer(ReadBuffer::fromStream(stream), hint, path, archive);
+    }
 
-        char c;
-        while (!stream.eof()) {
-            stream.read(&c, 1);
-            if (stream.gcount() == 1) {
-                buffer.emplace_back(c);
-            }
-        }
+    ResourceBundle StbiImporter::readBuffer(const ReadBuffer &buffer,
+                                            const std::string &hint,
+                                            const std::string &path,
+                                            Archive *archive) {
         //Try to read source as image
         int x, y, n;
         auto r = stbi_info_from_memory((const stbi_uc *) (buffer.data()),
@@ -42,6 +42,7 @@ namespace xng {
     }
 
     ResourceRegistry::~ResourceRegistry() {
+        streamer.waitIdle();
         auto tasks = loadTasks;
         for (auto &pair: tasks) {
             auto ex = pair.second->join();
@@ -86,16 +87,27 @@ namespace xng {
         return *archives.at(scheme);
     }
 
-    void ResourceRegistry::incRef(const Uri &uri) {
-        if (bundleRefCounter.inc(uri.getFile())) {
-            load(uri);
+    const ResourceId &ResourceRegistry::intern(const Uri &uri) {
+        {
+            std::shared_lock l(internMutex);
+            auto it = ids.find(uri);
+            if (it != ids.end()) {
+                return *it->second;
+            }
         }
-    }
 
-    void ResourceRegistry::decRef(const Uri &uri) {
-        if (bundleRefCounter.dec(uri.getFile())) {
-            unload(uri);
+        std::unique_lock l(internMutex);
+        auto &id = ids[uri];
+        if (id == nullptr) {
+            auto &counter = bundleCounters[uri.getFile()];
+            if (counter == nullptr) {
+                counter = std::make_unique<ResourceBundleCounter>();
+            }
+            id = std::make_unique<ResourceId>();
+            id->uri = uri;
+            id->bundle = counter.get();
         }
+        return *id;
     }
 
     void ResourceRegistry::reload(const Uri &uri) {
@@ -112,10 +124,14 @@ namespace xng {
             task->join();
         }
 
-        bundles.erase(uri.getFile());
-        uris.erase(uri);
+        {
+            std::vector<ResourceBundle> unloaded;
+            std::lock_guard<std::mutex> g(mutex);
+            removeBundle(uri.getFile(), unloaded);
+            uris.erase(uri);
+        }
 
-        load(uri);
+        load(uri, ResourceStreamer::VISIBLE, 0);
     }
 
     void ResourceRegistry::await(const Uri &uri) {
@@ -125,6 +141,7 @@ namespace xng {
             auto it = loadTasks.find(uri.getFile());
             if (it != loadTasks.end()) {
                 task = it->second;
+                streamer.setPriority(uri.getFile(), ResourceStreamer::CRITICAL, 0);
             }
         }
 
@@ -141,55 +158,319 @@ namespace xng {
         return loadingUris;
     }
 
-    void ResourceRegistry::load(const Uri &uri) {
+    bool ResourceRegistry::setLoadPriority(const Uri &uri, ResourceStreamer::Priority priority, float distance) {
+        return streamer.setPriority(uri.getFile(), priority, distance);
+    }
+
+    void ResourceRegistry::addLoadCallback(const Uri &uri, LoadCallback callback) {
+        {
+            std::lock_guard<std::mutex> g(mutex);
+            if (loadTasks.find(uri.getFile()) != loadTasks.end()) {
+                loadCallbacks[uri.getFile()].emplace_back(std::move(callback));
+                return;
+            } else if (bundles.find(uri.getFile()) == bundles.end()) {
+                throw std::runtime_error("Uri " + uri.toString() + " is not loaded or loading");
+            }
+        }
+        callback(uri, nullptr);
+    }
+
+    void ResourceRegistry::setStreamingConcurrency(size_t maxIo, size_t maxDecode) {
+        streamer.setConcurrency(maxIo, maxDecode);
+    }
+
+    void ResourceRegistry::setCachePolicy(const std::string &scheme, const ResourceCachePolicy &policy) {
+        std::vector<ResourceBundle> unloaded;
+        std::lock_guard<std::mutex> g(mutex);
+        cachePolicies[scheme] = policy;
+        collectBundles(unloaded);
+    }
+
+    void ResourceRegistry::setDefaultCachePolicy(const ResourceCachePolicy &policy) {
+        std::vector<ResourceBundle> unloaded;
+        std::lock_guard<std::mutex> g(mutex);
+        defaultCachePolicy = policy;
+        collectBundles(unloaded);
+    }
+
+    ResourceCacheStatistics ResourceRegistry::getCacheStatistics() {
         std::lock_guard<std::mutex> g(mutex);
+        return cacheStatistics;
+    }
+
+    void ResourceRegistry::collect() {
+        std::vector<ResourceBundle> unloaded;
+        std::lock_guard<std::mutex> g(mutex);
+        collectBundles(unloaded);
+    }
+
+    ResourceBundleCounter &ResourceRegistry::getBundleCounter(const std::string &file) {
+        {
+            std::shared_lock l(internMutex);
+            auto it = bundleCounters.find(file);
+            if (it != bundleCounters.end()) {
+                return *it->second;
+            }
+        }
+
+        std::unique_lock l(internMutex);
+        auto &counter = bundleCounters[file];
+        if (counter == nullptr) {
+            counter = std::make_unique<ResourceBundleCounter>();
+        }
+        return *counter;
+    }
+
+    void ResourceRegistry::load(const Uri &uri, ResourceStreamer::Priority priority, float distance) {
+        std::vector<ResourceBundle> unloaded;
+        std::lock_guard<std::mutex> g(mutex);
+
+        // The last reference was removed before the load locked the mutex
+        if (getBundleCounter(uri.getFile()).references.load(std::memory_order_acquire) == 0) {
+            return;
+        }
 
         uris.insert(uri);
 
+        // The uri is referenced again before the pending load completed
+        killBundles.erase(uri.getFile());
+
         auto it = loadTasks.find(uri.getFile());
-        if (it == loadTasks.end() && bundles.find(uri.getFile()) == bundles.end()) {
+        auto cacheIt = cacheEntries.find(uri.getFile());
+        if (cacheIt != cacheEntries.end()) {
+            cacheStatistics.hits++;
+            auto &entry = cacheIt->second;
+            if (!entry.referenced) {
+                unreferencedBundles.erase(entry.lruIterator);
+                cacheStatistics.unreferencedBytes -= entry.size;
+                entry.referenced = true;
+            }
+        } else if (it != loadTasks.end()) {
+            cacheStatistics.hits++;
+        } else {
+            cacheStatistics.misses++;
             loadingUris.insert(uri);
-            loadTasks[uri.getFile()] = ThreadPool::getPool().addTask([this, uri]() {
-                try {
-                    std::shared_lock l(importerMutex);
-
-                    auto &archive = resolveUri(uri);
-                    std::filesystem::path path(uri.getFile());
-                    auto stream = archive.open(path.string());
-                    auto bundle = getImporter(path.extension().string())
-                            .read(*stream, path.extension().string(), path.string(), &archive);
-
-                    std::lock_guard<std::mutex> g(mutex);
-
-                    if (killBundles.find(uri.getFile()) == killBundles.end()) {
-                        bundles[uri.getFile()] = std::move(bundle);
-                    } else {
-                        killBundles.erase(uri.getFile());
-                        uris.erase(uri);
-                    }
-
-                    loadTasks.erase(uri.getFile());
-                    loadingUris.erase(uri);
-                } catch (const std::runtime_error &e) {
-                    Log::instance().log(ERROR, e.what());
+            auto scheme = getCacheScheme(uri);
 
-                    throw e;
+            // The task is started by the streamer callback and rethrows the exception of the load to the joining threads
+            auto result = std::make_shared<std::exception_ptr>();
+            auto task = std::make_shared<Task>([result]() {
+                if (*result) {
+                    std::rethrow_exception(*result);
                 }
             });
+            loadTasks[uri.getFile()] = task;
+
+            streamer.enqueue(uri.getFile(),
+                             priority,
+                             distance,
+                             [this, uri]() {
+                                 auto &archive = resolveUri(uri);
+                                 return archive.openBuffer(std::filesystem::path(uri.getFile()).string());
+                             },
+                             [this, uri, scheme](const ReadBuffer &buffer) {
+                                 std::shared_lock l(importerMutex);
+
+                                 auto &archive = resolveUri(uri);
+                                 std::filesystem::path path(uri.getFile());
+                                 auto bundle = getImporter(path.extension().string())
+                                         .readBuffer(buffer, path.extension().string(), path.string(), &archive);
+
+                                 auto size = bundle.getMemoryUsage();
+                                 if (size == 0) {
+                                     size = buffer.size();
+                                 }
+
+                                 std::vector<ResourceBundle> unloaded;
+                                 std::lock_guard<std::mutex> g(mutex);
+
+                                 // Bundles which were released while loading are cached like any other unreferenced bundle
+                                 bool referenced = killBundles.find(uri.getFile()) == killBundles.end();
+                                 if (!referenced) {
+                                     killBundles.erase(uri.getFile());
+                                     uris.erase(uri);
+                                 }
+
+                                 insertBundle(uri.getFile(), scheme, std::move(bundle), size, referenced, unloaded);
+
+                                 loadTasks.erase(uri.getFile());
+                                 loadingUris.erase(uri);
+
+                                 collectBundles(unloaded);
+                             },
+                             [this, uri, result, task](ResourceStreamer::Status status,
+                                                       const std::exception_ptr &exception) {
+                                 // Cancelled loads are cleaned up by unload which holds the mutex
+                                 if (status == ResourceStreamer::CANCELLED) {
+                                     *result = std::make_exception_ptr(
+                                             std::runtime_error("Load of " + uri.toString() + " was cancelled"));
+                                     task->start();
+                                     return;
+                                 }
+
+                                 if (exception) {
+                                     try {
+                                         std::rethrow_exception(exception);
+                                     } catch (const std::exception &e) {
+                                         Log::instance().log(ERROR, e.what());
+                                     } catch (...) {}
+                                 }
+
+                                 std::vector<LoadCallback> callbacks;
+                                 {
+                                     std::lock_guard<std::mutex> g(mutex);
+                                     auto callbackIt = loadCallbacks.find(uri.getFile());
+                                     if (callbackIt != loadCallbacks.end()) {
+                                         callbacks = std::move(callbackIt->second);
+                                         loadCallbacks.erase(callbackIt);
+                                     }
+                                 }
+
+                                 *result = exception;
+                                 task->start();
+
+                                 for (auto &callback: callbacks) {
+                                     callback(uri, exception);
+                                 }
+                             });
         }
+
+        collectBundles(unloaded);
     }
 
     void ResourceRegistry::unload(const Uri &uri) {
-        std::lock_guard<std::mutex> g(mutex);
+        std::vector<LoadCallback> callbacks;
+        std::shared_ptr<Task> task;
+        {
+            std::vector<ResourceBundle> unloaded;
+            std::lock_guard<std::mutex> g(mutex);
 
-        auto it = loadTasks.find(uri.getFile());
-        if (it != loadTasks.end()) {
-            killBundles.insert(uri.getFile());
-        } else {
-            uris.erase(uri);
+            // The bundle was referenced again before the unload locked the mutex
+            if (getBundleCounter(uri.getFile()).references.load(std::memory_order_acquire) > 0) {
+                return;
+            }
+
+            auto it = loadTasks.find(uri.getFile());
+            if (it != loadTasks.end()) {
+                if (streamer.cancel(uri.getFile())) {
+                    // The load did not start yet
+                    task = it->second;
+                    loadTasks.erase(it);
+                    loadingUris.erase(uri);
+                    uris.erase(uri);
+
+                    auto callbackIt = loadCallbacks.find(uri.getFile());
+                    if (callbackIt != loadCallbacks.end()) {
+                        callbacks = std::move(callbackIt->second);
+                        loadCallbacks.erase(callbackIt);
+                    }
+                } else {
+                    killBundles.insert(uri.getFile());
+                }
+            } else {
+                uris.erase(uri);
+                releaseBundle(uri.getFile());
+            }
+
+            collectBundles(unloaded);
+        }
+
+        if (task != nullptr) {
+            auto exception = task->join();
+            for (auto &callback: callbacks) {
+                callback(uri, exception);
+            }
         }
     }
 
+    void ResourceRegistry::insertBundle(const std::string &file,
+                                        const std::string &scheme,
+                                        ResourceBundle bundle,
+                                        size_t size,
+                                        bool referenced,
+                                        std::vector<ResourceBundle> &unloaded) {
+        removeBundle(file, unloaded);
+
+        bundles[file] = std::move(bundle);
+        getBundleCounter(file).generation.fetch_add(1, std::memory_order_acq_rel);
+
+        CacheEntry entry;
+        entry.scheme = scheme;
+        entry.size = size;
+        entry.referenced = true;
+        cacheEntries[file] = entry;
+
+        schemeBytes[scheme] += size;
+        cacheStatistics.residentBytes += size;
+
+        if (!referenced) {
+            releaseBundle(file);
+        }
+    }
+
+    void ResourceRegistry::removeBundle(const std::string &file, std::vector<ResourceBundle> &unloaded) {
+        auto it = bundles.find(file);
+        if (it != bundles.end()) {
+            unloaded.emplace_back(std::move(it->second));
+            bundles.erase(it);
+            getBundleCounter(file).generation.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        auto entryIt = cacheEntries.find(file);
+        if (entryIt != cacheEntries.end()) {
+            auto &entry = entryIt->second;
+            if (!entry.referenced) {
+                unreferencedBundles.erase(entry.lruIterator);
+                cacheStatistics.unreferencedBytes -= entry.size;
+            }
+            schemeBytes[entry.scheme] -= entry.size;
+            cacheStatistics.residentBytes -= entry.size;
+            cacheEntries.erase(entryIt);
+        }
+    }
+
+    void ResourceRegistry::releaseBundle(const std::string &file) {
+        auto it = cacheEntries.find(file);
+        if (it == cacheEntries.end() || !it->second.referenced) {
+            return;
+        }
+        auto &entry = it->second;
+        entry.referenced = false;
+        entry.releaseTime = std::chrono::steady_clock::now();
+        entry.lruIterator = unreferencedBundles.insert(unreferencedBundles.end(), file);
+        cacheStatistics.unreferencedBytes += entry.size;
+    }
+
+    void ResourceRegistry::collectBundles(std::vector<ResourceBundle> &unloaded) {
+        auto now = std::chrono::steady_clock::now();
+
+        // Unload the bundles with expired grace periods, and the least recently released bundles of schemes over budget
+        for (auto it = unreferencedBundles.begin(); it != unreferencedBundles.end();) {
+            auto file = *it;
+            it++;
+
+            auto &entry = cacheEntries.at(file);
+            auto &policy = getCachePolicy(entry.scheme);
+            if (now - entry.releaseTime >= policy.gracePeriod
+                || schemeBytes[entry.scheme] > policy.memoryBudget) {
+                removeBundle(file, unloaded);
+                cacheStatistics.evictions++;
+            }
+        }
+    }
+
+    const ResourceCachePolicy &ResourceRegistry::getCachePolicy(const std::string &scheme) const {
+        auto it = cachePolicies.find(scheme);
+        if (it != cachePolicies.end()) {
+            return it->second;
+        }
+        return defaultCachePolicy;
+    }
+
+    std::string ResourceRegistry::getCacheScheme(const Uri &uri) const {
+        return uri.getScheme().empty() ? defaultScheme : uri.getScheme();
+    }
+
     Archive &ResourceRegistry::resolveUri(const Uri &uri) {
         std::shared_lock l(archiveMutex);
         if (uri.getScheme().empty()) {
@@ -0,0 +1,209 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/resource/resourcestreamer.hpp"
+
+namespace xng {
+    ResourceStreamer::ResourceStreamer(size_t maxIo, size_t maxDecode, ThreadPool &pool)
+            : pool(pool), maxIo(std::max<size_t>(maxIo, 1)), maxDecode(std::max<size_t>(maxDecode, 1)) {}
+
+    ResourceStreamer::~ResourceStreamer() {
+        std::unique_lock<std::mutex> l(mutex);
+        readQueue.clear();
+        decodeQueue.clear();
+        for (auto it = requests.begin(); it != requests.end();) {
+            auto stage = it->second->stage;
+            if (stage == QUEUED_READ || stage == QUEUED_DECODE) {
+                it = requests.erase(it);
+            } else {
+                it++;
+            }
+        }
+        idleCondition.wait(l, [this]() { return activeTasks == 0; });
+    }
+
+    void ResourceStreamer::enqueue(const std::string &key,
+                                   Priority priority,
+                                   float distance,
+                                   Reader reader,
+                                   Decoder decoder,
+                                   Callback callback) {
+        std::lock_guard<std::mutex> l(mutex);
+        if (requests.find(key) != requests.end())
+            throw std::runtime_error("Request with key " + key + " already exists");
+
+        auto request = std::make_shared<Request>();
+        request->key = key;
+        request->priority = priority;
+        request->distance = distance;
+        request->sequence = sequence++;
+        request->reader = std::move(reader);
+        request->decoder = std::move(decoder);
+        request->callback = std::move(callback);
+
+        requests[key] = request;
+        readQueue.insert(getQueueKey(*request));
+
+        dispatch();
+    }
+
+    bool ResourceStreamer::setPriority(const std::string &key, Priority priority, float distance) {
+        std::lock_guard<std::mutex> l(mutex);
+        auto it = requests.find(key);
+        if (it == requests.end())
+            return false;
+
+        auto &request = *it->second;
+        std::set<QueueKey> *queue;
+        if (request.stage == QUEUED_READ) {
+            queue = &readQueue;
+        } else if (request.stage == QUEUED_DECODE) {
+            queue = &decodeQueue;
+        } else {
+            return false;
+        }
+
+        queue->erase(getQueueKey(request));
+        request.priority = priority;
+        request.distance = distance;
+        queue->insert(getQueueKey(request));
+        return true;
+    }
+
+    bool ResourceStreamer::cancel(const std::string &key) {
+        std::shared_ptr<Request> request;
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            auto it = requests.find(key);
+            if (it == requests.end())
+                return false;
+
+            request = it->second;
+            if (request->stage == QUEUED_READ) {
+                readQueue.erase(getQueueKey(*request));
+            } else if (request->stage == QUEUED_DECODE) {
+                decodeQueue.erase(getQueueKey(*request));
+            } else {
+                return false;
+            }
+            requests.erase(it);
+        }
+        request->callback(CANCELLED, nullptr);
+        return true;
+    }
+
+    void ResourceStreamer::setConcurrency(size_t io, size_t decode) {
+        std::lock_guard<std::mutex> l(mutex);
+        maxIo = std::max<size_t>(io, 1);
+        maxDecode = std::max<size_t>(decode, 1);
+        dispatch();
+    }
+
+    bool ResourceStreamer::contains(const std::string &key) {
+        std::lock_guard<std::mutex> l(mutex);
+        return requests.find(key) != requests.end();
+    }
+
+    void ResourceStreamer::waitIdle() {
+        std::unique_lock<std::mutex> l(mutex);
+        idleCondition.wait(l, [this]() { return requests.empty() && activeTasks == 0; });
+    }
+
+    void ResourceStreamer::dispatch() {
+        // Decodes are started first, they complete requests and release their read buffers
+        while (runningDecode < maxDecode && !decodeQueue.empty()) {
+            auto request = requests.at(std::get<3>(*decodeQueue.begin()));
+            decodeQueue.erase(decodeQueue.begin());
+            request->stage = DECODING;
+            runningDecode++;
+            activeTasks++;
+            pool.addTask([this, request]() { decode(request); });
+        }
+
+        while (runningIo < maxIo && !readQueue.empty()) {
+            auto request = requests.at(std::get<3>(*readQueue.begin()));
+            readQueue.erase(readQueue.begin());
+            request->stage = READING;
+            runningIo++;
+            activeTasks++;
+            pool.addTask([this, request]() { read(request); });
+        }
+    }
+
+    void ResourceStreamer::read(const std::shared_ptr<Request> &request) {
+        std::exception_ptr exception;
+        try {
+            request->buffer = request->reader();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            runningIo--;
+            if (!exception) {
+                request->stage = QUEUED_DECODE;
+                decodeQueue.insert(getQueueKey(*request));
+            }
+            dispatch();
+        }
+
+        if (exception) {
+            finish(request, FAILED, exception);
+        }
+
+        std::lock_guard<std::mutex> l(mutex);
+        activeTasks--;
+        idleCondition.notify_all();
+    }
+
+    void ResourceStreamer::decode(const std::shared_ptr<Request> &request) {
+        std::exception_ptr exception;
+        try {
+            request->decoder(request->buffer);
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        request->buffer = {};
+
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            runningDecode--;
+            dispatch();
+        }
+
+        finish(request, exception ? FAILED : COMPLETED, exception);
+
+        std::lock_guard<std::mutex> l(mutex);
+        activeTasks--;
+        idleCondition.notify_all();
+    }
+
+    void ResourceStreamer::finish(const std::shared_ptr<Request> &request,
+                                  Status status,
+                                  const std::exception_ptr &exception) {
+        // The key can be enqueued again from within the callback
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            requests.erase(request->key);
+        }
+
+        request->callback(status, exception);
+    }
+}
@@ -0,0 +1,107 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/shader/shaderdecompilercache.hpp"
+
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "xng/util/stablehash.hpp"
+
+namespace xng {
+    static std::filesystem::path getSourcePath(const std::filesystem::path &directory, uint64_t key) {
+        std::stringstream stream;
+        stream << std::hex << std::setw(16) << std::setfill('0') << key << ".glsl";
+        return directory / stream.str();
+    }
+
+    ShaderDecompilerCache::ShaderDecompilerCache(ShaderDecompiler &decompiler, std::filesystem::path directory)
+            : decompiler(decompiler) {
+        setDirectory(directory);
+    }
+
+    std::string ShaderDecompilerCache::decompile(const std::vector<uint32_t> &source,
+                                                 const std::string &entryPoint,
+                                                 ShaderStage stage,
+                                                 ShaderLanguage targetLanguage) const {
+        StableHash hash;
+        hash.add(source);
+        hash.add(entryPoint);
+        hash.add(stage);
+        hash.add(targetLanguage);
+        auto key = hash.get();
+
+        std::filesystem::path path;
+        {
+            std::lock_guard<std::mutex> l(mutex);
+            auto it = sources.find(key);
+            if (it != sources.end()) {
+                return it->second;
+            }
+            if (!directory.empty()) {
+                path = getSourcePath(directory, key);
+            }
+        }
+
+        std::string ret;
+        bool cached = false;
+        if (!path.empty()) {
+            std::ifstream stream(path, std::ios::binary);
+            if (stream) {
+                std::stringstream buffer;
+                buffer << stream.rdbuf();
+                ret = buffer.str();
+                cached = true;
+            }
+        }
+
+        if (!cached) {
+            ret = decompiler.decompile(source, entryPoint, stage, targetLanguage);
+            if (!path.empty()) {
+                // Written to a temporary file first so that other processes never read partially written sources
+                auto tmp = path;
+                tmp += ".tmp";
+                {
+                    std::ofstream stream(tmp, std::ios::binary);
+                    stream.write(ret.data(), static_cast<std::streamsize>(ret.size()));
+                }
+                std::error_code error;
+                std::filesystem::rename(tmp, path, error);
+            }
+        }
+
+        std::lock_guard<std::mutex> l(mutex);
+        sources[key] = ret;
+        return ret;
+    }
+
+    void ShaderDecompilerCache::setDirectory(const std::filesystem::path &value) {
+        std::lock_guard<std::mutex> l(mutex);
+        directory = value;
+        if (!directory.empty()) {
+            std::filesystem::create_directories(directory);
+        }
+    }
+
+    void ShaderDecompilerCache::clear() {
+        std::lock_guard<std::mutex> l(mutex);
+        sources.clear();
+    }
+}
@@ -1,6 +1,7 @@
 #version 460
 
 #include "texfilter.glsl"
+#include "material.glsl"
 
 layout(location = 0) in vec3 fPos;
 layout(location = 1) in vec3 fNorm;
@@ -19,28 +20,14 @@ layout(location = 3) out vec4 oRoughnessMetallicAO;
 layout(location = 4) out vec4 oAlbedo;
 layout(location = 5) out ivec4 oObjectShadows;
 
-struct ShaderAtlasTexture {
-    ivec4 level_index_filtering_assigned;
-    vec4 atlasScale_texSize;
-};
-
 struct ShaderDrawData {
     mat4 model;
     mat4 mvp;
 
-    ivec4 objectID_boneOffset_shadows;
-
-    vec4 metallic_roughness_ambientOcclusion;
-    vec4 albedoColor;
-
-    vec4 normalIntensity;
+    ivec4 objectID_boneOffset_shadows_material;
 
-    ShaderAtlasTexture normal;
-
-    ShaderAtlasTexture metallic;
-    ShaderAtlasTexture roughness;
-    ShaderAtlasTexture ambientOcclusion;
-    ShaderAtlasTexture albedo;
+    vec4 positionOffset;
+    vec4 positionScale;
 };
 
 layout(binding = 0, std140) buffer ShaderUniformBuffer
@@ -50,6 +37,11 @@ layout(binding = 0, std140) buffer ShaderUniformBuffer
 
 layout(binding = 1) uniform sampler2DArray atlasTextures[12];
 
+layout(binding = 14, std140) buffer MaterialBuffer
+{
+    ShaderMaterial materials[];
+} materials;
+
 vec4 textureAtlas(ShaderAtlasTexture tex, vec2 inUv)
 {
     if (tex.level_index_filtering_assigned.w == 0)
@@ -71,35 +63,36 @@ vec4 textureAtlas(ShaderAtlasTexture tex, vec2 inUv)
 }
 
 void main() {
-    ShaderDrawData data = globs.data[drawID];
+    ShaderDrawData drawData = globs.data[drawID];
+    ShaderMaterial material = materials.materials[drawData.objectID_boneOffset_shadows_material.w];
 
     oPosition = vec4(fPos, 1);
 
-    if (data.albedo.level_index_filtering_assigned.w == 0) {
-        oAlbedo = data.albedoColor;
+    if (material.albedo.level_index_filtering_assigned.w == 0) {
+        oAlbedo = material.albedoColor;
     } else {
-        oAlbedo = textureAtlas(data.albedo, fUv);
+        oAlbedo = textureAtlas(material.albedo, fUv);
     }
 
-    oRoughnessMetallicAO.r = textureAtlas(data.roughness, fUv).r + data.metallic_roughness_ambientOcclusion.y;
-    oRoughnessMetallicAO.g = textureAtlas(data.metallic, fUv).r + data.metallic_roughness_ambientOcclusion.x;
-    oRoughnessMetallicAO.b = textureAtlas(data.ambientOcclusion, fUv).r + data.metallic_roughness_ambientOcclusion.z;
+    oRoughnessMetallicAO.r = textureAtlas(material.roughness, fUv).r + material.metallic_roughness_ambientOcclusion.y;
+    oRoughnessMetallicAO.g = textureAtlas(material.metallic, fUv).r + material.metallic_roughness_ambientOcclusion.x;
+    oRoughnessMetallicAO.b = textureAtlas(material.ambientOcclusion, fUv).r + material.metallic_roughness_ambientOcclusion.z;
     oRoughnessMetallicAO.a = 1;
 
-    mat3 normalMatrix = mat3(transpose(inverse(data.model)));
+    mat3 normalMatrix = mat3(transpose(inverse(drawData.model)));
     oNormal = vec4(normalize(normalMatrix * fNorm), 1);
     oTangent = vec4(normalize(normalMatrix * fTan), 1);
 
-    if (data.normal.level_index_filtering_assigned.w != 0)
+    if (material.normal.level_index_filtering_assigned.w != 0)
     {
         mat3x3 tbn = mat3(fT, fB, fN);
-        vec3 texNormal = textureAtlas(data.normal, fUv).xyz * vec3(data.normalIntensity.x, data.normalIntensity.x, 1);
+        vec3 texNormal = textureAtlas(material.normal, fUv).xyz * vec3(material.normalIntensity.x, material.normalIntensity.x, 1);
         texNormal = tbn * normalize(texNormal * 2.0 - 1.0);
         oNormal = vec4(normalize(texNormal), 1);
     }
 
-    oObjectShadows.r = data.objectID_boneOffset_shadows.x;
-    oObjectShadows.g = data.objectID_boneOffset_shadows.z;
+    oObjectShadows.r = drawData.objectID_boneOffset_shadows_material.x;
+    oObjectShadows.g = drawData.objectID_boneOffset_shadows_material.z;
     oObjectShadows.b = 0;
     oObjectShadows.a = 1;
 }
@@ -16,28 +16,14 @@ layout(location = 6) out vec3 fB;
 layout(location = 7) out vec3 fN;
 layout(location = 8) flat out uint drawID;
 
-struct ShaderAtlasTexture {
-    ivec4 level_index_filtering_assigned;
-    vec4 atlasScale_texSize;
-};
-
 struct ShaderDrawData {
     mat4 model;
     mat4 mvp;
 
-    ivec4 objectID_boneOffset_shadows;
-
-    vec4 metallic_roughness_ambientOcclusion;
-    vec4 albedoColor;
-
-    vec4 normalIntensity;
-
-    ShaderAtlasTexture normal;
+    ivec4 objectID_boneOffset_shadows_material;
 
-    ShaderAtlasTexture metallic;
-    ShaderAtlasTexture roughness;
-    ShaderAtlasTexture ambientOcclusion;
-    ShaderAtlasTexture albedo;
+    vec4 positionOffset;
+    vec4 positionScale;
 };
 
 layout(binding = 0, std140) buffer ShaderUniformBuffer
@@ -18,28 +18,14 @@ layout(location = 6) out vec3 fB;
 layout(location = 7) out vec3 fN;
 layout(location = 8) flat out uint drawID;
 
-struct ShaderAtlasTexture {
-    ivec4 level_index_filtering_assigned;
-    vec4 atlasScale_texSize;
-};
-
 struct ShaderDrawData {
     mat4 model;
     mat4 mvp;
 
-    ivec4 objectID_boneOffset_shadows;
-
-    vec4 metallic_roughness_ambientOcclusion;
-    vec4 albedoColor;
-
-    vec4 normalIntensity;
-
-    ShaderAtlasTexture normal;
+    ivec4 objectID_boneOffset_shadows_material;
 
-    ShaderAtlasTexture metallic;
-    ShaderAtlasTexture roughness;
-    ShaderAtlasTexture ambientOcclusion;
-    ShaderAtlasTexture albedo;
+    vec4 positionOffset;
+    vec4 positionScale;
 };
 
 layout(binding = 0, std140) buffer ShaderUniformBuffer
@@ -49,67 +35,24 @@ layout(binding = 0, std140) buffer ShaderUniformBuffer
 
 layout(binding = 1) uniform sampler2DArray atlasTextures[12];
 
-layout(binding = 13, std140) buffer BoneBuffer
+layout(binding = 13, std430) buffer BonePaletteData
 {
-    mat4 matrices[];
-} bones;
-
-vec4 getSkinnedVertexPosition(int offset) {
-    if (offset < 0) {
-        return vec4(vPosition, 1.0f);
-    }
-
-    int boneCount = bones.matrices.length();
-
-    vec4 totalPosition = vec4(0, 0, 0, 0);
-    if (boneIds.x > -1)
-    {
-        if (boneIds.x + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.x + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.x;
-        }
-    }
-
-    if (boneIds.y > -1)
-    {
-        if (boneIds.y + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.y + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.y;
-        }
-    }
-
-    if (boneIds.z > -1)
-    {
-        if (boneIds.z + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.z + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.z;
-        }
-    }
-
-    if (boneIds.w > -1)
-    {
-        if (boneIds.w + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.w + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.w;
-        }
-    }
-
-    return totalPosition;
-}
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 15, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
+
+#include "skinning.glsl"
 
 void main()
 {
     ShaderDrawData data = globs.data[gl_DrawID];
 
-    vec4 pos = getSkinnedVertexPosition(data.objectID_boneOffset_shadows.y);
+    vec4 pos = vec4(getSkinnedPosition(vPosition, boneIds, boneWeights, data.objectID_boneOffset_shadows_material.y), 1.0f);
 
     vPos = data.mvp * pos;
     fPos = (data.model * pos).xyz;
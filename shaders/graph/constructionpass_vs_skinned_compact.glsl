@@ -0,0 +1,80 @@
+#version 460
+
+#include "vertexcompression.glsl"
+
+layout (location = 0) in vec4 vPositionBitangentSign;
+layout (location = 1) in vec4 vNormalTangent;
+layout (location = 2) in vec2 vUv;
+layout (location = 3) in ivec4 boneIds;
+layout (location = 4) in vec4 boneWeights;
+
+layout(location = 0) out vec3 fPos;
+layout(location = 1) out vec3 fNorm;
+layout(location = 2) out vec3 fTan;
+layout(location = 3) out vec2 fUv;
+layout(location = 4) out vec4 vPos;
+layout(location = 5) out vec3 fT;
+layout(location = 6) out vec3 fB;
+layout(location = 7) out vec3 fN;
+layout(location = 8) flat out uint drawID;
+
+struct ShaderDrawData {
+    mat4 model;
+    mat4 mvp;
+
+    ivec4 objectID_boneOffset_shadows_material;
+
+    vec4 positionOffset;
+    vec4 positionScale;
+};
+
+layout(binding = 0, std140) buffer ShaderUniformBuffer
+{
+    ShaderDrawData data[];
+} globs;
+
+layout(binding = 1) uniform sampler2DArray atlasTextures[12];
+
+layout(binding = 13, std430) buffer BonePaletteData
+{
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 15, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
+
+vec3 vPosition;
+
+#include "skinning.glsl"
+
+void main()
+{
+    ShaderDrawData data = globs.data[gl_DrawID];
+
+    vPosition = decodePosition(vPositionBitangentSign.xyz, data.positionOffset, data.positionScale);
+
+    vec3 vNormal = decodeOctahedral(vNormalTangent.xy);
+    vec3 vTangent = decodeOctahedral(vNormalTangent.zw);
+    float bitangentSign = vPositionBitangentSign.w < 0 ? -1 : 1;
+
+    vec4 pos = vec4(getSkinnedPosition(vPosition, boneIds, boneWeights, data.objectID_boneOffset_shadows_material.y), 1.0f);
+
+    vPos = data.mvp * pos;
+    fPos = (data.model * pos).xyz;
+    fUv = vUv;
+
+    fNorm = vNormal;
+    fTan = vTangent;
+
+    //https://www.gamedeveloper.com/programming/three-normal-mapping-techniques-explained-for-the-mathematically-uninclined
+    fN = normalize((data.model * vec4(vNormal, 0.0)).xyz);
+    fT = normalize((data.model * vec4(vTangent, 0.0)).xyz);
+    fB = normalize((data.model * vec4(cross(vNormal, vTangent) * bitangentSign, 0.0)).xyz);
+
+    gl_Position = vPos;
+
+    drawID = gl_DrawID;
+}
@@ -3,6 +3,7 @@
 #include "phong.glsl"
 #include "pbr.glsl"
 #include "shadow.glsl"
+#include "lightclusters.glsl"
 
 layout(location = 0) in vec4 fPos;
 layout(location = 1) in vec2 fUv;
@@ -56,15 +57,35 @@ layout(binding = 15, std140) buffer ShadowSpotLightsData
     PBRSpotLight lights[];
 } spotLightsShadow;
 
-layout(binding = 16, std140) buffer DirectionalLightTransforms
+layout(binding = 16, std140) buffer DirectionalShadowData
 {
-    mat4 transforms[];
-} dirLightTransforms;
+    ShadowDirectionalData lights[];
+} dirShadowData;
 
-layout(binding = 17, std140) buffer SpotLightTransforms
+layout(binding = 17, std140) buffer SpotShadowData
 {
-    mat4 transforms[];
-} spotLightTransforms;
+    ShadowSpotData lights[];
+} spotShadowData;
+
+layout(binding = 18, std140) buffer LightClusterInfoData
+{
+    LightClusterInfo info;
+} lightClusterInfo;
+
+layout(binding = 19, std430) buffer LightClustersData
+{
+    uvec2 clusters[];
+} lightClusters;
+
+layout(binding = 20, std430) buffer LightIndicesData
+{
+    uint indices[];
+} lightIndices;
+
+layout(binding = 21, std140) buffer PointShadowData
+{
+    ShadowPointData lights[];
+} pointShadowData;
 
 void main() {
     float gDepth = texture(gBufferDepth, fUv).r;
@@ -91,61 +112,73 @@ void main() {
 
     vec3 reflectance = vec3(0);
 
-    for (int i = 0; i < pointLights.lights.length(); i++) {
-        PBRPointLight light = pointLights.lights[i];
-        reflectance = pbr_point(pass, reflectance, light, 1);
-    }
-
     for (int i = 0; i < directionalLights.lights.length(); i++) {
         PBRDirectionalLight light = directionalLights.lights[i];
         reflectance = pbr_directional(pass, reflectance, light, 1);
     }
 
-    for (int i = 0; i < spotLights.lights.length(); i++) {
-        PBRSpotLight light = spotLights.lights[i];
-        reflectance = pbr_spot(pass, reflectance, light, 1);
-    }
+    bool sampleShadows = receiveShadows != 0 && globs.enableShadows.x != 0;
 
-    if (receiveShadows == 0 || globs.enableShadows.x == 0){
-        for (int i = 0; i < pointLightsShadow.lights.length(); i++) {
-            PBRPointLight light = pointLightsShadow.lights[i];
-            reflectance = pbr_point(pass, reflectance, light, 1);
-        }
+    if (sampleShadows) {
+        float viewDepth = -(lightClusterInfo.info.view * vec4(fPos, 1)).z;
         for (int i = 0; i < directionalLightsShadow.lights.length(); i++) {
             PBRDirectionalLight light = directionalLightsShadow.lights[i];
-            reflectance = pbr_directional(pass, reflectance, light, 1);
-        }
-        for (int i = 0; i < spotLightsShadow.lights.length(); i++) {
-            PBRSpotLight light = spotLightsShadow.lights[i];
-            reflectance = pbr_spot(pass, reflectance, light, 1);
+            float shadow = 1;
+            if (i < dirShadowData.lights.length()) {
+                ShadowDirectionalData data = dirShadowData.lights[i];
+                int cascade = getShadowCascade(data, viewDepth);
+                vec4 fragPosLightSpace = data.transforms[cascade] * vec4(fPos, 1);
+                shadow = sampleShadowDirectional(fragPosLightSpace,
+                                                 dirLightShadowMaps,
+                                                 data.layers[cascade],
+                                                 fNorm,
+                                                 vec3(0),
+                                                 fPos);
+            }
+            reflectance = pbr_directional(pass, reflectance, light, shadow);
         }
     } else {
-        for (int i = 0; i < pointLightsShadow.lights.length(); i++) {
-            PBRPointLight light = pointLightsShadow.lights[i];
-            float shadow = sampleShadow(fPos, light.position.xyz, globs.viewPosition.xyz, pointLightShadowMaps, i, light.farPlane.x);
-            reflectance = pbr_point(pass, reflectance, light, shadow);
-        }
-
         for (int i = 0; i < directionalLightsShadow.lights.length(); i++) {
             PBRDirectionalLight light = directionalLightsShadow.lights[i];
-            vec4 fragPosLightSpace = dirLightTransforms.transforms[i] * vec4(fPos, 1);
-            float shadow = sampleShadowDirectional(fragPosLightSpace,
-                                                    dirLightShadowMaps,
-                                                    i,
-                                                    fNorm,
-                                                    vec3(0),
-                                                    fPos);
-            reflectance = pbr_directional(pass, reflectance, light, shadow);
+            reflectance = pbr_directional(pass, reflectance, light, 1);
         }
-        for (int i = 0; i < spotLightsShadow.lights.length(); i++) {
-            PBRSpotLight light = spotLightsShadow.lights[i];
-            vec4 fragPosLightSpace = spotLightTransforms.transforms[i] * vec4(fPos, 1);
-            float shadow = sampleShadowDirectional(fragPosLightSpace,
-                                                    spotLightShadowMaps,
-                                                    i,
-                                                    fNorm,
-                                                    light.position.xyz,
-                                                    fPos);
+    }
+
+    // Point and spot lights are only evaluated for the lights binned into the cluster of the fragment
+    uvec2 cluster = lightClusters.clusters[getLightCluster(lightClusterInfo.info, fPos, gl_FragCoord.xy)];
+    for (uint i = 0; i < cluster.y; i++) {
+        uint lightIndex = lightIndices.indices[cluster.x + i];
+        uint type = getLightType(lightIndex);
+        int index = getLightIndex(lightIndex);
+        if (type == LIGHT_POINT) {
+            reflectance = pbr_point(pass, reflectance, pointLights.lights[index], 1);
+        } else if (type == LIGHT_SPOT) {
+            reflectance = pbr_spot(pass, reflectance, spotLights.lights[index], 1);
+        } else if (type == LIGHT_POINT_SHADOW) {
+            PBRPointLight light = pointLightsShadow.lights[index];
+            float shadow = 1;
+            if (sampleShadows && index < pointShadowData.lights.length()) {
+                shadow = sampleShadow(fPos,
+                                      light.position.xyz,
+                                      globs.viewPosition.xyz,
+                                      pointLightShadowMaps,
+                                      pointShadowData.lights[index].layer.x,
+                                      light.farPlane.x);
+            }
+            reflectance = pbr_point(pass, reflectance, light, shadow);
+        } else {
+            PBRSpotLight light = spotLightsShadow.lights[index];
+            float shadow = 1;
+            if (sampleShadows && index < spotShadowData.lights.length()) {
+                ShadowSpotData data = spotShadowData.lights[index];
+                vec4 fragPosLightSpace = data.transform * vec4(fPos, 1);
+                shadow = sampleShadowDirectional(fragPosLightSpace,
+                                                 spotLightShadowMaps,
+                                                 data.layer.x,
+                                                 fNorm,
+                                                 light.position.xyz,
+                                                 fPos);
+            }
             reflectance = pbr_spot(pass, reflectance, light, shadow);
         }
     }
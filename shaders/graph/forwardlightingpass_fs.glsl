@@ -3,6 +3,8 @@
 #include "texfilter.glsl"
 #include "pbr.glsl"
 #include "shadow.glsl"
+#include "lightclusters.glsl"
+#include "material.glsl"
 
 layout(location = 0) in vec3 fPos;
 layout(location = 1) in vec3 fNorm;
@@ -20,30 +22,11 @@ layout(location = 9) in vec3 fPosLightSpace;
 
 layout(location = 0) out vec4 oColor;
 
-struct ShaderAtlasTexture {
-    ivec4 level_index_filtering_assigned;
-    vec4 atlasScale_texSize;
-};
-
 struct ShaderDrawData {
     mat4 model;
     mat4 mvp;
 
-    ivec4 objectID_shadows;
-
-    vec4 metallic_roughness_ambientOcclusion;
-
-    vec4 albedoColor;
-
-    vec4 normalIntensity;
-
-    ShaderAtlasTexture normal;
-
-    ShaderAtlasTexture metallic;
-    ShaderAtlasTexture roughness;
-    ShaderAtlasTexture ambientOcclusion;
-
-    ShaderAtlasTexture albedo;
+    ivec4 objectID_shadows_material;
 };
 
 layout(binding = 0, std140) buffer ShaderViewBuffer
@@ -91,21 +74,46 @@ layout(binding = 9, std140) buffer ShadowSpotLightsData
     PBRSpotLight lights[];
 } spotLightsShadow;
 
-layout(binding = 10, std140) buffer DirectionalLightTransforms
+layout(binding = 10, std140) buffer DirectionalShadowData
 {
-    mat4 transforms[];
-} dirLightTransforms;
+    ShadowDirectionalData lights[];
+} dirShadowData;
 
-layout(binding = 11, std140) buffer SpotLightTransforms
+layout(binding = 11, std140) buffer SpotShadowData
 {
-    mat4 transforms[];
-} spotLightTransforms;
+    ShadowSpotData lights[];
+} spotShadowData;
 
 layout(binding = 12) uniform sampler2DArray dirLightShadowMaps;
 layout(binding = 13) uniform sampler2DArray spotLightShadowMaps;
 
 layout(binding = 14) uniform sampler2DArray atlasTextures[12];
 
+layout(binding = 26, std140) buffer LightClusterInfoData
+{
+    LightClusterInfo info;
+} lightClusterInfo;
+
+layout(binding = 27, std430) buffer LightClustersData
+{
+    uvec2 clusters[];
+} lightClusters;
+
+layout(binding = 28, std430) buffer LightIndicesData
+{
+    uint indices[];
+} lightIndices;
+
+layout(binding = 29, std140) buffer PointShadowData
+{
+    ShadowPointData lights[];
+} pointShadowData;
+
+layout(binding = 30, std140) buffer MaterialBuffer
+{
+    ShaderMaterial materials[];
+} materials;
+
 vec4 textureAtlas(ShaderAtlasTexture tex, vec2 inUv)
 {
     if (tex.level_index_filtering_assigned.w == 0)
@@ -133,16 +141,17 @@ void main() {
         return; // Cannot use discard because we want the depth values in the forward depth texture.
     }
 
-    ShaderDrawData data = shaderData.data[drawID];
+    ShaderDrawData drawData = shaderData.data[drawID];
+    ShaderMaterial material = materials.materials[drawData.objectID_shadows_material.z];
 
-    mat3 normalMatrix = transpose(inverse(mat3(data.model)));
+    mat3 normalMatrix = transpose(inverse(mat3(drawData.model)));
     vec3 normal = normalize(normalMatrix * fNorm);
     vec3 tangent = normalize(normalMatrix * fTan);
 
-    if (data.normal.level_index_filtering_assigned.w != 0)
+    if (material.normal.level_index_filtering_assigned.w != 0)
     {
         mat3x3 tbn = mat3(fT, fB, fN);
-        vec3 texNormal = textureAtlas(data.normal, fUv).xyz * vec3(data.normalIntensity.x, data.normalIntensity.x, 1);
+        vec3 texNormal = textureAtlas(material.normal, fUv).xyz * vec3(material.normalIntensity.x, material.normalIntensity.x, 1);
         texNormal = tbn * normalize(texNormal * 2.0 - 1.0);
         normal = normalize(texNormal);
     }
@@ -152,31 +161,31 @@ void main() {
     float metallic;
     float ao;
 
-    if (data.albedo.level_index_filtering_assigned.w  != 0){
-        albedo = textureAtlas(data.albedo, fUv);
+    if (material.albedo.level_index_filtering_assigned.w  != 0){
+        albedo = textureAtlas(material.albedo, fUv);
     } else {
-        albedo = data.albedoColor;
+        albedo = material.albedoColor;
     }
 
-    if (data.roughness.level_index_filtering_assigned.w != 0){
-        roughness = textureAtlas(data.roughness, fUv).x;
+    if (material.roughness.level_index_filtering_assigned.w != 0){
+        roughness = textureAtlas(material.roughness, fUv).x;
     } else {
-        roughness = data.metallic_roughness_ambientOcclusion.y;
+        roughness = material.metallic_roughness_ambientOcclusion.y;
     }
 
-    if (data.metallic.level_index_filtering_assigned.w != 0){
-        metallic = textureAtlas(data.metallic, fUv).x;
+    if (material.metallic.level_index_filtering_assigned.w != 0){
+        metallic = textureAtlas(material.metallic, fUv).x;
     } else {
-        metallic = data.metallic_roughness_ambientOcclusion.x;
+        metallic = material.metallic_roughness_ambientOcclusion.x;
     }
 
-    if (data.ambientOcclusion.level_index_filtering_assigned.w != 0){
-        ao = textureAtlas(data.ambientOcclusion, fUv).x;
+    if (material.ambientOcclusion.level_index_filtering_assigned.w != 0){
+        ao = textureAtlas(material.ambientOcclusion, fUv).x;
     } else {
-        ao = data.metallic_roughness_ambientOcclusion.z;
+        ao = material.metallic_roughness_ambientOcclusion.z;
     }
 
-    int shadows = data.objectID_shadows.y;
+    int shadows = drawData.objectID_shadows_material.y;
 
     PbrPass pass = pbr_begin(fPos,
     normal,
@@ -188,61 +197,71 @@ void main() {
 
     vec3 reflectance = vec3(0);
 
-    for (int i = 0; i < pointLights.lights.length(); i++) {
-        PBRPointLight light = pointLights.lights[i];
-        reflectance = pbr_point(pass, reflectance, light, 1);
-    }
-
     for (int i = 0; i < directionalLights.lights.length(); i++) {
         PBRDirectionalLight light = directionalLights.lights[i];
         reflectance = pbr_directional(pass, reflectance, light, 1);
     }
 
-    for (int i = 0; i < spotLights.lights.length(); i++) {
-        PBRSpotLight light = spotLights.lights[i];
-        reflectance = pbr_spot(pass, reflectance, light, 1);
-    }
-
     if (shadows == 0){
-        for (int i = 0; i < pointLightsShadow.lights.length(); i++) {
-            PBRPointLight light = pointLightsShadow.lights[i];
-            reflectance = pbr_point(pass, reflectance, light, 1);
-        }
         for (int i = 0; i < directionalLightsShadow.lights.length(); i++) {
             PBRDirectionalLight light = directionalLightsShadow.lights[i];
             reflectance = pbr_directional(pass, reflectance, light, 1);
         }
-        for (int i = 0; i < spotLightsShadow.lights.length(); i++) {
-            PBRSpotLight light = spotLightsShadow.lights[i];
-            reflectance = pbr_spot(pass, reflectance, light, 1);
-        }
     } else {
-        for (int i = 0; i < pointLightsShadow.lights.length(); i++) {
-            PBRPointLight light = pointLightsShadow.lights[i];
-            float shadow = sampleShadow(fPos, light.position.xyz, globs.viewPosition.xyz, pointLightShadowMaps, i, light.farPlane.x);
-            reflectance = pbr_point(pass, reflectance, light, shadow);
-        }
-
+        float viewDepth = -(lightClusterInfo.info.view * vec4(fPos, 1)).z;
         for (int i = 0; i < directionalLightsShadow.lights.length(); i++) {
             PBRDirectionalLight light = directionalLightsShadow.lights[i];
-            vec4 fragPosLightSpace = dirLightTransforms.transforms[i] * vec4(fPos, 1);
-            float shadow = sampleShadowDirectional(fragPosLightSpace,
-            dirLightShadowMaps,
-            i,
-            fNorm,
-            vec3(0),
-            fPos);
+            float shadow = 1;
+            if (i < dirShadowData.lights.length()) {
+                ShadowDirectionalData data = dirShadowData.lights[i];
+                int cascade = getShadowCascade(data, viewDepth);
+                vec4 fragPosLightSpace = data.transforms[cascade] * vec4(fPos, 1);
+                shadow = sampleShadowDirectional(fragPosLightSpace,
+                dirLightShadowMaps,
+                data.layers[cascade],
+                fNorm,
+                vec3(0),
+                fPos);
+            }
             reflectance = pbr_directional(pass, reflectance, light, shadow);
         }
-        for (int i = 0; i < spotLightsShadow.lights.length(); i++) {
-            PBRSpotLight light = spotLightsShadow.lights[i];
-            vec4 fragPosLightSpace = spotLightTransforms.transforms[i] * vec4(fPos, 1);
-            float shadow = sampleShadowDirectional(fragPosLightSpace,
-            spotLightShadowMaps,
-            i,
-            fNorm,
-            light.position.xyz,
-            fPos);
+    }
+
+    // Point and spot lights are only evaluated for the lights binned into the cluster of the fragment
+    uvec2 cluster = lightClusters.clusters[getLightCluster(lightClusterInfo.info, fPos, gl_FragCoord.xy)];
+    for (uint i = 0; i < cluster.y; i++) {
+        uint lightIndex = lightIndices.indices[cluster.x + i];
+        uint type = getLightType(lightIndex);
+        int index = getLightIndex(lightIndex);
+        if (type == LIGHT_POINT) {
+            reflectance = pbr_point(pass, reflectance, pointLights.lights[index], 1);
+        } else if (type == LIGHT_SPOT) {
+            reflectance = pbr_spot(pass, reflectance, spotLights.lights[index], 1);
+        } else if (type == LIGHT_POINT_SHADOW) {
+            PBRPointLight light = pointLightsShadow.lights[index];
+            float shadow = 1;
+            if (shadows != 0 && index < pointShadowData.lights.length()) {
+                shadow = sampleShadow(fPos,
+                light.position.xyz,
+                globs.viewPosition.xyz,
+                pointLightShadowMaps,
+                pointShadowData.lights[index].layer.x,
+                light.farPlane.x);
+            }
+            reflectance = pbr_point(pass, reflectance, light, shadow);
+        } else {
+            PBRSpotLight light = spotLightsShadow.lights[index];
+            float shadow = 1;
+            if (shadows != 0 && index < spotShadowData.lights.length()) {
+                ShadowSpotData data = spotShadowData.lights[index];
+                vec4 fragPosLightSpace = data.transform * vec4(fPos, 1);
+                shadow = sampleShadowDirectional(fragPosLightSpace,
+                spotLightShadowMaps,
+                data.layer.x,
+                fNorm,
+                light.position.xyz,
+                fPos);
+            }
             reflectance = pbr_spot(pass, reflectance, light, shadow);
         }
     }
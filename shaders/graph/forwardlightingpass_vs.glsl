@@ -21,30 +21,11 @@ layout(location = 6) out vec3 fB;
 layout(location = 7) out vec3 fN;
 layout(location = 8) flat out uint drawID;
 
-struct ShaderAtlasTexture {
-    ivec4 level_index_filtering_assigned;
-    vec4 atlasScale_texSize;
-};
-
 struct ShaderDrawData {
     mat4 model;
     mat4 mvp;
 
-    ivec4 objectID_shadows;
-
-    vec4 metallic_roughness_ambientOcclusion;
-
-    vec4 albedoColor;
-
-    vec4 normalIntensity;
-
-    ShaderAtlasTexture normal;
-
-    ShaderAtlasTexture metallic;
-    ShaderAtlasTexture roughness;
-    ShaderAtlasTexture ambientOcclusion;
-
-    ShaderAtlasTexture albedo;
+    ivec4 objectID_shadows_material;
 };
 
 layout(binding = 0, std140) buffer ShaderViewBuffer
@@ -0,0 +1,16 @@
+#version 460
+
+layout(location = 0) in vec2 fUv;
+layout(location = 1) in vec4 fColor;
+
+layout(location = 0) out vec4 oColor;
+
+void main() {
+    // Round particles with a soft edge
+    float d = length(fUv * 2 - 1);
+    float alpha = fColor.a * (1 - smoothstep(0.5, 1, d));
+    if (alpha <= 0) {
+        discard;
+    }
+    oColor = vec4(fColor.rgb, alpha);
+}
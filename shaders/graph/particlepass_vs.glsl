@@ -0,0 +1,40 @@
+#version 460
+
+layout (location = 0) in vec3 vPosition;
+layout (location = 1) in vec2 vUv;
+
+layout(location = 0) out vec2 fUv;
+layout(location = 1) out vec4 fColor;
+
+struct ParticleInstance {
+    vec4 positionSize;
+    vec4 color;
+};
+
+layout(binding = 0, std140) buffer ParticleBuffer
+{
+    ParticleInstance instances[];
+} particles;
+
+layout(binding = 1, std140) buffer ShaderUniformBuffer
+{
+    mat4 viewProjection;
+    vec4 cameraRight;
+    vec4 cameraUp;
+} globs;
+
+void main()
+{
+    ParticleInstance instance = particles.instances[gl_InstanceID];
+
+    // Expand the unit quad into a camera facing billboard
+    float halfSize = instance.positionSize.w * 0.5;
+    vec3 worldPos = instance.positionSize.xyz
+                    + globs.cameraRight.xyz * vPosition.x * halfSize
+                    + globs.cameraUp.xyz * vPosition.y * halfSize;
+
+    fUv = vUv;
+    fColor = instance.color;
+
+    gl_Position = globs.viewProjection * vec4(worldPos, 1);
+}
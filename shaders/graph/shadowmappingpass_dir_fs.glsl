@@ -3,6 +3,8 @@
 struct DrawData {
     ivec4 boneOffset;
     mat4 model;
+    vec4 positionOffset;
+    vec4 positionScale;
 };
 
 layout(binding = 0, std140) buffer DrawDataBuffer
@@ -10,10 +12,16 @@ layout(binding = 0, std140) buffer DrawDataBuffer
     DrawData data[];
 } drawData;
 
-layout(binding = 1, std140) buffer BoneBuffer
+layout(binding = 1, std430) buffer BonePaletteData
 {
-    mat4 matrices[];
-} bones;
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 3, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
 
 layout(binding = 2, std140) buffer DirLightDataBuffer
 {
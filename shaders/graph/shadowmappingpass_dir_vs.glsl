@@ -11,6 +11,8 @@ layout (location = 6) in vec4 boneWeights;
 struct DrawData {
     ivec4 boneOffset;
     mat4 model;
+    vec4 positionOffset;
+    vec4 positionScale;
 };
 
 layout(binding = 0, std140) buffer DrawDataBuffer
@@ -18,10 +20,16 @@ layout(binding = 0, std140) buffer DrawDataBuffer
     DrawData data[];
 } drawData;
 
-layout(binding = 1, std140) buffer BoneBuffer
+layout(binding = 1, std430) buffer BonePaletteData
 {
-    mat4 matrices[];
-} bones;
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 3, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
 
 layout(binding = 2, std140) buffer DirLightDataBuffer
 {
@@ -29,58 +37,9 @@ layout(binding = 2, std140) buffer DirLightDataBuffer
     mat4 shadowMatrix;
 } lightData;
 
-vec4 getSkinnedVertexPosition(int offset) {
-    if (offset < 0) {
-        return vec4(vPosition, 1.0f);
-    }
-
-    int boneCount = bones.matrices.length();
-
-    vec4 totalPosition = vec4(0, 0, 0, 0);
-    if (boneIds.x > -1)
-    {
-        if (boneIds.x + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.x + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.x;
-        }
-    }
-
-    if (boneIds.y > -1)
-    {
-        if (boneIds.y + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.y + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.y;
-        }
-    }
-
-    if (boneIds.z > -1)
-    {
-        if (boneIds.z + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.z + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.z;
-        }
-    }
-
-    if (boneIds.w > -1)
-    {
-        if (boneIds.w + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.w + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.w;
-        }
-    }
-
-    return totalPosition;
-}
+#include "skinning.glsl"
 
 void main()
 {
-    gl_Position = lightData.shadowMatrix * drawData.data[gl_DrawID].model * getSkinnedVertexPosition(drawData.data[gl_DrawID].boneOffset.x);
+    gl_Position = lightData.shadowMatrix * drawData.data[gl_DrawID].model * vec4(getSkinnedPosition(vPosition, boneIds, boneWeights, drawData.data[gl_DrawID].boneOffset.x), 1.0f);
 }
\ No newline at end of file
@@ -0,0 +1,50 @@
+#version 460
+
+#include "vertexcompression.glsl"
+
+layout (location = 0) in vec4 vPositionBitangentSign;
+layout (location = 1) in vec4 vNormalTangent;
+layout (location = 2) in vec2 vUv;
+layout (location = 3) in ivec4 boneIds;
+layout (location = 4) in vec4 boneWeights;
+
+struct DrawData {
+    ivec4 boneOffset;
+    mat4 model;
+    vec4 positionOffset;
+    vec4 positionScale;
+};
+
+layout(binding = 0, std140) buffer DrawDataBuffer
+{
+    DrawData data[];
+} drawData;
+
+layout(binding = 1, std430) buffer BonePaletteData
+{
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 3, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
+
+layout(binding = 2, std140) buffer PointLightDataBuffer
+{
+    vec4 lightPosFarPlane;
+    ivec4 layer;
+    mat4 shadowMatrices[6];
+} lightData;
+
+vec3 vPosition;
+
+#include "skinning.glsl"
+
+void main()
+{
+    DrawData data = drawData.data[gl_DrawID];
+    vPosition = decodePosition(vPositionBitangentSign.xyz, data.positionOffset, data.positionScale);
+    gl_Position = data.model * vec4(getSkinnedPosition(vPosition, boneIds, boneWeights, data.boneOffset.x), 1.0f);
+}
\ No newline at end of file
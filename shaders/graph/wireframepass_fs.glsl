@@ -24,10 +24,16 @@ layout(binding = 0, std140) buffer ShaderUniformBuffer
     ShaderDrawData data[];
 } globs;
 
-layout(binding = 1, std140) buffer BoneBuffer
+layout(binding = 1, std430) buffer BonePaletteData
 {
-    mat4 matrices[];
-} bones;
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
+
+layout(binding = 2, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
 
 void main() {
     oColor = globs.data[drawID].wireColor;
@@ -30,67 +30,24 @@ layout(binding = 0, std140) buffer ShaderUniformBuffer
     ShaderDrawData data[];
 } globs;
 
-layout(binding = 1, std140) buffer BoneBuffer
+layout(binding = 1, std430) buffer BonePaletteData
 {
-    mat4 matrices[];
-} bones;
+    ivec4 format;
+    vec4 data[];
+} bonePalette;
 
-vec4 getSkinnedVertexPosition(int offset) {
-    if (offset < 0) {
-        return vec4(vPosition, 1.0f);
-    }
-
-    int boneCount = bones.matrices.length();
-
-    vec4 totalPosition = vec4(0, 0, 0, 0);
-    if (boneIds.x > -1)
-    {
-        if (boneIds.x + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.x + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.x;
-        }
-    }
-
-    if (boneIds.y > -1)
-    {
-        if (boneIds.y + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.y + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.y;
-        }
-    }
-
-    if (boneIds.z > -1)
-    {
-        if (boneIds.z + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.z + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.z;
-        }
-    }
-
-    if (boneIds.w > -1)
-    {
-        if (boneIds.w + offset >= boneCount) {
-            return vec4(vPosition, 1.0f);
-        } else {
-            vec4 localPosition = bones.matrices[boneIds.w + offset] * vec4(vPosition, 1.0f);
-            totalPosition += localPosition * boneWeights.w;
-        }
-    }
+layout(binding = 2, std430) buffer BoneIndexData
+{
+    uint indices[];
+} boneIndices;
 
-    return totalPosition;
-}
+#include "skinning.glsl"
 
 void main()
 {
     ShaderDrawData data = globs.data[gl_DrawID];
 
-    vec4 pos = getSkinnedVertexPosition(data.objectID_boneOffset.y);
+    vec4 pos = vec4(getSkinnedPosition(vPosition, boneIds, boneWeights, data.objectID_boneOffset.y), 1.0f);
 
     vPos = data.mvp * pos;
     fPos = (data.model * pos).xyz;
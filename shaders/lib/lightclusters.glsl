@@ -0,0 +1,35 @@
+// Clustered light culling, the light lists are built on the cpu by LightClusterGrid
+
+#define LIGHT_POINT 0u
+#define LIGHT_POINT_SHADOW 1u
+#define LIGHT_SPOT 2u
+#define LIGHT_SPOT_SHADOW 3u
+
+#define LIGHT_TYPE_SHIFT 30u
+#define LIGHT_INDEX_MASK 0x3FFFFFFFu
+
+struct LightClusterInfo {
+    mat4 view;
+    vec4 viewportSize_depthScale_depthBias;
+    ivec4 gridSize;
+};
+
+// Returns the index of the cluster containing the fragment, matches LightClusterGrid::getClusterIndex
+int getLightCluster(LightClusterInfo info, vec3 worldPos, vec2 fragCoord) {
+    float depth = max(-(info.view * vec4(worldPos, 1)).z, 1e-30);
+    int slice = int(floor(log(depth) * info.viewportSize_depthScale_depthBias.z - info.viewportSize_depthScale_depthBias.w));
+    ivec2 tile = ivec2(floor(fragCoord / info.viewportSize_depthScale_depthBias.xy * vec2(info.gridSize.xy)));
+
+    slice = clamp(slice, 0, info.gridSize.z - 1);
+    tile = clamp(tile, ivec2(0), info.gridSize.xy - 1);
+
+    return slice * info.gridSize.x * info.gridSize.y + tile.y * info.gridSize.x + tile.x;
+}
+
+uint getLightType(uint lightIndex) {
+    return lightIndex >> LIGHT_TYPE_SHIFT;
+}
+
+int getLightIndex(uint lightIndex) {
+    return int(lightIndex & LIGHT_INDEX_MASK);
+}
@@ -0,0 +1,20 @@
+// The resolved materials written by MaterialTable, draw data references the materials by index
+
+struct ShaderAtlasTexture {
+    ivec4 level_index_filtering_assigned;
+    vec4 atlasScale_texSize;
+};
+
+struct ShaderMaterial {
+    vec4 metallic_roughness_ambientOcclusion;
+    vec4 albedoColor;
+
+    vec4 normalIntensity;
+
+    ShaderAtlasTexture normal;
+
+    ShaderAtlasTexture metallic;
+    ShaderAtlasTexture roughness;
+    ShaderAtlasTexture ambientOcclusion;
+    ShaderAtlasTexture albedo;
+};
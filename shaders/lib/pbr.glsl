@@ -4,6 +4,7 @@
 
 #include "pi.glsl"
 
+// farPlane.x = shadow far plane, farPlane.y = light radius or 0 if the light is unbounded
 struct PBRPointLight {
     vec4 position;
     vec4 color;
@@ -24,6 +25,18 @@ struct PBRSpotLight {
     vec4 cutOff_outerCutOff_constant_linear;
 };
 
+// ----------------------------------------------------------------------------
+// Fades the light to zero at the light radius so that there is no visible edge at the light cluster bounds
+float lightRadiusWindow(float distance, float radius)
+{
+    if (radius <= 0.0) {
+        return 1.0;
+    }
+    float ratio = distance / radius;
+    float ratio2 = ratio * ratio;
+    float window = clamp(1.0 - ratio2 * ratio2, 0.0, 1.0);
+    return window * window;
+}
 // ----------------------------------------------------------------------------
 float DistributionGGX(vec3 N, vec3 H, float roughness)
 {
@@ -135,7 +148,7 @@ vec3 pbr_point(PbrPass pass, vec3 Lo, PBRPointLight light, float shadow) {
     vec3 L = normalize(lightPosition - WorldPos);
     vec3 H = normalize(V + L);
     float distance = length(lightPosition - WorldPos);
-    float attenuation = 1.0 / (distance * distance);
+    float attenuation = lightRadiusWindow(distance, light.farPlane.y) / (distance * distance);
     vec3 radiance = lightColor * attenuation;
 
     // Cook-Torrance BRDF
@@ -247,7 +260,7 @@ vec3 pbr_spot(PbrPass pass, vec3 Lo, PBRSpotLight light, float shadow) {
     vec3 L = normalize(lightPosition - WorldPos);
     vec3 H = normalize(V + L);
     float distance = length(lightPosition - WorldPos);
-    float attenuation = 1.0 / (light.cutOff_outerCutOff_constant_linear.z + light.cutOff_outerCutOff_constant_linear.w * distance + light.direction_quadratic.w * (distance * distance));
+    float attenuation = lightRadiusWindow(distance, light.farPlane.y) / (light.cutOff_outerCutOff_constant_linear.z + light.cutOff_outerCutOff_constant_linear.w * distance + light.direction_quadratic.w * (distance * distance));
 
     vec3 radiance = lightColor * attenuation * intensity;
 
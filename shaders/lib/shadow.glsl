@@ -106,4 +106,28 @@ float sampleShadowDirectional(vec4 fragPosLightSpace,
     shadow = 0.0;
 
     return 1 - shadow;
-}
\ No newline at end of file
+}
+// The layers and transforms written by the shadow mapping pass to the SLOT_SHADOW_MAP_*_DATA buffers
+struct ShadowPointData {
+    ivec4 layer;
+};
+
+struct ShadowDirectionalData {
+    ivec4 layers; // The shadow map layer of each cascade
+    vec4 cascadeSplits; // The view space depth at which each cascade ends
+    ivec4 cascadeCount;
+    mat4 transforms[4];
+};
+
+struct ShadowSpotData {
+    ivec4 layer;
+    mat4 transform;
+};
+
+int getShadowCascade(ShadowDirectionalData data, float viewDepth) {
+    for (int i = 0; i < data.cascadeCount.x - 1; i++) {
+        if (viewDepth < data.cascadeSplits[i])
+        return i;
+    }
+    return max(data.cascadeCount.x - 1, 0);
+}
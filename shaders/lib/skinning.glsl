@@ -0,0 +1,97 @@
+// Skinning with the shared bone palette of FrameGraphBonePalette
+//
+// The including shader has to declare the palette and the bone index buffer of the pass before including this file:
+//
+// layout(binding = X, std430) buffer BonePaletteData
+// {
+//     ivec4 format; // .x = BonePalette::Format
+//     vec4 data[];
+// } bonePalette;
+//
+// layout(binding = Y, std430) buffer BoneIndexData
+// {
+//     uint indices[]; // The palette index of each mesh local bone, starting at the bone offset of the draw
+// } boneIndices;
+
+#define BONE_PALETTE_MATRIX_3X4 0
+#define BONE_PALETTE_DUAL_QUATERNION 1
+
+// Returns the position transformed by the weighted bones or the unmodified position if the mesh is not skinned.
+vec3 getSkinnedPosition(vec3 position, ivec4 boneIds, vec4 boneWeights, int offset) {
+    if (offset < 0) {
+        return position;
+    }
+
+    int indexCount = boneIndices.indices.length();
+    int paletteSize = bonePalette.data.length();
+
+    ivec4 paletteIndices = ivec4(-1);
+    for (int i = 0; i < 4; i++) {
+        if (boneIds[i] > -1) {
+            if (boneIds[i] + offset >= indexCount) {
+                return position;
+            }
+            paletteIndices[i] = int(boneIndices.indices[boneIds[i] + offset]);
+        }
+    }
+
+    if (bonePalette.format.x == BONE_PALETTE_DUAL_QUATERNION) {
+        vec4 real = vec4(0);
+        vec4 dual = vec4(0);
+        vec4 pivot = vec4(0);
+        for (int i = 0; i < 4; i++) {
+            if (paletteIndices[i] < 0) {
+                continue;
+            }
+            int base = paletteIndices[i] * 2;
+            if (base + 1 >= paletteSize) {
+                return position;
+            }
+            vec4 r = bonePalette.data[base];
+            vec4 d = bonePalette.data[base + 1];
+            if (pivot == vec4(0)) {
+                pivot = r;
+            }
+            // q and -q represent the same rotation, blend along the shortest path
+            float weight = dot(r, pivot) < 0 ? -boneWeights[i] : boneWeights[i];
+            real += r * weight;
+            dual += d * weight;
+        }
+
+        float len = length(real);
+        if (len <= 0) {
+            return position;
+        }
+        real /= len;
+        dual /= len;
+
+        vec3 rotated = position + 2.0 * cross(real.xyz, cross(real.xyz, position) + real.w * position);
+        vec3 translation = 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+        return rotated + translation;
+    } else {
+        vec4 row0 = vec4(0);
+        vec4 row1 = vec4(0);
+        vec4 row2 = vec4(0);
+        float totalWeight = 0;
+        for (int i = 0; i < 4; i++) {
+            if (paletteIndices[i] < 0) {
+                continue;
+            }
+            int base = paletteIndices[i] * 3;
+            if (base + 2 >= paletteSize) {
+                return position;
+            }
+            row0 += bonePalette.data[base] * boneWeights[i];
+            row1 += bonePalette.data[base + 1] * boneWeights[i];
+            row2 += bonePalette.data[base + 2] * boneWeights[i];
+            totalWeight += boneWeights[i];
+        }
+
+        if (totalWeight <= 0) {
+            return position;
+        }
+
+        vec4 p = vec4(position, 1.0);
+        return vec3(dot(row0, p), dot(row1, p), dot(row2, p));
+    }
+}
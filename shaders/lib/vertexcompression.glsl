@@ -0,0 +1,14 @@
+// Decoding of the quantized attributes of Mesh::getCompactVertexLayout and SkinnedMesh::getCompactVertexLayout
+
+// https://knarkowicz.wordpress.com/2014/04/16/octahedron-normal-vector-encoding/
+vec3 decodeOctahedral(vec2 value) {
+    vec3 ret = vec3(value.x, value.y, 1.0 - abs(value.x) - abs(value.y));
+    float t = max(-ret.z, 0.0);
+    ret.x += ret.x >= 0.0 ? -t : t;
+    ret.y += ret.y >= 0.0 ? -t : t;
+    return normalize(ret);
+}
+
+vec3 decodePosition(vec3 quantizedPosition, vec4 positionOffset, vec4 positionScale) {
+    return positionOffset.xyz + quantizedPosition * positionScale.xyz;
+}
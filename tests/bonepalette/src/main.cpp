@@ -0,0 +1,342 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+static bool equals(const Mat4f &a, const Mat4f &b, float epsilon = 1e-4f) {
+    for (auto i = 0; i < Mat4f::size(); i++) {
+        if (std::abs(a.data[i] - b.data[i]) > epsilon) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool equals(const Vec3f &a, const Vec3f &b, float epsilon = 1e-4f) {
+    return std::abs(a.x - b.x) <= epsilon && std::abs(a.y - b.y) <= epsilon && std::abs(a.z - b.z) <= epsilon;
+}
+
+static Mat4f getRigidTransform(Vec3f axis, float angle, Vec3f translation) {
+    axis = axis / axis.magnitude();
+    auto s = std::sin(angle / 2);
+    return MatrixMath::translate(translation)
+           * Quaternion(std::cos(angle / 2), axis.x * s, axis.y * s, axis.z * s).matrix();
+}
+
+static Vec3f transformPoint(const Mat4f &transform, const Vec3f &point) {
+    auto ret = transform * Vec4f(point.x, point.y, point.z, 1);
+    return {ret.x, ret.y, ret.z};
+}
+
+static Vec3f cross(const Vec3f &a, const Vec3f &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// Mirrors getSkinnedPosition in skinning.glsl
+static Vec3f skin(const std::vector<float> &data,
+                  BonePalette::Format format,
+                  const std::vector<uint32_t> &indices,
+                  const std::vector<float> &weights,
+                  const Vec3f &position) {
+    auto stride = BonePalette::getStride(format) * 4;
+    if (format == BonePalette::MATRIX_3X4) {
+        float rows[12]{};
+        for (auto i = 0; i < indices.size(); i++) {
+            for (auto v = 0; v < 12; v++) {
+                rows[v] += data.at(indices.at(i) * stride + v) * weights.at(i);
+            }
+        }
+        return {rows[0] * position.x + rows[1] * position.y + rows[2] * position.z + rows[3],
+                rows[4] * position.x + rows[5] * position.y + rows[6] * position.z + rows[7],
+                rows[8] * position.x + rows[9] * position.y + rows[10] * position.z + rows[11]};
+    } else {
+        float real[4]{};
+        float dual[4]{};
+        auto *pivot = &data.at(indices.at(0) * stride);
+        for (auto i = 0; i < indices.size(); i++) {
+            auto *bone = &data.at(indices.at(i) * stride);
+            auto dot = bone[0] * pivot[0] + bone[1] * pivot[1] + bone[2] * pivot[2] + bone[3] * pivot[3];
+            auto weight = dot < 0 ? -weights.at(i) : weights.at(i);
+            for (auto v = 0; v < 4; v++) {
+                real[v] += bone[v] * weight;
+                dual[v] += bone[v + 4] * weight;
+            }
+        }
+        auto length = std::sqrt(real[0] * real[0] + real[1] * real[1] + real[2] * real[2] + real[3] * real[3]);
+        Vec3f r(real[0] / length, real[1] / length, real[2] / length);
+        auto rw = real[3] / length;
+        Vec3f d(dual[0] / length, dual[1] / length, dual[2] / length);
+        auto dw = dual[3] / length;
+
+        auto rotated = position + cross(r, cross(r, position) + position * rw) * 2.0f;
+        auto translation = (d * rw - r * dw + cross(r, d)) * 2.0f;
+        return rotated + translation;
+    }
+}
+
+static void testEncoding() {
+    std::mt19937 random(3);
+    std::uniform_real_distribution<float> value(-5, 5);
+
+    for (auto i = 0; i < 100; i++) {
+        auto transform = getRigidTransform({value(random), value(random), value(random)},
+                                           value(random),
+                                           {value(random), value(random), value(random)});
+
+        float data[12];
+        BonePalette::encode(transform, BonePalette::MATRIX_3X4, data);
+        if (!equals(BonePalette::decode(data, BonePalette::MATRIX_3X4), transform)) {
+            throw std::runtime_error("3x4 matrix round trip failed");
+        }
+
+        BonePalette::encode(transform, BonePalette::DUAL_QUATERNION, data);
+        if (!equals(BonePalette::decode(data, BonePalette::DUAL_QUATERNION), transform)) {
+            throw std::runtime_error("Dual quaternion round trip failed");
+        }
+
+        // The 3x4 format keeps the scale of the bone, dual quaternions drop it.
+        auto scaled = transform * MatrixMath::scale({2, 2, 2});
+        BonePalette::encode(scaled, BonePalette::MATRIX_3X4, data);
+        if (!equals(BonePalette::decode(data, BonePalette::MATRIX_3X4), scaled)) {
+            throw std::runtime_error("3x4 matrix does not preserve scale");
+        }
+        BonePalette::encode(scaled, BonePalette::DUAL_QUATERNION, data);
+        if (!equals(BonePalette::decode(data, BonePalette::DUAL_QUATERNION), transform)) {
+            throw std::runtime_error("Dual quaternion does not remove scale");
+        }
+    }
+}
+
+static void testBlending() {
+    BonePalette palette;
+    auto offset = palette.add({getRigidTransform({0, 0, 1}, 0, {1, 2, 3}),
+                               getRigidTransform({0, 0, 1}, 3.0f, {1, 2, 3})});
+
+    std::vector<uint32_t> indices{static_cast<uint32_t>(offset), static_cast<uint32_t>(offset + 1)};
+    std::vector<float> weights{0.5f, 0.5f};
+    Vec3f position(1, 0, 0);
+
+    auto matrices = palette.encode(BonePalette::MATRIX_3X4);
+    auto dualQuaternions = palette.encode(BonePalette::DUAL_QUATERNION);
+
+    // A single bone is applied exactly by both formats
+    for (auto i = 0; i < 2; i++) {
+        auto expected = transformPoint(palette.getTransforms().at(offset + i), position);
+        if (!equals(skin(matrices, BonePalette::MATRIX_3X4, {indices.at(i)}, {1}, position), expected)
+            || !equals(skin(dualQuaternions, BonePalette::DUAL_QUATERNION, {indices.at(i)}, {1}, position),
+                       expected)) {
+            throw std::runtime_error("Invalid single bone skinning");
+        }
+    }
+
+    // Linear blending collapses the point towards the rotation axis, dual quaternions keep the distance.
+    auto linear = skin(matrices, BonePalette::MATRIX_3X4, indices, weights, position) - Vec3f(1, 2, 3);
+    auto blended = skin(dualQuaternions, BonePalette::DUAL_QUATERNION, indices, weights, position) - Vec3f(1, 2, 3);
+
+    std::cout << "Distance to the joint after blending, 3x4 matrices " << linear.magnitude()
+              << " dual quaternions " << blended.magnitude() << "\n";
+
+    if (std::abs(blended.magnitude() - 1) > 1e-4f) {
+        throw std::runtime_error("Dual quaternion blending does not preserve the distance");
+    }
+    if (!equals(blended, transformPoint(getRigidTransform({0, 0, 1}, 1.5f, {}), position))) {
+        throw std::runtime_error("Dual quaternion blending does not interpolate the rotation");
+    }
+    if (linear.magnitude() > 0.1f) {
+        throw std::runtime_error("Unexpected linear blending result");
+    }
+}
+
+static void testPalette() {
+    BonePalette palette;
+    if (palette.size() != 1 || !equals(palette.getTransforms().at(0), MatrixMath::identity())) {
+        throw std::runtime_error("Palette does not start with the identity entry");
+    }
+
+    if (palette.add({}) != 0) {
+        throw std::runtime_error("Empty transforms must reference the identity entry");
+    }
+
+    std::vector<Mat4f> a(3, MatrixMath::translate({1, 0, 0}));
+    std::vector<Mat4f> b(2, MatrixMath::translate({0, 1, 0}));
+    auto offsetA = palette.add(a);
+    auto offsetB = palette.add(b);
+    if (offsetA != 1 || offsetB != 4 || palette.size() != 6) {
+        throw std::runtime_error("Invalid palette offsets");
+    }
+    if (!equals(palette.getTransforms().at(offsetB + 1), b.at(1))) {
+        throw std::runtime_error("Invalid palette contents");
+    }
+
+    if (palette.encode(BonePalette::MATRIX_3X4).size() != 6 * 12
+        || palette.encode(BonePalette::DUAL_QUATERNION).size() != 6 * 8) {
+        throw std::runtime_error("Invalid encoded palette size");
+    }
+
+    palette.clear();
+    if (palette.size() != 1) {
+        throw std::runtime_error("Clear must keep the identity entry");
+    }
+}
+
+static void testRigOrder() {
+    Bone root;
+    root.name = "root";
+    root.transform = MatrixMath::identity();
+    root.offset = MatrixMath::identity();
+    Bone child = root;
+    child.name = "child";
+
+    // The transforms of an animator without channels are the identity for every bone of the rig
+    RigAnimator animator(Rig({child, root}, {{"child", "root"}}));
+    if (!animator.getBoneTransforms().empty()) {
+        throw std::runtime_error("Bone transforms before the first update");
+    }
+    animator.update({});
+    if (animator.getBoneTransforms().size() != 2) {
+        throw std::runtime_error("Bone transforms are not in rig order");
+    }
+    for (auto &transform: animator.getBoneTransforms()) {
+        if (!equals(transform, MatrixMath::identity())) {
+            throw std::runtime_error("Bone transform of an idle rig is not the identity");
+        }
+    }
+}
+
+// Creates a mesh referencing the bones of the file contents, the rig contains the bones "child" and "root"
+class SkinnedMeshImporter : public ResourceImporter {
+public:
+    ResourceBundle read(std::istream &stream, const std::string &hint, const std::string &path, Archive *archive) override {
+        Bone root;
+        root.name = "root";
+        root.transform = MatrixMath::identity();
+        root.offset = MatrixMath::identity();
+        Bone child = root;
+        child.name = "child";
+
+        auto mesh = std::make_unique<SkinnedMesh>();
+        mesh->rig = Rig({child, root}, {{"child", "root"}});
+        std::string bone;
+        stream >> std::skipws;
+        while (stream >> bone) {
+            mesh->bones.emplace_back(bone);
+        }
+        mesh->subMeshes.emplace_back(); // Without bones
+
+        ResourceBundle ret;
+        ret.add("", std::move(mesh));
+        return ret;
+    }
+
+    const std::set<std::string> &getSupportedFormats() const override {
+        static const std::set<std::string> formats = {".skin"};
+        return formats;
+    }
+};
+
+static void setBones(MemoryArchive &archive, const std::string &bones) {
+    if (archive.exists("mesh.skin")) {
+        archive.removeData("mesh.skin");
+    }
+    archive.addData("mesh.skin", std::vector<uint8_t>(bones.begin(), bones.end()));
+}
+
+static std::vector<uint32_t> getBoneIndices(FrameGraphBonePalette &palette,
+                                            const Scene &scene,
+                                            const Node &node,
+                                            size_t subMesh = 0) {
+    std::vector<uint32_t> ret{42};
+    if (palette.addBoneIndices(scene, node, subMesh, ret) != 1) {
+        throw std::runtime_error("Bone indices are not appended");
+    }
+    ret.erase(ret.begin());
+    return ret;
+}
+
+static void testBoneIndices() {
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter>> importers;
+    importers.emplace_back(std::make_unique<SkinnedMeshImporter>());
+    registry.setImporters(std::move(importers));
+
+    auto &archive = registry.getArchiveT<MemoryArchive>("memory");
+    setBones(archive, "child missing root");
+
+    Scene scene;
+    Node node;
+    SkinnedMeshProperty meshProperty;
+    meshProperty.mesh = ResourceHandle<SkinnedMesh>(Uri("memory://mesh.skin"), &registry);
+    node.addProperty(meshProperty);
+    registry.awaitAll();
+
+    FrameGraphBonePalette bonePalette;
+
+    // Meshes without a BoneTransformsProperty are drawn in bind pose
+    if (getBoneIndices(bonePalette, scene, node) != std::vector<uint32_t>{0, 0, 0}) {
+        throw std::runtime_error("Bones without transforms must reference the identity entry");
+    }
+
+    std::vector<uint32_t> indices;
+    if (bonePalette.addBoneIndices(scene, node, 1, indices) != -1 || !indices.empty()) {
+        throw std::runtime_error("Sub mesh without bones must not append indices");
+    }
+
+    // Bones which are not part of the rig (NO_BONE) reference the identity entry
+    scene.bonePalette.add(std::vector<Mat4f>(3, MatrixMath::identity()));
+    BoneTransformsProperty transforms;
+    transforms.paletteOffset = scene.bonePalette.add(std::vector<Mat4f>(2, MatrixMath::identity()));
+    node.addProperty(transforms);
+    auto offset = static_cast<uint32_t>(transforms.paletteOffset);
+    if (getBoneIndices(bonePalette, scene, node) != std::vector<uint32_t>{offset, 0, offset + 1}) {
+        throw std::runtime_error("Invalid palette indices");
+    }
+
+    // Offsets past the end of the palette reference the identity entry
+    transforms.paletteOffset = scene.bonePalette.size() - 1;
+    node.addProperty(transforms);
+    auto last = static_cast<uint32_t>(scene.bonePalette.size() - 1);
+    if (getBoneIndices(bonePalette, scene, node) != std::vector<uint32_t>{last, 0, 0}) {
+        throw std::runtime_error("Out of range palette indices must reference the identity entry");
+    }
+
+    // The cached mapping is discarded when the mesh is reloaded
+    setBones(archive, "root");
+    registry.reload(Uri("memory://mesh.skin"));
+    registry.awaitAll();
+    transforms.paletteOffset = offset;
+    node.addProperty(transforms);
+    if (getBoneIndices(bonePalette, scene, node) != std::vector<uint32_t>{offset + 1}) {
+        throw std::runtime_error("Bone mapping was not updated after a reload");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testEncoding();
+    testBlending();
+    testPalette();
+    testRigOrder();
+    testBoneIndices();
+    std::cout << "Bone palette tests passed\n";
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+
+using namespace xng;
+
+static const int FRAMES = 60;
+static const int SAMPLES = 100000;
+
+static const Vec2i VIEWPORT_SIZE(1920, 1080);
+
+template<typename F>
+static void benchmark(const std::string &name, F func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; i++) {
+        func(i);
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": "
+              << static_cast<double>(duration.count()) / 1000.0 / FRAMES
+              << " ms/frame\n";
+}
+
+static std::vector<LightClusterGrid::LightBounds> createLights(size_t count, const Vec3f &cameraPosition) {
+    std::mt19937 rng(static_cast<unsigned int>(count));
+    std::uniform_real_distribution<float> xy(-100, 100);
+    std::uniform_real_distribution<float> z(-300, 10);
+    std::uniform_real_distribution<float> power(1, 50);
+
+    std::vector<LightClusterGrid::LightBounds> ret;
+    for (size_t i = 0; i < count; i++) {
+        PointLight light;
+        light.power = power(rng);
+        ret.emplace_back(LightClusterGrid::LightBounds{
+                .position = cameraPosition + Vec3f(xy(rng), xy(rng), z(rng)),
+                .radius = LightClusterGrid::getRadius(light, 1.0f / 256.0f) * 0.25f,
+                .index = LightClusterGrid::encodeLightIndex(LightClusterGrid::LIGHT_POINT, static_cast<uint32_t>(i))
+        });
+    }
+    return ret;
+}
+
+/**
+ * Check that every light affecting a sample position is contained in the light list of the cluster of the sample.
+ */
+static void verify(const LightClusterGrid &grid,
+                   const Camera &camera,
+                   const Vec3f &cameraPosition,
+                   const std::vector<LightClusterGrid::LightBounds> &lights) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> unit(0, 1);
+
+    auto tanY = std::tan(degreesToRadians(camera.fov) / 2);
+
+    size_t checked = 0;
+    for (int i = 0; i < SAMPLES; i++) {
+        Vec2f fragCoord(unit(rng) * static_cast<float>(VIEWPORT_SIZE.x),
+                        unit(rng) * static_cast<float>(VIEWPORT_SIZE.y));
+        auto depth = camera.nearClip + unit(rng) * (camera.farClip - camera.nearClip);
+
+        auto ndcX = fragCoord.x / static_cast<float>(VIEWPORT_SIZE.x) * 2 - 1;
+        auto ndcY = fragCoord.y / static_cast<float>(VIEWPORT_SIZE.y) * 2 - 1;
+        Vec3f worldPosition = cameraPosition + Vec3f(ndcX * depth * tanY * camera.aspectRatio,
+                                                     ndcY * depth * tanY,
+                                                     -depth);
+
+        auto &cluster = grid.getClusters().at(grid.getClusterIndex(worldPosition, fragCoord));
+        auto begin = grid.getLightIndices().begin() + cluster.offset;
+        auto end = begin + cluster.count;
+
+        for (auto &light: lights) {
+            if (light.position.distance(worldPosition) < light.radius) {
+                if (std::find(begin, end, light.index) == end) {
+                    throw std::runtime_error("Light missing from cluster");
+                }
+                checked++;
+            }
+        }
+    }
+
+    std::cout << "Verified " << checked << " light samples\n";
+}
+
+static void run(size_t lightCount) {
+    Camera camera;
+    camera.fov = 60;
+    camera.aspectRatio = static_cast<float>(VIEWPORT_SIZE.x) / static_cast<float>(VIEWPORT_SIZE.y);
+    camera.nearClip = 0.1f;
+    camera.farClip = 300;
+
+    Vec3f cameraPosition(10, 5, 20);
+    auto view = MatrixMath::translate(cameraPosition * -1);
+
+    auto lights = createLights(lightCount, cameraPosition);
+
+    LightClusterGrid singleThreaded(16, 9, 24, std::numeric_limits<size_t>::max());
+    LightClusterGrid parallel(16, 9, 24, 64);
+
+    std::cout << "--- " << lightCount << " lights ---\n";
+    benchmark("Single threaded", [&](int) {
+        singleThreaded.build(camera, view, VIEWPORT_SIZE, lights);
+    });
+    benchmark("Parallel", [&](int) {
+        parallel.build(camera, view, VIEWPORT_SIZE, lights);
+    });
+
+    if (singleThreaded.getLightIndices() != parallel.getLightIndices()) {
+        throw std::runtime_error("Parallel light lists differ from single threaded light lists");
+    }
+
+    verify(parallel, camera, cameraPosition, lights);
+
+    std::cout << "Light indices: " << parallel.getLightIndices().size()
+              << " (" << static_cast<double>(parallel.getLightIndices().size()) / parallel.getClusters().size()
+              << " per cluster)\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Threads: " << std::thread::hardware_concurrency() << "\n";
+    run(300);
+    run(1000);
+    run(5000);
+    return 0;
+}
@@ -0,0 +1,236 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+static const size_t ITERATIONS = 1000000;
+
+// The element wise implementations which were used before the simd kernels.
+
+static Mat4f referenceMultiply(const Mat4f &lhs, const Mat4f &rhs) {
+    Mat4f ret;
+    for (int row = 0; row < 4; row++) {
+        for (int column = 0; column < 4; column++) {
+            float v = 0;
+            for (int i = 0; i < 4; i++) {
+                v += lhs.get(i, row) * rhs.get(column, i);
+            }
+            ret.set(column, row, v);
+        }
+    }
+    return ret;
+}
+
+static Vec4f referenceMultiply(const Mat4f &lhs, const Vec4f &rhs) {
+    float in[4] = {rhs.x, rhs.y, rhs.z, rhs.w};
+    float out[4] = {};
+    for (int row = 0; row < 4; row++) {
+        for (int column = 0; column < 4; column++) {
+            out[row] += lhs.get(column, row) * in[column];
+        }
+    }
+    return {out[0], out[1], out[2], out[3]};
+}
+
+static Mat4f referenceTranspose(const Mat4f &mat) {
+    Mat4f ret;
+    for (int r = 0; r < mat.height(); r++) {
+        for (int c = 0; c < mat.width(); c++) {
+            ret.set(r, c, mat.get(c, r));
+        }
+    }
+    return ret;
+}
+
+static glm::mat4 convert(const Mat4f &mat) {
+    return reinterpret_cast<const glm::mat4 &>(mat);
+}
+
+static Mat4f convert(const glm::mat4 &mat) {
+    return reinterpret_cast<const Mat4f &>(mat);
+}
+
+template<typename F>
+static void benchmark(const std::string &name, F func) {
+    auto start = std::chrono::steady_clock::now();
+    func();
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": "
+              << static_cast<double>(duration.count()) / static_cast<double>(ITERATIONS)
+              << " ns/op\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> dist(-1, 1);
+
+    std::vector<Mat4f> matrices(1024);
+    for (auto &mat: matrices) {
+        for (auto &v: mat.data) {
+            v = dist(rng);
+        }
+    }
+
+    std::vector<Vec3f> points(ITERATIONS);
+    for (auto &point: points) {
+        point = Vec3f(dist(rng), dist(rng), dist(rng));
+    }
+
+    std::vector<Quaternion> quaternions(1024);
+    for (auto &q: quaternions) {
+        q = Quaternion(dist(rng), dist(rng), dist(rng), dist(rng)).normalize();
+    }
+
+    volatile float sink = 0;
+
+    std::cout << "--- Mat4f * Mat4f ---\n";
+    benchmark("Reference", [&]() {
+        Mat4f acc = MatrixMath::identity();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            acc = referenceMultiply(matrices[i % matrices.size()], acc);
+        }
+        sink = acc.data[0];
+    });
+    benchmark("GLM", [&]() {
+        Mat4f acc = MatrixMath::identity();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            acc = convert(convert(matrices[i % matrices.size()]) * convert(acc));
+        }
+        sink = acc.data[0];
+    });
+    benchmark("Engine", [&]() {
+        Mat4f acc = MatrixMath::identity();
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            acc = matrices[i % matrices.size()] * acc;
+        }
+        sink = acc.data[0];
+    });
+
+    std::cout << "--- Mat4f * Vec4f ---\n";
+    benchmark("Reference", [&]() {
+        Vec4f acc(1);
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            acc = referenceMultiply(matrices[i % matrices.size()], acc);
+        }
+        sink = acc.x;
+    });
+    benchmark("Engine", [&]() {
+        Vec4f acc(1);
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            acc = matrices[i % matrices.size()] * acc;
+        }
+        sink = acc.x;
+    });
+
+    std::cout << "--- Transpose ---\n";
+    benchmark("Reference", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = referenceTranspose(matrices[i % matrices.size()]).data[1];
+        }
+    });
+    benchmark("Engine", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = MatrixMath::transpose(matrices[i % matrices.size()]).data[1];
+        }
+    });
+
+    std::cout << "--- Inverse ---\n";
+    benchmark("GLM", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = convert(glm::inverse(convert(matrices[i % matrices.size()]))).data[1];
+        }
+    });
+    benchmark("Engine", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = MatrixMath::inverse(matrices[i % matrices.size()]).data[1];
+        }
+    });
+
+    std::cout << "--- Quaternion slerp ---\n";
+    benchmark("GLM", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            auto &a = quaternions[i % quaternions.size()];
+            auto &b = quaternions[(i + 1) % quaternions.size()];
+            sink = glm::slerp(glm::quat(a.w, a.x, a.y, a.z), glm::quat(b.w, b.x, b.y, b.z), 0.3f).w;
+        }
+    });
+    benchmark("Engine", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = Quaternion::slerp(quaternions[i % quaternions.size()],
+                                     quaternions[(i + 1) % quaternions.size()],
+                                     0.3f).w;
+        }
+    });
+
+    std::cout << "--- Quaternion normalize ---\n";
+    benchmark("GLM", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            auto &a = quaternions[i % quaternions.size()];
+            sink = glm::normalize(glm::quat(a.w, a.x, a.y, a.z)).w;
+        }
+    });
+    benchmark("Engine", [&]() {
+        for (size_t i = 0; i < ITERATIONS; i++) {
+            sink = Quaternion::normalize(quaternions[i % quaternions.size()]).w;
+        }
+    });
+
+    std::cout << "--- Transform points ---\n";
+    std::vector<Vec3f> out(points.size());
+    benchmark("Reference", [&]() {
+        for (size_t i = 0; i < points.size(); i++) {
+            auto v = referenceMultiply(matrices[0], Vec4f(points[i].x, points[i].y, points[i].z, 1));
+            out[i] = Vec3f(v.x, v.y, v.z);
+        }
+        sink = out[0].x;
+    });
+    benchmark("Engine Batch", [&]() {
+        MatrixMath::transformPoints(matrices[0], points.data(), out.data(), points.size());
+        sink = out[0].x;
+    });
+
+    std::cout << "--- Mat4f batch multiply ---\n";
+    std::vector<Mat4f> batch(ITERATIONS);
+    benchmark("Reference", [&]() {
+        for (size_t i = 0; i < batch.size(); i++) {
+            batch[i] = referenceMultiply(matrices[0], matrices[i % matrices.size()]);
+        }
+        sink = batch[0].data[0];
+    });
+    benchmark("Engine Batch", [&]() {
+        for (size_t i = 0; i < batch.size(); i += matrices.size()) {
+            MatrixMath::multiply(matrices[0],
+                                 matrices.data(),
+                                 batch.data() + i,
+                                 std::min(matrices.size(), batch.size() - i));
+        }
+        sink = batch[0].data[0];
+    });
+
+    return 0;
+}
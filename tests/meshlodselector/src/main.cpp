@@ -0,0 +1,117 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <iostream>
+
+using namespace xng;
+
+static const Vec2i resolution(1000, 1000);
+static const float threshold = 1;
+static const float hysteresis = 0.2f;
+
+/**
+ * @return A mesh whose first coarser level fits the threshold at a distance of about 9.66 and
+ * fits the threshold with hysteresis at a distance of about 11.83
+ */
+static MeshAllocator::MeshAllocation createMesh() {
+    MeshAllocator::MeshAllocation ret;
+    ret.lodErrors = {0, 0.01f, 0.1f};
+    ret.bounds = Vec4f(0, 0, 0, 1);
+    return ret;
+}
+
+/**
+ * Simulates the scene which is recreated by the mesh render system in every frame.
+ */
+static size_t selectFrame(MeshLodSelector &selector,
+                          const MeshAllocator::MeshAllocation &mesh,
+                          int objectId,
+                          float distance) {
+    Camera camera(PERSPECTIVE);
+    selector.beginFrame(camera, Transform(), resolution, threshold, hysteresis);
+
+    Node node;
+
+    TransformProperty transformProperty;
+    transformProperty.transform = Transform(Vec3f(0, 0, -distance), Vec3f(), Vec3f(1));
+    node.addProperty(transformProperty);
+
+    SkinnedMeshProperty meshProperty;
+    meshProperty.objectId = objectId;
+    node.addProperty(meshProperty);
+
+    return selector.select(MeshLodSelector::getObjectId(node.getProperty<SkinnedMeshProperty>(), 0),
+                           mesh,
+                           node.getProperty<TransformProperty>().transform);
+}
+
+static void testHysteresis(int objectId) {
+    auto mesh = createMesh();
+    MeshLodSelector selector;
+
+    if (selectFrame(selector, mesh, objectId, 13) != 1) {
+        throw std::runtime_error("Coarser level was not selected beyond the hysteresis distance");
+    }
+
+    // Between the threshold and the hysteresis distance the level of the previous frame is kept
+    for (auto i = 0; i < 4; i++) {
+        if (selectFrame(selector, mesh, objectId, 10.5f) != 1) {
+            throw std::runtime_error("Level of detail changed within the hysteresis range");
+        }
+    }
+
+    if (selectFrame(selector, mesh, objectId, 9) != 0) {
+        throw std::runtime_error("Finer level was not selected below the threshold distance");
+    }
+
+    for (auto i = 0; i < 4; i++) {
+        if (selectFrame(selector, mesh, objectId, 10.5f) != 0) {
+            throw std::runtime_error("Level of detail changed within the hysteresis range");
+        }
+    }
+}
+
+static void testObjects() {
+    auto mesh = createMesh();
+    MeshLodSelector selector;
+
+    selectFrame(selector, mesh, 1, 13);
+
+    // Another object at the same distance does not use the state of the first object
+    if (selectFrame(selector, mesh, 2, 10.5f) != 0) {
+        throw std::runtime_error("Objects with different ids shared the level of detail");
+    }
+
+    // Objects without an id are identified by the node index and do not collide with object ids
+    SkinnedMeshProperty property;
+    if (MeshLodSelector::getObjectId(property, 1) == MeshLodSelector::getObjectId(property, 2)
+        || MeshLodSelector::getObjectId(property, 1) == 1) {
+        throw std::runtime_error("Node index identifiers collide");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testHysteresis(5);
+    testHysteresis(-1);
+    testObjects();
+    std::cout << "Mesh lod selector tests passed\n";
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+/**
+ * A flat grid with its triangles in random order.
+ */
+static Mesh createShuffledGrid(unsigned int size) {
+    Mesh ret;
+    ret.primitive = TRIANGLES;
+    ret.vertexLayout = VertexLayout({VertexAttribute(VertexAttribute::VECTOR3, VertexAttribute::FLOAT),
+                                     VertexAttribute(VertexAttribute::VECTOR2, VertexAttribute::FLOAT)});
+    for (unsigned int y = 0; y <= size; y++) {
+        for (unsigned int x = 0; x <= size; x++) {
+            ret.vertices.emplace_back(VertexBuilder()
+                                              .addVec3(Vec3f(static_cast<float>(x), static_cast<float>(y), 0))
+                                              .addVec2(Vec2f(static_cast<float>(x) / static_cast<float>(size),
+                                                             static_cast<float>(y) / static_cast<float>(size)))
+                                              .build());
+        }
+    }
+
+    std::vector<std::array<unsigned int, 3>> triangles;
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            auto i = y * (size + 1) + x;
+            triangles.push_back({i, i + 1, i + size + 1});
+            triangles.push_back({i + 1, i + size + 2, i + size + 1});
+        }
+    }
+
+    std::mt19937 random(42);
+    std::shuffle(triangles.begin(), triangles.end(), random);
+    for (auto &triangle: triangles) {
+        ret.indices.insert(ret.indices.end(), triangle.begin(), triangle.end());
+    }
+
+    // A coarser level which references every other row of the grid
+    Mesh::Lod lod;
+    for (size_t i = 0; i < ret.indices.size(); i += 12) {
+        lod.indices.insert(lod.indices.end(), ret.indices.begin() + i, ret.indices.begin() + i + 3);
+    }
+    ret.lods.emplace_back(lod);
+
+    return ret;
+}
+
+/**
+ * @return The triangles as sorted vertex data so that the geometry can be compared independent of the order
+ */
+static std::vector<std::vector<uint8_t>> getTriangles(const Mesh &mesh, const std::vector<unsigned int> &indices) {
+    std::vector<std::vector<uint8_t>> ret;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        // Rotate the triangle so that the winding is preserved
+        std::array<const std::vector<uint8_t> *, 3> vertices{};
+        for (int v = 0; v < 3; v++) {
+            vertices.at(v) = &mesh.vertices.at(indices.at(i + v)).buffer;
+        }
+        auto first = std::min_element(vertices.begin(), vertices.end(), [](const auto *lhs, const auto *rhs) {
+            return *lhs < *rhs;
+        }) - vertices.begin();
+
+        std::vector<uint8_t> triangle;
+        for (int v = 0; v < 3; v++) {
+            auto &buffer = *vertices.at((first + v) % 3);
+            triangle.insert(triangle.end(), buffer.begin(), buffer.end());
+        }
+        ret.emplace_back(triangle);
+    }
+    std::sort(ret.begin(), ret.end());
+    return ret;
+}
+
+static void testGrid() {
+    auto mesh = createShuffledGrid(64);
+    auto triangles = getTriangles(mesh, mesh.indices);
+    auto lodTriangles = getTriangles(mesh, mesh.lods.at(0).indices);
+
+    auto start = std::chrono::steady_clock::now();
+    auto report = mesh.optimize();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "Grid: " << report.before.triangles << " triangles in "
+              << static_cast<double>(duration.count()) / 1000.0 << " ms"
+              << " ACMR: " << report.before.getACMR() << " -> " << report.after.getACMR()
+              << " ATVR: " << report.before.getATVR() << " -> " << report.after.getATVR() << "\n";
+
+    if (report.after.getACMR() > 0.8f || report.after.getACMR() * 2 > report.before.getACMR()) {
+        throw std::runtime_error("Vertex cache optimization did not reduce the cache miss ratio");
+    }
+    if (report.after.triangles != report.before.triangles || report.after.vertices != report.before.vertices) {
+        throw std::runtime_error("Optimization changed the triangle or vertex count");
+    }
+    if (getTriangles(mesh, mesh.indices) != triangles || getTriangles(mesh, mesh.lods.at(0).indices) != lodTriangles) {
+        throw std::runtime_error("Optimization changed the geometry");
+    }
+
+    // The vertices are stored in the order of their first use
+    unsigned int next = 0;
+    for (auto index: mesh.indices) {
+        if (index > next) {
+            throw std::runtime_error("Vertices are not ordered by first use");
+        } else if (index == next) {
+            next++;
+        }
+    }
+}
+
+static void testOverdraw() {
+    // Two parallel quads, the quad which lies further along its normal from the mesh center is drawn first
+    std::vector<Vec3f> positions = {
+            {0, 0, 0},
+            {1, 0, 0},
+            {1, 1, 0},
+            {0, 1, 0},
+            {0, 0, 3},
+            {1, 0, 3},
+            {1, 1, 3},
+            {0, 1, 3},
+    };
+    // Both quads face towards +z and do not share vertices so that each quad is a separate cluster
+    std::vector<unsigned int> indices = {0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 7};
+    auto optimized = MeshOptimizer::optimizeOverdraw(indices, positions);
+    if (optimized != std::vector<unsigned int>{4, 5, 6, 4, 6, 7, 0, 1, 2, 0, 2, 3}) {
+        throw std::runtime_error("Outer cluster is not drawn first");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testGrid();
+    testOverdraw();
+    return 0;
+}
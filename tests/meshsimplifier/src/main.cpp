@@ -0,0 +1,192 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+
+using namespace xng;
+
+/**
+ * A closed sphere without attribute seams, created by subdividing an icosahedron.
+ */
+static void createIcosphere(int subdivisions, std::vector<Vec3f> &positions, std::vector<unsigned int> &indices) {
+    const float t = (1.0f + std::sqrt(5.0f)) / 2.0f;
+    positions = {
+            {-1, t,  0},
+            {1,  t,  0},
+            {-1, -t, 0},
+            {1,  -t, 0},
+            {0,  -1, t},
+            {0,  1,  t},
+            {0,  -1, -t},
+            {0,  1,  -t},
+            {t,  0,  -1},
+            {t,  0,  1},
+            {-t, 0,  -1},
+            {-t, 0,  1}
+    };
+    indices = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11,
+               1, 5, 9, 5, 11, 4, 11, 10, 2, 10, 7, 6, 7, 1, 8,
+               3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9,
+               4, 9, 5, 2, 4, 11, 6, 2, 10, 8, 6, 7, 9, 8, 1};
+
+    for (int s = 0; s < subdivisions; s++) {
+        std::map<std::pair<unsigned int, unsigned int>, unsigned int> midpoints;
+        auto getMidpoint = [&](unsigned int a, unsigned int b) {
+            auto key = std::make_pair(std::min(a, b), std::max(a, b));
+            auto it = midpoints.find(key);
+            if (it != midpoints.end()) {
+                return it->second;
+            }
+            auto index = static_cast<unsigned int>(positions.size());
+            positions.emplace_back((positions.at(a) + positions.at(b)) * 0.5f);
+            midpoints[key] = index;
+            return index;
+        };
+
+        std::vector<unsigned int> subdivided;
+        for (size_t i = 0; i < indices.size(); i += 3) {
+            auto a = indices.at(i);
+            auto b = indices.at(i + 1);
+            auto c = indices.at(i + 2);
+            auto ab = getMidpoint(a, b);
+            auto bc = getMidpoint(b, c);
+            auto ca = getMidpoint(c, a);
+            subdivided.insert(subdivided.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+        }
+        indices = subdivided;
+    }
+
+    for (auto &p: positions) {
+        p = p / p.magnitude();
+    }
+}
+
+/**
+ * A flat grid with an open border.
+ */
+static void createGrid(unsigned int size, std::vector<Vec3f> &positions, std::vector<unsigned int> &indices) {
+    for (unsigned int y = 0; y <= size; y++) {
+        for (unsigned int x = 0; x <= size; x++) {
+            positions.emplace_back(static_cast<float>(x), static_cast<float>(y), 0.0f);
+        }
+    }
+    for (unsigned int y = 0; y < size; y++) {
+        for (unsigned int x = 0; x < size; x++) {
+            auto i = y * (size + 1) + x;
+            indices.insert(indices.end(), {i, i + 1, i + size + 1, i + 1, i + size + 2, i + size + 1});
+        }
+    }
+}
+
+static float getArea(const std::vector<Vec3f> &positions, const std::vector<unsigned int> &indices) {
+    float ret = 0;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        auto a = positions.at(indices.at(i + 1)) - positions.at(indices.at(i));
+        auto b = positions.at(indices.at(i + 2)) - positions.at(indices.at(i));
+        ret += std::abs(a.x * b.y - a.y * b.x) / 2;
+    }
+    return ret;
+}
+
+static void testGrid() {
+    std::vector<Vec3f> positions;
+    std::vector<unsigned int> indices;
+    createGrid(64, positions, indices);
+
+    auto result = MeshSimplifier::simplify(positions, indices, 0, 0.001f);
+    auto distance = MeshSimplifier::getDistanceError(positions, indices, result.indices);
+
+    std::cout << "Grid: " << indices.size() / 3 << " -> " << result.indices.size() / 3 << " triangles"
+              << " Error: " << result.error
+              << " Distance: " << distance << "\n";
+
+    // A flat surface collapses without error as long as its border is preserved
+    if (result.indices.size() * 4 > indices.size()) {
+        throw std::runtime_error("Flat grid was not simplified");
+    }
+    if (distance > 0.0001f || std::abs(getArea(positions, result.indices) - 64 * 64) > 0.01f) {
+        throw std::runtime_error("Flat grid border was not preserved");
+    }
+}
+
+static void testSphere() {
+    std::vector<Vec3f> positions;
+    std::vector<unsigned int> indices;
+    createIcosphere(5, positions, indices);
+
+    Mesh mesh;
+    mesh.primitive = TRIANGLES;
+    mesh.vertexLayout = Mesh::getDefaultVertexLayout();
+    mesh.indices = indices;
+    for (auto &p: positions) {
+        mesh.vertices.emplace_back(VertexBuilder()
+                                           .addVec3(p)
+                                           .addVec3(p)
+                                           .addVec2(Vec2f())
+                                           .addVec3(Vec3f())
+                                           .addVec3(Vec3f())
+                                           .build());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    MeshSimplifier::generateLods(mesh, MeshSimplifier::LodSettings{.maxLods = 6, .reduction = 0.5f, .maxError = 0.1f});
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << "Sphere: " << indices.size() / 3 << " triangles, "
+              << mesh.lods.size() << " levels in " << static_cast<double>(duration.count()) / 1000.0 << " ms\n";
+
+    if (mesh.lods.size() < 4) {
+        throw std::runtime_error("Sphere levels of detail were not generated");
+    }
+
+    auto previousCount = indices.size();
+    for (size_t i = 0; i < mesh.lods.size(); i++) {
+        auto &lod = mesh.lods.at(i);
+        auto distance = MeshSimplifier::getDistanceError(positions, indices, lod.indices);
+
+        std::cout << "LOD " << i + 1 << ": " << lod.indices.size() / 3 << " triangles"
+                  << " Error: " << lod.error
+                  << " Distance: " << distance << "\n";
+
+        if (lod.indices.size() >= previousCount) {
+            throw std::runtime_error("Level of detail is not coarser than the previous level");
+        }
+        // The quadric error approximates the distance to the source surface
+        if (distance > lod.error * 2 + 0.001f) {
+            throw std::runtime_error("Level of detail distance exceeds the reported error");
+        }
+        for (auto index: lod.indices) {
+            if (index >= positions.size()) {
+                throw std::runtime_error("Level of detail index out of range");
+            }
+        }
+        previousCount = lod.indices.size();
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testGrid();
+    testSphere();
+    return 0;
+}
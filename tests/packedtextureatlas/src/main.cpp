@@ -0,0 +1,217 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+static bool overlaps(const PackedTextureAtlas::Region &a, const PackedTextureAtlas::Region &b) {
+    return a.layer == b.layer
+           && a.allocationOffset.x < b.allocationOffset.x + b.allocationSize.x
+           && b.allocationOffset.x < a.allocationOffset.x + a.allocationSize.x
+           && a.allocationOffset.y < b.allocationOffset.y + b.allocationSize.y
+           && b.allocationOffset.y < a.allocationOffset.y + a.allocationSize.y;
+}
+
+static void validate(const PackedTextureAtlas &atlas, const std::vector<size_t> &handles) {
+    auto alignment = 1 << (atlas.getMipMapLevels() - 1);
+    for (auto i = 0; i < handles.size(); i++) {
+        auto &region = atlas.getRegion(handles.at(i));
+        if (region.allocationOffset.x % alignment != 0
+            || region.allocationOffset.y % alignment != 0
+            || region.allocationSize.x % alignment != 0
+            || region.allocationSize.y % alignment != 0) {
+            throw std::runtime_error("Region is not aligned to the smallest mip map level");
+        }
+        if (region.offset.x - region.allocationOffset.x < atlas.getPadding()
+            || region.offset.y - region.allocationOffset.y < atlas.getPadding()
+            || region.offset.x + region.size.x + atlas.getPadding()
+               > region.allocationOffset.x + region.allocationSize.x
+            || region.offset.y + region.size.y + atlas.getPadding()
+               > region.allocationOffset.y + region.allocationSize.y) {
+            throw std::runtime_error("Region padding is too small");
+        }
+        if (region.layer >= atlas.getLayerCount()
+            || region.allocationOffset.x < 0
+            || region.allocationOffset.y < 0
+            || region.allocationOffset.x + region.allocationSize.x > atlas.getLayerSize().x
+            || region.allocationOffset.y + region.allocationSize.y > atlas.getLayerSize().y) {
+            throw std::runtime_error("Region is outside of the layer");
+        }
+        for (auto j = i + 1; j < handles.size(); j++) {
+            if (overlaps(region, atlas.getRegion(handles.at(j)))) {
+                throw std::runtime_error("Regions overlap");
+            }
+        }
+    }
+}
+
+static void testPacking() {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> dimension(8, 300);
+
+    PackedTextureAtlas atlas({2048, 2048}, 4, 3);
+    std::vector<size_t> handles;
+    size_t textureArea = 0;
+    size_t slotArea = 0;
+    for (auto i = 0; i < 400; i++) {
+        Vec2i size(dimension(random), dimension(random));
+        handles.emplace_back(atlas.add(size));
+        textureArea += static_cast<size_t>(size.x * size.y);
+
+        auto slot = TextureAtlas::getResolutionLevelSize(TextureAtlas::getClosestMatchingResolutionLevel(size));
+        slotArea += static_cast<size_t>(slot.x * slot.y);
+    }
+    validate(atlas, handles);
+
+    auto packedArea = atlas.getLayerCount() * 2048 * 2048;
+    std::cout << "Packed " << handles.size() << " textures into " << atlas.getLayerCount() << " layers, "
+              << "texel efficiency " << static_cast<double>(textureArea) / static_cast<double>(packedArea)
+              << " (power of two slots " << static_cast<double>(textureArea) / static_cast<double>(slotArea)
+              << ")\n";
+    if (packedArea >= slotArea) {
+        throw std::runtime_error("Packing uses more memory than power of two slots");
+    }
+
+    // Wide textures waste most of a power of two slot.
+    PackedTextureAtlas wide({1024, 1024}, 2, 1);
+    for (auto i = 0; i < 60; i++) {
+        wide.add({300, 40});
+    }
+    if (wide.getLayerCount() != 1) {
+        throw std::runtime_error("Wide textures are not packed densely");
+    }
+
+    try {
+        atlas.add({2048, 2048});
+        throw std::logic_error("Texture larger than a layer was accepted");
+    } catch (const std::runtime_error &) {}
+}
+
+static void testPadding() {
+    ImageRGBA image(3, 2);
+    for (auto y = 0; y < 2; y++) {
+        for (auto x = 0; x < 3; x++) {
+            image.setPixel(x, y, ColorRGBA(static_cast<uint8_t>(x * 10 + y), 0, 0, 255));
+        }
+    }
+
+    PackedTextureAtlas atlas({64, 64}, 2, 3);
+    auto handle = atlas.add(image.getResolution());
+    auto &region = atlas.getRegion(handle);
+    if (region.allocationSize != Vec2i(8, 8)) {
+        throw std::runtime_error("Invalid allocation size");
+    }
+
+    auto padded = PackedTextureAtlas::getPaddedImage(image, region);
+    auto border = region.offset - region.allocationOffset;
+    for (auto y = 0; y < padded.getResolution().y; y++) {
+        for (auto x = 0; x < padded.getResolution().x; x++) {
+            auto sx = std::clamp(x - border.x, 0, 2);
+            auto sy = std::clamp(y - border.y, 0, 1);
+            if (padded.getPixel(x, y).r() != sx * 10 + sy) {
+                throw std::runtime_error("Padding does not repeat the texture edge");
+            }
+        }
+    }
+
+    auto scale = atlas.getUvScale(handle);
+    auto offset = atlas.getUvOffset(handle);
+    if (scale != Vec2f(3.0f / 64, 2.0f / 64) || offset != Vec2f(2.0f / 64, 2.0f / 64)) {
+        throw std::runtime_error("Invalid uv transform");
+    }
+}
+
+static void testDefragment() {
+    std::mt19937 random(11);
+    std::uniform_int_distribution<int> dimension(16, 128);
+
+    PackedTextureAtlas atlas({512, 512}, 2, 2);
+    std::vector<size_t> handles;
+    for (auto i = 0; i < 120; i++) {
+        handles.emplace_back(atlas.add({dimension(random), dimension(random)}));
+    }
+    validate(atlas, handles);
+
+    if (!atlas.defragment().empty()) {
+        throw std::runtime_error("Defragmented densely packed layers");
+    }
+
+    // Remove most of the textures of the first layer which leaves holes the packer cannot reuse.
+    std::vector<size_t> remaining;
+    for (auto i = 0; i < handles.size(); i++) {
+        auto handle = handles.at(i);
+        if (atlas.getRegion(handle).layer == 0 && i % 3 != 0) {
+            atlas.remove(handle);
+        } else {
+            remaining.emplace_back(handle);
+        }
+    }
+
+    auto layers = atlas.getLayerCount();
+    auto occupancy = atlas.getOccupancy(0);
+
+    std::map<size_t, PackedTextureAtlas::Region> before;
+    for (auto handle: remaining) {
+        before[handle] = atlas.getRegion(handle);
+    }
+
+    auto moves = atlas.defragment();
+    if (moves.empty()) {
+        throw std::runtime_error("Fragmented layer was not compacted");
+    }
+    validate(atlas, remaining);
+
+    for (auto &move: moves) {
+        if (!(move.source == before.at(move.handle)) || !(move.target == atlas.getRegion(move.handle))) {
+            throw std::runtime_error("Move does not match the regions");
+        }
+        if (move.source.layer != 0 || move.target.layer == 0 || move.source.size != move.target.size) {
+            throw std::runtime_error("Invalid move");
+        }
+    }
+    for (auto handle: remaining) {
+        if (before.at(handle).layer != 0 && !(before.at(handle) == atlas.getRegion(handle))) {
+            throw std::runtime_error("Region of another layer was moved");
+        }
+    }
+    if (atlas.getLayerCount() > layers + 1 || atlas.getOccupancy(moves.at(0).target.layer) <= occupancy) {
+        throw std::runtime_error("Defragmentation did not improve the occupancy");
+    }
+
+    std::cout << "Defragmented layer 0 with occupancy " << occupancy << " into layer " << moves.at(0).target.layer
+              << " with occupancy " << atlas.getOccupancy(moves.at(0).target.layer) << " ("
+              << moves.size() << " moves)\n";
+
+    // The evacuated layer is reused by new textures.
+    auto handle = atlas.add({100, 100});
+    if (atlas.getRegion(handle).layer != 0) {
+        throw std::runtime_error("Evacuated layer was not reused");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testPacking();
+    testPadding();
+    testDefragment();
+    return 0;
+}
@@ -20,6 +20,7 @@
 #include "xng/xng.hpp"
 
 #include <fstream>
+#include <random>
 
 int main(int argc, char *argv[]) {
     auto cryptoDriver = xng::cryptopp::CryptoPPDriver();
@@ -86,6 +87,65 @@ int main(int argc, char *argv[]) {
         fs.close();
     }
 
+    // Stream the files into chunk files
+    xng::PakBuilder fileBuilder;
+    for (auto &p: paths) {
+        fileBuilder.addFile(p, p);
+    }
+
+    std::vector<std::unique_ptr<std::fstream>> chunkStreams;
+    fileBuilder.build([&](size_t index) -> std::ostream & {
+                          chunkStreams.emplace_back(std::make_unique<std::fstream>(
+                                  "assets_streamed.pak." + std::to_string(index),
+                                  std::ios_base::in | std::ios_base::out | std::ios_base::trunc | std::ios::binary));
+                          return *chunkStreams.back();
+                      },
+                      1024 * 1024,
+                      true,
+                      false,
+                      *sha,
+                      *zip,
+                      *aes,
+                      "test",
+                      xng::AES::getRandomIv(*ran));
+
+    std::vector<std::shared_ptr<xng::RandomAccessReader>> chunks;
+    for (size_t i = 0; i < chunkStreams.size(); i++) {
+        chunks.emplace_back(xng::RandomAccessReader::open("assets_streamed.pak." + std::to_string(i)));
+    }
+    chunkStreams.clear();
+
+    xng::Pak streamedPak(chunks, *zip, *sha);
+    for (auto &p: paths) {
+        if (streamedPak.get(p, true) != xng::readFile(p)) {
+            throw std::runtime_error("Streamed pak entry mismatch: " + p);
+        }
+    }
+
+    // Compressed entries are framed if any block compresses, not only the first
+    std::vector<char> mixed(4 * 4096);
+    std::mt19937 rng(1);
+    for (size_t i = 0; i < 4096; i++) {
+        mixed[i] = static_cast<char>(rng());
+    }
+    xng::PakBuilder mixedBuilder(4096);
+    mixedBuilder.addEntry("mixed", mixed, xng::Pak::CODEC_LZ4);
+    auto mixedData = mixedBuilder.build(0,
+                                        true,
+                                        false,
+                                        *sha,
+                                        *zip,
+                                        *aes,
+                                        "test",
+                                        xng::AES::getRandomIv(*ran));
+    xng::Pak mixedPak({xng::RandomAccessReader::fromBuffer(xng::ReadBuffer(mixedData.at(0)))}, *zip, *sha);
+    if (mixedPak.getEntries().at("mixed").codec != xng::Pak::CODEC_LZ4) {
+        throw std::runtime_error("Entry with an incompressible first block was stored");
+    }
+    if (mixedPak.get("mixed", true) != mixed) {
+        throw std::runtime_error("Mixed pak entry mismatch");
+    }
+
     std::cout << "Successfully created and extracted pak files.\n";
 
     return 0;
@@ -0,0 +1,134 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+using namespace xng;
+
+static const size_t ENTRIES = 512;
+static const size_t ENTRY_SIZE = 256 * 1024;
+
+static std::vector<char> createEntry(size_t index) {
+    // Compressible but not trivially repeating data
+    std::vector<char> ret(ENTRY_SIZE);
+    uint32_t state = static_cast<uint32_t>(index) * 2654435761u + 1;
+    for (size_t i = 0; i < ret.size(); i++) {
+        state = state * 1664525u + 1013904223u;
+        ret[i] = static_cast<char>('a' + ((state >> 24) % 16));
+    }
+    return ret;
+}
+
+static void run(const std::string &name, Pak &pak, const std::vector<std::string> &paths, unsigned int threads) {
+    std::atomic<size_t> next = 0;
+    std::atomic<size_t> bytes = 0;
+
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; t++) {
+        workers.emplace_back([&]() {
+            size_t index;
+            while ((index = next++) < paths.size()) {
+                bytes += pak.getBuffer(paths.at(index), true).size();
+            }
+        });
+    }
+    for (auto &worker: workers) {
+        worker.join();
+    }
+
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    auto seconds = static_cast<double>(duration.count()) / 1000000.0;
+
+    std::cout << name << " Threads: " << threads
+              << " Time: " << seconds * 1000.0 << " ms"
+              << " Throughput: " << static_cast<double>(bytes) / 1024.0 / 1024.0 / seconds << " MB/s\n";
+}
+
+int main(int argc, char *argv[]) {
+    auto cryptoDriver = xng::cryptopp::CryptoPPDriver();
+    auto sha = cryptoDriver.createSHA();
+    auto aes = cryptoDriver.createAES();
+    auto zip = cryptoDriver.createGzip();
+    auto ran = cryptoDriver.createRandom();
+
+    size_t entries = ENTRIES;
+    if (argc > 1)
+        entries = std::stoul(argv[1]);
+
+    unsigned int maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    if (argc > 2)
+        maxThreads = std::stoul(argv[2]);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < entries; i++) {
+        paths.emplace_back("entry" + std::to_string(i));
+    }
+
+    const std::map<Pak::Codec, std::string> codecs = {{Pak::CODEC_STORE, "Store"},
+                                                      {Pak::CODEC_GZIP,  "GZip"},
+                                                      {Pak::CODEC_LZ4,   "LZ4"}};
+
+    for (auto &codec: codecs) {
+        {
+            PakBuilder builder;
+            for (size_t i = 0; i < entries; i++) {
+                builder.addEntry(paths.at(i), createEntry(i), codec.first);
+            }
+
+            auto pakData = builder.build(0,
+                                         false,
+                                         false,
+                                         *sha,
+                                         *zip,
+                                         *aes,
+                                         "test",
+                                         xng::AES::getRandomIv(*ran));
+
+            std::ofstream ofstream("benchmark.pak", std::ios_base::out | std::ios::binary);
+            ofstream.write(pakData.at(0).data(), static_cast<std::streamsize>(pakData.at(0).size()));
+            ofstream.close();
+        }
+
+        std::cout << "--- Entries: " << entries
+                  << " Entry Size: " << ENTRY_SIZE / 1024 << " KB"
+                  << " Codec: " << codec.second
+                  << " Pak Size: " << std::filesystem::file_size("benchmark.pak") / 1024 / 1024 << " MB ---\n";
+
+        std::ifstream stream("benchmark.pak", std::ios_base::in | std::ios::binary);
+        Pak streamPak(stream, *zip, *sha);
+        Pak mappedPak({RandomAccessReader::open("benchmark.pak")}, *zip, *sha);
+
+        for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+            run("Stream", streamPak, paths, threads);
+            run("Mapped", mappedPak, paths, threads);
+        }
+    }
+
+    std::filesystem::remove("benchmark.pak");
+
+    return 0;
+}
@@ -0,0 +1,112 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <limits>
+
+using namespace xng;
+
+static const size_t PARTICLES = 1000000;
+static const int FRAMES = 60;
+
+template<typename F>
+static void benchmark(const std::string &name, F func) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < FRAMES; i++) {
+        func(i);
+    }
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": "
+              << static_cast<double>(duration.count()) / 1000.0 / FRAMES
+              << " ms/frame\n";
+}
+
+static void run(const std::string &name, size_t parallelThreshold) {
+    ParticleEmitter emitter;
+    emitter.maxParticles = PARTICLES;
+    emitter.spawnRate = static_cast<float>(PARTICLES); // Replace the particles with a mean lifetime of one second
+    emitter.lifetimeMin = 0.5f;
+    emitter.lifetimeMax = 1.5f;
+    emitter.spawnExtent = {10, 10, 10};
+    emitter.velocityVariance = {1, 1, 1};
+    emitter.acceleration = {0, -9.81f, 0};
+    emitter.drag = 0.1f;
+
+    const float deltaTime = 1.0f / 60.0f;
+    const Vec3f origin;
+    const Vec3f viewPosition(0, 0, -50);
+
+    ParticlePool pool(PARTICLES, parallelThreshold);
+    pool.spawn(PARTICLES, origin, emitter, 0);
+
+    std::vector<ParticleInstance> instances;
+
+    std::cout << "--- " << name << " ---\n";
+    benchmark("Spawn", [&](int frame) {
+        pool.clear();
+        pool.spawn(PARTICLES, origin, emitter, frame);
+    });
+    benchmark("Integrate", [&](int) {
+        pool.integrate(deltaTime, emitter);
+    });
+    benchmark("Integrate, kill and respawn", [&](int frame) {
+        pool.integrate(deltaTime, emitter);
+        pool.kill();
+        pool.spawn(PARTICLES, origin, emitter, frame);
+    });
+    benchmark("Sort", [&](int) {
+        pool.sort(viewPosition);
+    });
+    benchmark("Write instances", [&](int) {
+        pool.writeInstances(emitter, instances);
+    });
+
+    float accumulator = 0;
+    benchmark("Update", [&](int frame) {
+        pool.update(deltaTime, origin, viewPosition, emitter, accumulator, frame);
+        pool.writeInstances(emitter, instances);
+    });
+
+    // Verify the invariants of the pool
+    for (size_t i = 0; i < pool.size(); i++) {
+        if (pool.getAge().at(i) >= pool.getLifetime().at(i)) {
+            throw std::runtime_error("Dead particle after kill");
+        }
+    }
+    for (size_t i = 1; i < instances.size(); i++) {
+        auto distance = [&](const ParticleInstance &instance) {
+            return Vec3f(instance.position[0], instance.position[1], instance.position[2]).distance(viewPosition);
+        };
+        if (distance(instances.at(i - 1)) < distance(instances.at(i)) - 0.001f) {
+            throw std::runtime_error("Particles are not sorted back to front");
+        }
+    }
+
+    std::cout << "Alive: " << pool.size() << "\n";
+}
+
+int main(int argc, char *argv[]) {
+    std::cout << "Particles: " << PARTICLES << " Threads: " << std::thread::hardware_concurrency() << "\n";
+    run("Single threaded", std::numeric_limits<size_t>::max());
+    run("Parallel", 16384);
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <iostream>
+#include <thread>
+
+using namespace xng;
+
+class CacheResource : public Resource {
+public:
+    explicit CacheResource(size_t size) : size(size) {}
+
+    std::unique_ptr<Resource> clone() override {
+        return std::make_unique<CacheResource>(size);
+    }
+
+    std::type_index getTypeIndex() const override {
+        return typeid(CacheResource);
+    }
+
+    size_t getMemoryUsage() const override {
+        return size;
+    }
+
+    size_t size;
+};
+
+// Imports a resource whose memory usage is the size of the file
+class CacheImporter : public ResourceImporter {
+public:
+    ResourceBundle read(std::istream &stream, const std::string &hint, const std::string &path, Archive *archive) override {
+        std::vector<char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+        ResourceBundle ret;
+        ret.add("", std::make_unique<CacheResource>(data.size()));
+        return ret;
+    }
+
+    const std::set<std::string> &getSupportedFormats() const override {
+        static const std::set<std::string> formats = {".cache"};
+        return formats;
+    }
+};
+
+static Uri getUri(size_t index) {
+    return Uri("memory://resource" + std::to_string(index) + ".cache");
+}
+
+// Load the resource and remove the reference again
+static void touch(ResourceRegistry &registry, size_t index) {
+    ResourceHandle<CacheResource> handle(getUri(index), &registry);
+    if (handle.get().size != 1000) {
+        throw std::runtime_error("Invalid resource");
+    }
+}
+
+static void testMemoryBudget() {
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter>> importers;
+    importers.emplace_back(std::make_unique<CacheImporter>());
+    registry.setImporters(std::move(importers));
+
+    auto &archive = registry.getArchiveT<MemoryArchive>("memory");
+    for (size_t i = 0; i < 4; i++) {
+        archive.addData(getUri(i).getFile(), std::vector<uint8_t>(1000));
+    }
+
+    registry.setCachePolicy("memory", {2500, std::chrono::hours(1)});
+
+    // Unreferenced bundles stay resident within the budget, the least recently released bundle is unloaded first
+    touch(registry, 0);
+    touch(registry, 1);
+    touch(registry, 2);
+    registry.awaitAll();
+
+    auto statistics = registry.getCacheStatistics();
+    if (statistics.residentBytes != 2000
+        || statistics.unreferencedBytes != 2000
+        || statistics.evictions != 1
+        || registry.isLoaded(getUri(0))
+        || !registry.isLoaded(getUri(1))
+        || !registry.isLoaded(getUri(2))) {
+        throw std::runtime_error("Least recently released bundle was not evicted");
+    }
+
+    // Referencing a resident bundle does not load it again
+    touch(registry, 1);
+    statistics = registry.getCacheStatistics();
+    if (statistics.hits != 1 || statistics.misses != 3) {
+        throw std::runtime_error("Resident bundle was not reused");
+    }
+
+    // Referenced bundles are never unloaded, even if they exceed the budget
+    {
+        ResourceHandle<CacheResource> a(getUri(2), &registry);
+        ResourceHandle<CacheResource> b(getUri(3), &registry);
+        registry.awaitAll();
+        registry.setCachePolicy("memory", {500, std::chrono::hours(1)});
+        statistics = registry.getCacheStatistics();
+        if (statistics.residentBytes != 2000 || statistics.unreferencedBytes != 0
+            || !registry.isLoaded(getUri(2)) || !registry.isLoaded(getUri(3))) {
+            throw std::runtime_error("Referenced bundle was evicted");
+        }
+    }
+
+    statistics = registry.getCacheStatistics();
+    if (statistics.residentBytes != 0) {
+        throw std::runtime_error("Released bundles over budget were not evicted");
+    }
+}
+
+static void testGracePeriod() {
+    ResourceRegistry registry;
+    std::vector<std::unique_ptr<ResourceImporter>> importers;
+    importers.emplace_back(std::make_unique<CacheImporter>());
+    registry.setImporters(std::move(importers));
+
+    auto &archive = registry.getArchiveT<MemoryArchive>("memory");
+    archive.addData(getUri(0).getFile(), std::vector<uint8_t>(1000));
+
+    // Without a grace period bundles are unloaded with the last reference
+    touch(registry, 0);
+    registry.awaitAll();
+    if (registry.isLoaded(getUri(0)) || registry.getCacheStatistics().evictions != 1) {
+        throw std::runtime_error("Bundle was not unloaded with the last reference");
+    }
+
+    auto gracePeriod = std::chrono::milliseconds(200);
+    registry.setCachePolicy("memory", {std::numeric_limits<size_t>::max(), gracePeriod});
+
+    auto released = std::chrono::steady_clock::now();
+    touch(registry, 0);
+    registry.awaitAll();
+    registry.collect();
+    if (std::chrono::steady_clock::now() - released < gracePeriod && !registry.isLoaded(getUri(0))) {
+        throw std::runtime_error("Bundle was unloaded before the grace period expired");
+    }
+
+    std::this_thread::sleep_for(gracePeriod);
+    registry.collect();
+    auto statistics = registry.getCacheStatistics();
+    if (registry.isLoaded(getUri(0)) || statistics.residentBytes != 0 || statistics.evictions != 2) {
+        throw std::runtime_error("Bundle was not unloaded after the grace period expired");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testMemoryBudget();
+    testGracePeriod();
+    std::cout << "Resource cache tests passed\n";
+    return 0;
+}
@@ -0,0 +1,209 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <chrono>
+#include <iostream>
+#include <thread>
+#include <atomic>
+
+using namespace xng;
+
+static const size_t ITERATIONS = 10000000;
+static const size_t RESOURCES = 64;
+
+class BenchmarkResource : public Resource {
+public:
+    explicit BenchmarkResource(int value) : value(value) {}
+
+    std::unique_ptr<Resource> clone() override {
+        return std::make_unique<BenchmarkResource>(value);
+    }
+
+    std::type_index getTypeIndex() const override {
+        return typeid(BenchmarkResource);
+    }
+
+    int value;
+};
+
+class BenchmarkImporter : public ResourceImporter {
+public:
+    ResourceBundle read(std::istream &stream, const std::string &hint, const std::string &path, Archive *archive) override {
+        int value;
+        stream >> value;
+        ResourceBundle ret;
+        ret.add("", std::make_unique<BenchmarkResource>(value));
+        return ret;
+    }
+
+    const std::set<std::string> &getSupportedFormats() const override {
+        static const std::set<std::string> formats = {".bench"};
+        return formats;
+    }
+};
+
+template<typename F>
+static void benchmark(const std::string &name, size_t iterations, F func) {
+    auto start = std::chrono::steady_clock::now();
+    func(iterations);
+    auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": "
+              << static_cast<double>(duration.count()) / static_cast<double>(iterations)
+              << " ns/op\n";
+}
+
+static void setData(MemoryArchive &archive, size_t index, int value) {
+    auto str = std::to_string(value);
+    auto path = "resource" + std::to_string(index) + ".bench";
+    if (archive.exists(path)) {
+        archive.removeData(path);
+    }
+    archive.addData(path, std::vector<uint8_t>(str.begin(), str.end()));
+}
+
+int main(int argc, char *argv[]) {
+    size_t iterations = ITERATIONS;
+    if (argc > 1)
+        iterations = std::stoul(argv[1]);
+
+    ResourceRegistry registry;
+
+    std::vector<std::unique_ptr<ResourceImporter>> importers;
+    importers.emplace_back(std::make_unique<BenchmarkImporter>());
+    registry.setImporters(std::move(importers));
+
+    auto &archive = registry.getArchiveT<MemoryArchive>("memory");
+    for (size_t i = 0; i < RESOURCES; i++) {
+        setData(archive, i, static_cast<int>(i));
+    }
+
+    std::vector<Uri> uris;
+    std::vector<ResourceHandle<BenchmarkResource>> handles;
+    for (size_t i = 0; i < RESOURCES; i++) {
+        uris.emplace_back("memory://resource" + std::to_string(i) + ".bench");
+        handles.emplace_back(uris.back(), &registry);
+    }
+    registry.awaitAll();
+
+    std::cout << "Threads: " << std::thread::hardware_concurrency() << "\n";
+
+    // The uri based path which every handle operation used before ids were interned
+    benchmark("Uri incRef / decRef", iterations, [&](size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            auto &uri = uris.at(i % RESOURCES);
+            registry.incRef(uri);
+            registry.decRef(uri);
+        }
+    });
+
+    benchmark("Uri get", iterations, [&](size_t count) {
+        int sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += dynamic_cast<const BenchmarkResource &>(registry.get(uris.at(i % RESOURCES),
+                                                                        typeid(BenchmarkResource))).value;
+        }
+        if (sum == -1) std::cout << sum;
+    });
+
+    benchmark("Handle copy", iterations, [&](size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            auto copy = handles.at(i % RESOURCES);
+            if (!copy.assigned()) throw std::runtime_error("Copied handle is not assigned");
+        }
+    });
+
+    benchmark("Handle get", iterations, [&](size_t count) {
+        int sum = 0;
+        for (size_t i = 0; i < count; i++) {
+            sum += handles.at(i % RESOURCES).get().value;
+        }
+        if (sum == -1) std::cout << sum;
+    });
+
+    auto threads = std::max(2u, std::thread::hardware_concurrency());
+    benchmark("Handle copy and get (" + std::to_string(threads) + " threads)", iterations, [&](size_t count) {
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; t++) {
+            workers.emplace_back([&, t]() {
+                int sum = 0;
+                for (size_t i = t; i < count; i += threads) {
+                    auto copy = handles.at(i % RESOURCES);
+                    sum += copy.get().value;
+                }
+                if (sum == -1) std::cout << sum;
+            });
+        }
+        for (auto &worker: workers) {
+            worker.join();
+        }
+    });
+
+    // The cached pointers must be invalidated by reloads
+    setData(archive, 0, 1000);
+    registry.reload(uris.at(0));
+    registry.awaitAll();
+    if (handles.at(0).get().value != 1000) {
+        throw std::runtime_error("Handle returned the resource of the previous generation after a reload");
+    }
+
+    // Threads resolving the same handle during reloads must not leave a stale pointer tagged with the current generation
+    {
+        std::atomic<bool> running = true;
+        std::vector<std::thread> workers;
+        for (unsigned int t = 0; t < threads; t++) {
+            workers.emplace_back([&]() {
+                while (running) {
+                    // The resource is not accessed, the previous one may be freed by the reload
+                    try {
+                        handles.at(1).get();
+                    } catch (const std::out_of_range &) {
+                        // The bundle is absent between the unload and the load of a reload
+                    }
+                }
+            });
+        }
+        for (auto i = 0; i < 50; i++) {
+            setData(archive, 1, 2000 + i);
+            registry.reload(uris.at(1));
+            registry.awaitAll();
+        }
+        running = false;
+        for (auto &worker: workers) {
+            worker.join();
+        }
+        if (handles.at(1).get().value != 2049) {
+            throw std::runtime_error("Handle returned a stale resource after concurrent reloads");
+        }
+    }
+
+    // Bundles are unloaded when the last handle is destroyed
+    handles.clear();
+    registry.collect();
+    for (auto &uri: uris) {
+        if (registry.isLoaded(uri)) {
+            throw std::runtime_error("Bundle is still loaded after the last handle was destroyed");
+        }
+    }
+
+    std::cout << "Verified reload and unload\n";
+
+    return 0;
+}
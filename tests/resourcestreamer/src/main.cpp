@@ -0,0 +1,220 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <atomic>
+#include <iostream>
+#include <thread>
+
+using namespace xng;
+
+class Gate {
+public:
+    void open() {
+        std::lock_guard<std::mutex> l(mutex);
+        opened = true;
+        condition.notify_all();
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> l(mutex);
+        condition.wait(l, [this]() { return opened; });
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool opened = false;
+};
+
+static void noDecode(const ReadBuffer &) {}
+
+static void noCallback(ResourceStreamer::Status, const std::exception_ptr &) {}
+
+// Occupies the only io slot of the streamer until the gate is opened
+static void enqueueBlocker(ResourceStreamer &streamer, Gate &gate) {
+    streamer.enqueue("blocker",
+                     ResourceStreamer::CRITICAL,
+                     0,
+                     [&gate]() {
+                         gate.wait();
+                         return ReadBuffer();
+                     },
+                     noDecode,
+                     noCallback);
+}
+
+static void testPriorityOrder() {
+    ThreadPool pool(4);
+    ResourceStreamer streamer(1, 1, pool);
+
+    Gate gate;
+    enqueueBlocker(streamer, gate);
+
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto enqueue = [&](const std::string &key, ResourceStreamer::Priority priority, float distance) {
+        streamer.enqueue(key,
+                         priority,
+                         distance,
+                         [&, key]() {
+                             std::lock_guard<std::mutex> l(mutex);
+                             order.emplace_back(key);
+                             return ReadBuffer();
+                         },
+                         noDecode,
+                         noCallback);
+    };
+
+    enqueue("prefetch", ResourceStreamer::PREFETCH, 0);
+    enqueue("visibleFar", ResourceStreamer::VISIBLE, 10);
+    enqueue("visibleNear", ResourceStreamer::VISIBLE, 1);
+    enqueue("visibleNearLater", ResourceStreamer::VISIBLE, 1);
+    enqueue("critical", ResourceStreamer::CRITICAL, 100);
+    enqueue("promoted", ResourceStreamer::PREFETCH, 0);
+
+    if (!streamer.setPriority("promoted", ResourceStreamer::CRITICAL, 0)) {
+        throw std::runtime_error("Queued request was not re-prioritized");
+    }
+    if (streamer.setPriority("blocker", ResourceStreamer::PREFETCH, 0)) {
+        throw std::runtime_error("Running request was re-prioritized");
+    }
+
+    gate.open();
+    streamer.waitIdle();
+
+    // By priority class, then by distance, then by insertion order
+    const std::vector<std::string> expected = {"promoted",
+                                               "critical",
+                                               "visibleNear",
+                                               "visibleNearLater",
+                                               "visibleFar",
+                                               "prefetch"};
+    if (order != expected) {
+        throw std::runtime_error("Requests were not read in priority order");
+    }
+}
+
+static void testCancellation() {
+    ThreadPool pool(4);
+    ResourceStreamer streamer(1, 1, pool);
+
+    Gate gate;
+    enqueueBlocker(streamer, gate);
+
+    std::atomic<bool> read = false;
+    bool cancelled = false;
+    streamer.enqueue("queued",
+                     ResourceStreamer::VISIBLE,
+                     0,
+                     [&]() {
+                         read = true;
+                         return ReadBuffer();
+                     },
+                     noDecode,
+                     [&](ResourceStreamer::Status status, const std::exception_ptr &) {
+                         cancelled = status == ResourceStreamer::CANCELLED;
+                     });
+
+    // The callback is invoked before cancel returns
+    if (!streamer.cancel("queued") || !cancelled || streamer.contains("queued")) {
+        throw std::runtime_error("Queued request was not cancelled");
+    }
+    if (streamer.cancel("blocker")) {
+        throw std::runtime_error("Running request was cancelled");
+    }
+    if (streamer.cancel("unknown")) {
+        throw std::runtime_error("Unknown request was cancelled");
+    }
+
+    gate.open();
+    streamer.waitIdle();
+
+    if (read) {
+        throw std::runtime_error("Cancelled request was read");
+    }
+}
+
+static void updateMax(std::atomic<int> &running, std::atomic<int> &max) {
+    auto value = ++running;
+    auto current = max.load();
+    while (value > current && !max.compare_exchange_weak(current, value)) {}
+}
+
+static void testConcurrencyLimits() {
+    ThreadPool pool(8);
+    ResourceStreamer streamer(2, 3, pool);
+
+    std::atomic<int> runningIo = 0;
+    std::atomic<int> runningDecode = 0;
+    std::atomic<int> maxIo = 0;
+    std::atomic<int> maxDecode = 0;
+    std::atomic<int> completed = 0;
+
+    auto enqueue = [&](size_t count) {
+        for (size_t i = 0; i < count; i++) {
+            streamer.enqueue("request" + std::to_string(i),
+                             ResourceStreamer::VISIBLE,
+                             0,
+                             [&]() {
+                                 updateMax(runningIo, maxIo);
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                                 runningIo--;
+                                 return ReadBuffer(std::vector<uint8_t>(16));
+                             },
+                             [&](const ReadBuffer &buffer) {
+                                 updateMax(runningDecode, maxDecode);
+                                 std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                                 runningDecode--;
+                             },
+                             [&](ResourceStreamer::Status status, const std::exception_ptr &) {
+                                 if (status == ResourceStreamer::COMPLETED) {
+                                     completed++;
+                                 }
+                             });
+        }
+        streamer.waitIdle();
+    };
+
+    enqueue(32);
+    std::cout << "Concurrent reads " << maxIo << " decodes " << maxDecode << "\n";
+    if (completed != 32) {
+        throw std::runtime_error("Not all requests completed");
+    }
+    if (maxIo > 2 || maxDecode > 3) {
+        throw std::runtime_error("Concurrency limits were exceeded");
+    }
+
+    streamer.setConcurrency(1, 1);
+    maxIo = 0;
+    maxDecode = 0;
+    enqueue(8);
+    if (completed != 40 || maxIo > 1 || maxDecode > 1) {
+        throw std::runtime_error("Changed concurrency limits were exceeded");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testPriorityOrder();
+    testCancellation();
+    testConcurrencyLimits();
+    std::cout << "Resource streamer tests passed\n";
+    return 0;
+}
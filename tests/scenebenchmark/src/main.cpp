@@ -0,0 +1,219 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+
+using namespace xng;
+
+static const size_t DEFAULT_ENTITIES = 200000;
+
+static std::string toJson(const Message &message) {
+    std::stringstream stream;
+    JsonProtocol().serialize(stream, message);
+    return stream.str();
+}
+
+static Message toMessage(const EntityScene &scene) {
+    Message ret;
+    scene >> ret;
+    return ret;
+}
+
+static void createScene(EntityScene &scene, size_t count) {
+    scene.setName("benchmark");
+    for (size_t i = 0; i < count; i++) {
+        auto entity = i % 10 == 0 ? scene.createEntity("entity" + std::to_string(i)) : scene.createEntity();
+
+        TransformComponent transform;
+        transform.transform.setPosition(Vec3f(static_cast<float>(i), static_cast<float>(i % 100), 0.5f));
+        transform.transform.setRotation(Quaternion(Vec3f(0, static_cast<float>(i % 360), 0)));
+        transform.transform.setScale(Vec3f(1, 2, 3));
+        if (i % 10 != 0) {
+            transform.parent = "entity" + std::to_string(i - i % 10);
+        }
+        entity.createComponent(transform);
+
+        if (i % 4 == 0) {
+            CameraComponent camera;
+            camera.camera.fov = static_cast<float>(i % 90);
+            entity.createComponent(camera);
+        }
+
+        if (i % 8 == 0) {
+            // Unregistered component types are stored as generic components
+            GenericComponent generic;
+            Message custom(Message::DICTIONARY);
+            custom["value"] = static_cast<long long>(i);
+            custom["text"] = std::string("custom");
+            generic.components["CustomComponent"] = custom;
+            entity.createComponent(generic);
+        }
+    }
+}
+
+/**
+ * Writes the bundle message with the binary protocol and reads it back with the binary importer
+ * from a stream and from a buffer.
+ *
+ * @return True if both bundles serialize to the same json as the bundle read by the json importer
+ */
+static bool checkBinaryImporter(const Message &bundleMessage,
+                                const std::function<std::string(const ResourceBundle &)> &serialize) {
+    std::stringstream jsonStream(toJson(bundleMessage));
+    auto expected = serialize(JsonImporter().read(jsonStream, ".json", "", nullptr));
+
+    std::stringstream binaryStream;
+    BinaryProtocol().serialize(binaryStream, bundleMessage);
+    auto binary = binaryStream.str();
+
+    std::stringstream readStream(binary);
+    auto streamBundle = BinaryImporter().read(readStream, ".xbin", "", nullptr);
+    auto bufferBundle = BinaryImporter().readBuffer(ReadBuffer(std::vector<char>(binary.begin(), binary.end())),
+                                                    ".xbin",
+                                                    "",
+                                                    nullptr);
+
+    return serialize(streamBundle) == expected && serialize(bufferBundle) == expected;
+}
+
+template<typename F>
+static double measure(F &&f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(duration.count()) / 1000.0;
+}
+
+int main(int argc, char *argv[]) {
+    auto count = argc > 1 ? std::stoul(argv[1]) : DEFAULT_ENTITIES;
+
+    // The message format is checked against a json message containing every data type
+    Message message(Message::DICTIONARY);
+    message["int"] = -42;
+    message["uint"] = 42u;
+    message["float"] = 0.25;
+    message["string"] = std::string("text");
+    message["list"] = std::vector<Message>{Message(1), Message(std::string("a")), Message()};
+    message["nested"] = Message(Message::DICTIONARY);
+    message["nested"]["int"] = -1;
+    message["nested"]["list"] = std::vector<Message>{Message(2.5)};
+
+    std::stringstream binaryStream;
+    BinaryProtocol().serialize(binaryStream, message);
+    if (toJson(BinaryProtocol().deserialize(binaryStream)) != toJson(message)) {
+        std::cout << "Binary message round trip failed\n";
+        return 1;
+    }
+
+    EntityScene scene;
+    createScene(scene, count);
+
+    auto sceneMessage = toMessage(scene);
+    auto json = toJson(sceneMessage);
+
+    std::stringstream messageStream;
+    BinaryProtocol().serialize(messageStream, sceneMessage);
+    auto binaryMessage = messageStream.str();
+
+    BinaryWriter writer;
+    scene.serialize(writer);
+
+    std::cout << "Entities: " << count << "\n";
+    std::cout << "Json Size: " << json.size() / 1024 << " KB"
+              << " Binary Message Size: " << binaryMessage.size() / 1024 << " KB"
+              << " Binary Scene Size: " << writer.size() / 1024 << " KB\n";
+
+    EntityScene jsonScene;
+    auto jsonTime = measure([&]() {
+        std::stringstream stream(json);
+        jsonScene << JsonProtocol().deserialize(stream);
+    });
+
+    EntityScene messageScene;
+    auto messageTime = measure([&]() {
+        std::stringstream stream(binaryMessage);
+        messageScene << BinaryProtocol().deserialize(stream);
+    });
+
+    EntityScene binaryScene;
+    auto binaryTime = measure([&]() {
+        BinaryReader reader(writer.getData().data(), writer.size());
+        binaryScene.deserialize(reader);
+    });
+
+    std::cout << "Json Load: " << jsonTime << " ms\n";
+    std::cout << "Binary Message Load: " << messageTime << " ms\n";
+    std::cout << "Binary Scene Load: " << binaryTime << " ms\n";
+
+    // Scenes loaded from the binary formats must serialize to the same json as the source scene
+    if (toJson(toMessage(messageScene)) != json) {
+        std::cout << "Binary message scene round trip failed\n";
+        return 1;
+    }
+
+    if (toJson(toMessage(binaryScene)) != json) {
+        std::cout << "Binary scene round trip failed\n";
+        return 1;
+    }
+
+    // Scenes loaded from json and written to the binary scene format must serialize to the same json
+    BinaryWriter jsonWriter;
+    jsonScene.serialize(jsonWriter);
+    EntityScene reloadedScene;
+    BinaryReader reader(jsonWriter.getData().data(), jsonWriter.size());
+    reloadedScene.deserialize(reader);
+    if (toJson(toMessage(reloadedScene)) != toJson(toMessage(jsonScene))) {
+        std::cout << "Json scene round trip failed\n";
+        return 1;
+    }
+
+    // Bundles written with the binary protocol and binary scenes load through the .xbin importer
+    auto serializeScene = [&](const ResourceBundle &bundle) {
+        return toJson(toMessage(bundle.get<EntityScene>(scene.getName())));
+    };
+    if (!checkBinaryImporter(sceneMessage, serializeScene)) {
+        std::cout << "Binary importer scene bundle round trip failed\n";
+        return 1;
+    }
+
+    auto binarySceneBundle = BinaryImporter().readBuffer(ReadBuffer(writer.getData()), ".xbin", "", nullptr);
+    if (serializeScene(binarySceneBundle) != json) {
+        std::cout << "Binary importer scene round trip failed\n";
+        return 1;
+    }
+
+    Material material;
+    material.roughness = 0.5f;
+    material.transparent = true;
+    ResourceBundle materials;
+    materials.add("material", std::make_unique<Material>(material));
+    if (!checkBinaryImporter(JsonImporter::createBundle(materials), [](const ResourceBundle &bundle) {
+        return toJson(JsonImporter::createBundle(bundle));
+    })) {
+        std::cout << "Binary importer resource bundle round trip failed\n";
+        return 1;
+    }
+
+    return 0;
+}
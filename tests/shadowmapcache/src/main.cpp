@@ -0,0 +1,191 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <iostream>
+
+using namespace xng;
+
+typedef ShadowMapCache::Request Request;
+
+static size_t countRenders(const std::vector<ShadowMapCache::Allocation> &allocations) {
+    size_t ret = 0;
+    for (auto &allocation: allocations) {
+        if (allocation.render) {
+            ret++;
+        }
+    }
+    return ret;
+}
+
+static void testReuse() {
+    ShadowMapCache cache(4);
+    std::vector<Request> requests = {{1, 10}, {2, 20}};
+
+    auto first = cache.update(requests);
+    if (countRenders(first) != 2 || first.at(0).layer == first.at(1).layer) {
+        throw std::runtime_error("New shadow maps were not rendered into separate layers");
+    }
+
+    // Unchanged light and caster hashes reuse the layer without rendering
+    auto second = cache.update(requests);
+    if (countRenders(second) != 0
+        || second.at(0).layer != first.at(0).layer
+        || second.at(1).layer != first.at(1).layer
+        || second.at(0).clear
+        || second.at(1).clear) {
+        throw std::runtime_error("Unchanged shadow maps were not reused");
+    }
+
+    // The order of the requests does not affect the layers
+    auto swapped = cache.update({requests.at(1), requests.at(0)});
+    if (countRenders(swapped) != 0
+        || swapped.at(0).layer != first.at(1).layer
+        || swapped.at(1).layer != first.at(0).layer) {
+        throw std::runtime_error("Shadow maps did not keep their layers after reordering");
+    }
+}
+
+static void testChangedHash() {
+    ShadowMapCache cache(4);
+    auto first = cache.update({{1, 10}, {2, 20}});
+
+    // A changed caster hash renders the shadow map again into the same layer
+    auto casters = cache.update({{1, 10}, {2, 21}});
+    if (casters.at(0).render
+        || !casters.at(1).render
+        || casters.at(1).layer != first.at(1).layer) {
+        throw std::runtime_error("Shadow map with changed casters was not rendered");
+    }
+
+    // A changed light hash renders the shadow map again, the other map is kept
+    auto light = cache.update({{3, 10}, {2, 21}});
+    if (!light.at(0).render || light.at(1).render || light.at(0).layer == light.at(1).layer) {
+        throw std::runtime_error("Shadow map of the changed light was not rendered");
+    }
+
+    // Invalidated layers are rendered again
+    cache.invalidate();
+    if (countRenders(cache.update({{3, 10}, {2, 21}})) != 2) {
+        throw std::runtime_error("Invalidated shadow maps were not rendered");
+    }
+}
+
+static void testBudget() {
+    ShadowMapCache cache(4);
+    auto first = cache.update({{1, 10}, {2, 20}, {3, 30}, {4, 40}}, 4);
+    if (countRenders(first) != 4 || cache.getCapacity() != 4) {
+        throw std::runtime_error("Shadow maps within the budget were not rendered");
+    }
+
+    // New lights evict the layers of the removed lights, new maps over the budget are cleared instead of rendered
+    auto replaced = cache.update({{1, 10}, {2, 20}, {5, 50}, {6, 60}}, 1);
+    if (replaced.at(0).render || replaced.at(1).render
+        || replaced.at(0).layer != first.at(0).layer
+        || replaced.at(1).layer != first.at(1).layer) {
+        throw std::runtime_error("Unchanged shadow maps lost their layers");
+    }
+    if (countRenders(replaced) != 1 || !replaced.at(2).render || !replaced.at(3).clear) {
+        throw std::runtime_error("Budget was not applied to new shadow maps in request order");
+    }
+    for (auto i = 2; i < 4; i++) {
+        if (replaced.at(i).layer != first.at(2).layer && replaced.at(i).layer != first.at(3).layer) {
+            throw std::runtime_error("New shadow map did not evict the layer of a removed light");
+        }
+    }
+
+    // The map which was not rendered is rendered in the next frame
+    auto next = cache.update({{1, 10}, {2, 20}, {5, 50}, {6, 60}}, 1);
+    if (countRenders(next) != 1 || !next.at(3).render || next.at(3).layer != replaced.at(3).layer) {
+        throw std::runtime_error("Cleared shadow map was not rendered in the next frame");
+    }
+
+    // Outdated maps over the budget keep their previous contents, the least recently rendered is updated first
+    auto outdated = cache.update({{1, 11}, {2, 21}, {5, 50}, {6, 60}}, 1);
+    if (countRenders(outdated) != 1
+        || !outdated.at(0).render
+        || outdated.at(1).render
+        || outdated.at(1).clear) {
+        throw std::runtime_error("Least recently rendered outdated shadow map was not updated first");
+    }
+    outdated = cache.update({{1, 11}, {2, 21}, {5, 50}, {6, 60}}, 1);
+    if (countRenders(outdated) != 1 || !outdated.at(1).render) {
+        throw std::runtime_error("Outdated shadow map was not updated in the next frame");
+    }
+
+    // Growing the capacity recreates the texture array and renders all maps
+    auto grown = cache.update({{1, 11}, {2, 21}, {5, 50}, {6, 60}, {7, 70}});
+    if (cache.getCapacity() != 8 || countRenders(grown) != 5) {
+        throw std::runtime_error("Shadow maps were not rendered after growing the capacity");
+    }
+}
+
+static void testCasterMovement() {
+    std::vector<ShadowMapCache::Caster> casters = {
+            {Vec3f(0, 0, 0), 1, 1},
+            {Vec3f(100, 0, 0), 1, 2},
+    };
+
+    auto getRequests = [&]() {
+        return std::vector<Request>{
+                {1, ShadowMapCache::getCasterHash(casters, Vec3f(0, 0, 0), 10)},
+                {2, ShadowMapCache::getCasterHash(casters, Vec3f(100, 0, 0), 10)},
+        };
+    };
+
+    ShadowMapCache cache(4);
+    cache.update(getRequests());
+
+    // The hash does not depend on the order of the casters
+    std::vector<ShadowMapCache::Caster> reversed(casters.rbegin(), casters.rend());
+    if (ShadowMapCache::getCasterHash(reversed, Vec3f(0, 0, 0), 10)
+        != ShadowMapCache::getCasterHash(casters, Vec3f(0, 0, 0), 10)) {
+        throw std::runtime_error("Caster hash depends on the order of the casters");
+    }
+
+    // Moving a caster within the range of the first light only invalidates the first map
+    casters.at(0) = {Vec3f(2, 0, 0), 1, 3};
+    auto moved = cache.update(getRequests());
+    if (!moved.at(0).render || moved.at(1).render) {
+        throw std::runtime_error("Moving a caster did not invalidate only the affected shadow map");
+    }
+
+    // Moving the caster into the range of the second light invalidates both maps
+    casters.at(0) = {Vec3f(100, 5, 0), 1, 4};
+    moved = cache.update(getRequests());
+    if (!moved.at(0).render || !moved.at(1).render) {
+        throw std::runtime_error("Moving a caster between lights did not invalidate both shadow maps");
+    }
+
+    // Casters outside the range of all lights do not invalidate any map
+    casters.emplace_back(ShadowMapCache::Caster{Vec3f(50, 0, 0), 1, 5});
+    if (countRenders(cache.update(getRequests())) != 0) {
+        throw std::runtime_error("Caster outside of all lights invalidated a shadow map");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testReuse();
+    testChangedHash();
+    testBudget();
+    testCasterMovement();
+    std::cout << "Shadow map cache tests passed\n";
+    return 0;
+}
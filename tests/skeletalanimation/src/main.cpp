@@ -139,7 +139,8 @@ int main(int argc, char *argv[]) {
         auto deltaTime = limiter.newFrame();
 
         rigAnimator.update(deltaTime);
-        boneTransformsProperty.boneTransforms = rigAnimator.getBoneTransforms();
+        scene.bonePalette.clear();
+        boneTransformsProperty.paletteOffset = scene.bonePalette.add(rigAnimator.getBoneTransforms());
 
         scene.rootNode.find<CameraProperty>().getProperty<CameraProperty>().camera.aspectRatio =
                 static_cast<float>(window->getWindowSize().x)
@@ -0,0 +1,230 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+static ImageRGBA createTestImage(int width, int height) {
+    std::mt19937 random(3);
+    std::uniform_int_distribution<int> noise(-6, 6);
+    ImageRGBA ret(width, height);
+    for (auto y = 0; y < height; y++) {
+        for (auto x = 0; x < width; x++) {
+            auto r = 255 * x / width;
+            auto g = 255 * y / height;
+            auto b = (x / 8 + y / 8) % 2 == 0 ? 40 : 200;
+            auto a = 255 - 255 * (x + y) / (width + height);
+            ret.setPixel(x, y, ColorRGBA(static_cast<uint8_t>(std::clamp(r + noise(random), 0, 255)),
+                                         static_cast<uint8_t>(std::clamp(g + noise(random), 0, 255)),
+                                         static_cast<uint8_t>(b),
+                                         static_cast<uint8_t>(a)));
+        }
+    }
+    return ret;
+}
+
+static double getPSNR(const ImageRGBA &a, const ImageRGBA &b, int channels) {
+    double error = 0;
+    for (auto i = 0; i < a.getBuffer().size(); i++) {
+        for (auto c = 0; c < channels; c++) {
+            double d = a.getBuffer().at(i).data[c] - b.getBuffer().at(i).data[c];
+            error += d * d;
+        }
+    }
+    error /= static_cast<double>(a.getBuffer().size() * channels);
+    return error == 0 ? 100 : 10 * std::log10(255.0 * 255.0 / error);
+}
+
+static void testMipChain() {
+    ImageRGBA checker(64, 64);
+    for (auto y = 0; y < 64; y++) {
+        for (auto x = 0; x < 64; x++) {
+            checker.setPixel(x, y, (x + y) % 2 == 0 ? ColorRGBA::black() : ColorRGBA::white());
+        }
+    }
+
+    TextureCooker::Settings settings;
+    settings.filter = TextureCooker::FILTER_BOX;
+    auto chain = TextureCooker::generateMipChain(checker, settings);
+    if (chain.size() != TextureBufferDesc::getMipMapLevelCount(checker.getResolution())) {
+        throw std::runtime_error("Invalid mip chain length");
+    }
+    // The average of black and white in linear space is 188 in srgb, averaging the srgb values would produce 128.
+    auto &average = chain.back().getPixel(0, 0);
+    std::cout << "Checkerboard 1x1 mip level: " << static_cast<int>(average.r()) << "\n";
+    if (std::abs(static_cast<int>(average.r()) - 188) > 1) {
+        throw std::runtime_error("Mip maps are not filtered in linear space");
+    }
+
+    settings.filter = TextureCooker::FILTER_KAISER;
+    chain = TextureCooker::generateMipChain(createTestImage(37, 20), settings);
+    Vec2i expected(37, 20);
+    for (auto &level: chain) {
+        if (level.getResolution() != expected) {
+            throw std::runtime_error("Invalid mip level resolution");
+        }
+        expected = Vec2i(std::max(1, expected.x / 2), std::max(1, expected.y / 2));
+    }
+    if (chain.back().getResolution() != Vec2i(1, 1)) {
+        throw std::runtime_error("Mip chain does not end at 1x1");
+    }
+
+    // Invisible pixels must not bleed their color into the smaller levels.
+    ImageRGBA cutout(2, 2);
+    cutout.setPixel(0, 0, ColorRGBA(255, 0, 0, 0));
+    cutout.setPixel(1, 0, ColorRGBA(0, 255, 0, 255));
+    cutout.setPixel(0, 1, ColorRGBA(0, 255, 0, 255));
+    cutout.setPixel(1, 1, ColorRGBA(0, 255, 0, 255));
+    settings.filter = TextureCooker::FILTER_BOX;
+    auto cutoutLevel = TextureCooker::generateMipChain(cutout, settings).at(1).getPixel(0, 0);
+    if (cutoutLevel.r() != 0 || cutoutLevel.g() != 255 || std::abs(cutoutLevel.a() - 191) > 1) {
+        throw std::runtime_error("Translucent pixels are not filtered with premultiplied alpha");
+    }
+}
+
+static void testBlockCompression() {
+    auto image = createTestImage(67, 45);
+
+    struct Case {
+        ColorFormat format;
+        int channels;
+        double minimumPSNR;
+        const char *name;
+    };
+
+    for (auto &test: {Case{BC1_RGBA, 3, 30, "BC1"},
+                      Case{BC3_RGBA, 4, 30, "BC3"},
+                      Case{BC5_RG, 2, 38, "BC5"},
+                      Case{BC7_RGBA, 4, 36, "BC7"}}) {
+        auto source = image;
+        if (test.format == BC1_RGBA) {
+            // BC1 only stores 1 bit alpha
+            for (auto &pixel: source.getBuffer()) {
+                pixel.a() = 255;
+            }
+        }
+        auto data = BlockCompressor::compress(source, test.format);
+        if (data.size() != getBlockCompressedSize(test.format, source.getWidth(), source.getHeight())) {
+            throw std::runtime_error("Invalid block compressed size");
+        }
+        auto decoded = BlockCompressor::decompress(data.data(), data.size(), source.getResolution(), test.format);
+        auto psnr = getPSNR(source, decoded, test.channels);
+        std::cout << test.name << " PSNR: " << psnr << " dB, "
+                  << source.getBuffer().size() * sizeof(ColorRGBA) << " -> " << data.size() << " bytes\n";
+        if (psnr < test.minimumPSNR) {
+            throw std::runtime_error(std::string(test.name) + " compression error too large");
+        }
+    }
+
+    // BC1 cutout alpha
+    ColorRGBA pixels[16];
+    for (auto i = 0; i < 16; i++) {
+        pixels[i] = i % 3 == 0 ? ColorRGBA(0, 0, 0, 0) : ColorRGBA(200, 100, 50, 255);
+    }
+    uint8_t block[8];
+    BlockCompressor::encodeBC1(pixels, block, true);
+    ColorRGBA decoded[16];
+    BlockCompressor::decodeBC1(block, decoded);
+    for (auto i = 0; i < 16; i++) {
+        if ((decoded[i].a() == 0) != (i % 3 == 0)) {
+            throw std::runtime_error("BC1 alpha is not preserved");
+        }
+    }
+}
+
+static void testContainer() {
+    TextureCooker::Settings settings;
+    settings.format = BC7_RGBA;
+    auto texture = TextureCooker::cook(createTestImage(40, 24), settings);
+
+    BinaryWriter writer;
+    texture.serialize(writer);
+
+    auto buffer = ReadBuffer(writer.getData());
+    auto bundle = CookedTextureImporter().readBuffer(buffer, ".xtex", "test.xtex", nullptr);
+    auto &imported = bundle.get<CookedTexture>("texture");
+
+    if (!(imported.description == texture.description)
+        || imported.mipMapLevels.size() != texture.mipMapLevels.size()) {
+        throw std::runtime_error("Cooked texture header mismatch");
+    }
+    for (auto i = 0; i < imported.mipMapLevels.size(); i++) {
+        auto &level = imported.mipMapLevels.at(i);
+        if (level.size() != texture.mipMapLevels.at(i).size()
+            || std::memcmp(level.data(), texture.mipMapLevels.at(i).data(), level.size()) != 0) {
+            throw std::runtime_error("Cooked texture mip level mismatch");
+        }
+        // The imported levels reference the read buffer
+        if (level.data() < buffer.begin() || level.data() + level.size() > buffer.end()) {
+            throw std::runtime_error("Cooked texture mip level was copied");
+        }
+    }
+    std::cout << "Cooked texture: " << imported.mipMapLevels.size() << " levels, "
+              << writer.getData().size() << " bytes\n";
+}
+
+static bool rejects(const CookedTexture &texture) {
+    BinaryWriter writer;
+    texture.serialize(writer);
+    try {
+        CookedTexture ret;
+        ret.deserialize(ReadBuffer(writer.getData()));
+    } catch (const std::runtime_error &) {
+        return true;
+    }
+    return false;
+}
+
+static void testMalformedContainer() {
+    CookedTexture texture;
+    texture.description.size = {4, 4};
+    texture.description.format = RGBA;
+    texture.description.mipMapLevels = 1;
+    texture.mipMapLevels.emplace_back(std::vector<uint8_t>(4 * 4 * 4));
+    if (rejects(texture)) {
+        throw std::runtime_error("Valid uncompressed cooked texture was rejected");
+    }
+
+    // Uncompressed levels must contain 4 bytes per pixel
+    texture.mipMapLevels.at(0) = ReadBuffer(std::vector<uint8_t>(4 * 4 * 4 - 1));
+    if (!rejects(texture)) {
+        throw std::runtime_error("Truncated uncompressed mip level was accepted");
+    }
+
+    // Only RGBA and block compressed formats are uploaded as is
+    texture.description.format = RGB;
+    texture.mipMapLevels.at(0) = ReadBuffer(std::vector<uint8_t>(4 * 4 * 3));
+    if (!rejects(texture)) {
+        throw std::runtime_error("Unsupported cooked texture format was accepted");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testMipChain();
+    testBlockCompression();
+    testContainer();
+    testMalformedContainer();
+    return 0;
+}
@@ -0,0 +1,168 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/xng.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <random>
+
+using namespace xng;
+
+template<typename T>
+static T read(const Vertex &vertex, size_t offset) {
+    T ret;
+    std::memcpy(&ret, vertex.buffer.data() + offset, sizeof(T));
+    return ret;
+}
+
+static Vec3f readVec3(const Vertex &vertex, size_t offset) {
+    return {read<float>(vertex, offset), read<float>(vertex, offset + 4), read<float>(vertex, offset + 8)};
+}
+
+static Vec3f cross(const Vec3f &a, const Vec3f &b) {
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+static float dot(const Vec3f &a, const Vec3f &b) {
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+static Vec3f getRandomDirection(std::mt19937 &random) {
+    std::normal_distribution<float> distribution;
+    Vec3f ret(distribution(random), distribution(random), distribution(random));
+    return ret / ret.magnitude();
+}
+
+static void testHalf() {
+    for (float value: {0.0f, -0.0f, 1.0f, -2.5f, 0.333333f, 65504.0f, 6.1035156e-05f, 5.9604645e-08f, 1024.5f}) {
+        auto decoded = VertexQuantizer::decodeHalf(VertexQuantizer::encodeHalf(value));
+        if (std::abs(decoded - value) > std::abs(value) / 1024.0f) {
+            throw std::runtime_error("Half float conversion of " + std::to_string(value) + " is inaccurate");
+        }
+    }
+    if (!std::isinf(VertexQuantizer::decodeHalf(VertexQuantizer::encodeHalf(1e6f)))) {
+        throw std::runtime_error("Half float overflow is not infinity");
+    }
+    // Ties round to even
+    if (VertexQuantizer::encodeHalf(2049.0f) != VertexQuantizer::encodeHalf(2048.0f)) {
+        throw std::runtime_error("Half float conversion does not round to even");
+    }
+}
+
+static void testOctahedral() {
+    std::mt19937 random(7);
+    float maxError = 0;
+    for (auto i = 0; i < 10000; i++) {
+        auto direction = getRandomDirection(random);
+        auto encoded = VertexQuantizer::encodeOctahedral(direction);
+        encoded = Vec2f(VertexQuantizer::decodeSnorm16(VertexQuantizer::encodeSnorm16(encoded.x)),
+                        VertexQuantizer::decodeSnorm16(VertexQuantizer::encodeSnorm16(encoded.y)));
+        auto decoded = VertexQuantizer::decodeOctahedral(encoded);
+        // The sine of the angle is more accurate than the arc cosine of the dot product for small angles
+        maxError = std::max(maxError, std::asin(std::min(1.0f, cross(direction, decoded).magnitude())));
+    }
+    std::cout << "Octahedral snorm16 maximum angular error: " << maxError << " radians\n";
+    if (maxError > 0.0002f) {
+        throw std::runtime_error("Octahedral encoding is inaccurate");
+    }
+}
+
+static void testMesh() {
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> positionDistribution(-50, 150);
+    std::uniform_real_distribution<float> uvDistribution(-2, 2);
+
+    SkinnedMesh mesh;
+    mesh.primitive = TRIANGLES;
+    mesh.vertexLayout = SkinnedMesh::getDefaultVertexLayout();
+    for (auto i = 0; i < 1000; i++) {
+        auto normal = getRandomDirection(random);
+        auto tangent = cross(normal, getRandomDirection(random));
+        tangent = tangent / tangent.magnitude();
+        auto bitangent = cross(normal, tangent) * (i % 2 == 0 ? 1.0f : -1.0f);
+        mesh.vertices.emplace_back(VertexBuilder()
+                                           .addVec3(Vec3f(positionDistribution(random),
+                                                          positionDistribution(random) * 0.01f,
+                                                          positionDistribution(random)))
+                                           .addVec3(normal)
+                                           .addVec2(Vec2f(uvDistribution(random), uvDistribution(random)))
+                                           .addVec3(tangent)
+                                           .addVec3(bitangent)
+                                           .addVec4(Vec4i(i % 100, -1, 3, -1))
+                                           .addVec4(Vec4f(0.75f, 0, 0.25f, 0))
+                                           .build());
+        mesh.indices.emplace_back(i);
+    }
+
+    auto source = mesh;
+    VertexQuantizer::quantize(mesh);
+
+    std::cout << "Vertex size: " << source.vertexLayout.getSize() << " -> " << mesh.vertexLayout.getSize() << " bytes\n";
+
+    if (mesh.vertexLayout != SkinnedMesh::getCompactVertexLayout()
+        || mesh.vertices.at(0).buffer.size() != mesh.vertexLayout.getSize()) {
+        throw std::runtime_error("Quantized mesh does not use the compact layout");
+    }
+
+    auto positions = MeshSimplifier::getPositions(mesh);
+
+    VertexQuantizer::dequantize(mesh);
+    if (mesh.vertexLayout != SkinnedMesh::getDefaultVertexLayout()) {
+        throw std::runtime_error("Dequantized mesh does not use the default layout");
+    }
+
+    for (auto i = 0; i < mesh.vertices.size(); i++) {
+        auto &expected = source.vertices.at(i);
+        auto &actual = mesh.vertices.at(i);
+
+        // The quantization step is the half extent of each axis divided by 32767
+        auto positionError = readVec3(actual, 0) - readVec3(expected, 0);
+        if (std::abs(positionError.x) > 0.002f
+            || std::abs(positionError.y) > 0.00002f
+            || std::abs(positionError.z) > 0.002f
+            || (positions.at(i) - readVec3(expected, 0)).magnitude() > 0.003f) {
+            throw std::runtime_error("Position quantization error too large");
+        }
+        if (dot(readVec3(actual, 12), readVec3(expected, 12)) < 0.9999f
+            || dot(readVec3(actual, 32), readVec3(expected, 32)) < 0.9999f
+            || dot(readVec3(actual, 44), readVec3(expected, 44)) < 0.999f) {
+            throw std::runtime_error("Tangent frame quantization error too large");
+        }
+        for (auto c = 0; c < 2; c++) {
+            if (std::abs(read<float>(actual, 24 + c * 4) - read<float>(expected, 24 + c * 4)) > 0.002f) {
+                throw std::runtime_error("Uv quantization error too large");
+            }
+        }
+        for (auto c = 0; c < 4; c++) {
+            if (read<int>(actual, 56 + c * 4) != read<int>(expected, 56 + c * 4)
+                || std::abs(read<float>(actual, 72 + c * 4) - read<float>(expected, 72 + c * 4)) > 0.5f / 255.0f) {
+                throw std::runtime_error("Bone data quantization error too large");
+            }
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    testHalf();
+    testOctahedral();
+    testMesh();
+    return 0;
+}
@@ -0,0 +1,206 @@
+/**
+ *  xEngine - C++ Game Engine Library
+ *  Copyright (C) 2024  Julian Zampiccoli
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser General Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser General Public License along
+ *  with this program; if not, write to the Free Software Foundation, Inc.,
+ *  51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include "xng/render/texture/texturecooker.hpp"
+#include "xng/resource/importers/stbiimporter.hpp"
+
+#include "xng/io/readfile.hpp"
+#include "xng/io/writefile.hpp"
+
+#include <filesystem>
+#include <iostream>
+
+struct Arguments {
+    std::filesystem::path sourcePath{};
+    std::filesystem::path outputPath{};
+    xng::TextureCooker::Settings settings{};
+    bool forceOverwrite = false;
+};
+
+xng::ColorFormat getFormat(const std::string &format) {
+    if (format == "RGBA") {
+        return xng::RGBA;
+    } else if (format == "BC1") {
+        return xng::BC1_RGBA;
+    } else if (format == "BC3") {
+        return xng::BC3_RGBA;
+    } else if (format == "BC5") {
+        return xng::BC5_RG;
+    } else if (format == "BC7") {
+        return xng::BC7_RGBA;
+    } else {
+        throw std::runtime_error("Unrecognized format: " + format);
+    }
+}
+
+xng::TextureCooker::MipMapFilter getFilter(const std::string &filter) {
+    if (filter == "BOX") {
+        return xng::TextureCooker::FILTER_BOX;
+    } else if (filter == "KAISER") {
+        return xng::TextureCooker::FILTER_KAISER;
+    } else {
+        throw std::runtime_error("Unrecognized mip map filter: " + filter);
+    }
+}
+
+xng::TextureWrapping getWrapping(const std::string &wrapping) {
+    if (wrapping == "REPEAT") {
+        return xng::REPEAT;
+    } else if (wrapping == "MIRRORED_REPEAT") {
+        return xng::MIRRORED_REPEAT;
+    } else if (wrapping == "CLAMP_TO_EDGE") {
+        return xng::CLAMP_TO_EDGE;
+    } else if (wrapping == "CLAMP_TO_BORDER") {
+        return xng::CLAMP_TO_BORDER;
+    } else {
+        throw std::runtime_error("Unrecognized wrapping: " + wrapping);
+    }
+}
+
+Arguments parseArgs(int argc, char *argv[]) {
+    if (argc < 2) {
+        throw std::runtime_error("No arguments specified");
+    }
+
+    Arguments ret;
+    for (auto i = 1; i < argc; i++) {
+        std::string arg(argv[i]);
+        if (arg.starts_with('-')) {
+            if (arg == "-c") {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("-c option must be followed by a valid format name");
+                } else {
+                    ret.settings.format = getFormat(std::string(argv[++i]));
+                }
+            } else if (arg == "-m") {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("-m option must be followed by a valid mip map filter name");
+                } else {
+                    ret.settings.filter = getFilter(std::string(argv[++i]));
+                }
+            } else if (arg == "-w") {
+                if (i + 1 >= argc) {
+                    throw std::runtime_error("-w option must be followed by a valid wrapping name");
+                } else {
+                    ret.settings.wrapping = getWrapping(std::string(argv[++i]));
+                }
+            } else if (arg == "-n") {
+                ret.settings.generateMipMaps = false;
+            } else if (arg == "-l") {
+                ret.settings.sRGB = false;
+            } else if (arg == "-N") {
+                ret.settings.normalMap = true;
+                ret.settings.sRGB = false;
+            } else if (arg == "-f") {
+                ret.forceOverwrite = true;
+            } else {
+                throw std::runtime_error("Unrecognized option: " + arg);
+            }
+        } else if (ret.sourcePath.empty()) {
+            ret.sourcePath = arg;
+        } else if (ret.outputPath.empty()) {
+            ret.outputPath = arg;
+        } else {
+            throw std::runtime_error("Invalid number of paths: " + arg);
+        }
+    }
+    return ret;
+}
+
+void printUsage() {
+    std::cout << "Usage: texturecooker [OPTION]... SOURCE [DEST]\n"
+                 "  -c FORMAT   The output format: RGBA, BC1, BC3, BC5 or BC7 (Default BC7)\n"
+                 "  -m FILTER   The mip map filter: BOX or KAISER (Default KAISER)\n"
+                 "  -w WRAPPING The wrapping used when filtering and sampling: REPEAT, MIRRORED_REPEAT, CLAMP_TO_EDGE or CLAMP_TO_BORDER (Default REPEAT)\n"
+                 "  -n          Do not generate mip maps\n"
+                 "  -l          The source contains linear data instead of srgb colors\n"
+                 "  -N          The source is a normal map, implies -l\n"
+                 "  -f          Overwrite the destination without asking\n";
+}
+
+int main(int argc, char *argv[]) {
+    Arguments args;
+    try {
+        args = parseArgs(argc, argv);
+    } catch (const std::exception &e) {
+        std::cout << "Failed to parse arguments: " << e.what() << "\n";
+        printUsage();
+        return 0;
+    }
+
+    if (!std::filesystem::exists(args.sourcePath)) {
+        std::cout << args.sourcePath.string() + ": No such file or directory\n";
+        return 0;
+    } else if (std::filesystem::is_directory(args.sourcePath)) {
+        std::cout << args.sourcePath.string() + ": Is a directory\n";
+        return 0;
+    }
+
+    if (args.outputPath.empty()) {
+        args.outputPath = args.sourcePath;
+        args.outputPath.replace_extension(".xtex");
+    }
+
+    if (std::filesystem::exists(args.outputPath) && !args.forceOverwrite) {
+        char inValue = 0;
+        while (!std::cin.fail() && inValue != 'y' && inValue != 'n') {
+            std::cout << args.outputPath.string() +
+                         ": File already exists, do you want to overwrite the existing file? y/n: ";
+            std::cin >> inValue;
+            std::cout << "\n";
+        }
+        if (inValue == 'n') {
+            std::cout << "Aborting";
+            return 0;
+        }
+    }
+
+    xng::CookedTexture texture;
+    try {
+        auto bundle = xng::StbiImporter().readBuffer(xng::ReadBuffer(xng::readFile(args.sourcePath)),
+                                                     args.sourcePath.extension().string(),
+                                                     args.sourcePath.string(),
+                                                     nullptr);
+        texture = xng::TextureCooker::cook(bundle.get<xng::ImageRGBA>("image"), args.settings);
+    } catch (const std::exception &e) {
+        std::cout << "Failed to cook texture " + args.sourcePath.string() + "\n";
+        std::cout << e.what();
+        std::cout << "\n";
+        return 1;
+    }
+
+    xng::BinaryWriter writer;
+    texture.serialize(writer);
+
+    try {
+        xng::writeFile(args.outputPath, writer.getData());
+    } catch (const std::exception &e) {
+        std::cout << "Failed to write file at: " + args.outputPath.string() + "\n";
+        std::cout << e.what();
+        std::cout << "\n";
+        return 1;
+    }
+
+    std::cout << args.outputPath.string() << ": "
+              << texture.description.size.x << "x" << texture.description.size.y << ", "
+              << texture.mipMapLevels.size() << " mip map levels, "
+              << texture.getMemoryUsage() << " bytes\n";
+
+    return 0;
+}